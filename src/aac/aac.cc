@@ -2,6 +2,12 @@
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#elif defined (__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #include <neaacdec.h>
 
 #include <audacious/audtag.h>
@@ -77,18 +83,57 @@ static int aac_parse_frame (unsigned char * buf, int * srate, int * num)
 
 #define PROBE_DEBUG(...)
 
+/* Finds the next 0xFF byte at or after <start>; returns <length> if there is
+ * none.  Candidates are located sixteen bytes at a time where SIMD is
+ * available, since sync bytes are rare within the body of a frame. */
+static int find_sync_byte (const unsigned char * data, int start, int length)
+{
+    int i = start;
+
+#ifdef __SSE2__
+    const __m128i ff = _mm_set1_epi8 ((char) 0xFF);
+
+    for (; i + 16 <= length; i += 16)
+    {
+        __m128i v = _mm_loadu_si128 ((const __m128i *) (data + i));
+        int mask = _mm_movemask_epi8 (_mm_cmpeq_epi8 (v, ff));
+
+        if (mask)
+            return i + __builtin_ctz (mask);
+    }
+#elif defined (__ARM_NEON)
+    for (; i + 16 <= length; i += 16)
+    {
+        uint8x16_t eq = vceqq_u8 (vld1q_u8 (data + i), vdupq_n_u8 (0xFF));
+
+        /* narrowing shift folds the match vector to four bits per byte */
+        uint64_t mask = vget_lane_u64 (vreinterpret_u64_u8
+         (vshrn_n_u16 (vreinterpretq_u16_u8 (eq), 4)), 0);
+
+        if (mask)
+            return i + (__builtin_ctzll (mask) >> 2);
+    }
+#endif
+
+    for (; i < length; i ++)
+    {
+        if (data[i] == 0xFF)
+            return i;
+    }
+
+    return length;
+}
+
 /* Searches <length> bytes of data for an ADTS header.  Returns the offset of
  * the first header or -1 if none is found.  Sets <size> to the length of the
  * frame. */
 static int find_aac_header (unsigned char * data, int length, int * size)
 {
-    int offset, a, b;
+    int a, b;
 
-    for (offset = 0; offset <= length - 8; offset++)
+    for (int offset = find_sync_byte (data, 0, length); offset <= length - 8;
+     offset = find_sync_byte (data, offset + 1, length))
     {
-        if (data[offset] != 255)
-            continue;
-
         *size = aac_parse_frame (data + offset, &a, &b);
 
         if (*size < 8)
@@ -137,14 +182,35 @@ bool AACDecoder::is_our_file (const char * filename, VFSFile & stream)
 
 static int aac_probe (unsigned char * buf, int len)
 {
-    for (int i = 0; i <= len - 4; i ++)
+    int best = len;
+
+    for (int i = find_sync_byte (buf, 0, len); i <= len - 4;
+     i = find_sync_byte (buf, i + 1, len))
     {
-        if ((buf[i] == 0xff && (buf[i + 1] & 0xf6) == 0xf0) || ! strncmp
-         ((char *) buf + i, "ADIF", 4))
-            return i;
+        if ((buf[i + 1] & 0xf6) == 0xf0)
+        {
+            best = i;
+            break;
+        }
+    }
+
+    /* an ADIF header may still come first */
+    for (int i = 0; i <= best - 4; i ++)
+    {
+        const void * hit = memchr (buf + i, 'A', best - 3 - i);
+        if (! hit)
+            break;
+
+        i = (const unsigned char *) hit - buf;
+
+        if (! strncmp ((char *) buf + i, "ADIF", 4))
+        {
+            best = i;
+            break;
+        }
     }
 
-    return len;
+    return best;
 }
 
 /* Gets info (some approximated) from an AAC/ADTS file.  <length> is
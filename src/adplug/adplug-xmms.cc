@@ -94,8 +94,10 @@ const char * const AdPlugXMMS::exts[] = {
 
 /***** Defines *****/
 
-// Sound buffer size in samples
-#define SNDBUFSIZE	512
+// Sound buffer size in samples.  The OPL emulator renders whole blocks
+// between player ticks, so a larger buffer means fewer emulator calls and
+// fewer trips through write_audio() per second.
+#define SNDBUFSIZE	4096
 
 // 4 byte sample size (16 bit depth & stereo)
 #define SAMPLESIZE 4
@@ -282,11 +284,14 @@ bool AdPlugXMMS::play (const char * filename, VFSFile & fd)
         if (playing)
           time += (int) (1000 / plr.p->getrefresh ());
       }
-      i = std::min (towrite, (long) (toadd / plr.p->getrefresh () + 4) & ~3);
+      // cache the refresh rate; getrefresh() is a virtual call and the rate
+      // only changes on player ticks, not within a rendered block
+      float refresh = plr.p->getrefresh ();
+      i = std::min (towrite, (long) (toadd / refresh + 4) & ~3);
       opl->update ((short *) sndbufpos, i);
       sndbufpos += i * SAMPLESIZE;
       towrite -= i;
-      toadd -= (long) (plr.p->getrefresh () * i);
+      toadd -= (long) (refresh * i);
     }
 
     write_audio (sndbuf, SNDBUFSIZE * SAMPLESIZE);
@@ -24,6 +24,7 @@
 #include <libaudcore/drct.h>
 #include <libaudcore/i18n.h>
 #include <libaudcore/plugin.h>
+#include <libaudcore/probe.h>
 #include <libaudcore/hook.h>
 #include <libaudcore/templates.h>
 
@@ -67,6 +68,17 @@ public:
 
     void update_art ()
     {
+        String filename = aud_drct_get_filename ();
+        auto art = filename ? aud_art_request (filename, AUD_ART_FILE) : AudArtPtr ();
+        String art_file = String (art.file ());
+
+        /* consecutive songs from one album share the art file; keep the
+         * already decoded image and skip the redundant decode */
+        if (art_file && art_file == m_art_file && ! origPixmap.isNull ())
+            return;
+
+        m_art_file = art_file;
+
         origPixmap = QPixmap (audqt::art_request_current (0, 0));
         qreal r = qApp->devicePixelRatio ();
         origPixmap.setDevicePixelRatio (r);
@@ -78,6 +90,7 @@ public:
     {
         QLabel::clear ();
         origPixmap = QPixmap ();
+        m_art_file = String ();
     }
 
 protected:
@@ -112,6 +125,7 @@ private:
 
     QPixmap origPixmap;
     QSize origSize;
+    String m_art_file;
 
     void init ()
     {
@@ -17,10 +17,16 @@
  * the use of this software.
  */
 
+#include <pthread.h>
+
 #include <libaudcore/drct.h>
 #include <libaudcore/i18n.h>
+#include <libaudcore/mainloop.h>
 #include <libaudcore/plugin.h>
+#include <libaudcore/probe.h>
 #include <libaudcore/hook.h>
+#include <libaudcore/templates.h>
+#include <libaudcore/vfs.h>
 #include <libaudgui/libaudgui.h>
 #include <libaudgui/libaudgui-gtk.h>
 
@@ -42,18 +48,196 @@ public:
 
 EXPORT AlbumArtPlugin aud_plugin_instance;
 
-static void album_update (void *, GtkWidget * widget)
+/* images larger than this are downscaled while being decoded (the pixbuf
+ * loader hands the bound to the codec, so a huge JPEG never exists at full
+ * resolution in memory); the widget scales further down as needed */
+static constexpr int MaxArtSize = 1024;
+
+static String last_art_file;
+
+/* the decode worker; one latest-wins job, so a rapid series of track
+ * changes only ever decodes the most recent art */
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+static pthread_t thread;
+static bool running, quitting;
+static String next_file, done_file;
+static AudArtPtr next_art, done_art;
+static AudguiPixbuf done_pixbuf;
+static QueuedFunc queued;
+static GtkWidget * art_widget;
+
+static void size_prepared_cb (GdkPixbufLoader * loader, int width, int height, void *)
+{
+    if (width > MaxArtSize || height > MaxArtSize)
+    {
+        if (width > height)
+        {
+            height = aud::rescale (height, width, MaxArtSize);
+            width = MaxArtSize;
+        }
+        else
+        {
+            width = aud::rescale (width, height, MaxArtSize);
+            height = MaxArtSize;
+        }
+
+        gdk_pixbuf_loader_set_size (loader, aud::max (width, 1), aud::max (height, 1));
+    }
+}
+
+static AudguiPixbuf decode_bounded (const char * uri)
+{
+    VFSFile file (uri, "r");
+    Index<char> data = file ? file.read_all () : Index<char> ();
+    if (! data.len ())
+        return AudguiPixbuf ();
+
+    GdkPixbufLoader * loader = gdk_pixbuf_loader_new ();
+    g_signal_connect (loader, "size-prepared", (GCallback) size_prepared_cb, nullptr);
+
+    AudguiPixbuf pixbuf;
+
+    if (gdk_pixbuf_loader_write (loader, (const unsigned char *) data.begin (),
+     data.len (), nullptr) && gdk_pixbuf_loader_close (loader, nullptr))
+    {
+        GdkPixbuf * p = gdk_pixbuf_loader_get_pixbuf (loader);
+        if (p)
+            pixbuf = AudguiPixbuf ((GdkPixbuf *) g_object_ref (p));
+    }
+    else
+        gdk_pixbuf_loader_close (loader, nullptr);
+
+    g_object_unref (loader);
+    return pixbuf;
+}
+
+/* runs on the main loop */
+static void art_ready ()
 {
-    AudguiPixbuf pixbuf = audgui_pixbuf_request_current ();
+    pthread_mutex_lock (& mutex);
+    String art_file = std::move (done_file);
+    AudguiPixbuf pixbuf = std::move (done_pixbuf);
+    AudArtPtr art = std::move (done_art); /* released here, off the worker */
+    pthread_mutex_unlock (& mutex);
+
+    /* a newer track may have taken over in the meantime */
+    if (! art_widget || art_file != last_art_file)
+        return;
 
     if (! pixbuf)
         pixbuf = audgui_pixbuf_fallback ();
 
-    audgui_scaled_image_set (widget, pixbuf.get ());
+    audgui_scaled_image_set (art_widget, pixbuf.get ());
+}
+
+static void * worker_cb (void *)
+{
+    pthread_mutex_lock (& mutex);
+
+    while (! quitting)
+    {
+        if (! next_file)
+        {
+            pthread_cond_wait (& cond, & mutex);
+            continue;
+        }
+
+        String art_file = std::move (next_file);
+        AudArtPtr art = std::move (next_art);
+
+        pthread_mutex_unlock (& mutex);
+        AudguiPixbuf pixbuf = decode_bounded (art_file);
+        pthread_mutex_lock (& mutex);
+
+        if (quitting)
+            break;
+
+        done_file = std::move (art_file);
+        done_art = std::move (art);
+        done_pixbuf = std::move (pixbuf);
+        queued.queue (art_ready);
+    }
+
+    pthread_mutex_unlock (& mutex);
+    return nullptr;
+}
+
+static void worker_stop ()
+{
+    pthread_mutex_lock (& mutex);
+    quitting = true;
+    next_file = String ();
+    next_art = AudArtPtr ();
+    pthread_cond_signal (& cond);
+    pthread_mutex_unlock (& mutex);
+
+    if (running)
+    {
+        pthread_join (thread, nullptr);
+        running = false;
+    }
+
+    queued.stop ();
+    done_file = String ();
+    done_art = AudArtPtr ();
+    done_pixbuf = AudguiPixbuf ();
+    quitting = false;
+}
+
+static void album_update (void *, GtkWidget * widget)
+{
+    String filename = aud_drct_get_filename ();
+    auto art = filename ? aud_art_request (filename, AUD_ART_FILE) : AudArtPtr ();
+    String art_file = String (art.file ());
+
+    /* consecutive songs from one album share the art file; the image shown
+     * is already correct, so skip the redundant decode and rescale */
+    if (art_file && art_file == last_art_file)
+        return;
+
+    last_art_file = art_file;
+
+    if (! art_file)
+    {
+        audgui_scaled_image_set (widget, audgui_pixbuf_fallback ().get ());
+        return;
+    }
+
+    /* hand the decode to the worker; the previous image stays up for the
+     * moment it takes, so the track change itself never waits */
+    pthread_mutex_lock (& mutex);
+
+    next_file = std::move (art_file);
+    next_art = std::move (art); /* keeps the extracted file alive */
+
+    if (! running && ! pthread_create (& thread, nullptr, worker_cb, nullptr))
+        running = true;
+
+    pthread_cond_signal (& cond);
+    pthread_mutex_unlock (& mutex);
+
+    /* no worker to be had; decode on the spot rather than showing nothing */
+    if (! running)
+    {
+        pthread_mutex_lock (& mutex);
+        String file = std::move (next_file);
+        next_art = AudArtPtr ();
+        pthread_mutex_unlock (& mutex);
+
+        if (file)
+        {
+            AudguiPixbuf pixbuf = decode_bounded (file);
+            if (! pixbuf)
+                pixbuf = audgui_pixbuf_fallback ();
+            audgui_scaled_image_set (widget, pixbuf.get ());
+        }
+    }
 }
 
 static void album_clear (void *, GtkWidget * widget)
 {
+    last_art_file = String ();
     audgui_scaled_image_set (widget, nullptr);
 }
 
@@ -62,6 +246,9 @@ static void album_cleanup (GtkWidget * widget)
     hook_dissociate ("playback ready", (HookFunction) album_update, widget);
     hook_dissociate ("playback stop", (HookFunction) album_clear, widget);
 
+    worker_stop ();
+    art_widget = nullptr;
+    last_art_file = String ();
     audgui_cleanup ();
 }
 
@@ -70,6 +257,7 @@ void * AlbumArtPlugin::get_gtk_widget ()
     audgui_init ();
 
     GtkWidget * widget = audgui_scaled_image_new (nullptr);
+    art_widget = widget;
 
     g_signal_connect (widget, "destroy", (GCallback) album_cleanup, nullptr);
 
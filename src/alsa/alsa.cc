@@ -41,7 +41,9 @@
 #include <errno.h>
 #include <poll.h>
 #include <pthread.h>
+#include <sched.h>
 #include <stdint.h>
+#include <string.h>
 #include <time.h>
 #include <unistd.h>
 
@@ -49,6 +51,7 @@
 #include <libaudcore/ringbuf.h>
 
 #include "alsa.h"
+#include "../ui-common/output-stats.h"
 
 EXPORT ALSAPlugin aud_plugin_instance;
 
@@ -56,6 +59,8 @@ EXPORT ALSAPlugin aud_plugin_instance;
 do { \
     (value) = function (__VA_ARGS__); \
     if ((value) < 0) { \
+        if ((value) == -EPIPE) \
+            alsa_stats.underruns ++; \
         CHECK (snd_pcm_recover, alsa_handle, (value), 0); \
         CHECK_VAL ((value), function, __VA_ARGS__); \
     } \
@@ -68,11 +73,17 @@ do { \
 } while (0)
 
 static snd_pcm_t * alsa_handle;
+
+/* cumulative write-path counters; protected by alsa_mutex */
+static OutputStats alsa_stats;
 static pthread_mutex_t alsa_mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_cond_t alsa_cond = PTHREAD_COND_INITIALIZER;
 
 static snd_pcm_format_t alsa_format;
 static int alsa_channels, alsa_rate;
+static int alsa_hard_buffer; /* milliseconds */
+static bool alsa_mmap;
+static String alsa_pcm;
 
 static RingBuf<char> alsa_buffer;
 static int alsa_period; /* milliseconds */
@@ -90,6 +101,33 @@ static pthread_t pump_thread;
 static snd_mixer_t * alsa_mixer;
 static snd_mixer_elem_t * alsa_mixer_element;
 
+/* secondary PCM devices for multi-sink playback */
+struct SecondaryDevice
+{
+    String name;
+    snd_pcm_t * handle;
+};
+
+static Index<SecondaryDevice> alsa_secondary;
+
+/* PCM handle parked across track transitions so that reopening with the same
+ * device and format can skip snd_pcm_open() and the hw_params probing loop */
+static snd_pcm_t * parked_handle;
+static String parked_pcm;
+static snd_pcm_format_t parked_format;
+static int parked_channels, parked_rate;
+static int parked_period, parked_hard_buffer; /* milliseconds */
+static bool parked_mmap;
+
+static void park_discard ()
+{
+    if (parked_handle)
+    {
+        snd_pcm_close (parked_handle);
+        parked_handle = nullptr;
+    }
+}
+
 static bool poll_setup ()
 {
     if (pipe (poll_pipe))
@@ -146,8 +184,169 @@ static void poll_cleanup ()
     delete[] poll_handles;
 }
 
+/* Opens each device listed in the "pcm-extra" option with the same format as
+ * the primary device.  Failures are logged and the device skipped; multi-sink
+ * playback is best-effort. */
+static void secondary_open_all ()
+{
+    String list = aud_get_str ("alsa", "pcm-extra");
+    if (! list[0])
+        return;
+
+    for (const String & name : str_list_to_index (list, ";,"))
+    {
+        snd_pcm_t * handle = nullptr;
+        snd_pcm_hw_params_t * params;
+        unsigned useconds;
+        int direction;
+
+        AUDINFO ("Opening secondary PCM device %s.\n", (const char *) name);
+        CHECK (snd_pcm_open, & handle, name, SND_PCM_STREAM_PLAYBACK, SND_PCM_NONBLOCK);
+
+        snd_pcm_hw_params_alloca (& params);
+        CHECK (snd_pcm_hw_params_any, handle, params);
+        CHECK (snd_pcm_hw_params_set_access, handle, params, SND_PCM_ACCESS_RW_INTERLEAVED);
+        CHECK (snd_pcm_hw_params_set_format, handle, params, alsa_format);
+        CHECK (snd_pcm_hw_params_set_channels, handle, params, alsa_channels);
+        CHECK (snd_pcm_hw_params_set_rate, handle, params, alsa_rate, 0);
+
+        useconds = 1000 * aud::min (1000, aud_get_int ("output_buffer_size") / 2);
+        direction = 0;
+        CHECK (snd_pcm_hw_params_set_buffer_time_near, handle, params, & useconds, & direction);
+
+        useconds = 1000 * alsa_period;
+        direction = 0;
+        CHECK (snd_pcm_hw_params_set_period_time_near, handle, params, & useconds, & direction);
+
+        CHECK (snd_pcm_hw_params, handle, params);
+
+        alsa_secondary.append (name, handle);
+        continue;
+
+    FAILED:
+        if (handle)
+            snd_pcm_close (handle);
+    }
+}
+
+static void secondary_close_all ()
+{
+    for (SecondaryDevice & dev : alsa_secondary)
+        snd_pcm_close (dev.handle);
+
+    alsa_secondary.clear ();
+}
+
+/* Fans the frames just written to the primary device out to each secondary
+ * device.  Each secondary is nudged back into phase with the primary using
+ * the queue lengths reported by snd_pcm_delay(): excess queued frames are
+ * rewound away, a deficit is padded with silence.  The devices are opened
+ * non-blocking, so a slow device cannot stall the pump; any short write is
+ * corrected by the next drift check. */
+static void secondary_write (int frames)
+{
+    snd_pcm_sframes_t main_delay = 0;
+    snd_pcm_delay (alsa_handle, & main_delay);
+
+    int tolerance = aud::rescale (alsa_period, 1000, alsa_rate);
+
+    for (SecondaryDevice & dev : alsa_secondary)
+    {
+        snd_pcm_sframes_t delay = 0;
+
+        if (snd_pcm_state (dev.handle) == SND_PCM_STATE_RUNNING &&
+         ! snd_pcm_delay (dev.handle, & delay))
+        {
+            if (delay > main_delay + tolerance)
+                snd_pcm_rewind (dev.handle, delay - main_delay);
+            else if (delay < main_delay - tolerance)
+            {
+                int pad = main_delay - delay;
+                Index<char> silence;
+                silence.insert (0, snd_pcm_frames_to_bytes (dev.handle, pad));
+                snd_pcm_writei (dev.handle, silence.begin (), pad);
+            }
+        }
+
+        int written = snd_pcm_writei (dev.handle, & alsa_buffer[0], frames);
+        if (written < 0 && written != -EAGAIN)
+        {
+            snd_pcm_recover (dev.handle, written, 1);
+            snd_pcm_writei (dev.handle, & alsa_buffer[0], frames);
+        }
+    }
+}
+
+/* Writes frames from the soft buffer directly into the mapped DMA buffer,
+ * avoiding the staging copy made by snd_pcm_writei().  Returns the number of
+ * frames committed, or a negative error code as snd_pcm_writei() would. */
+static int write_mmap (int frames)
+{
+    const snd_pcm_channel_area_t * areas;
+    snd_pcm_uframes_t offset, request = frames;
+
+    int error = snd_pcm_mmap_begin (alsa_handle, & areas, & offset, & request);
+    if (error < 0)
+        return error;
+
+    /* interleaved access; all channels share one contiguous area */
+    char * dest = (char *) areas[0].addr + (areas[0].first +
+     offset * areas[0].step) / 8;
+    memcpy (dest, & alsa_buffer[0], snd_pcm_frames_to_bytes (alsa_handle, request));
+
+    snd_pcm_sframes_t committed = snd_pcm_mmap_commit (alsa_handle, offset, request);
+    if (committed < 0)
+        return committed;
+
+    /* unlike snd_pcm_writei(), committing mapped frames does not start the
+     * stream automatically */
+    if (committed > 0 && snd_pcm_state (alsa_handle) == SND_PCM_STATE_PREPARED)
+    {
+        error = snd_pcm_start (alsa_handle);
+        if (error < 0)
+            return error;
+    }
+
+    return committed;
+}
+
+/* Apply the configured scheduling policy to the calling (pump) thread.
+ * Pinning the pump to one core keeps its working set in that core's cache,
+ * and SCHED_RR lets it meet period deadlines under load.  Both need
+ * privileges (CAP_SYS_NICE or an RLIMIT_RTPRIO grant), so failure is only
+ * logged and playback carries on with default scheduling. */
+static void pump_set_scheduling ()
+{
+    int cpu = aud_get_int ("alsa", "pump-cpu");
+    if (cpu >= 0)
+    {
+        cpu_set_t set;
+        CPU_ZERO (& set);
+        CPU_SET (cpu, & set);
+
+        int error = pthread_setaffinity_np (pthread_self (), sizeof set, & set);
+        if (error)
+            AUDWARN ("Cannot pin pump thread to CPU %d: %s.\n", cpu, strerror (error));
+    }
+
+    int prio = aud_get_int ("alsa", "pump-rt-prio");
+    if (prio > 0)
+    {
+        sched_param param;
+        param.sched_priority = aud::clamp (prio,
+         sched_get_priority_min (SCHED_RR), sched_get_priority_max (SCHED_RR));
+
+        int error = pthread_setschedparam (pthread_self (), SCHED_RR, & param);
+        if (error)
+            AUDWARN ("Cannot set realtime priority %d: %s.\n",
+             param.sched_priority, strerror (error));
+    }
+}
+
 static void * pump (void *)
 {
+    pump_set_scheduling ();
+
     pthread_mutex_lock (& alsa_mutex);
 
     bool failed_once = false;
@@ -171,12 +370,24 @@ static void * pump (void *)
         {
             wakeups_since_write = 0;
 
+            uint64_t begin = output_stats_now ();
+
             int written;
-            CHECK_VAL_RECOVER (written, snd_pcm_writei, alsa_handle,
-             & alsa_buffer[0], aud::min (writable, avail));
+            if (alsa_mmap)
+                CHECK_VAL_RECOVER (written, write_mmap, aud::min (writable, avail));
+            else
+                CHECK_VAL_RECOVER (written, snd_pcm_writei, alsa_handle,
+                 & alsa_buffer[0], aud::min (writable, avail));
 
             failed_once = false;
 
+            alsa_stats.blocks ++;
+            alsa_stats.frames += written;
+            alsa_stats.busy_ns += output_stats_now () - begin;
+
+            if (alsa_secondary.len ())
+                secondary_write (written);
+
             alsa_buffer.discard (snd_pcm_frames_to_bytes (alsa_handle, written));
 
             pthread_cond_broadcast (& alsa_cond); /* signal write complete */
@@ -240,6 +451,10 @@ static void pump_stop ()
 static void start_playback ()
 {
     AUDDBG ("Starting playback.\n");
+
+    for (SecondaryDevice & dev : alsa_secondary)
+        snd_pcm_prepare (dev.handle);
+
     CHECK (snd_pcm_prepare, alsa_handle);
 
 FAILED:
@@ -267,6 +482,7 @@ bool ALSAPlugin::init ()
 void ALSAPlugin::cleanup ()
 {
     AUDDBG ("Cleanup.\n");
+    park_discard ();
     close_mixer ();
 }
 
@@ -328,6 +544,28 @@ bool ALSAPlugin::open_audio (int aud_format, int rate, int channels, String & er
         goto FAILED;
     }
 
+    alsa_format = format;
+    alsa_channels = channels;
+    alsa_rate = rate;
+    alsa_pcm = pcm;
+
+    if (parked_handle && pcm == parked_pcm && format == parked_format &&
+     channels == parked_channels && rate == parked_rate &&
+     parked_mmap == aud_get_bool ("alsa", "use-mmap"))
+    {
+        AUDINFO ("Reusing previously negotiated PCM device %s.\n", (const char *) pcm);
+
+        alsa_handle = parked_handle;
+        parked_handle = nullptr;
+
+        alsa_mmap = parked_mmap;
+        alsa_period = parked_period;
+        alsa_hard_buffer = parked_hard_buffer;
+        goto NEGOTIATED;
+    }
+
+    park_discard ();
+
     AUDINFO ("Opening PCM device %s for %s, %d channels, %d Hz.\n",
      (const char *) pcm, snd_pcm_format_name (format), channels, rate);
     CHECK_STR (error, snd_pcm_open, & alsa_handle, pcm, SND_PCM_STREAM_PLAYBACK, 0);
@@ -335,17 +573,18 @@ bool ALSAPlugin::open_audio (int aud_format, int rate, int channels, String & er
     snd_pcm_hw_params_t * params;
     snd_pcm_hw_params_alloca (& params);
     CHECK_STR (error, snd_pcm_hw_params_any, alsa_handle, params);
-    CHECK_STR (error, snd_pcm_hw_params_set_access, alsa_handle, params,
-     SND_PCM_ACCESS_RW_INTERLEAVED);
+
+    alsa_mmap = aud_get_bool ("alsa", "use-mmap") && ! snd_pcm_hw_params_set_access
+     (alsa_handle, params, SND_PCM_ACCESS_MMAP_INTERLEAVED);
+
+    if (! alsa_mmap)
+        CHECK_STR (error, snd_pcm_hw_params_set_access, alsa_handle, params,
+         SND_PCM_ACCESS_RW_INTERLEAVED);
 
     CHECK_STR (error, snd_pcm_hw_params_set_format, alsa_handle, params, format);
     CHECK_STR (error, snd_pcm_hw_params_set_channels, alsa_handle, params, channels);
     CHECK_STR (error, snd_pcm_hw_params_set_rate, alsa_handle, params, rate, 0);
 
-    alsa_format = format;
-    alsa_channels = channels;
-    alsa_rate = rate;
-
     total_buffer = aud_get_int ("output_buffer_size");
     useconds = 1000 * aud::min (1000, total_buffer / 2);
     direction = 0;
@@ -360,10 +599,14 @@ bool ALSAPlugin::open_audio (int aud_format, int rate, int channels, String & er
     alsa_period = useconds / 1000;
 
     CHECK_STR (error, snd_pcm_hw_params, alsa_handle, params);
+    alsa_hard_buffer = hard_buffer;
 
+NEGOTIATED:
+    total_buffer = aud_get_int ("output_buffer_size");
+    hard_buffer = alsa_hard_buffer;
     soft_buffer = aud::max (total_buffer / 2, total_buffer - hard_buffer);
-    AUDINFO ("Buffer: hardware %d ms, software %d ms, period %d ms.\n",
-     hard_buffer, soft_buffer, alsa_period);
+    AUDINFO ("Buffer: hardware %d ms, software %d ms, period %d ms (%s access).\n",
+     hard_buffer, soft_buffer, alsa_period, alsa_mmap ? "mmap" : "read/write");
 
     buffer_frames = aud::rescale<int64_t> (soft_buffer, 1000, rate);
     alsa_buffer.alloc (snd_pcm_frames_to_bytes (alsa_handle, buffer_frames));
@@ -375,6 +618,8 @@ bool ALSAPlugin::open_audio (int aud_format, int rate, int channels, String & er
     if (! poll_setup ())
         goto FAILED;
 
+    secondary_open_all ();
+
     pump_start ();
 
     pthread_mutex_unlock (& alsa_mutex);
@@ -399,17 +644,46 @@ void ALSAPlugin::close_audio ()
     assert (alsa_handle);
 
     pump_stop ();
+    secondary_close_all ();
     CHECK (snd_pcm_drop, alsa_handle);
 
 FAILED:
     alsa_buffer.destroy ();
     poll_cleanup ();
-    snd_pcm_close (alsa_handle);
+
+    /* park the handle for a possible same-format reopen */
+    park_discard ();
+    parked_handle = alsa_handle;
+    parked_pcm = alsa_pcm;
+    parked_format = alsa_format;
+    parked_channels = alsa_channels;
+    parked_rate = alsa_rate;
+    parked_period = alsa_period;
+    parked_hard_buffer = alsa_hard_buffer;
+    parked_mmap = alsa_mmap;
+
     alsa_handle = nullptr;
 
     pthread_mutex_unlock (& alsa_mutex);
 }
 
+int ALSAPlugin::take_message (const char * code, const void * data, int size)
+{
+    if (! strcmp (code, OUTPUT_STATS_QUERY) && size == sizeof (OutputStats))
+    {
+        pthread_mutex_lock (& alsa_mutex);
+
+        alsa_stats.buffer_fill = alsa_buffer.size () ?
+         alsa_buffer.len () * 100 / alsa_buffer.size () : 0;
+        * (OutputStats *) data = alsa_stats;
+
+        pthread_mutex_unlock (& alsa_mutex);
+        return 0;
+    }
+
+    return -1;
+}
+
 int ALSAPlugin::write_audio (const void * data, int length)
 {
     pthread_mutex_lock (& alsa_mutex);
@@ -509,6 +783,9 @@ void ALSAPlugin::flush ()
     AUDDBG ("Seek requested; discarding buffer.\n");
     pthread_mutex_lock (& alsa_mutex);
 
+    for (SecondaryDevice & dev : alsa_secondary)
+        snd_pcm_drop (dev.handle);
+
     CHECK (snd_pcm_drop, alsa_handle);
 
 FAILED:
@@ -529,6 +806,14 @@ void ALSAPlugin::pause (bool pause)
 
     alsa_paused = pause;
 
+    for (SecondaryDevice & dev : alsa_secondary)
+    {
+        if (pause)
+            snd_pcm_drop (dev.handle);
+        else
+            snd_pcm_prepare (dev.handle);
+    }
+
     if (! alsa_prebuffer)
     {
         if (pause)
@@ -87,6 +87,8 @@ public:
     void pause (bool pause) override;
     void flush () override;
 
+    int take_message (const char * code, const void * data, int size) override;
+
 private:
     static void open_mixer ();
     static void close_mixer ();
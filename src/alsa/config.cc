@@ -241,6 +241,10 @@ static void guess_element ()
 const char * const ALSAPlugin::defaults[] = {
     "pcm", "default",
     "mixer", "default",
+    "pcm-extra", "",
+    "use-mmap", "TRUE",
+    "pump-cpu", "-1",
+    "pump-rt-prio", "0",
     nullptr
 };
 
@@ -301,7 +305,18 @@ const PreferencesWidget ALSAPlugin::widgets[] = {
         {nullptr, mixer_combo_fill}),
     WidgetCombo (N_("Mixer element:"),
         WidgetString ("alsa", "mixer-element", element_changed, "alsa mixer changed"),
-        {nullptr, element_combo_fill})
+        {nullptr, element_combo_fill}),
+    WidgetCheck (N_("Write through mmap when supported:"),
+        WidgetBool ("alsa", "use-mmap", pcm_changed)),
+    WidgetEntry (N_("Extra PCM devices (semicolon-separated):"),
+        WidgetString ("alsa", "pcm-extra", pcm_changed)),
+    WidgetLabel (N_("<b>Output Thread Scheduling</b>")),
+    WidgetSpin (N_("Pin to CPU core:"),
+        WidgetInt ("alsa", "pump-cpu", pcm_changed),
+        {-1, 255, 1, N_("(-1 = no pinning)")}),
+    WidgetSpin (N_("Realtime (SCHED_RR) priority:"),
+        WidgetInt ("alsa", "pump-rt-prio", pcm_changed),
+        {0, 99, 1, N_("(0 = normal scheduling)")})
 };
 
 static void alsa_prefs_init ()
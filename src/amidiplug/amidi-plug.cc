@@ -21,6 +21,7 @@
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include <libaudcore/runtime.h>
 #include <libaudcore/i18n.h>
@@ -98,6 +99,7 @@ bool AMIDIPlug::init ()
         "fsyn_synth_polyphony", "-1",
         "fsyn_synth_reverb", "-1",
         "fsyn_synth_chorus", "-1",
+        "fsyn_overload_cap", "TRUE",
         "skip_leading", "FALSE",
         "skip_trailing", "FALSE",
         nullptr
@@ -166,6 +168,24 @@ static int s_samplerate, s_channels;
 static int s_bufsize;
 static int16_t * s_buf;
 
+/* Render-load tracking.  The play loop renders as fast as the output
+ * accepts, so during light passages the synth naturally runs ahead by the
+ * whole output buffer; the danger is a dense passage draining that lead.
+ * Each chunk's render time is compared against the audio it produced, and
+ * when the smoothed ratio reaches real time the backend is told to shed
+ * load (see backend_overload).  The flag is cleared only after a sustained
+ * calm spell, so it does not flap around the threshold. */
+static double s_render_load;
+static int s_calm_chunks;
+static bool s_overloaded;
+
+static double now_seconds ()
+{
+    timespec ts;
+    clock_gettime (CLOCK_MONOTONIC, & ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
 bool AMIDIPlug::audio_init ()
 {
     int bitdepth;
@@ -177,9 +197,16 @@ bool AMIDIPlug::audio_init ()
 
     open_audio (FMT_S16_NE, s_samplerate, s_channels);
 
-    s_bufsize = 2 * s_channels * (s_samplerate / 4);
+    /* render in 50 ms chunks: small enough that the output buffer is topped
+     * off continuously and the load estimate reacts before it runs dry */
+    s_bufsize = 2 * s_channels * (s_samplerate / 20);
     s_buf = new int16_t[s_bufsize / 2];
 
+    s_render_load = 0;
+    s_calm_chunks = 0;
+    s_overloaded = false;
+    backend_overload (false);
+
     return true;
 }
 
@@ -191,7 +218,34 @@ void AMIDIPlug::audio_generate (double seconds)
     {
         int chunk = (total < s_bufsize) ? total : s_bufsize;
 
+        double begin = now_seconds ();
         backend_generate_audio (s_buf, chunk);
+
+        double real = (double) chunk / (2 * s_channels) / s_samplerate;
+        double load = (now_seconds () - begin) / real;
+        s_render_load = s_render_load ? 0.8 * s_render_load + 0.2 * load : load;
+
+        if (! s_overloaded)
+        {
+            if (s_render_load >= 0.95)
+            {
+                backend_overload (true);
+                s_overloaded = true;
+                s_calm_chunks = 0;
+            }
+        }
+        else if (s_render_load < 0.6)
+        {
+            /* two seconds of headroom before restoring full quality */
+            if (++ s_calm_chunks >= 40)
+            {
+                backend_overload (false);
+                s_overloaded = false;
+            }
+        }
+        else
+            s_calm_chunks = 0;
+
         write_audio (s_buf, chunk);
 
         total -= chunk;
@@ -200,6 +254,7 @@ void AMIDIPlug::audio_generate (double seconds)
 
 void AMIDIPlug::audio_cleanup ()
 {
+    backend_overload (false);
     delete[] s_buf;
 }
 
@@ -252,7 +307,7 @@ void AMIDIPlug::play_loop (midifile_t & midifile)
 
     /* initialize current position in each track */
     for (midifile_track_t & track : midifile.tracks)
-        track.current_event = track.events.head ();
+        track.current_event = track.head ();
 
     while (! (stopped = check_stop ()))
     {
@@ -281,7 +336,7 @@ void AMIDIPlug::play_loop (midifile_t & midifile)
             break; /* end of song reached */
 
         /* advance pointer to next event */
-        event_track->current_event = event_track->events.next (event);
+        event_track->current_event = event_track->next (event);
 
         if (event->tick > tick)
         {
@@ -364,7 +419,7 @@ int AMIDIPlug::skip_to (midifile_t & midifile, int seektime)
 
     /* initialize current position in each track */
     for (midifile_track_t & track : midifile.tracks)
-        track.current_event = track.events.head ();
+        track.current_event = track.head ();
 
     for (;;)
     {
@@ -400,7 +455,7 @@ int AMIDIPlug::skip_to (midifile_t & midifile, int seektime)
         }
 
         /* advance pointer to next event */
-        event_track->current_event = event_track->events.next (event);
+        event_track->current_event = event_track->next (event);
 
         switch (event->type)
         {
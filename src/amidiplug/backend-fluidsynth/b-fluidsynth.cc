@@ -36,6 +36,10 @@ typedef struct
     fluid_synth_t * synth;
 
     Index<int> soundfont_ids;
+
+    /* emergency polyphony cap state; see backend_overload() */
+    bool overloaded;
+    int saved_polyphony;
 }
 sequencer_client_t;
 
@@ -70,6 +74,7 @@ void backend_init ()
         fluid_settings_setint (sc.settings, "synth.chorus.active", chorus);
 
     sc.synth = new_fluid_synth (sc.settings);
+    sc.overloaded = false;
 
     /* load soundfonts */
     i_soundfont_load();
@@ -186,6 +191,37 @@ void backend_generate_audio (void * buf, int bufsize)
 }
 
 
+/* Polyphony spikes (large chords with heavy soundfonts) can make rendering
+ * slower than real time.  When the player reports that it has fallen
+ * behind, cap the voice count hard so rendering can catch up before the
+ * output buffer runs dry; the cap is lifted once playback has recovered.
+ * Voice stealing makes the cap itself inaudible next to an underrun. */
+void backend_overload (bool overloaded)
+{
+    if (overloaded == sc.overloaded)
+        return;
+
+    if (overloaded)
+    {
+        if (! aud_get_bool ("amidiplug", "fsyn_overload_cap"))
+            return;
+
+        sc.saved_polyphony = fluid_synth_get_polyphony (sc.synth);
+        int cap = aud::max (sc.saved_polyphony / 4, 32);
+
+        AUDDBG ("rendering fell behind, capping polyphony at %d voices\n", cap);
+        fluid_synth_set_polyphony (sc.synth, cap);
+    }
+    else
+    {
+        AUDDBG ("rendering caught up, restoring %d voices\n", sc.saved_polyphony);
+        fluid_synth_set_polyphony (sc.synth, sc.saved_polyphony);
+    }
+
+    sc.overloaded = overloaded;
+}
+
+
 void backend_audio_info (int * channels, int * bitdepth, int * samplerate)
 {
     *channels = 2;
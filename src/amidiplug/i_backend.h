@@ -30,6 +30,10 @@ void backend_reset ();
 void backend_audio_info (int *, int *, int *);
 void backend_generate_audio (void * buf, int bufsize);
 
+/* notifies the backend that rendering has fallen behind real time (or has
+ * caught back up), so it can trade voices for speed */
+void backend_overload (bool overloaded);
+
 void seq_event_noteon (midievent_t *);
 void seq_event_noteoff (midievent_t *);
 void seq_event_allnoteoff (int);
@@ -148,6 +148,8 @@ static const PreferencesWidget amidiplug_widgets[] = {
     WidgetLabel (N_("<b>Synthesizer</b>")),
     WidgetBox ({{gain_widgets}, true}),
     WidgetBox ({{polyphony_widgets}, true}),
+    WidgetCheck (N_("Reduce polyphony when rendering falls behind"),
+        WidgetBool ("amidiplug", "fsyn_overload_cap")),
     WidgetBox ({{reverb_widgets}, true}),
     WidgetBox ({{chorus_widgets}, true}),
     WidgetSpin (N_("Sample rate:"),
@@ -71,7 +71,7 @@ void i_fileinfo_text_fill (midifile_t * mf, GtkTextBuffer * text_tb, GtkTextBuff
 {
     /* initialize current position in each track */
     for (midifile_track_t & track : mf->tracks)
-        track.current_event = track.events.head ();
+        track.current_event = track.head ();
 
     for (;;)
     {
@@ -96,7 +96,7 @@ void i_fileinfo_text_fill (midifile_t * mf, GtkTextBuffer * text_tb, GtkTextBuff
             break; /* end of song reached */
 
         /* advance pointer to next event */
-        event_track->current_event = event_track->events.next (event);
+        event_track->current_event = event_track->next (event);
 
         switch (event->type)
         {
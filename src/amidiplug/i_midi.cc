@@ -23,7 +23,11 @@
 
 #include "i_midi.h"
 
+#include <inttypes.h>
+#include <pthread.h>
+
 #include <libaudcore/audstrings.h>
+#include <libaudcore/multihash.h>
 #include <libaudcore/runtime.h>
 #include <libaudcore/vfs.h>
 
@@ -102,6 +106,30 @@ int midifile_t::read_var ()
 {
     int value, c;
 
+    /* fast path: with at least four bytes in view, decode straight from the
+     * buffer without per-byte bounds checks (a valid number is at most four
+     * bytes, and this covers nearly every delta time in a file) */
+    if (file_offset + 4 <= file_data.len ())
+    {
+        const unsigned char * p = (const unsigned char *) & file_data[file_offset];
+
+        value = p[0] & 0x7f;
+        if (! (p[0] & 0x80))
+            { file_offset += 1; return value; }
+
+        value = (value << 7) | (p[1] & 0x7f);
+        if (! (p[1] & 0x80))
+            { file_offset += 2; return value; }
+
+        value = (value << 7) | (p[2] & 0x7f);
+        if (! (p[2] & 0x80))
+            { file_offset += 3; return value; }
+
+        value = (value << 7) | p[3];
+        file_offset += 4;
+        return (p[3] & 0x80) ? -1 : value;
+    }
+
     c = read_byte ();
     value = c & 0x7f;
 
@@ -593,7 +621,7 @@ void midifile_t::setget_length ()
 
     /* initialize current position in each track */
     for (midifile_track_t & track : tracks)
-        track.current_event = track.events.head ();
+        track.current_event = track.head ();
 
     /* search for tempo events in each track; in fact, since the program
        currently supports type 0 and type 1 MIDI files, we should find
@@ -627,7 +655,7 @@ void midifile_t::setget_length ()
         }
 
         /* advance pointer to next event */
-        event_track->current_event = event_track->events.next (event);
+        event_track->current_event = event_track->next (event);
 
         /* check if this is a tempo event */
         if (event->type == SND_SEQ_EVENT_TEMPO)
@@ -668,7 +696,7 @@ void midifile_t::get_bpm (int * bpm, int * wavg_bpm)
 
     /* initialize current position in each track */
     for (midifile_track_t & track : tracks)
-        track.current_event = track.events.head ();
+        track.current_event = track.head ();
 
     /* search for tempo events in each track; in fact, since the program
        currently supports type 0 and type 1 MIDI files, we should find
@@ -705,7 +733,7 @@ void midifile_t::get_bpm (int * bpm, int * wavg_bpm)
         }
 
         /* advance pointer to next event */
-        event_track->current_event = event_track->events.next (event);
+        event_track->current_event = event_track->next (event);
 
         /* check if this is a tempo event */
         if (event->type == SND_SEQ_EVENT_TEMPO)
@@ -745,11 +773,74 @@ void midifile_t::get_bpm (int * bpm, int * wavg_bpm)
 }
 
 
+/* Parsed-file cache, so that looping a playlist does not re-parse each file
+ * on every repeat.  Entries are keyed by filename plus file size (the VFS
+ * layer does not expose modification times) plus the option values that are
+ * baked into the parsed events, so changing e.g. the transpose setting
+ * simply misses the cache.  Playback mutates its copy of the sequence, so
+ * hits are served by copying the cached tracks, which is just a handful of
+ * block copies now that each track is contiguous. */
+
+static pthread_mutex_t cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static SimpleHash<String, midifile_t> parse_cache;
+static int parse_cache_entries = 0;
+
+void midifile_t::copy_from (const midifile_t & other)
+{
+    tracks.clear ();
+    tracks.insert (0, other.tracks.len ());
+
+    for (int i = 0; i < other.tracks.len (); i ++)
+    {
+        const midifile_track_t & src = other.tracks[i];
+        midifile_track_t & dst = tracks[i];
+
+        dst.events.insert (src.events.begin (), 0, src.events.len ());
+        dst.start_tick = src.start_tick;
+        dst.end_tick = src.end_tick;
+        dst.current_event = nullptr;
+    }
+
+    format = other.format;
+    start_tick = other.start_tick;
+    max_tick = other.max_tick;
+    smpte_timing = other.smpte_timing;
+    time_division = other.time_division;
+    ppq = other.ppq;
+    current_tempo = other.current_tempo;
+    avg_microsec_per_tick = other.avg_microsec_per_tick;
+    length = other.length;
+}
+
 /* helper function that parses a midi file; returns 1 on success, 0 otherwise */
 bool midifile_t::parse_from_file (const char * filename, VFSFile & file)
 {
     bool success = false;
 
+    String cache_key;
+    int64_t size = file.fsize ();
+
+    if (size >= 0)
+    {
+        cache_key = String (str_printf ("%s:%" PRId64 ":%d:%d:%d:%d", filename,
+         size, aud_get_int ("amidiplug", "ap_opts_transpose_value"),
+         aud_get_int ("amidiplug", "ap_opts_drumshift_value"),
+         (int) aud_get_bool ("amidiplug", "skip_leading"),
+         (int) aud_get_bool ("amidiplug", "skip_trailing")));
+
+        pthread_mutex_lock (& cache_mutex);
+        midifile_t * cached = parse_cache.lookup (cache_key);
+
+        if (cached)
+        {
+            copy_from (* cached);
+            pthread_mutex_unlock (& cache_mutex);
+            return true;
+        }
+
+        pthread_mutex_unlock (& cache_mutex);
+    }
+
     file_name = String (filename);
     file_data = file.read_all ();
 
@@ -793,5 +884,26 @@ bool midifile_t::parse_from_file (const char * filename, VFSFile & file)
     file_name = String ();
     file_data.clear ();
 
+    if (success && cache_key)
+    {
+        pthread_mutex_lock (& cache_mutex);
+
+        if (! parse_cache.lookup (cache_key))
+        {
+            /* primitive size cap; parsed sequences are sizable, so keep only
+             * a playlist's worth and drop the lot once in a while */
+            if (parse_cache_entries >= 8)
+            {
+                parse_cache.clear ();
+                parse_cache_entries = 0;
+            }
+
+            parse_cache.add (cache_key, midifile_t ())->copy_from (* this);
+            parse_cache_entries ++;
+        }
+
+        pthread_mutex_unlock (& cache_mutex);
+    }
+
     return success;
 }
@@ -229,20 +229,21 @@ enum snd_seq_event_type
 
 struct midifile_track_t
 {
-    List<midievent_t> events;           /* list of all events in this track */
+    Index<midievent_t> events;          /* all events in this track, in order */
     int start_tick;                     /* start of this track */
     int end_tick;			/* length of this track */
     midievent_t * current_event;	/* used while loading and playing */
 
+    /* events live in one contiguous block per track, appended during
+     * loading and freed wholesale with the track */
     midievent_t * add_event ()
-    {
-        midievent_t * event = new midievent_t ();
-        events.append (event);
-        return event;
-    }
-
-    ~midifile_track_t ()
-        { events.clear (); }
+        { return & events.append (); }
+
+    midievent_t * head ()
+        { return events.len () ? events.begin () : nullptr; }
+
+    midievent_t * next (midievent_t * event)
+        { return (event + 1 < events.end ()) ? event + 1 : nullptr; }
 };
 
 
@@ -266,6 +267,8 @@ struct midifile_t
     bool parse_from_file (const char *, VFSFile & file);
 
 private:
+    void copy_from (const midifile_t & other);
+
     String file_name;
     Index<char> file_data;
     int file_offset = 0;
@@ -21,10 +21,9 @@
 #ifndef _I_MIDIEVENT_H
 #define _I_MIDIEVENT_H 1
 
-#include <libaudcore/list.h>
 #include <libaudcore/objects.h>
 
-struct midievent_t : public ListNode
+struct midievent_t
 {
     unsigned char type;				/* SND_SEQ_EVENT_xxx */
     unsigned char port;				/* port index */
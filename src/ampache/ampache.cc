@@ -13,7 +13,8 @@
 #include <libaudcore/runtime.h>
 #include <libaudcore/plugin.h>
 #include <libaudcore/playlist.h>
-#include <libaudcore/vfs_async.h>
+
+#include "../fetch-common/fetch.h"
 
 #include <ampache_browser/settings.h>
 #include <ampache_browser/ampache_browser.h>
@@ -39,6 +40,7 @@ public:
 
     constexpr AmpacheBrowserPlugin(): GeneralPlugin(pluginInfo, false) {}
 
+    void cleanup() override;
     void* get_qt_widget() override;
 };
 
@@ -50,6 +52,11 @@ const char AmpacheBrowserPlugin::about[] =
 
 static SmartPtr<ampache_browser::ApplicationQt> s_app;
 
+void AmpacheBrowserPlugin::cleanup()
+{
+    fetch_cleanup();
+}
+
 static void vfsAsyncCb(const char* url, const Index<char>& data, void* callback)
 {
     if (s_app) // ignore callbacks after cleanup()
@@ -99,7 +106,7 @@ void* AmpacheBrowserPlugin::get_qt_widget()
 
     s_app->setNetworkRequestFunction([](const std::string& url, NetworkCb& networkCb) {
         using namespace std::placeholders;
-        vfs_async_file_get_contents(url.c_str(), std::bind(vfsAsyncCb, _1, _2, &networkCb));
+        fetch_async(url.c_str(), std::bind(vfsAsyncCb, _1, _2, &networkCb));
     });
 
     auto& browser = s_app->getAmpacheBrowser();
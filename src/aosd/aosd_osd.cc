@@ -49,10 +49,6 @@ struct GhosdFadeData
 {
   cairo_surface_t * surface = nullptr;
   float alpha = 0.0;
-  void * user_data = nullptr;
-  int width = 0;
-  int height = 0;
-  int deco_code = 0;
 
   ~GhosdFadeData ()
   {
@@ -96,6 +92,10 @@ static int osd_source_id = 0;
 static int osd_status = AOSD_STATUS_HIDDEN;
 static Ghosd *osd;
 static SmartPtr<GhosdData> osd_data;
+static float osd_display_time = 0;
+/* set when the cached surface changed and awaits compositing; rendering
+   only on the timer tick coalesces key-repeat bursts to the OSD rate */
+static bool osd_pending_render = false;
 
 
 static void
@@ -116,14 +116,7 @@ aosd_fade_func ( Ghosd * gosd , cairo_t * cr , void * user_data )
   GhosdFadeData *fade_data = (GhosdFadeData *) user_data;
 
   if ( fade_data->surface == nullptr )
-  {
-    cairo_t *rendered_cr;
-    fade_data->surface = cairo_surface_create_similar( cairo_get_target( cr ) ,
-                           CAIRO_CONTENT_COLOR_ALPHA , fade_data->width , fade_data->height );
-    rendered_cr = cairo_create( fade_data->surface );
-    aosd_deco_style_render( fade_data->deco_code , gosd , rendered_cr , fade_data->user_data );
-    cairo_destroy( rendered_cr );
-  }
+    return;
 
   cairo_set_source_surface( cr , fade_data->surface , 0 , 0 );
   cairo_paint_with_alpha( cr , fade_data->alpha );
@@ -266,12 +259,19 @@ G_GNUC_END_IGNORE_DEPRECATIONS
   style_data.layout = osd_data->pango_layout;
   style_data.text = &(osd_data->cfg_osd->text);
   style_data.decoration = &(osd_data->cfg_osd->decoration);
-  osd_data->fade_data.surface = nullptr;
-  osd_data->fade_data.user_data = &style_data;
-  osd_data->fade_data.width = layout_width + pad_left + pad_right;
-  osd_data->fade_data.height = layout_height + pad_top + pad_bottom;
+
+  /* render the OSD content (text layout, shadow, decoration) once into
+     a cached ARGB surface; every animation frame then composites this
+     surface at the current alpha instead of redoing the full render;
+     rendering eagerly here also keeps style_data off the fade path,
+     where it would dangle once this function returns */
+  osd_data->fade_data.surface = cairo_image_surface_create( CAIRO_FORMAT_ARGB32 ,
+    layout_width + pad_left + pad_right , layout_height + pad_top + pad_bottom );
+  cairo_t *rendered_cr = cairo_create( osd_data->fade_data.surface );
+  aosd_deco_style_render( osd_data->cfg_osd->decoration.code , osd , rendered_cr , &style_data );
+  cairo_destroy( rendered_cr );
+
   osd_data->fade_data.alpha = 0;
-  osd_data->fade_data.deco_code = osd_data->cfg_osd->decoration.code;
   osd_data->dalpha_in = 1.0 / ( osd_data->cfg_osd->animation.timing_fadein / (float)AOSD_TIMING );
   osd_data->dalpha_out = 1.0 / ( osd_data->cfg_osd->animation.timing_fadeout / (float)AOSD_TIMING );
   osd_data->ddisplay_stay = 1.0 / ( osd_data->cfg_osd->animation.timing_display / (float)AOSD_TIMING );
@@ -283,11 +283,53 @@ G_GNUC_END_IGNORE_DEPRECATIONS
 }
 
 
+/* fast path for updating an OSD that is already displayed: swap just the
+   message into the cached surface, reusing the existing window, pango
+   layout and placement; returns false if the new text does not fit in
+   the current window, in which case the full create path is needed */
+static bool
+aosd_osd_update ( const char * markup_string )
+{
+  PangoRectangle ink, log;
+  int pad_left = 0 , pad_right = 0 , pad_top = 0 , pad_bottom = 0;
+  aosd_deco_style_data_t style_data;
+
+  if (( osd_data->pango_layout == nullptr ) || ( osd_data->fade_data.surface == nullptr ))
+    return false;
+
+  aosd_deco_style_get_padding( osd_data->cfg_osd->decoration.code ,
+    &pad_top , &pad_bottom , &pad_left , &pad_right );
+
+  pango_layout_set_markup( osd_data->pango_layout , markup_string , -1 );
+  pango_layout_get_pixel_extents( osd_data->pango_layout , &ink , &log );
+
+  if (( ink.width + pad_left + pad_right >
+        cairo_image_surface_get_width( osd_data->fade_data.surface ) ) ||
+      ( log.height + pad_top + pad_bottom >
+        cairo_image_surface_get_height( osd_data->fade_data.surface ) ))
+    return false;
+
+  osd_data->markup_message = String( markup_string );
+
+  style_data.layout = osd_data->pango_layout;
+  style_data.text = &(osd_data->cfg_osd->text);
+  style_data.decoration = &(osd_data->cfg_osd->decoration);
+
+  cairo_t *rendered_cr = cairo_create( osd_data->fade_data.surface );
+  cairo_save( rendered_cr );
+  cairo_set_operator( rendered_cr , CAIRO_OPERATOR_CLEAR );
+  cairo_paint( rendered_cr );
+  cairo_restore( rendered_cr );
+  aosd_deco_style_render( osd_data->cfg_osd->decoration.code , osd , rendered_cr , &style_data );
+  cairo_destroy( rendered_cr );
+
+  return true;
+}
+
+
 static gboolean
 aosd_timer_func ( void * none )
 {
-  static float display_time = 0;
-
   switch ( osd_status )
   {
     case AOSD_STATUS_FADEIN:
@@ -302,18 +344,27 @@ aosd_timer_func ( void * none )
       else
       {
         osd_data->fade_data.alpha = 1.0;
-        display_time = 0;
+        osd_display_time = 0;
         osd_status = AOSD_STATUS_SHOW; /* move to next phase */
         ghosd_render( osd );
         ghosd_main_iterations( osd );
       }
+      osd_pending_render = false;
       return true;
     }
 
     case AOSD_STATUS_SHOW:
     {
-      display_time += osd_data->ddisplay_stay;
-      if ( display_time >= 1.0 )
+      if ( osd_pending_render )
+      {
+        /* composite the updated surface; one render per tick no matter
+           how many message updates arrived since the last one */
+        ghosd_render( osd );
+        osd_pending_render = false;
+      }
+
+      osd_display_time += osd_data->ddisplay_stay;
+      if ( osd_display_time >= 1.0 )
       {
         osd_status = AOSD_STATUS_FADEOUT; /* move to next phase */
         ghosd_main_iterations( osd );
@@ -372,6 +423,18 @@ aosd_osd_display ( char * markup_string , aosd_cfg_t * cfg_osd , bool copy_cfg )
       osd_source_id = g_timeout_add_full( G_PRIORITY_DEFAULT_IDLE , AOSD_TIMING ,
                                           aosd_timer_func , nullptr , nullptr );
     }
+    else if ( ! copy_cfg && ! osd_data->cfg_is_copied &&
+              cfg_osd == osd_data->cfg_osd && aosd_osd_update( markup_string ) )
+    {
+      /* key-repeat fast path: the OSD is already up with the same config,
+         so only the message was swapped into the cached surface; restart
+         the display countdown and let the timer composite it, instead of
+         tearing the window down and fading in again for every step */
+      osd_display_time = 0;
+      osd_pending_render = true;
+      if ( osd_status == AOSD_STATUS_FADEOUT )
+        osd_status = AOSD_STATUS_FADEIN; /* fade back in from current alpha */
+    }
     else
     {
       g_source_remove( osd_source_id ); /* remove timer */
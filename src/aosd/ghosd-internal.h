@@ -28,6 +28,12 @@ typedef struct {
   int set;
 } GhosdBackground;
 
+typedef struct {
+  Pixmap pixmap;
+  int width, height;
+  int set;
+} GhosdBacking;
+
 struct _Ghosd {
   Display *dpy;
   Window win;
@@ -41,6 +47,7 @@ struct _Ghosd {
   int x, y, width, height;
 
   GhosdBackground background;
+  GhosdBacking backing;
   RenderCallback render;
   EventButtonCallback eventbutton;
 };
@@ -99,28 +99,39 @@ void
 ghosd_render(Ghosd *ghosd) {
   Pixmap pixmap;
   GC gc;
+  int fresh;
+
+  /* reuse the backing pixmap across animation frames; it only needs to
+   * be recreated (and re-attached to the window) when the geometry
+   * changes. */
+  if (ghosd->backing.set &&
+      (ghosd->backing.width != ghosd->width ||
+       ghosd->backing.height != ghosd->height)) {
+    XFreePixmap(ghosd->dpy, ghosd->backing.pixmap);
+    ghosd->backing.set = 0;
+  }
 
-  if (ghosd->composite)
-  {
-    pixmap = XCreatePixmap(ghosd->dpy, ghosd->win, ghosd->width, ghosd->height, 32);
-    gc = XCreateGC(ghosd->dpy, pixmap, 0, NULL);
+  fresh = !ghosd->backing.set;
+  if (fresh) {
+    ghosd->backing.pixmap = XCreatePixmap(ghosd->dpy, ghosd->win,
+      ghosd->width, ghosd->height,
+      ghosd->composite ? 32
+                       : DefaultDepth(ghosd->dpy, DefaultScreen(ghosd->dpy)));
+    ghosd->backing.width = ghosd->width;
+    ghosd->backing.height = ghosd->height;
+    ghosd->backing.set = 1;
+  }
+  pixmap = ghosd->backing.pixmap;
+
+  gc = XCreateGC(ghosd->dpy, pixmap, 0, NULL);
+  if (!ghosd->composite && ghosd->transparent) {
+    /* make our own copy of the background pixmap as the initial surface. */
+    XCopyArea(ghosd->dpy, ghosd->background.pixmap, pixmap, gc,
+      0, 0, ghosd->width, ghosd->height, 0, 0);
+  } else {
     XFillRectangle(ghosd->dpy, pixmap, gc,
       0, 0, ghosd->width, ghosd->height);
   }
-  else
-  {
-    pixmap = XCreatePixmap(ghosd->dpy, ghosd->win, ghosd->width, ghosd->height,
-      DefaultDepth(ghosd->dpy, DefaultScreen(ghosd->dpy)));
-    gc = XCreateGC(ghosd->dpy, pixmap, 0, NULL);
-    if (ghosd->transparent) {
-      /* make our own copy of the background pixmap as the initial surface. */
-      XCopyArea(ghosd->dpy, ghosd->background.pixmap, pixmap, gc,
-        0, 0, ghosd->width, ghosd->height, 0, 0);
-    } else {
-      XFillRectangle(ghosd->dpy, pixmap, gc,
-        0, 0, ghosd->width, ghosd->height);
-    }
-  }
   XFreeGC(ghosd->dpy, gc);
 
   /* render with cairo. */
@@ -150,14 +161,11 @@ ghosd_render(Ghosd *ghosd) {
     cairo_surface_destroy(surf);
   }
 
-  /* point window at its new backing pixmap. */
-  XSetWindowBackgroundPixmap(ghosd->dpy, ghosd->win, pixmap);
-  /* I think it's ok to free it here because XCreatePixmap(3X11) says: "the X
-   * server frees the pixmap storage when there are no references to it".
-   */
-  XFreePixmap(ghosd->dpy, pixmap);
+  /* point the window at its backing pixmap once per geometry; on later
+   * frames a clear is enough to redraw from the updated pixmap. */
+  if (fresh)
+    XSetWindowBackgroundPixmap(ghosd->dpy, ghosd->win, pixmap);
 
-  /* and tell the window to redraw with this pixmap. */
   XClearWindow(ghosd->dpy, ghosd->win);
 }
 
@@ -444,6 +452,11 @@ ghosd_destroy(Ghosd* ghosd) {
     XFreePixmap(ghosd->dpy, ghosd->background.pixmap);
     ghosd->background.set = 0;
   }
+  if (ghosd->backing.set)
+  {
+    XFreePixmap(ghosd->dpy, ghosd->backing.pixmap);
+    ghosd->backing.set = 0;
+  }
   if (ghosd->composite)
   {
     XFreeColormap(ghosd->dpy, ghosd->colormap);
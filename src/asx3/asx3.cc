@@ -44,11 +44,6 @@ public:
 
 EXPORT ASX3Loader aud_plugin_instance;
 
-static int read_cb (void * file, char * buf, int len)
-{
-    return ((VFSFile *) file)->fread (buf, 1, len);
-}
-
 static int write_cb (void * file, const char * buf, int len)
 {
     return ((VFSFile *) file)->fwrite (buf, 1, len);
@@ -59,39 +54,45 @@ static int close_cb (void * file)
     return 0;
 }
 
-static const char * get_content (const xmlNode * node)
-{
-    const xmlNode * child = node->xmlChildrenNode;
-    if (child && child->type == XML_TEXT_NODE && child->content)
-        return (const char *) child->content;
+/* The document is parsed with SAX callbacks as it is read, so memory use
+ * is bounded by one read chunk plus the parser's own state no matter how
+ * large the playlist is, and entries become available as their elements
+ * are seen rather than after the whole tree has been built. */
 
-    return nullptr;
-}
+struct ASX3ParseState
+{
+    String * title;
+    Index<PlaylistAddItem> * items;
+    xmlParserCtxt * ctxt = nullptr;
+
+    int depth = 0;
+    bool valid_root = false;
+    bool failed = false;
+    bool in_entry = false;
+    bool in_title = false;
+    Index<char> title_text;
+};
 
-static const char * get_prop_nocase (const xmlNode * node, const char * name)
+static const char * get_attr_nocase (const xmlChar * * attrs, const char * name)
 {
-    for (const xmlAttr * prop = node->properties; prop; prop = prop->next)
+    for (; attrs && attrs[0]; attrs += 2)
     {
-        if (! xmlStrcasecmp (prop->name, (const xmlChar *) name))
-        {
-            const xmlNode * child = prop->children;
-            if (child && child->type == XML_TEXT_NODE && child->content)
-                return (const char *) child->content;
-        }
+        if (! xmlStrcasecmp (attrs[0], (const xmlChar *) name))
+            return (const char *) attrs[1];
     }
 
     return nullptr;
 }
 
-static bool check_root (const xmlNode * root)
+static bool check_root (const xmlChar * name, const xmlChar * * attrs)
 {
-    if (xmlStrcasecmp (root->name, (const xmlChar *) "asx"))
+    if (xmlStrcasecmp (name, (const xmlChar *) "asx"))
     {
         AUDERR ("Not an ASX file\n");
         return false;
     }
 
-    const char * version = get_prop_nocase (root, "version");
+    const char * version = get_attr_nocase (attrs, "version");
 
     if (! version)
     {
@@ -108,47 +109,106 @@ static bool check_root (const xmlNode * root)
     return true;
 }
 
-static void parse_entry (const xmlNode * entry, Index<PlaylistAddItem> & items)
+static void start_element (void * data, const xmlChar * name, const xmlChar * * attrs)
+{
+    auto state = (ASX3ParseState *) data;
+    state->depth ++;
+
+    if (state->depth == 1)
+    {
+        if (check_root (name, attrs))
+            state->valid_root = true;
+        else
+        {
+            state->failed = true;
+            xmlStopParser (state->ctxt);
+        }
+    }
+    else if (state->depth == 2 && state->valid_root)
+    {
+        if (! xmlStrcasecmp (name, (const xmlChar *) "entry"))
+            state->in_entry = true;
+        else if (! xmlStrcasecmp (name, (const xmlChar *) "title"))
+        {
+            state->in_title = true;
+            state->title_text.resize (0);
+        }
+    }
+    else if (state->depth == 3 && state->in_entry &&
+     ! xmlStrcasecmp (name, (const xmlChar *) "ref"))
+    {
+        const char * uri = get_attr_nocase (attrs, "href");
+        if (uri)
+            state->items->append (String (uri));
+    }
+}
+
+static void end_element (void * data, const xmlChar * name)
 {
-    for (const xmlNode * node = entry->xmlChildrenNode; node; node = node->next)
+    auto state = (ASX3ParseState *) data;
+
+    if (state->depth == 2)
     {
-        if (! xmlStrcasecmp (node->name, (const xmlChar *) "ref"))
+        if (state->in_title)
         {
-            const char * uri = get_prop_nocase (node, "href");
-            if (uri)
-                items.append (String (uri));
+            if (! * state->title && state->title_text.len ())
+            {
+                state->title_text.append (0);  /* null-terminate */
+                * state->title = String (state->title_text.begin ());
+            }
+
+            state->in_title = false;
         }
+
+        state->in_entry = false;
     }
+
+    state->depth --;
+}
+
+static void characters_cb (void * data, const xmlChar * ch, int len)
+{
+    auto state = (ASX3ParseState *) data;
+
+    if (state->in_title)
+        state->title_text.insert ((const char *) ch, -1, len);
 }
 
 bool ASX3Loader::load (const char * filename, VFSFile & file, String & title,
  Index<PlaylistAddItem> & items)
 {
-    xmlDoc * doc = xmlReadIO (read_cb, close_cb, & file, filename, nullptr, XML_PARSE_RECOVER);
-    if (! doc)
-        return false;
+    ASX3ParseState state;
+    state.title = & title;
+    state.items = & items;
 
-    xmlNode * root = xmlDocGetRootElement (doc);
+    xmlSAXHandler sax = xmlSAXHandler ();
+    sax.startElement = start_element;
+    sax.endElement = end_element;
+    sax.characters = characters_cb;
 
-    if (! root || ! check_root (root))
-    {
-        xmlFreeDoc(doc);
+    xmlParserCtxt * ctxt = xmlCreatePushParserCtxt (& sax, & state, nullptr, 0, filename);
+    if (! ctxt)
         return false;
-    }
 
-    for (xmlNode * node = root->xmlChildrenNode; node; node = node->next)
-    {
-        if (! xmlStrcasecmp (node->name, (const xmlChar *) "entry"))
-            parse_entry (node, items);
-        else if (! xmlStrcasecmp (node->name, (const xmlChar *) "title"))
-        {
-            if (! title)
-                title = String (get_content (node));
-        }
-    }
+    /* NONET (and NO_XXE where available) keeps entity substitution from
+     * fetching external entities: .asx files are downloaded content */
+    int options = XML_PARSE_RECOVER | XML_PARSE_NOENT | XML_PARSE_NONET;
+#if LIBXML_VERSION >= 21300 /* XML_PARSE_NO_XXE is an enum, not a macro */
+    options |= XML_PARSE_NO_XXE;
+#endif
+    xmlCtxtUseOptions (ctxt, options);
+    state.ctxt = ctxt;
 
-    xmlFreeDoc(doc);
-    return true;
+    char buf[4096];
+    int len;
+
+    while (! state.failed && (len = file.fread (buf, 1, sizeof buf)) > 0)
+        xmlParseChunk (ctxt, buf, len, 0);
+
+    xmlParseChunk (ctxt, buf, 0, 1);
+    xmlFreeParserCtxt (ctxt);
+
+    return state.valid_root && ! state.failed;
 }
 
 bool ASX3Loader::save (const char * filename, VFSFile & file,
@@ -17,6 +17,7 @@
  * the use of this software.
  */
 
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -24,6 +25,7 @@
 #include <libaudcore/i18n.h>
 #include <libaudcore/inifile.h>
 #include <libaudcore/plugin.h>
+#include <libaudcore/runtime.h>
 
 static const char * const audpl_exts[] = {"audpl"};
 
@@ -125,23 +127,351 @@ private:
     }
 };
 
+/* Alongside each .audpl a compiled .audpl.bin sidecar is written on save:
+ * a flat binary image with length-prefixed strings and a field-name table,
+ * so loading skips the line splitting, percent decoding and per-key field
+ * lookups of the text parser.  The sidecar records the length and hash of
+ * the text file it was built from and is ignored when they no longer
+ * match (e.g. the playlist was edited by hand or written by another
+ * version), so the text file remains the authoritative format. */
+
+#define AUDPL_BIN_MAGIC 0x41504C31u  /* "APL1", also an endianness check */
+#define AUDPL_BIN_VERSION 1
+
+static uint32_t text_hash (const char * d, int len)
+{
+    uint32_t h = 2166136261u;  /* FNV-1a */
+
+    for (int i = 0; i < len; i ++)
+    {
+        h ^= (unsigned char) d[i];
+        h *= 16777619u;
+    }
+
+    return h;
+}
+
+static void put_raw (Index<char> & b, const void * d, int len)
+    { b.insert ((const char *) d, -1, len); }
+
+static void put_u8 (Index<char> & b, uint8_t v)
+    { put_raw (b, & v, 1); }
+static void put_u32 (Index<char> & b, uint32_t v)
+    { put_raw (b, & v, 4); }
+static void put_i64 (Index<char> & b, int64_t v)
+    { put_raw (b, & v, 8); }
+
+/* length-prefixed string, stored with its terminating null */
+static void put_strz (Index<char> & b, const char * s)
+{
+    if (! s)
+        s = "";
+
+    int len = strlen (s) + 1;
+    put_u32 (b, len);
+    put_raw (b, s, len);
+}
+
+struct BinReader
+{
+    const char * p, * end;
+    bool ok = true;
+
+    bool get_raw (void * d, int len)
+    {
+        if (end - p < len)
+        {
+            ok = false;
+            return false;
+        }
+
+        memcpy (d, p, len);
+        p += len;
+        return true;
+    }
+
+    uint8_t get_u8 () { uint8_t v = 0; get_raw (& v, 1); return v; }
+    uint32_t get_u32 () { uint32_t v = 0; get_raw (& v, 4); return v; }
+    int64_t get_i64 () { int64_t v = 0; get_raw (& v, 8); return v; }
+
+    const char * get_strz ()
+    {
+        uint32_t len = get_u32 ();
+
+        if (! ok || len < 1 || (uint64_t) (end - p) < len || p[len - 1])
+        {
+            ok = false;
+            return "";
+        }
+
+        const char * s = p;
+        p += len;
+        return s;
+    }
+};
+
+/* the fields the text format serializes, in a stable order */
+static Index<Tuple::Field> serializable_fields ()
+{
+    Index<Tuple::Field> fields;
+
+    for (auto f : Tuple::all_fields ())
+    {
+        if (f == Tuple::Path || f == Tuple::Basename ||
+         f == Tuple::Suffix || f == Tuple::FormattedTitle)
+            continue;
+
+        fields.append (f);
+    }
+
+    return fields;
+}
+
+/* a sidecar whose header records the same text length and hash was
+ * built from identical content and does not need rewriting */
+static bool sidecar_is_current (const char * bin_path, int tlen, uint32_t thash)
+{
+    VFSFile bin_file (bin_path, "r");
+    if (! bin_file)
+        return false;
+
+    uint32_t header[4];
+    if (bin_file.fread (header, 1, sizeof header) != sizeof header)
+        return false;
+
+    return header[0] == AUDPL_BIN_MAGIC && header[1] == AUDPL_BIN_VERSION &&
+     header[2] == (uint32_t) tlen && header[3] == thash;
+}
+
+static void save_compiled (const char * path, const char * title,
+ const Index<PlaylistAddItem> & items, int tlen, uint32_t thash)
+{
+    StringBuf bin_path = str_concat ({path, ".bin"});
+
+    /* saving a session rewrites every playlist whether it changed or
+     * not; skipping sidecars that are already current halves the write
+     * volume for the unchanged majority */
+    if (sidecar_is_current (bin_path, tlen, thash))
+        return;
+
+    Index<Tuple::Field> fields = serializable_fields ();
+
+    Index<char> bin;
+    put_u32 (bin, AUDPL_BIN_MAGIC);
+    put_u32 (bin, AUDPL_BIN_VERSION);
+    put_u32 (bin, tlen);
+    put_u32 (bin, thash);
+    put_strz (bin, title);
+
+    put_u32 (bin, fields.len ());
+    for (auto f : fields)
+        put_strz (bin, Tuple::field_get_name (f));
+
+    put_u32 (bin, items.len ());
+
+    for (auto & item : items)
+    {
+        put_strz (bin, item.filename);
+
+        auto state = item.tuple.state ();
+        put_u8 (bin, (state == Tuple::Valid) ? 1 : (state == Tuple::Failed) ? 2 : 0);
+
+        int count_at = bin.len ();
+        put_u32 (bin, 0);  /* field count, patched below */
+        uint32_t count = 0;
+
+        if (state == Tuple::Valid)
+        {
+            for (int i = 0; i < fields.len (); i ++)
+            {
+                Tuple::Field f = fields[i];
+                Tuple::ValueType type = item.tuple.get_value_type (f);
+
+                if (type == Tuple::String)
+                {
+                    put_u32 (bin, i);
+                    put_u8 (bin, 1);
+                    put_strz (bin, item.tuple.get_str (f));
+                }
+                else if (type == Tuple::Int)
+                {
+                    put_u32 (bin, i);
+                    put_u8 (bin, 2);
+                    put_i64 (bin, item.tuple.get_int (f));
+                }
+                else if (type == Tuple::DateTime)
+                {
+                    put_u32 (bin, i);
+                    put_u8 (bin, 3);
+                    put_i64 (bin, item.tuple.get_int64 (f));
+                }
+                else
+                    continue;
+
+                count ++;
+            }
+        }
+
+        memcpy (& bin[count_at], & count, 4);
+    }
+
+    /* the sidecar is just a cache; failure to write it is not an error */
+    VFSFile bin_file (bin_path, "w");
+
+    if (! bin_file || bin_file.fwrite (bin.begin (), 1, bin.len ()) != bin.len ())
+        AUDWARN ("Could not write %s.bin\n", path);
+}
+
+static bool load_compiled (const char * path, VFSFile & file, String & title,
+ Index<PlaylistAddItem> & items)
+{
+    StringBuf bin_path = str_concat ({path, ".bin"});
+
+    if (! VFSFile::test_file (bin_path, VFS_IS_REGULAR))
+        return false;
+
+    VFSFile bin_file (bin_path, "r");
+    if (! bin_file)
+        return false;
+
+    Index<char> bin = bin_file.read_all ();
+    Index<char> text = file.read_all ();
+
+    BinReader r = {bin.begin (), bin.end ()};
+
+    if (r.get_u32 () != AUDPL_BIN_MAGIC || r.get_u32 () != AUDPL_BIN_VERSION ||
+     r.get_u32 () != (uint32_t) text.len () ||
+     r.get_u32 () != text_hash (text.begin (), text.len ()))
+        goto STALE;
+
+    {
+        const char * title_s = r.get_strz ();
+
+        /* resolve the field-name table once */
+        uint32_t nfields = r.get_u32 ();
+        if (! r.ok || nfields > 256)
+            goto STALE;
+
+        Index<Tuple::Field> fields;
+        for (uint32_t i = 0; i < nfields; i ++)
+            fields.append (Tuple::field_by_name (r.get_strz ()));
+
+        uint32_t nitems = r.get_u32 ();
+
+        for (uint32_t i = 0; i < nitems && r.ok; i ++)
+        {
+            const char * uri = r.get_strz ();
+            uint8_t state = r.get_u8 ();
+            uint32_t count = r.get_u32 ();
+
+            Tuple tuple;
+
+            for (uint32_t j = 0; j < count && r.ok; j ++)
+            {
+                uint32_t idx = r.get_u32 ();
+                uint8_t type = r.get_u8 ();
+
+                if (! r.ok || idx >= (uint32_t) fields.len ())
+                    goto STALE;
+
+                Tuple::Field f = fields[idx];
+
+                if (type == 1)
+                {
+                    const char * v = r.get_strz ();
+                    if (f != Tuple::Invalid)
+                    {
+                        if (Tuple::field_get_type (f) != Tuple::String)
+                            goto STALE;
+                        tuple.set_str (f, v);
+                    }
+                }
+                else if (type == 2 || type == 3)
+                {
+                    int64_t v = r.get_i64 ();
+                    if (f != Tuple::Invalid)
+                    {
+                        auto ftype = Tuple::field_get_type (f);
+                        if (type == 2 && ftype == Tuple::Int)
+                            tuple.set_int (f, v);
+                        else if (type == 3 && ftype == Tuple::DateTime)
+                            tuple.set_int64 (f, v);
+                        else
+                            goto STALE;
+                    }
+                }
+                else
+                    goto STALE;
+            }
+
+            if (state == 1)
+                tuple.set_state (Tuple::Valid);
+            else if (state == 2)
+                tuple.set_state (Tuple::Failed);
+            else if (state != 0)
+                goto STALE;
+
+            if (tuple.valid ())
+                tuple.set_filename (uri);
+
+            items.append (String (uri), std::move (tuple));
+        }
+
+        if (! r.ok)
+            goto STALE;
+
+        /* stored raw, like the item fields (the text file alone is
+         * percent-encoded) */
+        if (title_s[0] && ! title)
+            title = String (title_s);
+
+        return true;
+    }
+
+STALE:
+    AUDINFO ("Stale or invalid sidecar for %s; parsing text\n", path);
+    items.clear ();
+    title = String ();
+
+    if (file.fseek (0, VFS_SEEK_SET) != 0)
+    {
+        AUDERR ("Could not rewind %s\n", path);
+        return true;  /* cannot fall back; keep what we have */
+    }
+
+    return false;
+}
+
 bool AudPlaylistLoader::load (const char * path, VFSFile & file, String & title,
  Index<PlaylistAddItem> & items)
 {
+    if (load_compiled (path, file, title, items))
+        return true;
+
     AudPlaylistParser (title, items).parse (file);
     return true;
 }
 
+/* same format as inifile_write_entry, but into a memory buffer so that the
+ * text can be hashed for the sidecar and written out in a single call */
+static void write_entry (Index<char> & buf, const char * key, const char * value)
+{
+    buf.insert (key, -1, strlen (key));
+    buf.append ('=');
+    buf.insert (value, -1, strlen (value));
+    buf.append ('\n');
+}
+
 bool AudPlaylistLoader::save (const char * path, VFSFile & file,
  const char * title, const Index<PlaylistAddItem> & items)
 {
-    if (! inifile_write_entry (file, "title", str_encode_percent (title)))
-        return false;
+    Index<char> text;
+
+    write_entry (text, "title", str_encode_percent (title));
 
     for (auto & item : items)
     {
-        if (! inifile_write_entry (file, "uri", item.filename))
-            return false;
+        write_entry (text, "uri", item.filename);
 
         int keys = 0;
 
@@ -164,43 +494,39 @@ bool AudPlaylistLoader::save (const char * path, VFSFile & file,
                 if (type == Tuple::String)
                 {
                     String str = item.tuple.get_str (f);
-                    if (! inifile_write_entry (file, key,
-                     (f == Tuple::AudioFile) ? str : str_encode_percent (str)))
-                        return false;
-
+                    write_entry (text, key,
+                     (f == Tuple::AudioFile) ? str : str_encode_percent (str));
                     keys ++;
                 }
                 else if (type == Tuple::Int)
                 {
-                    int val = item.tuple.get_int (f);
-                    if (! inifile_write_entry (file, key, int_to_str (val)))
-                        return false;
-
+                    write_entry (text, key, int_to_str (item.tuple.get_int (f)));
                     keys ++;
                 }
                 else if (type == Tuple::DateTime)
                 {
-                    int64_t val = item.tuple.get_int64 (f);
-                    if (! inifile_write_entry (file, key, int64_to_str (val)))
-                        return false;
-
+                    write_entry (text, key, int64_to_str (item.tuple.get_int64 (f)));
                     keys++;
                 }
             }
 
             /* for an actual empty tuple, record state explicity */
-            if (! keys && ! inifile_write_entry (file, "state", "good"))
-                return false;
+            if (! keys)
+                write_entry (text, "state", "good");
 
             break;
 
         case Tuple::Failed:
-            if (! inifile_write_entry (file, "state", "failed"))
-                return false;
-
+            write_entry (text, "state", "failed");
             break;
         }
     }
 
+    if (file.fwrite (text.begin (), 1, text.len ()) != text.len ())
+        return false;
+
+    save_compiled (path, title, items, text.len (),
+     text_hash (text.begin (), text.len ()));
+
     return true;
 }
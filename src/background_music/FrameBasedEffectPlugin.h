@@ -26,6 +26,7 @@ class FrameBasedEffectPlugin : public EffectPlugin
     Index<float> frame_in;
     Index<float> frame_out;
     Index<float> output;
+    Index<float> sidechain;
     int current_channels = 0, current_rate = 0, channel_last_read = 0;
     LoudnessFrameProcessor detection;
 
@@ -48,6 +49,7 @@ public:
         output.clear();
         frame_in.clear();
         frame_out.clear();
+        sidechain.clear();
     }
 
     void start(int & channels, int & rate) override
@@ -68,17 +70,17 @@ public:
         detection.update_config();
 
         int output_samples = 0;
+        int position = 0;
         output.resize(0);
 
         // It is assumed data always contains a multiple of channels, but we
-        // don't care.
-        for (const float sample : data)
+        // don't care: complete a frame left partially read by a previous
+        // call before handling the bulk of the block.
+        while (channel_last_read > 0 && position < data.len())
         {
-            frame_in[channel_last_read++] = sample;
+            frame_in[channel_last_read++] = data[position++];
             if (channel_last_read == current_channels)
             {
-                // Processing happens per frame. Because of read-ahead there is
-                // not always output available yet.
                 if (detection.process_has_output(frame_in, frame_out))
                 {
                     output.move_from(frame_out, 0, output_samples,
@@ -89,6 +91,36 @@ public:
             }
         }
 
+        // The detection values for all whole frames are precomputed in one
+        // vectorized scan; the envelope itself still advances frame by
+        // frame. Because of read-ahead there is not always output available
+        // yet.
+        const int whole_frames =
+            (data.len() - position) / current_channels;
+        if (whole_frames > 0)
+        {
+            sidechain.resize(whole_frames);
+            detection.prescan(&data[position], whole_frames,
+                              sidechain.begin());
+
+            for (int frame = 0; frame < whole_frames; frame++)
+            {
+                if (detection.process_frame_has_output(
+                        &data[position], sidechain[frame], frame_out.begin()))
+                {
+                    output.move_from(frame_out, 0, output_samples,
+                                     current_channels, true, false);
+                    output_samples += current_channels;
+                }
+                position += current_channels;
+            }
+        }
+
+        while (position < data.len())
+        {
+            frame_in[channel_last_read++] = data[position++];
+        }
+
         return output;
     }
 
@@ -22,8 +22,15 @@
 #include "Loudness.h"
 #include "basic_config.h"
 #include <cmath>
+#include <libaudcore/index.h>
 #include <libaudcore/runtime.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 class LoudnessFrameProcessor
 {
     static constexpr float SHORT_INTEGRATION = 0.4;
@@ -44,8 +51,10 @@ class LoudnessFrameProcessor
     float perception_slow_balance = 0.3;
     float minimum_detection = 1e-6;
     RingBuf<float> read_ahead_buffer;
+    Index<float> squared_scratch;
     int channels_ = 0;
     int processed_frames = 0;
+    int extra_lookahead_frames = 0;
 
     static float get_clamped_value(const char * variable, const double minimum,
                                    const double maximum)
@@ -64,7 +73,10 @@ class LoudnessFrameProcessor
     }
 
 public:
-    [[nodiscard]] int latency() const { return perceivedLoudness.latency(); }
+    [[nodiscard]] int latency() const
+    {
+        return perceivedLoudness.latency() + extra_lookahead_frames;
+    }
 
     LoudnessFrameProcessor()
     {
@@ -97,6 +109,17 @@ public:
          * must therefore half the integration time.
          */
         perceivedLoudness.set_rate_and_value(rate, target_level);
+        /*
+         * Extra lookahead lengthens the read-ahead buffer so the gain
+         * computed from the incoming signal is applied to output this much
+         * earlier. It is read here rather than in update_config() because
+         * changing it means resizing the delay line, which cannot be done
+         * mid-stream without a glitch.
+         */
+        extra_lookahead_frames = static_cast<int>(
+            roundf(get_clamped_value(CONF_LOOKAHEAD_VARIABLE,
+                                     CONF_LOOKAHEAD_MIN, CONF_LOOKAHEAD_MAX) *
+                   static_cast<float>(rate) / 1000.0f));
         const int alloc_size = channels_ * latency();
 
         if (read_ahead_buffer.size() < alloc_size)
@@ -122,35 +145,81 @@ public:
         long_integration.set_scale(slow_weight);
     }
 
+    /*
+     * Computes the sidechain detection value (mean square plus peak square
+     * across channels) for each whole frame of the block in one pass, so the
+     * serial envelope update can work from precomputed values. The squaring
+     * runs four samples at a time where SIMD is available; the per-frame
+     * reduction over a handful of channels stays scalar.
+     */
+    void prescan(const float * samples, const int frames, float * square_sums)
+    {
+        const int total = frames * channels_;
+        squared_scratch.resize(total);
+        float * squared = squared_scratch.begin();
+        int i = 0;
+
+#ifdef __SSE2__
+        for (; i + 4 <= total; i += 4)
+        {
+            const __m128 v = _mm_loadu_ps(samples + i);
+            _mm_storeu_ps(squared + i, _mm_mul_ps(v, v));
+        }
+#elif defined(__ARM_NEON)
+        for (; i + 4 <= total; i += 4)
+        {
+            const float32x4_t v = vld1q_f32(samples + i);
+            vst1q_f32(squared + i, vmulq_f32(v, v));
+        }
+#endif
+        for (; i < total; i++)
+        {
+            squared[i] = samples[i] * samples[i];
+        }
+
+        const float channel_scale = 1.0f / static_cast<float>(channels_);
+        for (int frame = 0; frame < frames; frame++)
+        {
+            const float * f = squared + frame * channels_;
+            float square_sum = 0.0;
+            float square_max = 0.0;
+            for (int channel = 0; channel < channels_; channel++)
+            {
+                square_max = std::max(square_max, f[channel]);
+                square_sum += f[channel];
+            }
+            square_sums[frame] = square_sum * channel_scale + square_max;
+        }
+    }
+
     bool process_has_output(const Index<float> & frame_in,
                             Index<float> & frame_out)
+    {
+        float square_sum;
+        prescan(frame_in.begin(), 1, &square_sum);
+        return process_frame_has_output(frame_in.begin(), square_sum,
+                                        frame_out.begin());
+    }
+
+    bool process_frame_has_output(const float * frame_in,
+                                  const float square_sum, float * frame_out)
     {
         bool has_output_data = processed_frames >= latency();
         if (has_output_data)
         {
-            read_ahead_buffer.move_out(frame_out.begin(), channels_);
+            read_ahead_buffer.move_out(frame_out, channels_);
         }
         else
         {
             processed_frames++;
         }
-        read_ahead_buffer.copy_in(frame_in.begin(), channels_);
+        read_ahead_buffer.copy_in(frame_in, channels_);
 
         /*
          * Following calculations need to happen to anticipate the (future)
          * output.
          */
 
-        float square_sum = 0.0;
-        float square_max = 0.0;
-        for (const float sample : frame_in)
-        {
-            const float square = sample * sample;
-            square_max = std::max(square_max, square);
-            square_sum += square;
-        }
-        square_sum /= static_cast<float>(channels_);
-        square_sum += square_max;
         const float perceived = FAST_VU_FUDGE_FACTOR *
                                 perceivedLoudness.get_mean_squared(square_sum);
         const double weighted =
@@ -165,9 +234,9 @@ public:
 
         if (has_output_data)
         {
-            for (float & sample : frame_out)
+            for (int channel = 0; channel < channels_; channel++)
             {
-                sample *= gain;
+                frame_out[channel] *= gain;
             }
         }
 
@@ -36,6 +36,10 @@ static constexpr const PreferencesWidget background_music_widgets[] = {
         N_("Slow detection weight:"),
         WidgetFloat(CONFIG_SECTION_BACKGROUND_MUSIC, CONF_SLOW_WEIGHT_VARIABLE),
         {CONF_SLOW_WEIGHT_MIN, CONF_SLOW_WEIGHT_MAX, 0.1}),
+    WidgetSpin(N_("Sidechain lookahead:"),
+               WidgetFloat(CONFIG_SECTION_BACKGROUND_MUSIC,
+                           CONF_LOOKAHEAD_VARIABLE),
+               {CONF_LOOKAHEAD_MIN, CONF_LOOKAHEAD_MAX, 1.0, N_("ms")}),
     WidgetLabel(N_("<b>Hint</b>")),
     WidgetLabel(
         N_("Slow detection weight is the relative weight\n"
@@ -43,7 +47,10 @@ static constexpr const PreferencesWidget background_music_widgets[] = {
            "to the actual, faster loudness detection.\n"
            "A value of zero gives a more radio-like sound\n"
            "where soft passages get \"pulled up\" more quickly,\n"
-           "a value of two makes the sound feel less compressed."))};
+           "a value of two makes the sound feel less compressed.\n"
+           "Sidechain lookahead delays the output further so the\n"
+           "volume can start moving before a change arrives; it is\n"
+           "applied when playback (re)starts."))};
 
 static constexpr const PluginPreferences background_music_preferences = {
     {background_music_widgets}};
@@ -18,6 +18,13 @@
  */
 
 #include <cmath>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#elif defined (__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 #include <libaudcore/i18n.h>
 #include <libaudcore/runtime.h>
@@ -64,6 +71,10 @@ private:
     float m_accumulator = 0.0;
     int m_channels = 0;
     Index<float> m_hold;
+
+    /* quantization factors, recomputed only when the depth setting changes */
+    float m_last_depth = -1.0;
+    float m_scale = 1.0, m_inv_scale = 1.0;
 };
 
 EXPORT Bitcrusher aud_plugin_instance;
@@ -91,34 +102,109 @@ Bitcrusher::start (int & channels, int & rate)
     m_hold.erase (0, m_channels);
 }
 
+/* quantizes a run of samples in place: floor (x * k + 0.5) / k, four lanes
+ * per step where SSE2 or NEON is available */
+static void quantize_block (float * data, int count, float k, float inv_k)
+{
+    int i = 0;
+
+#ifdef __SSE2__
+    const __m128 vk = _mm_set1_ps (k);
+    const __m128 vinv = _mm_set1_ps (inv_k);
+    const __m128 half = _mm_set1_ps (0.5f);
+    const __m128 one = _mm_set1_ps (1.0f);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 y = _mm_add_ps (_mm_mul_ps (_mm_loadu_ps (data + i), vk), half);
+        __m128 t = _mm_cvtepi32_ps (_mm_cvttps_epi32 (y));
+        t = _mm_sub_ps (t, _mm_and_ps (_mm_cmpgt_ps (t, y), one));
+        _mm_storeu_ps (data + i, _mm_mul_ps (t, vinv));
+    }
+#elif defined (__ARM_NEON)
+    const float32x4_t one = vdupq_n_f32 (1.0f);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        float32x4_t y = vmlaq_n_f32 (vdupq_n_f32 (0.5f), vld1q_f32 (data + i), k);
+        float32x4_t t = vcvtq_f32_s32 (vcvtq_s32_f32 (y));
+        uint32x4_t gt = vcgtq_f32 (t, y);
+        t = vsubq_f32 (t, vreinterpretq_f32_u32
+         (vandq_u32 (gt, vreinterpretq_u32_f32 (one))));
+        vst1q_f32 (data + i, vmulq_n_f32 (t, inv_k));
+    }
+#endif
+
+    for (; i < count; i ++)
+        data[i] = floorf (data[i] * k + 0.5f) * inv_k;
+}
+
 Index<float> &
 Bitcrusher::process (Index<float> & data)
 {
     float downsample_ratio = aud_get_double ("bitcrusher", "downsample");
     float bit_depth = aud_get_double ("bitcrusher", "depth");
 
-    float scale = pow (2., bit_depth) / 2.;
-    float gain = (33. - bit_depth) / 8.;
+    /* the default settings are the identity (no quantization, no
+     * downsampling); keep the held frame current and pass through */
+    if (bit_depth >= 32 && downsample_ratio >= 1.0f)
+    {
+        if (data.len () >= m_channels)
+            memcpy (m_hold.begin (), data.end () - m_channels,
+             m_channels * sizeof (float));
+
+        return data;
+    }
+
+    if (bit_depth != m_last_depth)
+    {
+        m_last_depth = bit_depth;
+
+        float scale = powf (2.0f, bit_depth) / 2;
+        float gain = (33.0f - bit_depth) / 8;
+
+        /* floor (x*gain*scale + 0.5) / scale / gain folds into one factor */
+        m_scale = gain * scale;
+        m_inv_scale = 1.0f / m_scale;
+    }
 
     float * f = data.begin ();
-    float * end = data.end ();
+    int frames = data.len () / m_channels;
+    int frame = 0;
 
-    while (f < end)
+    while (frame < frames)
     {
-        m_accumulator += downsample_ratio;
+        /* run of consecutively sampled frames: quantize in one pass */
+        int run = 0;
+        while (frame + run < frames && m_accumulator + downsample_ratio >= 1.0f)
+        {
+            m_accumulator += downsample_ratio - 1.0f;
+            run ++;
+        }
 
-        for (int channel = 0; channel < m_channels; channel ++)
+        if (run > 0)
         {
-            float current = * f;
+            quantize_block (f, run * m_channels, m_scale, m_inv_scale);
+            f += run * m_channels;
+            memcpy (m_hold.begin (), f - m_channels, m_channels * sizeof (float));
+            frame += run;
+        }
 
-            if (m_accumulator >= 1.0)
-                m_hold [channel] = floorf ((current * gain) * scale + 0.5) / scale / gain;
+        /* run of held frames: splat the held frame without branching */
+        run = 0;
+        while (frame + run < frames && m_accumulator + downsample_ratio < 1.0f)
+        {
+            m_accumulator += downsample_ratio;
+            run ++;
+        }
 
-            * f ++ = m_hold [channel];
+        for (int count = 0; count < run; count ++)
+        {
+            memcpy (f, m_hold.begin (), m_channels * sizeof (float));
+            f += m_channels;
         }
 
-        if (m_accumulator >= 1.0)
-            m_accumulator -= 1.0;
+        frame += run;
     }
 
     return data;
@@ -28,6 +28,12 @@
 #include <string.h>
 #include <glib.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#elif defined (__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #include <QWidget>
 #include <QImage>
 #include <QPainter>
@@ -63,6 +69,7 @@ public:
     void clear ();
     void blur ();
     void draw_vert_line (int x, int y1, int y2);
+    void draw ();
 
 protected:
     void resizeEvent (QResizeEvent *) override;
@@ -71,6 +78,11 @@ protected:
 private:
     int m_width = 0, m_height = 0, m_image_size = 0;
     uint32_t * m_image = nullptr, * m_corner = nullptr;
+    uint32_t * m_row_copy = nullptr;
+
+    /* vertical band containing all lit pixels, and as last drawn */
+    int m_dirty_y1 = 0, m_dirty_y2 = -1;
+    int m_drawn_y1 = 0, m_drawn_y2 = -1;
 };
 
 static BlurScopeWidget *s_widget = nullptr;
@@ -85,6 +97,8 @@ BlurScopeWidget::~BlurScopeWidget ()
 {
     g_free(m_image);
     m_image = nullptr;
+    g_free(m_row_copy);
+    m_row_copy = nullptr;
     s_widget = nullptr;
 }
 
@@ -109,31 +123,110 @@ void BlurScopeWidget::resize (int w, int h)
     m_image = (uint32_t *) g_realloc (m_image, m_image_size);
     memset (m_image, 0, m_image_size);
     m_corner = m_image + m_width + 1;
+    m_row_copy = (uint32_t *) g_realloc (m_row_copy, (m_width + 2) << 2);
+
+    m_dirty_y1 = m_height;
+    m_dirty_y2 = -1;
+    m_drawn_y1 = 0;
+    m_drawn_y2 = m_height - 1;
 }
 
 void BlurScopeWidget::clear ()
 {
     memset (m_image, 0, m_image_size);
-    update ();
+    m_dirty_y1 = m_height;
+    m_dirty_y2 = -1;
+    draw ();
+}
+
+void BlurScopeWidget::draw ()
+{
+    /* invalidate the union of the current and previously drawn bands so
+     * that rows which have faded out are painted black once */
+    int y1 = aud::min (m_dirty_y1, m_drawn_y1);
+    int y2 = aud::max (m_dirty_y2, m_drawn_y2);
+
+    if (y1 <= y2)
+        update (0, y1, m_width, y2 - y1 + 1);
+
+    m_drawn_y1 = m_dirty_y1;
+    m_drawn_y2 = m_dirty_y2;
+}
+
+/* We do a quick and dirty average of four color values, first masking off the
+ * lowest two bits.  Over a large area, this masking has the net effect of
+ * subtracting 1.5 from each value, which by a happy chance is just right for a
+ * gradual fade effect.  The left and right neighbors are read from a copy of
+ * the row so that each output pixel depends only on last frame's values; with
+ * no serial dependence on the just-blurred left neighbor, the row can be
+ * processed four pixels per step where SSE2 or NEON is available. */
+static void blur_row (uint32_t * p, const uint32_t * plast,
+ const uint32_t * pnext, const uint32_t * copy, int width)
+{
+    int x = 0;
+
+#ifdef __SSE2__
+    const __m128i mask = _mm_set1_epi32 (0xFCFCFC);
+
+    for (; x + 4 <= width; x += 4)
+    {
+        __m128i sum = _mm_add_epi32 (
+         _mm_add_epi32 (_mm_and_si128 (_mm_loadu_si128 ((const __m128i *) (plast + x)), mask),
+                        _mm_and_si128 (_mm_loadu_si128 ((const __m128i *) (copy + x)), mask)),
+         _mm_add_epi32 (_mm_and_si128 (_mm_loadu_si128 ((const __m128i *) (copy + x + 2)), mask),
+                        _mm_and_si128 (_mm_loadu_si128 ((const __m128i *) (pnext + x)), mask)));
+        _mm_storeu_si128 ((__m128i *) (p + x), _mm_srli_epi32 (sum, 2));
+    }
+#elif defined (__ARM_NEON)
+    const uint32x4_t mask = vdupq_n_u32 (0xFCFCFC);
+
+    for (; x + 4 <= width; x += 4)
+    {
+        uint32x4_t sum = vaddq_u32 (
+         vaddq_u32 (vandq_u32 (vld1q_u32 (plast + x), mask),
+                    vandq_u32 (vld1q_u32 (copy + x), mask)),
+         vaddq_u32 (vandq_u32 (vld1q_u32 (copy + x + 2), mask),
+                    vandq_u32 (vld1q_u32 (pnext + x), mask)));
+        vst1q_u32 (p + x, vshrq_n_u32 (sum, 2));
+    }
+#endif
+
+    for (; x < width; x ++)
+        p[x] = ((plast[x] & 0xFCFCFC) + (copy[x] & 0xFCFCFC) +
+         (copy[x + 2] & 0xFCFCFC) + (pnext[x] & 0xFCFCFC)) >> 2;
+}
+
+static bool row_is_lit (const uint32_t * p, int width)
+{
+    uint32_t bits = 0;
+    for (int x = 0; x < width; x ++)
+        bits |= p[x];
+
+    return bits != 0;
 }
 
 void BlurScopeWidget::blur ()
 {
-    for (int y = 0; y < m_height; y ++)
+    if (m_dirty_y2 < m_dirty_y1)
+        return;
+
+    /* the fade spreads one pixel outward per frame */
+    m_dirty_y1 = aud::max (m_dirty_y1 - 1, 0);
+    m_dirty_y2 = aud::min (m_dirty_y2 + 1, m_height - 1);
+
+    for (int y = m_dirty_y1; y <= m_dirty_y2; y ++)
     {
         uint32_t * p = m_corner + m_width * y;
-        uint32_t * end = p + m_width;
-        uint32_t * plast = p - m_width;
-        uint32_t * pnext = p + m_width;
-
-        /* We do a quick and dirty average of four color values, first masking
-         * off the lowest two bits.  Over a large area, this masking has the net
-         * effect of subtracting 1.5 from each value, which by a happy chance
-         * is just right for a gradual fade effect. */
-        for (; p < end; p ++)
-            * p = ((* plast ++ & 0xFCFCFC) + (p[-1] & 0xFCFCFC) + (p[1] &
-             0xFCFCFC) + (* pnext ++ & 0xFCFCFC)) >> 2;
+
+        memcpy (m_row_copy, p - 1, (m_width + 2) * sizeof (uint32_t));
+        blur_row (p, p - m_width, p + m_width, m_row_copy, m_width);
     }
+
+    /* shrink the band as rows at its edges fade back to black */
+    while (m_dirty_y1 <= m_dirty_y2 && ! row_is_lit (m_corner + m_width * m_dirty_y1, m_width))
+        m_dirty_y1 ++;
+    while (m_dirty_y2 > m_dirty_y1 && ! row_is_lit (m_corner + m_width * m_dirty_y2, m_width))
+        m_dirty_y2 --;
 }
 
 void BlurScopeWidget::draw_vert_line (int x, int y1, int y2)
@@ -146,6 +239,9 @@ void BlurScopeWidget::draw_vert_line (int x, int y1, int y2)
 
     uint32_t * p = m_corner + y * m_width + x;
 
+    m_dirty_y1 = aud::min (m_dirty_y1, y);
+    m_dirty_y2 = aud::max (m_dirty_y2, y + h - 1);
+
     for (; h --; p += m_width)
         * p = bscope_color;
 }
@@ -213,7 +309,7 @@ void BlurScopeQt::render_mono_pcm (const float * pcm)
         prev_y = y;
     }
 
-    s_widget->update ();
+    s_widget->draw ();
 }
 
 void * BlurScopeQt::get_qt_widget ()
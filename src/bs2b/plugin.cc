@@ -88,6 +88,10 @@ void BS2BPlugin::start (int & channels, int & rate)
 
 Index<float> & BS2BPlugin::process (Index<float> & data)
 {
+    /* bs2b_cross_feed_f() is libbs2b's batch entry point and filters the
+     * whole block in one call.  The filter itself is recursive (each frame
+     * depends on the previous output), so it cannot be vectorized across the
+     * block without reimplementing the library's DSP. */
     if (bs2b_channels == 2)
         bs2b_cross_feed_f (bs2b, data.begin (), data.len () / 2);
 
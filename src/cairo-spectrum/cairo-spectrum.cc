@@ -59,6 +59,13 @@ static int width, height, bands;
 static int bars[MAX_BANDS + 1];
 static int delay[MAX_BANDS + 1];
 
+/* bar heights as last drawn, for partial invalidation */
+static int drawn_bars[MAX_BANDS + 1];
+
+/* per-band colors, recomputed only when the band count or style changes */
+static float bar_colors[MAX_BANDS][3];
+static int color_bands = 0;
+
 void CairoSpectrum::render_freq (const float * freq)
 {
     if (! bands)
@@ -82,8 +89,24 @@ void CairoSpectrum::render_freq (const float * freq)
         }
     }
 
-    if (spect_widget)
-        gtk_widget_queue_draw (spect_widget);
+    /* invalidate only the columns whose bar height actually changed */
+    int first = bands, last = -1;
+
+    for (int i = 0; i < bands; i ++)
+    {
+        if (bars[i] != drawn_bars[i])
+        {
+            first = aud::min (first, i);
+            last = aud::max (last, i);
+        }
+    }
+
+    if (spect_widget && last >= first)
+    {
+        int bw = width / bands;
+        gtk_widget_queue_draw_area (spect_widget, first * bw, 0,
+         (last - first + 1) * bw + 3, height);
+    }
 }
 
 void CairoSpectrum::clear ()
@@ -104,22 +127,55 @@ static void draw_background (GtkWidget * area, cairo_t * cr)
     cairo_fill (cr);
 }
 
-static void draw_visualizer (GtkWidget * widget, cairo_t * cr)
+static void update_bar_colors (GtkWidget * widget)
 {
 G_GNUC_BEGIN_IGNORE_DEPRECATIONS
     auto & c = (gtk_widget_get_style (widget))->base[GTK_STATE_SELECTED];
 G_GNUC_END_IGNORE_DEPRECATIONS
 
+    for (int i = 0; i < bands; i ++)
+        audgui_vis_bar_color (c, i, bands, bar_colors[i][0],
+         bar_colors[i][1], bar_colors[i][2]);
+
+    color_bands = bands;
+}
+
+static void style_changed ()
+{
+    color_bands = 0;
+
+    if (spect_widget)
+        gtk_widget_queue_draw (spect_widget);
+}
+
+static void draw_visualizer (GtkWidget * widget, cairo_t * cr)
+{
+    if (! bands)
+        return;
+
+    if (color_bands != bands)
+        update_bar_colors (widget);
+
+    double clip_x1, clip_y1, clip_x2, clip_y2;
+    cairo_clip_extents (cr, & clip_x1, & clip_y1, & clip_x2, & clip_y2);
+
+    int bw = width / bands;
+
     for (int i = 0; i < bands; i ++)
     {
-        int x = ((width / bands) * i) + 2;
-        float r, g, b;
+        int x = bw * i + 2;
+
+        /* skip columns outside the damaged region */
+        if (x + bw < clip_x1 || x > clip_x2)
+            continue;
 
-        audgui_vis_bar_color (c, i, bands, r, g, b);
-        cairo_set_source_rgb (cr, r, g, b);
+        cairo_set_source_rgb (cr, bar_colors[i][0], bar_colors[i][1],
+         bar_colors[i][2]);
         cairo_rectangle (cr, x + 1, height - (bars[i] * height / 40),
-         (width / bands) - 1, (bars[i] * height / 40));
+         bw - 1, (bars[i] * height / 40));
         cairo_fill (cr);
+
+        drawn_bars[i] = bars[i];
     }
 }
 
@@ -160,6 +216,11 @@ void * CairoSpectrum::get_gtk_widget ()
     g_signal_connect (area, AUDGUI_DRAW_SIGNAL, (GCallback) draw_event, nullptr);
     g_signal_connect (area, "configure-event", (GCallback) configure_event, nullptr);
     g_signal_connect (area, "destroy", (GCallback) gtk_widget_destroyed, & spect_widget);
+#ifdef USE_GTK3
+    g_signal_connect (area, "style-updated", (GCallback) style_changed, nullptr);
+#else
+    g_signal_connect (area, "style-set", (GCallback) style_changed, nullptr);
+#endif
 
     GtkWidget * frame = gtk_frame_new (nullptr);
     gtk_frame_set_shadow_type ((GtkFrame *) frame, GTK_SHADOW_IN);
@@ -52,6 +52,7 @@
 #include <libaudcore/plugin.h>
 #include <libaudcore/preferences.h>
 #include <libaudcore/runtime.h>
+#include <libaudcore/vfs.h>
 
 #define MIN_DISC_SPEED 2
 #define MAX_DISC_SPEED 24
@@ -59,6 +60,12 @@
 #define MAX_RETRIES 10
 #define MAX_SKIPS 10
 
+/* Sectors kept buffered ahead of playback (75 sectors = 1 second), and
+ * sectors of already played data kept around so that a short backward
+ * seek does not touch the drive. */
+#define CD_READAHEAD_SECTORS (5 * 75)
+#define CD_HISTORY_SECTORS (5 * 75)
+
 static const char * const cdaudio_schemes[] = {"cdda", nullptr};
 
 class CDAudio : public InputPlugin
@@ -110,6 +117,17 @@ static cdrom_drive_t *pcdrom_drive = nullptr;
 static Index<trackinfo_t> trackinfo;
 static QueuedFunc purge_func;
 
+/* Readahead state, guarded by the global mutex.  The reader thread keeps
+ * [prod_lsn, cons_lsn + CD_READAHEAD_SECTORS) buffered in cd_buf, which
+ * holds the contiguous sector range starting at buf_lsn; the play thread
+ * consumes from cons_lsn.  Retries on marginal discs thus happen off the
+ * playback path. */
+static pthread_cond_t cd_cond = PTHREAD_COND_INITIALIZER;
+static Index<unsigned char> cd_buf;
+static int buf_lsn, cons_lsn, prod_lsn, prod_endlsn;
+static int chunk_sectors;
+static bool prod_error, prod_quit;
+
 static bool scan_cd ();
 static bool refresh_trackinfo (bool warning);
 static void reset_trackinfo ();
@@ -241,6 +259,102 @@ bool CDAudio::is_our_file (const char * filename, VFSFile & file)
     return !strncmp (filename, "cdda://", 7);
 }
 
+/* reader thread only (except for startup/shutdown in the play thread) */
+static void * cd_reader (void *)
+{
+    int retry_count = 0, skip_count = 0;
+    int sectors = chunk_sectors;
+
+    Index<unsigned char> readbuf;
+    readbuf.insert (0, 2352 * chunk_sectors);
+
+    pthread_mutex_lock (& mutex);
+
+    while (! prod_quit)
+    {
+        if (prod_lsn - cons_lsn >= CD_READAHEAD_SECTORS || prod_lsn > prod_endlsn)
+        {
+            pthread_cond_wait (& cd_cond, & mutex);
+            continue;
+        }
+
+        int nsec = aud::min (sectors, prod_endlsn + 1 - prod_lsn);
+        int read_lsn = prod_lsn;
+
+        /* unlock mutex here to avoid blocking
+         * other threads must be careful not to close drive handle */
+        pthread_mutex_unlock (& mutex);
+
+        int ret = cdio_read_audio_sectors (pcdrom_drive->p_cdio,
+         readbuf.begin (), read_lsn, nsec);
+
+        pthread_mutex_lock (& mutex);
+
+        if (prod_quit)
+            break;
+
+        /* an out-of-window seek reset the buffer while we were reading */
+        if (read_lsn != prod_lsn)
+            continue;
+
+        if (ret == DRIVER_OP_SUCCESS)
+        {
+            int old = cd_buf.len ();
+            cd_buf.insert (-1, 2352 * nsec);
+            memcpy (& cd_buf[old], readbuf.begin (), 2352 * nsec);
+            prod_lsn += nsec;
+
+            retry_count = 0;
+            skip_count = 0;
+
+            /* drop played data beyond the backward seek window */
+            if (cons_lsn - buf_lsn > CD_HISTORY_SECTORS)
+            {
+                int drop = cons_lsn - buf_lsn - CD_HISTORY_SECTORS;
+                cd_buf.remove (0, 2352 * drop);
+                buf_lsn += drop;
+            }
+
+            pthread_cond_broadcast (& cd_cond);
+        }
+        else if (sectors > 16)
+        {
+            /* maybe a smaller read size will help */
+            sectors /= 2;
+        }
+        else if (retry_count < MAX_RETRIES)
+        {
+            /* still failed; retry a few times */
+            retry_count ++;
+        }
+        else if (skip_count < MAX_SKIPS)
+        {
+            /* maybe the disk is scratched; skip ahead, padding the stream
+             * with silence to keep the buffered range contiguous */
+            int skip = aud::min (75, prod_endlsn + 1 - prod_lsn);
+            cd_buf.insert (-1, 2352 * skip);
+            prod_lsn += skip;
+            skip_count ++;
+
+            pthread_cond_broadcast (& cd_cond);
+        }
+        else
+        {
+            /* still failed; give it up */
+            prod_error = true;
+            pthread_cond_broadcast (& cd_cond);
+            break;
+        }
+    }
+
+    /* hold the buffered data until told to quit */
+    while (! prod_quit)
+        pthread_cond_wait (& cd_cond, & mutex);
+
+    pthread_mutex_unlock (& mutex);
+    return nullptr;
+}
+
 /* play thread only */
 bool CDAudio::play (const char * name, VFSFile & file)
 {
@@ -281,65 +395,80 @@ bool CDAudio::play (const char * name, VFSFile & file)
     int buffer_size = aud_get_int ("output_buffer_size");
     int speed = aud_get_int ("CDDA", "disc_speed");
     speed = aud::clamp (speed, MIN_DISC_SPEED, MAX_DISC_SPEED);
-    int sectors = aud::clamp (buffer_size / 2, 50, 250) * speed * 75 / 1000;
-    int currlsn = startlsn;
-    int retry_count = 0, skip_count = 0;
+    chunk_sectors = aud::clamp (buffer_size / 2, 50, 250) * speed * 75 / 1000;
+
+    cd_buf.resize (0);
+    buf_lsn = cons_lsn = prod_lsn = startlsn;
+    prod_endlsn = endlsn;
+    prod_error = false;
+    prod_quit = false;
+
+    pthread_t reader;
+
+    if (pthread_create (& reader, nullptr, cd_reader, nullptr) != 0)
+    {
+        cdaudio_error (_("Error reading audio CD."));
+        playing = false;
+        pthread_mutex_unlock (& mutex);
+        return false;
+    }
 
     Index<unsigned char> buffer;
-    buffer.insert (0, 2352 * sectors);
+    buffer.insert (0, 2352 * chunk_sectors);
 
     while (! check_stop ())
     {
         int seek_time = check_seek ();
         if (seek_time >= 0)
-            currlsn = startlsn + (seek_time * 75 / 1000);
-
-        sectors = aud::min (sectors, endlsn + 1 - currlsn);
-        if (sectors < 1)
-            break;
+        {
+            int newlsn = startlsn + (seek_time * 75 / 1000);
 
-        /* unlock mutex here to avoid blocking
-         * other threads must be careful not to close drive handle */
-        pthread_mutex_unlock (& mutex);
+            if (newlsn >= buf_lsn && newlsn <= prod_lsn)
+            {
+                /* within the buffered window (including recently played
+                 * data): no drive access needed */
+                cons_lsn = newlsn;
+            }
+            else
+            {
+                cd_buf.resize (0);
+                buf_lsn = cons_lsn = prod_lsn = newlsn;
+            }
 
-        int ret = cdio_read_audio_sectors (pcdrom_drive->p_cdio,
-         buffer.begin (), currlsn, sectors);
+            pthread_cond_broadcast (& cd_cond);
+        }
 
-        if (ret == DRIVER_OP_SUCCESS)
-            write_audio (buffer.begin (), 2352 * sectors);
+        if (cons_lsn > endlsn)
+            break;
 
-        pthread_mutex_lock (& mutex);
+        while (cons_lsn == prod_lsn && ! prod_error)
+            pthread_cond_wait (& cd_cond, & mutex);
 
-        if (ret == DRIVER_OP_SUCCESS)
+        if (prod_error)
         {
-            currlsn += sectors;
-            retry_count = 0;
-            skip_count = 0;
-        }
-        else if (sectors > 16)
-        {
-            /* maybe a smaller read size will help */
-            sectors /= 2;
-        }
-        else if (retry_count < MAX_RETRIES)
-        {
-            /* still failed; retry a few times */
-            retry_count ++;
-        }
-        else if (skip_count < MAX_SKIPS)
-        {
-            /* maybe the disk is scratched; try skipping ahead */
-            currlsn = aud::min (currlsn + 75, endlsn + 1);
-            skip_count ++;
-        }
-        else
-        {
-            /* still failed; give it up */
             cdaudio_error (_("Error reading audio CD."));
             break;
         }
+
+        int take = aud::min (prod_lsn - cons_lsn, chunk_sectors);
+        memcpy (buffer.begin (), & cd_buf[(cons_lsn - buf_lsn) * 2352], 2352 * take);
+        cons_lsn += take;
+
+        /* wake the reader; the window just moved forward */
+        pthread_cond_broadcast (& cd_cond);
+
+        pthread_mutex_unlock (& mutex);
+        write_audio (buffer.begin (), 2352 * take);
+        pthread_mutex_lock (& mutex);
     }
 
+    prod_quit = true;
+    pthread_cond_broadcast (& cd_cond);
+    pthread_mutex_unlock (& mutex);
+    pthread_join (reader, nullptr);
+    pthread_mutex_lock (& mutex);
+
+    cd_buf.clear ();
     playing = false;
 
     pthread_mutex_unlock (& mutex);
@@ -430,6 +559,134 @@ bool CDAudio::read_tag (const char * filename, VFSFile & file, Tuple & tuple,
     return valid;
 }
 
+/* Persistent disc metadata cache.  Reading CD-Text and especially querying
+ * CDDB adds seconds between inserting a disc and a usable playlist, yet the
+ * answers never change for a given disc.  Successful lookups are therefore
+ * stored in a text file keyed by a signature of the TOC, and reinserting a
+ * known disc is filled in from the file without touching CD-Text or the
+ * network.  Lookups that found nothing are not stored, so they are retried
+ * (e.g. after a CDDB outage) the next time the disc shows up. */
+
+#define CACHE_MAX_DISCS 64
+
+static StringBuf cache_path ()
+    { return filename_build ({aud_get_path (AudPath::UserDir), "cd-metadata-cache"}); }
+
+/* mutex must be locked; track LSNs must already be filled in */
+static StringBuf disc_signature ()
+{
+    /* the track layout identifies the disc, as CDDB's disc ID does */
+    StringBuf sig = str_printf ("%d", firsttrackno);
+
+    for (int trackno = firsttrackno; trackno <= lasttrackno; trackno ++)
+        str_append_printf (sig, ":%d", trackinfo[trackno].startlsn);
+
+    str_append_printf (sig, ":%d", trackinfo[0].endlsn);
+    return sig;
+}
+
+/* Cache file format: a "disc <signature>" line opens a block, and each
+ * following "<field> <trackno> <value>" line fills one text field, with the
+ * value percent-encoded to keep it on one line.  Track 0 holds the
+ * disc-level fields, matching trackinfo. */
+
+/* mutex must be locked */
+static bool cache_load_disc (const char * sig)
+{
+    auto data = VFSFile::read_file (filename_to_uri (cache_path ()), VFS_APPEND_NULL);
+    if (! data.len ())
+        return false;
+
+    bool in_disc = false, found = false;
+
+    for (const String & line : str_list_to_index (data.begin (), "\n"))
+    {
+        if (! strncmp (line, "disc ", 5))
+        {
+            in_disc = ! strcmp (line + 5, sig);
+            found = found || in_disc;
+            continue;
+        }
+
+        if (! in_disc)
+            continue;
+
+        const char * sp1 = strchr (line, ' ');
+        const char * sp2 = sp1 ? strchr (sp1 + 1, ' ') : nullptr;
+        if (! sp2)
+            continue;
+
+        int trackno = str_to_int (sp1 + 1);
+        if (trackno < 0 || trackno > lasttrackno)
+            continue;
+
+        String value (str_decode_percent (sp2 + 1));
+
+        if (! strncmp (line, "performer ", 10))
+            trackinfo[trackno].performer = value;
+        else if (! strncmp (line, "name ", 5))
+            trackinfo[trackno].name = value;
+        else if (! strncmp (line, "genre ", 6))
+            trackinfo[trackno].genre = value;
+    }
+
+    return found;
+}
+
+static void cache_append (Index<char> & text, const char * field, int trackno,
+ const String & value)
+{
+    if (! value || ! value[0])
+        return;
+
+    StringBuf line = str_concat ({field, " ", int_to_str (trackno), " ",
+     str_encode_percent (value), "\n"});
+    text.insert (line, -1, line.len ());
+}
+
+/* mutex must be locked; writes the current disc first and carries over other
+ * cached discs up to a fixed cap, so the least recently seen drop out */
+static void cache_store_disc (const char * sig)
+{
+    Index<char> text;
+
+    StringBuf header = str_concat ({"disc ", sig, "\n"});
+    text.insert (header, -1, header.len ());
+
+    for (int trackno = 0; trackno <= lasttrackno; trackno ++)
+    {
+        if (trackno > 0 && trackno < firsttrackno)
+            continue;
+
+        cache_append (text, "performer", trackno, trackinfo[trackno].performer);
+        cache_append (text, "name", trackno, trackinfo[trackno].name);
+        cache_append (text, "genre", trackno, trackinfo[trackno].genre);
+    }
+
+    auto old = VFSFile::read_file (filename_to_uri (cache_path ()), VFS_APPEND_NULL);
+    if (old.len ())
+    {
+        int discs = 1;
+        bool keep = false;
+
+        for (const String & line : str_list_to_index (old.begin (), "\n"))
+        {
+            if (! strncmp (line, "disc ", 5))
+                keep = strcmp (line + 5, sig) && discs ++ < CACHE_MAX_DISCS;
+
+            if (keep)
+            {
+                text.insert (line, -1, strlen (line));
+                text.append ('\n');
+            }
+        }
+    }
+
+    String uri (filename_to_uri (cache_path ()));
+    if (! VFSFile::write_file (uri, text.begin (), text.len ()))
+        AUDWARN ("Could not save CD metadata cache to %s\n", (const char *) uri);
+}
+
 /* mutex must be locked */
 static bool open_cd ()
 {
@@ -546,6 +803,14 @@ static bool scan_cd ()
             n_audio_tracks++;
     }
 
+    StringBuf signature = disc_signature ();
+
+    if (cache_load_disc (signature))
+    {
+        AUDDBG ("using cached metadata for this disc\n");
+        return true;
+    }
+
     /* get trackinfo[0] cdtext information (the disc) */
     cdtext_t *pcdtext = nullptr;
     if (aud_get_bool ("CDDA", "use_cdtext"))
@@ -750,6 +1015,18 @@ static bool scan_cd ()
 #endif /* HAVE_LIBCDDB */
     }
 
+    /* remember the answers; empty lookups are not stored, so they are
+     * retried the next time the disc is inserted */
+    bool have_metadata = false;
+    for (const trackinfo_t & info : trackinfo)
+    {
+        if (info.performer || info.name || info.genre)
+            have_metadata = true;
+    }
+
+    if (have_metadata)
+        cache_store_disc (signature);
+
     return true;
 }
 
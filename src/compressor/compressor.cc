@@ -21,6 +21,12 @@
 #include <stdint.h>
 #include <stdlib.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#elif defined (__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #include <libaudcore/i18n.h>
 #include <libaudcore/plugin.h>
 #include <libaudcore/preferences.h>
@@ -37,6 +43,7 @@
 static const char * const compressor_defaults[] = {
     "center", "0.5",
     "range", "0.5",
+    "limiter", "FALSE",
      nullptr
 };
 
@@ -47,7 +54,10 @@ static const PreferencesWidget compressor_widgets[] = {
         {0.1, 1, 0.1}),
     WidgetSpin (N_("Dynamic range:"),
         WidgetFloat ("compressor", "range"),
-        {0.0, 3.0, 0.1})
+        {0.0, 3.0, 0.1}),
+    WidgetLabel (N_("<b>Limiter</b>")),
+    WidgetCheck (N_("Lookahead limiter (takes effect on next song)"),
+        WidgetBool ("compressor", "limiter"))
 };
 
 static const PluginPreferences compressor_prefs = {{compressor_widgets}};
@@ -91,23 +101,171 @@ static int chunk_size;
 static float current_peak;
 static int current_channels, current_rate;
 
+/* Optional lookahead limiter.  The compressor above works on 200 ms chunks
+ * and can overshoot ("pump") on sudden transients, especially speech.  The
+ * limiter delays the signal a few milliseconds and scales down any frame
+ * whose lookahead window would exceed the ceiling.  The window peak is
+ * tracked with a monotonic deque (values decrease from front to back), so
+ * the cost per frame is O(1) amortized. */
+#define LIMIT_TIME 0.005f /* seconds */
+#define LIMIT_CEILING 0.98f
+
+static bool limiter_on;
+static int limit_frames;
+static RingBuf<float> limit_buffer;
+static Index<float> limit_output, limit_gain;
+
+static Index<float> win_peaks;
+static Index<int64_t> win_frames;
+static int win_start;
+static int64_t frames_in, frames_out;
+
 /* I used to find the maximum sample and take that as the peak, but that doesn't
  * work well on badly clipped tracks.  Now, I use the highly sophisticated
  * method of averaging the absolute value of the samples and multiplying by 6, a
  * number proved by experiment (on exactly three files) to best approximate the
  * actual peak. */
 
-static float calc_peak (float * data, int length)
+/* Each chunk is summed exactly once, when it enters the window, and its
+ * cached value is dropped when it expires, so the tracker is already
+ * incremental; the summing pass itself runs four samples per step where SSE2
+ * or NEON is available. */
+static float calc_peak (const float * data, int length)
 {
     float sum = 0;
+    int i = 0;
+
+#ifdef __SSE2__
+    const __m128 mask = _mm_castsi128_ps (_mm_set1_epi32 (0x7fffffff));
+    __m128 vsum = _mm_setzero_ps ();
+
+    for (; i + 4 <= length; i += 4)
+        vsum = _mm_add_ps (vsum, _mm_and_ps (_mm_loadu_ps (data + i), mask));
+
+    float part[4];
+    _mm_storeu_ps (part, vsum);
+    sum = (part[0] + part[1]) + (part[2] + part[3]);
+#elif defined (__ARM_NEON)
+    float32x4_t vsum = vdupq_n_f32 (0);
+
+    for (; i + 4 <= length; i += 4)
+        vsum = vaddq_f32 (vsum, vabsq_f32 (vld1q_f32 (data + i)));
+
+    sum = (vgetq_lane_f32 (vsum, 0) + vgetq_lane_f32 (vsum, 1)) +
+          (vgetq_lane_f32 (vsum, 2) + vgetq_lane_f32 (vsum, 3));
+#endif
 
-    float * end = data + length;
-    while (data < end)
-        sum += fabsf (* data ++);
+    for (; i < length; i ++)
+        sum += fabsf (data[i]);
 
     return aud::max (0.01f, sum / length * 6);
 }
 
+static void win_push (float peak)
+{
+    int len = win_peaks.len ();
+
+    while (len > win_start && win_peaks[len - 1] <= peak)
+        len --;
+
+    win_peaks.resize (len);
+    win_frames.resize (len);
+
+    win_peaks.append (peak);
+    win_frames.append (frames_in);
+}
+
+/* drops window entries older than the frame about to be emitted and returns
+ * the peak of the remaining window */
+static float win_max ()
+{
+    while (win_start < win_peaks.len () && win_frames[win_start] <= frames_out)
+        win_start ++;
+
+    if (win_start == win_peaks.len ())
+    {
+        win_peaks.resize (0);
+        win_frames.resize (0);
+        win_start = 0;
+        return 0.0f;
+    }
+
+    if (win_start >= limit_frames)
+    {
+        win_peaks.remove (0, win_start);
+        win_frames.remove (0, win_start);
+        win_start = 0;
+    }
+
+    return win_peaks[win_start];
+}
+
+static void apply_gain (float * data, const float * gain, int length)
+{
+    int i = 0;
+
+#ifdef __SSE2__
+    for (; i + 4 <= length; i += 4)
+        _mm_storeu_ps (data + i, _mm_mul_ps (_mm_loadu_ps (data + i),
+         _mm_loadu_ps (gain + i)));
+#elif defined (__ARM_NEON)
+    for (; i + 4 <= length; i += 4)
+        vst1q_f32 (data + i, vmulq_f32 (vld1q_f32 (data + i),
+         vld1q_f32 (gain + i)));
+#endif
+
+    for (; i < length; i ++)
+        data[i] *= gain[i];
+}
+
+static void limit_emit ()
+{
+    float max = win_max ();
+    float gain = (max > LIMIT_CEILING) ? LIMIT_CEILING / max : 1.0f;
+
+    limit_buffer.move_out (limit_output, -1, current_channels);
+    frames_out ++;
+
+    for (int c = 0; c < current_channels; c ++)
+        limit_gain.append (gain);
+}
+
+static Index<float> & limit_run (Index<float> & data, bool drain)
+{
+    limit_output.resize (0);
+    limit_gain.resize (0);
+
+    int channels = current_channels;
+    int frames = data.len () / channels;
+    const float * in = data.begin ();
+
+    for (int f = 0; f < frames; f ++, in += channels)
+    {
+        float peak = 0.0f;
+        for (int c = 0; c < channels; c ++)
+            peak = aud::max (peak, fabsf (in[c]));
+
+        frames_in ++;
+        win_push (peak);
+        limit_buffer.copy_in (in, channels);
+
+        if (frames_in - frames_out == limit_frames)
+            limit_emit ();
+    }
+
+    if (drain)
+    {
+        while (frames_out < frames_in)
+            limit_emit ();
+    }
+
+    /* the delayed samples and their per-frame gains are contiguous now, so
+     * the actual scaling is a single vectorized pass */
+    apply_gain (limit_output.begin (), limit_gain.begin (), limit_output.len ());
+
+    return limit_output;
+}
+
 static void do_ramp (float * data, int length, float peak_a, float peak_b)
 {
     float center = aud_get_double ("compressor", "center");
@@ -115,11 +273,10 @@ static void do_ramp (float * data, int length, float peak_a, float peak_b)
     float a = powf (peak_a / center, range - 1);
     float b = powf (peak_b / center, range - 1);
 
+    float step = (length > 0) ? (b - a) / length : 0;
+
     for (int count = 0; count < length; count ++)
-    {
-        * data = (* data) * (a * (length - count) + b * count) / length;
-        data ++;
-    }
+        data[count] *= a + step * count;
 }
 
 bool Compressor::init ()
@@ -133,6 +290,12 @@ void Compressor::cleanup ()
     buffer.destroy ();
     peaks.destroy ();
     output.clear ();
+
+    limit_buffer.destroy ();
+    limit_output.clear ();
+    limit_gain.clear ();
+    win_peaks.clear ();
+    win_frames.clear ();
 }
 
 void Compressor::start (int & channels, int & rate)
@@ -145,6 +308,10 @@ void Compressor::start (int & channels, int & rate)
     buffer.alloc (chunk_size * CHUNKS);
     peaks.alloc (CHUNKS);
 
+    limiter_on = aud_get_bool ("compressor", "limiter");
+    limit_frames = aud::max (1, (int) (rate * LIMIT_TIME));
+    limit_buffer.alloc (limit_frames * channels);
+
     flush (true);
 }
 
@@ -189,7 +356,7 @@ Index<float> & Compressor::process (Index<float> & data)
         peaks.pop ();
     }
 
-    return output;
+    return limiter_on ? limit_run (output, false) : output;
 }
 
 bool Compressor::flush (bool force)
@@ -198,6 +365,13 @@ bool Compressor::flush (bool force)
     peaks.discard ();
 
     current_peak = 0.0f;
+
+    limit_buffer.discard ();
+    win_peaks.resize (0);
+    win_frames.resize (0);
+    win_start = 0;
+    frames_in = frames_out = 0;
+
     return true;
 }
 
@@ -222,10 +396,11 @@ Index<float> & Compressor::finish (Index<float> & data, bool end_of_playlist)
 
     output.insert (data.begin (), -1, data.len ());
 
-    return output;
+    return limiter_on ? limit_run (output, true) : output;
 }
 
 int Compressor::adjust_delay (int delay)
 {
-    return delay + aud::rescale<int64_t> (buffer.len () / current_channels, current_rate, 1000);
+    int frames = buffer.len () / current_channels + (int) (frames_in - frames_out);
+    return delay + aud::rescale<int64_t> (frames, current_rate, 1000);
 }
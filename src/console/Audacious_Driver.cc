@@ -7,14 +7,18 @@
  */
 
 #include <math.h>
+#include <pthread.h>
 
 #include <libaudcore/audstrings.h>
+#include <libaudcore/index.h>
+#include <libaudcore/multihash.h>
 #include <libaudcore/runtime.h>
 
 #include "configure.h"
 #include "plugin.h"
 #include "Music_Emu.h"
 #include "Gzip_Reader.h"
+#include "Zstd_Reader.h"
 
 static const int fade_threshold = 10 * 1000;
 static const int fade_length    = 8 * 1000;
@@ -58,6 +62,8 @@ private:
     char m_header[4];
     Vfs_File_Reader vfs_in;
     Gzip_Reader gzip_in;
+    Zstd_Reader zstd_in;
+    Data_Reader* m_in;
 };
 
 ConsoleFileHandler::ConsoleFileHandler(const char *path, VFSFile &fd)
@@ -65,6 +71,7 @@ ConsoleFileHandler::ConsoleFileHandler(const char *path, VFSFile &fd)
     m_emu   = nullptr;
     m_type  = 0;
     m_track = -1;
+    m_in    = nullptr;
 
     const char * sub;
     uri_parse (path, nullptr, nullptr, & sub, & m_track);
@@ -75,12 +82,29 @@ ConsoleFileHandler::ConsoleFileHandler(const char *path, VFSFile &fd)
     // open vfs
     vfs_in.reset(fd);
 
-    // now open gzip_reader on top of vfs
-    if (log_err(gzip_in.open(&vfs_in)))
+    // sniff for zstd before handing the stream to the gzip reader
+    char magic[4];
+    bool zstd = (vfs_in.read_avail(magic, sizeof magic) == sizeof magic &&
+     Zstd_Reader::detect(magic, sizeof magic));
+    if (log_err(vfs_in.seek(0)))
         return;
 
+    if (zstd)
+    {
+        if (log_err(zstd_in.open(&vfs_in)))
+            return;
+        m_in = &zstd_in;
+    }
+    else
+    {
+        // now open gzip_reader on top of vfs
+        if (log_err(gzip_in.open(&vfs_in)))
+            return;
+        m_in = &gzip_in;
+    }
+
     // read and identify header
-    if (!log_err(gzip_in.read(m_header, sizeof(m_header))))
+    if (!log_err(m_in->read(m_header, sizeof(m_header))))
     {
         m_type = gme_identify_extension(gme_identify_header(m_header));
         if (!m_type)
@@ -97,25 +121,83 @@ ConsoleFileHandler::~ConsoleFileHandler()
     gme_delete(m_emu);
 }
 
+/* Drains a reader into an Index<char> in large chunks.  Deflate itself is
+ * serial, so instead of inflating inline while the emulator parses, the
+ * whole file is inflated on a worker thread while the emulator engine is
+ * being constructed; a large compressed rip then costs roughly
+ * max(inflate, init) instead of their sum.
+ */
+struct InflateJob {
+    Data_Reader *in;
+    Index<char> data;
+    bool error = false;
+
+    static void *run(void *arg)
+    {
+        auto &job = *(InflateJob *)arg;
+        const int chunk = 128 * 1024;
+
+        while (1)
+        {
+            int pos = job.data.len();
+            job.data.insert(pos, chunk);
+
+            long got = job.in->read_avail(&job.data[pos], chunk);
+            if (got < 0)
+            {
+                job.error = true;
+                break;
+            }
+
+            if (got < chunk)
+                job.data.remove(pos + got, chunk - got);
+            if (!got)
+                break;
+        }
+
+        return nullptr;
+    }
+};
+
 int ConsoleFileHandler::load(int sample_rate)
 {
     if (!m_type)
         return 1;
 
+    // inflate the file body concurrently with emulator construction
+    InflateJob job;
+    job.in = m_in;
+    job.data.insert(m_header, -1, sizeof(m_header));
+
+    pthread_t inflater;
+    bool threaded = !pthread_create(&inflater, nullptr, InflateJob::run, &job);
+
     m_emu = gme_new_emu(m_type, sample_rate);
+
+    if (threaded)
+        pthread_join(inflater, nullptr);
+    else
+        InflateJob::run(&job);  // fall back to inflating on the spot
+
     if (m_emu == nullptr)
     {
         log_err("Out of memory allocating emulator engine. Fatal error.");
         return 1;
     }
 
-    // combine header with remaining file data
-    Remaining_Reader reader(m_header, sizeof(m_header), &gzip_in);
+    if (job.error)
+    {
+        log_err("Read error");
+        return 1;
+    }
+
+    Mem_File_Reader reader(job.data.begin(), job.data.len());
     if (log_err(m_emu->load(reader)))
         return 1;
 
     // files can be closed now
     gzip_in.close();
+    zstd_in.close();
     vfs_in.close();
 
     log_warning(m_emu);
@@ -142,11 +224,10 @@ int ConsoleFileHandler::load(int sample_rate)
     return 0;
 }
 
-static int get_track_length(const track_info_t &info)
+static int get_track_length(int length, int intro_length, int loop_length)
 {
-    int length = info.length;
     if (length <= 0)
-        length = info.intro_length + 2 * info.loop_length;
+        length = intro_length + 2 * loop_length;
 
     if (length <= 0)
         length = audcfg.loop_length * 1000;
@@ -156,8 +237,83 @@ static int get_track_length(const track_info_t &info)
     return length;
 }
 
+static int get_track_length(const track_info_t &info)
+{
+    return get_track_length(info.length, info.intro_length, info.loop_length);
+}
+
+/* Multi-track sets (NSF/NSFe/GBS/KSS) get one read_tag call per subtune, and
+ * each call re-read and re-parsed the whole file.  The per-track info of a
+ * file is cached on first read so the remaining subtunes are filled from
+ * memory; raw lengths are stored so the fade/loop policy above is applied
+ * per lookup with the current configuration.  The file size stands in for a
+ * modification time, which the VFS layer does not provide. */
+
+struct CachedTrack {
+    int length = 0, intro_length = 0, loop_length = 0;
+    String author, game, song, copyright, system, comment;
+};
+
+struct CachedFile {
+    int64_t file_size = 0;
+    int track_count = 0;
+    Index<CachedTrack> tracks;
+};
+
+static pthread_mutex_t cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static SimpleHash<String, CachedFile> info_cache;
+static int info_cache_entries = 0;
+
 bool ConsolePlugin::read_tag(const char *filename, VFSFile &file, Tuple &tuple, Index<char> *image)
 {
+    const char *sub;
+    int track = -1;
+    uri_parse(filename, nullptr, nullptr, &sub, &track);
+    String path = String(str_copy(filename, sub - filename));
+    track -= 1;
+
+    int64_t size = file.fsize();
+
+    if (size >= 0)
+    {
+        pthread_mutex_lock(&cache_mutex);
+        CachedFile *entry = info_cache.lookup(path);
+        int idx = track < 0 ? 0 : track;
+
+        if (entry && entry->file_size == size && idx < entry->tracks.len())
+        {
+            const CachedTrack &ct = entry->tracks[idx];
+
+            auto set_str = [&tuple](Tuple::Field f, const String &s)
+                { if (s && s[0]) tuple.set_str(f, s); };
+
+            set_str(Tuple::Artist, ct.author);
+            set_str(Tuple::Album, ct.game);
+            set_str(Tuple::Title, ct.song);
+            set_str(Tuple::Copyright, ct.copyright);
+            set_str(Tuple::Codec, ct.system);
+            set_str(Tuple::Comment, ct.comment);
+
+            if (track >= 0)
+            {
+                tuple.set_int(Tuple::Track, track + 1);
+                tuple.set_int(Tuple::Subtune, track + 1);
+                tuple.set_int(Tuple::NumSubtunes, entry->track_count);
+            }
+            else
+                tuple.set_subtunes(entry->track_count, nullptr);
+
+            tuple.set_int(Tuple::Length, get_track_length(ct.length,
+             ct.intro_length, ct.loop_length));
+            tuple.set_int(Tuple::Channels, 2);
+
+            pthread_mutex_unlock(&cache_mutex);
+            return true;
+        }
+
+        pthread_mutex_unlock(&cache_mutex);
+    }
+
     ConsoleFileHandler fh(filename, file);
 
     if (!fh.m_type)
@@ -192,6 +348,50 @@ bool ConsolePlugin::read_tag(const char *filename, VFSFile &file, Tuple &tuple,
     tuple.set_int (Tuple::Length, get_track_length (info));
     tuple.set_int (Tuple::Channels, 2);
 
+    if (size >= 0)
+    {
+        pthread_mutex_lock(&cache_mutex);
+        CachedFile *entry = info_cache.lookup(path);
+
+        if (!entry)
+        {
+            /* primitive size cap; entries are small, and dropping the cache
+             * once in a long while just means parsing those files again */
+            if (info_cache_entries >= 512)
+            {
+                info_cache.clear();
+                info_cache_entries = 0;
+            }
+
+            entry = info_cache.add(path, CachedFile());
+            info_cache_entries++;
+        }
+
+        entry->file_size = size;
+        entry->track_count = info.track_count;
+        entry->tracks.clear();
+
+        for (int t = 0; t < info.track_count; t++)
+        {
+            track_info_t ti;
+            if (fh.m_emu->track_info(&ti, t))
+                break;
+
+            CachedTrack &ct = entry->tracks.append();
+            ct.length = ti.length;
+            ct.intro_length = ti.intro_length;
+            ct.loop_length = ti.loop_length;
+            ct.author = String(ti.author);
+            ct.game = String(ti.game);
+            ct.song = String(ti.song);
+            ct.copyright = String(ti.copyright);
+            ct.system = String(ti.system);
+            ct.comment = String(ti.comment);
+        }
+
+        pthread_mutex_unlock(&cache_mutex);
+    }
+
     return true;
 }
 
@@ -212,6 +212,27 @@ Blip_Synth_::Blip_Synth_( short* p, int w ) :
 	buf = 0;
 	last_amp = 0;
 	delta_factor = 0;
+	phase_kernels = 0;
+}
+
+// Regenerate the phase-major copy of the impulse set.  For each phase, taps
+// up to the midpoint come from the mirrored half (impulses + blip_res -
+// phase), the rest from the straight half (impulses + phase) reversed --
+// the same two halves the old strided accumulation walked.
+void Blip_Synth_::rebuild_phase_kernels()
+{
+	if ( !phase_kernels )
+		return;
+
+	int const mid = width / 2 - 1;
+	for ( int phase = 0; phase < blip_res; phase++ )
+	{
+		short* k = phase_kernels + phase * width;
+		for ( int j = 0; j < width; j++ )
+			k [j] = (j <= mid) ?
+				impulses [blip_res - phase + j * blip_res] :
+				impulses [phase + (width - 1 - j) * blip_res];
+	}
 }
 
 #undef PI
@@ -302,6 +323,8 @@ void Blip_Synth_::adjust_impulse()
 	//for ( int i = blip_res; i--; printf( "\n" ) )
 	//  for ( int j = 0; j < width / 2; j++ )
 	//      printf( "%5ld,", impulses [j * blip_res + i + 1] );
+
+	rebuild_phase_kernels();
 }
 
 void Blip_Synth_::treble_eq( blip_eq_t const& eq )
@@ -6,6 +6,11 @@
 
 	// internal
 	#include <limits.h>
+	#ifdef __SSE4_1__
+		#include <smmintrin.h>
+	#elif defined (__ARM_NEON)
+		#include <arm_neon.h>
+	#endif
 	#if INT_MAX < 0x7FFFFFFF
 		#error "int must be at least 32 bits"
 	#endif
@@ -160,6 +165,10 @@ private:
 		Blip_Buffer* buf;
 		int last_amp;
 		int delta_factor;
+		// copy of the impulse set laid out phase-major (one contiguous
+		// width-tap kernel per phase), so offset_resampled() can accumulate
+		// with a single linear pass; points into Blip_Synth's array
+		short* phase_kernels;
 
 		void volume_unit( double );
 		Blip_Synth_( short* impulses, int width );
@@ -171,6 +180,7 @@ private:
 		blip_long kernel_unit;
 		int impulses_size() const { return blip_res / 2 * width + 1; }
 		void adjust_impulse();
+		void rebuild_phase_kernels();
 	};
 
 // Quality level. Start with blip_good_quality.
@@ -224,8 +234,9 @@ private:
 	Blip_Synth_ impl;
 	typedef short imp_t;
 	imp_t impulses [blip_res * (quality / 2) + 1];
+	imp_t phase_kernels [blip_res * quality];
 public:
-	Blip_Synth() : impl( impulses, quality ) { }
+	Blip_Synth() : impl( impulses, quality ) { impl.phase_kernels = phase_kernels; }
 #endif
 };
 
@@ -355,83 +366,34 @@ inline void Blip_Synth<quality,range>::offset_resampled( blip_resampled_time_t t
 #else
 
 	int const fwd = (blip_widest_impulse_ - quality) / 2;
-	int const rev = fwd + quality - 2;
-	int const mid = quality / 2 - 1;
-
-	imp_t const* BLIP_RESTRICT imp = impulses + blip_res - phase;
-
-	#if defined (_M_IX86) || defined (_M_IA64) || defined (__i486__) || \
-			defined (__x86_64__) || defined (__ia64__) || defined (__i386__)
-
-	// straight forward implementation resulted in better code on GCC for x86
 
-	#define ADD_IMP( out, in ) \
-		buf [out] += (blip_long) imp [blip_res * (in)] * delta
-
-	#define BLIP_FWD( i ) {\
-		ADD_IMP( fwd     + i, i     );\
-		ADD_IMP( fwd + 1 + i, i + 1 );\
+	// The impulse set is also kept phase-major (one contiguous kernel per
+	// phase), so the accumulation is a single linear multiply-add pass that
+	// runs in SIMD lanes where available; elsewhere the compiler can
+	// auto-vectorize the plain loop, which the original phase-strided
+	// indexing prevented.
+	imp_t const* BLIP_RESTRICT k = phase_kernels + phase * quality;
+
+	int i = 0;
+#ifdef __SSE4_1__
+	__m128i vdelta = _mm_set1_epi32( delta );
+	for ( ; i + 4 <= quality; i += 4 )
+	{
+		__m128i kk = _mm_cvtepi16_epi32( _mm_loadl_epi64( (const __m128i*) (k + i) ) );
+		__m128i acc = _mm_loadu_si128( (__m128i*) &buf [fwd + i] );
+		acc = _mm_add_epi32( acc, _mm_mullo_epi32( kk, vdelta ) );
+		_mm_storeu_si128( (__m128i*) &buf [fwd + i], acc );
 	}
-	#define BLIP_REV( r ) {\
-		ADD_IMP( rev     - r, r + 1 );\
-		ADD_IMP( rev + 1 - r, r     );\
+#elif defined (__ARM_NEON)
+	for ( ; i + 4 <= quality; i += 4 )
+	{
+		int32x4_t acc = vld1q_s32( (int32_t*) &buf [fwd + i] );
+		acc = vmlaq_n_s32( acc, vmovl_s16( vld1_s16( k + i ) ), delta );
+		vst1q_s32( (int32_t*) &buf [fwd + i], acc );
 	}
-
-		BLIP_FWD( 0 )
-		if ( quality > 8  ) BLIP_FWD( 2 )
-		if ( quality > 12 ) BLIP_FWD( 4 )
-		{
-			ADD_IMP( fwd + mid - 1, mid - 1 );
-			ADD_IMP( fwd + mid    , mid     );
-			imp = impulses + phase;
-		}
-		if ( quality > 12 ) BLIP_REV( 6 )
-		if ( quality > 8  ) BLIP_REV( 4 )
-		BLIP_REV( 2 )
-
-		ADD_IMP( rev    , 1 );
-		ADD_IMP( rev + 1, 0 );
-
-	#else
-
-	// for RISC processors, help compiler by reading ahead of writes
-
-	#define BLIP_FWD( i ) {\
-		blip_long t0 =                       i0 * delta + buf [fwd     + i];\
-		blip_long t1 = imp [blip_res * (i + 1)] * delta + buf [fwd + 1 + i];\
-		i0 =           imp [blip_res * (i + 2)];\
-		buf [fwd     + i] = t0;\
-		buf [fwd + 1 + i] = t1;\
-	}
-	#define BLIP_REV( r ) {\
-		blip_long t0 =                 i0 * delta + buf [rev     - r];\
-		blip_long t1 = imp [blip_res * r] * delta + buf [rev + 1 - r];\
-		i0 =           imp [blip_res * (r - 1)];\
-		buf [rev     - r] = t0;\
-		buf [rev + 1 - r] = t1;\
-	}
-
-		blip_long i0 = *imp;
-		BLIP_FWD( 0 )
-		if ( quality > 8  ) BLIP_FWD( 2 )
-		if ( quality > 12 ) BLIP_FWD( 4 )
-		{
-			blip_long t0 =                   i0 * delta + buf [fwd + mid - 1];
-			blip_long t1 = imp [blip_res * mid] * delta + buf [fwd + mid    ];
-			imp = impulses + phase;
-			i0 = imp [blip_res * mid];
-			buf [fwd + mid - 1] = t0;
-			buf [fwd + mid    ] = t1;
-		}
-		if ( quality > 12 ) BLIP_REV( 6 )
-		if ( quality > 8  ) BLIP_REV( 4 )
-		BLIP_REV( 2 )
-
-		blip_long t0 =   i0 * delta + buf [rev    ];
-		blip_long t1 = *imp * delta + buf [rev + 1];
-		buf [rev    ] = t0;
-		buf [rev + 1] = t1;
-	#endif
+#endif
+	for ( ; i < quality; i++ )
+		buf [fwd + i] += (blip_long) k [i] * delta;
 
 #endif
 }
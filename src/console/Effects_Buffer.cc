@@ -398,48 +398,86 @@ void Effects_Buffer::mix_mono_enhanced( blip_sample_t* out_, blargg_long count )
 	int echo_pos = this->echo_pos;
 	int reverb_pos = this->reverb_pos;
 
-	while ( count-- )
+	fixed_t const pan_1_l = chans.pan_1_levels [0];
+	fixed_t const pan_1_r = chans.pan_1_levels [1];
+	fixed_t const pan_2_l = chans.pan_2_levels [0];
+	fixed_t const pan_2_r = chans.pan_2_levels [1];
+	fixed_t const reverb_level = chans.reverb_level;
+	fixed_t const echo_level = chans.echo_level;
+
+	while ( count )
 	{
-		int sum1_s = BLIP_READER_READ( sq1 );
-		int sum2_s = BLIP_READER_READ( sq2 );
+		// process in runs that end before any delay line tap or write head
+		// wraps, so all delay accesses below are to contiguous memory with
+		// no per-sample masking
+		int const echo_read_l = (echo_pos + chans.echo_delay_l) & echo_mask;
+		int const echo_read_r = (echo_pos + chans.echo_delay_r) & echo_mask;
+		int const reverb_read_l = (reverb_pos + chans.reverb_delay_l) & reverb_mask;
+		int const reverb_read_r = (reverb_pos + chans.reverb_delay_r) & reverb_mask;
+
+		blargg_long n = count;
+		if ( n > (blargg_long) (echo_size - echo_pos) )
+			n = echo_size - echo_pos;
+		if ( n > (blargg_long) (echo_size - echo_read_l) )
+			n = echo_size - echo_read_l;
+		if ( n > (blargg_long) (echo_size - echo_read_r) )
+			n = echo_size - echo_read_r;
+		if ( n > (blargg_long) ((reverb_size - reverb_pos) >> 1) )
+			n = (reverb_size - reverb_pos) >> 1;
+		if ( n > (blargg_long) ((reverb_size + 1 - reverb_read_l) >> 1) )
+			n = (reverb_size + 1 - reverb_read_l) >> 1;
+		if ( n > (blargg_long) ((reverb_size + 1 - reverb_read_r) >> 1) )
+			n = (reverb_size + 1 - reverb_read_r) >> 1;
+
+		blip_sample_t* const echo_w = echo_buf + echo_pos;
+		blip_sample_t* const echo_l = echo_buf + echo_read_l;
+		blip_sample_t* const echo_r = echo_buf + echo_read_r;
+		blip_sample_t* const reverb_w = reverb_buf + reverb_pos;
+		blip_sample_t* const reverb_l = reverb_buf + reverb_read_l;
+		blip_sample_t* const reverb_r = reverb_buf + reverb_read_r;
+
+		echo_pos = (echo_pos + n) & echo_mask;
+		reverb_pos = (reverb_pos + n * 2) & reverb_mask;
+		count -= n;
+
+		// reverb feeds back into its own line, so samples must still be
+		// produced in order; short taps alias the pointers above
+		for ( blargg_long i = 0; i < n; i++ )
+		{
+			int sum1_s = BLIP_READER_READ( sq1 );
+			int sum2_s = BLIP_READER_READ( sq2 );
 
-		BLIP_READER_NEXT( sq1, bass );
-		BLIP_READER_NEXT( sq2, bass );
+			BLIP_READER_NEXT( sq1, bass );
+			BLIP_READER_NEXT( sq2, bass );
 
-		int new_reverb_l = FMUL( sum1_s, chans.pan_1_levels [0] ) +
-				FMUL( sum2_s, chans.pan_2_levels [0] ) +
-				reverb_buf [(reverb_pos + chans.reverb_delay_l) & reverb_mask];
+			int new_reverb_l = FMUL( sum1_s, pan_1_l ) +
+					FMUL( sum2_s, pan_2_l ) + reverb_l [i * 2];
 
-		int new_reverb_r = FMUL( sum1_s, chans.pan_1_levels [1] ) +
-				FMUL( sum2_s, chans.pan_2_levels [1] ) +
-				reverb_buf [(reverb_pos + chans.reverb_delay_r) & reverb_mask];
+			int new_reverb_r = FMUL( sum1_s, pan_1_r ) +
+					FMUL( sum2_s, pan_2_r ) + reverb_r [i * 2];
 
-		fixed_t reverb_level = chans.reverb_level;
-		reverb_buf [reverb_pos] = (blip_sample_t) FMUL( new_reverb_l, reverb_level );
-		reverb_buf [reverb_pos + 1] = (blip_sample_t) FMUL( new_reverb_r, reverb_level );
-		reverb_pos = (reverb_pos + 2) & reverb_mask;
+			reverb_w [i * 2    ] = (blip_sample_t) FMUL( new_reverb_l, reverb_level );
+			reverb_w [i * 2 + 1] = (blip_sample_t) FMUL( new_reverb_r, reverb_level );
 
-		int sum3_s = BLIP_READER_READ( center );
-		BLIP_READER_NEXT( center, bass );
+			int sum3_s = BLIP_READER_READ( center );
+			BLIP_READER_NEXT( center, bass );
 
-		int left = new_reverb_l + sum3_s + FMUL( chans.echo_level,
-				echo_buf [(echo_pos + chans.echo_delay_l) & echo_mask] );
-		int right = new_reverb_r + sum3_s + FMUL( chans.echo_level,
-				echo_buf [(echo_pos + chans.echo_delay_r) & echo_mask] );
+			int left = new_reverb_l + sum3_s + FMUL( echo_level, echo_l [i] );
+			int right = new_reverb_r + sum3_s + FMUL( echo_level, echo_r [i] );
 
-		echo_buf [echo_pos] = sum3_s;
-		echo_pos = (echo_pos + 1) & echo_mask;
+			echo_w [i] = sum3_s;
 
-		if ( (int16_t) left != left )
-			left = 0x7FFF - (left >> 24);
+			if ( (int16_t) left != left )
+				left = 0x7FFF - (left >> 24);
 
-		out [0] = left;
-		out [1] = right;
+			out [0] = left;
+			out [1] = right;
 
-		out += 2;
+			out += 2;
 
-		if ( (int16_t) right != right )
-			out [-1] = 0x7FFF - (right >> 24);
+			if ( (int16_t) right != right )
+				out [-1] = 0x7FFF - (right >> 24);
+		}
 	}
 	this->reverb_pos = reverb_pos;
 	this->echo_pos = echo_pos;
@@ -466,54 +504,92 @@ void Effects_Buffer::mix_enhanced( blip_sample_t* out_, blargg_long count )
 	int echo_pos = this->echo_pos;
 	int reverb_pos = this->reverb_pos;
 
-	while ( count-- )
+	fixed_t const pan_1_l = chans.pan_1_levels [0];
+	fixed_t const pan_1_r = chans.pan_1_levels [1];
+	fixed_t const pan_2_l = chans.pan_2_levels [0];
+	fixed_t const pan_2_r = chans.pan_2_levels [1];
+	fixed_t const reverb_level = chans.reverb_level;
+	fixed_t const echo_level = chans.echo_level;
+
+	while ( count )
 	{
-		int sum1_s = BLIP_READER_READ( sq1 );
-		int sum2_s = BLIP_READER_READ( sq2 );
+		// same run splitting as mix_mono_enhanced(); see the comments there
+		int const echo_read_l = (echo_pos + chans.echo_delay_l) & echo_mask;
+		int const echo_read_r = (echo_pos + chans.echo_delay_r) & echo_mask;
+		int const reverb_read_l = (reverb_pos + chans.reverb_delay_l) & reverb_mask;
+		int const reverb_read_r = (reverb_pos + chans.reverb_delay_r) & reverb_mask;
+
+		blargg_long n = count;
+		if ( n > (blargg_long) (echo_size - echo_pos) )
+			n = echo_size - echo_pos;
+		if ( n > (blargg_long) (echo_size - echo_read_l) )
+			n = echo_size - echo_read_l;
+		if ( n > (blargg_long) (echo_size - echo_read_r) )
+			n = echo_size - echo_read_r;
+		if ( n > (blargg_long) ((reverb_size - reverb_pos) >> 1) )
+			n = (reverb_size - reverb_pos) >> 1;
+		if ( n > (blargg_long) ((reverb_size + 1 - reverb_read_l) >> 1) )
+			n = (reverb_size + 1 - reverb_read_l) >> 1;
+		if ( n > (blargg_long) ((reverb_size + 1 - reverb_read_r) >> 1) )
+			n = (reverb_size + 1 - reverb_read_r) >> 1;
+
+		blip_sample_t* const echo_w = echo_buf + echo_pos;
+		blip_sample_t* const echo_l = echo_buf + echo_read_l;
+		blip_sample_t* const echo_r = echo_buf + echo_read_r;
+		blip_sample_t* const reverb_w = reverb_buf + reverb_pos;
+		blip_sample_t* const reverb_l = reverb_buf + reverb_read_l;
+		blip_sample_t* const reverb_r = reverb_buf + reverb_read_r;
+
+		echo_pos = (echo_pos + n) & echo_mask;
+		reverb_pos = (reverb_pos + n * 2) & reverb_mask;
+		count -= n;
+
+		for ( blargg_long i = 0; i < n; i++ )
+		{
+			int sum1_s = BLIP_READER_READ( sq1 );
+			int sum2_s = BLIP_READER_READ( sq2 );
 
-		BLIP_READER_NEXT( sq1, bass );
-		BLIP_READER_NEXT( sq2, bass );
+			BLIP_READER_NEXT( sq1, bass );
+			BLIP_READER_NEXT( sq2, bass );
 
-		int new_reverb_l = FMUL( sum1_s, chans.pan_1_levels [0] ) +
-				FMUL( sum2_s, chans.pan_2_levels [0] ) + BLIP_READER_READ( l1 ) +
-				reverb_buf [(reverb_pos + chans.reverb_delay_l) & reverb_mask];
+			int new_reverb_l = FMUL( sum1_s, pan_1_l ) +
+					FMUL( sum2_s, pan_2_l ) + BLIP_READER_READ( l1 ) +
+					reverb_l [i * 2];
 
-		int new_reverb_r = FMUL( sum1_s, chans.pan_1_levels [1] ) +
-				FMUL( sum2_s, chans.pan_2_levels [1] ) + BLIP_READER_READ( r1 ) +
-				reverb_buf [(reverb_pos + chans.reverb_delay_r) & reverb_mask];
+			int new_reverb_r = FMUL( sum1_s, pan_1_r ) +
+					FMUL( sum2_s, pan_2_r ) + BLIP_READER_READ( r1 ) +
+					reverb_r [i * 2];
 
-		BLIP_READER_NEXT( l1, bass );
-		BLIP_READER_NEXT( r1, bass );
+			BLIP_READER_NEXT( l1, bass );
+			BLIP_READER_NEXT( r1, bass );
 
-		fixed_t reverb_level = chans.reverb_level;
-		reverb_buf [reverb_pos] = (blip_sample_t) FMUL( new_reverb_l, reverb_level );
-		reverb_buf [reverb_pos + 1] = (blip_sample_t) FMUL( new_reverb_r, reverb_level );
-		reverb_pos = (reverb_pos + 2) & reverb_mask;
+			reverb_w [i * 2    ] = (blip_sample_t) FMUL( new_reverb_l, reverb_level );
+			reverb_w [i * 2 + 1] = (blip_sample_t) FMUL( new_reverb_r, reverb_level );
 
-		int sum3_s = BLIP_READER_READ( center );
-		BLIP_READER_NEXT( center, bass );
+			int sum3_s = BLIP_READER_READ( center );
+			BLIP_READER_NEXT( center, bass );
 
-		int left = new_reverb_l + sum3_s + BLIP_READER_READ( l2 ) + FMUL( chans.echo_level,
-				echo_buf [(echo_pos + chans.echo_delay_l) & echo_mask] );
-		int right = new_reverb_r + sum3_s + BLIP_READER_READ( r2 ) + FMUL( chans.echo_level,
-				echo_buf [(echo_pos + chans.echo_delay_r) & echo_mask] );
+			int left = new_reverb_l + sum3_s + BLIP_READER_READ( l2 ) +
+					FMUL( echo_level, echo_l [i] );
+			int right = new_reverb_r + sum3_s + BLIP_READER_READ( r2 ) +
+					FMUL( echo_level, echo_r [i] );
 
-		BLIP_READER_NEXT( l2, bass );
-		BLIP_READER_NEXT( r2, bass );
+			BLIP_READER_NEXT( l2, bass );
+			BLIP_READER_NEXT( r2, bass );
 
-		echo_buf [echo_pos] = sum3_s;
-		echo_pos = (echo_pos + 1) & echo_mask;
+			echo_w [i] = sum3_s;
 
-		if ( (int16_t) left != left )
-			left = 0x7FFF - (left >> 24);
+			if ( (int16_t) left != left )
+				left = 0x7FFF - (left >> 24);
 
-		out [0] = left;
-		out [1] = right;
+			out [0] = left;
+			out [1] = right;
 
-		out += 2;
+			out += 2;
 
-		if ( (int16_t) right != right )
-			out [-1] = 0x7FFF - (right >> 24);
+			if ( (int16_t) right != right )
+				out [-1] = 0x7FFF - (right >> 24);
+		}
 	}
 	this->reverb_pos = reverb_pos;
 	this->echo_pos = echo_pos;
@@ -7,6 +7,12 @@
 #include "blargg_common.h"
 #include <string.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#elif defined (__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 class Fir_Resampler_ {
 public:
 
@@ -124,6 +130,58 @@ int Fir_Resampler<width>::read( sample_t* out_begin, blargg_long count )
 			if ( count < 0 )
 				break;
 
+		#if defined (__SSE2__) || defined (__ARM_NEON)
+			// Vectorized dot product over the current phase's taps.  Each
+			// tap is duplicated across a stereo frame, then products are
+			// widened to 32 bits and summed with left samples in even lanes
+			// and right samples in odd lanes; the lanes are folded at the
+			// end.  The phase tables are interleaved the same way as for
+			// the scalar loop, so no separate layout is needed.
+			{
+			#ifdef __SSE2__
+				__m128i acc = _mm_setzero_si128();
+				int n = 0;
+				for ( ; n + 4 <= width; n += 4 )
+				{
+					__m128i c = _mm_loadl_epi64( (__m128i const*) (imp + n) );
+					c = _mm_unpacklo_epi16( c, c );
+					__m128i v = _mm_loadu_si128( (__m128i const*) (i + n * 2) );
+					__m128i lo = _mm_mullo_epi16( c, v );
+					__m128i hi = _mm_mulhi_epi16( c, v );
+					acc = _mm_add_epi32( acc, _mm_unpacklo_epi16( lo, hi ) );
+					acc = _mm_add_epi32( acc, _mm_unpackhi_epi16( lo, hi ) );
+				}
+				acc = _mm_add_epi32( acc,
+						_mm_shuffle_epi32( acc, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+				l = _mm_cvtsi128_si32( acc );
+				r = _mm_cvtsi128_si32( _mm_shuffle_epi32( acc, _MM_SHUFFLE( 0, 0, 0, 1 ) ) );
+			#else
+				int32x4_t acc = vdupq_n_s32( 0 );
+				int n = 0;
+				for ( ; n + 4 <= width; n += 4 )
+				{
+					int16x4_t c = vld1_s16( imp + n );
+					int16x4x2_t cc = vzip_s16( c, c );
+					int16x8_t v = vld1q_s16( i + n * 2 );
+					acc = vmlal_s16( acc, cc.val [0], vget_low_s16( v ) );
+					acc = vmlal_s16( acc, cc.val [1], vget_high_s16( v ) );
+				}
+				acc = vaddq_s32( acc, vextq_s32( acc, acc, 2 ) );
+				l = vgetq_lane_s32( acc, 0 );
+				r = vgetq_lane_s32( acc, 1 );
+			#endif
+				for ( ; n < width; n += 2 )
+				{
+					int pt0 = imp [n];
+					l += pt0 * i [n * 2];
+					r += pt0 * i [n * 2 + 1];
+					int pt1 = imp [n + 1];
+					l += pt1 * i [n * 2 + 2];
+					r += pt1 * i [n * 2 + 3];
+				}
+				imp += width;
+			}
+		#else
 			for ( int n = width / 2; n; --n )
 			{
 				int pt0 = imp [0];
@@ -135,6 +193,7 @@ int Fir_Resampler<width>::read( sample_t* out_begin, blargg_long count )
 				r += pt1 * i [3];
 				i += 4;
 			}
+		#endif
 
 			remain--;
 
@@ -145,23 +145,34 @@ void Gb_Square::run( blip_time_t time, blip_time_t end_time, int playing )
 	if ( time < end_time )
 	{
 		int const period = (2048 - frequency) * 4;
-		Blip_Buffer* const output = this->output;
-		int phase = this->phase;
-		int delta = amp * 2;
-		do
+		if ( !volume )
+		{
+			// muted; advance phase over the whole span at once rather than
+			// stepping through it emitting zero deltas
+			int count = (end_time - time + period - 1) / period;
+			this->phase = (phase + count) & 7;
+			time += count * period;
+		}
+		else
 		{
-			phase = (phase + 1) & 7;
-			if ( phase == 0 || phase == duty )
+			Blip_Buffer* const output = this->output;
+			int phase = this->phase;
+			int delta = amp * 2;
+			do
 			{
-				delta = -delta;
-				synth->offset_inline( time, delta, output );
+				phase = (phase + 1) & 7;
+				if ( phase == 0 || phase == duty )
+				{
+					delta = -delta;
+					synth->offset_inline( time, delta, output );
+				}
+				time += period;
 			}
-			time += period;
-		}
-		while ( time < end_time );
+			while ( time < end_time );
 
-		this->phase = phase;
-		last_amp = delta >> 1;
+			this->phase = phase;
+			last_amp = delta >> 1;
+		}
 	}
 	delay = time - end_time;
 }
@@ -193,31 +204,51 @@ void Gb_Noise::run( blip_time_t time, blip_time_t end_time, int playing )
 		static unsigned char const table [8] = { 8, 16, 32, 48, 64, 80, 96, 112 };
 		int period = table [regs [3] & 7] << (regs [3] >> 4);
 
-		// keep parallel resampled time to eliminate time conversion in the loop
-		Blip_Buffer* const output = this->output;
-		const blip_resampled_time_t resampled_period =
-				output->resampled_duration( period );
-		blip_resampled_time_t resampled_time = output->resampled_time( time );
-		unsigned bits = this->bits;
-		int delta = amp * 2;
-
-		do
+		if ( !volume )
 		{
-			unsigned changed = (bits >> tap) + 1;
-			time += period;
-			bits <<= 1;
-			if ( changed & 2 )
+			// muted; periods go down to 8 clocks, so just keep the LFSR
+			// honest without any synthesis work
+			unsigned bits = this->bits;
+			do
 			{
-				delta = -delta;
-				bits |= 1;
-				synth->offset_resampled( resampled_time, delta, output );
+				unsigned changed = (bits >> tap) + 1;
+				time += period;
+				bits <<= 1;
+				if ( changed & 2 )
+					bits |= 1;
 			}
-			resampled_time += resampled_period;
+			while ( time < end_time );
+
+			this->bits = bits;
 		}
-		while ( time < end_time );
+		else
+		{
+			// keep parallel resampled time to eliminate time conversion in the loop
+			Blip_Buffer* const output = this->output;
+			const blip_resampled_time_t resampled_period =
+					output->resampled_duration( period );
+			blip_resampled_time_t resampled_time = output->resampled_time( time );
+			unsigned bits = this->bits;
+			int delta = amp * 2;
+
+			do
+			{
+				unsigned changed = (bits >> tap) + 1;
+				time += period;
+				bits <<= 1;
+				if ( changed & 2 )
+				{
+					delta = -delta;
+					bits |= 1;
+					synth->offset_resampled( resampled_time, delta, output );
+				}
+				resampled_time += resampled_period;
+			}
+			while ( time < end_time );
 
-		this->bits = bits;
-		last_amp = delta >> 1;
+			this->bits = bits;
+			last_amp = delta >> 1;
+		}
 	}
 	delay = time - end_time;
 }
@@ -280,8 +311,20 @@ void Gb_Wave::run( blip_time_t time, blip_time_t end_time, int playing )
 
 	if ( time < end_time )
 	{
-		Blip_Buffer* const output = this->output;
 		int const period = (2048 - frequency) * 2;
+
+		if ( !volume )
+		{
+			// muted; every sample shifts down to zero, so just advance the
+			// wave position over the whole span
+			int count = (end_time - time + period - 1) / period;
+			this->wave_pos = (this->wave_pos + count) & (wave_size - 1);
+			time += count * period;
+			delay = time - end_time;
+			return;
+		}
+
+		Blip_Buffer* const output = this->output;
 	 	int wave_pos = (this->wave_pos + 1) & (wave_size - 1);
 
 		do
@@ -91,7 +91,7 @@ typedef unsigned    fuint16;
 typedef unsigned    fuint8;
 typedef blargg_long fint32;
 
-bool Hes_Cpu::run( hes_time_t end_time )
+BLARGG_HOT bool Hes_Cpu::run( hes_time_t end_time )
 {
 	bool illegal_encountered = false;
 	set_end_time( end_time );
@@ -193,7 +193,7 @@ loop:
 
 	fuint16 data;
 	data = clock_table [opcode];
-	if ( (s_time += data) >= 0 )
+	if ( BLARGG_UNLIKELY( (s_time += data) >= 0 ) )
 		goto possibly_out_of_time;
 almost_out_of_time:
 
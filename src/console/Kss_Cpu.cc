@@ -167,7 +167,7 @@ typedef int         fint16;
 typedef unsigned    fuint16;
 typedef unsigned    fuint8;
 
-bool Kss_Cpu::run( cpu_time_t end_time )
+BLARGG_HOT bool Kss_Cpu::run( cpu_time_t end_time )
 {
 	set_end_time( end_time );
 	state_t s = this->state_;
@@ -245,7 +245,7 @@ loop:
 
 	fuint16 data;
 	data = base_timing [opcode];
-	if ( (s_time += data) >= 0 )
+	if ( BLARGG_UNLIKELY( (s_time += data) >= 0 ) )
 		goto possibly_out_of_time;
 almost_out_of_time:
 
@@ -3,6 +3,7 @@
 #include "Music_Emu.h"
 
 #include "Multi_Buffer.h"
+#include <stdlib.h>
 #include <string.h>
 
 /* Copyright (C) 2003-2006 Shay Green. This module is free software; you
@@ -20,6 +21,7 @@ Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA */
 
 int const stereo = 2; // number of channels for stereo
 int const silence_max = 6; // seconds
+int const snapshot_period = 10; // seconds of track time between seek snapshots
 int const silence_threshold = 0x10;
 long const fade_block_size = 512;
 int const fade_shift = 8; // fade ends with gain at 1.0 / (1 << fade_shift)
@@ -44,6 +46,7 @@ void Music_Emu::clear_track_vars()
 void Music_Emu::unload()
 {
 	voice_count_ = 0;
+	clear_snapshots();
 	clear_track_vars();
 	Gme_File::unload();
 }
@@ -52,6 +55,9 @@ Music_Emu::Music_Emu()
 {
 	effects_buffer = 0;
 
+	snapshot_count     = 0;
+	next_snapshot_time = 0;
+
 	sample_rate_ = 0;
 	mute_mask_   = 0;
 	tempo_       = 1.0;
@@ -72,7 +78,11 @@ Music_Emu::Music_Emu()
 	Music_Emu::unload(); // non-virtual
 }
 
-Music_Emu::~Music_Emu() { delete effects_buffer; }
+Music_Emu::~Music_Emu()
+{
+	clear_snapshots();
+	delete effects_buffer;
+}
 
 blargg_err_t Music_Emu::set_sample_rate( long rate )
 {
@@ -131,6 +141,9 @@ void Music_Emu::post_load_()
 
 blargg_err_t Music_Emu::start_track( int track )
 {
+	if ( track != current_track_ )
+		clear_snapshots();
+
 	clear_track_vars();
 
 	int remapped = track;
@@ -184,11 +197,67 @@ long Music_Emu::tell() const
 	return sec * 1000 + (out_time - sec * rate) * 1000 / rate;
 }
 
+// Seek snapshots
+
+void Music_Emu::clear_snapshots()
+{
+	while ( snapshot_count )
+		free( snapshots [--snapshot_count].data );
+	next_snapshot_time = 0;
+}
+
+void Music_Emu::take_snapshot()
+{
+	long size = state_size_();
+	if ( !size || snapshot_count >= max_snapshots || emu_track_ended_ )
+		return;
+
+	byte* data = (byte*) malloc( size );
+	if ( !data )
+		return; // not fatal; seeks fall back to re-emulating from time zero
+
+	save_state_( data );
+	snapshots [snapshot_count].time = emu_time;
+	snapshots [snapshot_count].data = data;
+	snapshot_count++;
+	next_snapshot_time = emu_time + snapshot_period * stereo * sample_rate();
+}
+
+bool Music_Emu::restore_snapshot( blargg_long time )
+{
+	int best = -1;
+	for ( int i = 0; i < snapshot_count; i++ )
+	{
+		if ( snapshots [i].time <= time &&
+				(best < 0 || snapshots [i].time > snapshots [best].time) )
+			best = i;
+	}
+	if ( best < 0 )
+		return false;
+
+	int track = current_track_;
+	clear_track_vars();
+	current_track_ = track;
+
+	load_state_( snapshots [best].data );
+	remute_voices();
+
+	out_time         = snapshots [best].time;
+	emu_time         = snapshots [best].time;
+	emu_track_ended_ = false;
+	track_ended_     = false;
+	return true;
+}
+
 blargg_err_t Music_Emu::seek( long msec )
 {
 	blargg_long time = msec_to_samples( msec );
 	if ( time < out_time )
-		RETURN_ERR( start_track( current_track_ ) );
+	{
+		// resume from the nearest earlier snapshot rather than time zero
+		if ( !restore_snapshot( time ) )
+			RETURN_ERR( start_track( current_track_ ) );
+	}
 	return skip( time - out_time );
 }
 
@@ -208,10 +277,22 @@ blargg_err_t Music_Emu::skip( long count )
 		count -= n;
 	}
 
-	if ( count && !emu_track_ended_ )
+	// emulate in pieces no longer than the snapshot period, so regions
+	// skipped over still leave snapshots behind for later seeks back
+	while ( count && !emu_track_ended_ )
 	{
-		emu_time += count;
-		end_track_if_error( skip_( count ) );
+		if ( emu_time >= next_snapshot_time )
+			take_snapshot();
+
+		blargg_long n = count;
+		blargg_long until = next_snapshot_time - emu_time;
+		if ( state_size_() && snapshot_count < max_snapshots &&
+				0 < until && until < n )
+			n = until;
+
+		emu_time += n;
+		count    -= n;
+		end_track_if_error( skip_( n ) );
 	}
 
 	if ( !(silence_count | buf_remain) ) // caught up to emulator, so update track ended
@@ -393,6 +474,9 @@ blargg_err_t Music_Emu::play( long out_count, sample_t* out )
 
 		if ( out_time > fade_start )
 			handle_fade( out_count, out );
+
+		if ( emu_time >= next_snapshot_time )
+			take_snapshot();
 	}
 	out_time += out_count;
 	return 0;
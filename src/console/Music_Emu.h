@@ -122,6 +122,15 @@ protected:
 	virtual blargg_err_t start_track_( int ) = 0; // tempo is set before this
 	virtual blargg_err_t play_( long count, sample_t* out ) = 0;
 	virtual blargg_err_t skip_( long count );
+
+	// Seek acceleration. An emulator whose complete state lives in its own
+	// members can override these; seek() then resumes from a periodic state
+	// snapshot instead of re-emulating from time zero. Snapshots are raw
+	// in-memory images and are only ever restored into the object that
+	// saved them, so interior pointers stay valid.
+	virtual long state_size_() const { return 0; }
+	virtual void save_state_( void* ) const { }
+	virtual void load_state_( void const* ) { }
 protected:
 	virtual void unload();
 	virtual void pre_load();
@@ -148,6 +157,16 @@ private:
 	void clear_track_vars();
 	void end_track_if_error( blargg_err_t );
 
+	// seek snapshots
+	enum { max_snapshots = 64 };
+	struct snapshot_t { blargg_long time; byte* data; };
+	snapshot_t snapshots [max_snapshots];
+	int snapshot_count;
+	blargg_long next_snapshot_time;
+	void take_snapshot();
+	void clear_snapshots();
+	bool restore_snapshot( blargg_long time );
+
 	// fading
 	blargg_long fade_start;
 	int fade_step;
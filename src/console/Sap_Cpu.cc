@@ -72,7 +72,7 @@ typedef unsigned    fuint16;
 typedef unsigned    fuint8;
 typedef blargg_long fint32;
 
-bool Sap_Cpu::run( sap_time_t end_time )
+BLARGG_HOT bool Sap_Cpu::run( sap_time_t end_time )
 {
 	bool illegal_encountered = false;
 	set_end_time( end_time );
@@ -159,7 +159,7 @@ loop:
 
 	fuint16 data;
 	data = clock_table [opcode];
-	if ( (s_time += data) >= 0 )
+	if ( BLARGG_UNLIKELY( (s_time += data) >= 0 ) )
 		goto possibly_out_of_time;
 almost_out_of_time:
 
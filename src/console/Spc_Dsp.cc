@@ -18,6 +18,12 @@ Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA */
 
 #include "blargg_source.h"
 
+#ifdef __SSE4_1__
+	#include <smmintrin.h>
+#elif defined (__ARM_NEON)
+	#include <arm_neon.h>
+#endif
+
 #ifdef BLARGG_ENABLE_OPTIMIZER
 	#include BLARGG_ENABLE_OPTIMIZER
 #endif
@@ -568,6 +574,38 @@ skip_brr:
 		echo_hist_pos [0] [1] = echo_hist_pos [8] [1] = echo_in_r;
 
 		#define CALC_FIR_( i, in )  ((in) * (int8_t) REG(fir + i * 0x10))
+		#if defined (__SSE4_1__) || defined (__ARM_NEON)
+			// The eight history pairs at echo_hist_pos [1..8] are contiguous
+			// ([8] duplicates the newest pair, so no wrap occurs), making the
+			// filter a plain dot product against the pair-duplicated
+			// coefficients: four 4-lane multiply-accumulates and one
+			// horizontal fold instead of sixteen scalar multiply-adds.
+			int32_t fir_coef [16];
+			for ( int i = 0; i < 8; i++ )
+				fir_coef [i * 2] = fir_coef [i * 2 + 1] = (int8_t) REG(fir + i * 0x10);
+
+			int32_t const* hist = (int32_t const*) &echo_hist_pos [1] [0];
+
+			#ifdef __SSE4_1__
+				__m128i acc = _mm_mullo_epi32(
+						_mm_loadu_si128( (__m128i const*) hist ),
+						_mm_loadu_si128( (__m128i const*) fir_coef ) );
+				for ( int i = 4; i < 16; i += 4 )
+					acc = _mm_add_epi32( acc, _mm_mullo_epi32(
+							_mm_loadu_si128( (__m128i const*) (hist + i) ),
+							_mm_loadu_si128( (__m128i const*) (fir_coef + i) ) ) );
+				acc = _mm_add_epi32( acc, _mm_shuffle_epi32( acc, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+				echo_in_l = _mm_cvtsi128_si32( acc );
+				echo_in_r = _mm_extract_epi32( acc, 1 );
+			#else
+				int32x4_t acc = vmulq_s32( vld1q_s32( hist ), vld1q_s32( fir_coef ) );
+				for ( int i = 4; i < 16; i += 4 )
+					acc = vmlaq_s32( acc, vld1q_s32( hist + i ), vld1q_s32( fir_coef + i ) );
+				int32x2_t fold = vadd_s32( vget_low_s32( acc ), vget_high_s32( acc ) );
+				echo_in_l = vget_lane_s32( fold, 0 );
+				echo_in_r = vget_lane_s32( fold, 1 );
+			#endif
+		#else
 		echo_in_l = CALC_FIR_( 7, echo_in_l );
 		echo_in_r = CALC_FIR_( 7, echo_in_r );
 
@@ -585,6 +623,7 @@ skip_brr:
 		DO_FIR( 4 );
 		DO_FIR( 5 );
 		DO_FIR( 6 );
+		#endif
 
 		// Echo out
 		if ( !(REG(flg) & 0x20) )
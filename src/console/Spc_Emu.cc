@@ -309,6 +309,22 @@ blargg_err_t Spc_Emu::play_and_filter( long count, sample_t out [] )
 	return 0;
 }
 
+// The SPC emulator keeps its complete state in its own members, so a raw
+// copy of the APU object doubles as a seek snapshot. Interior pointers
+// stay valid because a snapshot is only restored into the object that
+// saved it. The resampler and filter just hold a few samples of output
+// latency, so they are cleared rather than saved.
+long Spc_Emu::state_size_() const { return sizeof apu; }
+
+void Spc_Emu::save_state_( void* out ) const { memcpy( out, &apu, sizeof apu ); }
+
+void Spc_Emu::load_state_( void const* in )
+{
+	memcpy( &apu, in, sizeof apu );
+	resampler.clear();
+	filter.clear();
+}
+
 blargg_err_t Spc_Emu::skip_( long count )
 {
 	if ( sample_rate() != native_sample_rate )
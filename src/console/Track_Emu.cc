@@ -165,19 +165,27 @@ bool Track_Emu::play( int out_count, Music_Emu::sample_t* out )
 		( emu_time - silence_time > silence_max * stereo * emu->sample_rate() && silence_time ) )
 		end_track();
 
-	// fade if track is ending
+	// fade if track is ending; buffers before the fade window take only the
+	// comparison above
 	if ( out_time > fade_time )
 	{
+		// advance the gain incrementally, one multiply per block, instead of
+		// recomputing pow() for every block
+		double gain = pow( fade_factor, (double) (out_time - fade_time) );
+		double const block_factor = pow( fade_factor, (double) fade_block_size );
+
 		for ( int i = 0; i < out_count; i += fade_block_size )
 		{
-			double gain = pow( fade_factor, (double) (out_time + i - fade_time) );
 			if ( gain < 0.005 )
 				end_track();
 
 			int count = min( fade_block_size, out_count - i );
-			int igain = (unsigned int)((double)gain * (1 << 15));;
+			int igain = (unsigned int)((double)gain * (1 << 15));
+			Music_Emu::sample_t* io = &out [i];
 			for ( int j = 0; j < count; j++ )
-				out [i + j] = (out [i + j] * igain) >> 15;
+				io [j] = (io [j] * igain) >> 15;
+
+			gain *= block_factor;
 		}
 	}
 
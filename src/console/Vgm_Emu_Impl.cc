@@ -37,7 +37,12 @@ enum {
 	cmd_pcm_seek        = 0xE0,
 
 	pcm_block_type      = 0x00,
-	ym2612_dac_port     = 0x2A
+	ym2612_dac_port     = 0x2A,
+
+	// fm_command_t::chip
+	fm_chip_2612_port0  = 0,
+	fm_chip_2612_port1  = 1,
+	fm_chip_2413        = 2
 };
 
 inline int command_len( int command )
@@ -100,6 +105,183 @@ inline blip_time_t Vgm_Emu_Impl::to_blip_time( vgm_time_t t ) const
 	return (t * blip_time_factor) >> blip_time_bits;
 }
 
+// FM worker thread
+// Applies queued writes in order with the same run_until()-then-write sequence
+// the serial code used, so output is identical; only the thread doing the FM
+// synthesis differs. The worker alone touches the YM chips (and the FM half of
+// the output buffer) between fm_frame_begin() and fm_frame_wait().
+
+Vgm_Emu_Impl::Vgm_Emu_Impl()
+{
+	fm_command_count  = 0;
+	fm_consumed       = 0;
+	fm_final_time     = -1;
+	fm_frame_done     = false;
+	fm_thread_running = false;
+	fm_thread_failed  = false;
+	fm_thread_quit    = false;
+	pthread_mutex_init( &fm_mutex, nullptr );
+	pthread_cond_init( &fm_cond, nullptr );
+}
+
+Vgm_Emu_Impl::~Vgm_Emu_Impl()
+{
+	if ( fm_thread_running )
+	{
+		pthread_mutex_lock( &fm_mutex );
+		fm_thread_quit = true;
+		pthread_cond_broadcast( &fm_cond );
+		pthread_mutex_unlock( &fm_mutex );
+		pthread_join( fm_thread, nullptr );
+	}
+	pthread_cond_destroy( &fm_cond );
+	pthread_mutex_destroy( &fm_mutex );
+}
+
+void* Vgm_Emu_Impl::fm_thread_func( void* self )
+{
+	((Vgm_Emu_Impl*) self)->fm_worker();
+	return nullptr;
+}
+
+void Vgm_Emu_Impl::fm_apply( fm_command_t const& cmd )
+{
+	switch ( cmd.chip )
+	{
+	case fm_chip_2612_port0:
+		if ( ym2612.run_until( cmd.time ) )
+			ym2612.write0( cmd.addr, cmd.data );
+		break;
+
+	case fm_chip_2612_port1:
+		if ( ym2612.run_until( cmd.time ) )
+			ym2612.write1( cmd.addr, cmd.data );
+		break;
+
+	case fm_chip_2413:
+		if ( ym2413.run_until( cmd.time ) )
+			ym2413.write( cmd.addr, cmd.data );
+		break;
+	}
+}
+
+void Vgm_Emu_Impl::fm_worker()
+{
+	pthread_mutex_lock( &fm_mutex );
+	while ( !fm_thread_quit )
+	{
+		if ( fm_consumed < fm_command_count )
+		{
+			// batch everything queued so far; slots below fm_command_count are
+			// never rewritten, so they can be read outside the lock
+			int end = fm_command_count;
+			pthread_mutex_unlock( &fm_mutex );
+			for ( int i = fm_consumed; i < end; i++ )
+				fm_apply( fm_commands [i] );
+			pthread_mutex_lock( &fm_mutex );
+			fm_consumed = end;
+			pthread_cond_broadcast( &fm_cond );
+			continue;
+		}
+
+		if ( fm_final_time >= 0 )
+		{
+			fm_time_t time = fm_final_time;
+			fm_final_time = -1;
+			pthread_mutex_unlock( &fm_mutex );
+			ym2612.run_until( time );
+			ym2413.run_until( time );
+			pthread_mutex_lock( &fm_mutex );
+			fm_frame_done = true;
+			pthread_cond_broadcast( &fm_cond );
+			continue;
+		}
+
+		pthread_cond_wait( &fm_cond, &fm_mutex );
+	}
+	pthread_mutex_unlock( &fm_mutex );
+}
+
+void Vgm_Emu_Impl::fm_queue( int chip, fm_time_t time, int addr, int data )
+{
+	if ( !fm_thread_running )
+	{
+		// serial fallback (thread couldn't be created)
+		fm_command_t cmd;
+		cmd.time = time;
+		cmd.chip = chip;
+		cmd.addr = addr;
+		cmd.data = data;
+		fm_apply( cmd );
+		return;
+	}
+
+	pthread_mutex_lock( &fm_mutex );
+	if ( fm_command_count >= max_fm_commands )
+	{
+		// queue full (pathologically dense frame); drain it, then reuse the slots
+		while ( fm_consumed < fm_command_count )
+			pthread_cond_wait( &fm_cond, &fm_mutex );
+		fm_command_count = 0;
+		fm_consumed      = 0;
+	}
+	fm_command_t& cmd = fm_commands [fm_command_count];
+	cmd.time = time;
+	cmd.chip = chip;
+	cmd.addr = addr;
+	cmd.data = data;
+	fm_command_count++;
+	pthread_cond_broadcast( &fm_cond );
+	pthread_mutex_unlock( &fm_mutex );
+}
+
+void Vgm_Emu_Impl::fm_frame_begin()
+{
+	if ( !fm_thread_running && !fm_thread_failed )
+	{
+		// created on first use so PSG-only streams never pay for a thread
+		if ( !pthread_create( &fm_thread, nullptr, fm_thread_func, this ) )
+			fm_thread_running = true;
+		else
+			fm_thread_failed = true; // stay serial from here on
+	}
+
+	// worker is idle between frames, but take the lock so it can't observe
+	// the counters mid-reset after waking spuriously
+	pthread_mutex_lock( &fm_mutex );
+	fm_command_count = 0;
+	fm_consumed      = 0;
+	fm_frame_done    = false;
+	pthread_mutex_unlock( &fm_mutex );
+}
+
+void Vgm_Emu_Impl::fm_frame_end( fm_time_t pairs )
+{
+	if ( !fm_thread_running )
+	{
+		ym2612.run_until( pairs );
+		ym2413.run_until( pairs );
+		fm_frame_done = true;
+		return;
+	}
+
+	pthread_mutex_lock( &fm_mutex );
+	fm_final_time = pairs;
+	pthread_cond_broadcast( &fm_cond );
+	pthread_mutex_unlock( &fm_mutex );
+}
+
+void Vgm_Emu_Impl::fm_frame_wait()
+{
+	if ( !fm_thread_running )
+		return;
+
+	pthread_mutex_lock( &fm_mutex );
+	while ( !fm_frame_done )
+		pthread_cond_wait( &fm_cond, &fm_mutex );
+	pthread_mutex_unlock( &fm_mutex );
+}
+
 void Vgm_Emu_Impl::write_pcm( vgm_time_t vgm_time, int amp )
 {
 	blip_time_t blip_time = to_blip_time( vgm_time );
@@ -158,9 +340,11 @@ blip_time_t Vgm_Emu_Impl::run_commands( vgm_time_t end_time )
 			vgm_time += *pos++;
 			break;
 
+		// FM writes are handed to the worker; enabled() is checked here since
+		// the serial code's run_until() only rejected writes to a disabled chip
 		case cmd_ym2413:
-			if ( ym2413.run_until( to_fm_time( vgm_time ) ) )
-				ym2413.write( pos [0], pos [1] );
+			if ( ym2413.enabled() )
+				fm_queue( fm_chip_2413, to_fm_time( vgm_time ), pos [0], pos [1] );
 			pos += 2;
 			break;
 
@@ -169,21 +353,22 @@ blip_time_t Vgm_Emu_Impl::run_commands( vgm_time_t end_time )
 			{
 				write_pcm( vgm_time, pos [1] );
 			}
-			else if ( ym2612.run_until( to_fm_time( vgm_time ) ) )
+			else if ( ym2612.enabled() )
 			{
 				if ( pos [0] == 0x2B )
 				{
+					// DAC enable feeds the main thread's PCM synthesis, not the chip
 					dac_disabled = (pos [1] >> 7 & 1) - 1;
 					dac_amp |= dac_disabled;
 				}
-				ym2612.write0( pos [0], pos [1] );
+				fm_queue( fm_chip_2612_port0, to_fm_time( vgm_time ), pos [0], pos [1] );
 			}
 			pos += 2;
 			break;
 
 		case cmd_ym2612_port1:
-			if ( ym2612.run_until( to_fm_time( vgm_time ) ) )
-				ym2612.write1( pos [0], pos [1] );
+			if ( ym2612.enabled() )
+				fm_queue( fm_chip_2612_port1, to_fm_time( vgm_time ), pos [0], pos [1] );
 			pos += 2;
 			break;
 
@@ -256,15 +441,24 @@ int Vgm_Emu_Impl::play_frame( blip_time_t blip_time, int sample_count, sample_t*
 		ym2413.begin_frame( buf );
 	}
 
+	// with an FM chip active, its synthesis runs on the worker while this
+	// thread parses commands and renders the PSG/DAC into blip_buf
+	bool use_worker = ym2612.enabled() || ym2413.enabled();
+	if ( use_worker )
+		fm_frame_begin();
+
 	run_commands( vgm_time );
-	ym2612.run_until( pairs );
-	ym2413.run_until( pairs );
+	if ( use_worker )
+		fm_frame_end( pairs );
 
 	fm_time_offset = (vgm_time * fm_time_factor + fm_time_offset) -
 			((long) pairs << fm_time_bits);
 
 	psg.end_frame( blip_time );
 
+	if ( use_worker )
+		fm_frame_wait(); // FM buffer must be complete before it's mixed
+
 	return pairs * stereo;
 }
 
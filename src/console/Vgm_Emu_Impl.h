@@ -10,6 +10,8 @@
 #include "Ym2612_Emu.h"
 #include "Sms_Apu.h"
 
+#include <pthread.h>
+
 template<class Emu>
 class Ym_Emu : public Emu {
 protected:
@@ -27,6 +29,8 @@ public:
 class Vgm_Emu_Impl : public Classic_Emu, private Dual_Resampler {
 public:
 	typedef Classic_Emu::sample_t sample_t;
+	Vgm_Emu_Impl();
+	~Vgm_Emu_Impl();
 protected:
 	enum { stereo = 2 };
 
@@ -65,6 +69,37 @@ protected:
 	Sms_Apu psg;
 	Blip_Synth<blip_med_quality,1> dac_synth;
 
+	// FM register writes are queued by run_commands() and replayed on a worker
+	// thread, which runs the YM chips while the main thread keeps parsing
+	// commands and synthesizing the PSG and DAC; the two halves only meet at
+	// the final FM+PSG mix, so play_frame() waits at a barrier before returning
+	enum { max_fm_commands = 8 * 1024 };
+	struct fm_command_t {
+		fm_time_t time;
+		byte chip;
+		byte addr;
+		byte data;
+	};
+	fm_command_t fm_commands [max_fm_commands];
+	int fm_command_count;   // written by main thread (producer)
+	int fm_consumed;        // advanced by worker thread
+	fm_time_t fm_final_time; // end-of-frame run_until() target, -1 until set
+	bool fm_frame_done;
+	bool fm_thread_running;
+	bool fm_thread_failed;
+	bool fm_thread_quit;
+	pthread_t fm_thread;
+	pthread_mutex_t fm_mutex;
+	pthread_cond_t fm_cond;
+
+	static void* fm_thread_func( void* );
+	void fm_worker();
+	void fm_apply( fm_command_t const& );
+	void fm_queue( int chip, fm_time_t time, int addr, int data );
+	void fm_frame_begin();
+	void fm_frame_end( fm_time_t pairs );
+	void fm_frame_wait();
+
 	friend class Vgm_Emu;
 };
 
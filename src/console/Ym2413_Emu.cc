@@ -2205,6 +2205,9 @@ void Ym2413_Emu::mute_voices( int mask )
 
 void Ym2413_Emu::run( int pair_count, sample_t* out )
 {
+	// emu2413 exposes only per-sample synthesis; its modulator->carrier FM
+	// chains and per-sample LFO/rhythm state keep OPLL_calc() serial, so the
+	// block structure lives in the callers (Vgm_Emu batches between commands).
 	while ( pair_count-- )
 	{
 		int s = OPLL_calc( opll );
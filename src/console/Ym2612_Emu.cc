@@ -1038,6 +1038,13 @@ struct ym2612_update_chan {
 
 typedef void (*ym2612_update_chan_t)( tables_t&, channel_t&, Ym2612_Emu::sample_t*, int );
 
+// Synthesizes a whole block of samples for one channel.  The algorithm
+// number is a template parameter, so each of the eight operator topologies
+// compiles to a straight-line loop body; the sine and TL (exp) lookups are
+// already fused into the single SINT() chain.  The operators themselves are
+// serially chained (each one's output phase-modulates the next, plus the
+// slot 0 feedback path), so they cannot be spread across SIMD lanes without
+// changing the emulation.
 template<int algo>
 void ym2612_update_chan<algo>::func( tables_t& g, channel_t& ch,
 		Ym2612_Emu::sample_t* buf, int length )
@@ -0,0 +1,166 @@
+// Zstd counterpart of Gzip_Reader; decompresses through a single reusable
+// input window rather than inflating the whole file up front.
+
+#include "Zstd_Reader.h"
+
+#include "blargg_source.h"
+
+bool Zstd_Reader::detect( const void* header, long size )
+{
+	// zstd frame magic, 0xFD2FB528 little-endian
+	unsigned char const* h = (unsigned char const*) header;
+	return size >= 4 &&
+			h [0] == 0x28 && h [1] == 0xB5 && h [2] == 0x2F && h [3] == 0xFD;
+}
+
+#ifdef HAVE_ZSTD
+
+void Zstd_Reader::close()
+{
+	in    = 0;
+	tell_ = 0;
+	size_ = 0;
+	stream_end = false;
+	zin.src  = 0;
+	zin.size = 0;
+	zin.pos  = 0;
+	if ( stream )
+	{
+		ZSTD_freeDStream( stream );
+		stream = 0;
+	}
+	buf.clear();
+}
+
+Zstd_Reader::Zstd_Reader()
+{
+	stream = 0;
+	close();
+}
+
+Zstd_Reader::~Zstd_Reader() { close(); }
+
+blargg_err_t Zstd_Reader::fill_buf()
+{
+	long count = in->read_avail( buf.begin(), buf.size() );
+	if ( count < 0 )
+		return "Read error";
+	zin.src  = buf.begin();
+	zin.size = count;
+	zin.pos  = 0;
+	return 0;
+}
+
+blargg_err_t Zstd_Reader::open( File_Reader* new_in )
+{
+	close();
+	in = new_in;
+
+	RETURN_ERR( buf.resize( ZSTD_DStreamInSize() ) );
+
+	stream = ZSTD_createDStream();
+	if ( !stream )
+	{
+		close();
+		return "Out of memory";
+	}
+
+	blargg_err_t err = fill_buf();
+	if ( !err && !detect( buf.begin(), (long) zin.size ) )
+		err = "Not a zstd file";
+
+	// Frame header records the decompressed size, which lets callers make
+	// a single full-size allocation from remain() instead of growing one.
+	unsigned long long size = 0;
+	if ( !err )
+	{
+		size = ZSTD_getFrameContentSize( buf.begin(), zin.size );
+		if ( size == ZSTD_CONTENTSIZE_ERROR || size == ZSTD_CONTENTSIZE_UNKNOWN ||
+				size > 0x7FFFFFFF )
+			err = "Zstd file lacks decompressed size";
+	}
+
+	if ( err )
+	{
+		close();
+		return err;
+	}
+
+	size_ = size;
+	return 0;
+}
+
+long Zstd_Reader::remain() const
+{
+	return size_ - tell_;
+}
+
+blargg_err_t Zstd_Reader::read_( void* out, long* count )
+{
+	ZSTD_outBuffer zout = { out, (size_t) *count, 0 };
+
+	while ( zout.pos < zout.size && !stream_end )
+	{
+		if ( zin.pos == zin.size )
+		{
+			RETURN_ERR( fill_buf() );
+			if ( !zin.size )
+				return "Corrupt zstd file"; // stream didn't end but no more data
+		}
+
+		size_t ret = ZSTD_decompressStream( stream, &zout, &zin );
+		if ( ZSTD_isError( ret ) )
+			return ZSTD_getErrorName( ret );
+		if ( !ret )
+			stream_end = true;
+	}
+
+	*count = zout.pos;
+	tell_ += zout.pos;
+	return 0;
+}
+
+blargg_err_t Zstd_Reader::read( void* out, long count )
+{
+	if ( in )
+	{
+		long actual = count;
+		RETURN_ERR( read_( out, &actual ) );
+		if ( actual == count )
+			return 0;
+	}
+	return eof_error;
+}
+
+long Zstd_Reader::read_avail( void* out, long count )
+{
+	if ( !in || read_( out, &count ) )
+		count = -1;
+	return count;
+}
+
+#else // !HAVE_ZSTD
+
+void Zstd_Reader::close()
+{
+	in    = 0;
+	tell_ = 0;
+	size_ = 0;
+}
+
+Zstd_Reader::Zstd_Reader() { close(); }
+
+Zstd_Reader::~Zstd_Reader() { }
+
+blargg_err_t Zstd_Reader::open( File_Reader* )
+{
+	return "Zstd support not compiled in";
+}
+
+long Zstd_Reader::remain() const { return 0; }
+
+blargg_err_t Zstd_Reader::read( void*, long ) { return eof_error; }
+
+long Zstd_Reader::read_avail( void*, long ) { return -1; }
+
+#endif
@@ -0,0 +1,42 @@
+// Transparently decompresses zstd files in the Data_Reader stack
+
+#ifndef ZSTD_READER_H
+#define ZSTD_READER_H
+
+#include "Data_Reader.h"
+#include "blargg_common.h"
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+class Zstd_Reader : public Data_Reader {
+public:
+	// True if header begins with a zstd frame (usable without libzstd)
+	static bool detect( const void* header, long size );
+
+	error_t open( File_Reader* );
+	void close();
+
+public:
+	Zstd_Reader();
+	~Zstd_Reader();
+	long remain() const;
+	error_t read( void*, long );
+	long read_avail( void*, long );
+private:
+	File_Reader* in;
+	long tell_;
+	long size_;
+#ifdef HAVE_ZSTD
+	ZSTD_DStream* stream;
+	blargg_vector<unsigned char> buf; // reusable input window
+	ZSTD_inBuffer zin;
+	bool stream_end;
+
+	blargg_err_t read_( void* out, long* count );
+	blargg_err_t fill_buf();
+#endif
+};
+
+#endif
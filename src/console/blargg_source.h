@@ -98,6 +98,21 @@ typedef unsigned char byte;
     #endif
 #endif
 
+// Branch and code-placement hints for the CPU interpreter loops; these
+// keep the out-of-time bookkeeping off the hot dispatch path and let the
+// compiler place run() for instruction cache locality.
+#ifndef BLARGG_HOT
+    #if defined (__GNUC__) || defined (__clang__)
+        #define BLARGG_HOT __attribute__((hot))
+        #define BLARGG_LIKELY( x )   __builtin_expect( !!(x), 1 )
+        #define BLARGG_UNLIKELY( x ) __builtin_expect( !!(x), 0 )
+    #else
+        #define BLARGG_HOT
+        #define BLARGG_LIKELY( x )   (x)
+        #define BLARGG_UNLIKELY( x ) (x)
+    #endif
+#endif
+
 // deprecated
 #define BLARGG_CHECK_ALLOC CHECK_ALLOC
 #define BLARGG_RETURN_ERR RETURN_ERR
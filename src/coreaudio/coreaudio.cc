@@ -32,7 +32,6 @@
 #include <libaudcore/interface.h>
 #include <libaudcore/plugin.h>
 #include <libaudcore/runtime.h>
-#include <libaudcore/ringbuf.h>
 #include <libaudcore/i18n.h>
 #include <libaudcore/preferences.h>
 #include <libaudcore/drct.h>
@@ -41,6 +40,7 @@
 #include <AudioUnit/AudioUnit.h>
 
 #include "audiodevice.h"
+#include "../output-common/spsc_ringbuf.h"
 
 class CoreAudioPlugin : public OutputPlugin {
 public:
@@ -132,7 +132,7 @@ static struct AudioUnitFormatDescriptionMap AUFormatMap[] = {
     {FMT_FLOAT,  32, sizeof (float),   kAudioFormatFlagIsFloat},
 };
 
-static RingBuf <unsigned char> buffer;
+static SPSCRingBuf <unsigned char> buffer;
 static int vol_left = 0, vol_right = 0;
 static int chan = 0;
 static int rate = 0;
@@ -369,26 +369,28 @@ void CoreAudioPlugin::set_volume (StereoVolume vol)
 
 OSStatus CoreAudioPlugin::callback (void *inRefCon, AudioUnitRenderActionFlags *ioActionFlags, const AudioTimeStamp *inTimeStamp, UInt32 inBusNumber, UInt32 inNumberFrames, AudioBufferList *ioData)
 {
-    pthread_mutex_lock (& mutex);
-
+    /* The ring buffer is lock-free; the realtime render thread must never
+     * block on the mutex while the playback thread holds it. */
     int len = ioData->mBuffers[0].mDataByteSize;
     unsigned char * buf = (unsigned char *) ioData->mBuffers[0].mData;
     ioData->mBuffers[0].mNumberChannels = chan;
 
-    int copy = aud::min (len, buffer.len ());
-
-    buffer.move_out (buf, copy);
+    int copy = buffer.move_out (buf, len);
     if (copy < len)
         memset (buf + copy, 0, len - copy);
 
     /* At this moment, we know that there is a delay of (at least) the block of
      * data just written.  We save the block size and the current time for
-     * estimating the delay later on. */
-    block_delay = copy / (buffer_bytes_per_channel * chan) * 1000 / rate;
-    gettimeofday (& block_time, nullptr);
+     * estimating the delay later on.  If the playback thread holds the mutex,
+     * skip the update rather than block; the estimate is approximate anyway. */
+    if (! pthread_mutex_trylock (& mutex))
+    {
+        block_delay = copy / (buffer_bytes_per_channel * chan) * 1000 / rate;
+        gettimeofday (& block_time, nullptr);
+        pthread_mutex_unlock (& mutex);
+    }
 
     pthread_cond_broadcast (& cond);
-    pthread_mutex_unlock (& mutex);
 
     return 0;
 }
@@ -556,13 +558,7 @@ void CoreAudioPlugin::period_wait ()
 
 int CoreAudioPlugin::write_audio (const void * data, int len)
 {
-    pthread_mutex_lock (& mutex);
-
-    len = aud::min (len, buffer.space ());
-    buffer.copy_in ((const unsigned char *) data, len);
-
-    pthread_mutex_unlock (& mutex);
-    return len;
+    return buffer.copy_in ((const unsigned char *) data, len);
 }
 
 void CoreAudioPlugin::drain ()
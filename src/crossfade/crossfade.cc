@@ -18,6 +18,13 @@
  */
 
 #include <math.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#elif defined (__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #include <libaudcore/i18n.h>
 #include <libaudcore/plugin.h>
 #include <libaudcore/preferences.h>
@@ -106,6 +113,24 @@ static int current_channels, current_rate;
 static Index<float> buffer, output;
 static int fadein_point;
 
+/* Samples already output from the front of the buffer.  Draining advances
+ * this offset instead of removing from the front (which memmoves the whole
+ * overlap); the drained prefix is dropped only when it grows as large as the
+ * remaining data, so steady-state processing does no O(buffer) moves. */
+static int buffer_start;
+
+static int buffered_len ()
+    { return buffer.len () - buffer_start; }
+
+static void compact_buffer ()
+{
+    if (buffer_start > 0)
+    {
+        buffer.remove (0, buffer_start);
+        buffer_start = 0;
+    }
+}
+
 bool Crossfade::init ()
 {
     aud_config_set_defaults ("crossfade", crossfade_defaults);
@@ -117,21 +142,60 @@ void Crossfade::cleanup ()
     state = STATE_OFF;
     buffer.clear ();
     output.clear ();
+    buffer_start = 0;
 }
 
+/* The ramp and mix kernels run over the whole overlap buffer on the playback
+ * thread, so they process four samples per step where SSE2 or NEON is
+ * available; the gain ramp is computed incrementally to avoid the per-sample
+ * division.  The scalar tail also covers builds without either instruction
+ * set. */
+
 static void do_linear_ramp (float * data, int length, float a, float b)
 {
-    for (int i = 0; i < length; i ++)
-        (* data ++) *= (a * (length - i) + b * i) / length;
+    if (length <= 0)
+        return;
+
+    float step = (b - a) / length;
+    int i = 0;
+
+#ifdef __SSE2__
+    __m128 gain = _mm_setr_ps (a, a + step, a + 2 * step, a + 3 * step);
+    __m128 gain_step = _mm_set1_ps (4 * step);
+
+    for (; i + 4 <= length; i += 4)
+    {
+        _mm_storeu_ps (data + i, _mm_mul_ps (_mm_loadu_ps (data + i), gain));
+        gain = _mm_add_ps (gain, gain_step);
+    }
+#elif defined (__ARM_NEON)
+    float32x4_t gain = {a, a + step, a + 2 * step, a + 3 * step};
+    float32x4_t gain_step = vdupq_n_f32 (4 * step);
+
+    for (; i + 4 <= length; i += 4)
+    {
+        vst1q_f32 (data + i, vmulq_f32 (vld1q_f32 (data + i), gain));
+        gain = vaddq_f32 (gain, gain_step);
+    }
+#endif
+
+    for (; i < length; i ++)
+        data[i] *= a + step * i;
 }
 
 static void do_sigmoid_ramp (float * data, int length, float a, float b)
 {
+    if (length <= 0)
+        return;
+
+    /* tanhf() dominates here, so only the ramp is strength-reduced */
     float steepness = aud_get_double ("crossfade", "sigmoid_steepness");
+    float step = (b - a) / length;
+
     for (int i = 0; i < length; i ++)
     {
-        float linear = (a * (length - i) + b * i) / length;
-        (* data ++) *= 0.5f + 0.5f * tanhf (steepness * (linear - 0.5f));
+        float linear = a + step * i;
+        data[i] *= 0.5f + 0.5f * tanhf (steepness * (linear - 0.5f));
     }
 }
 
@@ -143,10 +207,21 @@ static void do_ramp (float * data, int length, float a, float b)
         do_linear_ramp (data, length, a, b);
 }
 
-static void mix (float * data, float * add, int length)
+static void mix (float * data, const float * add, int length)
 {
-    while (length --)
-        (* data ++) += (* add ++);
+    int i = 0;
+
+#ifdef __SSE2__
+    for (; i + 4 <= length; i += 4)
+        _mm_storeu_ps (data + i,
+         _mm_add_ps (_mm_loadu_ps (data + i), _mm_loadu_ps (add + i)));
+#elif defined (__ARM_NEON)
+    for (; i + 4 <= length; i += 4)
+        vst1q_f32 (data + i, vaddq_f32 (vld1q_f32 (data + i), vld1q_f32 (add + i)));
+#endif
+
+    for (; i < length; i ++)
+        data[i] += add[i];
 }
 
 /* stupid simple resampling/rechanneling algorithm */
@@ -155,6 +230,8 @@ static void reformat (int channels, int rate)
     if (channels == current_channels && rate == current_rate)
         return;
 
+    compact_buffer ();
+
     int old_frames = buffer.len () / current_channels;
     int new_frames = (int64_t) old_frames * rate / current_rate;
 
@@ -193,11 +270,17 @@ static int buffer_needed_for_state ()
 
 static void output_data_as_ready (int buffer_needed, bool exact)
 {
-    int copy = buffer.len () - buffer_needed;
+    int copy = buffered_len () - buffer_needed;
 
     /* if allowed, wait until we have at least 1/2 second ready to output */
     if (exact ? (copy > 0) : (copy >= current_channels * (current_rate / 2)))
-        output.move_from (buffer, 0, -1, copy, true, true);
+    {
+        output.insert (buffer.begin () + buffer_start, -1, copy);
+        buffer_start += copy;
+
+        if (buffer_start >= buffered_len ())
+            compact_buffer ();
+    }
 }
 
 void Crossfade::start (int & channels, int & rate)
@@ -222,6 +305,7 @@ void Crossfade::start (int & channels, int & rate)
 
 static void run_fadeout ()
 {
+    compact_buffer ();
     do_ramp (buffer.begin (), buffer.len (), 1.0, 0.0);
 
     state = STATE_FADEIN;
@@ -281,6 +365,8 @@ bool Crossfade::flush (bool force)
     if (! force && aud_get_bool ("crossfade", "manual"))
     {
         state = STATE_FLUSHED;
+        compact_buffer ();
+
         int buffer_needed = buffer_needed_for_state ();
         if (buffer.len () > buffer_needed)
             buffer.remove (buffer_needed, -1);
@@ -290,6 +376,7 @@ bool Crossfade::flush (bool force)
 
     state = STATE_RUNNING;
     buffer.resize (0);
+    buffer_start = 0;
 
     return true;
 }
@@ -326,6 +413,7 @@ Index<float> & Crossfade::finish (Index<float> & data, bool end_of_playlist)
 
     if (end_of_playlist && (state == STATE_FINISHED || state == STATE_FLUSHED))
     {
+        compact_buffer ();
         do_ramp (buffer.begin (), buffer.len (), 1.0, 0.0);
 
         state = STATE_OFF;
@@ -337,5 +425,5 @@ Index<float> & Crossfade::finish (Index<float> & data, bool end_of_playlist)
 
 int Crossfade::adjust_delay (int delay)
 {
-    return delay + aud::rescale<int64_t> (buffer.len () / current_channels, current_rate, 1000);
+    return delay + aud::rescale<int64_t> (buffered_len () / current_channels, current_rate, 1000);
 }
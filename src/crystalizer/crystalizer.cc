@@ -18,6 +18,9 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <math.h>
+#include <string.h>
+
 #include <libaudcore/i18n.h>
 #include <libaudcore/runtime.h>
 #include <libaudcore/plugin.h>
@@ -25,13 +28,31 @@
 
 static const char * const cryst_defaults[] = {
  "intensity", "1",
+ "multiband", "FALSE",
+ "intensity_low", "1",
+ "intensity_mid", "1",
+ "intensity_high", "1",
  nullptr};
 
 static const PreferencesWidget cryst_widgets[] = {
     WidgetLabel (N_("<b>Crystalizer</b>")),
     WidgetSpin (N_("Intensity:"),
         WidgetFloat ("crystalizer", "intensity"),
-        {0, 10, 0.1})
+        {0, 10, 0.1}),
+    WidgetCheck (N_("Multi-band mode"),
+        WidgetBool ("crystalizer", "multiband")),
+    WidgetSpin (N_("Low intensity:"),
+        WidgetFloat ("crystalizer", "intensity_low"),
+        {0, 10, 0.1},
+        WIDGET_CHILD),
+    WidgetSpin (N_("Mid intensity:"),
+        WidgetFloat ("crystalizer", "intensity_mid"),
+        {0, 10, 0.1},
+        WIDGET_CHILD),
+    WidgetSpin (N_("High intensity:"),
+        WidgetFloat ("crystalizer", "intensity_high"),
+        {0, 10, 0.1},
+        WIDGET_CHILD)
 };
 
 static const PluginPreferences cryst_prefs = {{cryst_widgets}};
@@ -58,9 +79,26 @@ public:
 
 EXPORT Crystalizer aud_plugin_instance;
 
+/* Multi-band mode splits each channel into three complementary bands with a
+ * shared pair of one-pole crossovers (low = lp1, mid = lp2 - lp1,
+ * high = x - lp2, so the bands sum back to the input exactly and zero
+ * intensity is still the identity).  The split runs once per sample rather
+ * than once per band, writing planar band data into a reused workspace; the
+ * per-band difference enhancement and the recombine then happen in a single
+ * pass over contiguous planes, which the compiler can vectorize.  Total cost
+ * stays close to the single-band path. */
+
+static constexpr int NumBands = 3;
+static constexpr float cryst_crossover[NumBands - 1] = {250, 4000}; /* Hz */
+
 static int cryst_channels;
 static Index<float> cryst_prev;
 
+static float cryst_k[NumBands - 1];     /* crossover coefficients */
+static Index<float> cryst_split;        /* crossover state, 2 per channel */
+static Index<float> cryst_band_prev;    /* last input sample, NumBands per channel */
+static Index<float> cryst_work;         /* planar band workspace, NumBands * frames */
+
 bool Crystalizer::init ()
 {
     aud_config_set_defaults ("crystalizer", cryst_defaults);
@@ -70,6 +108,9 @@ bool Crystalizer::init ()
 void Crystalizer::cleanup ()
 {
     cryst_prev.clear ();
+    cryst_split.clear ();
+    cryst_band_prev.clear ();
+    cryst_work.clear ();
 }
 
 void Crystalizer::start (int & channels, int & rate)
@@ -77,29 +118,123 @@ void Crystalizer::start (int & channels, int & rate)
     cryst_channels = channels;
     cryst_prev.resize (cryst_channels);
     cryst_prev.erase (0, cryst_channels);
+
+    for (int i = 0; i < NumBands - 1; i ++)
+        cryst_k[i] = 1 - expf (-2 * (float) M_PI * cryst_crossover[i] / rate);
+
+    cryst_split.resize ((NumBands - 1) * cryst_channels);
+    cryst_split.erase (0, cryst_split.len ());
+    cryst_band_prev.resize (NumBands * cryst_channels);
+    cryst_band_prev.erase (0, cryst_band_prev.len ());
+}
+
+static void process_multiband (Index<float> & data)
+{
+    float value[NumBands];
+    value[0] = aud_get_double ("crystalizer", "intensity_low");
+    value[1] = aud_get_double ("crystalizer", "intensity_mid");
+    value[2] = aud_get_double ("crystalizer", "intensity_high");
+
+    int frames = data.len () / cryst_channels;
+    if (! frames)
+        return;
+
+    cryst_work.resize (NumBands * frames);
+
+    for (int channel = 0; channel < cryst_channels; channel ++)
+    {
+        float * in = data.begin () + channel;
+
+        float * low = cryst_work.begin ();
+        float * mid = low + frames;
+        float * high = mid + frames;
+
+        float a = cryst_split[channel * 2];
+        float b = cryst_split[channel * 2 + 1];
+
+        /* shared filter-bank split into the planar workspace */
+        for (int i = 0; i < frames; i ++)
+        {
+            float x = in[i * cryst_channels];
+            a += cryst_k[0] * (x - a);
+            b += cryst_k[1] * (x - b);
+            low[i] = a;
+            mid[i] = b - a;
+            high[i] = x - b;
+        }
+
+        cryst_split[channel * 2] = a;
+        cryst_split[channel * 2 + 1] = b;
+
+        float * prev = & cryst_band_prev[channel * NumBands];
+
+        in[0] = low[0] + (low[0] - prev[0]) * value[0]
+              + mid[0] + (mid[0] - prev[1]) * value[1]
+              + high[0] + (high[0] - prev[2]) * value[2];
+
+        /* per-band enhancement and recombine in one pass; each band plane
+         * is only read, at i and i - 1, so the loop vectorizes */
+        for (int i = 1; i < frames; i ++)
+            in[i * cryst_channels] =
+                  low[i] + (low[i] - low[i - 1]) * value[0]
+                + mid[i] + (mid[i] - mid[i - 1]) * value[1]
+                + high[i] + (high[i] - high[i - 1]) * value[2];
+
+        prev[0] = low[frames - 1];
+        prev[1] = mid[frames - 1];
+        prev[2] = high[frames - 1];
+    }
 }
 
 Index<float> & Crystalizer::process (Index<float> & data)
 {
+    if (aud_get_bool ("crystalizer", "multiband"))
+    {
+        process_multiband (data);
+        return data;
+    }
+
     float value = aud_get_double ("crystalizer", "intensity");
     float * f = data.begin ();
     float * end = data.end ();
 
+    /* intensity 0 is the identity; just keep the history current so
+     * turning the effect back up does not glitch */
+    if (value == 0)
+    {
+        if (data.len () >= cryst_channels)
+            memcpy (cryst_prev.begin (), end - cryst_channels,
+             cryst_channels * sizeof (float));
+
+        return data;
+    }
+
+    /* keep the per-channel history in locals so the inner loop touches only
+     * the sample data, not the Index, and can be vectorized */
+    float prev[AUD_MAX_CHANNELS];
+    for (int channel = 0; channel < cryst_channels; channel ++)
+        prev[channel] = cryst_prev[channel];
+
     while (f < end)
     {
         for (int channel = 0; channel < cryst_channels; channel ++)
         {
             float current = * f;
-            * f ++ = current + (current - cryst_prev[channel]) * value;
-            cryst_prev[channel] = current;
+            * f ++ = current + (current - prev[channel]) * value;
+            prev[channel] = current;
         }
     }
 
+    for (int channel = 0; channel < cryst_channels; channel ++)
+        cryst_prev[channel] = prev[channel];
+
     return data;
 }
 
 bool Crystalizer::flush (bool force)
 {
     cryst_prev.erase (0, cryst_channels);
+    cryst_split.erase (0, cryst_split.len ());
+    cryst_band_prev.erase (0, cryst_band_prev.len ());
     return true;
 }
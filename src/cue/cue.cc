@@ -48,6 +48,73 @@ public:
 
 EXPORT CueLoader aud_plugin_instance;
 
+/* A small cache of recently loaded sheets.  The core re-loads a cue sheet
+ * whenever one of its virtual tracks is resolved, so a 99-track album can
+ * trigger 99 loads, each probing the underlying audio file.  Hits are
+ * validated by comparing the raw sheet text, which is a few kilobytes at
+ * most and stricter than a modification time check (the VFS layer has no
+ * portable mtime anyway). */
+struct CachedSheet {
+    String filename;
+    Index<char> text;
+    Index<PlaylistAddItem> items;
+};
+
+#define CUE_CACHE_SIZE 4
+
+static pthread_mutex_t cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static Index<CachedSheet> sheet_cache;  /* most recently used last */
+
+static bool cache_lookup (const char * cue_filename, const Index<char> & text,
+ Index<PlaylistAddItem> & items)
+{
+    pthread_mutex_lock (& cache_mutex);
+
+    for (int i = sheet_cache.len (); i --; )
+    {
+        CachedSheet & c = sheet_cache[i];
+
+        if (strcmp (c.filename, cue_filename) || c.text.len () != text.len ()
+         || memcmp (c.text.begin (), text.begin (), text.len ()))
+            continue;
+
+        for (auto & item : c.items)
+            items.append (item.filename, item.tuple.ref (), item.decoder);
+
+        /* move to the end of the eviction order */
+        if (i != sheet_cache.len () - 1)
+        {
+            CachedSheet tmp = std::move (c);
+            sheet_cache.remove (i, 1);
+            sheet_cache.append (std::move (tmp));
+        }
+
+        pthread_mutex_unlock (& cache_mutex);
+        return true;
+    }
+
+    pthread_mutex_unlock (& cache_mutex);
+    return false;
+}
+
+static void cache_store (const char * cue_filename, Index<char> && text,
+ const Index<PlaylistAddItem> & items)
+{
+    pthread_mutex_lock (& cache_mutex);
+
+    if (sheet_cache.len () >= CUE_CACHE_SIZE)
+        sheet_cache.remove (0, 1);
+
+    CachedSheet & c = sheet_cache.append ();
+    c.filename = String (cue_filename);
+    c.text = std::move (text);
+
+    for (auto & item : items)
+        c.items.append (item.filename, item.tuple.ref (), item.decoder);
+
+    pthread_mutex_unlock (& cache_mutex);
+}
+
 static bool is_year (const char * s)
 {
     auto is_digit = [] (char c)
@@ -69,6 +136,9 @@ bool CueLoader::load (const char * cue_filename, VFSFile & file, String & title,
 
     buffer.append (0);  /* null-terminate */
 
+    if (cache_lookup (cue_filename, buffer, items))
+        return true;
+
     pthread_mutex_lock (& mutex);
     Cd * cd = cue_parse_string (buffer.begin ());
     pthread_mutex_unlock (& mutex);
@@ -206,5 +276,6 @@ bool CueLoader::load (const char * cue_filename, VFSFile & file, String & title,
         cur_name = next_name;
     }
 
+    cache_store (cue_filename, std::move (buffer), items);
     return true;
 }
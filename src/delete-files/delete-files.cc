@@ -17,6 +17,7 @@
  * the use of this software.
  */
 
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
@@ -25,8 +26,10 @@
 #include <glib/gstdio.h>
 
 #include <libaudcore/audstrings.h>
+#include <libaudcore/hook.h>
 #include <libaudcore/i18n.h>
 #include <libaudcore/interface.h>
+#include <libaudcore/mainloop.h>
 #include <libaudcore/playlist.h>
 #include <libaudcore/plugin.h>
 #include <libaudcore/preferences.h>
@@ -76,7 +79,7 @@ static GtkWidget * dialog = nullptr;
 static QMessageBox * qdialog = nullptr;
 #endif
 
-static bool delete_uri (const char * uri, bool use_trash)
+static bool delete_uri (const char * uri, bool use_trash, String & first_error)
 {
     GFile * gfile = g_file_new_for_uri (uri);
     GError * gerror = nullptr;
@@ -87,7 +90,8 @@ static bool delete_uri (const char * uri, bool use_trash)
 
     if (! success)
     {
-        aud_ui_show_error (gerror->message);
+        if (! first_error)
+            first_error = String (gerror->message);
         g_error_free (gerror);
     }
 
@@ -95,6 +99,131 @@ static bool delete_uri (const char * uri, bool use_trash)
     return success;
 }
 
+/* A confirmed set of files is deleted on a worker thread so that moving
+ * thousands of files to the trash (each a gio round-trip) never blocks
+ * the interface.  The worker only touches gio; playlist updates and
+ * error reporting happen back on the main loop, and failures are
+ * aggregated into a single message instead of one dialog per file. */
+
+struct DeleteJob
+{
+    Playlist playlist;
+    bool use_trash;
+    Index<String> files;
+    Index<String> deleted;
+    String first_error;
+    int n_errors = 0;
+};
+
+static pthread_mutex_t delete_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t delete_cond = PTHREAD_COND_INITIALIZER;
+static Index<SmartPtr<DeleteJob>> finished_jobs;
+static QueuedFunc delete_queued;
+static int jobs_running = 0;
+static int files_done = 0, files_total = 0;
+
+/* runs on the main loop */
+static void finish_job (DeleteJob & job)
+{
+    /* work around -Wignored-attributes on MinGW */
+    auto string_compare = [] (const String & a, const String & b)
+        { return strcmp (a, b); };
+
+    job.deleted.sort (string_compare);
+
+    /* make sure selection matches what we actually deleted,
+     * then drop the whole batch in one playlist mutation */
+    int num_entries = job.playlist.n_entries ();
+    for (int i = 0; i < num_entries; i ++)
+    {
+        int j = job.deleted.bsearch (job.playlist.entry_filename (i), string_compare);
+        job.playlist.select_entry (i, (j >= 0));
+    }
+
+    job.playlist.remove_selected ();
+
+    if (job.n_errors)
+    {
+        StringBuf message = str_printf (_("Failed to delete %d of %d files.\n%s"),
+         job.n_errors, job.files.len (), (const char *) job.first_error);
+        aud_ui_show_error (message);
+    }
+}
+
+/* runs on the main loop */
+static void delete_progress ()
+{
+    pthread_mutex_lock (& delete_mutex);
+    bool running = (jobs_running > 0);
+    int done = files_done, total = files_total;
+    Index<SmartPtr<DeleteJob>> jobs = std::move (finished_jobs);
+    pthread_mutex_unlock (& delete_mutex);
+
+    if (running)
+    {
+        StringBuf status = str_printf (_("Deleting files (%d of %d) ..."), done, total);
+        hook_call ("ui show progress", status);
+    }
+    else
+        hook_call ("ui hide progress", nullptr);
+
+    for (auto & job : jobs)
+        finish_job (* job);
+}
+
+static void run_job (DeleteJob & job)
+{
+    for (auto & uri : job.files)
+    {
+        if (delete_uri (uri, job.use_trash, job.first_error))
+            job.deleted.append (uri);
+        else
+            job.n_errors ++;
+
+        pthread_mutex_lock (& delete_mutex);
+        files_done ++;
+        delete_queued.queue (delete_progress);
+        pthread_mutex_unlock (& delete_mutex);
+    }
+}
+
+static void * delete_worker (void * data)
+{
+    auto job = (DeleteJob *) data;
+    run_job (* job);
+
+    pthread_mutex_lock (& delete_mutex);
+
+    finished_jobs.append (SmartPtr<DeleteJob> (job));
+
+    if (! -- jobs_running)
+        files_done = files_total = 0;
+
+    delete_queued.queue (delete_progress);
+    pthread_cond_broadcast (& delete_cond);
+    pthread_mutex_unlock (& delete_mutex);
+
+    return nullptr;
+}
+
+static void delete_cleanup ()
+{
+    pthread_mutex_lock (& delete_mutex);
+
+    while (jobs_running)
+        pthread_cond_wait (& delete_cond, & delete_mutex);
+
+    Index<SmartPtr<DeleteJob>> jobs = std::move (finished_jobs);
+    pthread_mutex_unlock (& delete_mutex);
+
+    delete_queued.stop ();
+    hook_call ("ui hide progress", nullptr);
+
+    /* don't lose the playlist updates for files already deleted */
+    for (auto & job : jobs)
+        finish_job (* job);
+}
+
 class DeleteOperation
 {
 public:
@@ -155,29 +284,36 @@ public:
 
     void run () const
     {
-        /* work around -Wignored-attributes on MinGW */
-        auto string_compare = [] (const String & a, const String & b)
-            { return strcmp (a, b); };
+        auto job = new DeleteJob;
+        job->playlist = m_playlist;
+        job->use_trash = m_use_trash;
+
+        for (auto & uri : m_files)
+            job->files.append (uri);
 
-        Index<String> deleted;
+        pthread_mutex_lock (& delete_mutex);
+        files_total += job->files.len ();
+        jobs_running ++;
+        pthread_mutex_unlock (& delete_mutex);
 
-        for (auto & uri: m_files)
+        pthread_t thread;
+        if (! pthread_create (& thread, nullptr, delete_worker, job))
         {
-            if (delete_uri (uri, m_use_trash))
-                deleted.append (uri);
+            pthread_detach (thread);
+            return;
         }
 
-        deleted.sort (string_compare);
+        /* no worker to be had; delete on the spot rather than not at all */
+        run_job (* job);
 
-        /* make sure selection matches what we actually deleted */
-        int num_entries = m_playlist.n_entries ();
-        for (int i = 0; i < num_entries; i++)
-        {
-            int j = deleted.bsearch (m_playlist.entry_filename (i), string_compare);
-            m_playlist.select_entry (i, (j >= 0));
-        }
+        pthread_mutex_lock (& delete_mutex);
+        if (! -- jobs_running)
+            files_done = files_total = 0;
+        pthread_mutex_unlock (& delete_mutex);
 
-        m_playlist.remove_selected ();
+        delete_queued.queue (delete_progress);
+        finish_job (* job);
+        delete job;
     }
 
 private:
@@ -276,6 +412,8 @@ void DeleteFiles::cleanup ()
     delete qdialog;
 #endif
 
+    delete_cleanup ();
+
     for (AudMenuID menu : menus)
         aud_plugin_menu_remove (menu, start_delete);
 }
@@ -1,9 +1,16 @@
+#ifdef __SSE2__
+#include <emmintrin.h>
+#elif defined (__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #include <libaudcore/i18n.h>
 #include <libaudcore/runtime.h>
 #include <libaudcore/plugin.h>
 #include <libaudcore/preferences.h>
 
 #define MAX_DELAY 1000
+#define MAX_TAPS 4
 
 static const char echo_about[] =
  N_("Echo Plugin\n"
@@ -15,8 +22,22 @@ static const char * const echo_defaults[] = {
  "delay", "500",
  "feedback", "50",
  "volume", "50",
+ "taps", "1",
+ "tap1_pan", "0",
+ "tap2_gain", "25",
+ "tap2_pan", "0",
+ "tap3_gain", "25",
+ "tap3_pan", "0",
+ "tap4_gain", "25",
+ "tap4_pan", "0",
  nullptr};
 
+/* tap 1 keeps the original "volume" key so existing configs are unchanged */
+static const char * const tap_gain_keys[MAX_TAPS] =
+ {"volume", "tap2_gain", "tap3_gain", "tap4_gain"};
+static const char * const tap_pan_keys[MAX_TAPS] =
+ {"tap1_pan", "tap2_pan", "tap3_pan", "tap4_pan"};
+
 static const PreferencesWidget echo_widgets[] = {
     WidgetLabel (N_("<b>Echo</b>")),
     WidgetSpin (N_("Delay:"),
@@ -27,7 +48,32 @@ static const PreferencesWidget echo_widgets[] = {
         {0, 100, 1, "%"}),
     WidgetSpin (N_("Volume:"),
         WidgetInt ("echo_plugin", "volume"),
-        {0, 100, 1, "%"})
+        {0, 100, 1, "%"}),
+    WidgetLabel (N_("<b>Multi-Tap</b>")),
+    WidgetSpin (N_("Taps (at multiples of the delay):"),
+        WidgetInt ("echo_plugin", "taps"),
+        {1, MAX_TAPS, 1}),
+    WidgetSpin (N_("Tap 1 pan:"),
+        WidgetInt ("echo_plugin", "tap1_pan"),
+        {-100, 100, 5}),
+    WidgetSpin (N_("Tap 2 volume:"),
+        WidgetInt ("echo_plugin", "tap2_gain"),
+        {0, 100, 1, "%"}),
+    WidgetSpin (N_("Tap 2 pan:"),
+        WidgetInt ("echo_plugin", "tap2_pan"),
+        {-100, 100, 5}),
+    WidgetSpin (N_("Tap 3 volume:"),
+        WidgetInt ("echo_plugin", "tap3_gain"),
+        {0, 100, 1, "%"}),
+    WidgetSpin (N_("Tap 3 pan:"),
+        WidgetInt ("echo_plugin", "tap3_pan"),
+        {-100, 100, 5}),
+    WidgetSpin (N_("Tap 4 volume:"),
+        WidgetInt ("echo_plugin", "tap4_gain"),
+        {0, 100, 1, "%"}),
+    WidgetSpin (N_("Tap 4 pan:"),
+        WidgetInt ("echo_plugin", "tap4_pan"),
+        {-100, 100, 5})
 };
 
 static const PluginPreferences echo_prefs = {{echo_widgets}};
@@ -54,8 +100,17 @@ public:
 EXPORT EchoPlugin aud_plugin_instance;
 
 static Index<float> buffer;
+static int buffer_mask;
 static int w_ofs;
 
+/* parameters in effect during the previous block, so changes made mid-song
+ * can be crossfaded in rather than jumping; last_taps == 0 means there is no
+ * previous block to fade from */
+static int last_taps;
+static float last_feedback;
+static int last_intervals[MAX_TAPS];
+static float last_gl[MAX_TAPS], last_gr[MAX_TAPS];
+
 bool EchoPlugin::init ()
 {
     aud_config_set_defaults ("echo_plugin", echo_defaults);
@@ -77,10 +132,63 @@ void EchoPlugin::start (int & channels, int & rate)
         echo_channels = channels;
         echo_rate = rate;
 
-        buffer.resize (aud::rescale (MAX_DELAY, 1000, rate) * channels);
+        /* power of two covering the last tap at the maximum configurable
+         * delay, so indices wrap with a mask and adjusting the delay never
+         * reallocates */
+        int size = 1;
+        while (size < aud::rescale (MAX_TAPS * MAX_DELAY, 1000, rate) * channels)
+            size <<= 1;
+
+        buffer.resize (size);
         buffer.erase (0, -1);
+        buffer_mask = size - 1;
 
         w_ofs = 0;
+        last_taps = 0;
+    }
+}
+
+/* out[i] += in[i] * gain, with the gain alternating between left and right.
+ * Both the buffer size and the write offset are multiples of the channel
+ * count, so runs always start on a frame boundary and the channel phase of
+ * the gain vector stays aligned; for mono and for more than two channels the
+ * two gains are equal and the phase is irrelevant. */
+static void accumulate_run (float * out, const float * in, int length,
+ float gl, float gr)
+{
+    int i = 0;
+
+#ifdef __SSE2__
+    const __m128 gain = _mm_set_ps (gr, gl, gr, gl);
+
+    for (; i + 4 <= length; i += 4)
+        _mm_storeu_ps (out + i, _mm_add_ps (_mm_loadu_ps (out + i),
+         _mm_mul_ps (_mm_loadu_ps (in + i), gain)));
+#elif defined (__ARM_NEON)
+    const float gains[4] = {gl, gr, gl, gr};
+    const float32x4_t gain = vld1q_f32 (gains);
+
+    for (; i + 4 <= length; i += 4)
+        vst1q_f32 (out + i, vmlaq_f32 (vld1q_f32 (out + i),
+         vld1q_f32 (in + i), gain));
+#endif
+
+    for (; i < length; i ++)
+        out[i] += in[i] * ((i & 1) ? gr : gl);
+}
+
+static void tap_accumulate (float * data, int len, int r_ofs, float gl, float gr)
+{
+    int pos = 0;
+
+    while (pos < len)
+    {
+        int run = aud::min (len - pos, buffer.len () - r_ofs);
+
+        accumulate_run (data + pos, & buffer[r_ofs], run, gl, gr);
+
+        pos += run;
+        r_ofs = (r_ofs + run) & buffer_mask;
     }
 }
 
@@ -88,27 +196,125 @@ Index<float> & EchoPlugin::process (Index<float> & data)
 {
     int delay = aud_get_int ("echo_plugin", "delay");
     float feedback = aud_get_int ("echo_plugin", "feedback") / 100.0f;
-    float volume = aud_get_int ("echo_plugin", "volume") / 100.0f;
+    int taps = aud::clamp (aud_get_int ("echo_plugin", "taps"), 1, MAX_TAPS);
 
     int interval = aud::rescale (delay, 1000, echo_rate) * echo_channels;
-    interval = aud::clamp (interval, 0, buffer.len ());  // sanity check
 
-    int r_ofs = w_ofs - interval;
-    if (r_ofs < 0)
-        r_ofs += buffer.len ();
+    int intervals[MAX_TAPS];
+    float gl[MAX_TAPS], gr[MAX_TAPS];
+
+    for (int t = 0; t < taps; t ++)
+    {
+        /* tap t reads (t + 1) delay periods behind the write offset */
+        intervals[t] = aud::clamp ((t + 1) * interval, 0, buffer.len ());  // sanity check
+
+        float gain = aud_get_int ("echo_plugin", tap_gain_keys[t]) / 100.0f;
+        float pan = (echo_channels == 2) ?
+         aud_get_int ("echo_plugin", tap_pan_keys[t]) / 100.0f : 0.0f;
+
+        gl[t] = gain * aud::min (1.0f, 1.0f - pan);
+        gr[t] = gain * aud::min (1.0f, 1.0f + pan);
+    }
+
+    bool changed = last_taps && (taps != last_taps || feedback != last_feedback);
+
+    for (int t = 0; last_taps && t < taps && ! changed; t ++)
+        changed = (intervals[t] != last_intervals[t] ||
+         gl[t] != last_gl[t] || gr[t] != last_gr[t]);
 
-    float * end = data.end ();
+    float * f = data.begin ();
 
-    for (float * f = data.begin (); f < end; f++)
+    if (! changed)
+    {
+        /* First pass: tap 1 and the feedback write, which must run sample by
+         * sample since the write offset can catch up with the read offset.
+         * Later taps only read, so they are applied afterward in vectorized
+         * bulk passes over the single shared delay line. */
+        int w_start = w_ofs;
+        int r_ofs = (w_ofs - intervals[0]) & buffer_mask;
+        float * end = data.end ();
+
+        while (f < end)
+        {
+            for (int channel = 0; channel < echo_channels; channel ++)
+            {
+                float in = * f;
+                float buf = buffer[r_ofs];
+
+                * f ++ = in + buf * ((channel & 1) ? gr[0] : gl[0]);
+                buffer[w_ofs] = in + buf * feedback;
+
+                r_ofs = (r_ofs + 1) & buffer_mask;
+                w_ofs = (w_ofs + 1) & buffer_mask;
+            }
+        }
+
+        for (int t = 1; t < taps; t ++)
+            tap_accumulate (data.begin (), data.len (),
+             (w_start - intervals[t]) & buffer_mask, gl[t], gr[t]);
+    }
+    else
     {
-        float in = * f;
-        float buf = buffer[r_ofs];
+        /* a parameter changed; crossfade from the old settings (including the
+         * old read offsets) to the new ones over this block */
+        int all_taps = aud::max (taps, last_taps);
+        int r_old[MAX_TAPS], r_new[MAX_TAPS];
 
-        * f = in + buf * volume;
-        buffer[w_ofs] = in + buf * feedback;
+        for (int t = 0; t < all_taps; t ++)
+        {
+            int old_iv = (t < last_taps) ? last_intervals[t] : intervals[t];
+            int new_iv = (t < taps) ? intervals[t] : last_intervals[t];
 
-        r_ofs = (r_ofs + 1) % buffer.len ();
-        w_ofs = (w_ofs + 1) % buffer.len ();
+            r_old[t] = (w_ofs - old_iv) & buffer_mask;
+            r_new[t] = (w_ofs - new_iv) & buffer_mask;
+        }
+
+        int frames = data.len () / echo_channels;
+
+        for (int frame = 0; frame < frames; frame ++)
+        {
+            float mix = (frames > 1) ? (float) frame / (frames - 1) : 1.0f;
+            float fb = last_feedback + (feedback - last_feedback) * mix;
+
+            for (int channel = 0; channel < echo_channels; channel ++)
+            {
+                float in = * f;
+                float out = in;
+                float buf1 = 0.0f;
+
+                for (int t = 0; t < all_taps; t ++)
+                {
+                    float buf = buffer[r_old[t]] +
+                     (buffer[r_new[t]] - buffer[r_old[t]]) * mix;
+                    float g_old = (t < last_taps) ?
+                     ((channel & 1) ? last_gr[t] : last_gl[t]) : 0.0f;
+                    float g_new = (t < taps) ?
+                     ((channel & 1) ? gr[t] : gl[t]) : 0.0f;
+
+                    out += buf * (g_old + (g_new - g_old) * mix);
+
+                    if (! t)
+                        buf1 = buf;
+
+                    r_old[t] = (r_old[t] + 1) & buffer_mask;
+                    r_new[t] = (r_new[t] + 1) & buffer_mask;
+                }
+
+                * f ++ = out;
+                buffer[w_ofs] = in + buf1 * fb;
+                w_ofs = (w_ofs + 1) & buffer_mask;
+            }
+        }
+    }
+
+    last_taps = taps;
+    last_feedback = feedback;
+
+    for (int t = 0; t < taps; t ++)
+    {
+        last_intervals[t] = intervals[t];
+        last_gl[t] = gl[t];
+        last_gr[t] = gr[t];
     }
 
     return data;
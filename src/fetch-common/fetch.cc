@@ -0,0 +1,176 @@
+// Copyright (c) 2026 Audacious developers
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// This software is provided 'as is' and without any warranty, express or
+// implied.  In no event shall the authors be liable for any damages arising
+// from the use of this software.
+
+#include "fetch.h"
+
+#include <pthread.h>
+#include <time.h>
+
+#include <libaudcore/index.h>
+#include <libaudcore/mainloop.h>
+#include <libaudcore/objects.h>
+#include <libaudcore/runtime.h>
+#include <libaudcore/vfs.h>
+
+// two workers cover the common case of a listing fetch overlapping an art
+// or lyrics fetch; anything beyond that waits its turn in the queue
+static constexpr int MaxWorkers = 2;
+// idle workers linger briefly in case another request follows, then exit
+static constexpr int IdleTimeout = 30; // seconds
+// a single quick retry smooths over transient network errors without
+// hammering a server that is really down
+static constexpr int RetryDelayMs = 500;
+
+struct FetchRequest {
+    String uri;
+    VFSConsumer cons;
+    Index<char> data;
+};
+
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+static Index<SmartPtr<FetchRequest>> pending, finished;
+static QueuedFunc queued;
+static int n_workers, n_idle;
+static bool quitting;
+
+// runs on the main loop
+static void deliver ()
+{
+    pthread_mutex_lock (& mutex);
+    Index<SmartPtr<FetchRequest>> batch = std::move (finished);
+    pthread_mutex_unlock (& mutex);
+
+    for (auto & req : batch)
+        req->cons (req->uri, req->data);
+}
+
+// runs on a worker thread; leaves req->data empty on failure
+static void run_request (FetchRequest * req)
+{
+    for (int attempt = 0; ; attempt ++)
+    {
+        VFSFile file (req->uri, "r");
+        if (file)
+        {
+            req->data = file.read_all ();
+            return;
+        }
+
+        AUDINFO ("Failed to open %s: %s.\n", (const char *) req->uri, file.error ());
+
+        if (attempt)
+            return;
+
+        timespec delay = {0, RetryDelayMs * 1000000L};
+        nanosleep (& delay, nullptr);
+    }
+}
+
+static void * worker_cb (void *)
+{
+    pthread_mutex_lock (& mutex);
+
+    while (! quitting)
+    {
+        if (! pending.len ())
+        {
+            timespec until;
+            clock_gettime (CLOCK_REALTIME, & until);
+            until.tv_sec += IdleTimeout;
+
+            n_idle ++;
+            int error = pthread_cond_timedwait (& cond, & mutex, & until);
+            n_idle --;
+
+            if (error && ! pending.len () && ! quitting)
+                break; // idled out with nothing to do
+
+            continue;
+        }
+
+        SmartPtr<FetchRequest> req = std::move (pending [0]);
+        pending.remove (0, 1);
+
+        pthread_mutex_unlock (& mutex);
+        run_request (req.get ());
+        pthread_mutex_lock (& mutex);
+
+        if (quitting)
+            break;
+
+        finished.append (std::move (req));
+        queued.queue (deliver);
+    }
+
+    n_workers --;
+    pthread_cond_broadcast (& cond); // fetch_cleanup() may be waiting
+    pthread_mutex_unlock (& mutex);
+    return nullptr;
+}
+
+void fetch_async (const char * uri, VFSConsumer cons)
+{
+    auto req = new FetchRequest;
+    req->uri = String (uri);
+    req->cons = std::move (cons);
+
+    pthread_mutex_lock (& mutex);
+
+    pending.append (SmartPtr<FetchRequest> (req));
+
+    if (! n_idle && n_workers < MaxWorkers)
+    {
+        // workers are detached; fetch_cleanup() waits on n_workers instead
+        pthread_t thread;
+        pthread_attr_t attr;
+        pthread_attr_init (& attr);
+        pthread_attr_setdetachstate (& attr, PTHREAD_CREATE_DETACHED);
+
+        if (! pthread_create (& thread, & attr, worker_cb, nullptr))
+            n_workers ++;
+
+        pthread_attr_destroy (& attr);
+
+        if (! n_workers)
+        {
+            // no thread to be had; fetch on the spot rather than stalling
+            pending.remove (pending.len () - 1, 1);
+            pthread_mutex_unlock (& mutex);
+
+            SmartPtr<FetchRequest> direct (req);
+            run_request (direct.get ());
+            direct->cons (direct->uri, direct->data);
+            return;
+        }
+    }
+
+    pthread_cond_signal (& cond);
+    pthread_mutex_unlock (& mutex);
+}
+
+void fetch_cleanup ()
+{
+    pthread_mutex_lock (& mutex);
+
+    quitting = true;
+    pending.clear ();
+    pthread_cond_broadcast (& cond);
+
+    while (n_workers)
+        pthread_cond_wait (& cond, & mutex);
+
+    finished.clear ();
+    quitting = false;
+
+    pthread_mutex_unlock (& mutex);
+
+    queued.stop ();
+}
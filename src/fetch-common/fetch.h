@@ -0,0 +1,29 @@
+// Copyright (c) 2026 Audacious developers
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// This software is provided 'as is' and without any warranty, express or
+// implied.  In no event shall the authors be liable for any damages arising
+// from the use of this software.
+
+#ifndef FETCH_COMMON_FETCH_H
+#define FETCH_COMMON_FETCH_H
+
+#include <libaudcore/vfs_async.h>
+
+// Shared front end for short HTTP requests.  Requests are queued to a small
+// worker pool (at most two threads, which exit again once idle) instead of
+// starting a thread per request, connections are reused through the HTTP
+// transport's session pool, and retry-on-failure policy lives here rather
+// than at every call site.  The callback runs on the main loop, with an
+// empty buffer on failure, matching vfs_async_file_get_contents().
+
+void fetch_async (const char * uri, VFSConsumer cons);
+
+// cancels pending requests and callbacks and waits for the workers to exit;
+// call from the plugin's cleanup
+void fetch_cleanup ();
+
+#endif
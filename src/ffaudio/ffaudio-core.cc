@@ -25,11 +25,21 @@
 
 #include <limits.h>
 #include <pthread.h>
+#include <stdint.h>
+#include <time.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#elif defined (__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 #include <audacious/audtag.h>
 #include <libaudcore/audstrings.h>
 #include <libaudcore/i18n.h>
+#include <libaudcore/mainloop.h>
 #include <libaudcore/multihash.h>
+#include <libaudcore/preferences.h>
 #include <libaudcore/runtime.h>
 
 #if CHECK_LIBAVFORMAT_VERSION (57, 33, 100)
@@ -40,16 +50,28 @@
 #define SEND_PACKET 1
 #endif
 
+typedef struct
+{
+    int stream_idx;
+    AVStream * stream;
+    AVCodec * codec;
+}
+CodecInfo;
+
 class FFaudio : public InputPlugin
 {
 public:
     static const char about[];
     static const char * const exts[], * const mimes[];
+    static const char * const defaults[];
+    static const PreferencesWidget widgets[];
+    static const PluginPreferences prefs;
 
     static constexpr PluginInfo info = {
         N_("FFmpeg Plugin"),
         PACKAGE,
-        about
+        about,
+        & prefs
     };
 
     constexpr FFaudio () : InputPlugin (info, InputInfo (FlagWritesTag)
@@ -64,17 +86,33 @@ public:
     bool read_tag (const char * filename, VFSFile & file, Tuple & tuple, Index<char> * image) override;
     bool write_tuple (const char * filename, VFSFile & file, const Tuple & tuple) override;
     bool play (const char * filename, VFSFile & file) override;
+
+#if CHECK_LIBAVCODEC_VERSION (56, 1, 0)
+private:
+    bool play_dop (AVFormatContext * ic, const CodecInfo & cinfo,
+     AVCodecContext * context);
+#endif
 };
 
 EXPORT FFaudio aud_plugin_instance;
 
-typedef struct
-{
-    int stream_idx;
-    AVStream * stream;
-    AVCodec * codec;
-}
-CodecInfo;
+const char * const FFaudio::defaults[] = {
+ "threads", "0",
+ "dop", "FALSE",
+ nullptr};
+
+const PreferencesWidget FFaudio::widgets[] = {
+    WidgetLabel (N_("<b>Advanced</b>")),
+    WidgetSpin (N_("Decoder threads (0 = automatic):"),
+        WidgetInt ("ffaudio", "threads"),
+        {0, 16, 1}),
+    WidgetCheck (N_("DSD over PCM (DoP) passthrough"),
+        WidgetBool ("ffaudio", "dop")),
+    WidgetLabel (N_("DoP reaches the DAC intact only with the volume at "
+                    "100% and no effects or resampling active."))
+};
+
+const PluginPreferences FFaudio::prefs = {{widgets}};
 
 struct ScopedContext
 {
@@ -149,7 +187,24 @@ struct ScopedFrame
 
 static SimpleHash<String, AVInputFormat *> extension_dict;
 
+/* Memo of content-probe results, so that a playlist scan followed by
+ * playback (or repeated scans of an unchanged library) does not re-read and
+ * re-probe the same file.  Entries are validated by file size, since the VFS
+ * layer does not expose modification times; negative results are remembered
+ * too.  Only the format name is stored, as AVInputFormat pointers from
+ * av_find_input_format() are stable for the life of the process. */
+struct ProbeResult
+{
+    int64_t file_size = 0;
+    String format_name; /* null = probe matched nothing */
+};
+
+static pthread_mutex_t probe_mutex = PTHREAD_MUTEX_INITIALIZER;
+static SimpleHash<String, ProbeResult> probe_memo;
+static int probe_memo_entries = 0;
+
 static void create_extension_dict ();
+static void input_cache_flush ();
 
 #if ! CHECK_LIBAVCODEC_VERSION(58, 9, 100)
 static int lockmgr (void * * mutexp, enum AVLockOp op)
@@ -210,6 +265,8 @@ static void ffaudio_log_cb (void * avcl, int av_level, const char * fmt, va_list
 
 bool FFaudio::init ()
 {
+    aud_config_set_defaults ("ffaudio", defaults);
+
 #if ! CHECK_LIBAVFORMAT_VERSION(58, 9, 100)
     av_register_all();
 #endif
@@ -226,7 +283,11 @@ bool FFaudio::init ()
 
 void FFaudio::cleanup ()
 {
+    input_cache_flush ();
+
     extension_dict.clear ();
+    probe_memo.clear ();
+    probe_memo_entries = 0;
 
 #if ! CHECK_LIBAVCODEC_VERSION(58, 9, 100)
     av_lockmgr_register (nullptr);
@@ -291,14 +352,110 @@ static AVInputFormat * get_format_by_extension (const char * name)
     return f ? * f : nullptr;
 }
 
+static AVInputFormat * probe_memo_lookup (const char * name, int64_t size,
+ bool & found)
+{
+    pthread_mutex_lock (& probe_mutex);
+
+    AVInputFormat * f = nullptr;
+    ProbeResult * entry = probe_memo.lookup (String (name));
+
+    if (entry && entry->file_size == size)
+    {
+        found = true;
+        if (entry->format_name)
+            f = (AVInputFormat *) av_find_input_format (entry->format_name);
+    }
+
+    pthread_mutex_unlock (& probe_mutex);
+    return f;
+}
+
+static void probe_memo_store (const char * name, int64_t size, AVInputFormat * f)
+{
+    pthread_mutex_lock (& probe_mutex);
+
+    ProbeResult * entry = probe_memo.lookup (String (name));
+    if (! entry)
+    {
+        /* primitive size cap; entries are tiny, and dropping the memo once
+         * in a long while just means probing those files again */
+        if (probe_memo_entries >= 1024)
+        {
+            probe_memo.clear ();
+            probe_memo_entries = 0;
+        }
+
+        entry = probe_memo.add (String (name), ProbeResult ());
+        probe_memo_entries ++;
+    }
+
+    entry->file_size = size;
+    entry->format_name = f ? String (f->name) : String ();
+
+    pthread_mutex_unlock (& probe_mutex);
+}
+
+/* Adaptive probe hints.  A library is usually dominated by one format, but a
+ * content probe still starts from a 16-byte read and walks every demuxer at a
+ * ladder of buffer sizes.  Remember, per file extension, which demuxer won
+ * the last probe and how many bytes it needed, so the next file of the same
+ * kind is identified with a single read of the right size.  The hints live in
+ * the plugin's config section and persist across sessions; a stale hint only
+ * costs falling through to the usual incremental probe. */
+
+static StringBuf probe_hint_key (const char * name)
+{
+    StringBuf ext = uri_get_extension (name);
+    if (! ext)
+        return StringBuf ();
+
+    return str_concat ({"probe_hint_", str_tolower (ext)});
+}
+
+static int probe_hint_lookup (const char * key)
+{
+    String hint = aud_get_str ("ffaudio", key);
+    const char * sep = hint[0] ? strrchr (hint, ':') : nullptr;
+
+    return sep ? aud::clamp (atoi (sep + 1), 16, 16384) : 0;
+}
+
+static void probe_hint_store (const char * key, AVInputFormat * f, int filled)
+{
+    StringBuf hint = str_printf ("%s:%d", f->name, filled);
+
+    if (strcmp (hint, aud_get_str ("ffaudio", key)))
+        aud_set_str ("ffaudio", key, hint);
+}
+
 static AVInputFormat * get_format_by_content (const char * name, VFSFile & file)
 {
+    int64_t file_size = file.fsize ();
+
+    /* streams have no stable identity worth remembering */
+    if (file_size >= 0)
+    {
+        bool found = false;
+        AVInputFormat * hit = probe_memo_lookup (name, file_size, found);
+
+        if (found)
+        {
+            AUDDBG ("Reusing probe result for %s: %s\n", name,
+             hit ? hit->name : "no match");
+            return hit;
+        }
+    }
+
     AUDDBG ("Probing content: %s\n", name);
 
+    StringBuf hint_key = probe_hint_key (name);
+
     AVInputFormat * f = nullptr;
 
     unsigned char buf[16384 + AVPROBE_PADDING_SIZE];
-    int size = 16;
+    /* start from the size that worked for the last file of this kind */
+    int size = hint_key ? aud::max (probe_hint_lookup (hint_key), 16) : 16;
     int filled = 0;
     int target = 100;
     int score = 0;
@@ -325,13 +482,21 @@ static AVInputFormat * get_format_by_content (const char * name, VFSFile & file)
     }
 
     if (f)
+    {
         AUDINFO ("Probe matched format %s, buffer size %d, score %d.\n", f->name, filled, score);
+
+        if (hint_key)
+            probe_hint_store (hint_key, f, filled);
+    }
     else
         AUDINFO ("Probe did not match any known formats.\n");
 
     if (file.fseek (0, VFS_SEEK_SET) < 0)
         ; /* ignore errors here */
 
+    if (file_size >= 0)
+        probe_memo_store (name, file_size, f);
+
     return f;
 }
 
@@ -372,6 +537,192 @@ static void close_input_file (AVFormatContext * c)
     io_context_free (io);
 }
 
+/* A track change typically demuxes the same file several times in a row:
+ * read_tag for the tuple, read_tag again for the album art, then play.
+ * Idle demuxer contexts are therefore kept open for a few seconds after
+ * use, with their own VFS handle (the caller's is gone once the call
+ * returns), so the repeats skip the open and probe round-trips that
+ * dominate on network filesystems.  An entry is owned by exactly one
+ * user at a time; acquiring removes it from the cache, releasing puts
+ * it back, so no locking of the context itself is needed. */
+
+static constexpr int CachedInputTimeout = 10; /* seconds */
+static constexpr int MaxCachedInputs = 2;
+
+struct CachedInput
+{
+    String name;
+    SmartPtr<VFSFile> file;
+    AVFormatContext * context = nullptr;
+    time_t idle_since = 0;
+};
+
+static pthread_mutex_t cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static Index<CachedInput> input_cache;
+static QueuedFunc cache_timer_starter;
+
+static void input_cache_sweep (void * = nullptr)
+{
+    Index<CachedInput> expired;
+
+    pthread_mutex_lock (& cache_mutex);
+
+    time_t now = time (nullptr);
+    for (int i = input_cache.len () - 1; i >= 0; i --)
+    {
+        if (now - input_cache[i].idle_since >= CachedInputTimeout)
+        {
+            expired.append (std::move (input_cache[i]));
+            input_cache.remove (i, 1);
+        }
+    }
+
+    bool empty = ! input_cache.len ();
+    pthread_mutex_unlock (& cache_mutex);
+
+    for (CachedInput & input : expired)
+        close_input_file (input.context);
+
+    if (empty)
+        timer_remove (TimerRate::Hz1, input_cache_sweep);
+}
+
+static void input_cache_flush ()
+{
+    pthread_mutex_lock (& cache_mutex);
+    Index<CachedInput> cached = std::move (input_cache);
+    pthread_mutex_unlock (& cache_mutex);
+
+    for (CachedInput & input : cached)
+        close_input_file (input.context);
+
+    cache_timer_starter.stop ();
+    timer_remove (TimerRate::Hz1, input_cache_sweep);
+}
+
+/* called when a file changes on disk (e.g. a tag write); a cached context
+ * would otherwise keep serving the old contents until it times out */
+static void input_cache_invalidate (const char * name)
+{
+    pthread_mutex_lock (& cache_mutex);
+
+    for (int i = 0; i < input_cache.len (); i ++)
+    {
+        if (! strcmp (input_cache[i].name, name))
+        {
+            CachedInput input = std::move (input_cache[i]);
+            input_cache.remove (i, 1);
+            pthread_mutex_unlock (& cache_mutex);
+            close_input_file (input.context);
+            return;
+        }
+    }
+
+    pthread_mutex_unlock (& cache_mutex);
+}
+
+/* scoped demuxer handle; takes an idle context from the cache when one
+ * matches, and returns it there when done */
+class InputFile
+{
+public:
+    InputFile (const char * name, VFSFile & file) : m_name (name)
+    {
+        pthread_mutex_lock (& cache_mutex);
+
+        for (int i = 0; i < input_cache.len (); i ++)
+        {
+            if (! strcmp (input_cache[i].name, name))
+            {
+                CachedInput input = std::move (input_cache[i]);
+                input_cache.remove (i, 1);
+                pthread_mutex_unlock (& cache_mutex);
+
+                if (avformat_seek_file (input.context, -1, INT64_MIN, 0,
+                 INT64_MAX, 0) >= 0)
+                {
+                    AUDDBG ("Reusing demuxer context for %s.\n", name);
+                    m_file = std::move (input.file);
+                    m_context = input.context;
+                    return;
+                }
+
+                /* cannot rewind; open from scratch instead */
+                close_input_file (input.context);
+                pthread_mutex_lock (& cache_mutex);
+                break;
+            }
+        }
+
+        pthread_mutex_unlock (& cache_mutex);
+
+        /* a context can only outlive this call with its own VFS handle,
+         * and caching a partly-consumed network stream would be wrong
+         * anyway, so only seekable files get one */
+        if (file.fsize () >= 0)
+        {
+            m_file.capture (new VFSFile (name, "r"));
+            if (* m_file)
+            {
+                m_context = open_input_file (name, * m_file);
+                if (m_context)
+                    return;
+            }
+
+            m_file.clear ();
+        }
+
+        m_context = open_input_file (name, file);
+    }
+
+    ~InputFile ()
+    {
+        if (! m_context)
+            return;
+
+        if (! m_file)
+        {
+            /* demuxing through the caller's handle; not cacheable */
+            close_input_file (m_context);
+            return;
+        }
+
+        pthread_mutex_lock (& cache_mutex);
+
+        if (input_cache.len () >= MaxCachedInputs)
+        {
+            /* drop the longest-idle entry to make room */
+            CachedInput oldest = std::move (input_cache[0]);
+            input_cache.remove (0, 1);
+            pthread_mutex_unlock (& cache_mutex);
+            close_input_file (oldest.context);
+            pthread_mutex_lock (& cache_mutex);
+        }
+
+        CachedInput & input = input_cache.append ();
+        input.name = m_name;
+        input.file = std::move (m_file);
+        input.context = m_context;
+        input.idle_since = time (nullptr);
+
+        pthread_mutex_unlock (& cache_mutex);
+
+        /* the sweep timer runs on the main loop; timer_add is a no-op if
+         * it is already running */
+        cache_timer_starter.queue (
+         [] () { timer_add (TimerRate::Hz1, input_cache_sweep); });
+    }
+
+    explicit operator bool () const { return (bool) m_context; }
+    AVFormatContext * get () { return m_context; }
+    AVFormatContext * operator-> () { return m_context; }
+
+private:
+    String m_name;
+    SmartPtr<VFSFile> m_file;
+    AVFormatContext * m_context = nullptr;
+};
+
 static bool find_codec (AVFormatContext * c, CodecInfo * cinfo)
 {
     avformat_find_stream_info (c, nullptr);
@@ -455,8 +806,7 @@ static void read_metadata_dict (Tuple & tuple, const AVDictionary * dict)
 
 bool FFaudio::read_tag (const char * filename, VFSFile & file, Tuple & tuple, Index<char> * image)
 {
-    SmartPtr<AVFormatContext, close_input_file>
-     ic (open_input_file (filename, file));
+    InputFile ic (filename, file);
 
     if (! ic)
         return false;
@@ -499,12 +849,93 @@ bool FFaudio::read_tag (const char * filename, VFSFile & file, Tuple & tuple, In
 
 bool FFaudio::write_tuple (const char * filename, VFSFile & file, const Tuple & tuple)
 {
+    /* any cached demuxer context holds the pre-edit metadata; drop it so
+     * the rescan that follows the tag write re-reads the file */
+    input_cache_invalidate (filename);
+
     if (str_has_suffix_nocase (filename, ".ape"))
         return audtag::write_tuple (file, tuple, audtag::TagType::APE);
 
     return audtag::write_tuple (file, tuple, audtag::TagType::None);
 }
 
+/* Interleaving planar samples runs once per decoded frame, so the layouts
+ * FFmpeg actually produces in bulk get vectorized paths; everything else
+ * (and builds without SSE2/NEON) falls back to the generic libaudcore
+ * routine.  Stereo float covers most real streams, since AAC, Vorbis and
+ * Opus all decode to FLTP. */
+static void interlace_frame (const void * const * data, int format,
+ int channels, void * dest, int samples)
+{
+#if defined (__SSE2__) || defined (__ARM_NEON)
+    if (format == FMT_FLOAT && channels == 2)
+    {
+        const float * left = (const float *) data[0];
+        const float * right = (const float *) data[1];
+        float * out = (float *) dest;
+        int i = 0;
+
+#ifdef __SSE2__
+        for (; i + 4 <= samples; i += 4)
+        {
+            __m128 l = _mm_loadu_ps (left + i);
+            __m128 r = _mm_loadu_ps (right + i);
+            _mm_storeu_ps (out + 2 * i, _mm_unpacklo_ps (l, r));
+            _mm_storeu_ps (out + 2 * i + 4, _mm_unpackhi_ps (l, r));
+        }
+#else
+        for (; i + 4 <= samples; i += 4)
+        {
+            float32x4x2_t lr = {{vld1q_f32 (left + i), vld1q_f32 (right + i)}};
+            vst2q_f32 (out + 2 * i, lr);
+        }
+#endif
+
+        for (; i < samples; i ++)
+        {
+            out[2 * i] = left[i];
+            out[2 * i + 1] = right[i];
+        }
+
+        return;
+    }
+
+    if (format == FMT_S16_NE && channels == 2)
+    {
+        const int16_t * left = (const int16_t *) data[0];
+        const int16_t * right = (const int16_t *) data[1];
+        int16_t * out = (int16_t *) dest;
+        int i = 0;
+
+#ifdef __SSE2__
+        for (; i + 8 <= samples; i += 8)
+        {
+            __m128i l = _mm_loadu_si128 ((const __m128i *) (left + i));
+            __m128i r = _mm_loadu_si128 ((const __m128i *) (right + i));
+            _mm_storeu_si128 ((__m128i *) (out + 2 * i), _mm_unpacklo_epi16 (l, r));
+            _mm_storeu_si128 ((__m128i *) (out + 2 * i + 8), _mm_unpackhi_epi16 (l, r));
+        }
+#else
+        for (; i + 8 <= samples; i += 8)
+        {
+            int16x8x2_t lr = {{vld1q_s16 (left + i), vld1q_s16 (right + i)}};
+            vst2q_s16 (out + 2 * i, lr);
+        }
+#endif
+
+        for (; i < samples; i ++)
+        {
+            out[2 * i] = left[i];
+            out[2 * i + 1] = right[i];
+        }
+
+        return;
+    }
+#endif
+
+    audio_interlace (data, format, channels, dest, samples);
+}
+
 static bool convert_format (int ff_fmt, int & aud_fmt, bool & planar)
 {
     switch (ff_fmt)
@@ -529,8 +960,7 @@ static bool convert_format (int ff_fmt, int & aud_fmt, bool & planar)
 
 bool FFaudio::play (const char * filename, VFSFile & file)
 {
-    SmartPtr<AVFormatContext, close_input_file>
-     ic (open_input_file (filename, file));
+    InputFile ic (filename, file);
 
     if (! ic)
         return false;
@@ -545,6 +975,29 @@ bool FFaudio::play (const char * filename, VFSFile & file)
     AUDDBG("got codec %s for stream index %d, opening\n", cinfo.codec->name, cinfo.stream_idx);
 
     ScopedContext context (cinfo);
+
+#if CHECK_LIBAVCODEC_VERSION (56, 1, 0)
+    /* raw DSD can bypass the decoder entirely and go out as DoP */
+    if (aud_get_bool ("ffaudio", "dop"))
+    {
+        switch (cinfo.codec->id)
+        {
+        case AV_CODEC_ID_DSD_LSBF:
+        case AV_CODEC_ID_DSD_MSBF:
+        case AV_CODEC_ID_DSD_LSBF_PLANAR:
+        case AV_CODEC_ID_DSD_MSBF_PLANAR:
+            return play_dop (ic.get (), cinfo, context.ptr);
+        default:
+            break;
+        }
+    }
+#endif
+
+    /* Multithreaded decode helps with heavyweight codecs (DTS, TrueHD);
+     * zero means one thread per core, decided by FFmpeg. */
+    context->thread_count = aud::clamp (aud_get_int ("ffaudio", "threads"), 0, 16);
+    context->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+
     if (LOG (avcodec_open2, context.ptr, cinfo.codec, nullptr) < 0)
         return false;
 
@@ -643,21 +1096,152 @@ bool FFaudio::play (const char * filename, VFSFile & file)
 
             if (planar)
             {
+                /* interleave planes into a reused buffer (it never shrinks,
+                 * so steady-state playback does not reallocate) */
                 if (size > buf.len ())
                     buf.resize (size);
 
-                audio_interlace ((const void * *) frame->data, out_fmt,
+                interlace_frame ((const void * *) frame->data, out_fmt,
                  channels, buf.begin (), frame->nb_samples);
                 write_audio (buf.begin (), size);
             }
             else
+            {
+                /* packed formats go straight from the decoded frame */
                 write_audio (frame->data[0], size);
+            }
+        }
+    }
+
+    return true;
+}
+
+#if CHECK_LIBAVCODEC_VERSION (56, 1, 0)
+
+/* table reversing the bit order of a byte, for LSB-first DSD variants */
+#define R2(n) n, n + 2*64, n + 1*64, n + 3*64
+#define R4(n) R2(n), R2(n + 2*16), R2(n + 1*16), R2(n + 3*16)
+#define R6(n) R4(n), R4(n + 2*4), R4(n + 1*4), R4(n + 3*4)
+static const unsigned char bit_rev[256] = {R6(0), R6(2), R6(1), R6(3)};
+#undef R2
+#undef R4
+#undef R6
+
+/* DSD over PCM (DoP): the raw DSD bytes are packed, two per channel, into
+ * 24-bit PCM frames whose top byte alternates between the 0x05 and 0xFA
+ * markers.  A DoP-capable DAC recognizes the marker sequence and unpacks
+ * the original DSD stream; anything else just plays the frames as very
+ * quiet noise.  The packing only survives to the output if the samples
+ * are not altered on the way, hence the volume/effects caveat in the
+ * preferences.  FFmpeg reports the DSD byte rate as the sample rate, and
+ * each DoP frame carries two bytes per channel, so the PCM rate is half
+ * that (176.4 kHz for DSD64). */
+bool FFaudio::play_dop (AVFormatContext * ic, const CodecInfo & cinfo,
+ AVCodecContext * context)
+{
+    bool lsbf = (cinfo.codec->id == AV_CODEC_ID_DSD_LSBF ||
+                 cinfo.codec->id == AV_CODEC_ID_DSD_LSBF_PLANAR);
+    bool planar = (cinfo.codec->id == AV_CODEC_ID_DSD_LSBF_PLANAR ||
+                   cinfo.codec->id == AV_CODEC_ID_DSD_MSBF_PLANAR);
+
+#if CHECK_LIBAVCODEC_VERSION(59, 37, 100)
+    int channels = context->ch_layout.nb_channels;
+#else
+    int channels = context->channels;
+#endif
+
+    if (channels < 1)
+        return false;
+
+    set_stream_bitrate (ic->bit_rate);
+    open_audio (FMT_S24_NE, context->sample_rate / 2, channels);
+
+    /* DSD bytes not yet packed, channel-interleaved and MSB-first */
+    Index<unsigned char> pending;
+    Index<int32_t> out;
+
+    bool marker = false;
+    int errcount = 0;
+
+    while (! check_stop ())
+    {
+        int seek_value = check_seek ();
+
+        if (seek_value >= 0)
+        {
+            if (LOG (av_seek_frame, ic, -1, (int64_t) seek_value *
+             AV_TIME_BASE / 1000, AVSEEK_FLAG_ANY) >= 0)
+            {
+                pending.clear (); /* drop bytes from before the seek */
+                errcount = 0;
+            }
+        }
+
+        ScopedPacket pkt;
+        int ret = LOG (av_read_frame, ic, pkt.ptr);
+
+        if (ret < 0)
+        {
+            if (ret == (int) AVERROR_EOF)
+                break; /* nothing buffered in a decoder to flush */
+
+            if (++ errcount > 4)
+                return false;
+
+            continue;
         }
+
+        errcount = 0;
+
+        /* Ignore any other substreams */
+        if (pkt->stream_index != cinfo.stream_idx)
+            continue;
+
+        int bytes_per_channel = pkt->size / channels;
+        if (! bytes_per_channel)
+            continue;
+
+        int base = pending.len ();
+        pending.insert (-1, bytes_per_channel * channels);
+
+        const unsigned char * data = pkt->data;
+
+        for (int f = 0; f < bytes_per_channel; f ++)
+        {
+            for (int c = 0; c < channels; c ++)
+            {
+                unsigned char b = planar ? data[c * bytes_per_channel + f]
+                                         : data[f * channels + c];
+                pending[base + f * channels + c] = lsbf ? bit_rev[b] : b;
+            }
+        }
+
+        int dop_frames = pending.len () / (2 * channels);
+        if (! dop_frames)
+            continue;
+
+        out.resize (dop_frames * channels);
+
+        for (int f = 0; f < dop_frames; f ++)
+        {
+            int32_t m = marker ? 0xFA0000 : 0x050000;
+            marker = ! marker;
+
+            for (int c = 0; c < channels; c ++)
+                out[f * channels + c] = m |
+                 ((int32_t) pending[(2 * f) * channels + c] << 8) |
+                 pending[(2 * f + 1) * channels + c];
+        }
+
+        pending.remove (0, dop_frames * 2 * channels);
+        write_audio (out.begin (), out.len () * sizeof (int32_t));
     }
 
     return true;
 }
 
+#endif // CHECK_LIBAVCODEC_VERSION (56, 1, 0)
+
 const char FFaudio::about[] =
  N_("Multi-format audio decoding plugin for Audacious using\n"
     "FFmpeg multimedia framework (http://www.ffmpeg.org/)\n"
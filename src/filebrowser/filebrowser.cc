@@ -162,51 +162,69 @@ static void append_tree_row(GFile * source, GFileInfo * info, GtkTreeIter * pare
     g_object_unref(file);
 }
 
-static void enumerate_children_cb(GObject * source, GAsyncResult * res, void * data)
+/* Number of entries fetched from the enumerator per batch. Each batch is
+ * appended to the tree in one main loop iteration, so the UI stays
+ * responsive while huge (or slow, e.g. networked) folders keep loading on
+ * a worker thread. */
+static constexpr int BATCH_SIZE = 500;
+
+/* Bumped on every navigation so that batches still in flight for the
+ * previous folder are recognized as stale and dropped. */
+static int load_serial;
+
+struct EnumerateState
+{
+    GFile * file;                  /* the directory being enumerated */
+    GFileEnumerator * enumerator;
+    GtkTreeRowReference * row_ref; /* null when loading the top level */
+    int serial;                    /* load_serial at the time of request */
+};
+
+static void enumerate_state_free(EnumerateState * state)
 {
-    GFile * file = (GFile *)source;
-    GtkTreeRowReference * row_ref = (GtkTreeRowReference *)data;
-    GtkTreeIter parent;
-    GtkTreeIter * parent_ptr = nullptr;
-    GError * error = nullptr;
+    if (state->enumerator)
+        g_object_unref(state->enumerator);
+    gtk_tree_row_reference_free(state->row_ref);
+    g_object_unref(state->file);
+    g_free(state);
+}
 
-    GFileEnumerator * enumerator = g_file_enumerate_children_finish(file, res, &error);
+/* Looks up the parent row to append entries to (null for the top level).
+ * Returns false if navigation has moved on or the row is gone. */
+static bool get_parent_iter(EnumerateState * state, GtkTreeIter * parent,
+                            GtkTreeIter * * parent_ptr)
+{
+    *parent_ptr = nullptr;
 
-    if (!enumerator)
-    {
-        AUDERR("%s\n", error->message);
-        g_error_free(error);
-        goto cleanup;
-    }
+    if (state->serial != load_serial)
+        return false;
 
-    if (row_ref)
-    {
-        GtkTreePath * path = gtk_tree_row_reference_get_path(row_ref);
-        if (!path)
-            goto cleanup_enum;
+    if (!state->row_ref)
+        return true;
 
-        if (!gtk_tree_model_get_iter((GtkTreeModel *)tree_store, &parent, path))
-        {
-            gtk_tree_path_free(path);
-            goto cleanup_enum;
-        }
+    GtkTreePath * path = gtk_tree_row_reference_get_path(state->row_ref);
+    if (!path)
+        return false;
 
-        parent_ptr = &parent;
-        gtk_tree_path_free(path);
-    }
+    gboolean valid = gtk_tree_model_get_iter((GtkTreeModel *)tree_store, parent, path);
+    gtk_tree_path_free(path);
 
-    GFileInfo * info;
-    while ((info = g_file_enumerator_next_file(enumerator, nullptr, nullptr)))
-    {
-        append_tree_row(file, info, parent_ptr);
-        g_object_unref(info);
-    }
+    if (valid)
+        *parent_ptr = parent;
 
-    if (row_ref)
+    return valid;
+}
+
+static void finish_enumeration(EnumerateState * state)
+{
+    GtkTreeIter parent;
+    GtkTreeIter * parent_ptr;
+
+    if (state->row_ref && get_parent_iter(state, &parent, &parent_ptr) && parent_ptr)
     {
-        GtkTreePath * store_path = gtk_tree_row_reference_get_path(row_ref);
         gtk_tree_store_set(tree_store, &parent, COL_LOADED, true, -1);
 
+        GtkTreePath * store_path = gtk_tree_row_reference_get_path(state->row_ref);
         if (store_path)
         {
             GtkTreeModel * model = gtk_tree_view_get_model(tree_view);
@@ -224,21 +242,77 @@ static void enumerate_children_cb(GObject * source, GAsyncResult * res, void * d
         }
     }
 
-cleanup_enum:
-    g_object_unref(enumerator);
-cleanup:
-    gtk_tree_row_reference_free(row_ref);
-    g_object_unref(file);
+    enumerate_state_free(state);
+}
+
+static void next_files_cb(GObject * source, GAsyncResult * res, void * data)
+{
+    EnumerateState * state = (EnumerateState *)data;
+    GError * error = nullptr;
+
+    GList * infos = g_file_enumerator_next_files_finish(
+        (GFileEnumerator *)source, res, &error);
+
+    if (error)
+    {
+        AUDERR("%s\n", error->message);
+        g_error_free(error);
+    }
+
+    GtkTreeIter parent;
+    GtkTreeIter * parent_ptr;
+    bool parent_valid = get_parent_iter(state, &parent, &parent_ptr);
+
+    if (parent_valid)
+    {
+        for (GList * l = infos; l; l = l->next)
+            append_tree_row(state->file, (GFileInfo *)l->data, parent_ptr);
+    }
+
+    bool more = infos && parent_valid;
+    g_list_free_full(infos, g_object_unref);
+
+    if (more)
+        g_file_enumerator_next_files_async(state->enumerator, BATCH_SIZE,
+                                           G_PRIORITY_DEFAULT, nullptr,
+                                           next_files_cb, state);
+    else
+        finish_enumeration(state);
+}
+
+static void enumerate_children_cb(GObject * source, GAsyncResult * res, void * data)
+{
+    EnumerateState * state = (EnumerateState *)data;
+    GError * error = nullptr;
+
+    state->enumerator = g_file_enumerate_children_finish((GFile *)source, res, &error);
+
+    if (!state->enumerator)
+    {
+        AUDERR("%s\n", error->message);
+        g_error_free(error);
+        enumerate_state_free(state);
+        return;
+    }
+
+    g_file_enumerator_next_files_async(state->enumerator, BATCH_SIZE,
+                                       G_PRIORITY_DEFAULT, nullptr,
+                                       next_files_cb, state);
 }
 
 static void load_dir_async(GFile * file, GtkTreeRowReference * row_ref)
 {
+    EnumerateState * state = g_new0(EnumerateState, 1);
+    state->file = (GFile *)g_object_ref(file);
+    state->row_ref = row_ref;
+    state->serial = load_serial;
+
     g_file_enumerate_children_async(
-        (GFile *)g_object_ref(file),
+        state->file,
         G_FILE_ATTRIBUTE_STANDARD_NAME "," G_FILE_ATTRIBUTE_STANDARD_TYPE ","
         G_FILE_ATTRIBUTE_STANDARD_IS_HIDDEN "," G_FILE_ATTRIBUTE_STANDARD_ICON,
         G_FILE_QUERY_INFO_NONE, G_PRIORITY_DEFAULT, nullptr,
-        enumerate_children_cb, row_ref);
+        enumerate_children_cb, state);
 }
 
 static void load_children_async(GtkTreeIter * iter)
@@ -574,6 +648,9 @@ static void navigate_to_directory(const char * filepath)
     bool is_root = !filename_get_parent(filepath);
     gtk_widget_set_sensitive(nav_button, !is_root);
     gtk_entry_set_text(filter_entry, "");
+
+    /* Invalidate enumeration batches still in flight for the old folder */
+    load_serial++;
     gtk_tree_store_clear(tree_store);
 
     GFile * target_dir = g_file_new_for_path(filepath);
@@ -1,5 +1,7 @@
 #include "convert.h"
 
+#include <math.h>
+#include <stdint.h>
 #include <string.h>
 
 #include <libaudcore/audio.h>
@@ -8,6 +10,21 @@
 static int in_fmt;
 static int out_fmt;
 
+/* Fast path for the dominant conversion: the float PCM fed to us by the
+ * output system into the 16-bit samples most encoders want.  The scale,
+ * clamp and round all map to vector instructions, so the compiler can
+ * auto-vectorize this loop (same approach as src/ui-common/pcm-scan.h);
+ * the less common formats still go through libaudcore's converters. */
+static void float_to_s16 (const float * in, int16_t * out, int samples)
+{
+    for (int i = 0; i < samples; i ++)
+    {
+        float f = in[i] * 32767;
+        f = (f < -32768) ? -32768 : (f > 32767) ? 32767 : f;
+        out[i] = (int16_t) lrintf (f);
+    }
+}
+
 static Index<char> convert_output;
 static Index<float> convert_temp;
 
@@ -25,6 +42,8 @@ const Index<char> & convert_process (const void * ptr, int length)
 
     if (in_fmt == out_fmt)
         memcpy (convert_output.begin (), ptr, FMT_SIZEOF (in_fmt) * samples);
+    else if (in_fmt == FMT_FLOAT && out_fmt == FMT_S16_NE)
+        float_to_s16 ((const float *) ptr, (int16_t *) convert_output.begin (), samples);
     else if (in_fmt == FMT_FLOAT)
         audio_to_int ((const float *) ptr, convert_output.begin (), out_fmt, samples);
     else if (out_fmt == FMT_FLOAT)
@@ -35,6 +35,7 @@
 
 #include "filewriter.h"
 #include "convert.h"
+#include "write-behind.h"
 
 class FileWriter : public OutputPlugin
 {
@@ -51,7 +52,9 @@ public:
         & prefs
     };
 
-    constexpr FileWriter () : OutputPlugin (info, 0, true) {}
+    /* note: force_reopen is off; track boundaries are handled in
+     * set_info() so the output pipeline is never torn down mid-stream */
+    constexpr FileWriter () : OutputPlugin (info, 0, false) {}
 
     bool init () override;
 
@@ -152,6 +155,7 @@ const char * const FileWriter::defaults[] = {
  "filenamefromtags", "TRUE",
  "prependnumber", "FALSE",
  "save_original", "FALSE",
+ "single_file_cue", "FALSE",
  "use_suffix", "FALSE",
  nullptr};
 
@@ -219,10 +223,80 @@ static VFSFile safe_create (const char * filename)
     return VFSFile ();
 }
 
+static StringBuf format_filename (const char * suffix);
+
+/* state of the currently open output, for splitting at track boundaries */
+static String current_target;    /* formatted name, before deduplication */
+static format_info open_info;    /* format passed to the encoder */
+static int in_frame_bytes;       /* input bytes per audio frame */
+static int64_t frames_written;   /* frames since the file was opened */
+
+static VFSFile cue_file;
+static int cue_track;
+
+/* appends a TRACK entry for the song in in_tuple, starting at the
+ * current offset into the recording */
+static void write_cue_track ()
+{
+    cue_track ++;
+
+    StringBuf entry = str_printf ("  TRACK %02d AUDIO\n", cue_track);
+
+    String title = in_tuple.get_str (Tuple::Title);
+    String artist = in_tuple.get_str (Tuple::Artist);
+
+    if (title)
+        str_append_printf (entry, "    TITLE \"%s\"\n", (const char *) title);
+    if (artist)
+        str_append_printf (entry, "    PERFORMER \"%s\"\n", (const char *) artist);
+
+    int64_t msf = frames_written * 75 / open_info.frequency;
+    str_append_printf (entry, "    INDEX 01 %02d:%02d:%02d\n",
+     (int) (msf / (75 * 60)), (int) (msf / 75 % 60), (int) (msf % 75));
+
+    if (cue_file.fwrite (entry, 1, entry.len ()) != entry.len ())
+        AUDERR ("Error writing cue sheet.\n");
+}
+
 void FileWriter::set_info (const char * filename, const Tuple & tuple)
 {
     in_filename = String (filename);
     in_tuple = tuple.ref ();
+
+    if (! plugin)
+        return;
+
+    /* a track boundary while recording: either mark it in the cue sheet
+     * or start a new file, without tearing down the output pipeline */
+    if (cue_file)
+    {
+        write_cue_track ();
+        return;
+    }
+
+    int ext = aud_get_int ("filewriter", "fileext");
+    g_return_if_fail (ext >= 0 && ext < FILEEXT_MAX);
+
+    StringBuf new_name = format_filename (fileext_str[ext]);
+    if (! new_name || ! strcmp (new_name, current_target))
+        return; /* metadata-only update; keep writing */
+
+    plugin->close (output_file);
+
+    output_file = safe_create (new_name);
+    if (output_file)
+        output_file = open_write_behind (std::move (output_file));
+
+    if (! output_file || ! plugin->open (output_file, open_info, in_tuple))
+    {
+        AUDERR ("Error opening %s; recording stopped.\n", (const char *) new_name);
+        plugin = nullptr;
+        output_file = VFSFile ();
+        return;
+    }
+
+    current_target = String (new_name);
+    frames_written = 0;
 }
 
 static StringBuf format_filename (const char * suffix)
@@ -307,8 +381,40 @@ bool FileWriter::open_audio (int fmt, int rate, int nch, String & error)
     output_file = safe_create (filename);
     if (output_file)
     {
+        /* decouple the encoder from destination latency; any background
+         * write error surfaces through the encoder's own write calls */
+        output_file = open_write_behind (std::move (output_file));
+
         if (plugin->open (output_file, {out_fmt, rate, nch}, in_tuple))
+        {
+            current_target = String (filename);
+            open_info = {out_fmt, rate, nch};
+            in_frame_bytes = FMT_SIZEOF (fmt) * nch;
+            frames_written = 0;
+
+            if (aud_get_bool ("filewriter", "single_file_cue"))
+            {
+                const char * out_name = output_file.filename ();
+                cue_file = VFSFile (str_concat ({out_name, ".cue"}), "w");
+
+                if (cue_file)
+                {
+                    const char * slash = strrchr (out_name, '/');
+                    StringBuf base = str_decode_percent (slash ? slash + 1 : out_name);
+                    StringBuf header = str_printf ("FILE \"%s\" WAVE\n", (const char *) base);
+
+                    if (cue_file.fwrite (header, 1, header.len ()) != header.len ())
+                        AUDERR ("Error writing cue sheet.\n");
+
+                    cue_track = 0;
+                    write_cue_track ();
+                }
+                else
+                    AUDERR ("Error opening cue sheet file.\n");
+            }
+
             return true;
+        }
     }
     else
     {
@@ -325,21 +431,32 @@ bool FileWriter::open_audio (int fmt, int rate, int nch, String & error)
 
 int FileWriter::write_audio (const void * ptr, int length)
 {
+    if (! plugin)
+        return length; /* a mid-stream reopen failed; drop the output */
+
     auto & buf = convert_process (ptr, length);
     plugin->write (output_file, buf.begin (), buf.len ());
 
+    frames_written += length / in_frame_bytes;
+
     return length;
 }
 
 void FileWriter::close_audio ()
 {
-    plugin->close (output_file);
+    if (plugin)
+        plugin->close (output_file);
+
     convert_free ();
 
     plugin = nullptr;
     output_file = VFSFile ();
     in_filename = String ();
     in_tuple = Tuple ();
+
+    current_target = String ();
+    cue_file = VFSFile ();
+    frames_written = 0;
 }
 
 static void save_original_cb ()
@@ -408,7 +525,9 @@ static const PreferencesWidget main_widgets[] = {
         {FILENAME_FROM_TAG}),
     WidgetSeparator ({true}),
     WidgetCheck (N_("Prepend track number to file name"),
-        WidgetBool ("filewriter", "prependnumber"))
+        WidgetBool ("filewriter", "prependnumber")),
+    WidgetCheck (N_("Record to a single file with a cue sheet"),
+        WidgetBool ("filewriter", "single_file_cue"))
 };
 
 #ifdef FILEWRITER_MP3
@@ -23,6 +23,8 @@
 
 #ifdef FILEWRITER_FLAC
 
+#include <glib.h>
+
 #include <FLAC/all.h>
 
 #include <libaudcore/audstrings.h>
@@ -101,6 +103,13 @@ static bool flac_open (VFSFile & file, const format_info & info, const Tuple & t
     FLAC__stream_encoder_set_channels(flac_encoder, info.channels);
     FLAC__stream_encoder_set_sample_rate(flac_encoder, info.frequency);
 
+#if defined(FLAC_API_VERSION_CURRENT) && FLAC_API_VERSION_CURRENT >= 14
+    /* libFLAC 1.5.0 can split the stream into frames and encode them on
+     * a worker pool internally, stitching the output in order; with it,
+     * conversion is no longer limited to a single core */
+    FLAC__stream_encoder_set_num_threads(flac_encoder, g_get_num_processors());
+#endif
+
     flac_metadata = FLAC__metadata_object_new(FLAC__METADATA_TYPE_VORBIS_COMMENT);
 
     insert_vorbis_comment (flac_metadata, "TITLE", tuple, Tuple::Title);
@@ -0,0 +1,280 @@
+/*  FileWriter write-behind buffer
+ *  Copyright (c) 2025 Audacious team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "write-behind.h"
+
+#include <pthread.h>
+#include <string.h>
+
+#include <libaudcore/index.h>
+#include <libaudcore/runtime.h>
+#include <libaudcore/templates.h>
+
+/* The encoders trickle output in many small writes.  Against a local
+ * disk that is harmless, but a high-latency destination (network mount)
+ * stalls the encoding thread, and with it realtime playback, on every
+ * write.  Two fixed-size buffers alternate instead: the encoder fills
+ * one while a background thread flushes the other in a single large
+ * write, so the encoder only blocks when the destination falls a full
+ * buffer behind.  The rare non-sequential operations (the header
+ * rewrites the encoders perform at open and close) drain the buffer
+ * first and then go straight to the destination. */
+
+static constexpr int BUFFER_SIZE = 256 * 1024;
+
+class WriteBehindFile : public VFSImpl
+{
+public:
+    WriteBehindFile (VFSFile && dest) :
+        m_dest (std::move (dest)) {}
+
+    ~WriteBehindFile () override;
+
+protected:
+    int64_t fread (void * ptr, int64_t size, int64_t nmemb) override;
+    int64_t fwrite (const void * buf, int64_t size, int64_t nitems) override;
+
+    int fseek (int64_t offset, VFSSeekType whence) override;
+    int64_t ftell () override;
+    bool feof () override;
+
+    int ftruncate (int64_t length) override;
+    int64_t fsize () override;
+
+    int fflush () override;
+
+private:
+    VFSFile m_dest;
+
+    Index<char> m_fill;   /* being appended to by the encoder */
+    Index<char> m_flush;  /* being written out by the flusher */
+
+    pthread_t m_flusher;
+    pthread_mutex_t m_mutex = PTHREAD_MUTEX_INITIALIZER;
+    pthread_cond_t m_cond = PTHREAD_COND_INITIALIZER;
+    bool m_running = false;  /* flusher thread started */
+    bool m_busy = false;     /* flusher has a buffer to write */
+    bool m_error = false;    /* a background write failed */
+    bool m_quit = false;
+
+    /* the following are called with the mutex held */
+    bool start_flusher ();
+    void hand_off ();
+    int drain ();
+
+    void flusher ();
+
+    static void * flusher_thread (void * data)
+        { ((WriteBehindFile *) data)->flusher (); return nullptr; }
+};
+
+bool WriteBehindFile::start_flusher ()
+{
+    if (m_running)
+        return true;
+
+    if (pthread_create (& m_flusher, nullptr, flusher_thread, this))
+        return false;
+
+    m_running = true;
+    return true;
+}
+
+/* passes the full buffer to the flusher; falls back to a synchronous
+ * write if no thread could be created */
+void WriteBehindFile::hand_off ()
+{
+    if (! start_flusher ())
+    {
+        if (m_dest.fwrite (m_fill.begin (), 1, m_fill.len ()) != m_fill.len ())
+            m_error = true;
+
+        m_fill.clear ();
+        return;
+    }
+
+    while (m_busy)
+        pthread_cond_wait (& m_cond, & m_mutex);
+
+    if (m_error)
+        return;
+
+    m_flush = std::move (m_fill);
+    m_busy = true;
+    pthread_cond_broadcast (& m_cond);
+}
+
+/* waits out any pending background write and flushes what remains
+ * buffered, so that the destination is fully caught up */
+int WriteBehindFile::drain ()
+{
+    while (m_busy)
+        pthread_cond_wait (& m_cond, & m_mutex);
+
+    if (! m_error && m_fill.len ())
+    {
+        if (m_dest.fwrite (m_fill.begin (), 1, m_fill.len ()) != m_fill.len ())
+            m_error = true;
+    }
+
+    m_fill.clear ();
+    return m_error ? -1 : 0;
+}
+
+void WriteBehindFile::flusher ()
+{
+    pthread_mutex_lock (& m_mutex);
+
+    while (1)
+    {
+        while (! m_busy && ! m_quit)
+            pthread_cond_wait (& m_cond, & m_mutex);
+
+        if (! m_busy)
+            break;
+
+        Index<char> data = std::move (m_flush);
+        pthread_mutex_unlock (& m_mutex);
+
+        int64_t written = m_dest.fwrite (data.begin (), 1, data.len ());
+
+        pthread_mutex_lock (& m_mutex);
+
+        if (written != data.len ())
+            m_error = true;
+
+        m_busy = false;
+        pthread_cond_broadcast (& m_cond);
+    }
+
+    pthread_mutex_unlock (& m_mutex);
+}
+
+WriteBehindFile::~WriteBehindFile ()
+{
+    pthread_mutex_lock (& m_mutex);
+    drain ();
+    m_quit = true;
+    pthread_cond_broadcast (& m_cond);
+    bool running = m_running;
+    bool error = m_error;
+    pthread_mutex_unlock (& m_mutex);
+
+    if (running)
+        pthread_join (m_flusher, nullptr);
+
+    if (error)
+        AUDERR ("Error writing %s.\n", m_dest.filename ());
+}
+
+int64_t WriteBehindFile::fwrite (const void * buf, int64_t size, int64_t nitems)
+{
+    const char * data = (const char *) buf;
+    int64_t total = size * nitems;
+    int64_t left = total;
+
+    pthread_mutex_lock (& m_mutex);
+
+    while (left > 0 && ! m_error)
+    {
+        if (m_fill.len () >= BUFFER_SIZE)
+        {
+            hand_off ();
+            continue;
+        }
+
+        int64_t copy = aud::min (left, (int64_t) (BUFFER_SIZE - m_fill.len ()));
+        m_fill.insert (data, -1, copy);
+
+        data += copy;
+        left -= copy;
+    }
+
+    pthread_mutex_unlock (& m_mutex);
+
+    return size ? (total - left) / size : 0;
+}
+
+int64_t WriteBehindFile::fread (void * ptr, int64_t size, int64_t nmemb)
+{
+    pthread_mutex_lock (& m_mutex);
+    int error = drain ();
+    pthread_mutex_unlock (& m_mutex);
+
+    return error ? 0 : m_dest.fread (ptr, size, nmemb);
+}
+
+int WriteBehindFile::fseek (int64_t offset, VFSSeekType whence)
+{
+    pthread_mutex_lock (& m_mutex);
+    int error = drain ();
+    pthread_mutex_unlock (& m_mutex);
+
+    return error ? -1 : m_dest.fseek (offset, whence);
+}
+
+int64_t WriteBehindFile::ftell ()
+{
+    pthread_mutex_lock (& m_mutex);
+    int error = drain ();
+    pthread_mutex_unlock (& m_mutex);
+
+    return error ? -1 : m_dest.ftell ();
+}
+
+bool WriteBehindFile::feof ()
+{
+    pthread_mutex_lock (& m_mutex);
+    drain ();
+    pthread_mutex_unlock (& m_mutex);
+
+    return m_dest.feof ();
+}
+
+int WriteBehindFile::ftruncate (int64_t length)
+{
+    pthread_mutex_lock (& m_mutex);
+    int error = drain ();
+    pthread_mutex_unlock (& m_mutex);
+
+    return error ? -1 : m_dest.ftruncate (length);
+}
+
+int64_t WriteBehindFile::fsize ()
+{
+    pthread_mutex_lock (& m_mutex);
+    int error = drain ();
+    pthread_mutex_unlock (& m_mutex);
+
+    return error ? -1 : m_dest.fsize ();
+}
+
+int WriteBehindFile::fflush ()
+{
+    pthread_mutex_lock (& m_mutex);
+    int error = drain ();
+    pthread_mutex_unlock (& m_mutex);
+
+    return error ? -1 : m_dest.fflush ();
+}
+
+VFSFile open_write_behind (VFSFile && dest)
+{
+    String filename (dest.filename ());
+    return VFSFile (filename, new WriteBehindFile (std::move (dest)));
+}
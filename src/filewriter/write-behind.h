@@ -0,0 +1,10 @@
+#ifndef WRITE_BEHIND_H
+#define WRITE_BEHIND_H
+
+#include <libaudcore/vfs.h>
+
+/* Wraps an open destination file so that sequential writes are buffered
+ * and flushed by a background thread; see write-behind.cc for details. */
+VFSFile open_write_behind (VFSFile && dest);
+
+#endif
@@ -24,6 +24,8 @@
 
 #include <libaudcore/i18n.h>
 #include <libaudcore/plugin.h>
+#include <libaudcore/preferences.h>
+#include <libaudcore/runtime.h>
 
 class FLACng : public InputPlugin
 {
@@ -31,11 +33,15 @@ public:
     static const char about[];
     static const char *const exts[];
     static const char *const mimes[];
+    static const char *const defaults[];
+    static const PreferencesWidget widgets[];
+    static const PluginPreferences prefs;
 
     static constexpr PluginInfo info = {
         N_("FLAC Decoder"),
         PACKAGE,
-        about
+        about,
+        &prefs
     };
 
     constexpr FLACng() : InputPlugin(info, InputInfo(FlagWritesTag)
@@ -70,6 +76,37 @@ struct callback_info
     VFSFile *fd = nullptr;
     int bitrate = 0;
 
+    /* position of the most recently decoded frame, for the seek-point
+     * memo (see plugin.cc) */
+    uint64_t frame_start_sample = 0;
+    int64_t frame_start_byte = -1;
+    int64_t pending_frame_byte = -1; /* decode position before the frame */
+
+    /*
+     * Buffered read layer: libFLAC issues many small reads per frame, so the
+     * read callback serves them from a large cache filled with aligned VFS
+     * reads (see seekable_stream_callbacks.cc). Disabled for streams, where
+     * reading ahead could block on the network.
+     */
+    Index<char> read_cache;
+    int64_t cache_offset = 0; /* file offset of the first cached byte */
+    int cache_used = 0;       /* valid bytes in the cache */
+    int cache_pos = 0;        /* read position within the cache */
+    bool cache_enabled = false;
+
+    void setup_cache(bool enable)
+    {
+        cache_enabled = enable;
+        cache_offset = 0;
+        cache_used = cache_pos = 0;
+
+        if (enable)
+        {
+            int kb = aud::clamp(aud_get_int("flacng", "cache_size"), 16, 4096);
+            read_cache.resize(kb * 1024);
+        }
+    }
+
     void alloc()
     {
         output_buffer.resize(BUFFER_SIZE_SAMP);
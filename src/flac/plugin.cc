@@ -20,18 +20,127 @@
 
 #include <string.h>
 
+#include <libaudcore/multihash.h>
 #include <libaudcore/runtime.h>
 
 #include "flacng.h"
 
 EXPORT FLACng aud_plugin_instance;
 
+const char *const FLACng::defaults[] = {
+    "cache_size", "256", /* KB */
+    nullptr};
+
+const PreferencesWidget FLACng::widgets[] = {
+    WidgetLabel(N_("<b>Advanced</b>")),
+    WidgetSpin(N_("Read cache size:"),
+               WidgetInt("flacng", "cache_size"),
+               {16, 4096, 16, N_("KB")})};
+
+const PluginPreferences FLACng::prefs = {{widgets}};
+
 using StreamDecoderPtr = SmartPtr<FLAC__StreamDecoder, FLAC__stream_decoder_delete>;
 static StreamDecoderPtr s_decoder, s_ogg_decoder;
 static callback_info s_cinfo;
 
+/*
+ * Seek points learned during playback, keyed by filename.  The frame
+ * boundary where one virtual track of a cue sheet stops decoding is
+ * exactly where the next track begins, so consecutive track changes
+ * within a single-file album resume with a direct fseek to a recorded
+ * frame offset instead of libFLAC's binary-search time seek.
+ */
+struct SeekPoint
+{
+    uint64_t sample; /* first sample of the frame at this offset */
+    int64_t byte;
+};
+
+struct SeekMemo
+{
+    int64_t file_size = 0;
+    Index<SeekPoint> points;
+};
+
+#define SEEK_MEMO_FILES 16
+#define SEEK_MEMO_POINTS 128
+
+/* how far past a known frame boundary a target may be; decoding forward
+ * from further away would cost more than the search being avoided */
+#define SEEK_MEMO_WINDOW (4 * FLAC__MAX_BLOCK_SIZE)
+
+static SimpleHash<String, SeekMemo> s_seek_memo;
+static int s_seek_memo_files = 0;
+
+static void memo_store(const char *filename, int64_t file_size,
+ uint64_t sample, int64_t byte)
+{
+    String key(filename);
+    SeekMemo *memo = s_seek_memo.lookup(key);
+
+    if (!memo)
+    {
+        if (s_seek_memo_files >= SEEK_MEMO_FILES)
+        {
+            s_seek_memo.clear();
+            s_seek_memo_files = 0;
+        }
+
+        memo = s_seek_memo.add(key, SeekMemo());
+        s_seek_memo_files++;
+    }
+
+    if (memo->file_size != file_size)
+    {
+        memo->points.clear();
+        memo->file_size = file_size;
+    }
+
+    for (auto &p : memo->points)
+    {
+        if (p.sample == sample)
+        {
+            p.byte = byte;
+            return;
+        }
+    }
+
+    if (memo->points.len() >= SEEK_MEMO_POINTS)
+        memo->points.clear();
+
+    memo->points.append(SeekPoint {sample, byte});
+}
+
+static const SeekPoint *memo_lookup(const char *filename, int64_t file_size,
+ uint64_t sample)
+{
+    SeekMemo *memo = s_seek_memo.lookup(String(filename));
+    if (!memo || memo->file_size != file_size)
+        return nullptr;
+
+    const SeekPoint *best = nullptr;
+
+    for (auto &p : memo->points)
+    {
+        if (p.sample <= sample && sample - p.sample <= SEEK_MEMO_WINDOW &&
+         (!best || p.sample > best->sample))
+            best = &p;
+    }
+
+    return best;
+}
+
+static void memo_drop(const char *filename)
+{
+    SeekMemo *memo = s_seek_memo.lookup(String(filename));
+    if (memo)
+        memo->points.clear();
+}
+
 bool FLACng::init()
 {
+    aud_config_set_defaults("flacng", defaults);
+
     /* Callback structure and decoder for main decoding loop */
     auto flac_decoder = StreamDecoderPtr(FLAC__stream_decoder_new());
     if (!flac_decoder)
@@ -83,6 +192,8 @@ void FLACng::cleanup()
 {
     s_decoder.clear();
     s_ogg_decoder.clear();
+    s_seek_memo.clear();
+    s_seek_memo_files = 0;
 }
 
 bool FLACng::is_our_file(const char *filename, VFSFile &file)
@@ -130,6 +241,9 @@ bool FLACng::play(const char *filename, VFSFile &file)
 {
     Index<char> play_buffer;
     bool error = false;
+    uint64_t seek_target = 0;
+    uint64_t skip_samples = 0;   /* decoded samples to drop after a memo seek */
+    int64_t expect_sample = -1;  /* frame expected at the memoized offset */
     bool stream = (file.fsize() < 0);
     bool _is_ogg_flac = is_ogg_flac(file);
     auto tuple = stream ? get_playback_tuple() : Tuple();
@@ -143,6 +257,7 @@ bool FLACng::play(const char *filename, VFSFile &file)
     }
 
     s_cinfo.fd = &file;
+    s_cinfo.setup_cache(!stream);
 
     if (read_metadata(decoder, &s_cinfo) == false)
     {
@@ -173,7 +288,24 @@ bool FLACng::play(const char *filename, VFSFile &file)
             if (s_cinfo.total_samples > 0)
                 sample = aud::min<uint64_t>(sample, s_cinfo.total_samples - 1);
 
-            if (! FLAC__stream_decoder_seek_absolute(decoder, sample))
+            seek_target = sample;
+            skip_samples = 0;
+            expect_sample = -1;
+
+            const SeekPoint *point = stream ? nullptr
+                : memo_lookup(filename, file.fsize(), sample);
+
+            if (point && FLAC__stream_decoder_flush(decoder) &&
+             file.fseek(point->byte, VFS_SEEK_SET) == 0)
+            {
+                /* resume decoding directly at a recorded frame boundary;
+                 * the decoder re-syncs instantly since the offset is exact */
+                s_cinfo.cache_offset = point->byte;
+                s_cinfo.cache_used = s_cinfo.cache_pos = 0;
+                skip_samples = sample - point->sample;
+                expect_sample = point->sample;
+            }
+            else if (! FLAC__stream_decoder_seek_absolute(decoder, sample))
             {
                 AUDERR("Error while seeking!\n");
                 error = true;
@@ -181,6 +313,13 @@ bool FLACng::play(const char *filename, VFSFile &file)
             }
         }
 
+        /* note the byte position of the frame about to be decoded */
+        FLAC__uint64 decode_pos;
+        if (FLAC__stream_decoder_get_decode_position(decoder, &decode_pos))
+            s_cinfo.pending_frame_byte = decode_pos;
+        else
+            s_cinfo.pending_frame_byte = -1;
+
         /* Try to decode a single frame of audio */
         if (FLAC__stream_decoder_process_single(decoder) == false)
         {
@@ -189,6 +328,45 @@ bool FLACng::play(const char *filename, VFSFile &file)
             break;
         }
 
+        if (expect_sample >= 0)
+        {
+            /* verify the memoized offset still lines up with the file */
+            if (s_cinfo.frame_start_sample != (uint64_t) expect_sample)
+            {
+                AUDWARN("Stale seek point; falling back to decoder seek.\n");
+                memo_drop(filename);
+                skip_samples = 0;
+                expect_sample = -1;
+                s_cinfo.reset();
+
+                if (! FLAC__stream_decoder_seek_absolute(decoder, seek_target))
+                {
+                    AUDERR("Error while seeking!\n");
+                    error = true;
+                    break;
+                }
+
+                continue;
+            }
+
+            expect_sample = -1;
+        }
+
+        if (skip_samples > 0 && s_cinfo.buffer_used > 0)
+        {
+            /* drop decoded samples preceding the seek target */
+            unsigned drop = aud::min((unsigned) (skip_samples * s_cinfo.channels),
+             s_cinfo.buffer_used);
+
+            memmove(s_cinfo.output_buffer.begin(),
+             s_cinfo.output_buffer.begin() + drop,
+             (s_cinfo.buffer_used - drop) * sizeof(int32_t));
+
+            s_cinfo.buffer_used -= drop;
+            s_cinfo.write_pointer -= drop;
+            skip_samples -= drop / s_cinfo.channels;
+        }
+
         if (stream && tuple.fetch_stream_info(file))
             set_playback_tuple(tuple.ref());
 
@@ -200,6 +378,12 @@ bool FLACng::play(const char *filename, VFSFile &file)
         s_cinfo.reset();
     }
 
+    /* remember the frame boundary where decoding stopped; the next track
+     * of a cue album starts exactly there */
+    if (! error && ! stream && s_cinfo.frame_start_byte >= 0)
+        memo_store(filename, file.fsize(), s_cinfo.frame_start_sample,
+         s_cinfo.frame_start_byte);
+
 ERR:
     s_cinfo.reset();
 
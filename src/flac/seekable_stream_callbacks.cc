@@ -25,6 +25,27 @@
 
 #include "flacng.h"
 
+/* refills the cache with one VFS read, sized so that reads stay aligned to
+ * cache-size boundaries in the file; returns bytes read, 0 at EOF, -1 on
+ * error */
+static int64_t cache_refill(callback_info *info)
+{
+    int64_t pos = info->cache_offset + info->cache_used;
+    int chunk = info->read_cache.len();
+    int to_read = chunk - (int) (pos % chunk);
+
+    int64_t read = info->fd->fread (info->read_cache.begin(), 1, to_read);
+
+    if (read > 0)
+    {
+        info->cache_offset = pos;
+        info->cache_used = read;
+        info->cache_pos = 0;
+    }
+
+    return read;
+}
+
 FLAC__StreamDecoderReadStatus read_callback(const FLAC__StreamDecoder *decoder, FLAC__byte buffer[], size_t *bytes, void *client_data)
 {
     callback_info* info = (callback_info*) client_data;
@@ -33,6 +54,44 @@ FLAC__StreamDecoderReadStatus read_callback(const FLAC__StreamDecoder *decoder,
     if (*bytes == 0)
         return FLAC__STREAM_DECODER_READ_STATUS_END_OF_STREAM;
 
+    if (info->cache_enabled)
+    {
+        size_t want = *bytes;
+        size_t got = 0;
+
+        while (got < want)
+        {
+            if (info->cache_pos == info->cache_used)
+            {
+                int64_t filled = cache_refill (info);
+
+                if (filled < 0)
+                {
+                    AUDERR("Error while reading from stream!\n");
+                    return FLAC__STREAM_DECODER_READ_STATUS_ABORT;
+                }
+                if (filled == 0)
+                    break;
+            }
+
+            size_t copy = aud::min (want - got,
+             (size_t) (info->cache_used - info->cache_pos));
+            memcpy (buffer + got, & info->read_cache[info->cache_pos], copy);
+            info->cache_pos += copy;
+            got += copy;
+        }
+
+        *bytes = got;
+
+        if (got == 0)
+        {
+            AUDDBG("Stream reached EOF\n");
+            return FLAC__STREAM_DECODER_READ_STATUS_END_OF_STREAM;
+        }
+
+        return FLAC__STREAM_DECODER_READ_STATUS_CONTINUE;
+    }
+
     read = info->fd->fread (buffer, 1, *bytes);
     *bytes = read;
 
@@ -55,12 +114,28 @@ FLAC__StreamDecoderSeekStatus seek_callback(const FLAC__StreamDecoder *decoder,
 {
     callback_info *info = (callback_info*) client_data;
 
+    /* libFLAC's binary-search seek probes nearby offsets repeatedly; when a
+     * target is still inside the cached chunk, just move the read position */
+    if (info->cache_enabled && (int64_t) offset >= info->cache_offset &&
+     (int64_t) offset < info->cache_offset + info->cache_used)
+    {
+        info->cache_pos = offset - info->cache_offset;
+        return FLAC__STREAM_DECODER_SEEK_STATUS_OK;
+    }
+
     if (info->fd->fseek (offset, VFS_SEEK_SET) != 0)
     {
         AUDERR("Could not seek to %ld!\n", (long)offset);
         return FLAC__STREAM_DECODER_SEEK_STATUS_ERROR;
     }
 
+    if (info->cache_enabled)
+    {
+        /* invalidate; the next read refills a chunk starting here */
+        info->cache_offset = offset;
+        info->cache_used = info->cache_pos = 0;
+    }
+
     return FLAC__STREAM_DECODER_SEEK_STATUS_OK;
 }
 
@@ -68,6 +143,13 @@ FLAC__StreamDecoderTellStatus tell_callback(const FLAC__StreamDecoder *decoder,
 {
     callback_info *info = (callback_info*) client_data;
 
+    if (info->cache_enabled)
+    {
+        /* logical position: cached but unread bytes are still "ahead" */
+        *offset = info->cache_offset + info->cache_pos;
+        return FLAC__STREAM_DECODER_TELL_STATUS_OK;
+    }
+
     int64_t result = info->fd->ftell ();
     if (result < 0)
     {
@@ -85,6 +167,10 @@ FLAC__StreamDecoderTellStatus tell_callback(const FLAC__StreamDecoder *decoder,
 FLAC__bool eof_callback(const FLAC__StreamDecoder *decoder, void *client_data)
 {
     callback_info *info = (callback_info*) client_data;
+
+    if (info->cache_enabled && info->cache_pos < info->cache_used)
+        return false;
+
     return info->fd->feof ();
 }
 
@@ -122,6 +208,15 @@ FLAC__StreamDecoderWriteStatus write_callback(const FLAC__StreamDecoder *decoder
         return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
     }
 
+    /* record where this frame starts, for the seek-point memo */
+    if (frame->header.number_type == FLAC__FRAME_NUMBER_TYPE_SAMPLE_NUMBER)
+        info->frame_start_sample = frame->header.number.sample_number;
+    else
+        info->frame_start_sample = (uint64_t) frame->header.number.frame_number *
+         frame->header.blocksize;
+
+    info->frame_start_byte = info->pending_frame_byte;
+
     if (!info->output_buffer.len())
         info->alloc();
 
@@ -17,6 +17,7 @@
  * the use of this software.
  */
 
+#include <pthread.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
@@ -28,8 +29,12 @@
 #include <libaudcore/i18n.h>
 #include <libaudcore/interface.h>
 #include <libaudcore/plugin.h>
+#include <libaudcore/ringbuf.h>
 #include <libaudcore/runtime.h>
 
+/* Maximum bytes per blocking read issued by the readahead thread */
+#define GIO_READBLKSIZE 16384
+
 static const char gio_about[] =
  N_("GIO Plugin for Audacious\n"
     "Copyright 2009-2012 John Lindgren");
@@ -82,6 +87,31 @@ private:
     GOutputStream * m_ostream = nullptr;
     GSeekable * m_seekable = nullptr;
     bool m_eof = false;
+
+    /* Readahead state, used in read-only mode.  All the schemes we handle
+     * are remote mounts, so reads can stall for network round trips; a
+     * background thread keeps a ring buffer filled so that the decode
+     * thread only blocks when the buffer is truly empty.  The reader owns
+     * m_istream while it is running; operations that touch the stream
+     * directly must stop it and resync the stream position first. */
+    RingBuf<char> m_rb;
+    pthread_t m_reader;
+    pthread_mutex_t m_mutex = PTHREAD_MUTEX_INITIALIZER;
+    pthread_cond_t m_cond = PTHREAD_COND_INITIALIZER;
+    bool m_readahead = false;   /* eligible (read-only mode) */
+    bool m_reading = false;     /* reader thread running */
+    bool m_read_eof = false;    /* reader hit end of stream */
+    bool m_read_error = false;  /* reader hit an error */
+    bool m_quit = false;
+    int64_t m_pos = 0;          /* position seen by the consumer */
+
+    bool ensure_reader ();
+    void stop_reader ();
+    void resync_stream ();
+    void reader ();
+
+    static void * reader_thread (void * data)
+        { ((GIOFile *) data)->reader (); return nullptr; }
 };
 
 #define CHECK_ERROR(op, name) do { \
@@ -125,6 +155,8 @@ GIOFile::GIOFile (const char * filename, const char * mode) :
             m_istream = (GInputStream *) g_file_read (m_file, 0, & error);
             CHECK_AND_SAVE_ERROR ("open", filename);
             m_seekable = (GSeekable *) m_istream;
+            m_readahead = true;
+            m_rb.alloc (1024 * aud::clamp (aud_get_int ("net_buffer_kb"), 16, 1024));
         }
         break;
     case 'w':
@@ -177,6 +209,8 @@ GIOFile::~GIOFile ()
 {
     GError * error = nullptr;
 
+    stop_reader ();
+
     if (m_iostream)
     {
         g_io_stream_close (m_iostream, 0, & error);
@@ -200,6 +234,117 @@ FAILED:
     g_object_unref (m_file);
 }
 
+void GIOFile::reader ()
+{
+    char buf[GIO_READBLKSIZE];
+
+    pthread_mutex_lock (& m_mutex);
+
+    while (! m_quit)
+    {
+        int space = aud::min (m_rb.space (), (int) sizeof buf);
+
+        if (! space)
+        {
+            pthread_cond_wait (& m_cond, & m_mutex);
+            continue;
+        }
+
+        pthread_mutex_unlock (& m_mutex);
+
+        GError * error = nullptr;
+        int64_t part = g_input_stream_read (m_istream, buf, space, 0, & error);
+
+        pthread_mutex_lock (& m_mutex);
+
+        if (part > 0)
+            m_rb.copy_in (buf, part);
+        else if (part == 0)
+            m_read_eof = true;
+        else
+        {
+            AUDERR ("Error while reading from %s: %s.\n", (const char *)
+             m_filename, error ? error->message : "unknown error");
+
+            if (error)
+                g_error_free (error);
+
+            m_read_error = true;
+        }
+
+        pthread_cond_broadcast (& m_cond);
+
+        if (part <= 0)
+            break;
+    }
+
+    /* hold the buffered data until told to quit */
+    while (! m_quit)
+        pthread_cond_wait (& m_cond, & m_mutex);
+
+    pthread_mutex_unlock (& m_mutex);
+}
+
+bool GIOFile::ensure_reader ()
+{
+    if (m_reading || m_read_eof || m_read_error)
+        return true;
+
+    if (pthread_create (& m_reader, nullptr, reader_thread, this) != 0)
+    {
+        AUDERR ("Cannot start reader thread for %s.\n", (const char *) m_filename);
+        m_readahead = false;
+        return false;
+    }
+
+    m_reading = true;
+    return true;
+}
+
+void GIOFile::stop_reader ()
+{
+    if (! m_reading)
+        return;
+
+    pthread_mutex_lock (& m_mutex);
+    m_quit = true;
+    pthread_cond_broadcast (& m_cond);
+    pthread_mutex_unlock (& m_mutex);
+
+    pthread_join (m_reader, nullptr);
+
+    m_reading = false;
+    m_quit = false;
+}
+
+/* Stops the reader and rewinds the stream to the position the consumer has
+ * actually reached, so that direct stream operations (seeks, size queries)
+ * see a consistent file offset. */
+void GIOFile::resync_stream ()
+{
+    if (! m_readahead)
+        return;
+
+    stop_reader ();
+
+    if (m_rb.len () > 0)
+    {
+        GError * error = nullptr;
+        g_seekable_seek (m_seekable, m_pos, G_SEEK_SET, nullptr, & error);
+
+        if (error)
+        {
+            AUDERR ("Cannot seek within %s: %s.\n", (const char *) m_filename,
+             error->message);
+            g_error_free (error);
+        }
+    }
+
+    m_rb.discard ();
+    m_read_eof = false;
+    m_read_error = false;
+}
+
 VFSImpl * GIOTransport::fopen (const char * filename, const char * mode, String & error)
 {
     try { return new GIOFile (filename, mode); }
@@ -223,6 +368,41 @@ int64_t GIOFile::fread (void * buf, int64_t size, int64_t nitems)
     int64_t total = 0;
     int64_t remain = size * nitems;
 
+    if (m_readahead && ensure_reader ())
+    {
+        pthread_mutex_lock (& m_mutex);
+
+        while (remain > 0)
+        {
+            int part = aud::min ((int64_t) m_rb.len (), remain);
+
+            if (part > 0)
+            {
+                m_rb.move_out ((char *) buf, part);
+                buf = (char *) buf + part;
+                total += part;
+                remain -= part;
+                m_pos += part;
+
+                /* wake the reader; we just made room */
+                pthread_cond_broadcast (& m_cond);
+                continue;
+            }
+
+            if (m_read_eof || m_read_error)
+            {
+                m_eof = m_read_eof;
+                break;
+            }
+
+            pthread_cond_broadcast (& m_cond);
+            pthread_cond_wait (& m_cond, & m_mutex);
+        }
+
+        pthread_mutex_unlock (& m_mutex);
+        return (size > 0) ? total / size : 0;
+    }
+
     while (remain > 0)
     {
         int64_t part = g_input_stream_read (m_istream, buf, remain, 0, & error);
@@ -293,9 +473,38 @@ int GIOFile::fseek (int64_t offset, VFSSeekType whence)
         return -1;
     }
 
+    if (m_readahead)
+    {
+        /* a short forward seek may land within the buffered data */
+        int64_t target = (whence == VFS_SEEK_SET) ? offset :
+         (whence == VFS_SEEK_CUR) ? m_pos + offset : -1;
+
+        if (target >= m_pos)
+        {
+            pthread_mutex_lock (& m_mutex);
+
+            if (target - m_pos <= (int64_t) m_rb.len ())
+            {
+                m_rb.discard ((int) (target - m_pos));
+                m_pos = target;
+                pthread_cond_broadcast (& m_cond);
+                pthread_mutex_unlock (& m_mutex);
+
+                m_eof = false;
+                return 0;
+            }
+
+            pthread_mutex_unlock (& m_mutex);
+        }
+
+        /* with the stream resynced, relative seeks keep their meaning */
+        resync_stream ();
+    }
+
     g_seekable_seek (m_seekable, offset, gwhence, nullptr, & error);
     CHECK_ERROR ("seek within", m_filename);
 
+    m_pos = g_seekable_tell (m_seekable);
     m_eof = (whence == VFS_SEEK_END && offset == 0);
 
     return 0;
@@ -306,6 +515,9 @@ FAILED:
 
 int64_t GIOFile::ftell ()
 {
+    if (m_readahead)
+        return m_pos;
+
     return g_seekable_tell (m_seekable);
 }
 
@@ -334,6 +546,8 @@ int64_t GIOFile::fsize ()
     if (! g_seekable_can_seek (m_seekable))
         return -1;
 
+    resync_stream ();
+
     GError * error = nullptr;
     int64_t saved_pos = g_seekable_tell (m_seekable);
     int64_t size = -1;
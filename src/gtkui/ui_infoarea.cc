@@ -72,9 +72,12 @@ public:
         Visualizer (Freq) {}
 
     GtkWidget * widget = nullptr;
+    bool active = false;
     float bars[VIS_BANDS] {};
     char delay[VIS_BANDS] {};
 
+    void set_active (bool on);
+
     void clear () override;
     void render_freq (const float * freq) override;
 };
@@ -121,6 +124,30 @@ void InfoAreaVis::clear ()
         gtk_widget_queue_draw (widget);
 }
 
+/* register with the core only while the widget is mapped; an unregistered
+ * visualizer costs nothing, since the core computes the spectrum only when
+ * someone is listening */
+void InfoAreaVis::set_active (bool on)
+{
+    if (on == active)
+        return;
+
+    active = on;
+
+    if (on)
+        aud_visualizer_add (this);
+    else
+    {
+        aud_visualizer_remove (this);
+        clear ();
+    }
+}
+
+static void vis_map_cb (GtkWidget *)
+    { vis.set_active (true); }
+static void vis_unmap_cb (GtkWidget *)
+    { vis.set_active (false); }
+
 /****************************************************************************/
 
 static void clear (GtkWidget * widget, cairo_t * cr)
@@ -406,21 +433,19 @@ void ui_infoarea_show_vis (bool show)
         gtk_box_pack_start ((GtkBox *) area->box, vis.widget, false, false, 0);
 
         g_signal_connect (vis.widget, AUDGUI_DRAW_SIGNAL, (GCallback) draw_vis_cb, nullptr);
+        g_signal_connect (vis.widget, "map", (GCallback) vis_map_cb, nullptr);
+        g_signal_connect (vis.widget, "unmap", (GCallback) vis_unmap_cb, nullptr);
         gtk_widget_show (vis.widget);
-
-        aud_visualizer_add (& vis);
     }
     else
     {
         if (! vis.widget)
             return;
 
-        aud_visualizer_remove (& vis);
-
         gtk_widget_destroy (vis.widget);
         vis.widget = nullptr;
 
-        vis.clear ();
+        vis.set_active (false);
     }
 }
 
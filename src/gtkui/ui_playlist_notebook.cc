@@ -510,10 +510,10 @@ void pl_notebook_update (void * data, void * user)
     {
         GtkWidget * treeview = treeview_at_idx (i);
 
-        if (global_level >= Playlist::Metadata)
+        /* the title and entry count shown in the tab label can only have
+         * changed if this playlist has a pending update of its own */
+        if (ui_playlist_widget_update (treeview) >= Playlist::Metadata)
             update_tab_label (get_tab_label (i), list_of (treeview));
-
-        ui_playlist_widget_update (treeview);
     }
 
     switch_to_active ();
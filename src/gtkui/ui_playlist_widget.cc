@@ -477,18 +477,32 @@ GtkWidget * ui_playlist_widget_new (Playlist playlist)
         }
     }
 
+    /* All rows are a single line of text, so tell GtkTreeView they are all the
+     * same height.  Otherwise it measures every row after a playlist is loaded,
+     * which stalls the first scroll of a very large playlist.  Fixed-height
+     * mode requires every column to use fixed sizing; explicit widths are set
+     * in apply_column_widths (), and the righthand column still expands to fill
+     * the window. */
+    for (int i = 0; i < pw_num_cols; i ++)
+    {
+        auto column = gtk_tree_view_get_column ((GtkTreeView *) list, i);
+        gtk_tree_view_column_set_sizing (column, GTK_TREE_VIEW_COLUMN_FIXED);
+    }
+
+    gtk_tree_view_set_fixed_height_mode ((GtkTreeView *) list, true);
+
     return list;
 }
 
-void ui_playlist_widget_update (GtkWidget * widget)
+Playlist::UpdateLevel ui_playlist_widget_update (GtkWidget * widget)
 {
     PlaylistWidgetData * data = (PlaylistWidgetData *) audgui_list_get_user (widget);
-    g_return_if_fail (data);
+    g_return_val_if_fail (data, Playlist::NoUpdate);
 
     auto update = data->list.update_detail ();
 
     if (update.level == Playlist::NoUpdate)
-        return;
+        return Playlist::NoUpdate;
 
     int entries = data->list.n_entries ();
     int changed = entries - update.before - update.after;
@@ -524,6 +538,8 @@ void ui_playlist_widget_update (GtkWidget * widget)
     audgui_list_update_selection (widget, update.before, changed);
     audgui_list_set_highlight (widget, data->list.get_position ());
     audgui_list_set_focus (widget, data->list.get_focus ());
+
+    return update.level;
 }
 
 void ui_playlist_widget_scroll (GtkWidget * widget)
@@ -24,7 +24,7 @@
 #include <libaudcore/playlist.h>
 
 GtkWidget * ui_playlist_widget_new (Playlist playlist);
-void ui_playlist_widget_update (GtkWidget * widget);
+Playlist::UpdateLevel ui_playlist_widget_update (GtkWidget * widget);
 void ui_playlist_widget_scroll (GtkWidget * widget);
 
 enum {
@@ -45,6 +45,92 @@ static unsigned int numlock_mask = 0;
 static unsigned int scrolllock_mask = 0;
 static unsigned int capslock_mask = 0;
 
+static void grab_key(const HotkeyConfiguration * hotkey, Display * xdisplay,
+                     Window x_root_window);
+static void ungrab_key(HotkeyConfiguration * hotkey, Display * xdisplay,
+                       Window x_root_window);
+
+/* bindings indexed by (type, keycode, modifier mask) so that dispatching
+ * an event is a single hash lookup instead of a walk over the full list */
+static GHashTable * binding_index = nullptr;
+
+/* bindings actually grabbed on the server; grab updates only touch the
+ * bindings that changed, and ungrabs always release exactly what was
+ * grabbed even if the configuration has been reloaded in between */
+typedef struct
+{
+    unsigned key;
+    unsigned mask;
+    unsigned type;
+} GrabbedKey;
+
+static GArray * active_grabs = nullptr;
+
+static unsigned binding_hash_key(unsigned type, unsigned key, unsigned mask)
+{
+    return (mask << 9) | ((key & 0xff) << 1) | type;
+}
+
+static void rebuild_binding_index()
+{
+    HotkeyConfiguration * hotkey;
+
+    if (!binding_index)
+        binding_index = g_hash_table_new(g_direct_hash, g_direct_equal);
+    else
+        g_hash_table_remove_all(binding_index);
+
+    for (hotkey = &(get_config()->first); hotkey; hotkey = hotkey->next)
+    {
+        if (!hotkey->key)
+            continue;
+
+        void * hash_key = GUINT_TO_POINTER(
+            binding_hash_key(hotkey->type, hotkey->key, hotkey->mask));
+
+        /* keep first-match semantics for duplicate bindings */
+        if (!g_hash_table_lookup(binding_index, hash_key))
+            g_hash_table_insert(binding_index, hash_key, hotkey);
+    }
+}
+
+static HotkeyConfiguration * lookup_binding(unsigned type, unsigned key,
+                                            unsigned mask)
+{
+    if (!binding_index)
+        return nullptr;
+
+    return (HotkeyConfiguration *)g_hash_table_lookup(
+        binding_index, GUINT_TO_POINTER(binding_hash_key(type, key, mask)));
+}
+
+static int find_active_grab(unsigned key, unsigned mask, unsigned type)
+{
+    if (!active_grabs)
+        return -1;
+
+    for (unsigned i = 0; i < active_grabs->len; i++)
+    {
+        GrabbedKey * entry = &g_array_index(active_grabs, GrabbedKey, i);
+        if (entry->key == key && entry->mask == mask && entry->type == type)
+            return i;
+    }
+
+    return -1;
+}
+
+static void ungrab_active_entry(const GrabbedKey * entry, Display * xdisplay)
+{
+    HotkeyConfiguration dropped;
+    dropped.key = entry->key;
+    dropped.mask = entry->mask;
+    dropped.type = entry->type;
+    dropped.next = nullptr;
+
+    for (int screen = 0; screen < ScreenCount(xdisplay); screen++)
+        ungrab_key(&dropped, xdisplay, RootWindow(xdisplay, screen));
+}
+
 /* Taken from xbindkeys */
 static void get_offending_modifiers(Display * dpy)
 {
@@ -183,33 +269,66 @@ static void grab_key(const HotkeyConfiguration * hotkey, Display * xdisplay,
     }
 }
 
+/* synchronize the server-side grabs with the configured bindings;
+ * only bindings added or removed since the last call are touched, so a
+ * configuration change no longer releases and re-acquires every grab */
 void grab_keys()
 {
     Display * xdisplay;
     int screen;
     PluginConfig * plugin_cfg = get_config();
     HotkeyConfiguration * hotkey;
+    unsigned old_len, i;
+    gboolean * keep;
 
     XErrorHandler old_handler = 0;
     xdisplay = GDK_DISPLAY_XDISPLAY(gdk_display_get_default());
 
-    if (grabbed)
-        return;
+    if (!active_grabs)
+        active_grabs = g_array_new(false, false, sizeof(GrabbedKey));
 
     XSync(xdisplay, False);
     old_handler = XSetErrorHandler(x11_error_handler);
 
     get_offending_modifiers(xdisplay);
+
+    old_len = active_grabs->len;
+    keep = g_new0(gboolean, old_len + 1);
+
     hotkey = &(plugin_cfg->first);
     while (hotkey)
     {
-        for (screen = 0; screen < ScreenCount(xdisplay); screen++)
+        if (hotkey->key)
         {
-            grab_key(hotkey, xdisplay, RootWindow(xdisplay, screen));
+            int idx = find_active_grab(hotkey->key, hotkey->mask, hotkey->type);
+            if (idx >= 0)
+                keep[idx] = true;
+            else
+            {
+                GrabbedKey entry = {hotkey->key, hotkey->mask, hotkey->type};
+                for (screen = 0; screen < ScreenCount(xdisplay); screen++)
+                {
+                    grab_key(hotkey, xdisplay, RootWindow(xdisplay, screen));
+                }
+                g_array_append_val(active_grabs, entry);
+            }
         }
         hotkey = hotkey->next;
     }
 
+    for (i = old_len; i-- > 0;)
+    {
+        if (keep[i])
+            continue;
+
+        GrabbedKey entry = g_array_index(active_grabs, GrabbedKey, i);
+        ungrab_active_entry(&entry, xdisplay);
+        g_array_remove_index(active_grabs, i);
+    }
+    g_free(keep);
+
+    rebuild_binding_index();
+
     XSync(xdisplay, False);
     XSetErrorHandler(old_handler);
 
@@ -310,9 +429,7 @@ static void ungrab_key(HotkeyConfiguration * hotkey, Display * xdisplay,
 void ungrab_keys()
 {
     Display * xdisplay;
-    int screen;
-    PluginConfig * plugin_cfg = get_config();
-    HotkeyConfiguration * hotkey;
+    unsigned i;
 
     XErrorHandler old_handler = 0;
     xdisplay = GDK_DISPLAY_XDISPLAY(gdk_display_get_default());
@@ -327,16 +444,19 @@ void ungrab_keys()
 
     get_offending_modifiers(xdisplay);
 
-    hotkey = &(plugin_cfg->first);
-    while (hotkey)
+    if (active_grabs)
     {
-        for (screen = 0; screen < ScreenCount(xdisplay); screen++)
+        for (i = 0; i < active_grabs->len; i++)
         {
-            ungrab_key(hotkey, xdisplay, RootWindow(xdisplay, screen));
+            GrabbedKey entry = g_array_index(active_grabs, GrabbedKey, i);
+            ungrab_active_entry(&entry, xdisplay);
         }
-        hotkey = hotkey->next;
+        g_array_set_size(active_grabs, 0);
     }
 
+    if (binding_index)
+        g_hash_table_remove_all(binding_index);
+
     XSync(xdisplay, False);
     XSetErrorHandler(old_handler);
 
@@ -347,48 +467,28 @@ static GdkFilterReturn gdk_filter(GdkXEvent * xevent, GdkEvent * event,
                                   void * data)
 {
     HotkeyConfiguration * hotkey;
-    hotkey = &(get_config()->first);
     switch (((XEvent *)xevent)->type)
     {
     case KeyPress:
     {
         XKeyEvent * keyevent = (XKeyEvent *)xevent;
-        while (hotkey)
-        {
-            if ((hotkey->key == keyevent->keycode) &&
-                (hotkey->mask ==
-                 (keyevent->state &
-                  ~(scrolllock_mask | numlock_mask | capslock_mask))) &&
-                (hotkey->type == TYPE_KEY))
-            {
-                if (handle_keyevent(hotkey->event))
-                    return GDK_FILTER_REMOVE;
-                break;
-            }
-
-            hotkey = hotkey->next;
-        }
+        hotkey = lookup_binding(
+            TYPE_KEY, keyevent->keycode,
+            keyevent->state &
+                ~(scrolllock_mask | numlock_mask | capslock_mask));
+        if (hotkey && handle_keyevent(hotkey->event))
+            return GDK_FILTER_REMOVE;
         break;
     }
     case ButtonPress:
     {
         XButtonEvent * buttonevent = (XButtonEvent *)xevent;
-        while (hotkey)
-        {
-            if ((hotkey->key == buttonevent->button) &&
-                (hotkey->mask ==
-                 (buttonevent->state &
-                  ~(scrolllock_mask | numlock_mask | capslock_mask))) &&
-                (hotkey->type == TYPE_MOUSE))
-            {
-                if (handle_keyevent(hotkey->event))
-                    return GDK_FILTER_REMOVE;
-                break;
-            }
-
-            hotkey = hotkey->next;
-        }
-
+        hotkey = lookup_binding(
+            TYPE_MOUSE, buttonevent->button,
+            buttonevent->state &
+                ~(scrolllock_mask | numlock_mask | capslock_mask));
+        if (hotkey && handle_keyevent(hotkey->event))
+            return GDK_FILTER_REMOVE;
         break;
     }
     }
@@ -24,9 +24,10 @@
 #include <libaudcore/interface.h>
 #include <libaudcore/plugin.h>
 #include <libaudcore/preferences.h>
-#include <libaudcore/ringbuf.h>
 #include <libaudcore/runtime.h>
 
+#include "../output-common/spsc_ringbuf.h"
+
 #include <algorithm>
 #include <iterator>
 
@@ -57,7 +58,7 @@ public:
         & prefs
     };
 
-    constexpr JACKOutput (RingBuf<float> & buffer) :
+    constexpr JACKOutput (SPSCRingBuf<float> & buffer) :
         OutputPlugin (info, 0),
         m_buffer (buffer) {}
 
@@ -94,7 +95,7 @@ private:
     timeval m_last_write_time = timeval ();
     bool m_rate_mismatch = false;
 
-    RingBuf<float> & m_buffer;
+    SPSCRingBuf<float> & m_buffer;
 
     jack_client_t * m_client = nullptr;
     jack_port_t * m_ports[AUD_MAX_CHANNELS] = {};
@@ -104,7 +105,7 @@ private:
 };
 
 // must be separate in order for JACKOutput() to be constexpr
-static RingBuf<float> s_buffer;
+static SPSCRingBuf<float> s_buffer;
 
 EXPORT JACKOutput aud_plugin_instance (s_buffer);
 
@@ -223,7 +224,7 @@ fail:
 
 bool JACKOutput::open_audio (int format, int rate, int channels, String & error)
 {
-    int buffer_time;
+    int buffer_time, period, buffer_frames;
 
     if (format != FMT_FLOAT)
     {
@@ -257,8 +258,13 @@ bool JACKOutput::open_audio (int format, int rate, int channels, String & error)
         }
     }
 
+    /* size the soft buffer in whole JACK periods, at least two of them, so
+     * each process cycle consumes an integral number of buffered periods */
     buffer_time = aud_get_int ("output_buffer_size");
-    m_buffer.alloc (aud::rescale (buffer_time, 1000, rate) * channels);
+    period = jack_get_buffer_size (m_client);
+    buffer_frames = aud::max (aud::rescale (buffer_time, 1000, rate), 2 * period);
+    buffer_frames = (buffer_frames + period - 1) / period * period;
+    m_buffer.alloc (buffer_frames * channels);
 
     m_rate = rate;
     m_channels = channels;
@@ -303,10 +309,9 @@ void JACKOutput::close_audio ()
 
 void JACKOutput::generate (jack_nframes_t frames)
 {
-    pthread_mutex_lock (& m_mutex);
-
-    m_last_write_frames = 0;
-    gettimeofday (& m_last_write_time, nullptr);
+    /* The ring buffer is lock-free; the JACK realtime thread must never
+     * block on m_mutex while the playback thread holds it. */
+    int written_frames = 0;
 
     float * out[AUD_MAX_CHANNELS];
     for (int i = 0; i < m_channels; i ++)
@@ -333,32 +338,67 @@ void JACKOutput::generate (jack_nframes_t frames)
     if (m_paused || m_prebuffer)
         goto silence;
 
-    while (frames && m_buffer.len ())
     {
-        int linear_samples = m_buffer.linear ();
-        assert (linear_samples % m_channels == 0);
+        StereoVolume volume = get_volume ();
+        bool unity = (volume.left == 100 && volume.right == 100);
+
+        while (frames && m_buffer.len ())
+        {
+            int frames_to_copy = aud::min ((int) frames, m_buffer.linear () / m_channels);
+
+            if (! frames_to_copy)
+            {
+                /* the contiguous run ends mid-frame; stitch the wrapped frame
+                 * back together off the ring */
+                float stitch[AUD_MAX_CHANNELS];
+                if (m_buffer.move_out (stitch, m_channels) < m_channels)
+                    break;
+
+                if (! unity)
+                    audio_amplify (stitch, m_channels, 1, volume);
+
+                audio_deinterlace (stitch, FMT_FLOAT, m_channels,
+                 (void * const *) out, 1);
+                frames_to_copy = 1;
+            }
+            else
+            {
+                float * from = m_buffer.tail_data ();
 
-        int frames_to_copy = aud::min (frames, (jack_nframes_t) linear_samples / m_channels);
+                /* at unity volume, deinterlace straight from the ring into
+                 * the port buffers with no intermediate scaling pass */
+                if (! unity)
+                    audio_amplify (from, m_channels, frames_to_copy, volume);
 
-        audio_amplify (& m_buffer[0], m_channels, frames_to_copy, get_volume ());
-        audio_deinterlace (& m_buffer[0], FMT_FLOAT, m_channels,
-         (void * const *) out, frames_to_copy);
+                audio_deinterlace (from, FMT_FLOAT, m_channels,
+                 (void * const *) out, frames_to_copy);
 
-        m_last_write_frames += frames_to_copy;
-        m_buffer.discard (frames_to_copy * m_channels);
+                m_buffer.consume (frames_to_copy * m_channels);
+            }
 
-        for (int i = 0; i < m_channels; i ++)
-            out[i] += frames_to_copy;
+            written_frames += frames_to_copy;
 
-        frames -= frames_to_copy;
+            for (int i = 0; i < m_channels; i ++)
+                out[i] += frames_to_copy;
+
+            frames -= frames_to_copy;
+        }
     }
 
 silence:
     for (int i = 0; i < m_channels; i ++)
         std::fill (out[i], out[i] + frames, 0.0);
 
+    /* update the delay estimate; skip rather than block if the playback
+     * thread holds the mutex */
+    if (! pthread_mutex_trylock (& m_mutex))
+    {
+        m_last_write_frames = written_frames;
+        gettimeofday (& m_last_write_time, nullptr);
+        pthread_mutex_unlock (& m_mutex);
+    }
+
     pthread_cond_broadcast (& m_cond);
-    pthread_mutex_unlock (& m_mutex);
 }
 
 void JACKOutput::period_wait ()
@@ -376,19 +416,17 @@ void JACKOutput::period_wait ()
 
 int JACKOutput::write_audio (const void * data, int size)
 {
-    pthread_mutex_lock (& m_mutex);
-
     int samples = size / sizeof (float);
     assert (samples % m_channels == 0);
 
-    samples = aud::min (samples, m_buffer.space ());
+    /* never leave a partial frame in the ring */
+    samples = aud::min (samples, m_buffer.space () / m_channels * m_channels);
 
-    m_buffer.copy_in ((const float *) data, samples);
+    samples = m_buffer.copy_in ((const float *) data, samples);
 
     if (m_buffer.len () >= m_buffer.size () / 4)
         m_prebuffer = false;
 
-    pthread_mutex_unlock (& m_mutex);
     return samples * sizeof (float);
 }
 
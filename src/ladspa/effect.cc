@@ -18,6 +18,7 @@
  */
 
 #include <assert.h>
+#include <unistd.h>
 
 #include "ladspa.h"
 #include "plugin.h"
@@ -26,6 +27,94 @@
 
 static int ladspa_channels, ladspa_rate;
 
+/* Worker pool for running the independent per-channel-group instances of a
+ * multichannel plugin in parallel.  The playback thread publishes a batch of
+ * instance indices, takes part in the work itself, and waits on a barrier
+ * until all instances have finished the block. */
+
+static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t pool_work_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t pool_done_cond = PTHREAD_COND_INITIALIZER;
+
+static Index<pthread_t> pool_threads;
+static bool pool_quit;
+
+static LoadedPlugin * pool_loaded;
+static float * pool_data;
+static int pool_frames, pool_instances;
+static int pool_next, pool_pending;
+
+static void run_instance (LoadedPlugin & loaded, float * data, int frames, int i);
+
+static void * pool_worker (void *)
+{
+    pthread_mutex_lock (& pool_mutex);
+
+    while (! pool_quit)
+    {
+        if (! pool_loaded || pool_next >= pool_instances)
+        {
+            pthread_cond_wait (& pool_work_cond, & pool_mutex);
+            continue;
+        }
+
+        LoadedPlugin * loaded = pool_loaded;
+        float * data = pool_data;
+        int frames = pool_frames;
+        int i = pool_next ++;
+
+        pthread_mutex_unlock (& pool_mutex);
+        run_instance (* loaded, data, frames, i);
+        pthread_mutex_lock (& pool_mutex);
+
+        if (! -- pool_pending)
+            pthread_cond_signal (& pool_done_cond);
+    }
+
+    pthread_mutex_unlock (& pool_mutex);
+    return nullptr;
+}
+
+/* starts the pool on first use; returns false on single-core machines, where
+ * the serial path is used instead */
+static bool pool_available ()
+{
+    if (pool_threads.len ())
+        return true;
+
+    int workers = aud::min ((int) sysconf (_SC_NPROCESSORS_ONLN) - 1, 3);
+    if (workers < 1)
+        return false;
+
+    for (int i = 0; i < workers; i ++)
+    {
+        pthread_t thread;
+        if (pthread_create (& thread, nullptr, pool_worker, nullptr))
+            break;
+
+        pool_threads.append (thread);
+    }
+
+    return (pool_threads.len () > 0);
+}
+
+void shutdown_worker_pool ()
+{
+    if (! pool_threads.len ())
+        return;
+
+    pthread_mutex_lock (& pool_mutex);
+    pool_quit = true;
+    pthread_cond_broadcast (& pool_work_cond);
+    pthread_mutex_unlock (& pool_mutex);
+
+    for (pthread_t thread : pool_threads)
+        pthread_join (thread, nullptr);
+
+    pool_threads.clear ();
+    pool_quit = false;
+}
+
 static void start_plugin (LoadedPlugin & loaded)
 {
     if (loaded.active)
@@ -83,55 +172,105 @@ static void start_plugin (LoadedPlugin & loaded)
     }
 }
 
+/* deinterleaves, runs and reinterleaves one instance's channel group; each
+ * instance touches disjoint channels, so instances can run concurrently */
+static void run_instance (LoadedPlugin & loaded, float * data, int frames, int i)
+{
+    PluginData & plugin = loaded.plugin;
+    const LADSPA_Descriptor & desc = plugin.desc;
+
+    int ports = plugin.in_ports.len ();
+    LADSPA_Handle handle = loaded.instances[i];
+
+    for (int p = 0; p < ports; p ++)
+    {
+        int channel = ports * i + p;
+        float * get = data + channel;
+        float * in = loaded.in_bufs[channel].begin ();
+        float * in_end = in + frames;
+
+        while (in < in_end)
+        {
+            * in ++ = * get;
+            get += ladspa_channels;
+        }
+    }
+
+    desc.run (handle, frames);
+
+    for (int p = 0; p < ports; p ++)
+    {
+        int channel = ports * i + p;
+        float * set = data + channel;
+        float * out = loaded.out_bufs[channel].begin ();
+        float * out_end = out + frames;
+
+        while (out < out_end)
+        {
+            * set = * out ++;
+            set += ladspa_channels;
+        }
+    }
+}
+
+static void run_instances_parallel (LoadedPlugin & loaded, float * data,
+ int frames, int instances)
+{
+    pthread_mutex_lock (& pool_mutex);
+
+    pool_loaded = & loaded;
+    pool_data = data;
+    pool_frames = frames;
+    pool_instances = instances;
+    pool_next = 0;
+    pool_pending = instances;
+
+    pthread_cond_broadcast (& pool_work_cond);
+
+    /* the playback thread works on the batch too */
+    while (pool_next < pool_instances)
+    {
+        int i = pool_next ++;
+
+        pthread_mutex_unlock (& pool_mutex);
+        run_instance (loaded, data, frames, i);
+        pthread_mutex_lock (& pool_mutex);
+
+        if (! -- pool_pending)
+            pthread_cond_signal (& pool_done_cond);
+    }
+
+    /* barrier: wait for the workers to finish their instances */
+    while (pool_pending)
+        pthread_cond_wait (& pool_done_cond, & pool_mutex);
+
+    pool_loaded = nullptr;
+    pthread_mutex_unlock (& pool_mutex);
+}
+
 static void run_plugin (LoadedPlugin & loaded, float * data, int samples)
 {
     if (! loaded.instances.len ())
         return;
 
     PluginData & plugin = loaded.plugin;
-    const LADSPA_Descriptor & desc = plugin.desc;
 
     int ports = plugin.in_ports.len ();
     int instances = loaded.instances.len ();
     assert (ports * instances == ladspa_channels);
 
+    bool parallel = (instances > 1 && pool_available ());
+
     while (samples / ladspa_channels > 0)
     {
         int frames = aud::min (samples / ladspa_channels, LADSPA_BUFLEN);
 
-        for (int i = 0; i < instances; i ++)
+        if (parallel)
+            run_instances_parallel (loaded, data, frames, instances);
+        else
         {
-            LADSPA_Handle handle = loaded.instances[i];
-
-            for (int p = 0; p < ports; p ++)
-            {
-                int channel = ports * i + p;
-                float * get = data + channel;
-                float * in = loaded.in_bufs[channel].begin ();
-                float * in_end = in + frames;
-
-                while (in < in_end)
-                {
-                    * in ++ = * get;
-                    get += ladspa_channels;
-                }
-            }
-
-            desc.run (handle, frames);
-
-            for (int p = 0; p < ports; p ++)
-            {
-                int channel = ports * i + p;
-                float * set = data + channel;
-                float * out = loaded.out_bufs[channel].begin ();
-                float * out_end = out + frames;
-
-                while (out < out_end)
-                {
-                    * set = * out ++;
-                    set += ladspa_channels;
-                }
-            }
+            for (int i = 0; i < instances; i ++)
+                run_instance (loaded, data, frames, i);
         }
 
         data += ladspa_channels * frames;
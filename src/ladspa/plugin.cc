@@ -322,6 +322,7 @@ void LADSPAHost::cleanup ()
     aud_set_str ("ladspa", "module_path", module_path);
     save_enabled_to_config ();
     close_modules ();
+    shutdown_worker_pool ();
 
     modules.clear ();
     plugins.clear ();
@@ -113,6 +113,7 @@ void disable_plugin_locked (LoadedPlugin & loaded);
 /* effect.c */
 
 void shutdown_plugin_locked (LoadedPlugin & loaded);
+void shutdown_worker_pool ();
 
 /* plugin-list.c */
 
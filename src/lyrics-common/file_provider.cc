@@ -46,14 +46,27 @@ void FileProvider::cache (LyricsState state)
 #define DIRMODE (S_IRWXU)
 #endif
 
+// Normalizes an artist or title for use as a cache key, so that case
+// and surrounding-whitespace variants of the same tag share one cache
+// entry instead of each triggering a fresh network lookup.
+static CharPtr normalize_cache_key (const char * field)
+{
+    CharPtr stripped (g_strdup (field));
+    g_strstrip (stripped);
+    return CharPtr (g_utf8_casefold (stripped, -1));
+}
+
 String FileProvider::cache_uri_for_entry (LyricsState state)
 {
-    if (! state.artist)
+    if (! state.artist || ! state.title)
         return String ();
 
+    CharPtr artist = normalize_cache_key (state.artist);
+    CharPtr title = normalize_cache_key (state.title);
+
     auto user_dir = aud_get_path (AudPath::UserDir);
     StringBuf base_path = filename_build ({user_dir, "lyrics"});
-    StringBuf artist_path = filename_build ({base_path, state.artist});
+    StringBuf artist_path = filename_build ({base_path, artist});
 
     if (aud_get_bool (CFG_SECTION, "enable-cache"))
     {
@@ -61,7 +74,7 @@ String FileProvider::cache_uri_for_entry (LyricsState state)
             AUDERR ("Failed to create '%s': %s\n", (const char *) artist_path, strerror (errno));
     }
 
-    StringBuf title_path = str_concat ({filename_build({artist_path, state.title}), ".lrc"});
+    StringBuf title_path = str_concat ({filename_build({artist_path, title}), ".lrc"});
 
     return String (filename_to_uri (title_path));
 }
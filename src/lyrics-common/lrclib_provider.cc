@@ -19,6 +19,7 @@
  */
 
 #include "lyrics.h"
+#include "../fetch-common/fetch.h"
 
 bool LrcLibProvider::match (LyricsState state)
 {
@@ -29,16 +30,19 @@ bool LrcLibProvider::match (LyricsState state)
 void LrcLibProvider::fetch (LyricsState state)
 {
     auto handle_result_cb = [=] (const char * uri, const Index<char> & buf) {
+        if (! remote_fetch_still_wanted (state))
+            return;
+
         if (! buf.len ())
         {
-            update_lyrics_window_error (str_printf (_("Unable to fetch %s"), uri));
+            remote_fetch_failed (state, str_printf (_("Unable to fetch %s"), uri));
             return;
         }
 
         String lyrics;
         if (! try_parse_json (buf, "plainLyrics", lyrics))
         {
-            update_lyrics_window_error (str_printf (_("Unable to parse %s"), uri));
+            remote_fetch_failed (state, str_printf (_("Unable to parse %s"), uri));
             return;
         }
 
@@ -47,14 +51,12 @@ void LrcLibProvider::fetch (LyricsState state)
 
         if (! lyrics)
         {
-            update_lyrics_window_notfound (new_state);
+            remote_fetch_failed (new_state, nullptr);
             return;
         }
 
         new_state.source = LyricsState::Source::LrcLib;
-
-        update_lyrics_window (new_state.title, new_state.artist, new_state.lyrics);
-        persist_state (new_state);
+        remote_fetch_succeeded (new_state);
     };
 
     auto artist = str_copy (state.artist);
@@ -66,6 +68,6 @@ void LrcLibProvider::fetch (LyricsState state)
     auto fetch_uri = str_concat(
         {m_base_url, "/api/get?artist_name=", artist, "&track_name=", title});
 
-    vfs_async_file_get_contents (fetch_uri, handle_result_cb);
+    fetch_async (fetch_uri, handle_result_cb);
     update_lyrics_window_message (state, _("Looking for lyrics ..."));
 }
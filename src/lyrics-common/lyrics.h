@@ -115,6 +115,19 @@ extern LrcLibProvider lrclib_provider;
 extern LyricsOVHProvider lyrics_ovh_provider;
 LyricProvider * remote_source ();
 
+// Dispatches a lookup to the configured remote source(s); when "all" is
+// selected, every remote provider is queried concurrently and the first
+// hit wins.  Returns false if remote fetching is disabled.
+bool remote_fetch_dispatch (LyricsState state);
+
+// Remote providers report their results through these functions so that
+// racing lookups can be coordinated.  Late answers (after another
+// provider already delivered, or for a song that is no longer current)
+// must be dropped via remote_fetch_still_wanted().
+bool remote_fetch_still_wanted (LyricsState state);
+void remote_fetch_succeeded (LyricsState state);
+void remote_fetch_failed (LyricsState state, const char * message);
+
 extern LyricsState g_state;
 void persist_state (LyricsState state);
 
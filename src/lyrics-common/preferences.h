@@ -42,7 +42,8 @@ static const char * const defaults[] = {
 static const ComboItem remote_sources[] = {
     ComboItem (N_("Nowhere"), "nowhere"),
     ComboItem ("lrclib.net", "lrclib.net"),
-    ComboItem ("lyrics.ovh", "lyrics.ovh")
+    ComboItem ("lyrics.ovh", "lyrics.ovh"),
+    ComboItem (N_("All sources (first hit wins)"), "all")
 };
 
 static const PreferencesWidget truncate_elements[] = {
@@ -34,9 +34,75 @@ LyricProvider * remote_source ()
     if (! strcmp (source, "lyrics.ovh"))
         return & lyrics_ovh_provider;
 
+    // representative provider when racing all sources
+    if (! strcmp (source, "all"))
+        return & lrclib_provider;
+
     return nullptr;
 }
 
+// Bookkeeping for racing several remote providers.  The first hit wins;
+// in-flight VFS requests cannot be cancelled with the current API, so
+// answers arriving after a hit, or for a song that is no longer current,
+// are dropped instead.  A miss is only reported once every racing
+// provider has come up empty, so a slow source cannot hide a hit from a
+// fast one.
+static int pending_remotes = 0;
+static bool remote_hit = false;
+
+bool remote_fetch_dispatch (LyricsState state)
+{
+    LyricProvider * remote_provider = remote_source ();
+    if (! remote_provider)
+        return false;
+
+    remote_hit = false;
+
+    if (! strcmp (aud_get_str (CFG_SECTION, "remote-source"), "all"))
+    {
+        pending_remotes = 2;
+        lrclib_provider.fetch (state);
+        lyrics_ovh_provider.fetch (state);
+    }
+    else
+    {
+        pending_remotes = 1;
+        remote_provider->match (state);
+    }
+
+    return true;
+}
+
+bool remote_fetch_still_wanted (LyricsState state)
+{
+    return ! remote_hit && ! strcmp_safe (state.filename, g_state.filename);
+}
+
+void remote_fetch_succeeded (LyricsState state)
+{
+    remote_hit = true;
+    pending_remotes = 0;
+
+    update_lyrics_window (state.title, state.artist, state.lyrics);
+    persist_state (state);
+}
+
+void remote_fetch_failed (LyricsState state, const char * message)
+{
+    if (pending_remotes > 1)
+    {
+        pending_remotes --;
+        return;
+    }
+
+    pending_remotes = 0;
+
+    if (message)
+        update_lyrics_window_error (message);
+    else
+        update_lyrics_window_notfound (state);
+}
+
 void persist_state (LyricsState state)
 {
     g_state = state;
@@ -111,7 +177,8 @@ static void split_title_and_truncate ()
 
 void lyrics_playback_began ()
 {
-    // FIXME: Cancel previous VFS requests (not possible with current API)
+    // Previous VFS requests cannot be cancelled with the current API;
+    // their late answers are dropped in remote_fetch_still_wanted()
 
     g_state.filename = aud_drct_get_filename ();
 
@@ -145,12 +212,8 @@ void lyrics_playback_began ()
             return;
         }
 
-        LyricProvider * remote_provider = remote_source ();
-        if (remote_provider)
-        {
-            remote_provider->match (g_state);
+        if (remote_fetch_dispatch (g_state))
             return;
-        }
     }
 
     if (! g_state.lyrics)
@@ -26,6 +26,7 @@
 #include <libaudcore/plugins.h>
 #include <libaudgui/gtk-compat.h>
 
+#include "../fetch-common/fetch.h"
 #include "../lyrics-common/lyrics.h"
 #include "../lyrics-common/preferences.h"
 
@@ -59,6 +60,7 @@ public:
     constexpr LyricsGtk () : GeneralPlugin (info, false) {}
 
     bool init () override;
+    void cleanup () override;
     void * get_gtk_widget () override;
 };
 
@@ -81,6 +83,11 @@ bool LyricsGtk::init ()
     return true;
 }
 
+void LyricsGtk::cleanup ()
+{
+    fetch_cleanup ();
+}
+
 void update_lyrics_window (const char * title, const char * artist, const char * lyrics)
 {
     GtkTextIter iter;
@@ -270,9 +277,7 @@ static void save_locally_cb (GtkMenuItem * menu_item, void * data)
 
 static void refresh_cb (GtkMenuItem * menu_item, void * data)
 {
-    LyricProvider * remote_provider = remote_source ();
-    if (remote_provider)
-        remote_provider->match (g_state);
+    remote_fetch_dispatch (g_state);
 }
 
 static void populate_popup_cb (GtkTextView * text_view, GtkWidget * menu, void * data)
@@ -37,6 +37,7 @@
 #include <string>
 #include <vector>
 
+#include "../fetch-common/fetch.h"
 #include "../lyrics-common/lyrics.h"
 #include "../lyrics-common/preferences.h"
 
@@ -72,6 +73,7 @@ public:
     constexpr LyricsQt () : GeneralPlugin (info, false) {}
 
     bool init () override;
+    void cleanup () override;
     void * get_qt_widget () override;
 };
 
@@ -93,6 +95,11 @@ bool LyricsQt::init ()
     return true;
 }
 
+void LyricsQt::cleanup ()
+{
+    fetch_cleanup ();
+}
+
 static void highlight_lyrics (int current_time_ms)
 {
     if (!textedit)
@@ -356,9 +363,8 @@ void TextEdit::contextMenuEvent (QContextMenuEvent * event)
     if (g_state.source == LyricsState::Source::Local || g_state.error)
     {
         QAction * refresh = menu->addAction (_("Refresh"));
-        QObject::connect (refresh, & QAction::triggered, [remote_provider] () {
-            if (remote_provider)
-                remote_provider->match (g_state);
+        QObject::connect (refresh, & QAction::triggered, [] () {
+            remote_fetch_dispatch (g_state);
         });
     }
 
@@ -24,6 +24,7 @@
 #include <libaudcore/i18n.h>
 #include <libaudcore/plugin.h>
 #include <libaudcore/runtime.h>
+#include <libaudcore/tuple.h>
 
 static const char * const m3u_exts[] = {"m3u", "m3u8"};
 
@@ -42,6 +43,32 @@ public:
 
 EXPORT M3ULoader aud_plugin_instance;
 
+/* #EXTINF:<seconds>,<display title> -- the one piece of metadata the
+ * extended m3u format carries.  Keeping it across save and load means a
+ * reopened playlist already has titles and lengths instead of going back
+ * to the input plugins for every entry. */
+static void parse_extinf (const char * extinf, Tuple & tuple)
+{
+    bool parsed = false;
+
+    int seconds = atoi (extinf);
+    if (seconds > 0)
+    {
+        tuple.set_int (Tuple::Length, seconds * 1000);
+        parsed = true;
+    }
+
+    const char * comma = strchr (extinf, ',');
+    if (comma && comma[1])
+    {
+        tuple.set_str (Tuple::Title, str_to_utf8 (comma + 1, -1));
+        parsed = true;
+    }
+
+    if (parsed)
+        tuple.set_state (Tuple::Valid);
+}
+
 static char * split_line (char * line)
 {
     char * feed = strchr (line, '\n');
@@ -67,6 +94,7 @@ bool M3ULoader::load (const char * filename, VFSFile & file, String & title,
 
     bool firstline = true;
     bool extm3u = false;
+    Tuple tuple;
 
     char * parse = text.begin ();
     if (! strncmp (parse, "\xef\xbb\xbf", 3)) /* byte order mark */
@@ -85,12 +113,16 @@ bool M3ULoader::load (const char * filename, VFSFile & file, String & title,
                 extm3u = true;
             else if (extm3u && ! strncmp (parse, "#EXT-X-", 7))
                 goto HLS;
+            else if (extm3u && ! strncmp (parse, "#EXTINF:", 8))
+                parse_extinf (parse + 8, tuple);
         }
         else if (* parse)
         {
             StringBuf s = uri_construct (parse, filename);
             if (s)
-                items.append (String (s));
+                items.append (String (s), std::move (tuple));
+
+            tuple = Tuple ();
         }
 
         firstline = false;
@@ -112,13 +144,42 @@ HLS:
 bool M3ULoader::save (const char * filename, VFSFile & file, const char * title,
  const Index<PlaylistAddItem> & items)
 {
+    /* batch the lines into large writes; one fwrite per entry is slow on
+     * remote files and large playlists */
+    Index<char> buf;
+
+    buf.insert ("#EXTM3U\n", -1, 8);
+
     for (auto & item : items)
     {
+        if (item.tuple.state () == Tuple::Valid)
+        {
+            int length = item.tuple.get_int (Tuple::Length);
+            String entry_title = item.tuple.get_str (Tuple::FormattedTitle);
+
+            StringBuf extinf = str_printf ("#EXTINF:%d,%s\n",
+             (length > 0) ? length / 1000 : -1,
+             entry_title ? (const char *) entry_title : "");
+
+            buf.insert (extinf, -1, extinf.len ());
+        }
+
         StringBuf path = uri_deconstruct (item.filename, filename);
-        StringBuf line = str_concat ({path, "\n"});
-        if (file.fwrite (line, 1, line.len ()) != line.len ())
-            return false;
+        path.insert (-1, "\n");
+
+        buf.insert (path, -1, path.len ());
+
+        if (buf.len () >= 65536)
+        {
+            if (file.fwrite (buf.begin (), 1, buf.len ()) != buf.len ())
+                return false;
+
+            buf.resize (0);
+        }
     }
 
+    if (buf.len () && file.fwrite (buf.begin (), 1, buf.len ()) != buf.len ())
+        return false;
+
     return true;
 }
@@ -11,6 +11,7 @@
 #import <Cocoa/Cocoa.h>
 #import <Foundation/Foundation.h>
 #import <MediaPlayer/MediaPlayer.h>
+#include <atomic>
 #include <fstream>
 #include <iostream>
 #include <istream>
@@ -37,6 +38,70 @@ EXPORT MacNowPlayingPlugin aud_plugin_instance;
 
 static void update_metadata(void * data, void * user);
 
+// Artwork pipeline: decoding and MPMediaItemArtwork construction run on
+// a background queue so a skip storm never beachballs the main thread.
+// Each update bumps a generation counter and stale decodes are dropped,
+// so only the newest pending update is ever applied; converted artwork
+// is cached by source file, so skipping back and forth reuses it.
+static dispatch_queue_t artQueue;
+static std::atomic<unsigned> artGeneration;
+static NSCache<NSString *, MPMediaItemArtwork *> * artCache;
+
+static void apply_artwork(MPMediaItemArtwork * artwork)
+{
+    MPNowPlayingInfoCenter * center = [MPNowPlayingInfoCenter defaultCenter];
+    NSMutableDictionary<NSString *, id> * minfo =
+        [[center nowPlayingInfo] mutableCopy];
+    minfo[MPMediaItemPropertyArtwork] = artwork;
+    center.nowPlayingInfo = minfo;
+}
+
+static void request_artwork(const char * file)
+{
+    NSString * key = [[NSString alloc] initWithUTF8String:file];
+    MPMediaItemArtwork * cached = [artCache objectForKey:key];
+    if (cached)
+    {
+        apply_artwork(cached);
+        return;
+    }
+
+    AudArtPtr artwork = aud_art_request(file, AUD_ART_DATA);
+    const Index<char> * artworkBytes = artwork.data();
+    if (!artworkBytes)
+    {
+        return;
+    }
+
+    NSData * nsBytes = [[NSData alloc] initWithBytes:artworkBytes->begin()
+                                              length:artworkBytes->len()];
+    unsigned generation = ++artGeneration;
+    dispatch_async(artQueue, ^{
+      if (generation != artGeneration.load())
+      {
+          // a newer update is already queued behind this one
+          return;
+      }
+      NSImage * image = [[NSImage alloc] initWithData:nsBytes];
+      if (!image)
+      {
+          return;
+      }
+      MPMediaItemArtwork * mpArtwork = [[MPMediaItemArtwork alloc]
+          initWithBoundsSize:[image size]
+              requestHandler:^NSImage * _Nonnull(CGSize size) {
+                return image;
+              }];
+      dispatch_async(dispatch_get_main_queue(), ^{
+        [artCache setObject:mpArtwork forKey:key];
+        if (generation == artGeneration.load())
+        {
+            apply_artwork(mpArtwork);
+        }
+      });
+    });
+}
+
 static void update_player_time()
 {
     if (!aud_drct_get_ready())
@@ -195,25 +260,12 @@ static void update_metadata(void * data, void * user)
     nowPlayingInfo[MPNowPlayingInfoPropertyElapsedPlaybackTime] =
         [[NSNumber alloc] initWithInt:current_time];
 
+    [center setNowPlayingInfo:nowPlayingInfo];
+
     if (file)
     {
-        AudArtPtr artwork = aud_art_request(file, AUD_ART_DATA);
-        const Index<char> * artworkBytes = artwork.data();
-        if (artworkBytes)
-        {
-            NSData * nsBytes =
-                [[NSData alloc] initWithBytes:artworkBytes->begin()
-                                       length:artworkBytes->len()];
-            NSImage * image = [[NSImage alloc] initWithData:nsBytes];
-            MPMediaItemArtwork * mpArtwork = [[MPMediaItemArtwork alloc]
-                initWithBoundsSize:[image size]
-                    requestHandler:^NSImage * _Nonnull(CGSize size) {
-                      return image;
-                    }];
-            nowPlayingInfo[MPMediaItemPropertyArtwork] = mpArtwork;
-        }
+        request_artwork(file);
     }
-    [center setNowPlayingInfo:nowPlayingInfo];
 }
 
 static void update_playback_status(void * data, void * user)
@@ -231,6 +283,14 @@ const char MacNowPlayingPlugin::about[] =
 
 bool MacNowPlayingPlugin::init()
 {
+    if (!artQueue)
+    {
+        artQueue = dispatch_queue_create("org.audacious.mac-now-playing.art",
+                                         DISPATCH_QUEUE_SERIAL);
+    }
+    artCache = [[NSCache alloc] init];
+    [artCache setCountLimit:16];
+
     remote_command_setup_handler();
     remote_command_start();
     remote_command_disable_commands();
@@ -259,4 +319,10 @@ void MacNowPlayingPlugin::cleanup()
     hook_dissociate("tuple change", update_metadata);
     hook_dissociate("playback ready", update_position);
     hook_dissociate("playback seek", update_position);
+
+    // invalidate pending updates and wait out any decode in flight
+    artGeneration++;
+    dispatch_sync(artQueue, ^{
+                  });
+    artCache = nil;
 }
@@ -25,6 +25,7 @@
          we care about. */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include <libaudcore/i18n.h>
 #include <libaudcore/runtime.h>
@@ -61,6 +62,7 @@ EXPORT ChannelMixer aud_plugin_instance;
 typedef Index<float> & (* Converter) (Index<float> & data);
 
 static Index<float> mixer_buf;
+static int input_channels, output_channels;
 
 static Index<float> & mono_to_stereo (Index<float> & data)
 {
@@ -186,6 +188,62 @@ static Index<float> & quadro_5_to_stereo (Index<float> & data)
     return mixer_buf;
 }
 
+/* Generic fixed-matrix fallback for layouts without a hand-written
+ * kernel above.  The matrix is built once at start(): channels map
+ * straight across while both sides have them, extra input channels fold
+ * into the outputs round-robin at half gain (the same gain the explicit
+ * downmixes use for the folded channels), and extra output channels
+ * repeat the inputs the way stereo_to_quadro does.  The nested loop
+ * only ever runs for these uncommon layouts; the standard ones keep
+ * their unrolled kernels. */
+static Index<float> mixer_matrix;
+
+static void build_matrix (int in, int out)
+{
+    mixer_matrix.resize (out * in);
+    memset (mixer_matrix.begin (), 0, out * in * sizeof (float));
+
+    for (int i = 0; i < in; i ++)
+    {
+        if (i < out)
+            mixer_matrix[i * in + i] = 1;
+        else
+            mixer_matrix[(i % out) * in + i] = 0.5;
+    }
+
+    for (int j = in; j < out; j ++)
+        mixer_matrix[j * in + (j % in)] = 1;
+}
+
+static Index<float> & remix_generic (Index<float> & data)
+{
+    int in = input_channels, out = output_channels;
+    int frames = data.len () / in;
+    mixer_buf.resize (out * frames);
+
+    const float * get = data.begin ();
+    float * set = mixer_buf.begin ();
+
+    while (frames --)
+    {
+        const float * m = mixer_matrix.begin ();
+
+        for (int j = 0; j < out; j ++)
+        {
+            float sum = 0;
+            for (int i = 0; i < in; i ++)
+                sum += m[i] * get[i];
+
+            * set ++ = sum;
+            m += in;
+        }
+
+        get += in;
+    }
+
+    return mixer_buf;
+}
+
 static Converter get_converter (int in, int out)
 {
     if (in == 1 && out == 2)
@@ -204,7 +262,8 @@ static Converter get_converter (int in, int out)
     return nullptr;
 }
 
-static int input_channels, output_channels;
+/* chosen once per song; process() must not redo the lookup per block */
+static Converter current_converter;
 
 void ChannelMixer::start (int & channels, int & rate)
 {
@@ -214,11 +273,14 @@ void ChannelMixer::start (int & channels, int & rate)
     if (input_channels == output_channels)
         return;
 
-    if (! get_converter (input_channels, output_channels))
+    current_converter = get_converter (input_channels, output_channels);
+
+    if (! current_converter)
     {
-        AUDERR ("Converting %d to %d channels is not implemented.\n",
+        AUDDBG ("Using generic matrix for %d to %d channels.\n",
          input_channels, output_channels);
-        return;
+        build_matrix (input_channels, output_channels);
+        current_converter = remix_generic;
     }
 
     channels = output_channels;
@@ -229,11 +291,7 @@ Index<float> & ChannelMixer::process (Index<float> & data)
     if (input_channels == output_channels)
         return data;
 
-    Converter converter = get_converter (input_channels, output_channels);
-    if (converter)
-        return converter (data);
-
-    return data;
+    return current_converter (data);
 }
 
 const char * const ChannelMixer::defaults[] = {
@@ -249,6 +307,7 @@ bool ChannelMixer::init ()
 void ChannelMixer::cleanup ()
 {
     mixer_buf.clear ();
+    mixer_matrix.clear ();
 }
 
 const char ChannelMixer::about[] =
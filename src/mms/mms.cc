@@ -17,13 +17,26 @@
  * the use of this software.
  */
 
+#include <pthread.h>
+
 #include <libmms/mms.h>
 #include <libmms/mmsh.h>
 
 #include <libaudcore/i18n.h>
 #include <libaudcore/plugin.h>
+#include <libaudcore/ringbuf.h>
 #include <libaudcore/runtime.h>
 
+/* Maximum bytes per blocking read issued by the fetch thread */
+#define MMS_READBLKSIZE 16384
+
+/* Reconnection attempts before a dropped connection becomes an error */
+#define MMS_RETRY_COUNT 3
+
+/* Initial bandwidth hint; the server uses it to pick a stream variant */
+#define MMS_INIT_BANDWIDTH (128 * 1024)
+#define MMS_MIN_BANDWIDTH (32 * 1024)
+
 static const char * const mms_schemes[] = {"mms"};
 
 class MMSTransport : public TransportPlugin
@@ -38,12 +51,34 @@ public:
 
 EXPORT MMSTransport aud_plugin_instance;
 
+static bool mms_open_stream (const char * path, int bandwidth,
+ mms_t * & mms, mmsh_t * & mmsh)
+{
+    mms = nullptr;
+
+    if (! (mmsh = mmsh_connect (nullptr, nullptr, path, bandwidth)))
+    {
+        AUDDBG ("Failed to connect with MMSH protocol; trying MMS.\n");
+
+        if (! (mms = mms_connect (nullptr, nullptr, path, bandwidth)))
+            return false;
+    }
+
+    return true;
+}
+
 class MMSFile : public VFSImpl
 {
 public:
     MMSFile (const char * path, mms_t * mms, mmsh_t * mmsh) :
+        m_path (path),
         m_mms (mms),
-        m_mmsh (mmsh) {}
+        m_mmsh (mmsh)
+    {
+        m_len = m_mms ? (int64_t) mms_get_length (m_mms) :
+         (int64_t) mmsh_get_length (m_mmsh);
+        m_rb.alloc (1024 * aud::clamp (aud_get_int ("net_buffer_kb"), 16, 1024));
+    }
 
     ~MMSFile () override;
 
@@ -60,25 +95,47 @@ public:
     int fflush () override;
 
 private:
+    String m_path;
     mms_t * m_mms;
     mmsh_t * m_mmsh;
+
+    int64_t m_len = 0;
+    int m_bandwidth = MMS_INIT_BANDWIDTH;
+
+    /* The fetch thread owns the libmms handles while it is running and is
+     * the only place reconnection happens; the consumer side works from
+     * m_pos, m_len and the ring buffer alone.  fseek stops the fetcher
+     * before touching the handles. */
+    RingBuf<char> m_rb;
+    pthread_t m_reader;
+    pthread_mutex_t m_mutex = PTHREAD_MUTEX_INITIALIZER;
+    pthread_cond_t m_cond = PTHREAD_COND_INITIALIZER;
+    bool m_reading = false;     /* fetch thread running */
+    bool m_read_eof = false;    /* fetcher hit end of stream or gave up */
+    bool m_quit = false;
+    bool m_eof = false;         /* consumer reached end of stream */
+    int64_t m_pos = 0;          /* position seen by the consumer */
+    int64_t m_fetch_pos = 0;    /* position the fetcher has reached */
+
+    bool ensure_reader ();
+    void stop_reader ();
+    bool reconnect (bool lower_bitrate);
+    void reader ();
+
+    static void * reader_thread (void * data)
+        { ((MMSFile *) data)->reader (); return nullptr; }
 };
 
 VFSImpl * MMSTransport::fopen (const char * path, const char * mode, String & error)
 {
-    mms_t * mms = nullptr;
-    mmsh_t * mmsh = nullptr;
+    mms_t * mms;
+    mmsh_t * mmsh;
 
-    if (! (mmsh = mmsh_connect (nullptr, nullptr, path, 128 * 1024)))
+    if (! mms_open_stream (path, MMS_INIT_BANDWIDTH, mms, mmsh))
     {
-        AUDDBG ("Failed to connect with MMSH protocol; trying MMS.\n");
-
-        if (! (mms = mms_connect (nullptr, nullptr, path, 128 * 1024)))
-        {
-            AUDERR ("Failed to open %s.\n", path);
-            error = String (_("Error connecting to MMS server"));
-            return nullptr;
-        }
+        AUDERR ("Failed to open %s.\n", path);
+        error = String (_("Error connecting to MMS server"));
+        return nullptr;
     }
 
     return new MMSFile (path, mms, mmsh);
@@ -86,35 +143,184 @@ VFSImpl * MMSTransport::fopen (const char * path, const char * mode, String & er
 
 MMSFile::~MMSFile ()
 {
+    stop_reader ();
+
     if (m_mms)
         mms_close (m_mms);
     else
         mmsh_close (m_mmsh);
 }
 
+/* called from the fetch thread with the mutex unlocked */
+bool MMSFile::reconnect (bool lower_bitrate)
+{
+    AUDERR ("Connection to %s lost; reconnecting.\n", (const char *) m_path);
+
+    if (m_mms)
+    {
+        mms_close (m_mms);
+        m_mms = nullptr;
+    }
+    else
+    {
+        mmsh_close (m_mmsh);
+        m_mmsh = nullptr;
+    }
+
+    /* if the link repeatedly cannot keep up, ask the server for a lower
+     * bitrate variant on the next connect */
+    if (lower_bitrate)
+        m_bandwidth = aud::max (m_bandwidth / 2, MMS_MIN_BANDWIDTH);
+
+    if (! mms_open_stream (m_path, m_bandwidth, m_mms, m_mmsh))
+        return false;
+
+    /* seekable streams resume where the fetcher left off; live streams
+     * just pick up at the server's current position */
+    if (m_len > 0)
+    {
+        int64_t ret;
+
+        if (m_mms)
+            ret = mms_seek (nullptr, m_mms, m_fetch_pos, SEEK_SET);
+        else
+            ret = mmsh_seek (nullptr, m_mmsh, m_fetch_pos, SEEK_SET);
+
+        if (ret != m_fetch_pos)
+            AUDERR ("Resume seek failed; stream may skip.\n");
+    }
+
+    return true;
+}
+
+void MMSFile::reader ()
+{
+    char buf[MMS_READBLKSIZE];
+    int retries = 0;
+
+    pthread_mutex_lock (& m_mutex);
+
+    while (! m_quit)
+    {
+        int space = aud::min (m_rb.space (), (int) sizeof buf);
+
+        if (! space)
+        {
+            pthread_cond_wait (& m_cond, & m_mutex);
+            continue;
+        }
+
+        pthread_mutex_unlock (& m_mutex);
+
+        int64_t part;
+
+        if (m_mms)
+            part = mms_read (nullptr, m_mms, buf, space);
+        else
+            part = mmsh_read (nullptr, m_mmsh, buf, space);
+
+        bool recovered = false;
+
+        if (part <= 0 && ! (m_len > 0 && m_fetch_pos >= m_len) &&
+         retries < MMS_RETRY_COUNT)
+        {
+            retries ++;
+            recovered = reconnect (retries > 1);
+        }
+
+        pthread_mutex_lock (& m_mutex);
+
+        if (part > 0)
+        {
+            m_rb.copy_in (buf, part);
+            m_fetch_pos += part;
+            retries = 0;
+        }
+        else if (! recovered)
+        {
+            m_read_eof = true;
+            pthread_cond_broadcast (& m_cond);
+            break;
+        }
+
+        pthread_cond_broadcast (& m_cond);
+    }
+
+    /* hold the buffered data until told to quit */
+    while (! m_quit)
+        pthread_cond_wait (& m_cond, & m_mutex);
+
+    pthread_mutex_unlock (& m_mutex);
+}
+
+bool MMSFile::ensure_reader ()
+{
+    if (m_reading || m_read_eof)
+        return true;
+
+    if (pthread_create (& m_reader, nullptr, reader_thread, this) != 0)
+    {
+        AUDERR ("Cannot start fetch thread for %s.\n", (const char *) m_path);
+        return false;
+    }
+
+    m_reading = true;
+    return true;
+}
+
+void MMSFile::stop_reader ()
+{
+    if (! m_reading)
+        return;
+
+    pthread_mutex_lock (& m_mutex);
+    m_quit = true;
+    pthread_cond_broadcast (& m_cond);
+    pthread_mutex_unlock (& m_mutex);
+
+    pthread_join (m_reader, nullptr);
+
+    m_reading = false;
+    m_quit = false;
+}
+
 int64_t MMSFile::fread (void * buf, int64_t size, int64_t count)
 {
     int64_t bytes_total = size * count;
     int64_t bytes_read = 0;
 
+    if (! ensure_reader ())
+        return 0;
+
+    pthread_mutex_lock (& m_mutex);
+
     while (bytes_read < bytes_total)
     {
-        int64_t readsize;
+        int part = aud::min ((int64_t) m_rb.len (), bytes_total - bytes_read);
 
-        if (m_mms)
-            readsize = mms_read (nullptr, m_mms, (char *) buf + bytes_read, bytes_total - bytes_read);
-        else
-            readsize = mmsh_read (nullptr, m_mmsh, (char *) buf + bytes_read, bytes_total - bytes_read);
+        if (part > 0)
+        {
+            m_rb.move_out ((char *) buf + bytes_read, part);
+            bytes_read += part;
+            m_pos += part;
 
-        if (readsize < 0)
-            AUDERR ("Read failed.\n");
+            /* wake the fetcher; we just made room */
+            pthread_cond_broadcast (& m_cond);
+            continue;
+        }
 
-        if (readsize <= 0)
+        if (m_read_eof)
+        {
+            m_eof = true;
             break;
+        }
 
-        bytes_read += readsize;
+        pthread_cond_broadcast (& m_cond);
+        pthread_cond_wait (& m_cond, & m_mutex);
     }
 
+    pthread_mutex_unlock (& m_mutex);
+
     return size ? bytes_read / size : 0;
 }
 
@@ -127,20 +333,37 @@ int64_t MMSFile::fwrite (const void * data, int64_t size, int64_t count)
 int MMSFile::fseek (int64_t offset, VFSSeekType whence)
 {
     if (whence == VFS_SEEK_CUR)
+        offset += m_pos;
+    else if (whence == VFS_SEEK_END)
+        offset += m_len;
+
+    if (offset < 0)
     {
-        if (m_mms)
-            offset += mms_get_current_pos (m_mms);
-        else
-            offset += mmsh_get_current_pos (m_mmsh);
+        AUDERR ("Seek failed.\n");
+        return -1;
     }
-    else if (whence == VFS_SEEK_END)
+
+    /* a short forward seek may land within the buffered data */
+    if (offset >= m_pos)
     {
-        if (m_mms)
-            offset += mms_get_length (m_mms);
-        else
-            offset += mmsh_get_length (m_mmsh);
+        pthread_mutex_lock (& m_mutex);
+
+        if (offset - m_pos <= (int64_t) m_rb.len ())
+        {
+            m_rb.discard ((int) (offset - m_pos));
+            m_pos = offset;
+            pthread_cond_broadcast (& m_cond);
+            pthread_mutex_unlock (& m_mutex);
+
+            m_eof = false;
+            return 0;
+        }
+
+        pthread_mutex_unlock (& m_mutex);
     }
 
+    stop_reader ();
+
     int64_t ret;
 
     if (m_mms)
@@ -154,23 +377,22 @@ int MMSFile::fseek (int64_t offset, VFSSeekType whence)
         return -1;
     }
 
+    m_rb.discard ();
+    m_pos = m_fetch_pos = offset;
+    m_read_eof = false;
+    m_eof = false;
+
     return 0;
 }
 
 int64_t MMSFile::ftell ()
 {
-    if (m_mms)
-        return mms_get_current_pos (m_mms);
-    else
-        return mmsh_get_current_pos (m_mmsh);
+    return m_pos;
 }
 
 bool MMSFile::feof ()
 {
-    if (m_mms)
-        return (mms_get_current_pos (m_mms) < (int64_t) mms_get_length (m_mms));
-    else
-        return (mmsh_get_current_pos (m_mmsh) < (int64_t) mmsh_get_length (m_mmsh));
+    return m_eof;
 }
 
 int MMSFile::ftruncate (int64_t size)
@@ -181,10 +403,7 @@ int MMSFile::ftruncate (int64_t size)
 
 int64_t MMSFile::fsize ()
 {
-    if (m_mms)
-        return mms_get_length (m_mms);
-    else
-        return mmsh_get_length (m_mmsh);
+    return m_len;
 }
 
 int MMSFile::fflush ()
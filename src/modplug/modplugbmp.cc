@@ -6,20 +6,43 @@
 
 #include "modplugbmp.h"
 
+#include <pthread.h>
 #include <stdint.h>
 #include <sys/types.h>
 #include <math.h>
+#include <time.h>
 
 #include <libmodplug/stdafx.h>
 #include <libmodplug/sndfile.h>
 
 #include <libaudcore/audstrings.h>
 #include <libaudcore/i18n.h>
+#include <libaudcore/index.h>
+#include <libaudcore/multihash.h>
+#include <libaudcore/ringbuf.h>
+#include <libaudcore/templates.h>
 
 #include "archive/open.h"
 
 using namespace std;
 
+/* read_tag results memoized by filename, so playlist rescans do not re-parse
+ * every module (libmodplug offers no way to load a module without its sample
+ * data, so a full parse is expensive).  The file size stands in for a
+ * modification time, which the VFS layer does not provide. */
+struct ModInfo
+{
+    int64_t file_size = 0;
+    int length = 0;
+    int channels = 0;
+    String title;
+    String codec;
+};
+
+static pthread_mutex_t memo_mutex = PTHREAD_MUTEX_INITIALIZER;
+static SimpleHash<String, ModInfo> tag_memo;
+static int tag_memo_entries = 0;
+
 // ModplugXMMS member functions ===============================
 
 bool ModplugXMMS::init ()
@@ -146,38 +169,175 @@ bool ModplugXMMS::is_our_file (const char * filename, VFSFile & file)
     return false;
 }
 
-void ModplugXMMS::PlayLoop()
+/* Pipeline parallelism, same pattern as the openmpt plugin: libmodplug
+ * renders all channels serially, so a dense module can spike past real
+ * time on one core.  Rendering runs on its own thread into a ring buffer
+ * holding a few hundred milliseconds of audio, decoupling those spikes
+ * from the output deadline; PlayLoop only moves finished blocks out. */
+
+static constexpr int PIPELINE_MS = 300;
+
+struct PlayPipeline
+{
+    RingBuf<char> ring;
+    pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+    pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+    int seek = -1;
+    bool quit = false;
+    bool eof = false;
+};
+
+static PlayPipeline s_pipeline;
+
+/* render one block into mBuffer, with preamp applied; runs off-thread */
+uint32_t ModplugXMMS::RenderBlock()
 {
-    uint32_t lLength;
+    uint32_t lLength = mSoundFile->Read (mBuffer, mBufSize);
 
-    while (! check_stop ())
+    if (lLength && mModProps.mPreamp)
     {
-        int seek_time = check_seek ();
-        if (seek_time != -1)
-            mSoundFile->SetCurrentPos (seek_time * (int64_t)
-             mSoundFile->GetMaxPosition () / (mSoundFile->GetSongTime () * 1000));
+        unsigned n = mBufSize >> 1;
+
+        for(unsigned i = 0; i < n; i++) {
+            short old = ((short*)mBuffer)[i];
+            ((short*)mBuffer)[i] *= (short int)mPreampFactor;
+
+            // detect overflow and clip!
+            if ((old & 0x8000) != (((short*)mBuffer)[i] & 0x8000))
+                ((short*)mBuffer)[i] = old | 0x7FFF;
+        }
+    }
+
+    return lLength;
+}
+
+void * ModplugXMMS::RenderWorker(void * arg)
+{
+    ModplugXMMS * self = (ModplugXMMS *) arg;
+
+    pthread_mutex_lock (& s_pipeline.mutex);
+
+    while (! s_pipeline.quit)
+    {
+        if (s_pipeline.seek != -1)
+        {
+            int seek_time = s_pipeline.seek;
+            s_pipeline.seek = -1;
+            s_pipeline.eof = false;
+
+            pthread_mutex_unlock (& s_pipeline.mutex);
+            self->mSoundFile->SetCurrentPos (seek_time * (int64_t)
+             self->mSoundFile->GetMaxPosition () / (self->mSoundFile->GetSongTime () * 1000));
+            pthread_mutex_lock (& s_pipeline.mutex);
+
+            /* drop anything rendered before the seek took effect */
+            s_pipeline.ring.discard ();
+        }
 
-        lLength = mSoundFile->Read (mBuffer, mBufSize);
+        if (s_pipeline.eof || s_pipeline.ring.space () < (int) self->mBufSize)
+        {
+            pthread_cond_wait (& s_pipeline.cond, & s_pipeline.mutex);
+            continue;
+        }
+
+        pthread_mutex_unlock (& s_pipeline.mutex);
+        uint32_t lLength = self->RenderBlock ();
+        pthread_mutex_lock (& s_pipeline.mutex);
 
         if (! lLength)
-            break;
+            s_pipeline.eof = true;
+        else if (s_pipeline.seek == -1)
+            s_pipeline.ring.copy_in ((char *) self->mBuffer, self->mBufSize);
+
+        pthread_cond_broadcast (& s_pipeline.cond);
+    }
+
+    pthread_mutex_unlock (& s_pipeline.mutex);
+    return nullptr;
+}
 
-        if(mModProps.mPreamp)
+void ModplugXMMS::PlayLoop()
+{
+    s_pipeline.seek = -1;
+    s_pipeline.quit = false;
+    s_pipeline.eof = false;
+    s_pipeline.ring.alloc (aud::max (2 * (int) mBufSize,
+     (int) (mModProps.mFrequency * mModProps.mChannels * 2 * PIPELINE_MS / 1000)));
+
+    pthread_t thread;
+    if (pthread_create (& thread, nullptr, RenderWorker, this) != 0)
+    {
+        /* no thread to be had; render inline as before */
+        while (! check_stop ())
         {
-            unsigned n = mBufSize >> 1;
+            int seek_time = check_seek ();
+            if (seek_time != -1)
+                mSoundFile->SetCurrentPos (seek_time * (int64_t)
+                 mSoundFile->GetMaxPosition () / (mSoundFile->GetSongTime () * 1000));
+
+            if (! RenderBlock ())
+                break;
+
+            write_audio (mBuffer, mBufSize);
+        }
+
+        return;
+    }
+
+    Index<char> buffer;
+    buffer.insert (0, mBufSize);
+
+    while (! check_stop ())
+    {
+        int seek_time = check_seek ();
+
+        pthread_mutex_lock (& s_pipeline.mutex);
 
-            for(unsigned i = 0; i < n; i++) {
-                short old = ((short*)mBuffer)[i];
-                ((short*)mBuffer)[i] *= (short int)mPreampFactor;
+        if (seek_time != -1)
+        {
+            s_pipeline.seek = seek_time;
+            s_pipeline.eof = false;
+            s_pipeline.ring.discard ();
+            pthread_cond_broadcast (& s_pipeline.cond);
+        }
 
-                // detect overflow and clip!
-                if ((old & 0x8000) != (((short*)mBuffer)[i] & 0x8000))
-                    ((short*)mBuffer)[i] = old | 0x7FFF;
+        if (! s_pipeline.ring.len () && ! s_pipeline.eof)
+        {
+            /* wait briefly for the renderer, then re-poll stop/seek */
+            timespec ts;
+            clock_gettime (CLOCK_REALTIME, & ts);
+            ts.tv_nsec += 50000000;
+            if (ts.tv_nsec >= 1000000000)
+            {
+                ts.tv_sec ++;
+                ts.tv_nsec -= 1000000000;
             }
+
+            pthread_cond_timedwait (& s_pipeline.cond, & s_pipeline.mutex, & ts);
         }
 
-        write_audio (mBuffer, mBufSize);
+        int n = aud::min (s_pipeline.ring.len (), buffer.len ());
+        if (n > 0)
+            s_pipeline.ring.move_out (buffer.begin (), n);
+
+        bool done = (! n && s_pipeline.eof && s_pipeline.seek == -1);
+
+        pthread_cond_broadcast (& s_pipeline.cond);
+        pthread_mutex_unlock (& s_pipeline.mutex);
+
+        if (done)
+            break;
+        if (n > 0)
+            write_audio (buffer.begin (), n);
     }
+
+    pthread_mutex_lock (& s_pipeline.mutex);
+    s_pipeline.quit = true;
+    pthread_cond_broadcast (& s_pipeline.cond);
+    pthread_mutex_unlock (& s_pipeline.mutex);
+    pthread_join (thread, nullptr);
+
+    s_pipeline.ring.discard ();
 }
 
 bool ModplugXMMS::play (const char * filename, VFSFile & file)
@@ -280,6 +440,32 @@ bool ModplugXMMS::read_tag (const char * filename, VFSFile & file, Tuple & tuple
     Archive* lArchive;
     const char *tmps;
 
+    int64_t lSize = file.fsize ();
+
+    if (lSize >= 0)
+    {
+        pthread_mutex_lock (& memo_mutex);
+        ModInfo * entry = tag_memo.lookup (String (filename));
+
+        if (entry && entry->file_size == lSize)
+        {
+            ModInfo info = * entry;
+            pthread_mutex_unlock (& memo_mutex);
+
+            tuple.set_str (Tuple::Codec, info.codec);
+            tuple.set_str (Tuple::Quality, _("sequenced"));
+            tuple.set_int (Tuple::Length, info.length);
+            tuple.set_int (Tuple::Channels, info.channels);
+
+            if (info.title)
+                tuple.set_str (Tuple::Title, info.title);
+
+            return true;
+        }
+
+        pthread_mutex_unlock (& memo_mutex);
+    }
+
     //open and mmap the file
     lArchive = OpenArchive(filename);
     if(lArchive->Size() == 0)
@@ -328,6 +514,34 @@ bool ModplugXMMS::read_tag (const char * filename, VFSFile & file, Tuple & tuple
     if (tmps2[0])
         tuple.set_str(Tuple::Title, tmps2);
 
+    if (lSize >= 0)
+    {
+        pthread_mutex_lock (& memo_mutex);
+        ModInfo * entry = tag_memo.lookup (String (filename));
+
+        if (! entry)
+        {
+            /* primitive size cap; entries are tiny, and dropping the memo
+             * once in a long while just means parsing those files again */
+            if (tag_memo_entries >= 4096)
+            {
+                tag_memo.clear ();
+                tag_memo_entries = 0;
+            }
+
+            entry = tag_memo.add (String (filename), ModInfo ());
+            tag_memo_entries ++;
+        }
+
+        entry->file_size = lSize;
+        entry->length = lSoundFile->GetSongTime() * 1000;
+        entry->channels = lSoundFile->GetNumChannels();
+        entry->title = tmps2[0] ? String (tmps2) : String ();
+        entry->codec = String (tmps);
+
+        pthread_mutex_unlock (& memo_mutex);
+    }
+
     //unload the file
     lSoundFile->Destroy();
     delete lSoundFile;
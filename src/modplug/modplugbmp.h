@@ -87,6 +87,8 @@ private:
     void apply_settings ();
 
     void PlayLoop();
+    uint32_t RenderBlock();
+    static void * RenderWorker(void * arg);
 };
 
 #endif //included
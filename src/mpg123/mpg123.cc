@@ -19,6 +19,7 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <pthread.h>
 #include <string.h>
 
 #undef EXPORT
@@ -38,6 +39,7 @@
 #include <audacious/audtag.h>
 #include <libaudcore/audstrings.h>
 #include <libaudcore/i18n.h>
+#include <libaudcore/multihash.h>
 #include <libaudcore/plugin.h>
 #include <libaudcore/preferences.h>
 #include <libaudcore/runtime.h>
@@ -75,12 +77,15 @@ const char * const MPG123Plugin::mimes[] = {
     "audio/mp3", "audio/mpeg", "audio/x-mp3", "audio/x-mpeg", nullptr};
 
 const char * const MPG123Plugin::defaults[] = {"full_scan", "FALSE", //
+                                               "int_output", "FALSE", //
                                                nullptr};
 
 const PreferencesWidget MPG123Plugin::widgets[] = {
     WidgetLabel(N_("<b>Advanced</b>")),
     WidgetCheck(N_("Use accurate length calculation (slow)"),
-                WidgetBool("mpg123", "full_scan"))};
+                WidgetBool("mpg123", "full_scan")),
+    WidgetCheck(N_("Decode to 16-bit integer (no floating point)"),
+                WidgetBool("mpg123", "int_output"))};
 
 const PluginPreferences MPG123Plugin::prefs = {{widgets}};
 
@@ -91,6 +96,70 @@ const PluginPreferences MPG123Plugin::prefs = {{widgets}};
 #define print_mpg123_error(filename, decoder)                                  \
     AUDERR("mpg123 error in %s: %s\n", filename, mpg123_strerror(decoder))
 
+/* Cached seek index for VBR files without Xing headers.  libmpg123 fills in
+ * its frame-offset table as a side effect of decoding, so after one playback
+ * the index covers the whole file; we keep a copy per file and hand it back
+ * on reopen, making later seeks direct jumps instead of forward re-scans.
+ * Entries are validated by file size, since the VFS layer does not expose
+ * modification times. */
+struct SeekIndex
+{
+    int64_t file_size = 0;
+    off_t step = 0;
+    Index<off_t> offsets;
+};
+
+static pthread_mutex_t index_mutex = PTHREAD_MUTEX_INITIALIZER;
+static SimpleHash<String, SeekIndex> index_cache;
+static int index_cache_entries = 0;
+
+static void restore_seek_index(const char * filename, int64_t size,
+                               mpg123_handle * dec)
+{
+    pthread_mutex_lock(&index_mutex);
+
+    SeekIndex * entry = index_cache.lookup(String(filename));
+    if (entry && entry->file_size == size && entry->offsets.len() > 0)
+        mpg123_set_index(dec, entry->offsets.begin(), entry->step,
+                         entry->offsets.len());
+
+    pthread_mutex_unlock(&index_mutex);
+}
+
+static void save_seek_index(const char * filename, int64_t size,
+                            mpg123_handle * dec)
+{
+    off_t * offsets, step;
+    size_t fill;
+
+    if (mpg123_index(dec, &offsets, &step, &fill) < 0 || !fill)
+        return;
+
+    pthread_mutex_lock(&index_mutex);
+
+    SeekIndex * entry = index_cache.lookup(String(filename));
+    if (!entry)
+    {
+        /* primitive size cap; a full index is only a few KB, so losing the
+         * cache once in a long while beats tracking LRU order */
+        if (index_cache_entries >= 256)
+        {
+            index_cache.clear();
+            index_cache_entries = 0;
+        }
+
+        entry = index_cache.add(String(filename), SeekIndex());
+        index_cache_entries++;
+    }
+
+    entry->file_size = size;
+    entry->step = step;
+    entry->offsets.resize(fill);
+    memcpy(entry->offsets.begin(), offsets, fill * sizeof(off_t));
+
+    pthread_mutex_unlock(&index_mutex);
+}
+
 static ssize_t replace_read(void * file, void * buffer, size_t length)
 {
     return ((VFSFile *)file)->fread(buffer, 1, length);
@@ -137,9 +206,10 @@ struct DecodeState
 
     long rate;
     int channels, encoding;
+    bool use_s16;
     mpg123_frameinfo info;
     size_t bytes_read;
-    float buf[4096];
+    char buf[16384];
 };
 
 DecodeState::DecodeState(const char * filename, VFSFile & file, bool probing,
@@ -155,12 +225,23 @@ DecodeState::DecodeState(const char * filename, VFSFile & file, bool probing,
     if (probing)
         mpg123_param(dec, MPG123_RESYNC_LIMIT, 0, 0);
 
+    /* for playback of seekable files, let the seek index grow to cover the
+     * whole file rather than thinning out, so it is worth caching */
+    if (!probing && !stream)
+        mpg123_param(dec, MPG123_INDEX_SIZE, -1, 0);
+
     mpg123_format_none(dec);
 
+    /* libmpg123's 16-bit synth is considerably cheaper than the float one on
+     * machines without fast floating point, so offer it as an option.  Float
+     * stays the default: it preserves samples beyond full scale, which MP3
+     * can legitimately produce, for later attenuation by ReplayGain. */
+    use_s16 = aud_get_bool("mpg123", "int_output");
+
     auto rates = {8000, 11025, 12000, 16000, 22050, 24000, 32000, 44100, 48000};
     for (int rate : rates)
         mpg123_format(dec, rate, MPG123_MONO | MPG123_STEREO,
-                      MPG123_ENC_FLOAT_32);
+                      use_s16 ? MPG123_ENC_SIGNED_16 : MPG123_ENC_FLOAT_32);
 
     if (mpg123_open_handle(dec, &file) < 0)
         goto err;
@@ -313,6 +394,9 @@ bool MPG123Plugin::play(const char * filename, VFSFile & file)
     if (!s.valid())
         return false;
 
+    if (!stream)
+        restore_seek_index(filename, file.fsize(), s.dec);
+
     int bitrate = s.info.bitrate * 1000;
     int bitrate_sum = 0, bitrate_count = 0;
     int error_count = 0;
@@ -322,7 +406,7 @@ bool MPG123Plugin::play(const char * filename, VFSFile & file)
     if (stream && tuple.fetch_stream_info(file))
         set_playback_tuple(tuple.ref());
 
-    open_audio(FMT_FLOAT, s.rate, s.channels);
+    open_audio(s.use_s16 ? FMT_S16_NE : FMT_FLOAT, s.rate, s.channels);
 
     while (!check_stop())
     {
@@ -387,6 +471,11 @@ bool MPG123Plugin::play(const char * filename, VFSFile & file)
         }
     }
 
+    /* keep whatever part of the index this playback filled in, so the next
+     * open of the same file can seek without re-scanning */
+    if (!stream)
+        save_seek_index(filename, file.fsize(), s.dec);
+
     return true;
 }
 
@@ -27,12 +27,17 @@
 #include <libaudcore/i18n.h>
 #include <libaudcore/index.h>
 #include <libaudcore/interface.h>
+#include <libaudcore/mainloop.h>
+#include <libaudcore/playlist.h>
 #include <libaudcore/plugin.h>
 #include <libaudcore/probe.h>
 #include <libaudcore/runtime.h>
+#include <libaudcore/templates.h>
+#include <libaudcore/tuple.h>
 
 #include "object-core.h"
 #include "object-player.h"
+#include "object-tracklist.h"
 
 class MPRIS2Plugin : public GeneralPlugin
 {
@@ -52,7 +57,7 @@ public:
 };
 
 EXPORT MPRIS2Plugin aud_plugin_instance;
-static GObject * object_core, * object_player;
+static GObject * object_core, * object_player, * object_tracklist;
 
 static gboolean quit_cb (MprisMediaPlayer2 * object, GDBusMethodInvocation * call,
  void * unused)
@@ -107,6 +112,7 @@ struct MPRIS2Metadata
 };
 
 static MPRIS2Metadata last_meta;
+static QueuedFunc meta_update_func;
 
 /* Helper functions to handle GVariant creation */
 
@@ -199,7 +205,12 @@ static void update_metadata (void * data, GObject * object)
     if (meta == last_meta)
         return;
 
-    if (meta.file != last_meta.file)
+    /* keep the resolved art for tuple changes within the same file
+     * (e.g. stream metadata updates) instead of resolving it again or,
+     * worse, dropping the art URL from the dict */
+    if (meta.file == last_meta.file)
+        meta.image = std::move (last_meta.image);
+    else
         meta.image =
             meta.file ? aud_art_request (meta.file, AUD_ART_FILE) : AudArtPtr ();
 
@@ -248,6 +259,15 @@ static void update_metadata (void * data, GObject * object)
     last_meta = std::move (meta);
 }
 
+/* Tuple changes can arrive in bursts (several partial updates per
+ * main-loop pass while a stream is probed); marshaling the metadata
+ * dict once per pass is enough, since the generated skeleton only
+ * emits PropertiesChanged from an idle callback anyway. */
+static void queue_update_metadata (void * data, GObject * object)
+{
+    meta_update_func.queue ([object] () { update_metadata (nullptr, object); });
+}
+
 static void volume_changed (GObject * object)
 {
     double vol;
@@ -358,6 +378,166 @@ static gboolean stop_cb (MprisMediaPlayer2Player * object, GDBusMethodInvocation
     return true;
 }
 
+/* --- TrackList interface ---
+ *
+ * Track ids encode playlist positions.  They are only valid until the
+ * playlist is edited; every edit (or window move) emits TrackListReplaced,
+ * which per the MPRIS spec tells controllers to drop cached ids and fetch
+ * fresh ones.  Only a window of ids around the current entry is advertised
+ * in the Tracks property, and GetTracksMetadata marshals exactly the ids
+ * it was asked about, so a huge playlist is paged across the bus in small
+ * pieces instead of being serialized wholesale. */
+
+static QueuedFunc tracklist_update_func;
+
+/* entries advertised on either side of the current one */
+static constexpr int TrackListWindow = 50;
+
+static const char NoTrackId[] = "/org/mpris/MediaPlayer2/TrackList/NoTrack";
+
+static StringBuf track_id_for (int entry)
+{
+    return str_printf ("/org/mpris/MediaPlayer2/TrackList/%d", entry);
+}
+
+static int track_id_to_entry (Playlist list, const char * id)
+{
+    const char prefix[] = "/org/mpris/MediaPlayer2/TrackList/";
+    if (strncmp (id, prefix, sizeof prefix - 1))
+        return -1;
+
+    const char * num = id + sizeof prefix - 1;
+    if (! num[0] || num[strspn (num, "0123456789")])
+        return -1;
+
+    int entry = atoi (num);
+    return (entry < list.n_entries ()) ? entry : -1;
+}
+
+static GVariant * track_metadata (Playlist list, int entry)
+{
+    /* built on demand from the tuple already cached by the playlist;
+     * NoWait keeps an unscanned entry from blocking the bus call */
+    Tuple tuple = list.entry_tuple (entry, Playlist::NoWait);
+
+    Index<GVariant *> elems;
+
+    GVariant * key = g_variant_new_string ("mpris:trackid");
+    GVariant * str = g_variant_new_object_path (track_id_for (entry));
+    elems.append (g_variant_new_dict_entry (key, g_variant_new_variant (str)));
+
+    add_g_variant_str ("xesam:url", list.entry_filename (entry), elems);
+    add_g_variant_str ("xesam:title", tuple.get_str (Tuple::Title), elems);
+
+    String artist = tuple.get_str (Tuple::Artist);
+    if (artist)
+        add_g_variant_arr_str ("xesam:artist", {{artist}}, elems);
+
+    add_g_variant_str ("xesam:album", tuple.get_str (Tuple::Album), elems);
+
+    int length = tuple.get_int (Tuple::Length);
+    if (length > 0)
+        add_g_variant_int64 ("mpris:length", (int64_t) length * 1000, elems);
+
+    return g_variant_new_array (G_VARIANT_TYPE ("{sv}"), elems.begin (),
+     elems.len ());
+}
+
+static void update_tracklist ()
+{
+    Playlist list = Playlist::active_playlist ();
+    int entries = list.n_entries ();
+    int current = aud::max (list.get_position (), 0);
+
+    int first = aud::clamp (current - TrackListWindow, 0,
+     aud::max (entries - (2 * TrackListWindow + 1), 0));
+    int last = aud::min (first + 2 * TrackListWindow + 1, entries);
+
+    Index<String> ids;
+    Index<const char *> pointers;
+
+    for (int entry = first; entry < last; entry ++)
+        pointers.append ((const char *) ids.append (String (track_id_for (entry))));
+
+    pointers.append (nullptr);
+
+    g_object_set (object_tracklist, "tracks", pointers.begin (), nullptr);
+
+    StringBuf current_id = (entries > 0) ? track_id_for (current)
+     : str_copy (NoTrackId);
+    mpris_media_player2_track_list_emit_track_list_replaced (
+     (MprisMediaPlayer2TrackList *) object_tracklist, pointers.begin (),
+     current_id);
+}
+
+/* a single playlist edit can fire many update hooks; rebuilding the
+ * window once per main-loop pass is enough */
+static void queue_update_tracklist (void *, void *)
+{
+    tracklist_update_func.queue ([] () { update_tracklist (); });
+}
+
+static gboolean get_tracks_metadata_cb (MprisMediaPlayer2TrackList * object,
+ GDBusMethodInvocation * call, const char * const * ids, void * unused)
+{
+    Playlist list = Playlist::active_playlist ();
+    Index<GVariant *> metas;
+
+    /* ids outside the advertised window are honored too; that is how
+     * controllers page through entries the window does not cover */
+    for (int i = 0; ids && ids[i]; i ++)
+    {
+        int entry = track_id_to_entry (list, ids[i]);
+        if (entry >= 0)
+            metas.append (track_metadata (list, entry));
+    }
+
+    mpris_media_player2_track_list_complete_get_tracks_metadata (object, call,
+     g_variant_new_array (G_VARIANT_TYPE ("a{sv}"), metas.begin (), metas.len ()));
+    return true;
+}
+
+static gboolean add_track_cb (MprisMediaPlayer2TrackList * object,
+ GDBusMethodInvocation * call, const char * uri, const char * after,
+ gboolean play, void * unused)
+{
+    Playlist list = Playlist::active_playlist ();
+    int entry = track_id_to_entry (list, after);
+    int at = (entry >= 0) ? entry + 1 : strcmp (after, NoTrackId) ? -1 : 0;
+
+    list.insert_entry (at, uri, Tuple (), play);
+
+    mpris_media_player2_track_list_complete_add_track (object, call);
+    return true;
+}
+
+static gboolean remove_track_cb (MprisMediaPlayer2TrackList * object,
+ GDBusMethodInvocation * call, const char * id, void * unused)
+{
+    Playlist list = Playlist::active_playlist ();
+    int entry = track_id_to_entry (list, id);
+    if (entry >= 0)
+        list.remove_entry (entry);
+
+    mpris_media_player2_track_list_complete_remove_track (object, call);
+    return true;
+}
+
+static gboolean go_to_cb (MprisMediaPlayer2TrackList * object,
+ GDBusMethodInvocation * call, const char * id, void * unused)
+{
+    Playlist list = Playlist::active_playlist ();
+    int entry = track_id_to_entry (list, id);
+    if (entry >= 0)
+    {
+        list.set_position (entry);
+        list.start_playback ();
+    }
+
+    mpris_media_player2_track_list_complete_go_to (object, call);
+    return true;
+}
+
 const char MPRIS2Plugin::about[] =
  N_("MPRIS Plugin for Audacious\n"
     "Copyright 2011-2012 John Lindgren\n\n"
@@ -373,17 +553,26 @@ void MPRIS2Plugin::cleanup ()
     hook_dissociate ("playback stop", (HookFunction) update_playback_status);
     hook_dissociate ("playback unpause", (HookFunction) update_playback_status);
 
-    hook_dissociate ("playback ready", (HookFunction) update_metadata);
-    hook_dissociate ("playback stop", (HookFunction) update_metadata);
-    hook_dissociate ("tuple change", (HookFunction) update_metadata);
+    hook_dissociate ("playback ready", (HookFunction) queue_update_metadata);
+    hook_dissociate ("playback stop", (HookFunction) queue_update_metadata);
+    hook_dissociate ("tuple change", (HookFunction) queue_update_metadata);
+
+    meta_update_func.stop ();
 
     hook_dissociate ("playback ready", (HookFunction) emit_seek);
     hook_dissociate ("playback seek", (HookFunction) emit_seek);
 
+    hook_dissociate ("playlist update", (HookFunction) queue_update_tracklist);
+    hook_dissociate ("playlist activate", (HookFunction) queue_update_tracklist);
+    hook_dissociate ("playlist position", (HookFunction) queue_update_tracklist);
+
+    tracklist_update_func.stop ();
+
     timer_remove (TimerRate::Hz4, update, object_player);
 
     g_object_unref (object_core);
     g_object_unref (object_player);
+    g_object_unref (object_tracklist);
 
     last_meta = MPRIS2Metadata ();
 }
@@ -442,9 +631,9 @@ bool MPRIS2Plugin::init ()
     hook_associate ("playback stop", (HookFunction) update_playback_status, object_player);
     hook_associate ("playback unpause", (HookFunction) update_playback_status, object_player);
 
-    hook_associate ("playback ready", (HookFunction) update_metadata, object_player);
-    hook_associate ("playback stop", (HookFunction) update_metadata, object_player);
-    hook_associate ("tuple change", (HookFunction) update_metadata, object_player);
+    hook_associate ("playback ready", (HookFunction) queue_update_metadata, object_player);
+    hook_associate ("playback stop", (HookFunction) queue_update_metadata, object_player);
+    hook_associate ("tuple change", (HookFunction) queue_update_metadata, object_player);
 
     hook_associate ("playback ready", (HookFunction) emit_seek, object_player);
     hook_associate ("playback seek", (HookFunction) emit_seek, object_player);
@@ -462,10 +651,28 @@ bool MPRIS2Plugin::init ()
 
     g_signal_connect (object_player, "notify::volume", (GCallback) volume_changed, nullptr);
 
+    object_tracklist = (GObject *) mpris_media_player2_track_list_skeleton_new ();
+
+    g_object_set (object_tracklist, "can-edit-tracks", (gboolean) true, nullptr);
+
+    update_tracklist ();
+
+    hook_associate ("playlist update", (HookFunction) queue_update_tracklist, nullptr);
+    hook_associate ("playlist activate", (HookFunction) queue_update_tracklist, nullptr);
+    hook_associate ("playlist position", (HookFunction) queue_update_tracklist, nullptr);
+
+    g_signal_connect (object_tracklist, "handle-get-tracks-metadata",
+     (GCallback) get_tracks_metadata_cb, nullptr);
+    g_signal_connect (object_tracklist, "handle-add-track", (GCallback) add_track_cb, nullptr);
+    g_signal_connect (object_tracklist, "handle-remove-track", (GCallback) remove_track_cb, nullptr);
+    g_signal_connect (object_tracklist, "handle-go-to", (GCallback) go_to_cb, nullptr);
+
     if (! g_dbus_interface_skeleton_export ((GDBusInterfaceSkeleton *)
      object_core, bus, "/org/mpris/MediaPlayer2", & error) ||
      ! g_dbus_interface_skeleton_export ((GDBusInterfaceSkeleton *)
-     object_player, bus, "/org/mpris/MediaPlayer2", & error))
+     object_player, bus, "/org/mpris/MediaPlayer2", & error) ||
+     ! g_dbus_interface_skeleton_export ((GDBusInterfaceSkeleton *)
+     object_tracklist, bus, "/org/mpris/MediaPlayer2", & error))
     {
         cleanup ();
         AUDERR ("%s\n", error->message);
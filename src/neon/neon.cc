@@ -22,6 +22,7 @@
 #include <pthread.h>
 #include <stdint.h>
 #include <string.h>
+#include <time.h>
 
 #include <glib.h>
 
@@ -46,9 +47,18 @@
 
 #include "cert_verification.h"
 
-#define NEON_NETBLKSIZE     (4096)
+#define NEON_NETBLKSIZE     (4096)     /* minimum free space before the reader hits the network */
+#define NEON_FILL_SECONDS   (8)        /* readahead target in seconds of audio, when the
+                                          server advertises a bitrate */
+#define NEON_FILL_MINIMUM   (64 * 1024) /* lower bound for the readahead target */
+#define NEON_READBLKSIZE    (16384)    /* maximum bytes per network read */
 #define NEON_ICY_BUFSIZE    (4096)
 #define NEON_RETRY_COUNT 6
+#define NEON_SESSION_POOL_MAX 8
+
+#define NEON_CACHE_MAX_OBJECT (256 * 1024)  /* cutoff for the small-object cache */
+#define NEON_CACHE_MAX_OBJECTS 32
+#define NEON_CACHE_FRESH_SECONDS 300        /* serve without revalidating for this long */
 
 enum FillBufferResult {
     FILL_BUFFER_SUCCESS,
@@ -111,6 +121,8 @@ public:
 
 EXPORT NeonTransport aud_plugin_instance;
 
+static void session_pool_drain ();
+
 bool NeonTransport::init ()
 {
     int ret = ne_sock_init ();
@@ -124,11 +136,223 @@ bool NeonTransport::init ()
     return true;
 }
 
+static void object_cache_drain ();
+
 void NeonTransport::cleanup ()
 {
+    session_pool_drain ();
+    object_cache_drain ();
     ne_sock_exit ();
 }
 
+class NeonFile;
+
+/* A pooled ne_session.  Connections are not kept alive (we abort stream
+ * bodies mid-response, so the socket is closed after every request), but
+ * the session object keeps the negotiated TLS session cache, so reusing
+ * it across stream opens gets abbreviated handshakes when hopping between
+ * stations on the same server.  The owner pointer is what the server auth
+ * callback forwards to, since the session can outlive the file it was
+ * created for.  The ne_session lifetime is managed explicitly. */
+struct NeonSession
+{
+    String scheme, host;
+    int port;
+    String proxy_sig;          /* proxy settings the session was built with */
+    ne_session * sess = nullptr;
+    NeonFile * owner = nullptr;
+
+    NeonSession (const char * scheme, const char * host, int port,
+     const char * proxy_sig) :
+        scheme (scheme),
+        host (host),
+        port (port),
+        proxy_sig (proxy_sig) {}
+};
+
+static pthread_mutex_t session_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static Index<SmartPtr<NeonSession>> session_pool;  /* least recently used first */
+
+static SmartPtr<NeonSession> session_pool_acquire (const char * scheme,
+ const char * host, int port, const char * proxy_sig)
+{
+    SmartPtr<NeonSession> ns;
+
+    pthread_mutex_lock (& session_pool_mutex);
+
+    for (int i = session_pool.len (); i --; )
+    {
+        NeonSession * s = session_pool[i].get ();
+
+        if (! strcmp (s->scheme, scheme) && ! strcmp (s->host, host) &&
+         s->port == port && ! strcmp (s->proxy_sig, proxy_sig))
+        {
+            ns = std::move (session_pool[i]);
+            session_pool.remove (i, 1);
+            break;
+        }
+    }
+
+    pthread_mutex_unlock (& session_pool_mutex);
+    return ns;
+}
+
+static void session_pool_release (SmartPtr<NeonSession> && ns)
+{
+    ns->owner = nullptr;
+
+    pthread_mutex_lock (& session_pool_mutex);
+
+    if (session_pool.len () >= NEON_SESSION_POOL_MAX)
+    {
+        ne_session_destroy (session_pool[0]->sess);
+        session_pool.remove (0, 1);
+    }
+
+    session_pool.append (std::move (ns));
+    pthread_mutex_unlock (& session_pool_mutex);
+}
+
+static void session_pool_drain ()
+{
+    pthread_mutex_lock (& session_pool_mutex);
+
+    for (auto & ns : session_pool)
+        ne_session_destroy (ns->sess);
+
+    session_pool.clear ();
+    pthread_mutex_unlock (& session_pool_mutex);
+}
+
+/* Small complete responses -- lyrics files, scrobbler calls, album art --
+ * are kept in a memory cache so reopening one does not redo the whole
+ * connect-and-GET dance.  Fresh entries are served straight from memory;
+ * stale ones that came with an ETag are revalidated with If-None-Match,
+ * turning a repeat transfer into a 304. */
+struct CacheObject
+{
+    String url;
+    String etag;           /* validator; unset if the server sent none */
+    String content_type;
+    Index<char> data;
+    time_t stored = 0;
+};
+
+static pthread_mutex_t object_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static Index<SmartPtr<CacheObject>> object_cache;  /* least recently used first */
+
+static SmartPtr<CacheObject> object_cache_take (const char * url)
+{
+    SmartPtr<CacheObject> obj;
+
+    pthread_mutex_lock (& object_cache_mutex);
+
+    for (int i = object_cache.len (); i --; )
+    {
+        if (! strcmp (object_cache[i]->url, url))
+        {
+            obj = std::move (object_cache[i]);
+            object_cache.remove (i, 1);
+            break;
+        }
+    }
+
+    pthread_mutex_unlock (& object_cache_mutex);
+    return obj;
+}
+
+static void object_cache_store (SmartPtr<CacheObject> && obj)
+{
+    pthread_mutex_lock (& object_cache_mutex);
+
+    if (object_cache.len () >= NEON_CACHE_MAX_OBJECTS)
+        object_cache.remove (0, 1);
+
+    object_cache.append (std::move (obj));
+    pthread_mutex_unlock (& object_cache_mutex);
+}
+
+static void object_cache_drain ()
+{
+    pthread_mutex_lock (& object_cache_mutex);
+    object_cache.clear ();
+    pthread_mutex_unlock (& object_cache_mutex);
+}
+
+/* Serves a cached response from memory.  get_metadata reports the content
+ * type so file type probing behaves as it would on the live response. */
+class NeonCachedFile : public VFSImpl
+{
+public:
+    NeonCachedFile (Index<char> && data, const String & content_type) :
+        m_data (std::move (data)),
+        m_content_type (content_type) {}
+
+protected:
+    int64_t fread (void * ptr, int64_t size, int64_t nmemb) override
+    {
+        int64_t remain = m_data.len () - m_pos;
+
+        if (size < 1 || remain < 1)
+            return 0;
+
+        nmemb = aud::min (nmemb, remain / size);
+        memcpy (ptr, m_data.begin () + m_pos, nmemb * size);
+        m_pos += nmemb * size;
+        return nmemb;
+    }
+
+    int fseek (int64_t offset, VFSSeekType whence) override
+    {
+        int64_t newpos;
+
+        switch (whence)
+        {
+        case VFS_SEEK_SET: newpos = offset; break;
+        case VFS_SEEK_CUR: newpos = m_pos + offset; break;
+        case VFS_SEEK_END: newpos = m_data.len () + offset; break;
+        default: return -1;
+        }
+
+        if (newpos < 0 || newpos > m_data.len ())
+            return -1;
+
+        m_pos = newpos;
+        return 0;
+    }
+
+    int64_t ftell () override { return m_pos; }
+    int64_t fsize () override { return m_data.len (); }
+    bool feof () override { return m_pos >= m_data.len (); }
+
+    int64_t fwrite (const void * ptr, int64_t size, int64_t nmemb) override { return 0; }
+    int ftruncate (int64_t length) override { return 0; }
+    int fflush () override { return 0; }
+
+    String get_metadata (const char * field) override
+    {
+        if (! strcmp (field, "content-type") && m_content_type)
+            return m_content_type;
+
+        return String ();
+    }
+
+private:
+    Index<char> m_data;
+    String m_content_type;
+    int64_t m_pos = 0;
+};
+
+static NeonCachedFile * serve_from_cache (SmartPtr<CacheObject> && obj)
+{
+    Index<char> data;
+    data.insert (obj->data.begin (), 0, obj->data.len ());
+    String type = obj->content_type;
+    object_cache_store (std::move (obj));
+
+    return new NeonCachedFile (std::move (data), type);
+}
+
 class NeonFile : public VFSImpl
 {
 public:
@@ -137,6 +361,10 @@ public:
 
     int open_handle (int64_t startbyte, String * error = nullptr);
 
+    /* revalidate against a cached copy; open_handle returns 2 on a 304 */
+    void set_validator (const String & etag)
+        { m_if_none_match = etag; }
+
 protected:
     int64_t fread (void * ptr, int64_t size, int64_t nmemb) override;
     int fseek (int64_t offset, VFSSeekType whence) override;
@@ -166,13 +394,29 @@ private:
                                            send metadata announcements. 0 if no announcments */
     int64_t m_icy_metaleft = 0;         /* Bytes left until the next metadata block */
     int m_icy_len = 0;                  /* Bytes in current metadata block */
+    uint32_t m_icy_hash = 0;            /* Hash of the last parsed metadata block */
 
     bool m_eof = false;
 
-    RingBuf<char> m_rb;           /* Ringbuffer for our data */
-    Index<char> m_icy_buf;        /* Buffer for ICY metadata */
+    String m_etag;               /* validator from the response, if any */
+    String m_if_none_match;      /* validator to revalidate against */
+    bool m_cacheable = false;    /* body is being accumulated for the cache */
+    Index<char> m_cache_accum;
+
+    /* Buffering statistics, for diagnosing underruns on remote streams.
+     * A stall is a read that had to wait because the buffer was empty
+     * while the reader thread was still running. */
+    int64_t m_stall_count = 0;
+    int64_t m_fill_total = 0;     /* sum of buffered bytes, sampled per read */
+    int64_t m_fill_samples = 0;
+
+    RingBuf<char> m_rb;           /* Ringbuffer for demuxed audio data */
+    int m_fill_target = 0;        /* bytes the reader keeps buffered ahead */
+    Index<char> m_icy_buf;        /* Staging buffer for an ICY metadata block
+                                     split across network reads */
     icy_metadata m_icy_metadata;  /* Current ICY metadata */
 
+    SmartPtr<NeonSession> m_ns;         /* owns m_session while we hold it */
     ne_session * m_session = nullptr;
     ne_request * m_request = nullptr;
 
@@ -184,12 +428,14 @@ private:
     void handle_headers ();
     int open_request (int64_t startbyte, String * error);
     FillBufferResult fill_buffer ();
+    bool icy_unchanged (const char * data, int len);
+    void demux_icy (char * data, int len);
     void reader ();
     int64_t try_fread (void * ptr, int64_t size, int64_t nmemb, bool & data_read);
 
     static int server_auth_callback (void * data, const char * realm, int attempt,
      char * username, char * password)
-        { return ((NeonFile *) data)->server_auth (realm, attempt, username, password); }
+        { return ((NeonSession *) data)->owner->server_auth (realm, attempt, username, password); }
 
     static void * reader_thread (void * data)
         { ((NeonFile *) data)->reader (); return nullptr; }
@@ -200,6 +446,7 @@ NeonFile::NeonFile (const char * url) :
 {
     int buffer_kb = aud_get_int ("net_buffer_kb");
     m_rb.alloc (1024 * aud::clamp (buffer_kb, 16, 1024));
+    m_fill_target = m_rb.size ();
 }
 
 NeonFile::~NeonFile ()
@@ -207,26 +454,57 @@ NeonFile::~NeonFile ()
     if (m_reader_status.reading)
         kill_reader ();
 
+    /* only complete bodies are worth keeping */
+    if (m_cacheable && m_cache_accum.len () == m_content_length)
+    {
+        AUDDBG ("<%p> Caching %d bytes for %s\n", this, m_cache_accum.len (),
+         (const char *) m_url);
+
+        SmartPtr<CacheObject> obj (new CacheObject);
+        obj->url = m_url;
+        obj->etag = m_etag;
+        obj->content_type = m_icy_metadata.stream_contenttype;
+        obj->data = std::move (m_cache_accum);
+        obj->stored = time (nullptr);
+        object_cache_store (std::move (obj));
+    }
+
+    if (m_fill_samples > 0)
+        AUDDBG ("<%p> Buffer stats for %s: %" PRId64 " stalls, average fill "
+         "%d%%\n", this, (const char *) m_url, m_stall_count,
+         (int) (100 * m_fill_total / ((int64_t) m_rb.size () * m_fill_samples)));
+
     if (m_request)
         ne_request_destroy (m_request);
     if (m_session)
-        ne_session_destroy (m_session);
+    {
+        session_pool_release (std::move (m_ns));
+        m_session = nullptr;
+    }
 
     ne_uri_free (& m_purl);
 }
 
 static void add_icy (struct icy_metadata * m, const char * name, const char * value)
 {
+    /* compare before replacing, so an unchanged field keeps its existing
+     * String rather than allocating a fresh copy of the same text */
     if (str_has_prefix_nocase (name, "StreamTitle"))
     {
         AUDDBG ("Found StreamTitle: %s\n", value);
-        m->stream_title = String (str_to_utf8 (value, -1));
+
+        StringBuf title = str_to_utf8 (value, -1);
+        if (! m->stream_title || strcmp (m->stream_title, title))
+            m->stream_title = String (title);
     }
 
     if (str_has_prefix_nocase (name, "StreamUrl"))
     {
         AUDDBG ("Found StreamUrl: %s\n", value);
-        m->stream_url = String (str_to_utf8 (value, -1));
+
+        StringBuf url = str_to_utf8 (value, -1);
+        if (! m->stream_url || strcmp (m->stream_url, url))
+            m->stream_url = String (url);
     }
 }
 
@@ -400,6 +678,12 @@ void NeonFile::handle_headers ()
             AUDDBG ("Content-Type: %s\n", value);
             m_icy_metadata.stream_contenttype = String (str_to_utf8 (value, -1));
         }
+        else if (str_has_prefix_nocase (name, "etag"))
+        {
+            /* Validator for the small-object cache */
+            AUDDBG ("ETag: %s\n", value);
+            m_etag = String (value);
+        }
         else if (str_has_prefix_nocase (name, "icy-metaint"))
         {
             /* The server sent us a ICY metaint header. Parse and store. */
@@ -462,6 +746,9 @@ int NeonFile::open_request (int64_t startbyte, String * error)
 
     ne_add_request_header (m_request, "Icy-MetaData", "1");
 
+    if (m_if_none_match)
+        ne_add_request_header (m_request, "If-None-Match", m_if_none_match);
+
     /* Try to connect to the server. */
     AUDDBG ("<%p> Connecting...\n", this);
     ret = ne_begin_request (m_request);
@@ -500,6 +787,15 @@ int NeonFile::open_request (int64_t startbyte, String * error)
     switch (ret)
     {
     case NE_OK:
+        if (status->code == 304)
+        {
+            /* revalidated; the cached copy is still current */
+            AUDDBG ("<%p> Not modified\n", this);
+            ne_request_destroy (m_request);
+            m_request = nullptr;
+            return 2;
+        }
+
         if (status->code > 199 && status->code < 300)
         {
             /* URL opened OK */
@@ -507,6 +803,21 @@ int NeonFile::open_request (int64_t startbyte, String * error)
             m_content_start = startbyte;
             m_pos = startbyte;
             handle_headers ();
+
+            /* small complete responses are teed into the object cache as
+             * they stream past (streams with ICY metadata never qualify) */
+            m_cacheable = (! startbyte && ! m_icy_metaint &&
+             m_content_length > 0 && m_content_length <= NEON_CACHE_MAX_OBJECT);
+
+            /* scale the readahead target to the advertised bitrate: keep a
+             * few seconds of audio ahead instead of filling the whole ring
+             * for a low-bitrate stream (icy-br is in kilobits per second) */
+            if (m_icy_metadata.stream_bitrate > 0)
+                m_fill_target = aud::clamp (m_icy_metadata.stream_bitrate * 125 *
+                 NEON_FILL_SECONDS, NEON_FILL_MINIMUM, m_rb.size ());
+            else
+                m_fill_target = m_rb.size ();
+
             return 0;
         }
 
@@ -622,46 +933,67 @@ int NeonFile::open_handle (int64_t startbyte, String * error)
         if (! m_purl.port)
             m_purl.port = ne_uri_defaultport (m_purl.scheme);
 
-        AUDDBG ("<%p> Creating session to %s://%s:%d\n", this,
-         m_purl.scheme, m_purl.host, m_purl.port);
-        m_session = ne_session_create (m_purl.scheme,
-         m_purl.host, m_purl.port);
-        ne_redirect_register (m_session);
-        ne_add_server_auth (m_session, NE_AUTH_BASIC, server_auth_callback, this);
-        ne_set_session_flag (m_session, NE_SESSFLAG_ICYPROTO, 1);
-        ne_set_session_flag (m_session, NE_SESSFLAG_PERSIST, 0);
-        ne_set_connect_timeout (m_session, 10);
-        ne_set_read_timeout (m_session, 10);
-        ne_set_useragent (m_session, "Audacious/" PACKAGE_VERSION);
-
-        if (use_proxy)
+        /* Sessions built with different proxy settings must not be mixed. */
+        StringBuf proxy_sig = use_proxy ? str_printf ("%s:%d:%d:%d:%s",
+         (const char *) proxy_host, proxy_port, (int) socks_proxy,
+         (int) socks_type, (const char *) proxy_user) : str_copy ("");
+
+        m_ns = session_pool_acquire (m_purl.scheme, m_purl.host,
+         m_purl.port, proxy_sig);
+
+        if (m_ns)
         {
-            AUDDBG ("<%p> Using proxy: %s:%d\n", this, (const char *) proxy_host, proxy_port);
-            if (socks_proxy)
-            {
-                ne_session_socks_proxy (m_session, socks_type, proxy_host, proxy_port, proxy_user, proxy_pass);
-            }
-            else
+            AUDDBG ("<%p> Reusing pooled session for %s://%s:%d\n", this,
+             m_purl.scheme, m_purl.host, m_purl.port);
+            m_ns->owner = this;
+            m_session = m_ns->sess;
+        }
+        else
+        {
+            AUDDBG ("<%p> Creating session to %s://%s:%d\n", this,
+             m_purl.scheme, m_purl.host, m_purl.port);
+            m_ns = SmartPtr<NeonSession> (new NeonSession (m_purl.scheme,
+             m_purl.host, m_purl.port, proxy_sig));
+            m_ns->owner = this;
+            m_session = m_ns->sess = ne_session_create (m_purl.scheme,
+             m_purl.host, m_purl.port);
+            ne_redirect_register (m_session);
+            ne_add_server_auth (m_session, NE_AUTH_BASIC, server_auth_callback, m_ns.get ());
+            ne_set_session_flag (m_session, NE_SESSFLAG_ICYPROTO, 1);
+            ne_set_session_flag (m_session, NE_SESSFLAG_PERSIST, 0);
+            ne_set_connect_timeout (m_session, 10);
+            ne_set_read_timeout (m_session, 10);
+            ne_set_useragent (m_session, "Audacious/" PACKAGE_VERSION);
+
+            if (use_proxy)
             {
-                ne_session_proxy (m_session, proxy_host, proxy_port);
+                AUDDBG ("<%p> Using proxy: %s:%d\n", this, (const char *) proxy_host, proxy_port);
+                if (socks_proxy)
+                {
+                    ne_session_socks_proxy (m_session, socks_type, proxy_host, proxy_port, proxy_user, proxy_pass);
+                }
+                else
+                {
+                    ne_session_proxy (m_session, proxy_host, proxy_port);
+                }
+
+                if (use_proxy_auth)
+                {
+                    AUDDBG ("<%p> Using proxy authentication\n", this);
+                    ne_add_proxy_auth (m_session, NE_AUTH_BASIC,
+                     neon_proxy_auth_cb, nullptr);
+                }
             }
 
-            if (use_proxy_auth)
+            if (! strcmp ("https", m_purl.scheme))
             {
-                AUDDBG ("<%p> Using proxy authentication\n", this);
-                ne_add_proxy_auth (m_session, NE_AUTH_BASIC,
-                 neon_proxy_auth_cb, (void *) this);
-            }
-        }
-
-        if (! strcmp ("https", m_purl.scheme))
-        {
-            ne_ssl_trust_default_ca (m_session);
+                ne_ssl_trust_default_ca (m_session);
 #ifdef _WIN32
-            trust_win32_root_certs (m_session);
+                trust_win32_root_certs (m_session);
 #endif
-            ne_ssl_set_verify (m_session,
-             neon_vfs_verify_environment_ssl_certs, m_session);
+                ne_ssl_set_verify (m_session,
+                 neon_vfs_verify_environment_ssl_certs, m_session);
+            }
         }
 
         AUDDBG ("<%p> Creating request\n", this);
@@ -670,15 +1002,23 @@ int NeonFile::open_handle (int64_t startbyte, String * error)
         if (! ret)
             return 0;
 
+        if (ret == 2)
+        {
+            session_pool_release (std::move (m_ns));
+            m_session = nullptr;
+            return 2;
+        }
+
         if (ret == -1)
         {
             ne_session_destroy (m_session);
             m_session = nullptr;
+            m_ns.clear ();
             return -1;
         }
 
         AUDDBG ("<%p> Following redirect...\n", this);
-        ne_session_destroy (m_session);
+        session_pool_release (std::move (m_ns));
         m_session = nullptr;
     }
 
@@ -692,11 +1032,11 @@ int NeonFile::open_handle (int64_t startbyte, String * error)
 
 FillBufferResult NeonFile::fill_buffer ()
 {
-    char buffer[NEON_NETBLKSIZE];
+    char buffer[NEON_READBLKSIZE];
     int to_read;
 
     pthread_mutex_lock (& m_reader_status.mutex);
-    to_read = aud::min (m_rb.space (), NEON_NETBLKSIZE);
+    to_read = aud::min (m_rb.space (), NEON_READBLKSIZE);
     pthread_mutex_unlock (& m_reader_status.mutex);
 
     int bsize = ne_read_response_block (m_request, buffer, to_read);
@@ -718,20 +1058,114 @@ FillBufferResult NeonFile::fill_buffer ()
     AUDDBG ("<%p> Read %d bytes of %d\n", this, bsize, to_read);
 
     pthread_mutex_lock (& m_reader_status.mutex);
-    m_rb.copy_in (buffer, bsize);
+
+    if (m_cacheable)
+        m_cache_accum.insert (buffer, -1, bsize);
+
+    demux_icy (buffer, bsize);
     pthread_mutex_unlock (& m_reader_status.mutex);
 
     return FILL_BUFFER_SUCCESS;
 }
 
+/* Strips ICY metadata announcements out of a network block and inserts the
+ * audio bytes into the ring buffer.  Demuxing here, rather than in the read
+ * path, means the ring holds plain audio: reads are no longer chopped into
+ * interval-sized pieces, and a metadata block is normally parsed straight
+ * out of the network block, without a trip through a staging buffer.
+ * Called with the reader mutex held. */
+/* Streams repeat the same metadata block with every announcement; hash the
+ * raw block and skip parsing (and the string work that comes with it) when
+ * it is identical to the one already parsed. */
+bool NeonFile::icy_unchanged (const char * data, int len)
+{
+    uint32_t hash = 2166136261u; /* FNV-1a */
+
+    for (int i = 0; i < len; i ++)
+        hash = (hash ^ (unsigned char) data[i]) * 16777619u;
+
+    if (m_icy_hash && hash == m_icy_hash)
+        return true;
+
+    m_icy_hash = hash;
+    return false;
+}
+
+void NeonFile::demux_icy (char * data, int len)
+{
+    if (! m_icy_metaint)
+    {
+        m_rb.copy_in (data, len);
+        return;
+    }
+
+    while (len > 0)
+    {
+        if (m_icy_metaleft > 0)
+        {
+            /* audio bytes up to the next announcement */
+            int chunk = aud::min ((int64_t) len, m_icy_metaleft);
+            m_rb.copy_in (data, chunk);
+            m_icy_metaleft -= chunk;
+            data += chunk;
+            len -= chunk;
+            continue;
+        }
+
+        if (! m_icy_len && ! m_icy_buf.len ())
+        {
+            /* the length byte of the announcement */
+            m_icy_len = 16 * (unsigned char) data[0];
+            data ++;
+            len --;
+
+            if (m_icy_len)
+                AUDDBG ("<%p> Expecting %d bytes of ICY metadata\n", this, m_icy_len);
+            else
+                m_icy_metaleft = m_icy_metaint; /* empty announcement */
+
+            continue;
+        }
+
+        if (! m_icy_buf.len () && len >= m_icy_len)
+        {
+            /* the whole announcement is in view; parse it in place */
+            if (! icy_unchanged (data, m_icy_len))
+                parse_icy (& m_icy_metadata, data, m_icy_len);
+            data += m_icy_len;
+            len -= m_icy_len;
+        }
+        else
+        {
+            /* the announcement is split across network blocks; stage it */
+            int chunk = aud::min (len, m_icy_len - m_icy_buf.len ());
+            m_icy_buf.insert (data, -1, chunk);
+            data += chunk;
+            len -= chunk;
+
+            if (m_icy_buf.len () < m_icy_len)
+                continue; /* out of data; len is now zero */
+
+            if (! icy_unchanged (m_icy_buf.begin (), m_icy_buf.len ()))
+                parse_icy (& m_icy_metadata, m_icy_buf.begin (), m_icy_buf.len ());
+
+            m_icy_buf.clear ();
+        }
+
+        m_icy_len = 0;
+        m_icy_metaleft = m_icy_metaint;
+    }
+}
+
 void NeonFile::reader ()
 {
     pthread_mutex_lock (& m_reader_status.mutex);
 
     while (m_reader_status.reading)
     {
-        /* Hit the network only if we have more than NEON_NETBLKSIZE of free buffer */
-        if (m_rb.space () > NEON_NETBLKSIZE)
+        /* Hit the network only if we have more than NEON_NETBLKSIZE of free
+         * buffer and the readahead target has not been met yet */
+        if (m_rb.space () > NEON_NETBLKSIZE && m_rb.len () < m_fill_target)
         {
             pthread_mutex_unlock (& m_reader_status.mutex);
 
@@ -774,6 +1208,49 @@ void NeonFile::reader ()
 
 VFSImpl * NeonTransport::fopen (const char * path, const char * mode, String & error)
 {
+    SmartPtr<CacheObject> obj = object_cache_take (path);
+
+    if (obj)
+    {
+        time_t age = time (nullptr) - obj->stored;
+
+        if (age >= 0 && age < NEON_CACHE_FRESH_SECONDS)
+        {
+            AUDDBG ("Serving %s from cache (age %d s)\n", path, (int) age);
+            return serve_from_cache (std::move (obj));
+        }
+
+        if (obj->etag)
+        {
+            /* stale but revalidatable */
+            NeonFile * file = new NeonFile (path);
+            file->set_validator (obj->etag);
+
+            AUDDBG ("<%p> Revalidating '%s' with neon\n", file, path);
+            int ret = file->open_handle (0, & error);
+
+            if (ret == 2)
+            {
+                /* 304; refresh the entry and serve the cached copy */
+                delete file;
+                obj->stored = time (nullptr);
+                return serve_from_cache (std::move (obj));
+            }
+
+            if (ret != 0)
+            {
+                AUDERR ("<%p> Could not open URL\n", file);
+                delete file;
+                return nullptr;
+            }
+
+            /* modified on the server; stream (and re-cache) the new copy */
+            return file;
+        }
+
+        /* stale with no validator: fall through to a plain refetch */
+    }
+
     NeonFile * file = new NeonFile (path);
 
     AUDDBG ("<%p> Trying to open '%s' with neon\n", file, path);
@@ -802,12 +1279,18 @@ int64_t NeonFile::try_fread (void * ptr, int64_t size, int64_t nmemb, bool & dat
     /* If the buffer is empty, wait for the reader thread to fill it. */
     pthread_mutex_lock (& m_reader_status.mutex);
 
+    m_fill_total += m_rb.len ();
+    m_fill_samples ++;
+
     for (int retries = 0; retries < NEON_RETRY_COUNT; retries ++)
     {
         if (m_rb.len () / size > 0 || ! m_reader_status.reading ||
          m_reader_status.status != NEON_READER_RUN)
             break;
 
+        if (! retries)
+            m_stall_count ++;
+
         pthread_cond_broadcast (& m_reader_status.cond);
         pthread_cond_wait (& m_reader_status.cond, & m_reader_status.mutex);
     }
@@ -917,42 +1400,9 @@ int64_t NeonFile::try_fread (void * ptr, int64_t size, int64_t nmemb, bool & dat
         return 0;
     }
 
+    /* metadata is stripped before insertion, so the whole buffer is audio */
     int64_t belem = m_rb.len () / size;
 
-    if (m_icy_metaint)
-    {
-        if (! m_icy_metaleft)
-        {
-            if (! m_icy_len)
-            {
-                /* The next data in the buffer is a ICY metadata announcement.
-                 * Get the length byte */
-                m_icy_len = 16 * (unsigned char) m_rb.head ();
-                m_rb.pop ();
-
-                AUDDBG ("<%p> Expecting %d bytes of ICY metadata\n", this, m_icy_len);
-            }
-
-            if (m_icy_buf.len () < m_icy_len)
-                m_rb.move_out (m_icy_buf, -1, aud::min (m_icy_len - m_icy_buf.len (), m_rb.len ()));
-
-            if (m_icy_buf.len () >= m_icy_len)
-            {
-                /* Grab the metadata from the buffer and send it to the parser */
-                parse_icy (& m_icy_metadata, m_icy_buf.begin (), m_icy_buf.len ());
-
-                /* Reset countdown to next announcement */
-                m_icy_buf.clear ();
-                m_icy_len = 0;
-                m_icy_metaleft = m_icy_metaint;
-            }
-        }
-
-        /* The maximum number of bytes we can deliver is determined
-         * by the number of bytes left until the next metadata announcement */
-        belem = aud::min ((int64_t) m_rb.len (), m_icy_metaleft) / size;
-    }
-
     nmemb = aud::min (belem, nmemb);
     m_rb.move_out ((char *) ptr, nmemb * size);
 
@@ -971,7 +1421,6 @@ int64_t NeonFile::try_fread (void * ptr, int64_t size, int64_t nmemb, bool & dat
     pthread_mutex_unlock (& m_reader_status.mutex);
 
     m_pos += nmemb * size;
-    m_icy_metaleft -= nmemb * size;
 
     return nmemb;
 }
@@ -1094,6 +1543,32 @@ int NeonFile::fseek (int64_t offset, VFSSeekType whence)
     if (newpos == m_pos)
         return 0;
 
+    /* A short forward seek -- a scrub landing within what the reader has
+     * already buffered -- can be satisfied by discarding bytes from the
+     * ring, keeping the connection and its readahead intact instead of
+     * reissuing the request.  Not done for ICY streams, whose audio-only
+     * positions do not map to server byte offsets. */
+    if (! m_icy_metaint && newpos > m_pos)
+    {
+        pthread_mutex_lock (& m_reader_status.mutex);
+
+        if (newpos - m_pos <= (int64_t) m_rb.len ())
+        {
+            m_rb.discard ((int) (newpos - m_pos));
+            m_pos = newpos;
+
+            /* wake the reader; we just made room */
+            pthread_cond_broadcast (& m_reader_status.cond);
+            pthread_mutex_unlock (& m_reader_status.mutex);
+
+            AUDDBG ("<%p> Seek satisfied from buffered data\n", this);
+            m_eof = false;
+            return 0;
+        }
+
+        pthread_mutex_unlock (& m_reader_status.mutex);
+    }
+
     /* To seek to the new position we have to
      * - stop the current reader thread, if there is one
      * - destroy the current request
@@ -1110,7 +1585,7 @@ int NeonFile::fseek (int64_t offset, VFSSeekType whence)
 
     if (m_session)
     {
-        ne_session_destroy (m_session);
+        session_pool_release (std::move (m_ns));
         m_session = nullptr;
     }
 
@@ -1118,6 +1593,10 @@ int NeonFile::fseek (int64_t offset, VFSSeekType whence)
     m_icy_buf.clear ();
     m_icy_len = 0;
 
+    /* the accumulated body is no longer contiguous from byte zero */
+    m_cacheable = false;
+    m_cache_accum.clear ();
+
     if (open_handle (newpos) != 0)
     {
         AUDERR ("<%p> Error while creating new request!\n", this);
@@ -1135,17 +1614,22 @@ String NeonFile::get_metadata (const char * field)
 {
     AUDDBG ("<%p> Field name: %s\n", this, field);
 
-    if (! strcmp (field, "track-name") && m_icy_metadata.stream_title)
-        return m_icy_metadata.stream_title;
+    /* the reader thread updates these fields under the same mutex */
+    pthread_mutex_lock (& m_reader_status.mutex);
+    icy_metadata meta = m_icy_metadata;
+    pthread_mutex_unlock (& m_reader_status.mutex);
+
+    if (! strcmp (field, "track-name") && meta.stream_title)
+        return meta.stream_title;
 
-    if (! strcmp (field, "stream-name") && m_icy_metadata.stream_name)
-        return m_icy_metadata.stream_name;
+    if (! strcmp (field, "stream-name") && meta.stream_name)
+        return meta.stream_name;
 
-    if (! strcmp (field, "content-type") && m_icy_metadata.stream_contenttype)
-        return m_icy_metadata.stream_contenttype;
+    if (! strcmp (field, "content-type") && meta.stream_contenttype)
+        return meta.stream_contenttype;
 
     if (! strcmp (field, "content-bitrate"))
-        return String (int_to_str (m_icy_metadata.stream_bitrate * 1000));
+        return String (int_to_str (meta.stream_bitrate * 1000));
 
     return String ();
 }
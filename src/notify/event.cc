@@ -26,6 +26,7 @@
 #include <libaudcore/runtime.h>
 #include <libaudcore/audstrings.h>
 #include <libaudcore/hook.h>
+#include <libaudcore/mainloop.h>
 
 #ifdef USE_GTK
 #include <libaudgui/libaudgui.h>
@@ -38,12 +39,21 @@
 static String last_title, last_message;
 static GdkPixbuf * last_pixbuf = nullptr;
 
+/* debounce timer for coalescing rapid tuple changes */
+static QueuedFunc update_timer;
+static bool update_timer_running = false;
+static bool update_pending = false;
+
 #ifdef USE_QT
 static QImage qimage;
 #endif
 
 static void clear_cache ()
 {
+    update_timer.stop ();
+    update_timer_running = false;
+    update_pending = false;
+
     last_title = String ();
     last_message = String ();
 
@@ -103,7 +113,7 @@ static void show_playing ()
         osd_show (last_title, last_message, "audio-x-generic", last_pixbuf);
 }
 
-static void playback_update ()
+static void do_playback_update ()
 {
     Tuple tuple = aud_drct_get_tuple ();
     String title = tuple.get_str (Tuple::Title);
@@ -133,6 +143,37 @@ static void playback_update ()
     show_playing ();
 }
 
+static void update_timer_expired ()
+{
+    if (update_pending)
+    {
+        update_pending = false;
+        do_playback_update ();
+        update_timer.queue (aud_get_int ("notify", "update_window"), update_timer_expired);
+    }
+    else
+        update_timer_running = false;
+}
+
+/* Internet streams can update their metadata every few seconds, often
+ * with partial data, and re-rendering a notification for each change
+ * produces a distracting storm.  The first change after a quiet period
+ * is shown at once; further changes within the update window are
+ * coalesced into a single re-render when the window expires. */
+static void playback_update ()
+{
+    if (update_timer_running)
+    {
+        update_pending = true;
+        return;
+    }
+
+    do_playback_update ();
+
+    update_timer_running = true;
+    update_timer.queue (aud_get_int ("notify", "update_window"), update_timer_expired);
+}
+
 static void playback_paused ()
 {
     if (aud_get_bool ("notify", "resident"))
@@ -74,6 +74,7 @@ const char * const NotifyPlugin::defaults[] = {
  "album", "TRUE",
  "custom_duration_enabled", "FALSE",
  "custom_duration", "1",
+ "update_window", "500",
  nullptr
 };
 
@@ -107,6 +108,8 @@ const PreferencesWidget NotifyPlugin::widgets[] = {
         WidgetBool ("notify", "resident", reinit)),
     WidgetCheck (N_("Include album name in notification"),
         WidgetBool ("notify", "album", reinit)),
+    WidgetSpin (N_("Coalesce rapid metadata updates:"),
+        WidgetInt ("notify", "update_window"), {100, 5000, 100, N_("milliseconds")}),
     WidgetCheck (N_("Custom notification duration:"),
         WidgetBool ("notify", "custom_duration_enabled")),
     WidgetSpin (nullptr,
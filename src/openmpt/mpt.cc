@@ -24,21 +24,216 @@
  * SUCH DAMAGE.
  */
 
+#include <pthread.h>
 #include <string.h>
+#include <time.h>
 
 #include <libaudcore/i18n.h>
+#include <libaudcore/multihash.h>
 #include <libaudcore/plugin.h>
 #include <libaudcore/preferences.h>
+#include <libaudcore/ringbuf.h>
 #include <libaudcore/runtime.h>
 
 #include "mptwrap.h"
 
 static bool force_apply = false;
 
+/* read_tag results memoized by filename so playlist rescans do not re-parse
+ * each module; the file size stands in for a modification time, which the
+ * VFS layer does not provide */
+struct ModuleInfo
+{
+    int64_t file_size = 0;
+    int duration = 0;
+    String title;
+    String format;
+};
+
+static pthread_mutex_t memo_mutex = PTHREAD_MUTEX_INITIALIZER;
+static SimpleHash<String, ModuleInfo> tag_memo;
+static int tag_memo_entries = 0;
+
+/* Quality ladder walked by the adaptive interpolation mode, best last.
+ * When decoding a block costs too large a share of the real time it covers,
+ * quality steps down; it creeps back up only after a sustained calm spell,
+ * so a module hovering near the limit does not flap between filters. */
+static constexpr int interp_steps[] =
+{
+    MPTWrap::interp_none,
+    MPTWrap::interp_linear,
+    MPTWrap::interp_cubic,
+    MPTWrap::interp_windowed,
+};
+
+/* load is evaluated over windows of this much produced audio (seconds) */
+static constexpr double adapt_window = 0.5;
+/* step down when decoding eats this share of real time or more ... */
+static constexpr double adapt_high_load = 0.85;
+/* ... and back up only below this share, after several calm windows */
+static constexpr double adapt_low_load = 0.35;
+static constexpr int adapt_calm_windows = 8;
+
+static double now_seconds()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
 static constexpr const char *CFG_SECTION               = "openmpt";
 static constexpr const char *SETTING_STEREO_SEPARATION = "stereo_separation";
 static constexpr const char *SETTING_INTERPOLATOR      = "interpolator";
 
+/* Pipeline parallelism for dense modules: libopenmpt renders all channels
+ * serially, so a 64-channel IT file can spike past real time on one core.
+ * Rendering therefore runs on its own thread into a ring buffer holding a
+ * few hundred milliseconds of audio, decoupling those spikes from the
+ * output deadline; the play loop only moves finished samples out. */
+
+static constexpr int render_chunk = 4096; /* floats per render call */
+static constexpr int pipeline_ms = 300;   /* ring buffer depth */
+
+/* one block of rendering, including the adaptive-interpolation ladder;
+ * shared between the render thread and the no-thread fallback */
+struct ModRenderer
+{
+    MPTWrap &mpt;
+    bool adaptive = false;
+    int interp_step = aud::n_elems(interp_steps) - 1;
+    double decode_time = 0, audio_time = 0;
+    int calm_windows = 0;
+
+    ModRenderer(MPTWrap &mpt_) : mpt(mpt_) { }
+
+    void apply_settings()
+    {
+        int interp = aud_get_int(CFG_SECTION, SETTING_INTERPOLATOR);
+        adaptive = (interp == MPTWrap::interp_adaptive);
+
+        if (adaptive)
+        {
+            interp_step = aud::n_elems(interp_steps) - 1;
+            interp = interp_steps[interp_step];
+            decode_time = audio_time = 0;
+            calm_windows = 0;
+        }
+
+        mpt.set_interpolator(interp);
+        mpt.set_stereo_separation(aud_get_int(CFG_SECTION, SETTING_STEREO_SEPARATION));
+    }
+
+    size_t render(float *buffer, size_t samples)
+    {
+        if (force_apply)
+        {
+            apply_settings();
+            force_apply = false;
+        }
+
+        double begin = adaptive ? now_seconds() : 0;
+
+        auto n = mpt.read(buffer, samples);
+        if (n == 0)
+            return 0;
+
+        if (adaptive)
+        {
+            decode_time += now_seconds() - begin;
+            audio_time += (double)(n / mpt.channels()) / mpt.rate();
+
+            if (audio_time >= adapt_window)
+            {
+                double load = decode_time / audio_time;
+
+                if (load >= adapt_high_load && interp_step > 0)
+                {
+                    /* losing fidelity beats losing audio */
+                    mpt.set_interpolator(interp_steps[--interp_step]);
+                    calm_windows = 0;
+                    AUDDBG("decode load %.2f, stepping down to filter %d\n",
+                     load, interp_steps[interp_step]);
+                }
+                else if (load < adapt_low_load &&
+                 interp_step < (int)aud::n_elems(interp_steps) - 1 &&
+                 ++calm_windows >= adapt_calm_windows)
+                {
+                    mpt.set_interpolator(interp_steps[++interp_step]);
+                    calm_windows = 0;
+                    AUDDBG("decode load %.2f, stepping up to filter %d\n",
+                     load, interp_steps[interp_step]);
+                }
+                else if (load >= adapt_low_load)
+                    calm_windows = 0;
+
+                decode_time = audio_time = 0;
+            }
+        }
+
+        return n;
+    }
+};
+
+struct RenderPipeline
+{
+    ModRenderer renderer;
+    RingBuf<float> ring;
+    pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+    pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+    int seek = -1;
+    bool quit = false;
+    bool eof = false;
+
+    RenderPipeline(MPTWrap &mpt) : renderer(mpt) { }
+};
+
+static void *render_worker(void *data)
+{
+    auto pipe = (RenderPipeline *)data;
+
+    pthread_mutex_lock(&pipe->mutex);
+
+    while (!pipe->quit)
+    {
+        if (pipe->seek >= 0)
+        {
+            int seek_value = pipe->seek;
+            pipe->seek = -1;
+            pipe->eof = false;
+
+            pthread_mutex_unlock(&pipe->mutex);
+            pipe->renderer.mpt.seek(seek_value);
+            pthread_mutex_lock(&pipe->mutex);
+
+            /* drop anything rendered before the seek took effect */
+            pipe->ring.discard();
+        }
+
+        if (pipe->eof || pipe->ring.space() < render_chunk)
+        {
+            pthread_cond_wait(&pipe->cond, &pipe->mutex);
+            continue;
+        }
+
+        pthread_mutex_unlock(&pipe->mutex);
+
+        float buffer[render_chunk];
+        auto n = pipe->renderer.render(buffer, render_chunk);
+
+        pthread_mutex_lock(&pipe->mutex);
+
+        if (n == 0)
+            pipe->eof = true;
+        else if (pipe->seek < 0)
+            pipe->ring.copy_in(buffer, n);
+
+        pthread_cond_broadcast(&pipe->cond);
+    }
+
+    pthread_mutex_unlock(&pipe->mutex);
+    return nullptr;
+}
+
 class MPTPlugin : public InputPlugin
 {
 public:
@@ -77,13 +272,38 @@ public:
     bool is_our_file(const char *filename, VFSFile &file) override
     {
         MPTWrap mpt;
-        return mpt.open(file);
+        return mpt.open(file, true);
     }
 
     bool read_tag(const char *filename, VFSFile &file, Tuple &tuple, Index<char> *) override
     {
+        int64_t size = file.fsize();
+
+        if (size >= 0)
+        {
+            pthread_mutex_lock(&memo_mutex);
+            ModuleInfo *entry = tag_memo.lookup(String(filename));
+
+            if (entry && entry->file_size == size)
+            {
+                ModuleInfo info = *entry;
+                pthread_mutex_unlock(&memo_mutex);
+
+                tuple.set_filename(filename);
+                tuple.set_format(info.format, MPTWrap::channels(), MPTWrap::rate(), 0);
+                tuple.set_int(Tuple::Length, info.duration);
+
+                if (strlen(info.title) > 0)
+                    tuple.set_str(Tuple::Title, info.title);
+
+                return true;
+            }
+
+            pthread_mutex_unlock(&memo_mutex);
+        }
+
         MPTWrap mpt;
-        if (!mpt.open(file))
+        if (!mpt.open(file, true))
             return false;
 
         tuple.set_filename(filename);
@@ -94,6 +314,33 @@ public:
         if (strlen(title) > 0)
             tuple.set_str(Tuple::Title, title);
 
+        if (size >= 0)
+        {
+            pthread_mutex_lock(&memo_mutex);
+            ModuleInfo *entry = tag_memo.lookup(String(filename));
+
+            if (!entry)
+            {
+                /* primitive size cap; entries are tiny, and dropping the memo
+                 * once in a long while just means parsing those files again */
+                if (tag_memo_entries >= 4096)
+                {
+                    tag_memo.clear();
+                    tag_memo_entries = 0;
+                }
+
+                entry = tag_memo.add(String(filename), ModuleInfo());
+                tag_memo_entries++;
+            }
+
+            entry->file_size = size;
+            entry->duration = mpt.duration();
+            entry->title = title;
+            entry->format = mpt.format();
+
+            pthread_mutex_unlock(&memo_mutex);
+        }
+
         return true;
     }
 
@@ -107,28 +354,83 @@ public:
 
         open_audio(FMT_FLOAT, mpt.rate(), mpt.channels());
 
+        RenderPipeline pipe(mpt);
+        pipe.ring.alloc(aud::max(2 * render_chunk,
+         mpt.rate() * mpt.channels() * pipeline_ms / 1000));
+
+        pthread_t thread;
+        if (pthread_create(&thread, nullptr, render_worker, &pipe) != 0)
+        {
+            /* no thread to be had; render inline as before */
+            while (!check_stop())
+            {
+                float buffer[16384];
+                int seek_value = check_seek();
+
+                if (seek_value >= 0)
+                    mpt.seek(seek_value);
+
+                auto n = pipe.renderer.render(buffer, aud::n_elems(buffer));
+                if (n == 0)
+                    break;
+
+                write_audio(buffer, n * sizeof buffer[0]);
+            }
+
+            return true;
+        }
+
         while (!check_stop())
         {
             float buffer[16384];
             int seek_value = check_seek();
 
+            pthread_mutex_lock(&pipe.mutex);
+
             if (seek_value >= 0)
-                mpt.seek(seek_value);
+            {
+                pipe.seek = seek_value;
+                pipe.eof = false;
+                pipe.ring.discard();
+                pthread_cond_broadcast(&pipe.cond);
+            }
 
-            if (force_apply)
+            if (!pipe.ring.len() && !pipe.eof)
             {
-                mpt.set_interpolator(aud_get_int(CFG_SECTION, SETTING_INTERPOLATOR));
-                mpt.set_stereo_separation(aud_get_int(CFG_SECTION, SETTING_STEREO_SEPARATION));
-                force_apply = false;
+                /* wait briefly for the renderer, then re-poll stop/seek */
+                timespec ts;
+                clock_gettime(CLOCK_REALTIME, &ts);
+                ts.tv_nsec += 50000000;
+                if (ts.tv_nsec >= 1000000000)
+                {
+                    ts.tv_sec++;
+                    ts.tv_nsec -= 1000000000;
+                }
+
+                pthread_cond_timedwait(&pipe.cond, &pipe.mutex, &ts);
             }
 
-            auto n = mpt.read(buffer, aud::n_elems(buffer));
-            if (n == 0)
-                break;
+            int n = aud::min(pipe.ring.len(), (int)aud::n_elems(buffer));
+            if (n > 0)
+                pipe.ring.move_out(buffer, n);
+
+            bool done = (n == 0 && pipe.eof && pipe.seek < 0);
 
-            write_audio(buffer, n * sizeof buffer[0]);
+            pthread_cond_broadcast(&pipe.cond);
+            pthread_mutex_unlock(&pipe.mutex);
+
+            if (done)
+                break;
+            if (n > 0)
+                write_audio(buffer, n * sizeof buffer[0]);
         }
 
+        pthread_mutex_lock(&pipe.mutex);
+        pipe.quit = true;
+        pthread_cond_broadcast(&pipe.cond);
+        pthread_mutex_unlock(&pipe.mutex);
+        pthread_join(thread, nullptr);
+
         return true;
     }
 };
@@ -41,14 +41,24 @@ static String to_aud_str(const char * str)
     return aud_str;
 }
 
-bool MPTWrap::open(VFSFile &file)
+bool MPTWrap::open(VFSFile &file, bool info_only)
 {
 #if OPENMPT_API_VERSION_MAJOR <= 0 && OPENMPT_API_VERSION_MINOR < 3
     auto m = openmpt_module_create(callbacks, &file, openmpt_log_func_silent,
      nullptr, nullptr);
 #else
+    /* Metadata-only opens skip loading sample waveforms, which are the bulk
+     * of most modules; durations come from pattern data, which is still
+     * parsed. */
+    static constexpr openmpt_module_initial_ctl info_ctls[] =
+    {
+        { "load.skip_samples", "1" },
+        { nullptr, nullptr },
+    };
+
     auto m = openmpt_module_create2(callbacks, &file, openmpt_log_func_silent,
-     nullptr, nullptr, nullptr, nullptr, nullptr, nullptr);
+     nullptr, nullptr, nullptr, nullptr, nullptr,
+     info_only ? info_ctls : nullptr);
 #endif
 
     if (m == nullptr)
@@ -89,7 +99,8 @@ bool MPTWrap::is_valid_interpolator(int interpolator_value)
 
 void MPTWrap::set_interpolator(int interpolator_value)
 {
-    if (is_valid_interpolator(interpolator_value))
+    if (interpolator_value != interp_adaptive &&
+     is_valid_interpolator(interpolator_value))
         openmpt_module_set_render_param(mod.get(),
          OPENMPT_MODULE_RENDER_INTERPOLATIONFILTER_LENGTH, interpolator_value);
 }
@@ -36,6 +36,9 @@
 class MPTWrap
 {
 public:
+    /* sentinel handled by the play loop; never passed to libopenmpt */
+    static constexpr int interp_adaptive = 0;
+
     static constexpr int interp_none = 1;
     static constexpr int interp_linear = 2;
     static constexpr int interp_cubic = 4;
@@ -46,6 +49,7 @@ public:
 
     static constexpr ComboItem interpolators[] =
     {
+        {N_("Adaptive (reduce under load)"), interp_adaptive},
         {N_("None"),          interp_none},
         {N_("Linear"),        interp_linear},
         {N_("Cubic"),         interp_cubic},
@@ -58,7 +62,7 @@ public:
     static bool is_valid_stereo_separation(int);
     void set_stereo_separation(int);
 
-    bool open(VFSFile &);
+    bool open(VFSFile &, bool info_only = false);
     int64_t read(float *, int64_t);
     void seek(int pos);
 
@@ -19,6 +19,7 @@
 
 #include <cstdlib>
 #include <cstring>
+#include <pthread.h>
 
 #include <glib.h>
 #include <opus/opusfile.h>
@@ -64,27 +65,171 @@ private:
 
 EXPORT OpusPlugin aud_plugin_instance;
 
+/*
+ * Background reader for network streams: keeps up to about a second of
+ * compressed data buffered ahead of the decoder, so transient transport
+ * stalls are absorbed here instead of reaching the output buffer.  Streams
+ * cannot seek, so the buffer is strictly first-in, first-out.
+ */
+class StreamPrefetch
+{
+public:
+    void start(VFSFile & file)
+    {
+        m_file = &file;
+        m_limit = DEFAULT_LIMIT;
+        m_stop = m_eof = m_error = false;
+        m_buffer.resize(0);
+        m_drained = 0;
+
+        m_started = !pthread_create(&m_thread, nullptr, worker, this);
+    }
+
+    void stop()
+    {
+        if (!m_started)
+            return;
+
+        pthread_mutex_lock(&m_mutex);
+        m_stop = true;
+        pthread_cond_broadcast(&m_cond);
+        pthread_mutex_unlock(&m_mutex);
+
+        pthread_join(m_thread, nullptr);
+        m_started = false;
+        m_buffer.clear();
+    }
+
+    /* about a second of data at the stream's bitrate */
+    void set_bitrate(int bitrate)
+    {
+        pthread_mutex_lock(&m_mutex);
+        m_limit = aud::clamp(bitrate / 8, MIN_LIMIT, MAX_LIMIT);
+        pthread_cond_broadcast(&m_cond);
+        pthread_mutex_unlock(&m_mutex);
+    }
+
+    /* same contract as fread: bytes read, 0 at EOF, -1 on error */
+    int read(unsigned char * buf, int size)
+    {
+        pthread_mutex_lock(&m_mutex);
+
+        while (!buffered() && !m_eof && !m_error && !m_stop)
+            pthread_cond_wait(&m_cond, &m_mutex);
+
+        int copy = aud::min(size, buffered());
+        if (copy > 0)
+        {
+            memcpy(buf, &m_buffer[m_drained], copy);
+            m_drained += copy;
+
+            /* reclaim the drained prefix once in a while */
+            if (m_drained >= m_limit)
+            {
+                m_buffer.remove(0, m_drained);
+                m_drained = 0;
+            }
+
+            pthread_cond_broadcast(&m_cond);
+        }
+
+        bool error = m_error;
+        pthread_mutex_unlock(&m_mutex);
+
+        return (!copy && error) ? -1 : copy;
+    }
+
+private:
+    static constexpr int CHUNK = 16384;
+    static constexpr int MIN_LIMIT = 64 * 1024;
+    static constexpr int DEFAULT_LIMIT = 256 * 1024;
+    static constexpr int MAX_LIMIT = 1024 * 1024;
+
+    int buffered() const { return m_buffer.len() - m_drained; }
+
+    static void * worker(void * data)
+    {
+        auto * p = static_cast<StreamPrefetch *>(data);
+        char chunk[CHUNK];
+
+        while (1)
+        {
+            pthread_mutex_lock(&p->m_mutex);
+
+            while (p->buffered() >= p->m_limit && !p->m_stop)
+                pthread_cond_wait(&p->m_cond, &p->m_mutex);
+
+            bool stop = p->m_stop;
+            pthread_mutex_unlock(&p->m_mutex);
+
+            if (stop)
+                break;
+
+            /* the (possibly slow) transport read happens unlocked */
+            int64_t got = p->m_file->fread(chunk, 1, sizeof chunk);
+
+            pthread_mutex_lock(&p->m_mutex);
+
+            if (got > 0)
+                p->m_buffer.insert(chunk, -1, got);
+            else if (got == 0)
+                p->m_eof = true;
+            else
+                p->m_error = true;
+
+            pthread_cond_broadcast(&p->m_cond);
+            bool done = p->m_eof || p->m_error;
+            pthread_mutex_unlock(&p->m_mutex);
+
+            if (done)
+                break;
+        }
+
+        return nullptr;
+    }
+
+    VFSFile * m_file = nullptr;
+    Index<char> m_buffer;
+    int m_drained = 0;
+    int m_limit = DEFAULT_LIMIT;
+    bool m_stop = false, m_eof = false, m_error = false, m_started = false;
+    pthread_t m_thread;
+    pthread_mutex_t m_mutex = PTHREAD_MUTEX_INITIALIZER;
+    pthread_cond_t m_cond = PTHREAD_COND_INITIALIZER;
+};
+
+/* handle passed to the opusfile callbacks */
+struct OpusReader
+{
+    VFSFile * file;
+    StreamPrefetch * prefetch; /* only set for network streams */
+};
+
 static int opcb_read(void * stream, unsigned char * buf, int size)
 {
-    VFSFile * file = static_cast<VFSFile *>(stream);
-    return file->fread(buf, 1, size);
+    OpusReader * reader = static_cast<OpusReader *>(stream);
+
+    if (reader->prefetch)
+        return reader->prefetch->read(buf, size);
+
+    return reader->file->fread(buf, 1, size);
 }
 
 static int opcb_seek(void * stream, opus_int64 offset, int whence)
 {
-    VFSFile * file = static_cast<VFSFile *>(stream);
-    return file->fseek(offset, to_vfs_seek_type(whence));
+    OpusReader * reader = static_cast<OpusReader *>(stream);
+    return reader->file->fseek(offset, to_vfs_seek_type(whence));
 }
 
 static opus_int64 opcb_tell(void * stream)
 {
-    VFSFile * file = static_cast<VFSFile *>(stream);
-    return file->ftell();
+    OpusReader * reader = static_cast<OpusReader *>(stream);
+    return reader->file->ftell();
 }
 
-static OggOpusFile * open_file(VFSFile & file)
+static OggOpusFile * open_file(OpusReader & reader)
 {
-    bool stream = file.fsize() < 0;
+    bool stream = reader.file->fsize() < 0;
 
     OpusFileCallbacks opus_callbacks = {
         opcb_read,
@@ -93,7 +238,7 @@ static OggOpusFile * open_file(VFSFile & file)
         nullptr
     };
 
-    return op_open_callbacks(&file, &opus_callbacks, nullptr, 0, nullptr);
+    return op_open_callbacks(&reader, &opus_callbacks, nullptr, 0, nullptr);
 }
 
 static void read_tags(const OpusTags * tags, Tuple & tuple)
@@ -302,7 +447,8 @@ bool OpusPlugin::is_our_file(const char * filename, VFSFile & file)
 bool OpusPlugin::read_tag(const char * filename, VFSFile & file, Tuple & tuple,
                           Index<char> * image)
 {
-    OggOpusFile * opus_file = open_file(file);
+    OpusReader reader = {&file, nullptr};
+    OggOpusFile * opus_file = open_file(reader);
     if (!opus_file)
         return false;
 
@@ -326,9 +472,23 @@ bool OpusPlugin::read_tag(const char * filename, VFSFile & file, Tuple & tuple,
 
 bool OpusPlugin::play(const char * filename, VFSFile & file)
 {
-    OggOpusFile * opus_file = open_file(file);
+    bool stream = file.fsize() < 0;
+
+    StreamPrefetch prefetch;
+    OpusReader reader = {&file, nullptr};
+
+    if (stream)
+    {
+        prefetch.start(file);
+        reader.prefetch = &prefetch;
+    }
+
+    OggOpusFile * opus_file = open_file(reader);
     if (!opus_file)
+    {
+        prefetch.stop();
         return false;
+    }
 
     Index<float> pcm_out;
     pcm_out.resize(pcm_bufsize * sizeof(float));
@@ -340,6 +500,9 @@ bool OpusPlugin::play(const char * filename, VFSFile & file)
 
     set_stream_bitrate(m_bitrate);
 
+    if (stream)
+        prefetch.set_bitrate(m_bitrate > 0 ? m_bitrate : 128000);
+
     if (update_tuple(opus_file, tuple))
         set_playback_tuple(tuple.ref());
 
@@ -399,6 +562,7 @@ bool OpusPlugin::play(const char * filename, VFSFile & file)
     }
 
     op_free(opus_file);
+    prefetch.stop();
     return !error;
 }
 
@@ -24,7 +24,9 @@
 
 #include <errno.h>
 #include <poll.h>
+#include <pthread.h>
 #include <string.h>
+#include <time.h>
 
 #include <libaudcore/audstrings.h>
 #include <libaudcore/runtime.h>
@@ -47,6 +49,40 @@ const char * const OSSPlugin::defaults[] = {
 static int poll_pipe[2];
 static pollfd poll_handles[2];
 
+/* Device probe/open runs on a worker thread so a slow device node does not
+ * stall the playback thread; the decoder prebuffers into open_prebuffer
+ * meanwhile and the audio is pushed to the device once it is live. */
+enum {OPEN_IDLE, OPEN_PENDING, OPEN_LIVE, OPEN_FAILED};
+
+static pthread_mutex_t open_mutex = PTHREAD_MUTEX_INITIALIZER;
+static int open_state = OPEN_IDLE;
+static Index<char> open_prebuffer;
+static int open_prebuffer_limit;
+
+struct OpenRequest
+{
+    OSSPlugin *plugin;
+    int format, rate, channels;
+};
+
+static int open_state_get()
+{
+    pthread_mutex_lock(&open_mutex);
+    int state = open_state;
+    pthread_mutex_unlock(&open_mutex);
+    return state;
+}
+
+/* waits for the open worker to finish, successfully or not */
+static void open_settle()
+{
+    while (open_state_get() == OPEN_PENDING)
+    {
+        timespec delay = {0, 10000000}; /* 10 ms */
+        nanosleep(&delay, nullptr);
+    }
+}
+
 bool OSSPlugin::init()
 {
     AUDDBG("Init.\n");
@@ -220,7 +256,53 @@ bool OSSPlugin::open_audio(int aud_format, int rate, int channels, String &error
 {
     AUDDBG("Opening audio.\n");
 
-    int format;
+    int format = oss_convert_aud_format(aud_format);
+
+    if (format < 0)
+    {
+        error = String("Unsupported audio format");
+        return false;
+    }
+
+    /* provisional values so that delay/buffer math works while the worker is
+     * still negotiating; set_format() overwrites them with negotiated ones */
+    m_format = format;
+    m_rate = rate;
+    m_channels = channels;
+    m_bytes_per_sample = oss_format_to_bytes(format);
+
+    open_prebuffer.clear();
+    open_prebuffer_limit = frames_to_bytes(aud::rescale(
+     aud_get_int("output_buffer_size"), 1000, rate));
+    open_state = OPEN_PENDING;
+
+    pthread_t thread;
+    pthread_create(&thread, nullptr, open_worker,
+     new OpenRequest {this, format, rate, channels});
+    pthread_detach(thread);
+
+    return true;
+}
+
+void *OSSPlugin::open_worker(void *arg)
+{
+    auto req = (OpenRequest *)arg;
+    String error;
+
+    bool ok = req->plugin->open_sync(req->format, req->rate, req->channels, error);
+    if (!ok)
+        AUDERR("%s\n", (const char *)error);
+
+    pthread_mutex_lock(&open_mutex);
+    open_state = ok ? OPEN_LIVE : OPEN_FAILED;
+    pthread_mutex_unlock(&open_mutex);
+
+    delete req;
+    return nullptr;
+}
+
+bool OSSPlugin::open_sync(int format, int rate, int channels, String &error)
+{
     audio_buf_info buf_info;
     bool poll_was_setup = false;
 
@@ -231,12 +313,6 @@ bool OSSPlugin::open_audio(int aud_format, int rate, int channels, String &error
     else
         goto FAILED;
 
-    if ((format = oss_convert_aud_format(aud_format)) < 0)
-    {
-        error = String("Unsupported audio format");
-        goto FAILED;
-    }
-
     if (!set_format(format, rate, channels, error))
         goto FAILED;
 
@@ -270,12 +346,60 @@ void OSSPlugin::close_audio()
 {
     AUDDBG("Closing audio.\n");
 
-    poll_cleanup();
-    close_device(m_fd);
+    open_settle();
+    open_prebuffer.clear();
+
+    if (open_state == OPEN_LIVE)
+    {
+        poll_cleanup();
+        close_device(m_fd);
+    }
+
+    open_state = OPEN_IDLE;
 }
 
 int OSSPlugin::write_audio(const void *data, int length)
 {
+    pthread_mutex_lock(&open_mutex);
+
+    if (open_state == OPEN_PENDING)
+    {
+        length = aud::min(length, open_prebuffer_limit - open_prebuffer.len());
+        open_prebuffer.insert((const char *)data, -1, length);
+        pthread_mutex_unlock(&open_mutex);
+        return length;
+    }
+
+    if (open_state == OPEN_FAILED)
+    {
+        /* no device to play to; swallow the audio, but at real-time pace, so
+         * a dead device behaves like muted playback instead of racing through
+         * the playlist */
+        pthread_mutex_unlock(&open_mutex);
+
+        int64_t ns = bytes_to_frames(length) * (int64_t)1000000000 / m_rate;
+        timespec delay = {(time_t)(ns / 1000000000), (long)(ns % 1000000000)};
+        nanosleep(&delay, nullptr);
+
+        return length;
+    }
+
+    if (open_prebuffer.len())
+    {
+        /* audio buffered while the device was opening goes out first */
+        int written = write(m_fd, open_prebuffer.begin(), open_prebuffer.len());
+        if (written > 0)
+            open_prebuffer.remove(0, written);
+
+        if (open_prebuffer.len())
+        {
+            pthread_mutex_unlock(&open_mutex);
+            return 0;
+        }
+    }
+
+    pthread_mutex_unlock(&open_mutex);
+
     int written = write(m_fd, data, length);
 
     if (written < 0)
@@ -291,6 +415,14 @@ int OSSPlugin::write_audio(const void *data, int length)
 
 void OSSPlugin::period_wait()
 {
+    if (open_state_get() != OPEN_LIVE)
+    {
+        /* no descriptor to poll yet (or ever); just pace the decoder */
+        timespec delay = {0, 10000000}; /* 10 ms */
+        nanosleep(&delay, nullptr);
+        return;
+    }
+
     poll_sleep();
 }
 
@@ -298,6 +430,28 @@ void OSSPlugin::drain()
 {
     AUDDBG("Drain.\n");
 
+    open_settle();
+
+    if (open_state_get() != OPEN_LIVE)
+        return;
+
+    pthread_mutex_lock(&open_mutex);
+
+    while (open_prebuffer.len())
+    {
+        int written = write(m_fd, open_prebuffer.begin(), open_prebuffer.len());
+        if (written > 0)
+            open_prebuffer.remove(0, written);
+        else
+        {
+            pthread_mutex_unlock(&open_mutex);
+            poll_sleep();
+            pthread_mutex_lock(&open_mutex);
+        }
+    }
+
+    pthread_mutex_unlock(&open_mutex);
+
     if (ioctl(m_fd, SNDCTL_DSP_SYNC, nullptr) == -1)
         DESCRIBE_ERROR;
 }
@@ -305,16 +459,35 @@ void OSSPlugin::drain()
 int OSSPlugin::get_delay()
 {
     int delay_bytes = 0;
+    int pre_bytes;
+    bool live;
+
+    pthread_mutex_lock(&open_mutex);
+    pre_bytes = open_prebuffer.len();
+    live = (open_state == OPEN_LIVE);
+    pthread_mutex_unlock(&open_mutex);
+
+    if (! live)
+        goto FAILED;
+
     CHECK(ioctl, m_fd, SNDCTL_DSP_GETODELAY, &delay_bytes);
 
 FAILED:
-    return aud::rescale<int64_t>(bytes_to_frames(delay_bytes), m_rate, 1000);
+    return aud::rescale<int64_t>(bytes_to_frames(delay_bytes + pre_bytes), m_rate, 1000);
 }
 
 void OSSPlugin::flush()
 {
     AUDDBG("Flush.\n");
 
+    pthread_mutex_lock(&open_mutex);
+    open_prebuffer.clear();
+    bool live = (open_state == OPEN_LIVE);
+    pthread_mutex_unlock(&open_mutex);
+
+    if (! live)
+        return;
+
     CHECK(ioctl, m_fd, SNDCTL_DSP_RESET, nullptr);
 
 FAILED:
@@ -325,6 +498,9 @@ void OSSPlugin::pause(bool pause)
 {
     AUDDBG("%sause.\n", pause ? "P" : "Unp");
 
+    if (open_state_get() != OPEN_LIVE)
+        return;
+
 #ifdef SNDCTL_DSP_SILENCE
     if (pause)
         CHECK(ioctl, m_fd, SNDCTL_DSP_SILENCE, nullptr);
@@ -100,6 +100,9 @@ public:
     void flush() override;
 
 private:
+    bool open_sync(int format, int rate, int channels, String &error);
+    static void *open_worker(void *arg);
+
     bool set_format(int format, int rate, int channels, String &error);
     bool set_buffer(String &error);
 
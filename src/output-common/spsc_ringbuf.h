@@ -0,0 +1,155 @@
+/*
+ * Lock-free ring buffer for output plugins
+ * Copyright 2026 Audacious developers
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions, and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions, and the following disclaimer in the documentation
+ *    provided with the distribution.
+ *
+ * This software is provided "as is" and without any warranty, express or
+ * implied. In no event shall the authors be liable for any damages arising from
+ * the use of this software.
+ */
+
+#ifndef AUDACIOUS_SPSC_RINGBUF_H
+#define AUDACIOUS_SPSC_RINGBUF_H
+
+#include <atomic>
+#include <string.h>
+
+#include <libaudcore/templates.h>
+
+/*
+ * Single-producer/single-consumer ring buffer for handing samples from the
+ * playback thread to a realtime device callback without taking a mutex on
+ * either side.  Unlike RingBuf, copy_in() and move_out() may safely run
+ * concurrently: the producer only stores the head index and the consumer only
+ * stores the tail index, each with release semantics after touching the data.
+ * The indices live on separate cache lines to avoid false sharing between the
+ * two threads.
+ *
+ * The buffer does not resize and does not throw; alloc() rounds the requested
+ * size up to a power of two so the indices can wrap for free.  discard() may
+ * be called from the producer side while the consumer is running; at worst
+ * the consumer replays the block it was already copying out.
+ */
+
+template<class T>
+class SPSCRingBuf
+{
+public:
+    constexpr SPSCRingBuf () = default;
+
+    SPSCRingBuf (const SPSCRingBuf &) = delete;
+    void operator= (const SPSCRingBuf &) = delete;
+
+    ~SPSCRingBuf ()
+        { destroy (); }
+
+    void alloc (int size)
+    {
+        destroy ();
+
+        m_size = 1;
+        while (m_size < size)
+            m_size <<= 1;
+
+        m_data = new T[m_size];
+    }
+
+    void destroy ()
+    {
+        delete[] m_data;
+        m_data = nullptr;
+        m_size = 0;
+        m_head.store (0, std::memory_order_relaxed);
+        m_tail.store (0, std::memory_order_relaxed);
+    }
+
+    int size () const
+        { return m_size; }
+
+    /* callable from either thread */
+    int len () const
+    {
+        return (int) (m_head.load (std::memory_order_acquire) -
+                      m_tail.load (std::memory_order_acquire));
+    }
+
+    int space () const
+        { return m_size - len (); }
+
+    /* producer side */
+    int copy_in (const T * from, int count)
+    {
+        size_t head = m_head.load (std::memory_order_relaxed);
+        size_t tail = m_tail.load (std::memory_order_acquire);
+
+        count = aud::min (count, m_size - (int) (head - tail));
+
+        int offset = head & (m_size - 1);
+        int part = aud::min (count, m_size - offset);
+
+        memcpy (m_data + offset, from, part * sizeof (T));
+        memcpy (m_data, from + part, (count - part) * sizeof (T));
+
+        m_head.store (head + count, std::memory_order_release);
+        return count;
+    }
+
+    /* consumer side */
+    int move_out (T * to, int count)
+    {
+        size_t head = m_head.load (std::memory_order_acquire);
+        size_t tail = m_tail.load (std::memory_order_relaxed);
+
+        count = aud::min (count, (int) (head - tail));
+
+        int offset = tail & (m_size - 1);
+        int part = aud::min (count, m_size - offset);
+
+        memcpy (to, m_data + offset, part * sizeof (T));
+        memcpy (to + part, m_data, (count - part) * sizeof (T));
+
+        m_tail.store (tail + count, std::memory_order_release);
+        return count;
+    }
+
+    /* consumer side: length of the contiguous readable run at the tail */
+    int linear () const
+    {
+        int offset = m_tail.load (std::memory_order_relaxed) & (m_size - 1);
+        return aud::min (len (), m_size - offset);
+    }
+
+    /* consumer side: start of the contiguous readable run; the producer will
+     * not touch these elements until they are consume()d */
+    T * tail_data ()
+        { return m_data + (m_tail.load (std::memory_order_relaxed) & (m_size - 1)); }
+
+    /* consumer side: release elements previously read through tail_data() */
+    void consume (int count)
+    {
+        m_tail.store (m_tail.load (std::memory_order_relaxed) + count,
+         std::memory_order_release);
+    }
+
+    /* producer side; see caveat above */
+    void discard ()
+        { m_tail.store (m_head.load (std::memory_order_acquire), std::memory_order_release); }
+
+private:
+    T * m_data = nullptr;
+    int m_size = 0;
+
+    alignas (64) std::atomic<size_t> m_head {0};
+    alignas (64) std::atomic<size_t> m_tail {0};
+};
+
+#endif
@@ -23,14 +23,18 @@
 #include <cstring>
 
 #include <pipewire/pipewire.h>
+#include <spa/node/io.h>
 #include <spa/param/audio/format-utils.h>
 #include <spa/param/props.h>
 
 #include <libaudcore/i18n.h>
+#include <libaudcore/index.h>
 #include <libaudcore/plugin.h>
 #include <libaudcore/ringbuf.h>
 #include <libaudcore/runtime.h>
 
+#include "../ui-common/output-stats.h"
+
 #if !PW_CHECK_VERSION(0, 3, 50)
 static inline int pw_stream_get_time_n(struct pw_stream * stream,
                                        struct pw_time * time, size_t size)
@@ -82,6 +86,8 @@ public:
     void pause(bool pause) override;
     void flush() override;
 
+    int take_message(const char * code, const void * data, int size) override;
+
 private:
     bool init_core();
     bool init_stream();
@@ -95,9 +101,12 @@ private:
                                          const struct spa_dict * props);
     static void on_state_changed(void * data, enum pw_stream_state old,
                                  enum pw_stream_state state, const char * error);
+    static void on_io_changed(void * data, uint32_t id, void * area, uint32_t size);
     static void on_process(void * data);
     static void on_drained(void * data);
 
+    void resize_buffer(unsigned int size);
+
     static enum spa_audio_format to_pipewire_format(int format);
     static void set_channel_map(struct spa_audio_info_raw * info, int channels);
 
@@ -120,6 +129,7 @@ private:
 
     RingBuf<unsigned char> m_buffer;
     unsigned int m_pw_buffer_size = 0;
+    unsigned int m_quantum = 0;
     unsigned int m_frames = 0;
     unsigned int m_stride = 0;
     unsigned int m_rate = 0;
@@ -128,6 +138,9 @@ private:
 
 EXPORT PipeWireOutput aud_plugin_instance;
 
+// cumulative process-cycle counters; updated with the thread loop locked
+static OutputStats pw_stats;
+
 const char PipeWireOutput::about[] =
  N_("PipeWire Output Plugin for Audacious\n"
     "Copyright 2022 Thomas Lange\n\n"
@@ -239,6 +252,26 @@ void PipeWireOutput::period_wait()
     pw_thread_loop_unlock(m_loop);
 }
 
+int PipeWireOutput::take_message(const char * code, const void * data, int size)
+{
+    if (!strcmp(code, OUTPUT_STATS_QUERY) && size == sizeof(OutputStats))
+    {
+        if (m_loop)
+            pw_thread_loop_lock(m_loop);
+
+        pw_stats.buffer_fill = m_buffer.size()
+                                   ? m_buffer.len() * 100 / m_buffer.size() : 0;
+        *(OutputStats *)data = pw_stats;
+
+        if (m_loop)
+            pw_thread_loop_unlock(m_loop);
+
+        return 0;
+    }
+
+    return -1;
+}
+
 int PipeWireOutput::write_audio(const void * data, int length)
 {
     pw_thread_loop_lock(m_loop);
@@ -404,6 +437,7 @@ bool PipeWireOutput::init_stream()
     static const struct pw_stream_events stream_events = {
         .version = PW_VERSION_STREAM_EVENTS,
         .state_changed = PipeWireOutput::on_state_changed,
+        .io_changed = PipeWireOutput::on_io_changed,
         .process = PipeWireOutput::on_process,
         .drained = PipeWireOutput::on_drained
     };
@@ -531,42 +565,95 @@ void PipeWireOutput::on_state_changed(void * data, enum pw_stream_state old,
     }
 }
 
+void PipeWireOutput::resize_buffer(unsigned int size)
+{
+    Index<unsigned char> stash;
+    stash.resize(m_buffer.len());
+    m_buffer.move_out(stash.begin(), stash.len());
+
+    m_buffer.destroy();
+    m_buffer.alloc(size);
+    m_buffer.copy_in(stash.begin(), stash.len());
+}
+
+void PipeWireOutput::on_io_changed(void * data, uint32_t id, void * area, uint32_t size)
+{
+    PipeWireOutput * o = static_cast<PipeWireOutput *>(data);
+
+    if (id != SPA_IO_Position || !area || size < sizeof(struct spa_io_position))
+        return;
+
+    auto position = static_cast<struct spa_io_position *>(area);
+    auto quantum = static_cast<unsigned int>(position->clock.duration);
+
+    if (!quantum || quantum == o->m_quantum)
+        return;
+
+    AUDDBG("PipeWireOutput: graph quantum changed to %u frames\n", quantum);
+    o->m_quantum = quantum;
+
+    // Keep room for at least two quanta so that one wakeup can refill
+    // the graph without forcing write_audio() to block mid-cycle.
+    unsigned int needed = 2 * quantum * o->m_stride;
+    if (static_cast<unsigned int>(o->m_buffer.size()) < needed)
+        o->resize_buffer(needed);
+}
+
 void PipeWireOutput::on_process(void * data)
 {
     PipeWireOutput * o = static_cast<PipeWireOutput *>(data);
     struct pw_buffer * b;
-    struct spa_buffer * buf;
-    void * dst;
 
     if (!o->m_buffer.len())
     {
+        // the graph asked for audio we could not supply
+        pw_stats.underruns++;
         pw_thread_loop_signal(o->m_loop, false);
         return;
     }
 
-    if (!(b = pw_stream_dequeue_buffer(o->m_stream)))
-    {
-        AUDWARN("PipeWireOutput: out of buffers\n");
-        return;
-    }
+    uint64_t begin = output_stats_now();
 
-    buf = b->buffer;
+    // Fill as many buffers as the stream will hand out so that a single
+    // wakeup can cover several graph quanta.
+    unsigned int queued = 0;
 
-    if (!(dst = buf->datas[0].data))
+    while (o->m_buffer.len() && (b = pw_stream_dequeue_buffer(o->m_stream)))
     {
-        AUDWARN("PipeWireOutput: no data pointer\n");
-        return;
+        struct spa_buffer * buf = b->buffer;
+        void * dst = buf->datas[0].data;
+
+        if (!dst)
+        {
+            AUDWARN("PipeWireOutput: no data pointer\n");
+            pw_stream_queue_buffer(o->m_stream, b);
+            break;
+        }
+
+        auto size = aud::min<uint32_t>(buf->datas[0].maxsize, o->m_buffer.len());
+
+#if PW_CHECK_VERSION(0, 3, 49)
+        // honor the quantum requested for this cycle
+        if (b->requested)
+            size = aud::min<uint32_t>(size, b->requested * o->m_stride);
+#endif
+
+        o->m_buffer.move_out(static_cast<unsigned char *>(dst), size);
+
+        buf->datas[0].chunk->offset = 0;
+        buf->datas[0].chunk->size = size;
+        buf->datas[0].chunk->stride = o->m_stride;
+
+        pw_stream_queue_buffer(o->m_stream, b);
+        queued += size;
     }
 
-    auto size = aud::min<uint32_t>(buf->datas[0].maxsize, o->m_buffer.len());
-    o->m_pw_buffer_size = size;
-    o->m_buffer.move_out(static_cast<unsigned char *>(dst), size);
+    o->m_pw_buffer_size = queued;
 
-    b->buffer->datas[0].chunk->offset = 0;
-    b->buffer->datas[0].chunk->size = size;
-    b->buffer->datas[0].chunk->stride = o->m_stride;
+    pw_stats.blocks++;
+    pw_stats.frames += queued / o->m_stride;
+    pw_stats.busy_ns += output_stats_now() - begin;
 
-    pw_stream_queue_buffer(o->m_stream, b);
     pw_thread_loop_signal(o->m_loop, false);
 }
 
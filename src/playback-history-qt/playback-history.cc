@@ -21,10 +21,13 @@
 #include <utility>
 
 #include <QAbstractListModel>
+#include <QDataStream>
 #include <QEvent>
 #include <QFont>
 #include <QMetaObject>
 #include <QPointer>
+#include <QTemporaryFile>
+#include <QVector>
 
 #include <libaudcore/audstrings.h>
 #include <libaudcore/hook.h>
@@ -53,9 +56,12 @@ private:
            "Copyright 2023-2024 Igor Kushnir <igorkuo@gmail.com>\n\n"
            "This plugin tracks and provides access to playback history.\n\n"
 
-           "History entries are stored only in memory and are lost\n"
-           "on Audacious exit. When the plugin is disabled,\n"
-           "playback history is not tracked at all.\n"
+           "History entries are lost on Audacious exit. When the plugin\n"
+           "is disabled, playback history is not tracked at all.\n"
+           "Only the most recently played entries are kept in memory;\n"
+           "older ones are spilled to a temporary file and read back\n"
+           "when the list is scrolled, so memory use stays bounded\n"
+           "no matter how long the history grows.\n"
            "History entries are only added, never removed automatically.\n"
            "The user can remove selected entries by pressing the Delete key.\n"
            "Restart Audacious or disable the plugin by closing\n"
@@ -103,6 +109,19 @@ public:
      */
     HistoryEntry() = default;
 
+    /**
+     * Recreates an entry from its saved fields.
+     *
+     * Call this constructor when a spilled entry is read back from the
+     * history log.
+     */
+    HistoryEntry(String text, Playlist playlist, int playlistPosition,
+                 Type type)
+        : m_text(std::move(text)), m_playlist(playlist),
+          m_playlistPosition(playlistPosition), m_type(type)
+    {
+    }
+
     /**
      * Stores the currently playing entry in @c this.
      *
@@ -226,6 +245,9 @@ public:
     bool removeRows(int row, int count,
                     const QModelIndex & parent = QModelIndex()) override;
 
+    bool canFetchMore(const QModelIndex & parent) const override;
+    void fetchMore(const QModelIndex & parent) override;
+
 private:
     enum
     {
@@ -233,7 +255,28 @@ private:
         NColumns
     };
 
-    // In this class the word "position" refers to an index into m_entries.
+    /** The number of entries kept in memory before the oldest ones are
+     * spilled to the history log. */
+    static constexpr int maxLoadedEntries = 1000;
+    /** The number of entries written to and read back from the history log
+     * at a time. */
+    static constexpr int pageSize = 200;
+
+    // In this class the word "position" refers to an index into the entire
+    // history, in playback order: 0 is the oldest entry ever recorded. The
+    // oldest m_unloaded entries exist only in the history log; the rest
+    // reside in m_entries, at index [position - m_unloaded].
+
+    int totalCount() const { return m_unloaded + m_entries.len(); }
+
+    HistoryEntry & entryAt(int position)
+    {
+        return m_entries[position - m_unloaded];
+    }
+    const HistoryEntry & entryAt(int position) const
+    {
+        return m_entries[position - m_unloaded];
+    }
 
     bool isModelRowOutOfBounds(int row) const;
     bool isOutOfBounds(const QModelIndex & index) const;
@@ -254,6 +297,55 @@ private:
      */
     void playbackStarted();
 
+    /**
+     * Creates the history log on first use.
+     *
+     * @return @c true if the log is open and writable.
+     */
+    bool openLog();
+
+    /**
+     * Returns the index of @p playlist in @a m_playlists, appending it first
+     * if it has not been referenced from the history log yet.
+     */
+    int playlistRef(const Playlist & playlist);
+
+    /**
+     * Appends one record for @p entry to the history log.
+     *
+     * The caller must check the stream status afterwards.
+     */
+    void writeRecord(QDataStream & stream, const HistoryEntry & entry);
+
+    /**
+     * Reads one record from the history log into @p entry.
+     *
+     * @return @c true if a valid record was read.
+     */
+    bool readRecord(QDataStream & stream, HistoryEntry & entry);
+
+    /**
+     * Spills the oldest in-memory entries to the history log once their
+     * number exceeds @a maxLoadedEntries.
+     *
+     * The spilled entries lose their model rows; scrolling to the bottom of
+     * the view pages them back in via fetchMore().
+     */
+    void maybeSpill();
+
+    /**
+     * Removes the records at positions [@p removeBegin, @p removeEnd) from
+     * the history log by streaming the survivors into a replacement log.
+     */
+    void rewriteLog(int removeBegin, int removeEnd);
+
+    /**
+     * Abandons the history log after an I/O failure.
+     *
+     * The entries still in memory are kept; the spilled ones are lost.
+     */
+    void dropSpilledEntries();
+
     const HookReceiver<HistoryModel> activate_hook{
         "playback ready", this, &HistoryModel::playbackStarted};
 
@@ -264,6 +356,19 @@ private:
     bool m_areRowsBeingRemoved = false;
     /** a cached font used to highlight the item that is currently playing */
     QFont m_currentlyPlaingFont;
+
+    /** an append-only log of spilled entries, created on first spill */
+    QTemporaryFile * m_logFile = nullptr;
+    /** the log offset of every @a pageSize -th record, for seeking */
+    QVector<qint64> m_chunkOffsets;
+    /** the distinct playlists referenced from the history log */
+    Index<Playlist> m_playlists;
+    /** the number of records in the log (positions [0, m_spilledTotal)) */
+    int m_spilledTotal = 0;
+    /** the number of oldest entries present only in the log */
+    int m_unloaded = 0;
+    /** set when writing the log fails; entries then stay in memory */
+    bool m_spillBroken = false;
 };
 
 #if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
@@ -467,7 +572,7 @@ void HistoryModel::makeCurrent(const QModelIndex & index) const
     if (isOutOfBounds(index))
         return;
     const int pos = positionFromIndex(index);
-    m_entries[pos].makeCurrent();
+    entryAt(pos).makeCurrent();
 }
 
 void HistoryModel::activate(const QModelIndex & index)
@@ -479,7 +584,7 @@ void HistoryModel::activate(const QModelIndex & index)
     // The "playback ready" hook is activated asynchronously, so
     // playbackStarted() for the playback initiated here will be invoked after
     // this function updates m_playingPosition and returns.
-    if (!m_entries[pos].play())
+    if (!entryAt(pos).play())
         return;
 
     // Update m_playingPosition here to prevent the imminent playbackStarted()
@@ -518,10 +623,10 @@ QVariant HistoryModel::data(const QModelIndex & index, int role) const
     switch (role)
     {
     case Qt::DisplayRole:
-        return QString(m_entries[pos].text());
+        return QString(entryAt(pos).text());
     case Qt::ToolTipRole:
     {
-        const auto & entry = m_entries[pos];
+        const auto & entry = entryAt(pos);
         // The playlist title and entry number are rarely interesting and
         // therefore shown only in the tooltip.
         return QString(
@@ -566,7 +671,14 @@ bool HistoryModel::removeRows(int row, int count, const QModelIndex & parent)
         m_playingPosition -= count;
     }
 
-    m_entries.remove(pos, count);
+    m_entries.remove(pos - m_unloaded, count);
+
+    // The removed rows were loaded, so the removed positions are all at least
+    // m_unloaded. But the lower ones may have been paged in from the history
+    // log, in which case their records must be removed from the log as well,
+    // or else scrolling would page the removed entries back in.
+    if (pos < m_spilledTotal)
+        rewriteLog(pos, std::min(pos + count, m_spilledTotal));
 
     endRemoveRows();
     m_areRowsBeingRemoved = false;
@@ -574,6 +686,55 @@ bool HistoryModel::removeRows(int row, int count, const QModelIndex & parent)
     return true;
 }
 
+bool HistoryModel::canFetchMore(const QModelIndex & parent) const
+{
+    return !parent.isValid() && m_unloaded > 0;
+}
+
+void HistoryModel::fetchMore(const QModelIndex & parent)
+{
+    if (parent.isValid() || m_unloaded <= 0)
+        return;
+    assert(m_logFile);
+
+    // Page in the chunk that contains the newest unloaded record. All the
+    // preceding records of that chunk are unloaded too, because entries are
+    // spilled and paged in oldest-first.
+    const int first = (m_unloaded - 1) / pageSize * pageSize;
+    const int count = m_unloaded - first;
+
+    if (!m_logFile->seek(m_chunkOffsets[first / pageSize]))
+    {
+        AUDWARN("Failed to seek in the history log: %s\n",
+                m_logFile->errorString().toUtf8().constData());
+        dropSpilledEntries();
+        return;
+    }
+
+    QDataStream stream(m_logFile);
+    Index<HistoryEntry> loaded;
+    for (int i = 0; i < count; i++)
+    {
+        HistoryEntry entry;
+        if (!readRecord(stream, entry))
+        {
+            AUDWARN("Failed to read back a spilled history entry.\n");
+            dropSpilledEntries();
+            return;
+        }
+        loaded.append(std::move(entry));
+    }
+
+    // The paged-in entries are the oldest loaded ones and thus occupy the
+    // rows below the current last row.
+    beginInsertRows(QModelIndex(), m_entries.len(), m_entries.len() + count - 1);
+    m_entries.insert(0, count);
+    for (int i = 0; i < count; i++)
+        m_entries[i] = std::move(loaded[i]);
+    m_unloaded = first;
+    endInsertRows();
+}
+
 bool HistoryModel::isModelRowOutOfBounds(int row) const
 {
     if (row >= 0 && row < m_entries.len())
@@ -601,22 +762,24 @@ bool HistoryModel::isOutOfBounds(const QModelIndex & index) const
 
 int HistoryModel::modelRowFromPosition(int position) const
 {
-    assert(position >= 0);
-    assert(position < m_entries.len());
+    assert(position >= m_unloaded);
+    assert(position < totalCount());
     // Reverse the order of entries here in order to:
     // 1) display most recently played entries at the top of the view and thus
     // avoid scrolling to the bottom of the view each time a new entry is added;
     // 2) efficiently append new elements to m_entries.
     // This code must be kept in sync with playbackStarted().
-    return m_entries.len() - 1 - position;
+    return totalCount() - 1 - position;
 }
 
 int HistoryModel::positionFromModelRow(int row) const
 {
     assert(!isModelRowOutOfBounds(row));
-    // modelRowFromPosition() is an involution (self-inverse function),
-    // and thus this inverse function delegates to it.
-    return modelRowFromPosition(row);
+    // The same formula as in modelRowFromPosition(): the mapping is an
+    // involution (self-inverse function). It is not delegated to, though,
+    // because rows and positions span different ranges once entries have
+    // been spilled, and the asserts there check the position range.
+    return totalCount() - 1 - row;
 }
 
 int HistoryModel::positionFromIndex(const QModelIndex & index) const
@@ -627,6 +790,11 @@ int HistoryModel::positionFromIndex(const QModelIndex & index) const
 
 void HistoryModel::updateFontForPosition(int position)
 {
+    // A spilled entry has no model row to update. Its font is set correctly
+    // by data() if it is paged back in later.
+    if (position < m_unloaded)
+        return;
+
     const int row = modelRowFromPosition(position);
     const auto topLeft = createIndex(row, 0);
     // Optimize for the current single-column implementation, but also support
@@ -654,7 +822,11 @@ void HistoryModel::playbackStarted()
     const auto shouldAppendEntry = [this, &entry] {
         if (m_playingPosition < 0)
             return true;
-        const auto & prevPlayingEntry = m_entries[m_playingPosition];
+        // The previously playing entry has been spilled. Comparing against
+        // it would require paging it back in; simply append instead.
+        if (m_playingPosition < m_unloaded)
+            return true;
+        const auto & prevPlayingEntry = entryAt(m_playingPosition);
 
         if (prevPlayingEntry.type() != entry.type() ||
             prevPlayingEntry.playlist() != entry.playlist())
@@ -700,12 +872,209 @@ void HistoryModel::playbackStarted()
     beginInsertRows(QModelIndex(), 0, 0);
     // Update m_playingPosition during the row insertion to avoid
     // updating the font for the new playing position separately below.
-    m_playingPosition = m_entries.len();
+    m_playingPosition = totalCount();
     m_entries.append(std::move(entry));
     endInsertRows();
 
     if (prevPlayingPosition >= 0)
         updateFontForPosition(prevPlayingPosition);
+
+    maybeSpill();
+}
+
+bool HistoryModel::openLog()
+{
+    if (m_logFile)
+        return true;
+
+    auto log = new QTemporaryFile(this);
+    if (!log->open())
+    {
+        AUDWARN("Failed to create the history log: %s\n",
+                log->errorString().toUtf8().constData());
+        delete log;
+        return false;
+    }
+
+    m_logFile = log;
+    return true;
+}
+
+int HistoryModel::playlistRef(const Playlist & playlist)
+{
+    // A linear search is fine here: history references few distinct
+    // playlists, and records are written in batches of pageSize anyway.
+    for (int i = 0; i < m_playlists.len(); i++)
+    {
+        if (m_playlists[i] == playlist)
+            return i;
+    }
+
+    m_playlists.append(playlist);
+    return m_playlists.len() - 1;
+}
+
+void HistoryModel::writeRecord(QDataStream & stream, const HistoryEntry & entry)
+{
+    // entryNumber() is 1-based, the stored playlist position is 0-based.
+    stream << static_cast<qint32>(playlistRef(entry.playlist()))
+           << static_cast<qint32>(entry.entryNumber() - 1)
+           << static_cast<qint32>(entry.type())
+           << QByteArray(static_cast<const char *>(entry.text()));
+}
+
+bool HistoryModel::readRecord(QDataStream & stream, HistoryEntry & entry)
+{
+    qint32 playlistIndex, playlistPosition, type;
+    QByteArray text;
+    stream >> playlistIndex >> playlistPosition >> type >> text;
+
+    if (stream.status() != QDataStream::Ok || playlistIndex < 0 ||
+        playlistIndex >= m_playlists.len() ||
+        (type != static_cast<qint32>(HistoryEntry::Type::Song) &&
+         type != static_cast<qint32>(HistoryEntry::Type::Album)))
+    {
+        return false;
+    }
+
+    entry = HistoryEntry(text.isEmpty() ? String() : String(text.constData()),
+                         m_playlists[playlistIndex], playlistPosition,
+                         static_cast<HistoryEntry::Type>(type));
+    return true;
+}
+
+void HistoryModel::maybeSpill()
+{
+    if (m_spillBroken || m_entries.len() <= maxLoadedEntries)
+        return;
+
+    if (!openLog())
+    {
+        m_spillBroken = true;
+        return;
+    }
+
+    // Spill down to one page below the limit so that the next spill is due
+    // only after another pageSize entries have been played.
+    const int spillCount = m_entries.len() - (maxLoadedEntries - pageSize);
+    const int end = m_unloaded + spillCount;
+
+    // Entries below m_spilledTotal were paged in from the log and still have
+    // their records there; only the newer ones need to be written out.
+    if (end > m_spilledTotal)
+    {
+        if (!m_logFile->seek(m_logFile->size()))
+        {
+            AUDWARN("Failed to seek in the history log: %s\n",
+                    m_logFile->errorString().toUtf8().constData());
+            m_spillBroken = true;
+            return;
+        }
+
+        QDataStream stream(m_logFile);
+        for (int pos = m_spilledTotal; pos < end; pos++)
+        {
+            if (pos % pageSize == 0)
+                m_chunkOffsets.append(m_logFile->pos());
+
+            writeRecord(stream, entryAt(pos));
+            if (stream.status() != QDataStream::Ok)
+            {
+                AUDWARN("Failed to write the history log; history entries"
+                        " will be kept in memory from now on.\n");
+                // Drop the offset of the partially written record, if any.
+                m_chunkOffsets.resize((pos + pageSize - 1) / pageSize);
+                m_spillBroken = true;
+                return;
+            }
+
+            m_spilledTotal = pos + 1;
+        }
+    }
+
+    // The spilled entries are the oldest loaded ones and thus occupy the
+    // bottommost rows. Removing their rows is not an explicit removal of
+    // entries by the user, so suppress makeCurrent() via the flag here, too.
+    const int firstRow = m_entries.len() - spillCount;
+    m_areRowsBeingRemoved = true;
+    beginRemoveRows(QModelIndex(), firstRow, m_entries.len() - 1);
+    m_entries.remove(0, spillCount);
+    m_unloaded = end;
+    endRemoveRows();
+    m_areRowsBeingRemoved = false;
+}
+
+void HistoryModel::rewriteLog(int removeBegin, int removeEnd)
+{
+    assert(removeBegin >= 0);
+    assert(removeBegin < removeEnd);
+    assert(removeEnd <= m_spilledTotal);
+
+    auto newLog = new QTemporaryFile(this);
+    if (!newLog->open() || !m_logFile->seek(0))
+    {
+        delete newLog;
+        dropSpilledEntries();
+        return;
+    }
+
+    QDataStream in(m_logFile);
+    QDataStream out(newLog);
+    QVector<qint64> offsets;
+    int outIndex = 0;
+
+    // Stream the records into the replacement log one at a time, skipping
+    // the removed range, to keep memory use bounded during the rewrite.
+    for (int i = 0; i < m_spilledTotal; i++)
+    {
+        HistoryEntry entry;
+        if (!readRecord(in, entry))
+        {
+            delete newLog;
+            dropSpilledEntries();
+            return;
+        }
+
+        if (i >= removeBegin && i < removeEnd)
+            continue;
+
+        if (outIndex % pageSize == 0)
+            offsets.append(newLog->pos());
+        writeRecord(out, entry);
+        outIndex++;
+    }
+
+    if (out.status() != QDataStream::Ok)
+    {
+        delete newLog;
+        dropSpilledEntries();
+        return;
+    }
+
+    delete m_logFile;
+    m_logFile = newLog;
+    m_chunkOffsets = offsets;
+    m_spilledTotal -= removeEnd - removeBegin;
+}
+
+void HistoryModel::dropSpilledEntries()
+{
+    AUDWARN("Dropping %d spilled history entries.\n", m_unloaded);
+
+    delete m_logFile;
+    m_logFile = nullptr;
+    m_chunkOffsets.clear();
+
+    // The unloaded entries are gone, so all positions shift down.
+    if (m_playingPosition >= 0)
+    {
+        m_playingPosition = (m_playingPosition >= m_unloaded)
+                                ? m_playingPosition - m_unloaded
+                                : -1;
+    }
+
+    m_spilledTotal = 0;
+    m_unloaded = 0;
 }
 
 HistoryView::HistoryView()
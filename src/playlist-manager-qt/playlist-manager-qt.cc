@@ -28,11 +28,15 @@
 #include <QMouseEvent>
 #include <QPointer>
 #include <QToolButton>
+#include <QVector>
 
+#include <libaudcore/audstrings.h>
 #include <libaudcore/hook.h>
 #include <libaudcore/i18n.h>
+#include <libaudcore/mainloop.h>
 #include <libaudcore/playlist.h>
 #include <libaudcore/plugin.h>
+#include <libaudcore/templates.h>
 #include <libaudqt/libaudqt.h>
 #include <libaudqt/treeview.h>
 
@@ -61,6 +65,7 @@ public:
     {
         ColumnTitle,
         ColumnEntries,
+        ColumnLength,
         NColumns
     };
 
@@ -68,6 +73,8 @@ public:
         : m_rows(Playlist::n_playlists()),
           m_playing(Playlist::playing_playlist().index())
     {
+        for (int row = 0; row < m_rows; row++)
+            m_cache.append(read_row(row));
     }
 
     void setFont(const QFont & font)
@@ -106,6 +113,33 @@ protected:
                         int role) const override;
 
 private:
+    struct RowData
+    {
+        QString title;
+        int entries;
+        QString length;
+
+        bool operator!=(const RowData & b) const
+        {
+            return title != b.title || entries != b.entries ||
+                   length != b.length;
+        }
+    };
+
+    static RowData read_row(int row)
+    {
+        auto list = Playlist::by_index(row);
+
+        /* the core maintains the total length incrementally, so this is
+         * O(1); an ellipsis marks playlists still being scanned */
+        StringBuf len = str_format_time(list.total_length_ms());
+        if (list.scan_in_progress())
+            len.insert(-1, "...");
+
+        return {QString(list.get_title()), list.n_entries(),
+                QString((const char *)len)};
+    }
+
     void update_rows(int row, int count);
     void update_playing();
 
@@ -113,6 +147,7 @@ private:
         "playlist set playing", this, &PlaylistsModel::update_playing};
 
     int m_rows, m_playing;
+    QVector<RowData> m_cache;
     QFont m_bold;
 };
 
@@ -145,6 +180,8 @@ private:
     const HookReceiver<PlaylistsView> //
         activate_hook{"playlist activate", this, &PlaylistsView::update_sel};
 
+    QueuedFunc m_update_func;
+    Playlist::UpdateLevel m_update_level = Playlist::NoUpdate;
     int m_in_update = 0;
 };
 
@@ -153,17 +190,16 @@ QVariant PlaylistsModel::data(const QModelIndex & index, int role) const
     switch (role)
     {
     case Qt::DisplayRole:
-    {
-        auto list = Playlist::by_index(index.row());
         switch (index.column())
         {
         case ColumnTitle:
-            return QString(list.get_title());
+            return m_cache[index.row()].title;
         case ColumnEntries:
-            return list.n_entries();
+            return m_cache[index.row()].entries;
+        case ColumnLength:
+            return m_cache[index.row()].length;
         }
-    }
-    break;
+        break;
 
     case Qt::FontRole:
         if (index.row() == m_playing)
@@ -171,7 +207,7 @@ QVariant PlaylistsModel::data(const QModelIndex & index, int role) const
         break;
 
     case Qt::TextAlignmentRole:
-        if (index.column() == ColumnEntries)
+        if (index.column() != ColumnTitle)
             return Qt::AlignRight;
         break;
     }
@@ -190,6 +226,8 @@ QVariant PlaylistsModel::headerData(int section, Qt::Orientation orientation,
             return QString(_("Title"));
         case ColumnEntries:
             return QString(_("Entries"));
+        case ColumnLength:
+            return QString(_("Length"));
         }
     }
 
@@ -231,11 +269,14 @@ void PlaylistsModel::update(const Playlist::UpdateLevel level)
         {
             beginRemoveRows(QModelIndex(), rows, m_rows - 1);
             m_rows = rows;
+            m_cache.resize(rows);
             endRemoveRows();
         }
         else if (rows > m_rows)
         {
             beginInsertRows(QModelIndex(), m_rows, rows - 1);
+            for (int row = m_rows; row < rows; row++)
+                m_cache.append(read_row(row));
             m_rows = rows;
             endInsertRows();
         }
@@ -243,11 +284,31 @@ void PlaylistsModel::update(const Playlist::UpdateLevel level)
 
     if (level >= Playlist::Metadata)
     {
-        update_rows(0, m_rows);
-        m_playing = Playlist::playing_playlist().index();
+        /* diff against the cached titles and entry counts and repaint
+         * only the rows that actually changed (a playlist added or
+         * removed in the middle shows up as a run of shifted rows) */
+        int start = -1;
+        for (int row = 0; row < m_rows; row++)
+        {
+            auto data = read_row(row);
+            if (data != m_cache[row])
+            {
+                m_cache[row] = data;
+                if (start < 0)
+                    start = row;
+            }
+            else if (start >= 0)
+            {
+                update_rows(start, row - start);
+                start = -1;
+            }
+        }
+
+        if (start >= 0)
+            update_rows(start, m_rows - start);
     }
-    else
-        update_playing();
+
+    update_playing();
 }
 
 PlaylistsView::PlaylistsView()
@@ -266,6 +327,9 @@ PlaylistsView::PlaylistsView()
     hdr->setSectionResizeMode(PlaylistsModel::ColumnEntries,
                               QHeaderView::Interactive);
     hdr->resizeSection(PlaylistsModel::ColumnEntries, audqt::to_native_dpi(64));
+    hdr->setSectionResizeMode(PlaylistsModel::ColumnLength,
+                              QHeaderView::Interactive);
+    hdr->resizeSection(PlaylistsModel::ColumnLength, audqt::to_native_dpi(72));
 
     setAllColumnsShowFocus(true);
     setDragDropMode(InternalMove);
@@ -317,10 +381,23 @@ void PlaylistsView::dropEvent(QDropEvent * event)
 
 void PlaylistsView::update(Playlist::UpdateLevel level)
 {
-    m_in_update++;
-    m_model.update(level);
-    update_sel();
-    m_in_update--;
+    /* hooks can arrive in bursts (one per changed playlist); coalesce
+     * those delivered within one main loop pass into a single model
+     * update at the highest level seen */
+    if (m_update_level == Playlist::NoUpdate)
+    {
+        m_update_func.queue([this]() {
+            auto level = m_update_level;
+            m_update_level = Playlist::NoUpdate;
+
+            m_in_update++;
+            m_model.update(level);
+            update_sel();
+            m_in_update--;
+        });
+    }
+
+    m_update_level = aud::max(m_update_level, level);
 }
 
 void PlaylistsView::update_sel()
@@ -77,6 +77,18 @@ static void get_value (void * user, int row, int column, GValue * value)
     case 1:
         g_value_set_int (value, list.n_entries ());
         break;
+
+    case 2:
+    {
+        /* the core maintains the total length incrementally, so this is
+         * O(1); an ellipsis marks playlists still being scanned */
+        StringBuf len = str_format_time (list.total_length_ms ());
+        if (list.scan_in_progress ())
+            len.insert (-1, "...");
+
+        g_value_set_string (value, len);
+        break;
+    }
     }
 }
 
@@ -199,6 +211,7 @@ void * PlaylistManager::get_gtk_widget ()
     GtkWidget * playman_pl_lv = audgui_list_new (& callbacks, nullptr, Playlist::n_playlists ());
     audgui_list_add_column (playman_pl_lv, _("Title"), 0, G_TYPE_STRING, -1);
     audgui_list_add_column (playman_pl_lv, _("Entries"), 1, G_TYPE_INT, 7);
+    audgui_list_add_column (playman_pl_lv, _("Length"), 2, G_TYPE_STRING, 9);
     audgui_list_set_highlight (playman_pl_lv, Playlist::playing_playlist ().index ());
     gtk_tree_view_set_search_equal_func ((GtkTreeView *) playman_pl_lv,
      search_cb, nullptr, nullptr);
@@ -80,17 +80,31 @@ bool PLSLoader::save (const char * filename, VFSFile & file, const char * title,
 {
     int entries = items.len ();
 
+    /* batch the lines into large writes; one fwrite per entry is slow on
+     * remote files and large playlists */
+    Index<char> buf;
+
     StringBuf header = str_printf ("[playlist]\nNumberOfEntries=%d\n", entries);
-    if (file.fwrite (header, 1, header.len ()) != header.len ())
-        return false;
+    buf.insert (header, -1, header.len ());
 
     for (int count = 0; count < entries; count ++)
     {
         StringBuf path = uri_deconstruct (items[count].filename, filename);
         StringBuf line = str_printf ("File%d=%s\n", 1 + count, (const char *) path);
-        if (file.fwrite (line, 1, line.len ()) != line.len ())
-            return false;
+
+        buf.insert (line, -1, line.len ());
+
+        if (buf.len () >= 65536)
+        {
+            if (file.fwrite (buf.begin (), 1, buf.len ()) != buf.len ())
+                return false;
+
+            buf.resize (0);
+        }
     }
 
+    if (buf.len () && file.fwrite (buf.begin (), 1, buf.len ()) != buf.len ())
+        return false;
+
     return true;
 }
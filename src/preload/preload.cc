@@ -0,0 +1,194 @@
+/*
+ * preload.cc
+ * Copyright 2025 Audacious team
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions, and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions, and the following disclaimer in the documentation
+ *    provided with the distribution.
+ *
+ * This software is provided "as is" and without any warranty, express or
+ * implied. In no event shall the authors be liable for any damages arising from
+ * the use of this software.
+ */
+
+#include <pthread.h>
+
+#include <libaudcore/drct.h>
+#include <libaudcore/hook.h>
+#include <libaudcore/i18n.h>
+#include <libaudcore/playlist.h>
+#include <libaudcore/plugin.h>
+#include <libaudcore/runtime.h>
+#include <libaudcore/templates.h>
+#include <libaudcore/vfs.h>
+
+/* An input plugin only opens the next playlist entry after the current
+ * one ends, so a gapless transition depends on the output buffer
+ * outliving the open+probe latency of the next file; on slow storage
+ * (network mounts) that race is sometimes lost.  This plugin warms the
+ * next entry up front: while the current song plays, a worker thread
+ * opens the file and reads its head and tail, priming the remote mount
+ * and the page cache so the real open and probe at the transition are
+ * served from memory.  With shuffle enabled the next entry cannot be
+ * predicted, and nothing is preloaded. */
+
+class TrackPreload : public GeneralPlugin
+{
+public:
+    static const char about[];
+
+    static constexpr PluginInfo info = {
+        N_("Track Preloader"),
+        PACKAGE,
+        about,
+        nullptr
+    };
+
+    constexpr TrackPreload () : GeneralPlugin (info, false) {}
+
+    bool init () override;
+    void cleanup () override;
+};
+
+EXPORT TrackPreload aud_plugin_instance;
+
+const char TrackPreload::about[] =
+ N_("Track Preloader Plugin\n\n"
+    "Reads ahead in the next playlist entry while the current song is "
+    "still playing, so that gapless transitions do not depend on the "
+    "latency of the storage holding the next file.");
+
+/* how much to read from each end of the file: enough to cover the
+ * probe, the codec headers and any tag at the tail */
+static constexpr int64_t HEAD_BYTES = 256 * 1024;
+static constexpr int64_t TAIL_BYTES = 64 * 1024;
+
+static pthread_t worker;
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+static String pending;  /* next file to warm */
+static bool worker_running = false;
+static bool worker_quit = false;
+
+static void read_span (VFSFile & file, int64_t bytes)
+{
+    char buf[16384];
+
+    while (bytes > 0)
+    {
+        int64_t n = file.fread (buf, 1, aud::min (bytes, (int64_t) sizeof buf));
+        if (n <= 0)
+            break;
+
+        bytes -= n;
+    }
+}
+
+static void warm_file (const char * filename)
+{
+    VFSFile file (filename, "r");
+    if (! file)
+        return;
+
+    read_span (file, HEAD_BYTES);
+
+    int64_t size = file.fsize ();
+    if (size > HEAD_BYTES + TAIL_BYTES &&
+     ! file.fseek (size - TAIL_BYTES, VFS_SEEK_SET))
+        read_span (file, TAIL_BYTES);
+
+    AUDDBG ("Warmed %s.\n", filename);
+}
+
+static void * worker_func (void *)
+{
+    pthread_mutex_lock (& mutex);
+
+    while (! worker_quit)
+    {
+        if (! pending)
+        {
+            pthread_cond_wait (& cond, & mutex);
+            continue;
+        }
+
+        String filename = pending;
+        pending = String ();
+        pthread_mutex_unlock (& mutex);
+
+        warm_file (filename);
+
+        pthread_mutex_lock (& mutex);
+    }
+
+    pthread_mutex_unlock (& mutex);
+    return nullptr;
+}
+
+static void queue_preload (void * data, void * user_data)
+{
+    if (! aud_drct_get_playing ())
+        return;
+
+    /* with shuffle on, the next entry cannot be predicted */
+    if (aud_get_bool ("shuffle"))
+        return;
+
+    auto playlist = Playlist::playing_playlist ();
+    int pos = playlist.get_position ();
+    if (pos < 0)
+        return;
+
+    int next = pos + 1;
+    if (next >= playlist.n_entries ())
+    {
+        if (! aud_get_bool ("repeat"))
+            return;
+
+        next = 0;
+    }
+
+    String filename = playlist.entry_filename (next);
+    if (! filename)
+        return;
+
+    pthread_mutex_lock (& mutex);
+
+    pending = filename;
+
+    if (! worker_running && ! pthread_create (& worker, nullptr, worker_func, nullptr))
+        worker_running = true;
+
+    pthread_cond_signal (& cond);
+    pthread_mutex_unlock (& mutex);
+}
+
+bool TrackPreload::init ()
+{
+    hook_associate ("playback ready", queue_preload, nullptr);
+    return true;
+}
+
+void TrackPreload::cleanup ()
+{
+    hook_dissociate ("playback ready", queue_preload);
+
+    pthread_mutex_lock (& mutex);
+    worker_quit = true;
+    pending = String ();
+    pthread_cond_signal (& cond);
+    bool running = worker_running;
+    worker_running = false;
+    pthread_mutex_unlock (& mutex);
+
+    if (running)
+        pthread_join (worker, nullptr);
+
+    worker_quit = false;
+}
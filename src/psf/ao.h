@@ -12,6 +12,7 @@
 #define WANT_AUD_BSWAP
 #include <libaudcore/audio.h>
 #include <libaudcore/index.h>
+#include <libaudcore/objects.h>
 
 #define AO_SUCCESS					1
 #define AO_FAIL						0
@@ -34,5 +35,6 @@ enum
 };
 
 Index<char> ao_get_lib(char *filename);
+StringBuf ao_get_lib_path(char *filename);
 
 #endif // AO_H
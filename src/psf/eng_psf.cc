@@ -28,6 +28,8 @@
 #include <string.h>
 #include <stdlib.h>
 
+#include <zlib.h>
+
 #include <libaudcore/audstrings.h>
 
 #include "ao.h"
@@ -51,6 +53,123 @@ int			psf_refresh  = -1;
 
 static uint32_t initialPC, initialGP, initialSP;
 
+/* Savestate-based seeking: the complete emulator state (R3000 context, RAM
+ * and hardware registers, SPU) is snapshotted every ten seconds of track
+ * time and zlib-compressed -- PSX work RAM is mostly static program data,
+ * so snapshots typically shrink to a fraction of the raw 2.5 MB.  A
+ * backward seek restores the nearest snapshot at or before the target and
+ * lets the SPU's existing fast-forward cover the remainder, instead of
+ * re-running the whole track from time zero. */
+
+static const int snapshot_period = 600;	/* frames between snapshots (10 s) */
+static const int max_snapshots = 64;
+
+struct PSFSnapshot
+{
+	uint32_t frame;			/* track position, 1/60 s units */
+	uint32_t comp_size;
+	uint8_t *data;
+};
+
+static PSFSnapshot snapshots[max_snapshots];
+static int snapshot_count = 0;
+static uint32_t frame_count;		/* frames emulated since track start */
+static uint32_t next_snapshot_frame;
+
+static void psf_clear_snapshots(void)
+{
+	while (snapshot_count)
+		free(snapshots[--snapshot_count].data);
+	next_snapshot_frame = 0;
+}
+
+static uint32_t psf_state_size(void)
+{
+	return mips_state_size() + psx_hw_state_size() + spu_state_size();
+}
+
+static void psf_take_snapshot(void)
+{
+	next_snapshot_frame = frame_count + snapshot_period;
+
+	if (snapshot_count >= max_snapshots)
+		return;
+
+	uint32_t raw_size = psf_state_size();
+	uLongf comp_size = compressBound(raw_size);
+	uint8_t *raw = (uint8_t *)malloc(raw_size);
+	uint8_t *comp = (uint8_t *)malloc(comp_size);
+
+	if (raw && comp)
+	{
+		uint8_t *p = raw;
+		mips_save_state(p);
+		p += mips_state_size();
+		psx_hw_save_state(p);
+		p += psx_hw_state_size();
+		spu_save_state(p);
+
+		if (compress2((Bytef *)comp, &comp_size, (Bytef *)raw, raw_size,
+		    Z_BEST_SPEED) == Z_OK)
+		{
+			PSFSnapshot &snap = snapshots[snapshot_count];
+			snap.frame = frame_count;
+			snap.comp_size = comp_size;
+
+			/* shrink to the compressed size */
+			snap.data = (uint8_t *)realloc(comp, comp_size);
+			if (!snap.data)
+				snap.data = comp;
+			comp = nullptr;
+
+			snapshot_count++;
+		}
+	}
+
+	free(raw);
+	free(comp);
+}
+
+int32_t psf_restore(uint32_t t_ms)
+{
+	uint32_t target = (uint64_t)t_ms * 60 / 1000;
+
+	int best = -1;
+	for (int i = 0; i < snapshot_count; i++)
+	{
+		if (snapshots[i].frame <= target &&
+		 (best < 0 || snapshots[i].frame > snapshots[best].frame))
+			best = i;
+	}
+
+	if (best < 0)
+		return 0;
+
+	uint32_t raw_size = psf_state_size();
+	uint8_t *raw = (uint8_t *)malloc(raw_size);
+	if (!raw)
+		return 0;
+
+	uLongf out_size = raw_size;
+	if (uncompress((Bytef *)raw, &out_size, (Bytef *)snapshots[best].data,
+	    snapshots[best].comp_size) != Z_OK || out_size != raw_size)
+	{
+		free(raw);
+		return 0;
+	}
+
+	uint8_t *p = raw;
+	mips_restore_state(p);
+	p += mips_state_size();
+	psx_hw_restore_state(p);
+	p += psx_hw_state_size();
+	spu_restore_state(p);
+	free(raw);
+
+	frame_count = snapshots[best].frame;
+	return 1;
+}
+
 int32_t psf_start(uint8_t *buffer, uint32_t length)
 {
 	uint8_t *file, *lib_decoded, *alib_decoded;
@@ -60,6 +179,9 @@ int32_t psf_start(uint8_t *buffer, uint32_t length)
 	int i;
 	union cpuinfo mipsinfo;
 
+	psf_clear_snapshots();
+	frame_count = 0;
+
 	// clear PSX work RAM before we start scribbling in it
 	memset(psx_ram, 0, 2*1024*1024);
 
@@ -335,12 +457,16 @@ int32_t psf_execute(void (*update)(const void *, int))
 	int i;
 
 	while (!stop_flag) {
+		if (frame_count >= next_snapshot_frame)
+			psf_take_snapshot();
+
 		for (i = 0; i < 44100 / 60; i++) {
 			psx_hw_slice();
 			SPUasync(384, update);
 		}
 
 		psx_hw_frame();
+		frame_count++;
 	}
 
 	return AO_SUCCESS;
@@ -348,6 +474,7 @@ int32_t psf_execute(void (*update)(const void *, int))
 
 int32_t psf_stop(void)
 {
+	psf_clear_snapshots();
 	SPUclose();
 	free(c);
 
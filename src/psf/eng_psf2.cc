@@ -48,6 +48,7 @@
 
 #include <zlib.h>
 #include <libaudcore/audstrings.h>
+#include <libaudcore/multihash.h>
 
 #include "ao.h"
 #include "cpuintrf.h"
@@ -77,10 +78,21 @@ static uint32_t initialPC, initialSP;
 static uint32_t loadAddr, lengthMS, fadeMS;
 
 static uint8_t *filesys[MAX_FS];
-static Index<char> lib_raw_file;
 static uint32_t fssize[MAX_FS];
 static int num_fs;
 
+// The library file is shared by every track of a PSF2 set, so the decoded
+// image stays mounted across tracks instead of being re-read and re-inflated
+// on each open.  lib_raw_file backs cached_lib->res_section and must outlive
+// it; both are replaced when a track names a different library.
+static String cached_lib_path;
+static Index<char> lib_raw_file;
+static corlett_t *cached_lib = nullptr;
+
+// program sections inflated out of the cached library's filesystem, keyed by
+// path; the track's own filesystem is searched first and never cached
+static SimpleHash<String, Index<char>> lib_file_cache;
+
 static void do_iopmod(uint8_t *start, uint32_t offset)
 {
 	#if DEBUG_LOADER
@@ -424,9 +436,29 @@ uint32_t psf2_load_file(const char *file, uint8_t *buf, uint32_t buflen)
 
 	for (i = 0; i < num_fs; i++)
 	{
+		// filesystem 1, when present, is the mounted library
+		bool from_lib = (i == 1);
+
+		if (from_lib)
+		{
+			Index<char> *cached = lib_file_cache.lookup(String(file));
+			if (cached)
+			{
+				flen = cached->len();
+				memcpy(buf, cached->begin(), (flen < buflen) ? flen : buflen);
+				return flen;
+			}
+		}
+
 		flen = load_file(i, file, buf, buflen);
 		if (flen != 0xffffffff)
 		{
+			if (from_lib && flen <= buflen)
+			{
+				Index<char> copy;
+				copy.insert((const char *)buf, 0, flen);
+				lib_file_cache.add(String(file), std::move(copy));
+			}
 			return flen;
 		}
 	}
@@ -436,9 +468,9 @@ uint32_t psf2_load_file(const char *file, uint8_t *buf, uint32_t buflen)
 
 int32_t psf2_start(uint8_t *buffer, uint32_t length)
 {
-	uint8_t *file, *lib_decoded;
+	uint8_t *file;
 	uint32_t irx_len;
-	uint64_t file_len, lib_len;
+	uint64_t file_len;
 	uint8_t *buf;
 	union cpuinfo mipsinfo;
 	corlett_t *lib;
@@ -473,22 +505,38 @@ int32_t psf2_start(uint8_t *buffer, uint32_t length)
 		printf("Loading library: %s\n", c->lib);
 		#endif
 
-		lib_raw_file = ao_get_lib(c->lib);
+		String lib_path = String(ao_get_lib_path(c->lib));
+
+		if (!cached_lib || strcmp(cached_lib_path, lib_path))
+		{
+			free(cached_lib);
+			cached_lib = nullptr;
+			cached_lib_path = String();
+			lib_file_cache.clear();
+
+			lib_raw_file = ao_get_lib(c->lib);
 
-		if (!lib_raw_file.len())
-			return AO_FAIL;
+			if (!lib_raw_file.len())
+				return AO_FAIL;
 
-		if (corlett_decode((uint8_t *)lib_raw_file.begin(), lib_raw_file.len(),
-		 &lib_decoded, &lib_len, &lib) != AO_SUCCESS)
-			return AO_FAIL;
+			if (corlett_decode((uint8_t *)lib_raw_file.begin(), lib_raw_file.len(),
+			 nullptr, nullptr, &lib) != AO_SUCCESS)
+			{
+				lib_raw_file.clear();
+				return AO_FAIL;
+			}
+
+			cached_lib = lib;
+			cached_lib_path = lib_path;
+		}
 
 		#if DEBUG_LOADER
-		printf("Lib FS section: size %x bytes\n", lib->res_size);
+		printf("Lib FS section: size %x bytes\n", cached_lib->res_size);
 		#endif
 
 		num_fs++;
-		filesys[1] = (uint8_t *)lib->res_section;
- 		fssize[1] = lib->res_size;
+		filesys[1] = (uint8_t *)cached_lib->res_section;
+ 		fssize[1] = cached_lib->res_size;
 	}
 
 	// dump all files
@@ -582,7 +630,7 @@ int32_t psf2_execute(void (*update)(const void *, int))
 int32_t psf2_stop(void)
 {
 	SPU2close();
-	lib_raw_file.clear();
+	// lib_raw_file and cached_lib stay mounted for the next track of the set
 	free(c);
 
 	return AO_SUCCESS;
@@ -200,6 +200,56 @@ void setendless(int e)
  endless=e;
 }
 
+/* Raw in-place snapshot of the SPU state for savestate-based seeking.
+ * Channel pointers (pStart/pCurr/pLoop) and pSpuIrq point into the static
+ * spuMem array, so they stay valid when copied back into the same process.
+ * The output cursor and cycle remainder are reset instead of saved; the
+ * few pending output samples they cover are discarded on restore anyway. */
+static u32 spu_state_walk(u8 *buf, int save)
+{
+ u32 off = 0;
+
+#define XFER(item) do { \
+ if (buf && save) memcpy(buf + off, &(item), sizeof(item)); \
+ else if (buf) memcpy(&(item), buf + off, sizeof(item)); \
+ off += sizeof(item); } while (0)
+
+ XFER(regArea);
+ XFER(spuMem);
+ XFER(pSpuIrq);
+ XFER(s_chan);
+ XFER(rvb);
+ XFER(dwNoiseVal);
+ XFER(spuCtrl);
+ XFER(spuStat);
+ XFER(spuIrq);
+ XFER(spuAddr);
+ XFER(sampcount);
+
+#undef XFER
+
+ return off;
+}
+
+uint32_t spu_state_size(void)
+{
+ return spu_state_walk(NULL, 0);
+}
+
+void spu_save_state(uint8_t *buf)
+{
+ spu_state_walk(buf, 1);
+}
+
+void spu_restore_state(const uint8_t *buf)
+{
+ spu_state_walk((u8 *)buf, 0);
+
+ pS=(s16 *)pSpuBuffer;
+ ttemp=0;
+ seektime=0;
+}
+
 // Counting to 65536 results in full volume offage.
 void setlength(s32 stop, s32 fade)
 {
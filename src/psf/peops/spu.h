@@ -30,6 +30,11 @@ int psf_seek(uint32_t t);
 void setendless(int e);
 void setlength(int32_t stop, int32_t fade);
 
+/* raw in-place SPU state snapshots for savestate-based seeking */
+uint32_t spu_state_size(void);
+void spu_save_state(uint8_t *buf);
+void spu_restore_state(const uint8_t *buf);
+
 int SPUasync(uint32_t cycles, void (*update)(const void *, int));
 void SPU_flushboot(void);
 int SPUinit(void);
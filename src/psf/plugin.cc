@@ -24,6 +24,7 @@
     SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -64,7 +65,6 @@ public:
     bool read_tag(const char *filename, VFSFile &file, Tuple &tuple, Index<char> *image) override;
     bool play(const char *filename, VFSFile &file) override;
 
-protected:
     static void update(const void *data, int bytes);
 };
 
@@ -82,14 +82,15 @@ typedef struct {
     int32_t (*start)(uint8_t *buffer, uint32_t length);
     int32_t (*stop)(void);
     int32_t (*seek)(uint32_t);
+    int32_t (*restore)(uint32_t);  /* resume from a snapshot, or null */
     int32_t (*execute)(void (*update)(const void *, int));
 } PSFEngineFunctors;
 
 static PSFEngineFunctors psf_functor_map[ENG_COUNT] = {
-    {nullptr, nullptr, nullptr, nullptr},
-    {psf_start, psf_stop, psf_seek, psf_execute},
-    {psf2_start, psf2_stop, psf2_seek, psf2_execute},
-    {spx_start, spx_stop, psf_seek, spx_execute},
+    {nullptr, nullptr, nullptr, nullptr, nullptr},
+    {psf_start, psf_stop, psf_seek, psf_restore, psf_execute},
+    {psf2_start, psf2_stop, psf2_seek, nullptr, psf2_execute},
+    {spx_start, spx_stop, psf_seek, nullptr, spx_execute},
 };
 
 const char* const PSFPlugin::defaults[] =
@@ -114,6 +115,22 @@ bool stop_flag = false;
  * to seek backward. */
 static int reverse_seek;
 
+/* The R3000 and SPU emulation runs on a worker thread, a few hundred
+ * milliseconds ahead of playback, so that sequencing bursts (PSF2 titles
+ * especially) are absorbed by the ring below instead of underrunning the
+ * output.  The worker owns the engine; the playback thread only drains the
+ * ring and forwards seek requests. */
+static pthread_mutex_t psf_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t psf_cond = PTHREAD_COND_INITIALIZER;
+
+static Index<char> psf_ring;      /* undrained PCM starts at psf_drained */
+static int psf_drained;           /* bytes already consumed from the front */
+static int psf_ring_limit;       /* maximum undrained bytes to buffer ahead */
+static int psf_seek_request;     /* milliseconds, or -1 for none */
+static bool psf_quit, psf_done, psf_worker_error;
+
+static Index<char> *psf_file_buf;
+
 static PSFEngine psf_probe(const char *buf, int len)
 {
     if (len < 4)
@@ -141,6 +158,12 @@ Index<char> ao_get_lib(char *filename)
     return file ? file.read_all() : Index<char>();
 }
 
+/* full path of a secondary file; engines use it to key caches */
+StringBuf ao_get_lib_path(char *filename)
+{
+    return filename_build({dirpath, filename});
+}
+
 bool PSFPlugin::read_tag(const char *filename, VFSFile &file, Tuple &tuple, Index<char> *image)
 {
     Index<char> buf = file.read_all ();
@@ -165,9 +188,64 @@ bool PSFPlugin::read_tag(const char *filename, VFSFile &file, Tuple &tuple, Inde
     return true;
 }
 
+static void *emulation_worker(void *)
+{
+    Index<char> &buf = *psf_file_buf;
+    bool started = false;
+    bool error = false;
+
+    reverse_seek = -1;
+
+    if (f->start((uint8_t *)buf.begin(), buf.len()) != AO_SUCCESS)
+        error = true;
+    else
+        started = true;
+
+    while (started)
+    {
+        stop_flag = false;
+
+        f->execute(PSFPlugin::update);
+
+        if (reverse_seek < 0)
+            break;
+
+        /* Seek backward: resume from a state snapshot when the engine has
+         * one at or before the target; otherwise restart from time zero. */
+        if (!(f->restore && f->restore(reverse_seek)))
+        {
+            f->stop();
+            started = false;
+
+            if (f->start((uint8_t *)buf.begin(), buf.len()) != AO_SUCCESS)
+            {
+                error = true;
+                break;
+            }
+
+            started = true;
+        }
+
+        f->seek(reverse_seek); /* should never fail here */
+        reverse_seek = -1;
+    }
+
+    if (started)
+        f->stop();
+
+    pthread_mutex_lock(&psf_mutex);
+    psf_worker_error = error;
+    psf_done = true;
+    pthread_cond_broadcast(&psf_cond);
+    pthread_mutex_unlock(&psf_mutex);
+
+    return nullptr;
+}
+
 bool PSFPlugin::play(const char *filename, VFSFile &file)
 {
     bool error = false;
+    pthread_t worker;
 
     const char * slash = strrchr (filename, '/');
     if (! slash)
@@ -197,30 +275,69 @@ bool PSFPlugin::play(const char *filename, VFSFile &file)
     set_stream_bitrate(44100*2*2*8);
     open_audio(FMT_S16_NE, 44100, 2);
 
-    reverse_seek = -1;
+    /* buffer half a second of 16-bit stereo PCM ahead of playback */
+    psf_ring_limit = 44100 * 2;
+    psf_ring.clear();
+    psf_drained = 0;
+    psf_seek_request = -1;
+    psf_quit = psf_done = psf_worker_error = false;
+    psf_file_buf = &buf;
 
-    /* This loop will restart playback from the beginning when necessary to seek
-     * backwards in the file (reverse_seek >= 0). */
-    do
+    if (pthread_create(&worker, nullptr, emulation_worker, nullptr) != 0)
     {
-        if (f->start((uint8_t *)buf.begin(), buf.len()) != AO_SUCCESS)
+        AUDERR("Failed to create emulation thread.\n");
+        error = true;
+        goto cleanup;
+    }
+
+    while (!check_stop())
+    {
+        int seek = check_seek();
+        char out[4096];
+        int copied = 0;
+
+        pthread_mutex_lock(&psf_mutex);
+
+        if (seek >= 0)
         {
-            error = true;
-            goto cleanup;
+            psf_seek_request = seek;
+            pthread_cond_broadcast(&psf_cond);
         }
 
-        if (reverse_seek >= 0)
+        while ((psf_ring.len() - psf_drained == 0 || psf_seek_request >= 0) &&
+         !psf_done)
+            pthread_cond_wait(&psf_cond, &psf_mutex);
+
+        if (psf_seek_request < 0)
         {
-            f->seek(reverse_seek); /* should never fail here */
-            reverse_seek = -1;
+            copied = aud::min((int)sizeof out, psf_ring.len() - psf_drained);
+            memcpy(out, &psf_ring[psf_drained], copied);
+            psf_drained += copied;
+            pthread_cond_broadcast(&psf_cond);
         }
 
-        stop_flag = false;
+        bool done = psf_done && (psf_ring.len() - psf_drained == 0 ||
+         psf_seek_request >= 0);
+        error = psf_worker_error;
 
-        f->execute(update);
-        f->stop();
+        pthread_mutex_unlock(&psf_mutex);
+
+        if (copied > 0)
+            write_audio(out, copied);
+
+        if (done || error)
+            break;
     }
-    while (reverse_seek >= 0);
+
+    pthread_mutex_lock(&psf_mutex);
+    psf_quit = true;
+    pthread_cond_broadcast(&psf_cond);
+    pthread_mutex_unlock(&psf_mutex);
+
+    pthread_join(worker, nullptr);
+
+    psf_ring.clear();
+    psf_file_buf = nullptr;
 
 cleanup:
     f = nullptr;
@@ -229,28 +346,67 @@ cleanup:
     return ! error;
 }
 
+/* Called by the engines on the worker thread with each block of synthesized
+ * PCM; blocks while the ring is full so the worker stays a bounded distance
+ * ahead of playback. */
 void PSFPlugin::update(const void *data, int bytes)
 {
-    if (!data || check_stop())
+    if (!data)
     {
         stop_flag = true;
         return;
     }
 
-    int seek = check_seek();
+    pthread_mutex_lock(&psf_mutex);
 
-    if (seek >= 0)
+    for (;;)
     {
-        if (!f->seek(seek))
+        if (psf_quit)
         {
-            reverse_seek = seek;
             stop_flag = true;
+            break;
         }
 
-        return;
+        if (psf_seek_request >= 0)
+        {
+            int seek = psf_seek_request;
+
+            /* discard PCM synthesized before the seek point */
+            psf_ring.clear();
+            psf_drained = 0;
+
+            if (f->seek(seek))
+                psf_seek_request = -1;
+            else
+            {
+                /* restart the engine to seek backward */
+                reverse_seek = seek;
+                psf_seek_request = -1;
+                stop_flag = true;
+            }
+
+            pthread_cond_broadcast(&psf_cond);
+            break;
+        }
+
+        if (psf_ring.len() - psf_drained < psf_ring_limit)
+        {
+            /* compact the drained prefix once it outgrows the limit */
+            if (psf_drained >= psf_ring_limit)
+            {
+                psf_ring.remove(0, psf_drained);
+                psf_drained = 0;
+            }
+
+            psf_ring.insert((const char *)data, -1, bytes);
+            pthread_cond_broadcast(&psf_cond);
+            break;
+        }
+
+        pthread_cond_wait(&psf_cond, &psf_mutex);
     }
 
-    write_audio(data, bytes);
+    pthread_mutex_unlock(&psf_mutex);
 }
 
 bool PSFPlugin::is_our_file(const char *filename, VFSFile &file)
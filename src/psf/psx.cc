@@ -15,6 +15,7 @@
 
 #include <stdio.h>
 #include <stdarg.h>
+#include <string.h>
 #include "ao.h"
 #include "cpuintrf.h"
 #include "psx.h"
@@ -1644,6 +1645,21 @@ int mips_execute( int cycles )
 	return cycles - mips_ICount;
 }
 
+uint32_t mips_state_size(void)
+{
+	return sizeof(mipscpu);
+}
+
+void mips_save_state(uint8_t *buf)
+{
+	memcpy(buf, &mipscpu, sizeof(mipscpu));
+}
+
+void mips_restore_state(const uint8_t *buf)
+{
+	memcpy(&mipscpu, buf, sizeof(mipscpu));
+}
+
 static void mips_get_context( void *dst )
 {
 	if( dst )
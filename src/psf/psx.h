@@ -290,6 +290,7 @@ extern int psf_refresh;
 
 int32_t psf_start(uint8_t *buffer, uint32_t length);
 int32_t psf_execute(void (*update)(const void *, int));
+int32_t psf_restore(uint32_t t_ms);
 int32_t psf_stop(void);
 
 /* eng_psf2.cc */
@@ -324,6 +325,12 @@ uint32_t mips_get_ePC(void);
 int mips_get_icount(void);
 void mips_set_icount(int count);
 
+/* raw in-place state snapshots for savestate-based seeking; only valid
+ * for the process (and loaded file) that saved them */
+uint32_t mips_state_size(void);
+void mips_save_state(uint8_t *buf);
+void mips_restore_state(const uint8_t *buf);
+
 /* psx_hw.cc */
 extern uint32_t psx_ram[((2*1024*1024)/4)+4];
 extern uint32_t psx_scratch[0x400];
@@ -339,6 +346,10 @@ void psx_hw_init(void);
 void psx_bios_hle(uint32_t pc);
 void psx_hw_runcounters(void);
 
+uint32_t psx_hw_state_size(void);
+void psx_hw_save_state(uint8_t *buf);
+void psx_hw_restore_state(const uint8_t *buf);
+
 uint8_t program_read_byte_32le(offs_t address);
 uint16_t program_read_word_32le(offs_t address);
 uint32_t program_read_dword_32le(offs_t address);
@@ -47,6 +47,7 @@
 */
 
 #include <stdio.h>
+#include <string.h>
 
 #include "ao.h"
 #include "cpuintrf.h"
@@ -3512,3 +3513,74 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 	}
 }
 
+
+/* Raw in-place snapshot of the PS1-side hardware state for savestate-based
+ * seeking.  Pointers such as Event/CounterEvent are fixed addresses into
+ * psx_ram and need no translation; the PS2 IOP structures (threads, file
+ * slots) are deliberately not covered, since the PSF2 engine keeps
+ * heap-allocated file data that a raw copy cannot safely capture. */
+static uint32_t psx_hw_state_walk(uint8_t *buf, int save)
+{
+	uint32_t off = 0;
+
+#define XFER(item) do { \
+	if (buf && save) memcpy(buf + off, (const void *)&(item), sizeof(item)); \
+	else if (buf) memcpy((void *)&(item), buf + off, sizeof(item)); \
+	off += sizeof(item); } while (0)
+
+	XFER(softcall_target);
+	XFER(intr_susp);
+	XFER(sys_time);
+	XFER(timerexp);
+	XFER(root_cnts);
+	XFER(spu_delay);
+	XFER(dma_icr);
+	XFER(irq_data);
+	XFER(irq_mask);
+	XFER(dma_timer);
+	XFER(WAI);
+	XFER(dma4_madr);
+	XFER(dma4_bcr);
+	XFER(dma4_chcr);
+	XFER(dma4_delay);
+	XFER(dma7_madr);
+	XFER(dma7_bcr);
+	XFER(dma7_chcr);
+	XFER(dma7_delay);
+	XFER(dma4_cb);
+	XFER(dma7_cb);
+	XFER(dma4_fval);
+	XFER(dma4_flag);
+	XFER(dma7_fval);
+	XFER(dma7_flag);
+	XFER(irq9_cb);
+	XFER(irq9_fval);
+	XFER(irq9_flag);
+	XFER(gpu_stat);
+	XFER(fcnt);
+	XFER(heap_addr);
+	XFER(entry_int);
+	XFER(irq_regs);
+	XFER(irq_mutex);
+	XFER(psx_ram);
+	XFER(psx_scratch);
+
+#undef XFER
+
+	return off;
+}
+
+uint32_t psx_hw_state_size(void)
+{
+	return psx_hw_state_walk(NULL, 0);
+}
+
+void psx_hw_save_state(uint8_t *buf)
+{
+	psx_hw_state_walk(buf, 1);
+}
+
+void psx_hw_restore_state(const uint8_t *buf)
+{
+	psx_hw_state_walk((uint8_t *)buf, 0);
+}
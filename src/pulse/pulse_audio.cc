@@ -73,6 +73,8 @@ const PreferencesWidget PulseOutput::widgets[] = {
         WidgetString ("pulse", "context_name")),
     WidgetEntry (N_("Stream name:"),
         WidgetString ("pulse", "stream_name")),
+    WidgetCheck (N_("Adapt latency to the connection:"),
+        WidgetBool ("pulse", "adjust_latency")),
 };
 
 const PluginPreferences PulseOutput::prefs = {{widgets}};
@@ -83,6 +85,7 @@ const String PulseOutput::default_stream_name = String ("Audacious");
 const char * const PulseOutput::prefs_defaults[] = {
     "context_name", PulseOutput::default_context_name,
     "stream_name", PulseOutput::default_stream_name,
+    "adjust_latency", "TRUE",
     nullptr
 };
 
@@ -97,6 +100,9 @@ static bool connected, flushed, polling;
 
 static pa_cvolume volume;
 
+/* current target latency; 0 means "use output_buffer_size" */
+static uint32_t target_latency_ms;
+
 static StereoVolume saved_volume = {0, 0};
 static bool saved_volume_changed = false;
 
@@ -400,7 +406,8 @@ static bool set_sample_spec (pa_sample_spec & ss, int fmt, int rate, int nch)
 
 static void set_buffer_attr (pa_buffer_attr & buffer, const pa_sample_spec & ss)
 {
-    int buffer_ms = aud_get_int ("output_buffer_size");
+    int buffer_ms = target_latency_ms ? (int) target_latency_ms :
+     aud_get_int ("output_buffer_size");
     size_t buffer_size = pa_usec_to_bytes ((pa_usec_t) 1000 * buffer_ms, & ss);
 
     buffer.maxlength = (uint32_t) -1;
@@ -410,6 +417,30 @@ static void set_buffer_attr (pa_buffer_attr & buffer, const pa_sample_spec & ss)
     buffer.fragsize = buffer_size;
 }
 
+/* Called from pa_mainloop_dispatch() with the mutex held.  Remote sinks
+ * routinely need more buffering than local ones, so grow the target by half
+ * on each underrun, bounded by four times the configured buffer, and let the
+ * server re-balance via PA_STREAM_ADJUST_LATENCY. */
+static void underflow_cb (pa_stream * s, void *)
+{
+    if (! aud_get_bool ("pulse", "adjust_latency"))
+        return;
+
+    uint32_t max_ms = 4 * aud_get_int ("output_buffer_size");
+    if (! target_latency_ms)
+        target_latency_ms = aud_get_int ("output_buffer_size");
+
+    target_latency_ms = aud::min (target_latency_ms + target_latency_ms / 2, max_ms);
+    AUDINFO ("Underrun; raising target latency to %u ms.\n", (unsigned) target_latency_ms);
+
+    pa_buffer_attr buffer;
+    set_buffer_attr (buffer, * pa_stream_get_sample_spec (s));
+
+    pa_operation * op = pa_stream_set_buffer_attr (s, & buffer, nullptr, nullptr);
+    if (op)
+        pa_operation_unref (op);
+}
+
 static String get_context_name ()
 {
     String context_name = aud_get_str ("pulse", "context_name");
@@ -483,11 +514,15 @@ static bool create_stream (aud::mutex::holder & lock, const pa_sample_spec & ss)
         return false;
     }
 
+    pa_stream_set_underflow_callback (stream, underflow_cb, nullptr);
+
     /* Connect stream with sink and default volume */
     pa_buffer_attr buffer;
     set_buffer_attr (buffer, ss);
 
     auto flags = pa_stream_flags_t (PA_STREAM_INTERPOLATE_TIMING | PA_STREAM_AUTO_TIMING_UPDATE);
+    if (aud_get_bool ("pulse", "adjust_latency"))
+        flags = pa_stream_flags_t (flags | PA_STREAM_ADJUST_LATENCY);
     if (pa_stream_connect_playback (stream, nullptr, & buffer, flags, nullptr, nullptr) < 0)
     {
         REPORT ("pa_stream_connect_playback");
@@ -510,6 +545,35 @@ static bool create_stream (aud::mutex::holder & lock, const pa_sample_spec & ss)
     return true;
 }
 
+/* Seed the adaptive latency target from the measured round trip to the sink,
+ * so remote connections start out with enough buffering instead of waiting
+ * for the first underrun. */
+static void init_target_latency (aud::mutex::holder & lock)
+{
+    int success = 0;
+    CHECK (pa_stream_update_timing_info, stream, stream_success_cb);
+
+    const pa_timing_info * ti = pa_stream_get_timing_info (stream);
+    if (! ti)
+        return;
+
+    int buffer_ms = aud_get_int ("output_buffer_size");
+    int rtt_ms = (2 * ti->transport_usec + ti->sink_usec) / 1000;
+
+    if (2 * rtt_ms > buffer_ms)
+    {
+        target_latency_ms = aud::min (2 * rtt_ms, 4 * buffer_ms);
+        AUDINFO ("Measured round trip %d ms; raising target latency to %u ms.\n",
+         rtt_ms, (unsigned) target_latency_ms);
+
+        pa_buffer_attr buffer;
+        set_buffer_attr (buffer, * pa_stream_get_sample_spec (stream));
+
+        success = 0;
+        CHECK (pa_stream_set_buffer_attr, stream, & buffer, stream_success_cb);
+    }
+}
+
 static bool subscribe_events (aud::mutex::holder & lock)
 {
     pa_context_set_subscribe_callback (context, subscribe_cb, nullptr);
@@ -537,6 +601,8 @@ bool PulseOutput::open_audio (int fmt, int rate, int nch, String & error)
     if (! set_sample_spec (ss, fmt, rate, nch))
         return false;
 
+    target_latency_ms = 0;
+
     if (! create_context (lock) ||
         ! create_stream (lock, ss) ||
         ! subscribe_events (lock))
@@ -545,6 +611,9 @@ bool PulseOutput::open_audio (int fmt, int rate, int nch, String & error)
         return false;
     }
 
+    if (aud_get_bool ("pulse", "adjust_latency"))
+        init_target_latency (lock);
+
     connected = true;
     flushed = true;
 
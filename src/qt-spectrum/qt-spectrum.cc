@@ -21,6 +21,7 @@
 #include <math.h>
 #include <string.h>
 
+#include <QEvent>
 #include <QWidget>
 #include <QPainter>
 
@@ -46,12 +47,18 @@ public:
     ~SpectrumWidget ();
 
 protected:
+    void changeEvent (QEvent *) override;
     void resizeEvent (QResizeEvent *) override;
     void paintEvent (QPaintEvent *) override;
 
 private:
+    void update_colors ();
     void paint_background (QPainter &);
     void paint_spectrum (QPainter &);
+
+    /* per-band colors, recomputed only when the band count or palette
+     * changes rather than for every band on every frame */
+    QColor m_colors[MAX_BANDS];
 };
 
 static SpectrumWidget * spect_widget = nullptr;
@@ -77,18 +84,34 @@ void SpectrumWidget::paint_spectrum (QPainter & p)
     for (int i = 0; i < bands; i++)
     {
         int x = ((width () / bands) * i) + 2;
-        auto color = audqt::vis_bar_color (palette ().color (QPalette::Highlight), i, bands);
 
         p.fillRect (x + 1, height () - (bars[i] * height () / 40),
-         (width () / bands) - 1, (bars[i] * height () / 40), color);
+         (width () / bands) - 1, (bars[i] * height () / 40), m_colors[i]);
     }
 }
 
+void SpectrumWidget::update_colors ()
+{
+    auto & highlight = palette ().color (QPalette::Highlight);
+
+    for (int i = 0; i < bands; i ++)
+        m_colors[i] = audqt::vis_bar_color (highlight, i, bands);
+}
+
+void SpectrumWidget::changeEvent (QEvent * event)
+{
+    if (event->type () == QEvent::PaletteChange)
+        update_colors ();
+
+    QWidget::changeEvent (event);
+}
+
 void SpectrumWidget::resizeEvent (QResizeEvent * event)
 {
     bands = width () / 10;
     bands = aud::clamp(bands, 12, MAX_BANDS);
     Visualizer::compute_log_xscale (xscale, bands);
+    update_colors ();
     update ();
 }
 
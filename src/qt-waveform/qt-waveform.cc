@@ -0,0 +1,329 @@
+/*
+ * qt-waveform.cc
+ * Copyright 2026 Audacious development team
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions, and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions, and the following disclaimer in the documentation
+ *    provided with the distribution.
+ *
+ * This software is provided "as is" and without any warranty, express or
+ * implied. In no event shall the authors be liable for any damages arising from
+ * the use of this software.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <QMouseEvent>
+#include <QPainter>
+#include <QWidget>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include <libaudcore/audstrings.h>
+#include <libaudcore/drct.h>
+#include <libaudcore/hook.h>
+#include <libaudcore/i18n.h>
+#include <libaudcore/index.h>
+#include <libaudcore/plugin.h>
+#include <libaudcore/runtime.h>
+#include <libaudcore/vfs.h>
+
+#define MS_PER_BUCKET 100
+#define VIS_FRAMES 512 /* frames per render_multi_pcm () call */
+
+/* The waveform is a pair of min/max peaks per 100 ms of audio, collected
+ * from the visualization stream while the song plays and saved to a small
+ * cache file in the user directory.  On the next play of the same file the
+ * whole waveform is available immediately, with no extra decoding at any
+ * point.  The cache file is binary: a magic string, the song URI (the file
+ * name is only a hash of it), the bucket count, then all minima and all
+ * maxima as signed bytes. */
+
+static const char peak_magic[8] = {'A', 'U', 'D', 'W', 'A', 'V', 'E', '1'};
+
+static String cur_uri;
+static int cur_length; /* milliseconds */
+static Index<int8_t> peak_min, peak_max;
+static bool peaks_dirty;
+
+static StringBuf peak_dir_path ()
+    { return filename_build ({aud_get_path (AudPath::UserDir), "waveform-peaks"}); }
+
+static StringBuf peak_file_path (const char * uri)
+    { return filename_build ({peak_dir_path (), str_printf ("%08x.peaks", g_str_hash (uri))}); }
+
+static void save_peaks ()
+{
+    if (! peaks_dirty || ! cur_uri)
+        return;
+
+    peaks_dirty = false;
+
+    if (g_mkdir_with_parents (peak_dir_path (), 0755) < 0)
+        return;
+
+    uint32_t uri_len = strlen (cur_uri);
+    uint32_t buckets = peak_min.len ();
+
+    Index<char> data;
+    data.insert (peak_magic, -1, sizeof peak_magic);
+    data.insert ((const char *) & uri_len, -1, sizeof uri_len);
+    data.insert ((const char *) cur_uri, -1, uri_len);
+    data.insert ((const char *) & buckets, -1, sizeof buckets);
+    data.insert ((const char *) peak_min.begin (), -1, buckets);
+    data.insert ((const char *) peak_max.begin (), -1, buckets);
+
+    VFSFile::write_file (filename_to_uri (peak_file_path (cur_uri)),
+     data.begin (), data.len ());
+}
+
+static void load_peaks (const char * uri, int buckets)
+{
+    auto data = VFSFile::read_file (filename_to_uri (peak_file_path (uri)), VFS_APPEND_NULL);
+    int len = data.len () - 1;
+
+    if (len < (int) (sizeof peak_magic + 2 * sizeof (uint32_t)))
+        return;
+
+    const char * read = data.begin ();
+
+    if (memcmp (read, peak_magic, sizeof peak_magic))
+        return;
+
+    read += sizeof peak_magic;
+
+    uint32_t uri_len;
+    memcpy (& uri_len, read, sizeof uri_len);
+    read += sizeof uri_len;
+
+    /* the file name is only a hash of the URI, so check the real thing */
+    if (len < (int) (sizeof peak_magic + 2 * sizeof (uint32_t) + uri_len) ||
+     uri_len != strlen (uri) || memcmp (read, uri, uri_len))
+        return;
+
+    read += uri_len;
+
+    uint32_t saved;
+    memcpy (& saved, read, sizeof saved);
+    read += sizeof saved;
+
+    /* validate in unsigned arithmetic: a huge saved count would wrap
+     * negative as an int and slip past a signed comparison */
+    if (saved > (uint32_t) (len - (read - data.begin ())) / 2)
+        return;
+
+    int copy = aud::min ((int) saved, buckets);
+    memcpy (peak_min.begin (), read, copy);
+    memcpy (peak_max.begin (), read + saved, copy);
+}
+
+class WaveformWidget : public QWidget
+{
+public:
+    WaveformWidget (QWidget * parent = nullptr);
+    ~WaveformWidget ();
+
+    void add_pcm (const float * pcm, int channels);
+
+protected:
+    void mousePressEvent (QMouseEvent *) override;
+    void mouseMoveEvent (QMouseEvent *) override;
+    void paintEvent (QPaintEvent *) override;
+
+private:
+    void song_changed ();
+    void stopped ();
+    void seek_to (int x);
+
+    HookReceiver<WaveformWidget>
+     change_hook {"playback ready", this, & WaveformWidget::song_changed},
+     stop_hook {"playback stop", this, & WaveformWidget::stopped};
+};
+
+static WaveformWidget * wave_widget = nullptr;
+
+WaveformWidget::WaveformWidget (QWidget * parent) :
+    QWidget (parent)
+{
+    setMinimumHeight (24);
+
+    if (aud_drct_get_ready ())
+        song_changed ();
+}
+
+WaveformWidget::~WaveformWidget ()
+{
+    save_peaks ();
+    wave_widget = nullptr;
+}
+
+void WaveformWidget::song_changed ()
+{
+    save_peaks ();
+
+    cur_uri = String (aud_drct_get_filename ());
+    cur_length = aud_drct_get_length ();
+
+    int buckets = (cur_length > 0) ?
+     (cur_length + MS_PER_BUCKET - 1) / MS_PER_BUCKET : 0;
+
+    peak_min.clear ();
+    peak_max.clear ();
+    peak_min.insert (0, buckets);
+    peak_max.insert (0, buckets);
+
+    if (buckets && cur_uri)
+        load_peaks (cur_uri, buckets);
+
+    update ();
+}
+
+void WaveformWidget::stopped ()
+{
+    save_peaks ();
+    update ();
+}
+
+void WaveformWidget::add_pcm (const float * pcm, int channels)
+{
+    int buckets = peak_min.len ();
+    if (! buckets)
+        return;
+
+    int bucket = aud::clamp (aud_drct_get_time () / MS_PER_BUCKET, 0, buckets - 1);
+
+    float min = 0, max = 0;
+
+    for (int i = 0; i < VIS_FRAMES * channels; i ++)
+    {
+        min = aud::min (min, pcm[i]);
+        max = aud::max (max, pcm[i]);
+    }
+
+    int8_t min8 = (int8_t) (aud::clamp (min, -1.0f, 1.0f) * 127);
+    int8_t max8 = (int8_t) (aud::clamp (max, -1.0f, 1.0f) * 127);
+
+    if (min8 < peak_min[bucket] || max8 > peak_max[bucket])
+        peaks_dirty = true;
+
+    peak_min[bucket] = aud::min (peak_min[bucket], min8);
+    peak_max[bucket] = aud::max (peak_max[bucket], max8);
+
+    update ();
+}
+
+void WaveformWidget::seek_to (int x)
+{
+    if (cur_length <= 0 || ! aud_drct_get_playing () || width () < 1)
+        return;
+
+    x = aud::clamp (x, 0, width () - 1);
+    aud_drct_seek ((int) ((int64_t) x * cur_length / width ()));
+}
+
+void WaveformWidget::mousePressEvent (QMouseEvent * event)
+{
+    if (event->button () == Qt::LeftButton)
+        seek_to (event->x ());
+}
+
+void WaveformWidget::mouseMoveEvent (QMouseEvent * event)
+{
+    if (event->buttons () & Qt::LeftButton)
+        seek_to (event->x ());
+}
+
+void WaveformWidget::paintEvent (QPaintEvent *)
+{
+    QPainter p (this);
+
+    int w = width (), h = height ();
+
+    p.fillRect (0, 0, w, h, palette ().color (QPalette::Window));
+
+    int buckets = peak_min.len ();
+    if (! buckets)
+        return;
+
+    auto & played = palette ().color (QPalette::Highlight);
+    auto & unplayed = palette ().color (QPalette::Mid);
+
+    int pos_x = (aud_drct_get_playing () && cur_length > 0) ?
+     (int) ((int64_t) aud_drct_get_time () * w / cur_length) : -1;
+
+    int mid = h / 2;
+
+    for (int x = 0; x < w; x ++)
+    {
+        int b0 = (int) ((int64_t) x * buckets / w);
+        int b1 = aud::max (b0 + 1, (int) ((int64_t) (x + 1) * buckets / w));
+        b1 = aud::min (b1, buckets);
+
+        int min = 0, max = 0;
+
+        for (int b = b0; b < b1; b ++)
+        {
+            min = aud::min (min, (int) peak_min[b]);
+            max = aud::max (max, (int) peak_max[b]);
+        }
+
+        int y0 = mid - max * mid / 127;
+        int y1 = mid - min * mid / 127;
+
+        if (y1 <= y0)
+            y1 = y0 + 1;
+
+        p.setPen ((x <= pos_x) ? played : unplayed);
+        p.drawLine (x, y0, x, y1);
+    }
+}
+
+class QtWaveform : public VisPlugin
+{
+public:
+    static constexpr PluginInfo info = {
+        N_("Waveform Seekbar"),
+        PACKAGE,
+        nullptr, // about
+        nullptr, // prefs
+        PluginQtOnly
+    };
+
+    constexpr QtWaveform () : VisPlugin (info, Visualizer::MultiPCM) {}
+
+    void * get_qt_widget () override;
+
+    void clear () override;
+    void render_multi_pcm (const float * pcm, int channels) override;
+};
+
+EXPORT QtWaveform aud_plugin_instance;
+
+void QtWaveform::render_multi_pcm (const float * pcm, int channels)
+{
+    if (wave_widget)
+        wave_widget->add_pcm (pcm, channels);
+}
+
+void QtWaveform::clear ()
+{
+    if (wave_widget)
+        wave_widget->update ();
+}
+
+void * QtWaveform::get_qt_widget ()
+{
+    if (wave_widget)
+        return wave_widget;
+
+    wave_widget = new WaveformWidget ();
+    return wave_widget;
+}
@@ -76,6 +76,82 @@ static int s_pos = 0;
 static float s_angle = 25, s_anglespeed = 0.05f;
 static float s_bars[NUM_BANDS][NUM_BANDS];
 
+/* Persistent vertex data for all bars, drawn with a single glDrawArrays()
+ * call.  Positions (x/z) and face shading never change and are filled in
+ * once; each frame rewrites only the bar heights and the height-scaled
+ * colors. */
+#define VERTS_PER_BAR 16 /* top, left, right, front quads */
+#define NUM_VERTS (NUM_BANDS * NUM_BANDS * VERTS_PER_BAR)
+
+static float s_verts[NUM_VERTS * 3];
+static float s_vert_colors[NUM_VERTS * 3];
+
+/* which corners of each quad sit at the top of the bar */
+static const char vert_at_top[VERTS_PER_BAR] =
+ {1, 1, 1, 1,  0, 1, 1, 0,  1, 0, 0, 1,  0, 0, 1, 1};
+
+/* face shading as in the old immediate-mode path */
+static const float vert_shade[VERTS_PER_BAR] =
+ {1, 1, 1, 1,  0.65f, 0.65f, 0.65f, 0.65f,  0.65f, 0.65f, 0.65f, 0.65f,
+  0.8f, 0.8f, 0.8f, 0.8f};
+
+static void init_bar_verts ()
+{
+    float * v = s_verts;
+
+    for (int i = 0; i < NUM_BANDS; i ++)
+    {
+        float z1 = -1.6f + (NUM_BANDS - i) * BAR_SPACING;
+        float z2 = z1 + BAR_WIDTH;
+
+        for (int j = 0; j < NUM_BANDS; j ++)
+        {
+            float x1 = 1.6f - BAR_SPACING * j;
+            float x2 = x1 + BAR_WIDTH;
+
+            const float xs[VERTS_PER_BAR] =
+             {x1, x2, x2, x1,  x1, x1, x1, x1,  x2, x2, x2, x2,  x1, x2, x2, x1};
+            const float zs[VERTS_PER_BAR] =
+             {z1, z1, z2, z2,  z1, z1, z2, z2,  z1, z1, z2, z2,  z1, z1, z1, z1};
+
+            for (int k = 0; k < VERTS_PER_BAR; k ++)
+            {
+                v[0] = xs[k];
+                v[2] = zs[k];
+                v += 3;
+            }
+        }
+    }
+}
+
+static void update_bar_verts ()
+{
+    float * v = s_verts;
+    float * c = s_vert_colors;
+
+    for (int i = 0; i < NUM_BANDS; i ++)
+    {
+        for (int j = 0; j < NUM_BANDS; j ++)
+        {
+            float h = s_bars[(s_pos + i) % NUM_BANDS][j] * 1.6f;
+            float br = 0.2f + 0.8f * h;
+            float r = colors[i][j][0] * br;
+            float g = colors[i][j][1] * br;
+            float b = colors[i][j][2] * br;
+
+            for (int k = 0; k < VERTS_PER_BAR; k ++)
+            {
+                v[1] = vert_at_top[k] ? h : 0;
+                c[0] = vert_shade[k] * r;
+                c[1] = vert_shade[k] * g;
+                c[2] = vert_shade[k] * b;
+                v += 3;
+                c += 3;
+            }
+        }
+    }
+}
+
 class GLSpectrumWidget : public QOpenGLWidget, protected QOpenGLFunctions_2_0
 {
 public:
@@ -88,9 +164,6 @@ private:
     void initializeGL () override;
 
     void draw_bars ();
-    void draw_bar (float x, float z, float h, float r, float g, float b);
-    void draw_rectangle (float x1, float y1, float z1, float x2, float y2,
-                         float z2, float r, float g, float b);
 };
 
 GLSpectrumWidget * s_widget = nullptr;
@@ -114,6 +187,8 @@ bool GLSpectrumQt::init ()
         }
     }
 
+    init_bar_verts ();
+
     return true;
 }
 
@@ -176,71 +251,26 @@ void GLSpectrumQt::clear ()
         s_widget->update ();
 }
 
-void GLSpectrumWidget::draw_rectangle (float x1, float y1, float z1, float x2, float y2,
- float z2, float r, float g, float b)
-{
-    glColor4f (r, g, b, 1.0f);
-
-    glBegin (GL_POLYGON);
-    glVertex3f (x1, y2, z1);
-    glVertex3f (x2, y2, z1);
-    glVertex3f (x2, y2, z2);
-    glVertex3f (x1, y2, z2);
-    glEnd ();
-
-    glColor4f (0.65f * r, 0.65f * g, 0.65f * b, 1.0f);
-
-    glBegin (GL_POLYGON);
-    glVertex3f (x1, y1, z1);
-    glVertex3f (x1, y2, z1);
-    glVertex3f (x1, y2, z2);
-    glVertex3f (x1, y1, z2);
-    glEnd ();
-
-    glBegin (GL_POLYGON);
-    glVertex3f (x2, y2, z1);
-    glVertex3f (x2, y1, z1);
-    glVertex3f (x2, y1, z2);
-    glVertex3f (x2, y2, z2);
-    glEnd ();
-
-    glColor4f (0.8f * r, 0.8f * g, 0.8f * b, 1.0f);
-
-    glBegin (GL_POLYGON);
-    glVertex3f (x1, y1, z1);
-    glVertex3f (x2, y1, z1);
-    glVertex3f (x2, y2, z1);
-    glVertex3f (x1, y2, z1);
-    glEnd ();
-}
-
-void GLSpectrumWidget::draw_bar (float x, float z, float h, float r, float g, float b)
-{
-    draw_rectangle (x, 0, z, x + BAR_WIDTH, h, z + BAR_WIDTH,
-     r * (0.2f + 0.8f * h), g * (0.2f + 0.8f * h), b * (0.2f + 0.8f * h));
-}
-
 void GLSpectrumWidget::draw_bars ()
 {
+    update_bar_verts ();
+
     glPushMatrix ();
     glTranslatef (0.0f, -0.5f, -5.0f);
     glRotatef (38.0f, 1.0f, 0.0f, 0.0f);
     glRotatef (s_angle + 180.0f, 0.0f, 1.0f, 0.0f);
     glPolygonMode (GL_FRONT_AND_BACK, GL_FILL);
 
-    for (int i = 0; i < NUM_BANDS; i ++)
-    {
-        float z = -1.6f + (NUM_BANDS - i) * BAR_SPACING;
+    glEnableClientState (GL_VERTEX_ARRAY);
+    glEnableClientState (GL_COLOR_ARRAY);
+    glVertexPointer (3, GL_FLOAT, 0, s_verts);
+    glColorPointer (3, GL_FLOAT, 0, s_vert_colors);
 
-        for (int j = 0; j < NUM_BANDS; j ++)
-        {
-            draw_bar (1.6f - BAR_SPACING * j, z,
-             s_bars[(s_pos + i) % NUM_BANDS][j] * 1.6,
-             colors[i][j][0], colors[i][j][1], colors[i][j][2]);
-        }
-    }
+    glDrawArrays (GL_QUADS, 0, NUM_VERTS);
+
+    glDisableClientState (GL_COLOR_ARRAY);
+    glDisableClientState (GL_VERTEX_ARRAY);
 
-    glPolygonMode (GL_FRONT_AND_BACK, GL_FILL);
     glPopMatrix ();
 }
 
@@ -40,6 +40,7 @@
 
 #include <QtCore/QAbstractNativeEventFilter>
 #include <QtCore/QCoreApplication>
+#include <QtCore/QHash>
 #include <QtCore/QString>
 #include <QtCore/QTimer>
 #include <QtGui/QGuiApplication>
@@ -101,6 +102,60 @@ unsigned int numlock_mask = 0;
 unsigned int scrolllock_mask = 0;
 unsigned int capslock_mask = 0;
 
+static void grab_key(const HotkeyConfiguration & hotkey, Display * xdisplay,
+                     Window x_root_window);
+static void ungrab_key(const HotkeyConfiguration & hotkey, Display * xdisplay,
+                       Window x_root_window);
+
+/* bindings indexed by (keycode, modifier mask) so that dispatching a key
+ * event is a single hash lookup instead of a walk over the full list */
+static QHash<unsigned, Event> binding_index;
+
+/* bindings actually grabbed on the server; grab updates only touch the
+ * bindings that changed, and ungrabs always release exactly what was
+ * grabbed even if the configuration has been reloaded in between */
+static QList<HotkeyConfiguration> active_grabs;
+
+static unsigned binding_hash_key(unsigned key, unsigned mask)
+{
+    return (mask << 8) | (key & 0xff);
+}
+
+static void rebuild_binding_index()
+{
+    binding_index.clear();
+
+    for (const auto & hotkey : plugin_cfg.hotkeys_list)
+    {
+        if (hotkey.key == 0)
+        {
+            continue;
+        }
+
+        unsigned hash_key = binding_hash_key(hotkey.key, hotkey.mask);
+
+        /* keep first-match semantics for duplicate bindings */
+        if (!binding_index.contains(hash_key))
+        {
+            binding_index.insert(hash_key, hotkey.event);
+        }
+    }
+}
+
+static int find_active_grab(const HotkeyConfiguration & hotkey)
+{
+    for (int i = 0; i < active_grabs.size(); ++i)
+    {
+        if ((active_grabs[i].key == hotkey.key) &&
+            (active_grabs[i].mask == hotkey.mask))
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
 const char GlobalHotkeys::about[] =
     N_("Global Hotkey Plugin\n"
        "Control the player with global key combinations or multimedia keys.\n\n"
@@ -488,16 +543,15 @@ bool GlobalHotkeysEventFilter::nativeEventFilter(const QByteArray & eventType,
 
     xcb_key_press_event_t * ke = (xcb_key_press_event_t *)e;
 
-    for (const auto & hotkey : plugin_cfg.hotkeys_list)
+    unsigned state =
+        ke->state & ~(scrolllock_mask | numlock_mask | capslock_mask);
+
+    auto it = binding_index.constFind(binding_hash_key(ke->detail, state));
+    if (it != binding_index.constEnd())
     {
-        if ((hotkey.key == ke->detail) &&
-            (hotkey.mask ==
-             (ke->state & ~(scrolllock_mask | numlock_mask | capslock_mask))))
+        if (handle_keyevent(*it))
         {
-            if (handle_keyevent(hotkey.event))
-            {
-                return true;
-            }
+            return true;
         }
     }
 
@@ -613,13 +667,16 @@ static void grab_key(const HotkeyConfiguration & hotkey, Display * xdisplay,
     }
 }
 
+/* synchronize the server-side grabs with the configured bindings;
+ * only bindings added or removed since the last call are touched, so a
+ * configuration change no longer releases and re-acquires every grab */
 void grab_keys()
 {
     PluginConfig * plugin_cfg = get_config();
 
     XErrorHandler old_handler = nullptr;
 
-    if (grabbed || (!xdisplay))
+    if (!xdisplay)
     {
         return;
     }
@@ -629,14 +686,54 @@ void grab_keys()
 
     get_offending_modifiers(xdisplay);
 
+    int old_count = active_grabs.size();
+    QList<bool> keep;
+    keep.reserve(old_count);
+    for (int i = 0; i < old_count; ++i)
+    {
+        keep.append(false);
+    }
+
     for (const auto & hotkey : plugin_cfg->hotkeys_list)
     {
+        if (hotkey.key == 0)
+        {
+            continue;
+        }
+
+        int idx = find_active_grab(hotkey);
+        if (idx >= 0)
+        {
+            keep[idx] = true;
+            continue;
+        }
+
         for (int screen = 0; screen < ScreenCount(xdisplay); ++screen)
         {
             grab_key(hotkey, xdisplay, RootWindow(xdisplay, screen));
         }
+
+        active_grabs.append(hotkey);
     }
 
+    for (int i = old_count; i-- > 0;)
+    {
+        if (keep[i])
+        {
+            continue;
+        }
+
+        for (int screen = 0; screen < ScreenCount(xdisplay); ++screen)
+        {
+            ungrab_key(active_grabs[i], xdisplay,
+                       RootWindow(xdisplay, screen));
+        }
+
+        active_grabs.removeAt(i);
+    }
+
+    rebuild_binding_index();
+
     XSync(xdisplay, False);
     XSetErrorHandler(old_handler);
 
@@ -708,8 +805,6 @@ static void ungrab_key(const HotkeyConfiguration & hotkey, Display * xdisplay,
 
 void ungrab_keys()
 {
-    PluginConfig * plugin_cfg = get_config();
-
     XErrorHandler old_handler = nullptr;
 
     if ((!grabbed) || (!xdisplay))
@@ -722,7 +817,7 @@ void ungrab_keys()
 
     get_offending_modifiers(xdisplay);
 
-    for (const auto & hotkey : plugin_cfg->hotkeys_list)
+    for (const auto & hotkey : active_grabs)
     {
         for (int screen = 0; screen < ScreenCount(xdisplay); ++screen)
         {
@@ -730,6 +825,9 @@ void ungrab_keys()
         }
     }
 
+    active_grabs.clear();
+    binding_index.clear();
+
     XSync(xdisplay, False);
     XSetErrorHandler(old_handler);
 
@@ -21,6 +21,7 @@
 
 #include <libaudcore/drct.h>
 #include <libaudcore/interface.h>
+#include <libaudcore/probe.h>
 #include <libaudcore/runtime.h>
 #include <libaudqt/libaudqt.h>
 
@@ -72,14 +73,20 @@ protected:
 
     void changeEvent(QEvent * event) override;
     void paintEvent(QPaintEvent *) override;
+    void showEvent(QShowEvent *) override;
+    void hideEvent(QHideEvent *) override;
 
 private:
     void update_colors();
+    void set_active(bool active);
 
     const PixelSizes ps;
     QLinearGradient m_gradient;
     BarColors m_bar_colors[VisBands];
 
+    bool m_enabled = false;
+    bool m_active = false;
+
     float m_bars[VisBands]{};
     char m_delay[VisBands]{};
 };
@@ -169,17 +176,38 @@ void InfoVis::paintEvent(QPaintEvent *)
     }
 }
 
-void InfoVis::enable(bool enabled)
+/* register with the core only while the widget is actually shown; an
+ * unregistered visualizer costs nothing, since the core computes the
+ * spectrum only when someone is listening */
+void InfoVis::set_active(bool active)
 {
-    if (enabled)
+    if (active == m_active)
+        return;
+
+    m_active = active;
+
+    if (active)
         aud_visualizer_add(this);
     else
     {
         aud_visualizer_remove(this);
         clear();
     }
+}
 
+void InfoVis::showEvent(QShowEvent *)
+{
+    if (m_enabled)
+        set_active(true);
+}
+
+void InfoVis::hideEvent(QHideEvent *) { set_active(false); }
+
+void InfoVis::enable(bool enabled)
+{
+    m_enabled = enabled;
     setVisible(enabled);
+    set_active(enabled && isVisible());
 }
 
 InfoBar::InfoBar(QWidget * parent)
@@ -276,7 +304,18 @@ void InfoBar::update_title()
 
 void InfoBar::update_album_art()
 {
-    sd[Cur].art = audqt::art_request_current(ps.IconSize, ps.IconSize);
+    String filename = aud_drct_get_filename();
+    auto art = filename ? aud_art_request(filename, AUD_ART_FILE) : AudArtPtr();
+    String art_file = String(art.file());
+
+    /* consecutive songs from one album share the art file; reuse the pixmap
+     * already scaled for the previous song instead of decoding it again */
+    if (art_file && art_file == sd[Prev].art_file && !sd[Prev].art.isNull())
+        sd[Cur].art = sd[Prev].art;
+    else
+        sd[Cur].art = audqt::art_request_current(ps.IconSize, ps.IconSize);
+
+    sd[Cur].art_file = art_file;
 }
 
 void InfoBar::next_song()
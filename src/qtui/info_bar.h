@@ -24,6 +24,7 @@
 #include <QWidget>
 
 #include <libaudcore/hook.h>
+#include <libaudcore/objects.h>
 
 class InfoVis;
 struct PixelSizes;
@@ -63,6 +64,7 @@ private:
     struct SongData
     {
         QPixmap art;
+        String art_file;
         QString orig_title;
         QStaticText title, artist, album;
         int alpha;
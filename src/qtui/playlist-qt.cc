@@ -436,12 +436,12 @@ void PlaylistWidget::updateSelection(int rowsBefore, int rowsAfter)
     }
 }
 
-void PlaylistWidget::playlistUpdate()
+Playlist::UpdateLevel PlaylistWidget::playlistUpdate()
 {
     auto update = m_playlist.update_detail();
 
     if (update.level == Playlist::NoUpdate)
-        return;
+        return Playlist::NoUpdate;
 
     inUpdate = true;
 
@@ -489,6 +489,8 @@ void PlaylistWidget::playlistUpdate()
     updateSelection(update.before, update.after);
 
     inUpdate = false;
+
+    return update.level;
 }
 
 void PlaylistWidget::setFilter(const char * text)
@@ -41,7 +41,7 @@ public:
 
     bool scrollToCurrent(bool force = false);
     void updatePlaybackIndicator();
-    void playlistUpdate();
+    Playlist::UpdateLevel playlistUpdate();
     void setFilter(const char * text);
     void setFirstVisibleColumn(int col);
     void moveFocus(int distance);
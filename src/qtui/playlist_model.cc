@@ -91,59 +91,84 @@ QVariant PlaylistModel::alignment(int col) const
     }
 }
 
+QVariant PlaylistModel::displayData(int row, int col) const
+{
+    Tuple tuple;
+    int val = -1;
+
+    if (s_fields[col] != Tuple::Invalid)
+    {
+        tuple = m_playlist.entry_tuple(row, Playlist::NoWait);
+
+        if (col == Filename)
+            return filename(tuple);
+
+        switch (tuple.get_value_type(s_fields[col]))
+        {
+        case Tuple::Empty:
+            return QVariant();
+        case Tuple::String:
+            return QString(tuple.get_str(s_fields[col]));
+        case Tuple::Int:
+            val = tuple.get_int(s_fields[col]);
+            break;
+        case Tuple::DateTime:
+            int64_t t = tuple.get_int64(s_fields[col]);
+            if (t > 0)
+            {
+                QDateTime dt = QDateTime::fromSecsSinceEpoch(t).toLocalTime();
+                return QLocale().toString(dt, QLocale::ShortFormat);
+            }
+            return QString();
+        }
+    }
+
+    switch (col)
+    {
+    case EntryNumber:
+        return QVariant(row + 1);
+    case Length:
+        return QString(str_format_time(val));
+    case Bitrate:
+        return QString(str_printf(_("%d kbit/s"), val));
+    default:
+        return QVariant(val);
+    }
+}
+
 QVariant PlaylistModel::data(const QModelIndex & index, int role) const
 {
     int col = index.column() - 1;
     if (col < 0 || col >= n_cols)
         return QVariant();
 
-    Tuple tuple;
-    int val = -1;
-
     switch (role)
     {
     case Qt::DisplayRole:
-        if (s_fields[col] != Tuple::Invalid)
-        {
-            tuple = m_playlist.entry_tuple(index.row(), Playlist::NoWait);
-
-            if (col == Filename)
-                return filename(tuple);
+    {
+        /* queue positions renumber without a per-entry update, so serve them
+         * fresh; they're a plain lookup with no formatting anyway */
+        if (col == QueuePos)
+            return queuePos(index.row());
 
-            switch (tuple.get_value_type(s_fields[col]))
-            {
-            case Tuple::Empty:
-                return QVariant();
-            case Tuple::String:
-                return QString(tuple.get_str(s_fields[col]));
-            case Tuple::Int:
-                val = tuple.get_int(s_fields[col]);
-                break;
-            case Tuple::DateTime:
-                int64_t t = tuple.get_int64(s_fields[col]);
-                if (t > 0)
-                {
-                    QDateTime dt = QDateTime::fromSecsSinceEpoch(t).toLocalTime();
-                    return QLocale().toString(dt, QLocale::ShortFormat);
-                }
-                return QString();
-            }
+        int row = index.row();
+        auto it = m_rowCache.find(row);
+        if (it == m_rowCache.end())
+        {
+            if (m_rowCache.size() >= MaxCachedRows)
+                m_rowCache.clear();
+            it = m_rowCache.insert(row, CachedRow());
         }
 
-        switch (col)
+        if (!it->filled[col])
         {
-        case EntryNumber:
-            return QVariant(index.row() + 1);
-        case QueuePos:
-            return queuePos(index.row());
-        case Length:
-            return QString(str_format_time(val));
-        case Bitrate:
-            return QString(str_printf(_("%d kbit/s"), val));
-        default:
-            return QVariant(val);
+            it->display[col] = displayData(row, col);
+            it->filled[col] = true;
         }
 
+        return it->display[col];
+    }
+
     case Qt::FontRole:
         if (index.row() == m_playlist.get_position())
             return m_bold;
@@ -272,6 +297,8 @@ void PlaylistModel::entriesAdded(int row, int count)
     if (count < 1)
         return;
 
+    m_rowCache.clear(); /* rows at or past the insertion point renumber */
+
     int last = row + count - 1;
     beginInsertRows(QModelIndex(), row, last);
     m_rows += count;
@@ -283,6 +310,8 @@ void PlaylistModel::entriesRemoved(int row, int count)
     if (count < 1)
         return;
 
+    m_rowCache.clear(); /* rows past the removed range renumber */
+
     int last = row + count - 1;
     beginRemoveRows(QModelIndex(), row, last);
     m_rows -= count;
@@ -294,6 +323,14 @@ void PlaylistModel::entriesChanged(int row, int count)
     if (count < 1)
         return;
 
+    for (auto it = m_rowCache.begin(); it != m_rowCache.end();)
+    {
+        if (it.key() >= row && it.key() < row + count)
+            it = m_rowCache.erase(it);
+        else
+            ++it;
+    }
+
     int bottom = row + count - 1;
     auto topLeft = createIndex(row, 0);
     auto bottomRight = createIndex(bottom, columnCount() - 1);
@@ -21,6 +21,7 @@
 #define PLAYLIST_MODEL_H
 
 #include <QAbstractListModel>
+#include <QHash>
 #include <QSortFilterProxyModel>
 
 #include <libaudcore/playlist.h>
@@ -80,12 +81,26 @@ public:
     void setPlayingCol(int playing_col);
 
 private:
+    /* Formatted DisplayRole values, cached per row so that scrolling doesn't
+     * re-run tuple lookup and title formatting on every repaint.  Invalidated
+     * by the playlist-update ranges via entriesChanged(); add/remove shift row
+     * numbers, so those drop the whole cache. */
+    struct CachedRow
+    {
+        QVariant display[n_cols];
+        bool filled[n_cols] {};
+    };
+
+    static constexpr int MaxCachedRows = 5000;
+
     Playlist m_playlist;
     int m_rows;
     QFont m_bold;
     int m_playing_col = -1;
+    mutable QHash<int, CachedRow> m_rowCache;
 
     QVariant alignment(int col) const;
+    QVariant displayData(int row, int col) const;
     QString queuePos(int row) const;
     QString filename(const Tuple & tuple) const;
 };
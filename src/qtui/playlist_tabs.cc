@@ -208,11 +208,14 @@ void PlaylistTabs::playlist_update_cb(Playlist::UpdateLevel global_level)
     m_in_update = true;
     if (global_level == Playlist::Structure)
         addRemovePlaylists();
-    if (global_level >= Playlist::Metadata)
-        m_tabbar->updateTitles();
 
     for (int i = 0; i < count(); i++)
-        playlistWidget(i)->playlistUpdate();
+    {
+        /* the title and entry count shown in the tab label can only have
+         * changed if this playlist has a pending update of its own */
+        if (playlistWidget(i)->playlistUpdate() >= Playlist::Metadata)
+            m_tabbar->updateTabText(i);
+    }
 
     setCurrentIndex(Playlist::active_playlist().index());
     m_in_update = false;
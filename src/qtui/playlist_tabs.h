@@ -76,6 +76,7 @@ public:
     PlaylistTabBar(QWidget * parent = nullptr);
 
     void updateTitles();
+    void updateTabText(int idx);
     void updateIcons();
     void startRename(Playlist playlist);
     bool cancelRename();
@@ -87,7 +88,6 @@ protected:
 
 private:
     QLineEdit * getTabEdit(int idx);
-    void updateTabText(int idx);
     void setupTab(int idx, QWidget * button, QWidget ** oldp);
     void tabMoved(int from, int to);
     void updateSettings();
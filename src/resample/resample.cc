@@ -29,6 +29,10 @@
 #define MAX_RATE 192000
 #define RATE_STEP 50
 
+/* input frames handed to libsamplerate per call, independent of the chain
+ * block size */
+#define BATCH_FRAMES 4096
+
 #define RESAMPLE_ERROR(e) AUDERR ("%s\n", src_strerror (e))
 
 class Resampler : public EffectPlugin
@@ -137,6 +141,12 @@ void Resampler::start (int & channels, int & rate)
     stored_channels = channels;
     ratio = (double) new_rate / rate;
     rate = new_rate;
+
+    /* preallocate worst-case scratch for a half second of output; Index never
+     * shrinks its allocation, so steady-state processing does not reallocate
+     * even across ratio changes in mixed-rate playlists */
+    buffer.resize (channels * (new_rate / 2));
+    buffer.resize (0);
 }
 
 Index<float> & Resampler::resample (Index<float> & data, bool finish)
@@ -144,25 +154,44 @@ Index<float> & Resampler::resample (Index<float> & data, bool finish)
     if (! state || ! data.len ())
         return data;
 
-    buffer.resize ((int) (data.len () * ratio) + 256);
-
-    SRC_DATA d = SRC_DATA ();
-
-    d.data_in = data.begin ();
-    d.input_frames = data.len () / stored_channels;
-    d.data_out = buffer.begin ();
-    d.output_frames = buffer.len () / stored_channels;
-    d.src_ratio = ratio;
-    d.end_of_input = finish;
+    int in_total = data.len () / stored_channels;
+    int in_done = 0, out_done = 0;
+    bool flushing = finish;
 
-    int error;
-    if ((error = src_process (state, & d)))
+    while (in_done < in_total || flushing)
     {
-        RESAMPLE_ERROR (error);
-        return data;
+        /* make room for the worst-case output of one batch (a no-op after the
+         * preallocation in start) */
+        int out_need = (int) (BATCH_FRAMES * ratio) + 256;
+        if (buffer.len () / stored_channels - out_done < out_need)
+            buffer.resize (stored_channels * (out_done + out_need));
+
+        SRC_DATA d = SRC_DATA ();
+
+        d.data_in = data.begin () + stored_channels * in_done;
+        d.input_frames = aud::min (BATCH_FRAMES, in_total - in_done);
+        d.data_out = & buffer[stored_channels * out_done];
+        d.output_frames = buffer.len () / stored_channels - out_done;
+        d.src_ratio = ratio;
+        d.end_of_input = (finish && in_done + d.input_frames == in_total);
+
+        int error;
+        if ((error = src_process (state, & d)))
+        {
+            RESAMPLE_ERROR (error);
+            return data;
+        }
+
+        in_done += d.input_frames_used;
+        out_done += d.output_frames_gen;
+
+        if (d.end_of_input)
+            flushing = (d.output_frames_gen > 0);
+        else if (! d.input_frames_used && ! d.output_frames_gen)
+            break; /* avoid spinning if the converter stalls */
     }
 
-    buffer.resize (stored_channels * d.output_frames_gen);
+    buffer.resize (stored_channels * out_done);
 
     if (finish)
         flush (true);
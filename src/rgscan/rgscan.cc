@@ -0,0 +1,395 @@
+/*
+ * rgscan.cc
+ * Copyright 2025 Audacious team
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions, and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions, and the following disclaimer in the documentation
+ *    provided with the distribution.
+ *
+ * This software is provided "as is" and without any warranty, express or
+ * implied. In no event shall the authors be liable for any damages arising from
+ * the use of this software.
+ */
+
+#include <math.h>
+#include <pthread.h>
+
+#include <libaudcore/audstrings.h>
+#include <libaudcore/drct.h>
+#include <libaudcore/i18n.h>
+#include <libaudcore/plugin.h>
+#include <libaudcore/preferences.h>
+#include <libaudcore/probe.h>
+#include <libaudcore/runtime.h>
+#include <libaudcore/templates.h>
+#include <libaudcore/tuple.h>
+
+/* Audacious can apply ReplayGain but has never been able to compute it,
+ * forcing a second full decode of every file through an external
+ * scanner.  There is no API for a plugin to decode a file offline, but
+ * there is a decode pass already happening: playback.  This effect sits
+ * at the head of the effect chain, measures EBU R 128 loudness (BS.1770
+ * K-weighting, 400 ms gated blocks) of each song as it plays, and when
+ * a song ends naturally -- no seeking, played start to finish -- hands
+ * the result to a worker thread that writes ReplayGain 2.0 tags through
+ * the input plugin that owns the file.  Tagging the library thus costs
+ * nothing beyond listening to it. */
+
+class RGScanner : public EffectPlugin
+{
+public:
+    static const char about[];
+    static const char * const defaults[];
+    static const PreferencesWidget widgets[];
+    static const PluginPreferences prefs;
+
+    static constexpr PluginInfo info = {
+        N_("ReplayGain Analyzer"),
+        PACKAGE,
+        about,
+        & prefs
+    };
+
+    constexpr RGScanner () : EffectPlugin (info, 0, true) {}
+
+    bool init () override;
+    void cleanup () override;
+
+    void start (int & channels, int & rate) override;
+    Index<float> & process (Index<float> & data) override;
+    bool flush (bool force) override;
+    Index<float> & finish (Index<float> & data, bool end_of_playlist) override;
+};
+
+EXPORT RGScanner aud_plugin_instance;
+
+const char RGScanner::about[] =
+ N_("ReplayGain Analyzer Plugin\n\n"
+    "Measures EBU R 128 loudness while songs play and writes ReplayGain "
+    "tags for every song that is played through from start to finish, so "
+    "the library gets tagged without a separate scanning pass.\n\n"
+    "Songs that already carry ReplayGain information are skipped unless "
+    "configured otherwise.");
+
+const char * const RGScanner::defaults[] = {
+    "target_lufs", "-18",
+    "skip_tagged", "TRUE",
+    nullptr
+};
+
+const PreferencesWidget RGScanner::widgets[] = {
+    WidgetLabel (N_("<b>ReplayGain Analyzer</b>")),
+    WidgetSpin (N_("Target loudness:"),
+        WidgetFloat ("rgscan", "target_lufs"),
+        {-30, -10, 1, N_("LUFS")}),
+    WidgetCheck (N_("Skip files that already have ReplayGain information"),
+        WidgetBool ("rgscan", "skip_tagged"))
+};
+
+const PluginPreferences RGScanner::prefs = {{widgets}};
+
+/* BS.1770 K-weighting: a high shelf modelling the acoustic effect of
+ * the head, then a high pass.  The reference coefficients are given at
+ * 48 kHz only; these formulas reproduce them and generalize to any
+ * sample rate (the same parametrization used by libebur128). */
+struct Biquad
+{
+    double b0, b1, b2, a1, a2;
+};
+
+static Biquad design_shelf (double rate)
+{
+    const double f0 = 1681.9744509555319;
+    const double G = 3.99984385397;
+    const double Q = 0.7071752369554193;
+
+    double K = tan (M_PI * f0 / rate);
+    double Vh = pow (10, G / 20);
+    double Vb = pow (Vh, 0.4996667741545416);
+    double a0 = 1 + K / Q + K * K;
+
+    return {(Vh + Vb * K / Q + K * K) / a0,
+            2 * (K * K - Vh) / a0,
+            (Vh - Vb * K / Q + K * K) / a0,
+            2 * (K * K - 1) / a0,
+            (1 - K / Q + K * K) / a0};
+}
+
+static Biquad design_highpass (double rate)
+{
+    const double f0 = 38.13547087602444;
+    const double Q = 0.5003270373238773;
+
+    double K = tan (M_PI * f0 / rate);
+    double a0 = 1 + K / Q + K * K;
+
+    return {1, -2, 1,
+            2 * (K * K - 1) / a0,
+            (1 - K / Q + K * K) / a0};
+}
+
+/* measurement state; touched only from the output thread */
+static int chan_count;
+static Biquad shelf, highpass;
+static double shelf_z1[AUD_MAX_CHANNELS], shelf_z2[AUD_MAX_CHANNELS];
+static double hp_z1[AUD_MAX_CHANNELS], hp_z2[AUD_MAX_CHANNELS];
+
+static int subblock_frames;      /* 100 ms hop */
+static int subblock_filled;
+static double subblock_accum;
+static double subblock_ring[4];  /* last four hops = one 400 ms block */
+static int subblocks_seen;
+
+static Index<double> block_energies;
+static double peak_level;
+static bool measurement_valid;
+static String current_file;
+
+/* tag-writing worker, fed one job per fully played song */
+struct GainResult
+{
+    String filename;
+    double gain, peak;
+};
+
+static pthread_t writer;
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+static Index<GainResult> jobs;
+static bool writer_running = false;
+static bool writer_quit = false;
+
+static void write_gain (const GainResult & job)
+{
+    VFSFile file (job.filename, "r");
+    if (! file)
+        return;
+
+    PluginHandle * decoder = aud_file_find_decoder (job.filename, true, file);
+    if (! decoder)
+        return;
+
+    Tuple tuple;
+    if (! aud_file_read_tag (job.filename, decoder, file, tuple))
+        return;
+
+    if (aud_get_bool ("rgscan", "skip_tagged") &&
+     tuple.get_value_type (Tuple::TrackGain) != Tuple::Empty)
+    {
+        AUDDBG ("%s already has ReplayGain, skipping.\n", (const char *) job.filename);
+        return;
+    }
+
+    tuple.set_gain (Tuple::TrackGain, Tuple::GainDivisor,
+     str_printf ("%.2f", job.gain));
+    tuple.set_gain (Tuple::TrackPeak, Tuple::PeakDivisor,
+     str_printf ("%.6f", job.peak));
+
+    if (aud_file_write_tuple (job.filename, decoder, tuple))
+        AUDINFO ("Wrote ReplayGain %.2f dB (peak %.6f) to %s.\n",
+         job.gain, job.peak, (const char *) job.filename);
+    else
+        AUDWARN ("Could not write ReplayGain tag to %s.\n",
+         (const char *) job.filename);
+}
+
+static void * writer_func (void *)
+{
+    pthread_mutex_lock (& mutex);
+
+    while (! writer_quit)
+    {
+        if (! jobs.len ())
+        {
+            pthread_cond_wait (& cond, & mutex);
+            continue;
+        }
+
+        GainResult job = std::move (jobs[0]);
+        jobs.remove (0, 1);
+        pthread_mutex_unlock (& mutex);
+
+        write_gain (job);
+
+        pthread_mutex_lock (& mutex);
+    }
+
+    pthread_mutex_unlock (& mutex);
+    return nullptr;
+}
+
+static void queue_result (GainResult && job)
+{
+    pthread_mutex_lock (& mutex);
+
+    jobs.append (std::move (job));
+
+    if (! writer_running && ! pthread_create (& writer, nullptr, writer_func, nullptr))
+        writer_running = true;
+
+    pthread_cond_signal (& cond);
+    pthread_mutex_unlock (& mutex);
+}
+
+bool RGScanner::init ()
+{
+    aud_config_set_defaults ("rgscan", defaults);
+    return true;
+}
+
+void RGScanner::cleanup ()
+{
+    pthread_mutex_lock (& mutex);
+    writer_quit = true;
+    pthread_cond_signal (& cond);
+    bool running = writer_running;
+    writer_running = false;
+    pthread_mutex_unlock (& mutex);
+
+    if (running)
+        pthread_join (writer, nullptr);
+
+    writer_quit = false;
+    jobs.clear ();
+    block_energies.clear ();
+    current_file = String ();
+}
+
+void RGScanner::start (int & channels, int & rate)
+{
+    chan_count = channels;
+
+    shelf = design_shelf (rate);
+    highpass = design_highpass (rate);
+
+    for (int c = 0; c < channels; c ++)
+        shelf_z1[c] = shelf_z2[c] = hp_z1[c] = hp_z2[c] = 0;
+
+    subblock_frames = rate / 10;
+    subblock_filled = 0;
+    subblock_accum = 0;
+    subblocks_seen = 0;
+
+    block_energies.resize (0);
+    peak_level = 0;
+
+    current_file = String (aud_drct_get_filename ());
+    measurement_valid = (bool) current_file;
+}
+
+Index<float> & RGScanner::process (Index<float> & data)
+{
+    if (! measurement_valid)
+        return data;
+
+    const float * f = data.begin ();
+    int frames = data.len () / chan_count;
+
+    for (int i = 0; i < frames; i ++)
+    {
+        double energy = 0;
+
+        for (int c = 0; c < chan_count; c ++)
+        {
+            double x = * f ++;
+            peak_level = aud::max (peak_level, fabs (x));
+
+            /* two cascaded biquads, transposed direct form II */
+            double y = shelf.b0 * x + shelf_z1[c];
+            shelf_z1[c] = shelf.b1 * x - shelf.a1 * y + shelf_z2[c];
+            shelf_z2[c] = shelf.b2 * x - shelf.a2 * y;
+
+            double z = highpass.b0 * y + hp_z1[c];
+            hp_z1[c] = highpass.b1 * y - highpass.a1 * z + hp_z2[c];
+            hp_z2[c] = highpass.b2 * y - highpass.a2 * z;
+
+            energy += z * z;
+        }
+
+        subblock_accum += energy;
+
+        if (++ subblock_filled == subblock_frames)
+        {
+            subblock_ring[subblocks_seen % 4] = subblock_accum / subblock_frames;
+            subblocks_seen ++;
+
+            if (subblocks_seen >= 4)
+                block_energies.append ((subblock_ring[0] + subblock_ring[1] +
+                 subblock_ring[2] + subblock_ring[3]) / 4);
+
+            subblock_accum = 0;
+            subblock_filled = 0;
+        }
+    }
+
+    return data;
+}
+
+bool RGScanner::flush (bool force)
+{
+    /* a seek (or manual song change) means the measurement no longer
+     * covers the whole song */
+    measurement_valid = false;
+    return true;
+}
+
+Index<float> & RGScanner::finish (Index<float> & data, bool end_of_playlist)
+{
+    process (data);
+
+    if (measurement_valid && block_energies.len ())
+    {
+        /* BS.1770 two-stage gating: drop blocks below -70 LUFS, then
+         * drop blocks more than 10 LU below the mean of the rest */
+        const double absolute_gate = pow (10, (-70 + 0.691) / 10);
+
+        double sum = 0;
+        int count = 0;
+
+        for (double e : block_energies)
+        {
+            if (e >= absolute_gate)
+            {
+                sum += e;
+                count ++;
+            }
+        }
+
+        if (count)
+        {
+            double relative_gate = (sum / count) * 0.1;  /* -10 LU */
+
+            sum = 0;
+            count = 0;
+
+            for (double e : block_energies)
+            {
+                if (e >= absolute_gate && e >= relative_gate)
+                {
+                    sum += e;
+                    count ++;
+                }
+            }
+        }
+
+        if (count)
+        {
+            double loudness = -0.691 + 10 * log10 (sum / count);
+            double gain = aud_get_double ("rgscan", "target_lufs") - loudness;
+
+            AUDDBG ("%s: %.2f LUFS, gain %.2f dB, peak %.6f\n",
+             (const char *) current_file, loudness, gain, peak_level);
+
+            queue_result ({current_file, gain, peak_level});
+        }
+    }
+
+    measurement_valid = false;
+    return data;
+}
@@ -14,11 +14,10 @@
 #include <pthread.h>
 #include <string.h>
 #include <glib.h>
-#include <libxml/parser.h>
-#include <libxml/xpath.h>
 
 //audacious includes
 #include <libaudcore/i18n.h>
+#include <libaudcore/index.h>
 #include <libaudcore/mainloop.h>
 #include <libaudcore/preferences.h>
 #include <libaudcore/runtime.h>
@@ -80,6 +79,7 @@ extern gboolean read_authentication_test_result(String &error_code, String &erro
 extern gboolean read_token(String &error_code, String &error_detail);
 extern gboolean read_session_key(String &error_code, String &error_detail);
 extern gboolean read_scrobble_result(String &error_code, String &error_detail, gboolean *ignored, String &ignored_code);
+extern gboolean read_batch_scrobble_result(String &error_code, String &error_detail, Index<String> &ignored_codes);
 
 //scrobbler.c
 extern StringBuf clean_string(const char *string);
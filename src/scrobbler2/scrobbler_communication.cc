@@ -22,6 +22,9 @@
 //plugin includes
 #include "scrobbler.h"
 
+//last.fm's track.scrobble call accepts at most 50 tracks per request
+#define SCROBBLES_PER_BATCH 50
+
 typedef struct {
     String paramName;
     String argument;
@@ -72,6 +75,33 @@ static char * scrobbler_get_signature (Index<API_Parameter> & params)
     return g_compute_checksum_for_string (G_CHECKSUM_MD5, buf, -1);
 }
 
+static String create_message_from_params (const char * method_name,
+ Index<API_Parameter> & params)
+{
+    StringBuf buf = str_concat ({"method=", method_name});
+
+    for (const API_Parameter & param : params)
+    {
+        char * esc = curl_easy_escape (curlHandle, param.argument, 0);
+        buf.insert (-1, "&");
+        buf.insert (-1, param.paramName);
+        buf.insert (-1, "=");
+        buf.insert (-1, esc ? esc : "");
+        curl_free (esc);
+    }
+
+    params.append (String ("method"), String (method_name));
+
+    char * api_sig = scrobbler_get_signature (params);
+    buf.insert (-1, "&api_sig=");
+    buf.insert (-1, api_sig);
+    g_free (api_sig);
+
+    AUDDBG ("FINAL message: %s.\n", (const char *) buf);
+
+    return String (buf);
+}
+
 /*
  * n_args should count with the given authentication parameters
  * At most 2: api_key, session_key.
@@ -86,9 +116,6 @@ static char * scrobbler_get_signature (Index<API_Parameter> & params)
 static String create_message_to_lastfm (const char * method_name, int n_args, ...)
 {
     Index<API_Parameter> params;
-    params.append (String ("method"), String (method_name));
-
-    StringBuf buf = str_concat ({"method=", method_name});
 
     va_list vl;
     va_start (vl, n_args);
@@ -99,25 +126,11 @@ static String create_message_to_lastfm (const char * method_name, int n_args, ..
         const char * arg = va_arg (vl, const char *);
 
         params.append (String (name), String (arg));
-
-        char * esc = curl_easy_escape (curlHandle, arg, 0);
-        buf.insert (-1, "&");
-        buf.insert (-1, name);
-        buf.insert (-1, "=");
-        buf.insert (-1, esc ? esc : "");
-        curl_free (esc);
     }
 
     va_end (vl);
 
-    char * api_sig = scrobbler_get_signature (params);
-    buf.insert (-1, "&api_sig=");
-    buf.insert (-1, api_sig);
-    g_free (api_sig);
-
-    AUDDBG ("FINAL message: %s.\n", (const char *) buf);
-
-    return String (buf);
+    return create_message_from_params (method_name, params);
 }
 
 static gboolean send_message_to_lastfm (const char * data)
@@ -301,6 +314,13 @@ static void set_timestamp_to_current(char **line) {
 static void delete_lines_from_scrobble_log (GSList **lines_to_remove_ptr, GSList **lines_to_retry_ptr, char *queuepath) {
     GSList *lines_to_remove = *lines_to_remove_ptr;
     GSList *lines_to_retry = *lines_to_retry_ptr;
+
+    if (lines_to_remove == nullptr && lines_to_retry == nullptr) {
+        //nothing was consumed; leave the journal untouched instead of
+        //rewriting an identical copy of it
+        return;
+    }
+
     char *contents = nullptr;
     char **lines = nullptr;
     char **finallines = g_new (char *, 1);
@@ -407,86 +427,110 @@ static void scrobble_cached_queue() {
     } else {
         lines = g_strsplit(contents, "\n", 0);
 
-        for (int i = 0; lines[i] != nullptr && scrobbling_enabled; i++) {
-            if (!strlen(lines[i])) continue;
+        int i = 0;
+        while (lines[i] != nullptr && scrobbling_enabled) {
+            //collect the next batch of valid entries from the journal
+            int batch_indexes[SCROBBLES_PER_BATCH];
+            char **batch_lines[SCROBBLES_PER_BATCH];
+            int batch_size = 0;
+
+            for (; lines[i] != nullptr && batch_size < SCROBBLES_PER_BATCH; i++) {
+                if (!strlen(lines[i])) continue;
+
+                line = g_strsplit(lines[i], "\t", 0);
+
+                //line[0] line[1] line[2] line[3] line[4] line[5] line[6]   line[7]      line[8]
+                //artist  album   title   number  length  "L"     timestamp album_artist nullptr
+
+                if (is_valid_scrobble_format(line)) {
+                    batch_indexes[batch_size] = i;
+                    batch_lines[batch_size] = line;
+                    batch_size++;
+                } else {
+                    AUDDBG("Unscrobbable line.\n");
+                    //leave entry on the cache file
+                    g_strfreev(line);
+                }
+            }
+
+            if (batch_size == 0) continue;
+
+            //one track.scrobble call covers the whole batch
+            Index<API_Parameter> params;
+            for (int j = 0; j < batch_size; j++) {
+                char **fields = batch_lines[j];
+                params.append (String (str_printf ("artist[%i]", j)), String (fields[0]));
+                params.append (String (str_printf ("album[%i]", j)), String (fields[1]));
+                params.append (String (str_printf ("track[%i]", j)), String (fields[2]));
+                params.append (String (str_printf ("trackNumber[%i]", j)), String (fields[3]));
+                params.append (String (str_printf ("duration[%i]", j)), String (fields[4]));
+                params.append (String (str_printf ("timestamp[%i]", j)), String (fields[6]));
+                //in case cache uses old format without album artist field
+                params.append (String (str_printf ("albumArtist[%i]", j)),
+                 String (fields[7] != nullptr ? fields[7] : ""));
+            }
+            params.append (String ("api_key"), String (SCROBBLER_API_KEY));
+            params.append (String ("sk"), session_key);
 
-            line = g_strsplit(lines[i], "\t", 0);
-
-            //line[0] line[1] line[2] line[3] line[4] line[5] line[6]   line[7]      line[8]
-            //artist  album   title   number  length  "L"     timestamp album_artist nullptr
-
-            if (is_valid_scrobble_format(line))
-            {
-                String scrobblemsg = create_message_to_lastfm ("track.scrobble",
-                 9, "artist", line[0], "album", line[1], "track", line[2],
-                 "trackNumber", line[3], "duration", line[4],
-                 "timestamp", line[6],
-                 "albumArtist", line[7] != nullptr ? line[7] : "",  //in case cache uses old format without album artist field
-                 "api_key", SCROBBLER_API_KEY, "sk", (const char *) session_key);
-
-                if (send_message_to_lastfm(scrobblemsg) == true) {
-                    String error_code;
-                    String error_detail;
-                    gboolean ignored = false;
-                    String ignored_code;
-
-                    if (read_scrobble_result(error_code, error_detail, &ignored, ignored_code) == true) {
-                        AUDDBG("SCROBBLE OK. Error code: %s. Error detail: %s\n",
-                         (const char *)error_code, (const char *)error_detail);
-                        AUDDBG("SCROBBLE OK. ignored: %i.\n", ignored);
-                        AUDDBG("SCROBBLE OK. ignored code: %s.\n",
-                         (const char *)ignored_code);
-                        if (ignored == true && g_strcmp0(ignored_code, "3") == 0) { //3: Timestamp was too old
-                            AUDDBG("SCROBBLE IGNORED!!! %i, detail: %s\n",
-                             ignored, (const char *)ignored_code);
-                            save_line_to_remove(&lines_to_retry, i);
-                        } else if (ignored == true && g_strcmp0(ignored_code, "") == 0) { //5: Daily scrobble limit reached
+            String scrobblemsg = create_message_from_params ("track.scrobble", params);
+
+            if (send_message_to_lastfm(scrobblemsg) == true) {
+                String error_code;
+                String error_detail;
+                Index<String> ignored_codes;
+
+                if (read_batch_scrobble_result(error_code, error_detail, ignored_codes) == true) {
+                    AUDDBG("SCROBBLE OK. %i tracks submitted, %i results.\n",
+                     batch_size, ignored_codes.len());
+
+                    for (int j = 0; j < batch_size; j++) {
+                        //an absent ignoredMessage counts as accepted
+                        const char *code = (j < ignored_codes.len()) ?
+                         (const char *)ignored_codes[j] : "0";
+
+                        if (g_strcmp0(code, "3") == 0) { //3: Timestamp was too old
+                            AUDDBG("SCROBBLE IGNORED!!! code: %s\n", code);
+                            save_line_to_remove(&lines_to_retry, batch_indexes[j]);
+                        } else {
                            //TODO: a track might not be scrobbled due to "daily scrobble limit exeeded".
                            //This message comes on the ignoredMessage attribute, inside the XML of the response.
                            //We are not dealing with this case currently and are losing that scrobble.
-                           //TODO
-                        } else {
-                            AUDDBG("Not ignored. Carrying on...\n");
-                            save_line_to_remove(&lines_to_remove, i);
-                        }
-                    } else {
-                        AUDINFO("SCROBBLE NOT OK. Error code: %s. Error detail: %s.\n",
-                         (const char *)error_code, (const char *)error_detail);
-
-                        if (! error_code) { //net error(?) or the answer from last.fm was not well read
-                            //scrobble to be retried
-                        }
-                        else if (g_strcmp0(error_code, "11") == 0 ||
-                                 g_strcmp0(error_code, "16") == 0){
-                            //error code 11: Service Offline - This service is temporarily offline. Try again later.
-                            //error code 16: The service is temporarily unavailable, please try again.
-                            //scrobble to be retried
-                        }
-                        else if (g_strcmp0(error_code,  "9") == 0) {
-                            //Bad Session. Reauth.
-                            scrobbling_enabled = false;
-                            session_key = String();
-                            aud_set_str("scrobbler", "session_key", "");
-                        }
-                        else {
-                            save_line_to_remove(&lines_to_remove, i);
+                            save_line_to_remove(&lines_to_remove, batch_indexes[j]);
                         }
                     }
                 } else {
-                    AUDDBG("Could not scrobble a track on the queue. Network problem?\n");
-                    //scrobble to be retried
-                    scrobbling_enabled = false;
-                }
+                    AUDINFO("SCROBBLE NOT OK. Error code: %s. Error detail: %s.\n",
+                     (const char *)error_code, (const char *)error_detail);
 
-                //TODO: Avoid spamming last.fm --- It's not as simple as just adding a wait here:
-                //If audacious is closed while we're on this loop, tracks might be re-scrobbled.
-                //This shall be doable if we only pick one track at a time from the scrobbler.log
+                    if (! error_code) { //net error(?) or the answer from last.fm was not well read
+                        //batch to be retried
+                    }
+                    else if (g_strcmp0(error_code, "11") == 0 ||
+                             g_strcmp0(error_code, "16") == 0){
+                        //error code 11: Service Offline - This service is temporarily offline. Try again later.
+                        //error code 16: The service is temporarily unavailable, please try again.
+                        //batch to be retried
+                    }
+                    else if (g_strcmp0(error_code,  "9") == 0) {
+                        //Bad Session. Reauth.
+                        scrobbling_enabled = false;
+                        session_key = String();
+                        aud_set_str("scrobbler", "session_key", "");
+                    }
+                    else {
+                        for (int j = 0; j < batch_size; j++)
+                            save_line_to_remove(&lines_to_remove, batch_indexes[j]);
+                    }
+                }
             } else {
-                AUDDBG("Unscrobbable line.\n");
-                //leave entry on the cache file
+                AUDDBG("Could not scrobble a batch on the queue. Network problem?\n");
+                //batch to be retried
+                scrobbling_enabled = false;
             }
-            g_strfreev(line);
-        }//for
+
+            for (int j = 0; j < batch_size; j++)
+                g_strfreev(batch_lines[j]);
+        }//while
 
         delete_lines_from_scrobble_log(&lines_to_remove, &lines_to_retry, queuepath);
 
@@ -10,110 +10,114 @@
 //plugin includes
 #include "scrobbler.h"
 
-//static (private) variables
-static xmlDocPtr doc = nullptr;
-static xmlXPathContextPtr context = nullptr;
+#include <libxml/xmlreader.h>
 
-static gboolean prepare_data () {
-    received_data[received_data_size] = '\0';
-    AUDDBG("Data received from last.fm:\n%s\n%%%%End of data%%%%\n", received_data);
-
-    doc = xmlReadMemory(received_data, received_data_size, nullptr, nullptr, 0);
-    received_data_size = 0;
-    if (doc == nullptr) {
-        AUDDBG("Document not parsed successfully.\n");
-        return false;
-    }
-
-    context = xmlXPathNewContext(doc);
-    if (context == nullptr) {
-        AUDDBG("Error in xmlXPathNewContext\n");
-        xmlFreeDoc(doc);
-        doc = nullptr;
-        return false;
-    }
-
-    return true;
-}
+/*
+ * The last.fm responses are small, flat documents, so instead of building a
+ * DOM and running XPath queries over it, a single streaming pass with
+ * xmlTextReader collects the handful of fields any caller might want.  The
+ * read_* functions below then just inspect the collected record.
+ */
 
-static void clean_data() {
-    xmlXPathFreeContext(context);
-    xmlFreeDoc(doc);
-    context = nullptr;
-    doc = nullptr;
-}
+struct lfm_response {
+    String status;            // "ok" or "failed", from /lfm[@status]
+    String error_code;        // /lfm/error[@code]
+    String error_detail;      // /lfm/error text
+    String token;             // /lfm/token text
+    String user_name;         // /lfm/user/name text
+    String session_key;       // /lfm/session/key text
+    String scrobbles_ignored; // /lfm/scrobbles[@ignored]
 
-//returns:
-// nullptr if an error occurs or the attribute was not found
-// the attribute's value if it was found
-static String get_attribute_value (const char *node_expression, const char *attribute) {
-    if (doc == nullptr || context == nullptr) {
-        AUDDBG("Response from last.fm not parsed successfully. Did you call prepare_data?\n");
-        return String();
-    }
+    //one ignoredMessage code per /lfm/scrobbles/scrobble, in document order
+    Index<String> ignored_codes;
+};
 
-    xmlXPathObjectPtr statusObj = xmlXPathEvalExpression((xmlChar *) node_expression, context);
-    if (statusObj == nullptr) {
-        AUDDBG ("Error in xmlXPathEvalExpression.\n");
-        return String();
-    }
-    if (xmlXPathNodeSetIsEmpty(statusObj->nodesetval)) {
-        AUDDBG("No result.\n");
-        xmlXPathFreeObject(statusObj);
-        return String();
-    }
+//maximum element nesting we care about (/lfm/scrobbles/scrobble/ignoredMessage)
+#define MAX_DEPTH 4
 
-    xmlChar *prop = xmlGetProp(statusObj->nodesetval->nodeTab[0], (xmlChar *) attribute);
+static String reader_attribute (xmlTextReaderPtr reader, const char *name) {
+    xmlChar *prop = xmlTextReaderGetAttribute(reader, (const xmlChar *) name);
 
     String result;
     if (prop && prop[0])
-        result = String((const char *)prop);
+        result = String((const char *) prop);
 
-    xmlXPathFreeObject(statusObj);
     xmlFree(prop);
-
-    AUDDBG("RESULT FOR THIS FUNCTION: %s.\n", (const char *)result);
     return result;
 }
 
-//returns:
-// nullptr if an error occurs or the node was not found
-static String get_node_string (const char *node_expression) {
-    if (doc == nullptr || context == nullptr) {
-        AUDDBG("Response from last.fm not parsed successfully. Did you call prepare_data?\n");
-        return String();
-    }
+//returns FALSE if the response was not well-formed XML
+static gboolean parse_response (lfm_response &response) {
+    received_data[received_data_size] = '\0';
+    AUDDBG("Data received from last.fm:\n%s\n%%%%End of data%%%%\n", received_data);
 
-    xmlXPathObjectPtr statusObj = xmlXPathEvalExpression((xmlChar *) node_expression, context);
-    if (statusObj == nullptr) {
-        AUDDBG ("Error in xmlXPathEvalExpression.\n");
-        return String();
-    }
-    if (xmlXPathNodeSetIsEmpty(statusObj->nodesetval)) {
-        AUDDBG("No result.\n");
-        xmlXPathFreeObject(statusObj);
-        return String();
+    xmlTextReaderPtr reader = xmlReaderForMemory(received_data,
+     received_data_size, nullptr, nullptr, XML_PARSE_NOBLANKS);
+    received_data_size = 0;
+
+    if (reader == nullptr) {
+        AUDDBG("Could not create a reader for the received data.\n");
+        return false;
     }
 
-    xmlChar *string = xmlNodeListGetString(doc, statusObj->nodesetval->nodeTab[0]->children, 1);
+    String path[MAX_DEPTH]; //open element names, indexed by depth
+    int ret;
+
+    while ((ret = xmlTextReaderRead(reader)) == 1) {
+        int type = xmlTextReaderNodeType(reader);
+        int depth = xmlTextReaderDepth(reader);
+
+        if (type == XML_READER_TYPE_ELEMENT && depth < MAX_DEPTH) {
+            path[depth] = String((const char *) xmlTextReaderConstName(reader));
+
+            if (depth == 0 && !strcmp(path[0], "lfm"))
+                response.status = reader_attribute(reader, "status");
+            else if (depth == 1 && !strcmp(path[1], "error"))
+                response.error_code = reader_attribute(reader, "code");
+            else if (depth == 1 && !strcmp(path[1], "scrobbles"))
+                response.scrobbles_ignored = reader_attribute(reader, "ignored");
+            else if (depth == 3 && !strcmp(path[3], "ignoredMessage") &&
+             !strcmp(path[2], "scrobble")) {
+                String code = reader_attribute(reader, "code");
+                response.ignored_codes.append (code ? code : String("0"));
+            }
+        }
+        else if ((type == XML_READER_TYPE_TEXT ||
+         type == XML_READER_TYPE_CDATA) && depth >= 1 && depth <= MAX_DEPTH) {
+            const char *value = (const char *) xmlTextReaderConstValue(reader);
+            const String &parent = path[depth - 1];
+
+            if (!value || !value[0] || !parent)
+                continue;
+
+            if (depth == 2 && !strcmp(parent, "error"))
+                response.error_detail = String(value);
+            else if (depth == 2 && !strcmp(parent, "token"))
+                response.token = String(value);
+            else if (depth == 3 && !strcmp(parent, "name") && !strcmp(path[1], "user"))
+                response.user_name = String(value);
+            else if (depth == 3 && !strcmp(parent, "key") && !strcmp(path[1], "session"))
+                response.session_key = String(value);
+        }
+    }
 
-    String result;
-    if (string && string[0])
-        result = String((const char *) string);
+    xmlFreeTextReader(reader);
 
-    xmlXPathFreeObject(statusObj);
-    xmlFree(string);
+    if (ret != 0) {
+        AUDDBG("Document not parsed successfully.\n");
+        return false;
+    }
 
-    AUDDBG("RESULT FOR THIS FUNCTION: %s.\n", (const char *)result);
-    return result;
+    return true;
 }
 
 //returns:
 // nullptr if an error occurs
 // "true" if the the command succeeded
 // "false" if an error occurred. error_code and error_detail should be checked in this case
-static String check_status (String &error_code, String &error_detail) {
-    String status = get_attribute_value("/lfm[@status]", "status");
+static String check_status (const lfm_response &response, String &error_code,
+ String &error_detail) {
+    String status = response.status;
     if (!status) {
         AUDDBG("last.fm not answering according to the API.\n");
         return String();
@@ -121,13 +125,13 @@ static String check_status (String &error_code, String &error_detail) {
 
     AUDDBG ("status is %s.\n", (const char *)status);
     if (strcmp(status, "ok")) {
-        error_code = get_attribute_value("/lfm/error[@code]", "code");
+        error_code = response.error_code;
         if (!(*error_code)) {
             AUDDBG("Weird API answer. Last.fm says status is %s but there is no error code?\n",
              (const char *)status);
             status = String();
         } else {
-            error_detail = get_node_string("/lfm/error");
+            error_detail = response.error_detail;
         }
     }
 
@@ -150,144 +154,157 @@ gboolean read_scrobble_result(String &error_code, String &error_detail,
  gboolean *ignored, String &ignored_code) {
     *ignored = false;
 
-    gboolean result = true;
-
-    if (!prepare_data()) {
+    lfm_response response;
+    if (!parse_response(response)) {
         AUDDBG("Could not read received data from last.fm. What's up?\n");
         return false;
     }
 
-    String status = check_status(error_code, error_detail);
+    String status = check_status(response, error_code, error_detail);
 
     if (!status) {
         AUDDBG("Status was nullptr. Invalid API answer.\n");
-        clean_data();
         return false;
     }
 
     if (!strcmp(status, "failed")) {
         AUDDBG("Error code: %s. Detail: %s.\n", (const char *)error_code,
          (const char *)error_detail);
-        result = false;
-    } else {
-        //TODO: We are assuming that only one track is scrobbled per request! This will have to be
-        //re-done to support multiple tracks being scrobbled in batch
-        String ignored_scrobble = get_attribute_value("/lfm/scrobbles[@ignored]", "ignored");
-
-        if (ignored_scrobble && strcmp(ignored_scrobble, "0")) {
-          //The track was ignored
-          //TODO: this assumes ignored_scrobble == 1!!!
-          *ignored = true;
-          ignored_code = get_attribute_value("/lfm/scrobbles/scrobble/ignoredMessage[@code]", "code");
-        }
+        return false;
+    }
 
-        AUDDBG("ignored? %i, ignored_code: %s\n", *ignored, (const char *)ignored_code);
+    //TODO: We are assuming that only one track is scrobbled per request! This will have to be
+    //re-done to support multiple tracks being scrobbled in batch
+    if (response.scrobbles_ignored && strcmp(response.scrobbles_ignored, "0")) {
+        //The track was ignored
+        //TODO: this assumes ignored_scrobble == 1!!!
+        *ignored = true;
+        if (response.ignored_codes.len())
+            ignored_code = response.ignored_codes[0];
     }
 
-    clean_data();
-    return result;
+    AUDDBG("ignored? %i, ignored_code: %s\n", *ignored, (const char *)ignored_code);
+    return true;
+}
+
+/*
+ * Batch variant of read_scrobble_result for track.scrobble calls carrying
+ * several tracks.  Returns TRUE if the call itself succeeded; ignored_codes
+ * then holds one ignoredMessage code per submitted track, in submission
+ * order ("0" means the scrobble was accepted).
+ * On FALSE, error_code and error_detail must be checked as above.
+ */
+gboolean read_batch_scrobble_result(String &error_code, String &error_detail,
+ Index<String> &ignored_codes) {
+    lfm_response response;
+    if (!parse_response(response)) {
+        AUDDBG("Could not read received data from last.fm. What's up?\n");
+        return false;
+    }
+
+    String status = check_status(response, error_code, error_detail);
+
+    if (!status) {
+        AUDDBG("Status was nullptr. Invalid API answer.\n");
+        return false;
+    }
+
+    if (!strcmp(status, "failed")) {
+        AUDDBG("Error code: %s. Detail: %s.\n", (const char *)error_code,
+         (const char *)error_detail);
+        return false;
+    }
+
+    ignored_codes.move_from(response.ignored_codes, 0, -1, -1, true, true);
+    return true;
 }
 
 //returns
 //FALSE if there was an error with the connection
 gboolean read_authentication_test_result (String &error_code, String &error_detail) {
-    gboolean result = true;
-
-    if (!prepare_data()) {
+    lfm_response response;
+    if (!parse_response(response)) {
         AUDDBG("Could not read received data from last.fm. What's up?\n");
         return false;
     }
 
-    String status = check_status(error_code, error_detail);
+    String status = check_status(response, error_code, error_detail);
 
     if (!status) {
         AUDDBG("Status was nullptr. Invalid API answer.\n");
-        clean_data();
         return false;
     }
 
-    if (!strcmp(status, "failed")) {
-        result = false;
-    } else {
-        username = get_node_string("/lfm/user/name");
-        if (!username) {
-          AUDERR("last.fm not answering according to the API.\n");
-          result = false;
-        }
+    if (!strcmp(status, "failed"))
+        return false;
+
+    username = response.user_name;
+    if (!username) {
+        AUDERR("last.fm not answering according to the API.\n");
+        return false;
     }
 
-    clean_data();
-    return result;
+    return true;
 }
 
 gboolean read_token (String &error_code, String &error_detail) {
-    gboolean result = true;
-
-    if (!prepare_data()) {
+    lfm_response response;
+    if (!parse_response(response)) {
         AUDDBG("Could not read received data from last.fm. What's up?\n");
         return false;
     }
 
-    String status = check_status(error_code, error_detail);
+    String status = check_status(response, error_code, error_detail);
 
     if (!status) {
         AUDDBG("Status was nullptr. Invalid API answer.\n");
-        clean_data();
         return false;
     }
 
     if (!strcmp(status, "failed")) {
         AUDDBG("Error code: %s. Detail: %s.\n", (const char *)error_code,
          (const char *)error_detail);
-        result = false;
+        return false;
     }
-    else {
-        request_token = get_node_string("/lfm/token");
 
-        if (!request_token || !request_token[0]) {
-            AUDDBG("Could not read the received token. Something's wrong with the API?\n");
-            result = false;
-        }
-        else {
-            AUDDBG("This is the token: %s.\nNice? Nice.\n", (const char *)request_token);
-        }
+    request_token = response.token;
+
+    if (!request_token || !request_token[0]) {
+        AUDDBG("Could not read the received token. Something's wrong with the API?\n");
+        return false;
     }
 
-    clean_data();
-    return result;
+    AUDDBG("This is the token: %s.\nNice? Nice.\n", (const char *)request_token);
+    return true;
 }
 
 gboolean read_session_key(String &error_code, String &error_detail) {
-    gboolean result = true;
-
-    if (!prepare_data()) {
+    lfm_response response;
+    if (!parse_response(response)) {
         AUDDBG("Could not read received data from last.fm. What's up?\n");
         return false;
     }
 
-    String status = check_status(error_code, error_detail);
+    String status = check_status(response, error_code, error_detail);
 
     if (!status) {
         AUDDBG("Status was nullptr or empty. Invalid API answer.\n");
-        clean_data();
         return false;
     }
 
     if (!strcmp(status, "failed")) {
         AUDDBG("Error code: %s. Detail: %s.\n", (const char *)error_code,
          (const char *)error_detail);
-        result = false;
-    } else {
-        session_key = get_node_string("/lfm/session/key");
+        return false;
+    }
 
-        if (!session_key || !session_key[0]) {
-            AUDDBG("Could not read the received session key. Something's wrong with the API?\n");
-            result = false;
-        } else {
-            AUDDBG("This is the session key: %s.\n", (const char *)session_key);
-        }
+    session_key = response.session_key;
+
+    if (!session_key || !session_key[0]) {
+        AUDDBG("Could not read the received session key. Something's wrong with the API?\n");
+        return false;
     }
 
-    clean_data();
-    return result;
+    AUDDBG("This is the session key: %s.\n", (const char *)session_key);
+    return true;
 }
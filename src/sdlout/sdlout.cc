@@ -17,6 +17,8 @@
  * the use of this software.
  */
 
+#include <atomic>
+
 #include <math.h>
 #include <pthread.h>
 #include <string.h>
@@ -31,11 +33,16 @@
 #include <libaudcore/audstrings.h>
 #include <libaudcore/i18n.h>
 #include <libaudcore/plugin.h>
-#include <libaudcore/ringbuf.h>
 #include <libaudcore/runtime.h>
 
+#include "../output-common/spsc_ringbuf.h"
+
 #define VOLUME_RANGE 40 /* decibels */
 
+/* limits for the adaptive device period, in frames (powers of two) */
+#define PERIOD_MIN 256
+#define PERIOD_MAX 8192
+
 class SDLOutput : public OutputPlugin
 {
 public:
@@ -78,6 +85,7 @@ const char SDLOutput::about[] =
 const char * const SDLOutput::defaults[] = {
     "vol_left", "100",
     "vol_right", "100",
+    "period", "512",
     nullptr
 };
 
@@ -92,13 +100,26 @@ static int sdlout_chan, sdlout_rate;
 static SDL_AudioStream * sdlout_stream;
 #endif
 
-static RingBuf<unsigned char> buffer;
+static SPSCRingBuf<unsigned char> buffer;
 
-static bool prebuffer_flag, paused_flag;
+static bool prebuffer_flag, paused_flag, draining_flag;
 
 static int block_delay;
 static struct timeval block_time;
 
+/* One fixed period size cannot serve both weak and fast machines, so the
+ * period starts small and is retuned between streams: it is doubled as soon
+ * as a stream underruns more than once, and halved again only after several
+ * consecutive clean streams.  The counters are updated from the realtime
+ * callback with relaxed atomics and are published as "stat_*" config keys so
+ * they can be scraped externally. */
+static int period_frames;
+static int clean_streak, total_underruns;
+
+static std::atomic<int> underrun_count {0};
+static std::atomic<int> callback_count {0};
+static std::atomic<int64_t> fill_total {0};
+
 bool SDLOutput::init ()
 {
     aud_config_set_defaults ("sdlout", defaults);
@@ -179,10 +200,15 @@ static void apply_stereo_volume (unsigned char * data, int len)
 
 static void callback (void * user, unsigned char * buf, int len)
 {
-    pthread_mutex_lock (& sdlout_mutex);
+    /* The ring buffer is lock-free; the realtime thread must never block on
+     * sdlout_mutex while the playback thread holds it. */
+    int copy = buffer.move_out (buf, len);
+
+    if (copy < len && ! prebuffer_flag && ! paused_flag && ! draining_flag)
+        underrun_count.fetch_add (1, std::memory_order_relaxed);
 
-    int copy = aud::min (len, buffer.len ());
-    buffer.move_out (buf, copy);
+    callback_count.fetch_add (1, std::memory_order_relaxed);
+    fill_total.fetch_add (buffer.len (), std::memory_order_relaxed);
 
     if (sdlout_chan == 2)
         apply_stereo_volume (buf, copy);
@@ -194,12 +220,16 @@ static void callback (void * user, unsigned char * buf, int len)
 
     /* At this moment, we know that there is a delay of (at least) the block of
      * data just written.  We save the block size and the current time for
-     * estimating the delay later on. */
-    block_delay = aud::rescale (copy / (2 * sdlout_chan), sdlout_rate, 1000);
-    gettimeofday (& block_time, nullptr);
+     * estimating the delay later on.  If the playback thread holds the mutex,
+     * skip the update rather than block; the estimate is approximate anyway. */
+    if (! pthread_mutex_trylock (& sdlout_mutex))
+    {
+        block_delay = aud::rescale (copy / (2 * sdlout_chan), sdlout_rate, 1000);
+        gettimeofday (& block_time, nullptr);
+        pthread_mutex_unlock (& sdlout_mutex);
+    }
 
     pthread_cond_broadcast (& sdlout_cond);
-    pthread_mutex_unlock (& sdlout_mutex);
 }
 
 #if HAVE_LIBSDL3
@@ -237,8 +267,20 @@ bool SDLOutput::open_audio (int format, int rate, int chan, String & error)
 
     prebuffer_flag = true;
     paused_flag = false;
+    draining_flag = false;
+
+    if (! period_frames)
+        period_frames = aud_get_int ("sdlout", "period");
+
+    period_frames = aud::clamp (period_frames, PERIOD_MIN, PERIOD_MAX);
+
+    underrun_count.store (0, std::memory_order_relaxed);
+    callback_count.store (0, std::memory_order_relaxed);
+    fill_total.store (0, std::memory_order_relaxed);
 
 #if HAVE_LIBSDL3
+    SDL_SetHint (SDL_HINT_AUDIO_DEVICE_SAMPLE_FRAMES, str_printf ("%d", period_frames));
+
     const SDL_AudioSpec spec = { SDL_AUDIO_S16, chan, rate };
     sdlout_stream = SDL_OpenAudioDeviceStream (
      SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK, & spec, sdl3_callback, nullptr);
@@ -249,7 +291,7 @@ bool SDLOutput::open_audio (int format, int rate, int chan, String & error)
     spec.freq = rate;
     spec.format = AUDIO_S16;
     spec.channels = chan;
-    spec.samples = 4096;
+    spec.samples = period_frames;
     spec.callback = callback;
 
     if (SDL_OpenAudio (& spec, nullptr) < 0)
@@ -264,10 +306,43 @@ bool SDLOutput::open_audio (int format, int rate, int chan, String & error)
     return true;
 }
 
+/* retunes the period from the counters gathered over the last stream */
+static void update_period ()
+{
+    int underruns = underrun_count.exchange (0, std::memory_order_relaxed);
+    int callbacks = callback_count.exchange (0, std::memory_order_relaxed);
+    int64_t fill = fill_total.exchange (0, std::memory_order_relaxed);
+
+    int avg_fill = (callbacks && buffer.size ()) ?
+     aud::rescale ((int) (fill / callbacks), buffer.size (), 100) : 0;
+
+    if (underruns > 1 && period_frames < PERIOD_MAX)
+    {
+        period_frames <<= 1;
+        clean_streak = 0;
+    }
+    else if (! underruns && ++ clean_streak >= 3 && period_frames > PERIOD_MIN)
+    {
+        period_frames >>= 1;
+        clean_streak = 0;
+    }
+
+    total_underruns += underruns;
+
+    aud_set_int ("sdlout", "period", period_frames);
+    aud_set_int ("sdlout", "stat_underruns", total_underruns);
+    aud_set_int ("sdlout", "stat_avg_fill", avg_fill);
+
+    AUDINFO ("Stream had %d underruns, average fill %d%%; next period %d frames.\n",
+     underruns, avg_fill, period_frames);
+}
+
 void SDLOutput::close_audio ()
 {
     AUDDBG ("Closing audio.\n");
 
+    draining_flag = true;
+
 #if HAVE_LIBSDL3
     SDL_DestroyAudioStream (sdlout_stream);
     sdlout_stream = nullptr;
@@ -275,6 +350,7 @@ void SDLOutput::close_audio ()
     SDL_CloseAudio ();
 #endif
 
+    update_period ();
     buffer.destroy ();
 }
 
@@ -311,13 +387,7 @@ void SDLOutput::period_wait ()
 
 int SDLOutput::write_audio (const void * data, int len)
 {
-    pthread_mutex_lock (& sdlout_mutex);
-
-    len = aud::min (len, buffer.space ());
-    buffer.copy_in ((const unsigned char *) data, len);
-
-    pthread_mutex_unlock (& sdlout_mutex);
-    return len;
+    return buffer.copy_in ((const unsigned char *) data, len);
 }
 
 void SDLOutput::drain ()
@@ -325,11 +395,13 @@ void SDLOutput::drain ()
     AUDDBG ("Draining.\n");
     pthread_mutex_lock (& sdlout_mutex);
 
+    draining_flag = true;
     check_started ();
 
     while (buffer.len ())
         pthread_cond_wait (& sdlout_cond, & sdlout_mutex);
 
+    draining_flag = false;
     pthread_mutex_unlock (& sdlout_mutex);
 }
 
@@ -383,7 +455,18 @@ void SDLOutput::flush ()
     AUDDBG ("Seek requested; discarding buffer.\n");
     pthread_mutex_lock (& sdlout_mutex);
 
+    /* exclude the device callback so no stale block replays after the seek */
+#if HAVE_LIBSDL3
+    SDL_LockAudioStream (sdlout_stream);
+#else
+    SDL_LockAudio ();
+#endif
     buffer.discard ();
+#if HAVE_LIBSDL3
+    SDL_UnlockAudioStream (sdlout_stream);
+#else
+    SDL_UnlockAudio ();
+#endif
 
     prebuffer_flag = true;
 
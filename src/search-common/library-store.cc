@@ -0,0 +1,230 @@
+/*
+ * library-store.cc
+ * Copyright 2026 John Lindgren
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions, and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions, and the following disclaimer in the documentation
+ *    provided with the distribution.
+ *
+ * This software is provided "as is" and without any warranty, express or
+ * implied. In no event shall the authors be liable for any damages arising from
+ * the use of this software.
+ */
+
+#include "library-store.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include <libaudcore/audstrings.h>
+#include <libaudcore/runtime.h>
+#include <libaudcore/vfs.h>
+
+static StringBuf store_path ()
+    { return filename_build ({aud_get_path (AudPath::UserDir), "library-mtimes"}); }
+
+static String parent_dir (const char * path)
+{
+    const char * slash = strrchr (path, G_DIR_SEPARATOR);
+    if (! slash || slash == path)
+        return String ();
+
+    return String (str_copy (path, slash - path));
+}
+
+/* The snapshot is a text file in the user directory: the first line
+ * names the monitored folder, each further line is "<mtime> <path>",
+ * with paths percent-encoded so that they stay on one line. */
+
+void LibraryStore::load ()
+{
+    auto data = VFSFile::read_file (filename_to_uri (store_path ()), VFS_APPEND_NULL);
+    if (! data.len ())
+        return;
+
+    bool folder_ok = false;
+
+    for (const String & line : str_list_to_index (data.begin (), "\n"))
+    {
+        const char * space = strchr (line, ' ');
+        if (! space)
+            continue;
+
+        StringBuf path = str_decode_percent (space + 1);
+
+        if (! strncmp (line, "folder ", 7))
+        {
+            folder_ok = ! strcmp (path, m_folder);
+            continue;
+        }
+
+        if (! folder_ok)
+            continue;
+
+        String dir (path);
+        m_saved.add (dir, str_to_int64 (line));
+
+        String parent = parent_dir (dir);
+        if (parent)
+        {
+            auto subdirs = m_saved_dirs.lookup (parent);
+            if (! subdirs)
+                subdirs = m_saved_dirs.add (parent, Index<String> ());
+
+            subdirs->append (dir);
+        }
+    }
+}
+
+void LibraryStore::walk (const char * path, bool is_new)
+{
+    GStatBuf st;
+    if (g_stat (path, & st) < 0 || ! S_ISDIR (st.st_mode))
+        return;
+
+    /* symlinks could lead us in circles */
+    String id (str_printf ("%ld:%ld", (long) st.st_dev, (long) st.st_ino));
+    if (m_visited.lookup (id))
+        return;
+
+    m_visited.add (id, true);
+
+    String dir (path);
+    m_scanned.add (dir, (int64_t) st.st_mtime);
+
+    int64_t * saved = is_new ? nullptr : m_saved.lookup (dir);
+
+    if (! is_new && ! saved)
+    {
+        /* not in the snapshot; let the scanner add the whole subtree */
+        m_changed.append (String (filename_to_uri (path)));
+        is_new = true;
+    }
+
+    if (! is_new && * saved == (int64_t) st.st_mtime)
+    {
+        /* unchanged, so its entries are unchanged too; recurse into the
+         * subdirectories recorded in the snapshot without reading it */
+        auto subdirs = m_saved_dirs.lookup (dir);
+        if (subdirs)
+        {
+            for (const String & subdir : * subdirs)
+                walk (subdir, false);
+        }
+
+        return;
+    }
+
+    if (! is_new)
+        m_dirty ++;
+
+    GDir * folder = g_dir_open (path, 0, nullptr);
+    if (! folder)
+        return;
+
+    const char * entry;
+    while ((entry = g_dir_read_name (folder)))
+    {
+        StringBuf sub = filename_build ({path, entry});
+
+        if (g_file_test (sub, G_FILE_TEST_IS_DIR))
+            walk (sub, is_new);
+        else if (! is_new)
+            m_changed.append (String (filename_to_uri (sub)));
+    }
+
+    g_dir_close (folder);
+}
+
+bool LibraryStore::scan (const Index<String> & uris)
+{
+    m_valid = false;
+    m_folder = String ();
+    m_saved.clear ();
+    m_scanned.clear ();
+    m_saved_dirs.clear ();
+    m_visited.clear ();
+    m_changed.clear ();
+    m_dirty = 0;
+    m_missing = 0;
+
+    Index<String> folders;
+
+    for (const String & uri : uris)
+    {
+        if (strcmp (uri_get_scheme (uri), "file"))
+            return false;
+
+        StringBuf folder = uri_to_filename (uri);
+        if (! g_file_test (folder, G_FILE_TEST_IS_DIR))
+            return false;
+
+        folders.append (String (folder));
+    }
+
+    if (! folders.len ())
+        return false;
+
+    m_folder = String (index_to_str_list (folders, ";"));
+
+    load ();
+
+    for (const String & folder : folders)
+        walk (folder, false);
+
+    m_saved.iterate ([this] (const String & dir, int64_t & mtime)
+    {
+        if (! m_scanned.lookup (dir))
+            m_missing ++;
+    });
+
+    m_valid = true;
+    return true;
+}
+
+bool LibraryStore::file_unchanged (const char * file_uri)
+{
+    if (strcmp (uri_get_scheme (file_uri), "file"))
+        return false;
+
+    String dir = parent_dir (uri_to_filename (file_uri));
+    if (! dir)
+        return false;
+
+    int64_t * old_mtime = m_saved.lookup (dir);
+    int64_t * new_mtime = m_scanned.lookup (dir);
+
+    return old_mtime && new_mtime && * old_mtime == * new_mtime;
+}
+
+void LibraryStore::save ()
+{
+    if (! m_valid)
+        return;
+
+    Index<char> text;
+
+    StringBuf line = str_concat ({"folder ", str_encode_percent (m_folder), "\n"});
+    text.insert (line, -1, line.len ());
+
+    m_scanned.iterate ([& text] (const String & dir, int64_t & mtime)
+    {
+        StringBuf line = str_concat ({int64_to_str (mtime), " ",
+         str_encode_percent (dir), "\n"});
+        text.insert (line, -1, line.len ());
+    });
+
+    String uri (filename_to_uri (store_path ()));
+
+    if (! VFSFile::write_file (uri, text.begin (), text.len ()))
+        AUDWARN ("Could not save library snapshot to %s\n", (const char *) uri);
+}
@@ -0,0 +1,78 @@
+/*
+ * library-store.h
+ * Copyright 2026 John Lindgren
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions, and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions, and the following disclaimer in the documentation
+ *    provided with the distribution.
+ *
+ * This software is provided "as is" and without any warranty, express or
+ * implied. In no event shall the authors be liable for any damages arising from
+ * the use of this software.
+ */
+
+#ifndef LIBRARYSTORE_H
+#define LIBRARYSTORE_H
+
+#include <stdint.h>
+
+#include <libaudcore/index.h>
+#include <libaudcore/multihash.h>
+#include <libaudcore/objects.h>
+
+/* A snapshot of the directory modification times under the monitored
+ * library folder, persisted in the Audacious user directory and shared
+ * by the GTK and Qt search tools.  Comparing the snapshot against the
+ * folder at startup tells the library which subtrees actually changed,
+ * so an unchanged library skips the rescan (and its per-file metadata
+ * I/O) entirely, and a mostly unchanged one rescans only the changed
+ * directories. */
+
+class LibraryStore
+{
+public:
+    /* walks the folders, comparing against the snapshot saved by the
+     * previous session; returns false (leaving the store unusable, and
+     * the caller to do a full rescan) if any folder is non-local.  the
+     * snapshot is keyed to the exact set of folders, so changing the
+     * set forces one full rescan */
+    bool scan (const Index<String> & uris);
+
+    explicit operator bool () const { return m_valid; }
+
+    /* true if nothing under the folder changed since the snapshot */
+    bool unchanged () const
+        { return ! m_dirty && ! m_missing && ! m_changed.len (); }
+
+    /* true if the directory containing the file is unchanged */
+    bool file_unchanged (const char * file_uri);
+
+    /* URIs to rescan: the files of each changed directory, and each
+     * directory not in the snapshot (those are added recursively) */
+    const Index<String> & changed () const { return m_changed; }
+
+    /* saves the scanned mtimes as the new snapshot */
+    void save ();
+
+private:
+    void load ();
+    void walk (const char * path, bool is_new);
+
+    bool m_valid = false;
+    String m_folder;                       /* local paths, ";"-separated */
+    SimpleHash<String, int64_t> m_saved;   /* snapshot: directory to mtime */
+    SimpleHash<String, int64_t> m_scanned;
+    SimpleHash<String, Index<String>> m_saved_dirs;  /* directory to subdirectories */
+    SimpleHash<String, bool> m_visited;    /* device:inode, breaks symlink loops */
+    Index<String> m_changed;
+    int m_dirty = 0;    /* directories whose mtime changed */
+    int m_missing = 0;  /* snapshot directories no longer present */
+};
+
+#endif // LIBRARYSTORE_H
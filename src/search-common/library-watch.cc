@@ -0,0 +1,190 @@
+/*
+ * library-watch.cc
+ * Copyright 2026 John Lindgren
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions, and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions, and the following disclaimer in the documentation
+ *    provided with the distribution.
+ *
+ * This software is provided "as is" and without any warranty, express or
+ * implied. In no event shall the authors be liable for any damages arising from
+ * the use of this software.
+ */
+
+#include "library-watch.h"
+
+#ifdef __linux__
+
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+#include <glib.h>
+
+#include <libaudcore/audstrings.h>
+
+/* changes are reported this long after the last event, so that a burst
+ * triggers one rescan at the end rather than one per file */
+static const int debounce_ms = 2000;
+
+static const uint32_t watch_mask = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE |
+ IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF;
+
+void LibraryWatch::add_watch (const char * path)
+{
+    /* failure (e.g. the per-user watch limit) just degrades coverage */
+    int wd = inotify_add_watch (m_fd, path, watch_mask);
+    if (wd < 0)
+        return;
+
+    if (wd >= m_wd_paths.len ())
+        m_wd_paths.insert (-1, wd + 1 - m_wd_paths.len ());
+
+    m_wd_paths[wd] = String (path);
+}
+
+void LibraryWatch::walk (const char * path)
+{
+    add_watch (path);
+
+    GDir * folder = g_dir_open (path, 0, nullptr);
+    if (! folder)
+        return;
+
+    const char * entry;
+    while ((entry = g_dir_read_name (folder)))
+    {
+        StringBuf sub = filename_build ({path, entry});
+
+        /* symlinks could lead us in circles */
+        if (! g_file_test (sub, G_FILE_TEST_IS_SYMLINK) &&
+         g_file_test (sub, G_FILE_TEST_IS_DIR))
+            walk (sub);
+    }
+
+    g_dir_close (folder);
+}
+
+void LibraryWatch::worker ()
+{
+    /* registering watches stats every directory of the library, so it
+     * happens here rather than on the main thread */
+    for (const String & root : m_roots)
+        walk (root);
+
+    alignas (inotify_event) char buf[16384];
+    bool pending = false;
+
+    for (;;)
+    {
+        pollfd fds[2] = {{m_fd, POLLIN, 0}, {m_pipe[0], POLLIN, 0}};
+
+        int ret = poll (fds, 2, pending ? debounce_ms : -1);
+        if (ret < 0)
+            break;
+
+        if (! ret)
+        {
+            /* the folders went quiet; report the batch */
+            pending = false;
+            m_queued.queue (m_func);
+            continue;
+        }
+
+        if (fds[1].revents)
+            break;
+
+        int len = read (m_fd, buf, sizeof buf);
+        if (len <= 0)
+            break;
+
+        for (char * p = buf; p < buf + len;)
+        {
+            auto event = (const inotify_event *) p;
+            p += sizeof (inotify_event) + event->len;
+
+            /* watch folders as they appear so that files created inside
+             * them a moment later are not missed */
+            if ((event->mask & IN_ISDIR) &&
+             (event->mask & (IN_CREATE | IN_MOVED_TO)) &&
+             event->wd >= 0 && event->wd < m_wd_paths.len () &&
+             m_wd_paths[event->wd])
+                walk (filename_build ({m_wd_paths[event->wd], event->name}));
+
+            pending = true;
+        }
+    }
+}
+
+void LibraryWatch::start (const Index<String> & uris, ChangeFunc func)
+{
+    stop ();
+
+    for (const String & uri : uris)
+    {
+        if (strcmp (uri_get_scheme (uri), "file"))
+            continue;
+
+        StringBuf path = uri_to_filename (uri);
+        if (g_file_test (path, G_FILE_TEST_IS_DIR))
+            m_roots.append (String (path));
+    }
+
+    if (! m_roots.len ())
+        return;
+
+    m_func = func;
+    m_fd = inotify_init ();
+
+    if (m_fd < 0 || pipe (m_pipe) < 0 ||
+     pthread_create (& m_thread, nullptr, worker_cb, this))
+    {
+        stop ();
+        return;
+    }
+
+    m_started = true;
+}
+
+void LibraryWatch::stop ()
+{
+    if (m_started)
+    {
+        char c = 0;
+        if (write (m_pipe[1], & c, 1) < 0)
+            { } /* a 1-byte pipe write does not fail in practice */
+
+        pthread_join (m_thread, nullptr);
+        m_started = false;
+    }
+
+    if (m_fd >= 0)
+        close (m_fd); /* also removes all watches */
+
+    for (int i = 0; i < 2; i ++)
+    {
+        if (m_pipe[i] >= 0)
+            close (m_pipe[i]);
+        m_pipe[i] = -1;
+    }
+
+    m_fd = -1;
+    m_func = nullptr;
+    m_roots.clear ();
+    m_wd_paths.clear ();
+    m_queued.stop ();
+}
+
+#else // ! __linux__
+
+void LibraryWatch::start (const Index<String> &, ChangeFunc) { }
+void LibraryWatch::stop () { }
+
+#endif
@@ -0,0 +1,68 @@
+/*
+ * library-watch.h
+ * Copyright 2026 John Lindgren
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions, and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions, and the following disclaimer in the documentation
+ *    provided with the distribution.
+ *
+ * This software is provided "as is" and without any warranty, express or
+ * implied. In no event shall the authors be liable for any damages arising from
+ * the use of this software.
+ */
+
+#ifndef LIBRARYWATCH_H
+#define LIBRARYWATCH_H
+
+#include <pthread.h>
+
+#include <libaudcore/index.h>
+#include <libaudcore/mainloop.h>
+#include <libaudcore/objects.h>
+
+/* Watches the library folders recursively with inotify and calls back on
+ * the main loop when their contents change.  Events are batched on a
+ * worker thread and debounced, so a burst of changes (copying in an
+ * album, a mass retag) results in a single callback once the folder goes
+ * quiet; the callback is expected to rescan via Library::begin_add,
+ * which already limits the work to the changed subtrees.  On platforms
+ * without inotify, start() does nothing. */
+
+class LibraryWatch
+{
+public:
+    typedef void (* ChangeFunc) ();
+
+    LibraryWatch () = default;
+    ~LibraryWatch () { stop (); }
+
+    /* begins watching the given folders; non-local URIs are skipped */
+    void start (const Index<String> & uris, ChangeFunc func);
+    void stop ();
+
+private:
+#ifdef __linux__
+    void add_watch (const char * path);
+    void walk (const char * path);
+    void worker ();
+    static void * worker_cb (void * self)
+        { (* (LibraryWatch *) self).worker (); return nullptr; }
+
+    ChangeFunc m_func = nullptr;
+    Index<String> m_roots;     /* local paths of the watched folders */
+    Index<String> m_wd_paths;  /* directory paths indexed by watch descriptor */
+    QueuedFunc m_queued;
+    int m_fd = -1;
+    int m_pipe[2] = {-1, -1};  /* wakes the worker up to quit */
+    pthread_t m_thread;
+    bool m_started = false;
+#endif
+};
+
+#endif // LIBRARYWATCH_H
@@ -18,6 +18,7 @@
  */
 
 #include "search-model.h"
+#include <algorithm>
 
 #include <QMimeData>
 #include <QUrl>
@@ -210,10 +211,14 @@ void SearchModel::create_database (Playlist playlist)
 }
 
 static void search_recurse (SimpleHash<Key, Item> & domain,
- const Index<String> & terms, int mask, Index<const Item *> & results)
+ const Index<String> & terms, int mask, Index<const Item *> & results,
+ const std::atomic<bool> * cancel)
 {
     domain.iterate ([&] (const Key & key, Item & item)
     {
+        if (cancel && cancel->load (std::memory_order_relaxed))
+            return;
+
         int count = terms.len ();
         int new_mask = mask;
 
@@ -233,7 +238,7 @@ static void search_recurse (SimpleHash<Key, Item> & domain,
          item.field != SearchField::HiddenAlbum)
             results.append (& item);
 
-        search_recurse (item.children, terms, new_mask, results);
+        search_recurse (item.children, terms, new_mask, results, cancel);
     });
 }
 
@@ -244,7 +249,11 @@ static int item_compare (const Item * const & a, const Item * const & b)
     if (a->field > b->field)
         return 1;
 
-    int val = str_compare (a->name, b->name);
+    /* keys were built once at database time, so each comparison is a
+     * flat byte compare rather than a full collation */
+    int val = strcmp (a->collate_key.begin (), b->collate_key.begin ());
+    if (! val)
+        val = str_compare (a->name, b->name);
     if (val)
         return val;
 
@@ -264,24 +273,34 @@ static int item_compare_pass1 (const Item * const & a, const Item * const & b)
     return item_compare (a, b);
 }
 
-void SearchModel::do_search (const Index<String> & terms, int max_results)
+bool SearchModel::do_search (const Index<String> & terms, int max_results,
+ const std::atomic<bool> * cancel)
 {
     m_items.clear ();
     m_hidden_items = 0;
 
     /* effectively limits number of search terms to 32 */
-    search_recurse (m_database, terms, (1 << terms.len ()) - 1, m_items);
+    search_recurse (m_database, terms, (1 << terms.len ()) - 1, m_items, cancel);
 
-    /* first sort by number of songs per item */
-    m_items.sort (item_compare_pass1);
+    if (cancel && cancel->load (std::memory_order_relaxed))
+    {
+        m_items.clear ();
+        return false;
+    }
 
-    /* limit to items with most songs */
+    /* limit to items with most songs; partial selection is enough, since
+     * only the kept window gets displayed (and sorted properly below) */
     if (m_items.len () > max_results)
     {
+        std::nth_element (m_items.begin (), m_items.begin () + max_results,
+         m_items.end (), [] (const Item * a, const Item * b)
+            { return item_compare_pass1 (a, b) < 0; });
+
         m_hidden_items = m_items.len () - max_results;
         m_items.remove (max_results, -1);
     }
 
     /* sort by item type, then item name */
     m_items.sort (item_compare);
+    return true;
 }
@@ -22,6 +22,9 @@
 
 #include <QAbstractListModel>
 
+#include <atomic>
+#include <string.h>
+
 #include <libaudcore/audstrings.h>
 #include <libaudcore/i18n.h>
 #include <libaudcore/multihash.h>
@@ -58,10 +61,22 @@ struct Key
         { return (unsigned) field + name.hash (); }
 };
 
+/* strxfrm-transformed collation key; comparing these with plain byte
+ * comparison is equivalent to collating the original strings */
+static inline Index<char> make_collate_key (const char * name)
+{
+    Index<char> key;
+    int len = strxfrm (nullptr, name, 0);
+    key.insert (0, len + 1);
+    strxfrm (key.begin (), name, len + 1);
+    return key;
+}
+
 struct Item
 {
     SearchField field;
     String name, folded;
+    Index<char> collate_key; /* see make_collate_key */
     Item * parent;
     SimpleHash<Key, Item> children;
     Index<int> matches;
@@ -70,6 +85,7 @@ struct Item
         field (field),
         name (name),
         folded (str_tolower_utf8 (name)),
+        collate_key (make_collate_key (name)),
         parent (parent) {}
 
     Item (Item &&) = default;
@@ -86,7 +102,11 @@ public:
     void update ();
     void destroy_database ();
     void create_database (Playlist playlist);
-    void do_search (const Index<String> & terms, int max_results);
+
+    /* returns false if aborted via the cancel flag, which may be set
+     * from another thread; aborting leaves the result list empty */
+    bool do_search (const Index<String> & terms, int max_results,
+     const std::atomic<bool> * cancel = nullptr);
 
 protected:
     int rowCount (const QModelIndex & parent) const override
@@ -17,6 +17,10 @@
  * the use of this software.
  */
 
+#include <pthread.h>
+
+#include <atomic>
+
 #include <QApplication>
 #include <QBoxLayout>
 #include <QContextMenuEvent>
@@ -28,6 +32,7 @@
 #include <QMenu>
 #include <QPointer>
 #include <QPushButton>
+#include <QSet>
 #include <QStandardPaths>
 #include <QTreeView>
 
@@ -46,6 +51,10 @@
 #define CFG_ID "search-tool"
 #define SEARCH_DELAY 300
 
+/* library changes are batched and reported this long after the last
+ * event, so a burst (copying in an album) triggers one rescan */
+#define MONITOR_DELAY 2000
+
 class SearchToolQt : public GeneralPlugin
 {
 public:
@@ -112,6 +121,7 @@ class SearchWidget : public QWidget
 {
 public:
     SearchWidget ();
+    ~SearchWidget ();
 
     void grab_focus () { m_search_entry.setFocus (Qt::OtherFocusReason); }
 
@@ -122,9 +132,14 @@ private:
     void init_library ();
     void show_hide_widgets ();
     void search_timeout ();
+    void search_finished ();
+    void search_worker ();
+    void cancel_search ();
+    void finish_search_now ();
     void library_updated ();
     void location_changed ();
-    void walk_library_paths ();
+    void add_watch_subtree (const QString & root);
+    void monitor_timeout ();
     void setup_monitor ();
 
     void do_add (bool play, bool set_title);
@@ -138,11 +153,27 @@ private:
     HtmlDelegate m_delegate;
 
     SmartPtr<QFileSystemWatcher> m_watcher;
-    QStringList m_watcher_paths;
+    QSet<QString> m_watcher_paths;
+    QStringList m_watcher_pending; /* changed dirs awaiting the debounce */
+    QueuedFunc m_watcher_timer;
 
     QueuedFunc m_search_timer;
     bool m_search_pending = false;
 
+    /* searches run on a worker thread so that typing never blocks the
+     * UI; a new keystroke cancels the in-flight search at its next
+     * check point and replaces the pending request, and completed
+     * results come back to the main loop via m_results_func */
+    pthread_t m_search_thread;
+    pthread_mutex_t m_search_mutex = PTHREAD_MUTEX_INITIALIZER;
+    pthread_cond_t m_search_cond = PTHREAD_COND_INITIALIZER;
+    bool m_thread_started = false, m_search_quit = false;
+    bool m_search_busy = false, m_have_request = false;
+    Index<String> m_request_terms;
+    int m_request_max = 0;
+    std::atomic<bool> m_search_cancel {false};
+    QueuedFunc m_results_func;
+
     QLabel m_help_label, m_wait_label, m_stats_label;
     SearchEntry m_search_entry;
     ResultsList m_results_list;
@@ -172,21 +203,31 @@ const PreferencesWidget SearchToolQt::widgets[] = {
 
 const PluginPreferences SearchToolQt::prefs = {{widgets}};
 
-static String get_uri ()
+static Index<String> get_uris ()
 {
     auto to_uri = [] (const char * path)
-        { return String (filename_to_uri (path)); };
+        { return strstr (path, "://") ? String (path) :
+                 String (filename_to_uri (path)); };
+
+    Index<String> uris;
+
+    /* the folder setting can list several library roots separated by
+     * ';' (hand-edited; the chooser in the UI sets a single folder) */
+    String paths = aud_get_str (CFG_ID, "path");
+    for (const String & path : str_list_to_index (paths, ";"))
+        uris.append (to_uri (path));
 
-    String path1 = aud_get_str (CFG_ID, "path");
-    if (path1[0])
-        return strstr (path1, "://") ? path1 : to_uri (path1);
+    if (uris.len ())
+        return uris;
 
     QStringList locations = QStandardPaths::standardLocations (QStandardPaths::MusicLocation);
     QString path2 = locations.value (0, QString ());
     if (! path2.isEmpty () && QFile::exists (path2))
-        return to_uri (path2.toUtf8 ().constData ());
+        uris.append (to_uri (path2.toUtf8 ().constData ()));
+    else
+        uris.append (to_uri (QDir::homePath ().toUtf8 ().constData ()));
 
-    return to_uri (QDir::homePath ().toUtf8 ().constData ());
+    return uris;
 }
 
 SearchWidget::SearchWidget () :
@@ -247,7 +288,7 @@ SearchWidget::SearchWidget () :
     vbox->addWidget (& m_stats_label);
     vbox->addLayout (hbox2);
 
-    audqt::file_entry_set_uri (m_file_entry, get_uri ());
+    audqt::file_entry_set_uri (m_file_entry, get_uris ()[0]);
 
     init_library ();
     reset_monitor ();
@@ -266,13 +307,30 @@ SearchWidget::SearchWidget () :
     QObject::connect (& m_refresh_btn, & QPushButton::clicked, this, & SearchWidget::location_changed);
 }
 
+SearchWidget::~SearchWidget ()
+{
+    if (m_thread_started)
+    {
+        pthread_mutex_lock (& m_search_mutex);
+        m_search_quit = true;
+        m_search_cancel.store (true, std::memory_order_relaxed);
+        pthread_cond_broadcast (& m_search_cond);
+        pthread_mutex_unlock (& m_search_mutex);
+
+        pthread_join (m_search_thread, nullptr);
+        m_thread_started = false;
+    }
+
+    m_results_func.stop ();
+}
+
 void SearchWidget::init_library ()
 {
     m_library.connect_update
      (aud::obj_member<SearchWidget, & SearchWidget::library_updated>, this);
 
     if (aud_get_bool (CFG_ID, "rescan_on_startup"))
-        m_library.begin_add (get_uri ());
+        m_library.begin_add (get_uris ());
 
     m_library.check_ready_and_update (true);
 }
@@ -305,11 +363,8 @@ void SearchWidget::show_hide_widgets ()
     }
 }
 
-void SearchWidget::search_timeout ()
+void SearchWidget::search_finished ()
 {
-    auto text = m_search_entry.text ().toUtf8 ();
-    auto terms = str_list_to_index (str_tolower_utf8 (text), " ");
-    m_model.do_search (terms, aud_get_int (CFG_ID, "max_results"));
     m_model.update ();
 
     int shown = m_model.num_items ();
@@ -330,10 +385,105 @@ void SearchWidget::search_timeout ()
         m_stats_label.setText ((const char *)
          str_printf (dngettext (PACKAGE, "%d result", "%d results", total), total));
 
-    m_search_timer.stop ();
     m_search_pending = false;
 }
 
+void SearchWidget::search_worker ()
+{
+    pthread_mutex_lock (& m_search_mutex);
+
+    while (! m_search_quit)
+    {
+        if (! m_have_request)
+        {
+            pthread_cond_wait (& m_search_cond, & m_search_mutex);
+            continue;
+        }
+
+        Index<String> terms = std::move (m_request_terms);
+        int max_results = m_request_max;
+        m_have_request = false;
+        m_search_busy = true;
+        m_search_cancel.store (false, std::memory_order_relaxed);
+
+        pthread_mutex_unlock (& m_search_mutex);
+        bool completed = m_model.do_search (terms, max_results, & m_search_cancel);
+        pthread_mutex_lock (& m_search_mutex);
+
+        m_search_busy = false;
+        pthread_cond_broadcast (& m_search_cond);
+
+        /* cancelled or superseded searches deliver nothing */
+        if (completed && ! m_have_request && ! m_search_quit)
+            m_results_func.queue ([this] () { search_finished (); });
+    }
+
+    pthread_mutex_unlock (& m_search_mutex);
+}
+
+/* aborts any in-flight search; the model is safe to modify afterward */
+void SearchWidget::cancel_search ()
+{
+    if (! m_thread_started)
+        return;
+
+    pthread_mutex_lock (& m_search_mutex);
+    m_have_request = false;
+    m_search_cancel.store (true, std::memory_order_relaxed);
+
+    while (m_search_busy)
+        pthread_cond_wait (& m_search_cond, & m_search_mutex);
+
+    pthread_mutex_unlock (& m_search_mutex);
+}
+
+void SearchWidget::search_timeout ()
+{
+    auto text = m_search_entry.text ().toUtf8 ();
+    auto terms = str_list_to_index (str_tolower_utf8 (text), " ");
+    int max_results = aud_get_int (CFG_ID, "max_results");
+
+    if (! m_thread_started)
+    {
+        auto worker = [] (void * me) -> void *
+            { ((SearchWidget *) me)->search_worker (); return nullptr; };
+
+        if (pthread_create (& m_search_thread, nullptr, worker, this) != 0)
+        {
+            /* fall back to searching synchronously */
+            m_model.do_search (terms, max_results);
+            search_finished ();
+            m_search_timer.stop ();
+            return;
+        }
+
+        m_thread_started = true;
+    }
+
+    pthread_mutex_lock (& m_search_mutex);
+    m_request_terms = std::move (terms);
+    m_request_max = max_results;
+    m_have_request = true;
+    m_search_cancel.store (true, std::memory_order_relaxed);
+    pthread_cond_broadcast (& m_search_cond);
+    pthread_mutex_unlock (& m_search_mutex);
+
+    m_search_timer.stop ();
+}
+
+/* runs the pending search synchronously, for when the results are
+ * needed immediately (e.g. acting on the current selection) */
+void SearchWidget::finish_search_now ()
+{
+    m_search_timer.stop ();
+    cancel_search ();
+
+    auto text = m_search_entry.text ().toUtf8 ();
+    auto terms = str_list_to_index (str_tolower_utf8 (text), " ");
+    m_model.do_search (terms, aud_get_int (CFG_ID, "max_results"));
+    search_finished ();
+}
+
 void SearchWidget::trigger_search ()
 {
     m_search_timer.queue (SEARCH_DELAY, [this] () { search_timeout (); });
@@ -342,6 +492,8 @@ void SearchWidget::trigger_search ()
 
 void SearchWidget::library_updated ()
 {
+    cancel_search ();
+
     if (m_library.is_ready ())
     {
         m_model.create_database (m_library.playlist ());
@@ -369,7 +521,9 @@ void SearchWidget::location_changed ()
     StringBuf path = uri_to_filename (uri);
     aud_set_str (CFG_ID, "path", path ? path : uri);
 
-    m_library.begin_add (uri);
+    Index<String> uris;
+    uris.append (uri);
+    m_library.begin_add (uris);
     m_library.check_ready_and_update (true);
     reset_monitor ();
 }
@@ -378,24 +532,52 @@ void SearchWidget::location_changed ()
 // TODO: Since MacOS has an abysmally low default per-process FD limit, this
 // means it probably won't work on MacOS with a huge media library.
 // In the case of MacOS, we should use the FSEvents API instead.
-void SearchWidget::walk_library_paths ()
+void SearchWidget::add_watch_subtree (const QString & root)
 {
-    if (! m_watcher_paths.isEmpty ())
-        m_watcher->removePaths (m_watcher_paths);
-
-    m_watcher_paths.clear ();
-
-    auto root = (QString) uri_to_filename (get_uri ());
     if (root.isEmpty ())
         return;
 
-    m_watcher_paths.append (root);
+    QStringList added;
+
+    if (! m_watcher_paths.contains (root))
+    {
+        m_watcher_paths.insert (root);
+        added.append (root);
+    }
 
     QDirIterator it (root, QDir::Dirs | QDir::NoDot | QDir::NoDotDot, QDirIterator::Subdirectories);
     while (it.hasNext ())
-        m_watcher_paths.append (it.next ());
+    {
+        QString dir = it.next ();
+        if (! m_watcher_paths.contains (dir))
+        {
+            m_watcher_paths.insert (dir);
+            added.append (dir);
+        }
+    }
 
-    m_watcher->addPaths (m_watcher_paths);
+    if (! added.isEmpty ())
+        m_watcher->addPaths (added);
+}
+
+void SearchWidget::monitor_timeout ()
+{
+    AUDINFO ("Library directories changed, refreshing library.\n");
+
+    m_library.begin_add (get_uris ());
+    m_library.check_ready_and_update (true);
+
+    /* folders deleted since the last pass were dropped by the watcher;
+     * resync our set so they can be watched again if they reappear */
+    const QStringList watched = m_watcher->directories ();
+    m_watcher_paths = QSet<QString> (watched.begin (), watched.end ());
+
+    /* re-enumerate only the subtrees that reported events, picking up
+     * watches for folders created inside them */
+    for (const QString & dir : m_watcher_pending)
+        add_watch_subtree (dir);
+
+    m_watcher_pending.clear ();
 }
 
 void SearchWidget::setup_monitor ()
@@ -403,19 +585,19 @@ void SearchWidget::setup_monitor ()
     AUDINFO ("Starting monitoring.\n");
     m_watcher.capture (new QFileSystemWatcher);
     m_watcher_paths.clear ();
+    m_watcher_pending.clear ();
+    m_watcher_timer.stop ();
 
     QObject::connect (m_watcher.get (), & QFileSystemWatcher::directoryChanged,
-     [this] (const QString &)
+     [this] (const QString & path)
     {
-        AUDINFO ("Library directory changed, refreshing library.\n");
-
-        m_library.begin_add (get_uri ());
-        m_library.check_ready_and_update (true);
-
-        walk_library_paths ();
+        /* batch events and wait for the folder to go quiet */
+        m_watcher_pending.append (path);
+        m_watcher_timer.queue (MONITOR_DELAY, [this] () { monitor_timeout (); });
     });
 
-    walk_library_paths ();
+    for (const String & uri : get_uris ())
+        add_watch_subtree ((QString) uri_to_filename (uri));
 }
 
 void SearchWidget::reset_monitor ()
@@ -429,13 +611,15 @@ void SearchWidget::reset_monitor ()
         AUDINFO ("Stopping monitoring.\n");
         m_watcher.clear ();
         m_watcher_paths.clear ();
+        m_watcher_pending.clear ();
+        m_watcher_timer.stop ();
     }
 }
 
 void SearchWidget::do_add (bool play, bool set_title)
 {
     if (m_search_pending)
-        search_timeout ();
+        finish_search_now ();
 
     int n_items = m_model.num_items ();
     int n_selected = 0;
@@ -87,7 +87,7 @@ bool Library::filter_cb (const char * filename, void *)
     return add;
 }
 
-void Library::begin_add (const char * uri)
+void Library::begin_add (const Index<String> & uris)
 {
     if (s_adding_library)
         return;
@@ -97,6 +97,13 @@ void Library::begin_add (const char * uri)
 
     m_added_table.clear ();
 
+    /* compare directory mtimes against the snapshot saved last session
+     * so that only the changed parts of the folders are rescanned */
+    m_store.scan (uris);
+
+    if (m_store && m_store.unchanged () && m_playlist.n_entries ())
+        return;
+
     int entries = m_playlist.n_entries ();
 
     for (int entry = 0; entry < entries; entry ++)
@@ -106,7 +113,8 @@ void Library::begin_add (const char * uri)
         if (! m_added_table.lookup (filename))
         {
             m_playlist.select_entry (entry, false);
-            m_added_table.add (filename, false);
+            /* files in unchanged directories are known to still exist */
+            m_added_table.add (filename, m_store && m_store.file_unchanged (filename));
         }
         else
             m_playlist.select_entry (entry, true);
@@ -114,10 +122,38 @@ void Library::begin_add (const char * uri)
 
     m_playlist.remove_selected ();
 
+    if (m_store && ! m_store.changed ().len ())
+    {
+        /* only deletions; drop the affected entries and skip the scan */
+        entries = m_playlist.n_entries ();
+
+        for (int entry = 0; entry < entries; entry ++)
+        {
+            bool * added = m_added_table.lookup (m_playlist.entry_filename (entry));
+            m_playlist.select_entry (entry, ! added || ! (* added));
+        }
+
+        m_playlist.remove_selected ();
+        m_added_table.clear ();
+        m_store.save ();
+        return;
+    }
+
     set_adding (true);
 
     Index<PlaylistAddItem> add;
-    add.append (String (uri));
+
+    if (m_store)
+    {
+        for (const String & item : m_store.changed ())
+            add.append (item);
+    }
+    else
+    {
+        for (const String & uri : uris)
+            add.append (uri);
+    }
+
     m_playlist.insert_filtered (-1, std::move (add), filter_cb, nullptr, false);
 }
 
@@ -159,6 +195,9 @@ void Library::add_complete ()
             m_playlist.select_all (false);
 
         m_playlist.sort_entries (Playlist::Path);
+
+        if (m_store)
+            m_store.save ();
     }
 
     if (! m_playlist.update_pending ())
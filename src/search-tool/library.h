@@ -24,6 +24,8 @@
 #include <libaudcore/multihash.h>
 #include <libaudcore/playlist.h>
 
+#include "../search-common/library-store.h"
+
 class Library
 {
 public:
@@ -33,7 +35,7 @@ public:
     Playlist playlist () const { return m_playlist; }
     bool is_ready () const { return m_is_ready; }
 
-    void begin_add (const char * uri);
+    void begin_add (const Index<String> & uris);
     void check_ready_and_update (bool force);
 
 private:
@@ -53,6 +55,7 @@ private:
     Playlist m_playlist;
     bool m_is_ready = false;
     SimpleHash<String, bool> m_added_table;
+    LibraryStore m_store;
 
     /* to allow safe callback access from playlist add thread */
     static aud::spinlock s_adding_lock;
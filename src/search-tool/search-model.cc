@@ -18,29 +18,77 @@
  */
 
 #include "search-model.h"
+#include <algorithm>
+#include <pthread.h>
 #include <string.h>
+#include <unistd.h>
 
 void SearchModel::destroy_database ()
 {
     m_playlist = Playlist ();
     m_items.clear ();
     m_hidden_items = 0;
-    m_database.clear ();
+
+    for (Shard & shard : m_shards)
+    {
+        shard.database.clear ();
+        shard.terms.clear ();
+    }
+
+    m_db_entries = 0;
+}
+
+/* Adds an item to the posting list of each word of its folded name.
+ * Search terms are split on spaces (see search_timeout), so a term can
+ * only ever match within a single word; indexing by word is therefore
+ * exactly equivalent to the old substring scan of the whole name. */
+void SearchModel::index_item_terms (Shard & shard, Item * item)
+{
+    for (const String & word : str_list_to_index (item->folded, " "))
+    {
+        auto list = shard.terms.lookup (word);
+        if (! list)
+            list = shard.terms.add (word, Index<Item *> ());
+
+        /* a word repeated within one name was just added by us */
+        if (! list->len () || (* list)[list->len () - 1] != item)
+            list->append (item);
+    }
 }
 
-void SearchModel::add_to_database (int entry, std::initializer_list<Key> keys)
+/* The shard is chosen by the root key of the chain, so every insertion
+ * under one root-level item lands in the same shard.  When called from a
+ * build worker, chains belonging to other workers' shards are skipped;
+ * each worker makes its own pass over the entries, touching only the
+ * shards it owns. */
+void SearchModel::add_to_database (int entry, int worker, int n_workers,
+ std::initializer_list<Key> keys)
 {
+    Shard * shard = nullptr;
     Item * parent = nullptr;
-    auto hash = & m_database;
+    SimpleHash<Key, Item> * hash = nullptr;
 
     for (auto & key : keys)
     {
         if (! key.name)
             continue;
 
+        if (! shard)
+        {
+            int s = key.hash () % N_SHARDS;
+            if (s % n_workers != worker)
+                return;
+
+            shard = & m_shards[s];
+            hash = & shard->database;
+        }
+
         Item * item = hash->lookup (key);
         if (! item)
+        {
             item = hash->add (key, Item (key.field, key.name, parent));
+            index_item_terms (* shard, item);
+        }
 
         item->matches.append (entry);
 
@@ -49,77 +97,155 @@ void SearchModel::add_to_database (int entry, std::initializer_list<Key> keys)
     }
 }
 
-void SearchModel::create_database (Playlist playlist)
+void SearchModel::add_entry (const EntryData & data, int worker, int n_workers)
 {
-    destroy_database ();
+    int entry = data.entry;
 
-    int entries = playlist.n_entries ();
+    if (data.album_artist && data.album_artist != data.artist)
+    {
+        /* album and song have different artists;
+         * add separately under respective artists */
+        add_to_database (entry, worker, n_workers,
+         {{SearchField::Artist, data.album_artist},
+          {SearchField::Album, data.album}});
+        /* add Title node under a HiddenAlbum node so that it can
+         * still be searched by album name (without listing the
+         * album twice) */
+        add_to_database (entry, worker, n_workers,
+         {{SearchField::Artist, data.artist},
+          {SearchField::HiddenAlbum, data.album},
+          {SearchField::Title, data.title}});
+    }
+    else
+    {
+        /* album and song have the same artist;
+         * add hierarchically under that artist */
+        add_to_database (entry, worker, n_workers,
+         {{SearchField::Artist, data.artist},
+          {SearchField::Album, data.album},
+          {SearchField::Title, data.title}});
+    }
 
-    for (int e = 0; e < entries; e ++)
+    /* add separately under genre */
+    add_to_database (entry, worker, n_workers,
+     {{SearchField::Genre, data.genre}});
+}
+
+SearchModel::EntryData SearchModel::collect_entry (Playlist playlist, int entry)
+{
+    Tuple tuple = playlist.entry_tuple (entry, Playlist::NoWait);
+
+    return {entry,
+            tuple.get_str (Tuple::Artist),
+            tuple.get_str (Tuple::AlbumArtist),
+            tuple.get_str (Tuple::Album),
+            tuple.get_str (Tuple::Title),
+            tuple.get_str (Tuple::Genre)};
+}
+
+void * SearchModel::build_worker (void * ctx_)
+{
+    auto & ctx = * (BuildContext *) ctx_;
+
+    for (const EntryData & data : * ctx.data)
+        ctx.model->add_entry (data, ctx.worker, ctx.n_workers);
+
+    return nullptr;
+}
+
+void SearchModel::build_database (const Index<EntryData> & data)
+{
+    int n_workers = aud::clamp ((int) sysconf (_SC_NPROCESSORS_ONLN), 1, N_SHARDS);
+
+    /* sharding only pays off when there is real work to split */
+    if (data.len () < 10000)
+        n_workers = 1;
+
+    if (n_workers > 1)
     {
-        Tuple tuple = playlist.entry_tuple (e, Playlist::NoWait);
-        String album_artist = tuple.get_str (Tuple::AlbumArtist);
-        String artist = tuple.get_str (Tuple::Artist);
+        BuildContext contexts[N_SHARDS];
+        pthread_t threads[N_SHARDS];
+        int started = 0;
 
-        if (album_artist && album_artist != artist)
+        for (int w = 0; w < n_workers; w ++)
         {
-            /* album and song have different artists;
-             * add separately under respective artists */
-            add_to_database (e,
-             {{SearchField::Artist, album_artist},
-              {SearchField::Album, tuple.get_str (Tuple::Album)}});
-            /* add Title node under a HiddenAlbum node so that it can
-             * still be searched by album name (without listing the
-             * album twice) */
-            add_to_database (e,
-             {{SearchField::Artist, artist},
-              {SearchField::HiddenAlbum, tuple.get_str (Tuple::Album)},
-              {SearchField::Title, tuple.get_str (Tuple::Title)}});
+            contexts[w] = {this, & data, w, n_workers};
+            if (pthread_create (& threads[w], nullptr, build_worker, & contexts[w]))
+                break;
+
+            started ++;
         }
-        else
+
+        for (int w = 0; w < started; w ++)
+            pthread_join (threads[w], nullptr);
+
+        if (started == n_workers)
+            return;
+
+        /* thread creation failed part-way; rebuild serially */
+        for (Shard & shard : m_shards)
         {
-            /* album and song have the same artist;
-             * add hierarchically under that artist */
-            add_to_database (e,
-             {{SearchField::Artist, artist},
-              {SearchField::Album, tuple.get_str (Tuple::Album)},
-              {SearchField::Title, tuple.get_str (Tuple::Title)}});
+            shard.database.clear ();
+            shard.terms.clear ();
         }
-
-        /* add separately under genre */
-        add_to_database (e,
-         {{SearchField::Genre, tuple.get_str (Tuple::Genre)}});
     }
 
+    for (const EntryData & entry : data)
+        add_entry (entry, 0, 1);
+}
+
+void SearchModel::create_database (Playlist playlist)
+{
+    destroy_database ();
+
+    int entries = playlist.n_entries ();
+
+    /* tuple access is main-thread-only; gather the strings up front and
+     * leave the folding, collation and hashing to the workers */
+    Index<EntryData> data;
+    for (int e = 0; e < entries; e ++)
+        data.append (collect_entry (playlist, e));
+
+    build_database (data);
+
     m_playlist = playlist;
+    m_db_entries = entries;
 }
 
-static void search_recurse (SimpleHash<Key, Item> & domain,
- const Index<String> & terms, int mask, Index<const Item *> & results)
+void SearchModel::update_database (Playlist playlist)
 {
-    domain.iterate ([&] (const Key & key, Item & item)
+    auto update = playlist.update_detail ();
+    int entries = playlist.n_entries ();
+
+    /* the common library update only appends newly scanned entries;
+     * index just those.  any other change renumbers or retags entries
+     * already in the database, so rebuild from scratch. */
+    if (playlist == m_playlist && update.before >= m_db_entries && ! update.after)
     {
-        int count = terms.len ();
-        int new_mask = mask;
+        for (int e = m_db_entries; e < entries; e ++)
+            add_entry (collect_entry (playlist, e), 0, 1);
 
-        for (int t = 0, bit = 1; t < count; t ++, bit <<= 1)
-        {
-            if (! (new_mask & bit))
-                continue; /* skip term if it is already found */
+        m_db_entries = entries;
+    }
+    else
+        create_database (playlist);
+}
 
-            if (strstr (item.folded, terms[t]))
-                new_mask &= ~bit; /* we found it */
-            else if (! item.children.n_items ())
-                break; /* quit early if there are no children to search */
-        }
+void SearchModel::search_item (Item & item, int mask)
+{
+    if (m_cancel && m_cancel->load (std::memory_order_relaxed))
+        return;
 
-        /* adding an item with exactly one child is redundant, so avoid it */
-        if (! new_mask && item.children.n_items () != 1 &&
-         item.field != SearchField::HiddenAlbum)
-            results.append (& item);
+    if (item.match_gen == m_search_gen)
+        mask &= ~item.match_mask;
 
-        search_recurse (item.children, terms, new_mask, results);
-    });
+    /* adding an item with exactly one child is redundant, so avoid it */
+    if (! mask && item.children.n_items () != 1 &&
+     item.field != SearchField::HiddenAlbum)
+        m_items.append (& item);
+
+    item.children.iterate ([this, mask] (const Key & key, Item & child)
+        { search_item (child, mask); });
 }
 
 static int item_compare (const Item * const & a, const Item * const & b)
@@ -129,7 +255,11 @@ static int item_compare (const Item * const & a, const Item * const & b)
     if (a->field > b->field)
         return 1;
 
-    int val = str_compare (a->name, b->name);
+    /* keys were built once at database time, so each comparison is a
+     * flat byte compare rather than a full collation */
+    int val = strcmp (a->collate_key.begin (), b->collate_key.begin ());
+    if (! val)
+        val = str_compare (a->name, b->name);
     if (val)
         return val;
 
@@ -149,24 +279,121 @@ static int item_compare_pass1 (const Item * const & a, const Item * const & b)
     return item_compare (a, b);
 }
 
-void SearchModel::do_search (const Index<String> & terms, int max_results)
+bool SearchModel::do_search (const Index<String> & terms, int max_results,
+ const std::atomic<bool> * cancel)
 {
+    m_cancel = cancel;
     m_items.clear ();
     m_hidden_items = 0;
 
-    /* effectively limits number of search terms to 32 */
-    search_recurse (m_database, terms, (1 << terms.len ()) - 1, m_items);
+    if (! terms.len ())
+    {
+        /* an empty search lists the entire library */
+        for (Shard & shard : m_shards)
+        {
+            shard.database.iterate ([this] (const Key & key, Item & item)
+                { search_item (item, 0); });
+        }
+    }
+    else
+    {
+        m_search_gen ++;
+
+        /* effectively limits number of search terms to 32 */
+        int full_mask = (1 << terms.len ()) - 1;
 
-    /* first sort by number of songs per item */
-    m_items.sort (item_compare_pass1);
+        /* mark each item whose name contains a term, via the posting
+         * lists of the indexed words */
+        Index<Index<Item *>> matched;
 
-    /* limit to items with most songs */
+        for (int t = 0; t < terms.len (); t ++)
+        {
+            Index<Item *> & hits = matched.append ();
+            int bit = 1 << t;
+
+            for (Shard & shard : m_shards)
+            {
+                shard.terms.iterate ([&] (const String & word, Index<Item *> & postings)
+                {
+                    if (cancel && cancel->load (std::memory_order_relaxed))
+                        return;
+
+                    if (! strstr (word, terms[t]))
+                        return;
+
+                    for (Item * item : postings)
+                    {
+                        if (item->match_gen != m_search_gen)
+                        {
+                            item->match_gen = m_search_gen;
+                            item->match_mask = 0;
+                        }
+
+                        if (! (item->match_mask & bit))
+                        {
+                            item->match_mask |= bit;
+                            hits.append (item);
+                        }
+                    }
+                });
+            }
+        }
+
+        /* every result's path must contain a match of each term, so it
+         * is enough to walk the subtrees rooted at the matches of the
+         * rarest term and let the mask check the others */
+        int rarest = 0;
+        for (int t = 1; t < terms.len (); t ++)
+        {
+            if (matched[t].len () < matched[rarest].len ())
+                rarest = t;
+        }
+
+        int bit = 1 << rarest;
+
+        for (Item * item : matched[rarest])
+        {
+            int mask = full_mask;
+            bool covered = false;
+
+            for (Item * p = item->parent; p; p = p->parent)
+            {
+                if (p->match_gen != m_search_gen)
+                    continue;
+
+                /* an ancestor matching the same term covers this subtree */
+                if (p->match_mask & bit)
+                    covered = true;
+
+                mask &= ~p->match_mask;
+            }
+
+            if (! covered)
+                search_item (* item, mask);
+        }
+    }
+
+    m_cancel = nullptr;
+
+    if (cancel && cancel->load (std::memory_order_relaxed))
+    {
+        m_items.clear ();
+        return false;
+    }
+
+    /* limit to items with most songs; partial selection is enough, since
+     * only the kept window gets displayed (and sorted properly below) */
     if (m_items.len () > max_results)
     {
+        std::nth_element (m_items.begin (), m_items.begin () + max_results,
+         m_items.end (), [] (const Item * a, const Item * b)
+            { return item_compare_pass1 (a, b) < 0; });
+
         m_hidden_items = m_items.len () - max_results;
         m_items.remove (max_results, -1);
     }
 
     /* sort by item type, then item name */
     m_items.sort (item_compare);
+    return true;
 }
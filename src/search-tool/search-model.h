@@ -20,6 +20,9 @@
 #ifndef SEARCHMODEL_H
 #define SEARCHMODEL_H
 
+#include <atomic>
+#include <string.h>
+
 #include <libaudcore/audstrings.h>
 #include <libaudcore/i18n.h>
 #include <libaudcore/multihash.h>
@@ -56,18 +59,36 @@ struct Key
         { return (unsigned) field + name.hash (); }
 };
 
+/* strxfrm-transformed collation key; comparing these with plain byte
+ * comparison is equivalent to collating the original strings */
+static inline Index<char> make_collate_key (const char * name)
+{
+    Index<char> key;
+    int len = strxfrm (nullptr, name, 0);
+    key.insert (0, len + 1);
+    strxfrm (key.begin (), name, len + 1);
+    return key;
+}
+
 struct Item
 {
     SearchField field;
     String name, folded;
+    Index<char> collate_key; /* see make_collate_key */
     Item * parent;
     SimpleHash<Key, Item> children;
     Index<int> matches;
 
+    /* which search terms matched this item's name, valid while match_gen
+     * equals the model's current search generation */
+    int match_mask = 0;
+    int match_gen = 0;
+
     Item (SearchField field, const String & name, Item * parent) :
         field (field),
         name (name),
         folded (str_tolower_utf8 (name)),
+        collate_key (make_collate_key (name)),
         parent (parent) {}
 
     Item (Item &&) = default;
@@ -83,13 +104,61 @@ public:
 
     void destroy_database ();
     void create_database (Playlist playlist);
-    void do_search (const Index<String> & terms, int max_results);
+    void update_database (Playlist playlist);
+
+    /* returns false if aborted via the cancel flag, which may be set
+     * from another thread; aborting leaves the result list empty */
+    bool do_search (const Index<String> & terms, int max_results,
+     const std::atomic<bool> * cancel = nullptr);
 
 private:
-    void add_to_database (int entry, std::initializer_list<Key> keys);
+    /* the root level of the database is split into shards by root key
+     * hash, so that build workers own disjoint subtrees and need no
+     * locking; searches simply walk every shard */
+    static constexpr int N_SHARDS = 16;
+
+    struct Shard
+    {
+        SimpleHash<Key, Item> database;
+
+        /* inverted index: each word of each item's folded name maps to
+         * the items containing it, so searches touch only the matching
+         * subtrees; kept per shard, alongside the items it points to */
+        SimpleHash<String, Index<Item *>> terms;
+    };
+
+    /* per-entry strings gathered up front on the main thread, since
+     * tuple access is not safe from the build workers */
+    struct EntryData
+    {
+        int entry;
+        String artist, album_artist, album, title, genre;
+    };
+
+    /* context handed to each build worker */
+    struct BuildContext
+    {
+        SearchModel * model;
+        const Index<EntryData> * data;
+        int worker, n_workers;
+    };
+
+    static EntryData collect_entry (Playlist playlist, int entry);
+    static void * build_worker (void * ctx);
+
+    void build_database (const Index<EntryData> & data);
+    void add_entry (const EntryData & data, int worker, int n_workers);
+    void add_to_database (int entry, int worker, int n_workers,
+     std::initializer_list<Key> keys);
+    void index_item_terms (Shard & shard, Item * item);
+    void search_item (Item & item, int mask);
 
     Playlist m_playlist;
-    SimpleHash<Key, Item> m_database;
+    Shard m_shards[N_SHARDS];
+    int m_db_entries = 0;
+    int m_search_gen = 0;
+    const std::atomic<bool> * m_cancel = nullptr;
+
     Index<const Item *> m_items;
     int m_hidden_items = 0;
 };
@@ -17,7 +17,11 @@
  * the use of this software.
  */
 
+#include <pthread.h>
 #include <string.h>
+
+#include <atomic>
+
 #include <gtk/gtk.h>
 #include <gdk/gdk.h>
 
@@ -32,6 +36,7 @@
 #include <libaudgui/list.h>
 #include <libaudgui/menu.h>
 
+#include "../search-common/library-watch.h"
 #include "library.h"
 #include "search-model.h"
 
@@ -63,10 +68,12 @@ public:
 EXPORT SearchTool aud_plugin_instance;
 
 static void trigger_search ();
+static void reset_monitor ();
 
 const char * const SearchTool::defaults[] = {
     "max_results", "20",
     "rescan_on_startup", "FALSE",
+    "monitor", "FALSE",
     nullptr
 };
 
@@ -75,7 +82,9 @@ const PreferencesWidget SearchTool::widgets[] = {
         WidgetInt (CFG_ID, "max_results", trigger_search),
          {10, 10000, 10}),
     WidgetCheck (N_("Rescan library at startup"),
-        WidgetBool (CFG_ID, "rescan_on_startup"))
+        WidgetBool (CFG_ID, "rescan_on_startup")),
+    WidgetCheck (N_("Monitor library for changes"),
+        WidgetBool (CFG_ID, "monitor", reset_monitor))
 };
 
 const PluginPreferences SearchTool::prefs = {{widgets}};
@@ -87,22 +96,47 @@ static Index<bool> s_selection;
 static QueuedFunc s_search_timer;
 static bool s_search_pending;
 
+/* searches run on a worker thread so that typing never blocks the UI;
+ * a new keystroke cancels the in-flight search at its next check point
+ * and replaces the pending request, and completed results come back to
+ * the main loop via s_results_func */
+static pthread_t s_search_thread;
+static pthread_mutex_t s_search_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_search_cond = PTHREAD_COND_INITIALIZER;
+static bool s_thread_started, s_search_quit, s_search_busy, s_have_request;
+static Index<String> s_request_terms;
+static int s_request_max;
+static std::atomic<bool> s_search_cancel {false};
+static QueuedFunc s_results_func;
+
+static LibraryWatch s_watch;
+
 static GtkWidget * entry, * help_label, * wait_label, * scrolled, * results_list, * stats_label;
 
-static String get_uri ()
+static Index<String> get_uris ()
 {
     auto to_uri = [] (const char * path)
-        { return String (filename_to_uri (path)); };
+        { return strstr (path, "://") ? String (path) :
+                 String (filename_to_uri (path)); };
+
+    Index<String> uris;
+
+    /* the folder setting can list several library roots separated by
+     * ';' (hand-edited; the chooser in the UI sets a single folder) */
+    String paths = aud_get_str (CFG_ID, "path");
+    for (const String & path : str_list_to_index (paths, ";"))
+        uris.append (to_uri (path));
 
-    String path1 = aud_get_str (CFG_ID, "path");
-    if (path1[0])
-        return strstr (path1, "://") ? path1 : to_uri (path1);
+    if (uris.len ())
+        return uris;
 
     const char * path2 = g_get_user_special_dir (G_USER_DIRECTORY_MUSIC);
     if (g_file_test (path2, G_FILE_TEST_EXISTS))
-        return to_uri (path2);
+        uris.append (to_uri (path2));
+    else
+        uris.append (to_uri (g_get_home_dir ()));
 
-    return to_uri (g_get_home_dir ());
+    return uris;
 }
 
 static void show_hide_widgets ()
@@ -133,12 +167,8 @@ static void show_hide_widgets ()
     }
 }
 
-static void search_timeout ()
+static void search_finished ()
 {
-    const char * text = gtk_entry_get_text ((GtkEntry *) entry);
-    auto terms = str_list_to_index (str_tolower_utf8 (text), " ");
-    s_model.do_search (terms, aud_get_int (CFG_ID, "max_results"));
-
     int shown = s_model.num_items ();
     int hidden = s_model.num_hidden_items ();
     int total = shown + hidden;
@@ -159,10 +189,103 @@ static void search_timeout ()
         gtk_label_set_text ((GtkLabel *) stats_label,
          str_printf (dngettext (PACKAGE, "%d result", "%d results", total), total));
 
-    s_search_timer.stop ();
     s_search_pending = false;
 }
 
+static void * search_worker (void *)
+{
+    pthread_mutex_lock (& s_search_mutex);
+
+    while (! s_search_quit)
+    {
+        if (! s_have_request)
+        {
+            pthread_cond_wait (& s_search_cond, & s_search_mutex);
+            continue;
+        }
+
+        Index<String> terms = std::move (s_request_terms);
+        int max_results = s_request_max;
+        s_have_request = false;
+        s_search_busy = true;
+        s_search_cancel.store (false, std::memory_order_relaxed);
+
+        pthread_mutex_unlock (& s_search_mutex);
+        bool completed = s_model.do_search (terms, max_results, & s_search_cancel);
+        pthread_mutex_lock (& s_search_mutex);
+
+        s_search_busy = false;
+        pthread_cond_broadcast (& s_search_cond);
+
+        /* cancelled or superseded searches deliver nothing */
+        if (completed && ! s_have_request && ! s_search_quit)
+            s_results_func.queue (search_finished);
+    }
+
+    pthread_mutex_unlock (& s_search_mutex);
+    return nullptr;
+}
+
+/* aborts any in-flight search; the model is safe to modify afterward */
+static void cancel_search ()
+{
+    if (! s_thread_started)
+        return;
+
+    pthread_mutex_lock (& s_search_mutex);
+    s_have_request = false;
+    s_search_cancel.store (true, std::memory_order_relaxed);
+
+    while (s_search_busy)
+        pthread_cond_wait (& s_search_cond, & s_search_mutex);
+
+    pthread_mutex_unlock (& s_search_mutex);
+}
+
+static void search_timeout ()
+{
+    const char * text = gtk_entry_get_text ((GtkEntry *) entry);
+    auto terms = str_list_to_index (str_tolower_utf8 (text), " ");
+    int max_results = aud_get_int (CFG_ID, "max_results");
+
+    if (! s_thread_started)
+    {
+        if (pthread_create (& s_search_thread, nullptr, search_worker, nullptr) != 0)
+        {
+            /* fall back to searching synchronously */
+            s_model.do_search (terms, max_results);
+            search_finished ();
+            s_search_timer.stop ();
+            return;
+        }
+
+        s_thread_started = true;
+    }
+
+    pthread_mutex_lock (& s_search_mutex);
+    s_request_terms = std::move (terms);
+    s_request_max = max_results;
+    s_have_request = true;
+    s_search_cancel.store (true, std::memory_order_relaxed);
+    pthread_cond_broadcast (& s_search_cond);
+    pthread_mutex_unlock (& s_search_mutex);
+
+    s_search_timer.stop ();
+}
+
+/* runs the pending search synchronously, for when the results are
+ * needed immediately (e.g. acting on the current selection) */
+static void finish_search_now ()
+{
+    s_search_timer.stop ();
+    cancel_search ();
+
+    const char * text = gtk_entry_get_text ((GtkEntry *) entry);
+    auto terms = str_list_to_index (str_tolower_utf8 (text), " ");
+    s_model.do_search (terms, aud_get_int (CFG_ID, "max_results"));
+    search_finished ();
+}
+
 static void trigger_search ()
 {
     s_search_timer.queue (SEARCH_DELAY, search_timeout);
@@ -171,9 +294,11 @@ static void trigger_search ()
 
 void Library::signal_update ()
 {
+    cancel_search ();
+
     if (s_library->is_ready ())
     {
-        s_model.create_database (s_library->playlist ());
+        s_model.update_database (s_library->playlist ());
         search_timeout ();
     }
     else
@@ -187,14 +312,31 @@ void Library::signal_update ()
     show_hide_widgets ();
 }
 
+static void library_changed ()
+{
+    AUDINFO ("Library directory changed, refreshing library.\n");
+
+    s_library->begin_add (get_uris ());
+    s_library->check_ready_and_update (true);
+}
+
+static void reset_monitor ()
+{
+    s_watch.stop ();
+
+    if (s_library && aud_get_bool (CFG_ID, "monitor"))
+        s_watch.start (get_uris (), library_changed);
+}
+
 static void search_init ()
 {
     s_library = new Library;
 
     if (aud_get_bool (CFG_ID, "rescan_on_startup"))
-        s_library->begin_add (get_uri ());
+        s_library->begin_add (get_uris ());
 
     s_library->check_ready_and_update (true);
+    reset_monitor ();
 }
 
 static void search_cleanup ()
@@ -202,6 +344,22 @@ static void search_cleanup ()
     s_search_timer.stop ();
     s_search_pending = false;
 
+    if (s_thread_started)
+    {
+        pthread_mutex_lock (& s_search_mutex);
+        s_search_quit = true;
+        s_search_cancel.store (true, std::memory_order_relaxed);
+        pthread_cond_broadcast (& s_search_cond);
+        pthread_mutex_unlock (& s_search_mutex);
+
+        pthread_join (s_search_thread, nullptr);
+        s_thread_started = false;
+        s_search_quit = false;
+    }
+
+    s_results_func.stop ();
+    s_watch.stop ();
+
     delete s_library;
     s_library = nullptr;
 
@@ -212,7 +370,7 @@ static void search_cleanup ()
 static void do_add (bool play, bool set_title)
 {
     if (s_search_pending)
-        search_timeout ();
+        finish_search_now ();
 
     auto list = s_library->playlist ();
     int n_items = s_model.num_items ();
@@ -357,7 +515,7 @@ static void list_right_click (void * user, GdkEventButton * event)
 static Index<char> list_get_data (void * user)
 {
     if (s_search_pending)
-        search_timeout ();
+        finish_search_now ();
 
     auto list = s_library->playlist ();
     int n_items = s_model.num_items ();
@@ -424,8 +582,11 @@ static void refresh_cb (GtkButton * button, GtkWidget * file_entry)
         StringBuf path = uri_to_filename (uri);
         aud_set_str (CFG_ID, "path", path ? path : uri);
 
-        s_library->begin_add (uri);
+        Index<String> uris;
+        uris.append (uri);
+        s_library->begin_add (uris);
         s_library->check_ready_and_update (true);
+        reset_monitor ();
     }
 }
 
@@ -487,7 +648,7 @@ void * SearchTool::get_gtk_widget ()
      (GTK_FILE_CHOOSER_ACTION_SELECT_FOLDER, _("Choose Folder"));
     gtk_box_pack_start ((GtkBox *) hbox, file_entry, true, true, 0);
 
-    audgui_file_entry_set_uri (file_entry, get_uri ());
+    audgui_file_entry_set_uri (file_entry, get_uris ()[0]);
 
     GtkWidget * button = gtk_button_new ();
     gtk_container_add ((GtkContainer *) button, gtk_image_new_from_icon_name
@@ -24,9 +24,11 @@
 #include <assert.h>
 #include <pthread.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <libaudcore/audstrings.h>
 #include <libaudcore/i18n.h>
+#include <libaudcore/multihash.h>
 #include <libaudcore/plugin.h>
 #include <libaudcore/runtime.h>
 
@@ -76,6 +78,60 @@ static void xs_get_song_tuple_info(Tuple &pResult, const xs_tuneinfo_t &info, in
 
 static pthread_mutex_t s_init_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+/* The reSIDfp emulation can be slower than real time in spots (filter-heavy
+ * tunes, multi-SID configurations), so it runs on its own thread, rendering
+ * ahead of the output into a bounded PCM ring.  The output thread then only
+ * copies from the ring, which decouples emulation jitter from the output
+ * deadlines. */
+
+#define XS_RING_CHUNK 4096
+
+static pthread_mutex_t s_ring_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_ring_cond = PTHREAD_COND_INITIALIZER;
+static Index<char> s_ring;
+static int s_ring_drained;  /* bytes already consumed from the front */
+static int s_ring_limit;
+static bool s_ring_quit, s_ring_eof;
+
+static void *emulation_worker(void *)
+{
+    char chunk[XS_RING_CHUNK];
+
+    pthread_mutex_lock(&s_ring_mutex);
+
+    while (!s_ring_quit && !s_ring_eof)
+    {
+        if (s_ring.len() - s_ring_drained >= s_ring_limit)
+        {
+            pthread_cond_wait(&s_ring_cond, &s_ring_mutex);
+            continue;
+        }
+
+        pthread_mutex_unlock(&s_ring_mutex);
+        unsigned filled = xs_sidplayfp_fillbuffer(chunk, sizeof chunk);
+        pthread_mutex_lock(&s_ring_mutex);
+
+        if (!filled)
+            s_ring_eof = true;
+        else
+        {
+            /* drop the drained prefix once it outweighs the live data */
+            if (s_ring_drained >= s_ring_limit)
+            {
+                s_ring.remove(0, s_ring_drained);
+                s_ring_drained = 0;
+            }
+
+            s_ring.insert(chunk, -1, filled);
+        }
+
+        pthread_cond_broadcast(&s_ring_cond);
+    }
+
+    pthread_mutex_unlock(&s_ring_mutex);
+    return nullptr;
+}
+
 /*
  * Initialization functions
  */
@@ -171,12 +227,18 @@ bool SIDPlugin::play(const char *filename, VFSFile &file)
     /* Open the audio output */
     open_audio(FMT_S16_NE, xs_cfg.audioFrequency, xs_cfg.audioChannels);
 
-    /* Allocate audio buffer */
-    int audioBufSize = xs_cfg.audioFrequency * xs_cfg.audioChannels * 2;
-    if (audioBufSize < 512)
-        audioBufSize = 512;
+    /* Keep up to a second of rendered audio ahead of the output */
+    s_ring.resize(0);
+    s_ring_drained = 0;
+    s_ring_limit = xs_cfg.audioFrequency * xs_cfg.audioChannels * 2;
+    s_ring_quit = s_ring_eof = false;
+
+    pthread_t worker;
+    if (pthread_create(&worker, nullptr, emulation_worker, nullptr)) {
+        AUDERR("Couldn't start the emulation thread!\n");
+        return false;
+    }
 
-    char *audioBuffer = new char[audioBufSize];
     int64_t bytes_played = 0;
 
     while (! check_stop ())
@@ -184,10 +246,28 @@ bool SIDPlugin::play(const char *filename, VFSFile &file)
         if (check_seek () >= 0)
             AUDWARN ("Seeking is not implemented, ignoring.\n");
 
-        int bufRemaining = xs_sidplayfp_fillbuffer(audioBuffer, audioBufSize);
+        char chunk[XS_RING_CHUNK];
 
-        write_audio (audioBuffer, bufRemaining);
-        bytes_played += bufRemaining;
+        pthread_mutex_lock(&s_ring_mutex);
+
+        while (s_ring.len() == s_ring_drained && !s_ring_eof)
+            pthread_cond_wait(&s_ring_cond, &s_ring_mutex);
+
+        int take = aud::min(s_ring.len() - s_ring_drained, (int) sizeof chunk);
+
+        if (!take) {
+            pthread_mutex_unlock(&s_ring_mutex);
+            break;
+        }
+
+        memcpy(chunk, &s_ring[s_ring_drained], take);
+        s_ring_drained += take;
+
+        pthread_cond_broadcast(&s_ring_cond);
+        pthread_mutex_unlock(&s_ring_mutex);
+
+        write_audio (chunk, take);
+        bytes_played += take;
 
         /* Check if we have played enough */
         int time_played = aud::rescale<int64_t> (bytes_played,
@@ -210,7 +290,13 @@ bool SIDPlugin::play(const char *filename, VFSFile &file)
         }
     }
 
-    delete[] audioBuffer;
+    pthread_mutex_lock(&s_ring_mutex);
+    s_ring_quit = true;
+    pthread_cond_broadcast(&s_ring_cond);
+    pthread_mutex_unlock(&s_ring_mutex);
+
+    pthread_join(worker, nullptr);
+    s_ring.clear();
 
     return true;
 }
@@ -256,27 +342,86 @@ static void xs_fill_subtunes(Tuple &tuple, const xs_tuneinfo_t &info)
     tuple.set_subtunes (subtunes.len (), subtunes.begin ());
 }
 
+/* Each subtune of a multi-song SID gets its own read_tag call, and each
+ * call re-read and re-parsed the whole file.  The tune information of a
+ * file is cached on first read so the remaining subtunes are served from
+ * memory.  The file size stands in for a modification time, which the
+ * VFS layer does not provide. */
+struct xs_cached_info_t
+{
+    int64_t file_size = 0;
+    xs_tuneinfo_t info;
+};
+
+static pthread_mutex_t s_info_mutex = PTHREAD_MUTEX_INITIALIZER;
+static SimpleHash<String, xs_cached_info_t> s_info_cache;
+static int s_info_cache_entries = 0;
+
+static void xs_fill_from_info(Tuple &tuple, const xs_tuneinfo_t &info, int tune)
+{
+    xs_get_song_tuple_info(tuple, info, tune);
+
+    if (xs_cfg.subAutoEnable && info.nsubTunes > 1 && tune < 0)
+        xs_fill_subtunes(tuple, info);
+}
+
 bool SIDPlugin::read_tag(const char *filename, VFSFile &file, Tuple &tuple, Index<char> *image)
 {
     if (!delayed_init())
         return false;
 
+    /* Get information from URL */
+    int tune = tuple.get_int (Tuple::Subtune);
+
+    const char *sub;
+    uri_parse(filename, nullptr, nullptr, &sub, nullptr);
+    String path = String(str_copy(filename, sub - filename));
+    int64_t size = file.fsize();
+
+    if (size >= 0) {
+        pthread_mutex_lock(&s_info_mutex);
+        xs_cached_info_t *entry = s_info_cache.lookup(path);
+
+        if (entry && entry->file_size == size) {
+            xs_fill_from_info(tuple, entry->info, tune);
+            pthread_mutex_unlock(&s_info_mutex);
+            return true;
+        }
+
+        pthread_mutex_unlock(&s_info_mutex);
+    }
+
     Index<char> buf = file.read_all ();
     if (!xs_sidplayfp_probe(buf.begin(), buf.len()))
         return false;
 
-    /* Get information from URL */
-    int tune = tuple.get_int (Tuple::Subtune);
-
     /* Get tune information from emulation engine */
     xs_tuneinfo_t info;
     if (!xs_sidplayfp_getinfo(info, buf.begin(), buf.len()))
         return false;
 
-    xs_get_song_tuple_info(tuple, info, tune);
+    xs_fill_from_info(tuple, info, tune);
 
-    if (xs_cfg.subAutoEnable && info.nsubTunes > 1 && tune < 0)
-        xs_fill_subtunes(tuple, info);
+    if (size >= 0) {
+        pthread_mutex_lock(&s_info_mutex);
+        xs_cached_info_t *entry = s_info_cache.lookup(path);
+
+        if (!entry) {
+            /* primitive size cap; entries are small and dropping the
+             * cache once in a long while just means parsing again */
+            if (s_info_cache_entries >= 256) {
+                s_info_cache.clear();
+                s_info_cache_entries = 0;
+            }
+
+            entry = s_info_cache.add(path, xs_cached_info_t());
+            s_info_cache_entries++;
+        }
+
+        entry->file_size = size;
+        entry->info = std::move(info);
+        pthread_mutex_unlock(&s_info_mutex);
+    }
 
     return true;
 }
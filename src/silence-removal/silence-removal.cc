@@ -25,6 +25,12 @@
 
 #include <math.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#elif defined (__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #define MAX_BUFFER_SECS  10
 
 class SilenceRemoval : public EffectPlugin
@@ -60,6 +66,7 @@ const char SilenceRemoval::about[] =
 
 const char * const SilenceRemoval::defaults[] = {
     "threshold", "-40",
+    "lookahead", "10",
     nullptr
 };
 
@@ -67,7 +74,10 @@ const PreferencesWidget SilenceRemoval::widgets[] = {
     WidgetLabel (N_("<b>Silence Removal</b>")),
     WidgetSpin (N_("Threshold:"),
         WidgetInt ("silence-removal", "threshold"),
-        {-60, -20, 1, N_("dB")})
+        {-60, -20, 1, N_("dB")}),
+    WidgetSpin (N_("Lookahead:"),
+        WidgetInt ("silence-removal", "lookahead"),
+        {1, MAX_BUFFER_SECS, 1, N_("seconds")})
 };
 
 const PluginPreferences SilenceRemoval::prefs = {{widgets}};
@@ -91,14 +101,95 @@ void SilenceRemoval::cleanup ()
 
 void SilenceRemoval::start (int & channels, int & rate)
 {
+    int lookahead = aud::clamp (aud_get_int ("silence-removal", "lookahead"),
+     1, MAX_BUFFER_SECS);
+
     buffer.discard ();
-    buffer.alloc (channels * rate * MAX_BUFFER_SECS);
+    buffer.alloc (channels * rate * lookahead);
     output.resize (0);
 
     current_channels = channels;
     initial_silence = true;
 }
 
+/* The scans below test four samples per step where SSE2 or NEON is
+ * available and drop to per-sample resolution only inside the block that
+ * crosses the threshold (and for the unaligned tail). */
+
+static int find_first_loud (const float * data, int len, float threshold)
+{
+    int i = 0;
+
+#ifdef __SSE2__
+    const __m128 mask = _mm_castsi128_ps (_mm_set1_epi32 (0x7fffffff));
+    const __m128 thresh = _mm_set1_ps (threshold);
+
+    for (; i + 4 <= len; i += 4)
+    {
+        __m128 mag = _mm_and_ps (_mm_loadu_ps (data + i), mask);
+        if (_mm_movemask_ps (_mm_cmpgt_ps (mag, thresh)))
+            break;
+    }
+#elif defined (__ARM_NEON)
+    const float32x4_t thresh = vdupq_n_f32 (threshold);
+
+    for (; i + 4 <= len; i += 4)
+    {
+        uint32x4_t hit = vcgtq_f32 (vabsq_f32 (vld1q_f32 (data + i)), thresh);
+        uint32x2_t any = vorr_u32 (vget_low_u32 (hit), vget_high_u32 (hit));
+        if (vget_lane_u32 (vpmax_u32 (any, any), 0))
+            break;
+    }
+#endif
+
+    for (; i < len; i ++)
+    {
+        if (fabsf (data[i]) > threshold)
+            return i;
+    }
+
+    return -1;
+}
+
+static int find_last_loud (const float * data, int len, float threshold)
+{
+    int i = len;
+
+#ifdef __SSE2__
+    const __m128 mask = _mm_castsi128_ps (_mm_set1_epi32 (0x7fffffff));
+    const __m128 thresh = _mm_set1_ps (threshold);
+
+    while (i >= 4)
+    {
+        __m128 mag = _mm_and_ps (_mm_loadu_ps (data + i - 4), mask);
+        if (_mm_movemask_ps (_mm_cmpgt_ps (mag, thresh)))
+            break;
+
+        i -= 4;
+    }
+#elif defined (__ARM_NEON)
+    const float32x4_t thresh = vdupq_n_f32 (threshold);
+
+    while (i >= 4)
+    {
+        uint32x4_t hit = vcgtq_f32 (vabsq_f32 (vld1q_f32 (data + i - 4)), thresh);
+        uint32x2_t any = vorr_u32 (vget_low_u32 (hit), vget_high_u32 (hit));
+        if (vget_lane_u32 (vpmax_u32 (any, any), 0))
+            break;
+
+        i -= 4;
+    }
+#endif
+
+    for (; i > 0; i --)
+    {
+        if (fabsf (data[i - 1]) > threshold)
+            return i - 1;
+    }
+
+    return -1;
+}
+
 static float * align_to_frame (float * begin, float * sample, bool align_to_end)
 {
     if (! sample)
@@ -139,15 +230,12 @@ Index<float> & SilenceRemoval::process (Index<float> & data)
     float * first_sample = nullptr;
     float * last_sample = nullptr;
 
-    for (float & sample : data)
-    {
-        if (sample > threshold || sample < -threshold)
-        {
-            if (! first_sample)
-                first_sample = & sample;
+    int first = find_first_loud (data.begin (), data.len (), threshold);
 
-            last_sample = & sample;
-        }
+    if (first >= 0)
+    {
+        first_sample = & data[first];
+        last_sample = & data[find_last_loud (data.begin (), data.len (), threshold)];
     }
 
     first_sample = align_to_frame (data.begin (), first_sample, false);
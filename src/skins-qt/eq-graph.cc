@@ -80,10 +80,36 @@ static double eval_spline (const double * xa, const double * ya, const double *
              (b * b * b - b) * y2a[khi]) * (h * h) / 6.0);
 }
 
-void EqGraph::draw (QPainter & cr)
+/* The natural cubic spline is a linear operator on the band values: the
+ * second derivatives solve a linear system in y, and evaluation is a
+ * linear combination of y and y2.  So the curve each band contributes
+ * per pixel can be computed once from the fixed band positions, and a
+ * redraw is then a 10-term weighted sum per pixel instead of a spline
+ * solve and per-pixel evaluation. */
+static double eq_basis[109][N];
+static bool eq_basis_ready = false;
+
+static void init_basis ()
 {
     static const double x[N] = {0, 11, 23, 35, 47, 59, 71, 83, 97, 109};
 
+    for (int b = 0; b < N; b ++)
+    {
+        double unit[N] = {0};
+        unit[b] = 1.0;
+
+        double y2[N];
+        init_spline (x, unit, y2);
+
+        for (int i = 0; i < 109; i ++)
+            eq_basis[i][b] = eval_spline (x, unit, y2, i);
+    }
+
+    eq_basis_ready = true;
+}
+
+void EqGraph::draw (QPainter & cr)
+{
     if (skin.pixmaps[SKIN_EQMAIN].height () < 313)
         return;
 
@@ -94,13 +120,17 @@ void EqGraph::draw (QPainter & cr)
     double bands[N];
     aud_eq_get_bands (bands);
 
-    double yf[N];
-    init_spline (x, bands, yf);
+    if (! eq_basis_ready)
+        init_basis ();
 
     int py = 0;
     for (int i = 0; i < 109; i ++)
     {
-        int y = 9.5 - eval_spline (x, bands, yf, i) * 9 / AUD_EQ_MAX_GAIN;
+        double value = 0;
+        for (int b = 0; b < N; b ++)
+            value += eq_basis[i][b] * bands[b];
+
+        int y = 9.5 - value * 9 / AUD_EQ_MAX_GAIN;
         y = aud::clamp (y, 0, 18);
 
         if (!i)
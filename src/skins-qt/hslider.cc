@@ -120,7 +120,11 @@ void HSlider::set_pos (int pos)
     if (m_pressed)
         return;
 
-    m_pos = aud::clamp (pos, m_min, m_max);
+    pos = aud::clamp (pos, m_min, m_max);
+    if (m_pos == pos)
+        return;
+
+    m_pos = pos;
     queue_draw ();
 }
 
@@ -43,6 +43,7 @@
 #include <libaudcore/playlist.h>
 #include <libaudqt/libaudqt.h>
 
+#include <QImage>
 #include <QMimeData>
 
 enum {
@@ -133,124 +134,204 @@ void PlaylistWidget::cancel_all ()
     popup_hide ();
 }
 
-void PlaylistWidget::draw (QPainter & cr)
+void PlaylistWidget::draw_row (QPainter & cr, const RowState & state,
+ int row, int left, int right, int len_right, int queue_right)
 {
-    int active_entry = m_playlist.get_position ();
-    int left = 3, right = 3;
-    int width;
-    QRect rect;
+    int y = m_offset + m_row_height * row;
 
-    cr.setFont (* m_font);
+    /* selection highlight */
 
-    /* background */
+    if (state.selected)
+        cr.fillRect (0, y, m_width, m_row_height,
+         QColor (skin.colors[SKIN_PLEDIT_SELECTEDBG]));
 
-    cr.fillRect (cr.window (), QColor (skin.colors[SKIN_PLEDIT_NORMALBG]));
+    cr.setPen (QColor (skin.colors[state.active ?
+     SKIN_PLEDIT_CURRENT : SKIN_PLEDIT_NORMAL]));
 
-    /* playlist title */
+    /* entry number */
 
-    if (m_offset)
+    if (state.number)
     {
-        cr.setPen (QColor (skin.colors[SKIN_PLEDIT_NORMAL]));
-        cr.drawText (left, 0, m_width - left - right, m_row_height,
-         Qt::AlignCenter, (const char *) m_title_text);
+        char buf[16];
+        snprintf (buf, sizeof buf, "%d.", state.number);
+
+        cr.drawText (3, y, m_width - 6, m_row_height,
+         Qt::AlignLeft | Qt::AlignVCenter, buf);
     }
 
-    /* selection highlight */
+    /* entry length */
+
+    if (state.length >= 0)
+        cr.drawText (0, y, len_right, m_row_height,
+         Qt::AlignRight | Qt::AlignVCenter,
+         (const char *) str_format_time (state.length));
+
+    /* queue position */
+
+    if (state.queue_pos >= 0)
+    {
+        char buf[16];
+        snprintf (buf, sizeof buf, "(#%d)", 1 + state.queue_pos);
+
+        cr.drawText (0, y, queue_right, m_row_height,
+         Qt::AlignRight | Qt::AlignVCenter, buf);
+    }
+
+    /* title */
+
+    cr.drawText (left, y, m_width - left - right, m_row_height,
+     Qt::AlignLeft | Qt::AlignVCenter, (const char *) state.title);
+}
+
+void PlaylistWidget::update_canvas ()
+{
+    int active_entry = m_playlist.get_position ();
+    bool show_numbers = aud_get_bool ("show_numbers_in_pl");
+    bool have_queue = m_playlist.n_queued ();
+    int left = 3, right = 3;
+
+    /* gather the current state of the visible rows */
+
+    Index<RowState> states;
 
     for (int i = m_first; i < m_first + m_rows && i < m_length; i ++)
     {
-        if (m_playlist.entry_selected (i))
-            cr.fillRect (0, m_offset + m_row_height * (i - m_first), m_width,
-             m_row_height, QColor (skin.colors[SKIN_PLEDIT_SELECTEDBG]));
+        Tuple tuple = m_playlist.entry_tuple (i, Playlist::NoWait);
+
+        RowState & state = states.append ();
+        state.title = tuple.get_str (Tuple::FormattedTitle);
+        state.length = tuple.get_int (Tuple::Length);
+        state.number = show_numbers ? 1 + i : 0;
+        state.queue_pos = have_queue ? m_playlist.queue_find_entry (i) : -1;
+        state.selected = m_playlist.entry_selected (i);
+        state.active = (i == active_entry);
     }
 
-    /* entry numbers */
+    /* column layout (text measurement only; nothing is rasterized) */
+
+    int width;
 
-    if (aud_get_bool ("show_numbers_in_pl"))
+    if (show_numbers)
     {
         width = 0;
 
-        for (int i = m_first; i < m_first + m_rows && i < m_length; i ++)
+        for (const RowState & state : states)
         {
             char buf[16];
-            snprintf (buf, sizeof buf, "%d.", 1 + i);
-
-            cr.setPen (QColor (skin.colors[(i == active_entry) ?
-             SKIN_PLEDIT_CURRENT : SKIN_PLEDIT_NORMAL]));
-            cr.drawText (left, m_offset + m_row_height * (i - m_first),
-             m_width - left - right, m_row_height,
-             Qt::AlignLeft | Qt::AlignVCenter, buf, & rect);
-
-            width = aud::max (width, rect.width ());
+            snprintf (buf, sizeof buf, "%d.", state.number);
+            width = aud::max (width, m_metrics->horizontalAdvance (buf));
         }
 
         left += width + 4;
     }
 
-    /* entry lengths */
-
+    int len_right = m_width - right;
     width = 0;
 
-    for (int i = m_first; i < m_first + m_rows && i < m_length; i ++)
+    for (const RowState & state : states)
     {
-        Tuple tuple = m_playlist.entry_tuple (i, Playlist::NoWait);
-        int len = tuple.get_int (Tuple::Length);
-        if (len < 0)
-            continue;
-
-        cr.setPen (QColor (skin.colors[(i == active_entry) ?
-         SKIN_PLEDIT_CURRENT : SKIN_PLEDIT_NORMAL]));
-        cr.drawText (left, m_offset + m_row_height * (i - m_first),
-         m_width - left - right, m_row_height,
-         Qt::AlignRight | Qt::AlignVCenter,
-         (const char *) str_format_time (len), & rect);
-
-        width = aud::max (width, rect.width ());
+        if (state.length >= 0)
+            width = aud::max (width, m_metrics->horizontalAdvance
+             ((const char *) str_format_time (state.length)));
     }
 
     right += width + 6;
+    int queue_right = m_width - right;
 
-    /* queue positions */
-
-    if (m_playlist.n_queued ())
+    if (have_queue)
     {
         width = 0;
 
-        for (int i = m_first; i < m_first + m_rows && i < m_length; i ++)
+        for (const RowState & state : states)
         {
-            int pos = m_playlist.queue_find_entry (i);
-            if (pos < 0)
+            if (state.queue_pos < 0)
                 continue;
 
             char buf[16];
-            snprintf (buf, sizeof buf, "(#%d)", 1 + pos);
-
-            cr.setPen (QColor (skin.colors[(i == active_entry) ?
-             SKIN_PLEDIT_CURRENT : SKIN_PLEDIT_NORMAL]));
-            cr.drawText (left, m_offset + m_row_height * (i - m_first),
-             m_width - left - right, m_row_height,
-             Qt::AlignRight | Qt::AlignVCenter, buf, & rect);
-
-            width = aud::max (width, rect.width ());
+            snprintf (buf, sizeof buf, "(#%d)", 1 + state.queue_pos);
+            width = aud::max (width, m_metrics->horizontalAdvance (buf));
         }
 
         right += width + 6;
     }
 
-    /* titles */
+    /* rows from the previous canvas can only be reused if the column
+     * layout and title bar are unchanged */
 
-    for (int i = m_first; i < m_first + m_rows && i < m_length; i ++)
+    bool reuse = m_canvas && m_offset == m_canvas_offset &&
+     left == m_canvas_left && right == m_canvas_right &&
+     queue_right == m_canvas_queue_right && m_title_text == m_canvas_title;
+
+    if (reuse && m_first == m_canvas_first && states.len () == m_row_cache.len ())
     {
-        Tuple tuple = m_playlist.entry_tuple (i, Playlist::NoWait);
-        String title = tuple.get_str (Tuple::FormattedTitle);
+        bool same = true;
+        for (int r = 0; same && r < states.len (); r ++)
+            same = (states[r] == m_row_cache[r]);
 
-        cr.setPen (QColor (skin.colors[(i == active_entry) ?
-         SKIN_PLEDIT_CURRENT : SKIN_PLEDIT_NORMAL]));
-        cr.drawText (left, m_offset + m_row_height * (i - m_first),
-         m_width - left - right, m_row_height,
-         Qt::AlignLeft | Qt::AlignVCenter, (const char *) title);
+        /* nothing changed at all; keep the canvas as it is */
+        if (same)
+            return;
     }
 
+    SmartPtr<QImage> canvas (new QImage (m_width, m_height, QImage::Format_RGB32));
+    QPainter cr (canvas.get ());
+
+    cr.setFont (* m_font);
+
+    /* background */
+
+    cr.fillRect (canvas->rect (), QColor (skin.colors[SKIN_PLEDIT_NORMALBG]));
+
+    /* playlist title */
+
+    if (m_offset)
+    {
+        cr.setPen (QColor (skin.colors[SKIN_PLEDIT_NORMAL]));
+        cr.drawText (3, 0, m_width - 6, m_row_height,
+         Qt::AlignCenter, (const char *) m_title_text);
+    }
+
+    /* blit rows unchanged since the last render from the old canvas (this
+     * is also how scrolling by whole rows avoids re-rendering); draw the
+     * rest through the font path */
+
+    for (int r = 0; r < states.len (); r ++)
+    {
+        int old_r = (m_first + r) - m_canvas_first;
+
+        if (reuse && old_r >= 0 && old_r < m_row_cache.len () &&
+         states[r] == m_row_cache[old_r])
+        {
+            int y = m_offset + m_row_height * r;
+            cr.drawImage (0, y, * m_canvas, 0, m_offset + m_row_height * old_r,
+             m_width, m_row_height);
+        }
+        else
+            draw_row (cr, states[r], r, left, right, len_right, queue_right);
+    }
+
+    cr.end ();
+
+    m_canvas = std::move (canvas);
+    m_row_cache = std::move (states);
+    m_canvas_title = m_title_text;
+    m_canvas_first = m_first;
+    m_canvas_offset = m_offset;
+    m_canvas_left = left;
+    m_canvas_right = right;
+    m_canvas_queue_right = queue_right;
+}
+
+void PlaylistWidget::draw (QPainter & cr)
+{
+    update_canvas ();
+
+    /* rendered rows */
+
+    cr.drawImage (0, 0, * m_canvas);
+
+    cr.setFont (* m_font);
+
     /* focus rectangle */
 
     int focus = m_playlist.get_focus ();
@@ -286,6 +367,7 @@ void PlaylistWidget::resize (int width, int height)
 {
     m_width = width * config.scale;
     m_height = height * config.scale;
+    m_canvas.clear ();
 
     Widget::resize (m_width, m_height);
     refresh ();
@@ -296,6 +378,7 @@ void PlaylistWidget::set_font (const char * font)
     m_font.capture (new QFont (audqt::qfont_from_string (font)));
     m_metrics.capture (new QFontMetrics (* m_font, this));
     m_row_height = m_metrics->height ();
+    m_canvas.clear ();
     refresh ();
 }
 
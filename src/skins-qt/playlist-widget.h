@@ -37,6 +37,7 @@
 class PlaylistSlider;
 class QFont;
 class QFontMetrics;
+class QImage;
 
 class PlaylistWidget : public Widget
 {
@@ -66,9 +67,33 @@ private:
     void dropEvent (QDropEvent * event) override;
     bool leave () override;
 
+    /* everything that affects how one row is drawn; rows whose state is
+     * unchanged are blitted from the previous canvas instead of being
+     * rasterized again */
+    struct RowState
+    {
+        String title;
+        int length = -1;     /* song length, -1 if unknown */
+        int number = 0;      /* 1-based entry number, 0 if numbers are hidden */
+        int queue_pos = -1;  /* 0-based queue position, -1 if not queued */
+        bool selected = false;
+        bool active = false;
+
+        bool operator== (const RowState & b) const
+        {
+            return title == b.title && length == b.length &&
+             number == b.number && queue_pos == b.queue_pos &&
+             selected == b.selected && active == b.active;
+        }
+    };
+
     void update_title ();
     void calc_layout ();
 
+    void draw_row (QPainter & cr, const RowState & state, int row,
+     int left, int right, int len_right, int queue_right);
+    void update_canvas ();
+
     int calc_position (int y) const;
     int adjust_position (bool relative, int position) const;
 
@@ -94,6 +119,13 @@ private:
     SmartPtr<QFontMetrics> m_metrics;
     String m_title_text;
 
+    /* offscreen canvas holding the rendered rows; see update_canvas () */
+    SmartPtr<QImage> m_canvas;
+    Index<RowState> m_row_cache;
+    String m_canvas_title;
+    int m_canvas_first = -1, m_canvas_offset = -1;
+    int m_canvas_left = -1, m_canvas_right = -1, m_canvas_queue_right = -1;
+
     Playlist m_playlist;
     int m_length = 0;
     int m_width = 0, m_height = 0, m_row_height = 1, m_offset = 0, m_rows = 0, m_first = 0;
@@ -58,6 +58,9 @@ PlayStatus::PlayStatus ()
 
 void PlayStatus::set_status (PStatus status)
 {
+    if (m_status == status)
+        return;
+
     m_status = status;
     queue_draw ();
 }
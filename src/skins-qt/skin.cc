@@ -201,6 +201,34 @@ static void skin_numbers_generate_dash (QImage & image)
     image = std::move (temp);
 }
 
+static void skin_build_atlas ()
+{
+    int width = 0, height = 0;
+
+    for (const QImage & image : skin.pixmaps)
+    {
+        width = aud::max (width, image.width ());
+        height += image.height ();
+    }
+
+    QImage atlas (width, height, QImage::Format_RGB32);
+    atlas.fill (0);
+
+    {
+        QPainter p (& atlas);
+        int y = 0;
+
+        for (int i = 0; i < SKIN_PIXMAP_COUNT; i ++)
+        {
+            skin.atlas_y[i] = y;
+            p.drawImage (0, y, skin.pixmaps[i]);
+            y += skin.pixmaps[i].height ();
+        }
+    }
+
+    skin.atlas = std::move (atlas);
+}
+
 static bool skin_load_pixmaps (const char * path)
 {
     AUDDBG ("Loading pixmaps in %s\n", path);
@@ -214,6 +242,9 @@ static bool skin_load_pixmaps (const char * path)
     skin_get_eq_spline_colors (skin.pixmaps[SKIN_EQMAIN]);
     skin_numbers_generate_dash (skin.pixmaps[SKIN_NUMBERS]);
 
+    /* pack after any generated pixmaps are final */
+    skin_build_atlas ();
+
     return true;
 }
 
@@ -311,8 +342,20 @@ void skin_install_skin (const char * path)
 void skin_draw_pixbuf (QPainter & p, SkinPixmapId id, int xsrc, int ysrc, int
  xdest, int ydest, int width, int height)
 {
-    if (! skin.pixmaps[id].isNull ())
-        p.drawImage (xdest, ydest, skin.pixmaps[id], xsrc, ysrc, width, height);
+    const QImage & image = skin.pixmaps[id];
+    if (image.isNull ())
+        return;
+
+    /* clip to the original pixmap, as Qt did when it was the source image;
+     * undersized skin bitmaps must not bleed into the next atlas row */
+    width = aud::min (width, image.width () - xsrc);
+    height = aud::min (height, image.height () - ysrc);
+
+    /* all draws share the atlas as their source, so the raster paint engine
+     * can batch consecutive blits instead of switching surfaces */
+    if (width > 0 && height > 0)
+        p.drawImage (xdest, ydest, skin.atlas, xsrc, ysrc + skin.atlas_y[id],
+         width, height);
 }
 
 static void skin_draw_playlistwin_frame_top (QPainter & cr, int width, bool focus)
@@ -173,6 +173,12 @@ struct Skin {
 
     QImage pixmaps[SKIN_PIXMAP_COUNT];
     Index<QRect> masks[SKIN_MASK_COUNT];
+
+    /* all pixmaps packed into a single image at load time; widgets draw
+     * source rectangles from it so the paint engine keeps one source surface
+     * instead of switching between a dozen small ones */
+    QImage atlas;
+    int atlas_y[SKIN_PIXMAP_COUNT] {};
 };
 
 extern Skin skin;
@@ -113,8 +113,12 @@ void EqSlider::set_value (float value)
     if (m_pressed)
         return;
 
+    int pos = aud::clamp (25 - (int) (value * 25 / AUD_EQ_MAX_GAIN), 0, 50);
+    if (m_value == value && m_pos == pos)
+        return;
+
     m_value = value;
-    m_pos = aud::clamp (25 - (int) (value * 25 / AUD_EQ_MAX_GAIN), 0, 50);
+    m_pos = pos;
     queue_draw ();
 }
 
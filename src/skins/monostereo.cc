@@ -56,6 +56,9 @@ MonoStereo::MonoStereo ()
 
 void MonoStereo::set_num_channels (int num_channels)
 {
+    if (m_num_channels == num_channels)
+        return;
+
     m_num_channels = num_channels;
     queue_draw ();
 }
@@ -85,8 +85,8 @@ int PlaylistWidget::calc_position (int y) const
     if (y < m_offset)
         return -1;
 
-    int position = m_first + (y - m_offset) / m_row_height;
-    if (position >= m_first + m_rows || position >= m_length)
+    int position = m_first + (y - m_offset + m_shift) / m_row_height;
+    if (position >= m_first + m_rows + (m_shift ? 1 : 0) || position >= m_length)
         return m_length;
 
     return position;
@@ -133,153 +133,281 @@ void PlaylistWidget::cancel_all ()
     popup_hide ();
 }
 
-void PlaylistWidget::draw (cairo_t * cr)
+int PlaylistWidget::text_width (const char * text)
 {
-    int active_entry = m_playlist.get_position ();
-    int left = 3, right = 3;
+    PangoLayout * layout = gtk_widget_create_pango_layout (gtk_dr (), text);
+    pango_layout_set_font_description (layout, m_font.get ());
+
+    PangoRectangle rect;
+    pango_layout_get_pixel_extents (layout, nullptr, & rect);
+    g_object_unref (layout);
+
+    return rect.width;
+}
+
+void PlaylistWidget::draw_row (cairo_t * cr, const RowState & state, int row,
+ int left, int right, int len_right, int queue_right)
+{
+    int y = m_offset + m_row_height * row;
     PangoLayout * layout;
-    int width;
 
-    /* background */
+    /* selection highlight */
 
-    set_cairo_color (cr, skin.colors[SKIN_PLEDIT_NORMALBG]);
-    cairo_paint (cr);
+    if (state.selected)
+    {
+        cairo_rectangle (cr, 0, y, m_width, m_row_height);
+        set_cairo_color (cr, skin.colors[SKIN_PLEDIT_SELECTEDBG]);
+        cairo_fill (cr);
+    }
 
-    /* playlist title */
+    set_cairo_color (cr, skin.colors[state.active ?
+     SKIN_PLEDIT_CURRENT : SKIN_PLEDIT_NORMAL]);
 
-    if (m_offset)
+    /* entry number */
+
+    if (state.number)
     {
-        layout = gtk_widget_create_pango_layout (gtk_dr (), m_title_text);
+        char buf[16];
+        snprintf (buf, sizeof buf, "%d.", state.number);
+
+        layout = gtk_widget_create_pango_layout (gtk_dr (), buf);
         pango_layout_set_font_description (layout, m_font.get ());
-        pango_layout_set_width (layout, PANGO_SCALE * (m_width - left - right));
-        pango_layout_set_alignment (layout, PANGO_ALIGN_CENTER);
-        pango_layout_set_ellipsize (layout, PANGO_ELLIPSIZE_MIDDLE);
 
-        cairo_move_to (cr, left, 0);
-        set_cairo_color (cr, skin.colors[SKIN_PLEDIT_NORMAL]);
+        cairo_move_to (cr, 3, y);
         pango_cairo_show_layout (cr, layout);
         g_object_unref (layout);
     }
 
-    /* selection highlight */
+    /* entry length */
 
-    for (int i = m_first; i < m_first + m_rows && i < m_length; i ++)
+    if (state.length >= 0)
     {
-        if (! m_playlist.entry_selected (i))
-            continue;
+        layout = gtk_widget_create_pango_layout (gtk_dr (),
+         str_format_time (state.length));
+        pango_layout_set_font_description (layout, m_font.get ());
 
-        cairo_rectangle (cr, 0, m_offset + m_row_height * (i - m_first), m_width, m_row_height);
-        set_cairo_color (cr, skin.colors[SKIN_PLEDIT_SELECTEDBG]);
-        cairo_fill (cr);
+        PangoRectangle rect;
+        pango_layout_get_pixel_extents (layout, nullptr, & rect);
+
+        cairo_move_to (cr, len_right - rect.width, y);
+        pango_cairo_show_layout (cr, layout);
+        g_object_unref (layout);
     }
 
-    /* entry numbers */
+    /* queue position */
 
-    if (aud_get_bool ("show_numbers_in_pl"))
+    if (state.queue_pos >= 0)
     {
-        width = 0;
+        char buf[16];
+        snprintf (buf, sizeof buf, "(#%d)", 1 + state.queue_pos);
 
-        for (int i = m_first; i < m_first + m_rows && i < m_length; i ++)
-        {
-            char buf[16];
-            snprintf (buf, sizeof buf, "%d.", 1 + i);
+        layout = gtk_widget_create_pango_layout (gtk_dr (), buf);
+        pango_layout_set_font_description (layout, m_font.get ());
 
-            layout = gtk_widget_create_pango_layout (gtk_dr (), buf);
-            pango_layout_set_font_description (layout, m_font.get ());
+        PangoRectangle rect;
+        pango_layout_get_pixel_extents (layout, nullptr, & rect);
 
-            PangoRectangle rect;
-            pango_layout_get_pixel_extents (layout, nullptr, & rect);
-            width = aud::max (width, rect.width);
+        cairo_move_to (cr, queue_right - rect.width, y);
+        pango_cairo_show_layout (cr, layout);
+        g_object_unref (layout);
+    }
 
-            cairo_move_to (cr, left, m_offset + m_row_height * (i - m_first));
-            set_cairo_color (cr, skin.colors[(i == active_entry) ?
-             SKIN_PLEDIT_CURRENT : SKIN_PLEDIT_NORMAL]);
-            pango_cairo_show_layout (cr, layout);
-            g_object_unref (layout);
-        }
+    /* title */
 
-        left += width + 4;
-    }
+    layout = gtk_widget_create_pango_layout (gtk_dr (), state.title);
+    pango_layout_set_font_description (layout, m_font.get ());
+    pango_layout_set_width (layout, PANGO_SCALE * (m_width - left - right));
+    pango_layout_set_ellipsize (layout, PANGO_ELLIPSIZE_END);
 
-    /* entry lengths */
+    cairo_move_to (cr, left, y);
+    pango_cairo_show_layout (cr, layout);
+    g_object_unref (layout);
+}
 
-    width = 0;
+void PlaylistWidget::update_canvas ()
+{
+    int active_entry = m_playlist.get_position ();
+    bool show_numbers = aud_get_bool ("show_numbers_in_pl");
+    bool have_queue = m_playlist.n_queued ();
+    int left = 3, right = 3;
+
+    /* gather the current state of the visible rows */
+
+    Index<RowState> states;
+
+    /* when shifted mid-row, one extra row is partly visible at the bottom */
+    int visible_rows = m_rows + (m_shift ? 1 : 0);
 
-    for (int i = m_first; i < m_first + m_rows && i < m_length; i ++)
+    for (int i = m_first; i < m_first + visible_rows && i < m_length; i ++)
     {
         Tuple tuple = m_playlist.entry_tuple (i, Playlist::NoWait);
-        int len = tuple.get_int (Tuple::Length);
-        if (len < 0)
-            continue;
 
-        layout = gtk_widget_create_pango_layout (gtk_dr (), str_format_time (len));
-        pango_layout_set_font_description (layout, m_font.get ());
+        RowState & state = states.append ();
+        state.title = tuple.get_str (Tuple::FormattedTitle);
+        state.length = tuple.get_int (Tuple::Length);
+        state.number = show_numbers ? 1 + i : 0;
+        state.queue_pos = have_queue ? m_playlist.queue_find_entry (i) : -1;
+        state.selected = m_playlist.entry_selected (i);
+        state.active = (i == active_entry);
+    }
 
-        PangoRectangle rect;
-        pango_layout_get_pixel_extents (layout, nullptr, & rect);
-        width = aud::max (width, rect.width);
+    /* column layout (text measurement only; nothing is rasterized) */
 
-        cairo_move_to (cr, m_width - right - rect.width, m_offset + m_row_height * (i - m_first));
-        set_cairo_color (cr, skin.colors[(i == active_entry) ?
-         SKIN_PLEDIT_CURRENT : SKIN_PLEDIT_NORMAL]);
-        pango_cairo_show_layout (cr, layout);
-        g_object_unref (layout);
+    int width;
+
+    if (show_numbers)
+    {
+        width = 0;
+
+        for (const RowState & state : states)
+        {
+            char buf[16];
+            snprintf (buf, sizeof buf, "%d.", state.number);
+            width = aud::max (width, text_width (buf));
+        }
+
+        left += width + 4;
     }
 
-    right += width + 6;
+    int len_right = m_width - right;
+    width = 0;
 
-    /* queue positions */
+    for (const RowState & state : states)
+    {
+        if (state.length >= 0)
+            width = aud::max (width, text_width (str_format_time (state.length)));
+    }
+
+    right += width + 6;
+    int queue_right = m_width - right;
 
-    if (m_playlist.n_queued ())
+    if (have_queue)
     {
         width = 0;
 
-        for (int i = m_first; i < m_first + m_rows && i < m_length; i ++)
+        for (const RowState & state : states)
         {
-            int pos = m_playlist.queue_find_entry (i);
-            if (pos < 0)
+            if (state.queue_pos < 0)
                 continue;
 
             char buf[16];
-            snprintf (buf, sizeof buf, "(#%d)", 1 + pos);
-
-            layout = gtk_widget_create_pango_layout (gtk_dr (), buf);
-            pango_layout_set_font_description (layout, m_font.get ());
-
-            PangoRectangle rect;
-            pango_layout_get_pixel_extents (layout, nullptr, & rect);
-            width = aud::max (width, rect.width);
-
-            cairo_move_to (cr, m_width - right - rect.width, m_offset +
-             m_row_height * (i - m_first));
-            set_cairo_color (cr, skin.colors[(i == active_entry) ?
-             SKIN_PLEDIT_CURRENT : SKIN_PLEDIT_NORMAL]);
-            pango_cairo_show_layout (cr, layout);
-            g_object_unref (layout);
+            snprintf (buf, sizeof buf, "(#%d)", 1 + state.queue_pos);
+            width = aud::max (width, text_width (buf));
         }
 
         right += width + 6;
     }
 
-    /* titles */
+    /* rows from the previous canvas can only be reused if the column
+     * layout and title bar are unchanged */
 
-    for (int i = m_first; i < m_first + m_rows && i < m_length; i ++)
+    bool reuse = m_canvas && m_offset == m_canvas_offset &&
+     left == m_canvas_left && right == m_canvas_right &&
+     queue_right == m_canvas_queue_right && m_title_text == m_canvas_title;
+
+    if (reuse && m_first == m_canvas_first && states.len () == m_row_cache.len ())
     {
-        Tuple tuple = m_playlist.entry_tuple (i, Playlist::NoWait);
-        String title = tuple.get_str (Tuple::FormattedTitle);
+        bool same = true;
+        for (int r = 0; same && r < states.len (); r ++)
+            same = (states[r] == m_row_cache[r]);
+
+        /* nothing changed at all; keep the canvas as it is */
+        if (same)
+            return;
+    }
+
+    /* one row taller than the widget so the partly visible row fits */
+    CairoSurfacePtr canvas (cairo_image_surface_create (CAIRO_FORMAT_RGB24,
+     m_width, m_height + m_row_height));
+    cairo_t * cr = cairo_create (canvas.get ());
+
+    /* background */
 
-        layout = gtk_widget_create_pango_layout (gtk_dr (), title);
+    set_cairo_color (cr, skin.colors[SKIN_PLEDIT_NORMALBG]);
+    cairo_paint (cr);
+
+    /* playlist title */
+
+    if (m_offset)
+    {
+        PangoLayout * layout = gtk_widget_create_pango_layout (gtk_dr (), m_title_text);
         pango_layout_set_font_description (layout, m_font.get ());
-        pango_layout_set_width (layout, PANGO_SCALE * (m_width - left - right));
-        pango_layout_set_ellipsize (layout, PANGO_ELLIPSIZE_END);
+        pango_layout_set_width (layout, PANGO_SCALE * (m_width - 6));
+        pango_layout_set_alignment (layout, PANGO_ALIGN_CENTER);
+        pango_layout_set_ellipsize (layout, PANGO_ELLIPSIZE_MIDDLE);
 
-        cairo_move_to (cr, left, m_offset + m_row_height * (i - m_first));
-        set_cairo_color (cr, skin.colors[(i == active_entry) ?
-         SKIN_PLEDIT_CURRENT : SKIN_PLEDIT_NORMAL]);
+        cairo_move_to (cr, 3, 0);
+        set_cairo_color (cr, skin.colors[SKIN_PLEDIT_NORMAL]);
         pango_cairo_show_layout (cr, layout);
         g_object_unref (layout);
     }
 
+    /* blit rows unchanged since the last render from the old canvas (this
+     * is also how scrolling by whole rows avoids re-rendering); draw the
+     * rest through the font path */
+
+    for (int r = 0; r < states.len (); r ++)
+    {
+        int old_r = (m_first + r) - m_canvas_first;
+
+        if (reuse && old_r >= 0 && old_r < m_row_cache.len () &&
+         states[r] == m_row_cache[old_r])
+        {
+            cairo_save (cr);
+            cairo_rectangle (cr, 0, m_offset + m_row_height * r, m_width, m_row_height);
+            cairo_clip (cr);
+            cairo_set_source_surface (cr, m_canvas.get (), 0, m_row_height * (r - old_r));
+            cairo_paint (cr);
+            cairo_restore (cr);
+        }
+        else
+            draw_row (cr, states[r], r, left, right, len_right, queue_right);
+    }
+
+    cairo_destroy (cr);
+
+    m_canvas = std::move (canvas);
+    m_row_cache = std::move (states);
+    m_canvas_title = m_title_text;
+    m_canvas_first = m_first;
+    m_canvas_offset = m_offset;
+    m_canvas_left = left;
+    m_canvas_right = right;
+    m_canvas_queue_right = queue_right;
+}
+
+void PlaylistWidget::draw (cairo_t * cr)
+{
+    update_canvas ();
+
+    /* rendered rows; mid-row scrolling is just a shifted blit of the same
+     * canvas, with the title bar pinned in place */
+
+    if (m_shift)
+    {
+        if (m_offset)
+        {
+            cairo_save (cr);
+            cairo_rectangle (cr, 0, 0, m_width, m_offset);
+            cairo_clip (cr);
+            cairo_set_source_surface (cr, m_canvas.get (), 0, 0);
+            cairo_paint (cr);
+            cairo_restore (cr);
+        }
+
+        cairo_save (cr);
+        cairo_rectangle (cr, 0, m_offset, m_width, m_height - m_offset);
+        cairo_clip (cr);
+        cairo_set_source_surface (cr, m_canvas.get (), 0, - m_shift);
+        cairo_paint (cr);
+        cairo_restore (cr);
+    }
+    else
+    {
+        cairo_set_source_surface (cr, m_canvas.get (), 0, 0);
+        cairo_paint (cr);
+    }
+
     /* focus rectangle */
 
     int focus = m_playlist.get_focus ();
@@ -290,8 +418,8 @@ void PlaylistWidget::draw (cairo_t * cr)
     {
         cairo_new_path (cr);
         cairo_set_line_width (cr, 1);
-        cairo_rectangle (cr, 0.5, m_offset + m_row_height * (focus - m_first) +
-         0.5, m_width - 1, m_row_height - 1);
+        cairo_rectangle (cr, 0.5, m_offset + m_row_height * (focus - m_first) -
+         m_shift + 0.5, m_width - 1, m_row_height - 1);
         set_cairo_color (cr, skin.colors[SKIN_PLEDIT_NORMAL]);
         cairo_stroke (cr);
     }
@@ -302,7 +430,7 @@ void PlaylistWidget::draw (cairo_t * cr)
     {
         cairo_new_path (cr);
         cairo_set_line_width (cr, 2);
-        cairo_move_to (cr, 0, m_offset + m_row_height * (m_hover - m_first));
+        cairo_move_to (cr, 0, m_offset + m_row_height * (m_hover - m_first) - m_shift);
         cairo_rel_line_to (cr, m_width, 0);
         set_cairo_color (cr, skin.colors[SKIN_PLEDIT_NORMAL]);
         cairo_stroke (cr);
@@ -321,6 +449,7 @@ void PlaylistWidget::resize (int width, int height)
 {
     m_width = width * config.scale;
     m_height = height * config.scale;
+    m_canvas.clear ();
 
     Widget::resize (m_width, m_height);
     refresh ();
@@ -340,6 +469,8 @@ void PlaylistWidget::set_font (const char * font)
     m_row_height = aud::max (rect.height, 1);
 
     g_object_unref (layout);
+    m_canvas.clear ();
+    stop_smooth (); /* m_shift is in units of the old row height */
     refresh ();
 }
 
@@ -355,6 +486,7 @@ void PlaylistWidget::refresh ()
     if (m_playlist != prev_playlist)
     {
         cancel_all ();
+        stop_smooth ();
         m_first = 0;
         ensure_visible (m_playlist.get_focus ());
     }
@@ -368,7 +500,10 @@ void PlaylistWidget::refresh ()
 void PlaylistWidget::ensure_visible (int position)
 {
     if (position < m_first || position >= m_first + m_rows)
+    {
         m_first = position - m_rows / 2;
+        stop_smooth ();
+    }
 
     calc_layout ();
 }
@@ -587,11 +722,52 @@ void PlaylistWidget::row_info (int * rows, int * first)
     * first = m_first;
 }
 
+void PlaylistWidget::stop_smooth ()
+{
+    smooth_timer.stop ();
+    m_shift = 0;
+}
+
+void PlaylistWidget::smooth_timeout ()
+{
+    /* the playlist may have shrunk since the target was set */
+    int max = aud::max (0, m_length - m_rows) * m_row_height;
+    if (m_target > max)
+        m_target = max;
+
+    int pos = m_first * m_row_height + m_shift;
+    int left = m_target - pos;
+
+    /* ease out: cover a third of the remaining distance per tick, but
+     * always at least one pixel so the animation terminates */
+    int step = left / 3;
+    if (! step)
+        step = (left > 0) ? 1 : -1;
+
+    pos += step;
+
+    if (pos == m_target)
+        smooth_timer.stop ();
+
+    m_first = pos / m_row_height;
+    m_shift = pos % m_row_height;
+    refresh ();
+}
+
 void PlaylistWidget::scroll_to (int row)
 {
     cancel_all ();
-    m_first = row;
-    refresh ();
+
+    /* clamp here so the animation target is a resting position */
+    if (row + m_rows > m_length)
+        row = m_length - m_rows;
+    if (row < 0)
+        row = 0;
+
+    m_target = row * m_row_height;
+
+    if (m_target != m_first * m_row_height + m_shift)
+        smooth_timer.start ();
 }
 
 void PlaylistWidget::set_focused (int row)
@@ -36,6 +36,7 @@
 
 class PlaylistSlider;
 
+typedef SmartPtr<cairo_surface_t, cairo_surface_destroy> CairoSurfacePtr;
 typedef SmartPtr<PangoFontDescription, pango_font_description_free> PangoFontDescPtr;
 
 class PlaylistWidget : public Widget
@@ -62,9 +63,34 @@ private:
     bool motion (GdkEventMotion * event) override;
     bool leave () override;
 
+    /* everything that affects how one row is drawn; rows whose state is
+     * unchanged are blitted from the previous canvas instead of being
+     * rasterized again */
+    struct RowState
+    {
+        String title;
+        int length = -1;     /* song length, -1 if unknown */
+        int number = 0;      /* 1-based entry number, 0 if numbers are hidden */
+        int queue_pos = -1;  /* 0-based queue position, -1 if not queued */
+        bool selected = false;
+        bool active = false;
+
+        bool operator== (const RowState & b) const
+        {
+            return title == b.title && length == b.length &&
+             number == b.number && queue_pos == b.queue_pos &&
+             selected == b.selected && active == b.active;
+        }
+    };
+
     void update_title ();
     void calc_layout ();
 
+    int text_width (const char * text);
+    void draw_row (cairo_t * cr, const RowState & state, int row, int left,
+     int right, int len_right, int queue_right);
+    void update_canvas ();
+
     int calc_position (int y) const;
     int adjust_position (bool relative, int position) const;
 
@@ -78,12 +104,16 @@ private:
 
     void cancel_all ();
     void scroll_timeout ();
+    void stop_smooth ();
+    void smooth_timeout ();
     void popup_trigger (int pos);
     void popup_show ();
     void popup_hide ();
 
     const Timer<PlaylistWidget>
      scroll_timer {TimerRate::Hz10, this, & PlaylistWidget::scroll_timeout};
+    const Timer<PlaylistWidget>
+     smooth_timer {TimerRate::Hz30, this, & PlaylistWidget::smooth_timeout};
 
     PlaylistSlider * m_slider = nullptr;
     PangoFontDescPtr m_font;
@@ -93,7 +123,18 @@ private:
     int m_length = 0;
     int m_width = 0, m_height = 0, m_row_height = 1, m_offset = 0, m_rows = 0, m_first = 0;
     int m_scroll = 0, m_hover = -1, m_drag = 0, m_popup_pos = -1;
+
+    /* smooth scrolling: rows are shifted up by m_shift pixels (less than
+     * one row height), and smooth_timeout () eases toward m_target */
+    int m_shift = 0, m_target = 0;
     QueuedFunc m_popup_timer;
+
+    /* offscreen canvas holding the rendered rows; see update_canvas () */
+    CairoSurfacePtr m_canvas;
+    Index<RowState> m_row_cache;
+    String m_canvas_title;
+    int m_canvas_first = -1, m_canvas_offset = -1;
+    int m_canvas_left = -1, m_canvas_right = -1, m_canvas_queue_right = -1;
 };
 
 #endif
@@ -37,6 +37,19 @@
 
 static Index<TextBox *> textboxes;
 
+/* Cache of composited strings, shared by all textboxes.  Strings like the
+ * time readout and alternating song titles recur constantly; reusing the
+ * rendered surface makes switching back to a recent string a single blit.
+ * Kept in least-recently-used order and flushed when the skin changes. */
+struct CachedRender
+{
+    String key;
+    CairoSurfacePtr buf;
+};
+
+static constexpr int RENDER_CACHE_SIZE = 64;
+static Index<CachedRender> render_cache;
+
 void TextBox::draw (cairo_t * cr)
 {
     if (m_scrolling)
@@ -208,6 +221,48 @@ void TextBox::render_bitmap (const char * text)
     g_free (utf32);
 }
 
+void TextBox::render_text (const char * text)
+{
+    /* the rendered surface depends on the font (null for the bitmap font),
+     * the minimum width, and of course the text itself */
+    String key (str_printf ("%s\n%d\n%s", m_font_name ?
+     (const char *) m_font_name : "", m_width, text));
+
+    for (int i = 0; i < render_cache.len (); i ++)
+    {
+        CachedRender & hit = render_cache[i];
+        if (hit.key != key)
+            continue;
+
+        m_buf.capture (cairo_surface_reference (hit.buf.get ()));
+        m_buf_width = cairo_image_surface_get_width (m_buf.get ()) / config.scale;
+        resize (m_width * config.scale,
+         cairo_image_surface_get_height (m_buf.get ()));
+
+        /* move to the most-recently-used position */
+        if (i < render_cache.len () - 1)
+        {
+            CachedRender moved = std::move (hit);
+            render_cache.remove (i, 1);
+            render_cache.append (std::move (moved));
+        }
+
+        return;
+    }
+
+    if (m_font)
+        render_vector (text);
+    else
+        render_bitmap (text);
+
+    if (render_cache.len () >= RENDER_CACHE_SIZE)
+        render_cache.remove (0, 1);
+
+    CachedRender & entry = render_cache.append ();
+    entry.key = key;
+    entry.buf.capture (cairo_surface_reference (m_buf.get ()));
+}
+
 void TextBox::render ()
 {
     m_scrolling = false;
@@ -217,25 +272,15 @@ void TextBox::render ()
 
     const char * text = m_text ? m_text : "";
 
-    if (m_font)
-        render_vector (text);
-    else
-        render_bitmap (text);
+    render_text (text);
 
     if (m_may_scroll && m_buf_width > m_width)
     {
         m_scrolling = true;
 
         if (! m_two_way)
-        {
-            StringBuf temp = str_printf ("%s %s ", text,
-             config.mainwin_use_bitmapfont ? "***" : "---");
-
-            if (m_font)
-                render_vector (temp);
-            else
-                render_bitmap (temp);
-        }
+            render_text (str_printf ("%s %s ", text,
+             config.mainwin_use_bitmapfont ? "***" : "---"));
     }
 
     queue_draw ();
@@ -266,6 +311,8 @@ void TextBox::set_text (const char * text)
 
 void TextBox::set_font (const char * font)
 {
+    m_font_name = String (font);
+
     if (font)
         m_font.capture (pango_font_description_from_string (font));
     else
@@ -305,6 +352,10 @@ TextBox::TextBox (int width, const char * font, bool scroll) :
 
 void TextBox::update_all ()
 {
+    /* called when the skin changes; the cached surfaces were composited
+     * with the old skin's colors and font bitmap */
+    render_cache.clear ();
+
     for (TextBox * textbox : textboxes)
         textbox->render ();
 }
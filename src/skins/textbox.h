@@ -60,12 +60,14 @@ private:
     void scroll_timeout ();
     void render_vector (const char * text);
     void render_bitmap (const char * text);
+    void render_text (const char * text);
     void render ();
 
     const Timer<TextBox>
      scroll_timer {TimerRate::Hz30, this, & TextBox::scroll_timeout};
 
     String m_text;
+    String m_font_name;
     PangoFontDescPtr m_font;
     CairoSurfacePtr m_buf;
 
@@ -20,12 +20,27 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <sndfile.h>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#elif defined (__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #define WANT_VFS_STDIO_COMPAT
 #include <libaudcore/plugin.h>
 #include <libaudcore/i18n.h>
 #include <libaudcore/audstrings.h>
+#include <libaudcore/runtime.h>
 
 class SndfilePlugin : public InputPlugin
 {
@@ -48,6 +63,12 @@ public:
     bool is_our_file (const char * filename, VFSFile & file) override;
     bool read_tag (const char * filename, VFSFile & file, Tuple & tuple, Index<char> * image) override;
     bool play (const char * filename, VFSFile & file) override;
+
+#ifndef _WIN32
+private:
+    bool play_mapped (const char * filename, VFSFile & file,
+     SNDFILE * sndfile, const SF_INFO & sfinfo);
+#endif
 };
 
 EXPORT SndfilePlugin aud_plugin_instance;
@@ -112,6 +133,136 @@ static SF_VIRTUAL_IO sf_virtual_io_stream =
     sf_tell
 };
 
+#ifndef _WIN32
+
+/* Converts little-endian signed 16-bit PCM to float, eight samples per step
+ * where vector units are available. */
+static void pcm16_to_float (const int16_t * in, float * out, int count)
+{
+    const float scale = 1.0f / 32768;
+    int i = 0;
+
+#ifdef __SSE2__
+    __m128 vscale = _mm_set1_ps (scale);
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i v = _mm_loadu_si128 ((const __m128i *) (in + i));
+        __m128i lo = _mm_srai_epi32 (_mm_unpacklo_epi16 (v, v), 16);
+        __m128i hi = _mm_srai_epi32 (_mm_unpackhi_epi16 (v, v), 16);
+        _mm_storeu_ps (out + i, _mm_mul_ps (_mm_cvtepi32_ps (lo), vscale));
+        _mm_storeu_ps (out + i + 4, _mm_mul_ps (_mm_cvtepi32_ps (hi), vscale));
+    }
+#elif defined (__ARM_NEON)
+    float32x4_t vscale = vdupq_n_f32 (scale);
+
+    for (; i + 8 <= count; i += 8)
+    {
+        int16x8_t v = vld1q_s16 (in + i);
+        vst1q_f32 (out + i, vmulq_f32 (vcvtq_f32_s32
+         (vmovl_s16 (vget_low_s16 (v))), vscale));
+        vst1q_f32 (out + i + 4, vmulq_f32 (vcvtq_f32_s32
+         (vmovl_s16 (vget_high_s16 (v))), vscale));
+    }
+#endif
+
+    for (; i < count; i ++)
+        out[i] = in[i] * scale;
+}
+
+/* Fast path for local files with plain PCM: map the file and feed frames to
+ * the output directly from the mapping, bypassing libsndfile's read loop.
+ * Returns false (without having played anything) if the file is not
+ * eligible, in which case the caller falls back to sf_read_float(). */
+bool SndfilePlugin::play_mapped (const char * filename, VFSFile & file,
+ SNDFILE * sndfile, const SF_INFO & sfinfo)
+{
+#if defined (__BYTE_ORDER__) && (__BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__)
+    /* the samples are used in place, so the host must match the file's
+     * little-endian byte order */
+    return false;
+#else
+    int container = sfinfo.format & SF_FORMAT_TYPEMASK;
+    int encoding = sfinfo.format & SF_FORMAT_SUBMASK;
+
+    if ((container != SF_FORMAT_WAV && container != SF_FORMAT_WAVEX &&
+         container != SF_FORMAT_W64) ||
+        (encoding != SF_FORMAT_PCM_16 && encoding != SF_FORMAT_FLOAT))
+        return false;
+
+    StringBuf path = uri_to_filename (filename);
+    if (! path)
+        return false;
+
+    /* libsndfile does not expose the data chunk offset, but seeking to frame
+     * zero leaves the underlying VFS position exactly there */
+    if (sf_seek (sndfile, 0, SEEK_SET) != 0)
+        return false;
+
+    int64_t data_offset = file.ftell ();
+    int frame_size = sfinfo.channels * (encoding == SF_FORMAT_PCM_16 ? 2 : 4);
+
+    int fd = open (path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat (fd, & st) < 0 || ! S_ISREG (st.st_mode) ||
+        data_offset <= 0 || (data_offset & 1) ||
+        data_offset + (int64_t) sfinfo.frames * frame_size > st.st_size)
+    {
+        close (fd);
+        return false;
+    }
+
+    void * map = mmap (nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close (fd);
+
+    if (map == MAP_FAILED)
+        return false;
+
+    madvise (map, st.st_size, MADV_SEQUENTIAL);
+    AUDDBG ("Playing %s from a mapping (data offset %d).\n", (const char *) path,
+     (int) data_offset);
+
+    const char * data = (const char *) map + data_offset;
+    int block = sfinfo.samplerate / 50;
+    int64_t frame = 0;
+
+    Index<float> buffer;
+    buffer.resize (sfinfo.channels * block);
+
+    while (! check_stop ())
+    {
+        int seek_value = check_seek ();
+        if (seek_value != -1)
+            frame = aud::min (aud::rescale<int64_t> (seek_value, 1000,
+             sfinfo.samplerate), (int64_t) sfinfo.frames);
+
+        int frames = aud::min ((int64_t) block, sfinfo.frames - frame);
+        if (frames <= 0)
+            break;
+
+        int samples = frames * sfinfo.channels;
+
+        if (encoding == SF_FORMAT_PCM_16)
+            pcm16_to_float ((const int16_t *) (data + frame * frame_size),
+             buffer.begin (), samples);
+        else
+            memcpy (buffer.begin (), data + frame * frame_size,
+             sizeof (float) * samples);
+
+        write_audio (buffer.begin (), sizeof (float) * samples);
+        frame += frames;
+    }
+
+    munmap (map, st.st_size);
+    return true;
+#endif
+}
+
+#endif /* ! _WIN32 */
+
 static void copy_string (SNDFILE * sf, int sf_id, Tuple & tup, Tuple::Field field)
 {
     const char * str = sf_get_string (sf, sf_id);
@@ -325,6 +476,14 @@ bool SndfilePlugin::play (const char * filename, VFSFile & file)
 
     open_audio (FMT_FLOAT, sfinfo.samplerate, sfinfo.channels);
 
+#ifndef _WIN32
+    if (! stream && play_mapped (filename, file, sndfile, sfinfo))
+    {
+        sf_close (sndfile);
+        return true;
+    }
+#endif
+
     Index<float> buffer;
     buffer.resize (sfinfo.channels * (sfinfo.samplerate / 50));
 
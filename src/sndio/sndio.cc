@@ -68,8 +68,11 @@ public:
     void pause (bool pause) override {}
 
 private:
+    bool open_sync (int format, int rate, int channels, String & error);
+    void open_settle ();
     bool poll_locked ();
 
+    static void * open_worker (void * arg);
     static void volume_cb (void *, unsigned int vol);
     static void move_cb (void * arg, int delta);
 
@@ -88,6 +91,21 @@ private:
 
 EXPORT SndioPlugin aud_plugin_instance;
 
+/* sio_open() can stall for hundreds of milliseconds on some hardware, so the
+ * device is opened on a worker thread while the decoder prebuffers into
+ * s_prebuffer; the buffered audio is pushed out once the handle is live. */
+enum {OPEN_IDLE, OPEN_PENDING, OPEN_LIVE, OPEN_FAILED};
+
+static int s_open_state = OPEN_IDLE;
+static Index<char> s_prebuffer;
+static int s_prebuffer_limit;
+
+struct OpenRequest
+{
+    SndioPlugin * plugin;
+    int format, rate, channels;
+};
+
 const char * const SndioPlugin::defaults[] = {
     "save_volume", "FALSE",
     "volume", "100",
@@ -182,6 +200,56 @@ bool SndioPlugin::open_audio (int format, int rate, int channels, String & error
         return false;
     }
 
+    m_rate = rate;
+    m_channels = channels;
+    m_bytes_per_frame = FMT_SIZEOF (format) * channels;
+
+    m_frames_buffered = 0;
+    m_last_write_time = timeval ();
+    m_flush_count = 0;
+
+    s_prebuffer.clear ();
+    s_prebuffer_limit = m_bytes_per_frame *
+     aud::rescale (aud_get_int ("output_buffer_size"), 1000, rate);
+    s_open_state = OPEN_PENDING;
+
+    pthread_t thread;
+    pthread_create (& thread, nullptr, open_worker,
+     new OpenRequest {this, format, rate, channels});
+    pthread_detach (thread);
+
+    return true;
+}
+
+void * SndioPlugin::open_worker (void * arg)
+{
+    auto req = (OpenRequest *) arg;
+    auto me = req->plugin;
+    String error;
+
+    bool ok = me->open_sync (req->format, req->rate, req->channels, error);
+    if (! ok)
+        AUDERR ("%s\n", (const char *) error);
+
+    pthread_mutex_lock (& me->m_mutex);
+    s_open_state = ok ? OPEN_LIVE : OPEN_FAILED;
+    pthread_cond_broadcast (& me->m_cond);
+    pthread_mutex_unlock (& me->m_mutex);
+
+    delete req;
+    return nullptr;
+}
+
+bool SndioPlugin::open_sync (int format, int rate, int channels, String & error)
+{
+    const FormatData * fdata = nullptr;
+
+    for (const FormatData & f : format_table)
+    {
+        if (f.format == format)
+            fdata = & f;
+    }
+
     String device = aud_get_str ("sndio", "device");
     const char * device2 = device[0] ? (const char *) device : SIO_DEVANY;
 
@@ -193,14 +261,6 @@ bool SndioPlugin::open_audio (int format, int rate, int channels, String & error
         return false;
     }
 
-    m_rate = rate;
-    m_channels = channels;
-    m_bytes_per_frame = FMT_SIZEOF (format) * channels;
-
-    m_frames_buffered = 0;
-    m_last_write_time = timeval ();
-    m_flush_count = 0;
-
     int buffer_ms = aud_get_int ("output_buffer_size");
 
     sio_par par;
@@ -242,10 +302,28 @@ fail:
     return false;
 }
 
+/* waits for the open worker to finish, successfully or not */
+void SndioPlugin::open_settle ()
+{
+    pthread_mutex_lock (& m_mutex);
+
+    while (s_open_state == OPEN_PENDING)
+        pthread_cond_wait (& m_cond, & m_mutex);
+
+    pthread_mutex_unlock (& m_mutex);
+}
+
 void SndioPlugin::close_audio ()
 {
-    sio_close (m_handle);
+    open_settle ();
+
+    s_prebuffer.clear ();
+
+    if (m_handle)
+        sio_close (m_handle);
+
     m_handle = nullptr;
+    s_open_state = OPEN_IDLE;
 }
 
 bool SndioPlugin::poll_locked ()
@@ -287,8 +365,13 @@ void SndioPlugin::period_wait ()
 {
     pthread_mutex_lock (& m_mutex);
 
-    if (sio_eof (m_handle) || ! poll_locked ())
+    if (s_open_state == OPEN_PENDING)
         pthread_cond_wait (& m_cond, & m_mutex);
+    else if (s_open_state == OPEN_LIVE)
+    {
+        if (sio_eof (m_handle) || ! poll_locked ())
+            pthread_cond_wait (& m_cond, & m_mutex);
+    }
 
     pthread_mutex_unlock (& m_mutex);
 }
@@ -297,6 +380,44 @@ int SndioPlugin::write_audio (const void * data, int size)
 {
     pthread_mutex_lock (& m_mutex);
 
+    if (s_open_state == OPEN_PENDING)
+    {
+        size = aud::min (size, s_prebuffer_limit - s_prebuffer.len ());
+        s_prebuffer.insert ((const char *) data, -1, size);
+        pthread_mutex_unlock (& m_mutex);
+        return size;
+    }
+
+    if (s_open_state == OPEN_FAILED)
+    {
+        /* no device to play to; swallow the audio, but at real-time pace, so
+         * a dead device behaves like muted playback instead of racing through
+         * the playlist */
+        pthread_mutex_unlock (& m_mutex);
+
+        int64_t ns = (int64_t) (size / m_bytes_per_frame) * 1000000000 / m_rate;
+        timespec delay = {(time_t) (ns / 1000000000), (long) (ns % 1000000000)};
+        nanosleep (& delay, nullptr);
+
+        return size;
+    }
+
+    if (s_prebuffer.len ())
+    {
+        /* audio buffered while the device was opening goes out first */
+        int written = sio_write (m_handle, s_prebuffer.begin (), s_prebuffer.len ());
+        m_frames_buffered += written / m_bytes_per_frame;
+
+        if (written > 0)
+            s_prebuffer.remove (0, written);
+
+        if (s_prebuffer.len ())
+        {
+            pthread_mutex_unlock (& m_mutex);
+            return 0;
+        }
+    }
+
     int len = sio_write (m_handle, data, size);
     m_frames_buffered += len / m_bytes_per_frame;
 
@@ -306,8 +427,21 @@ int SndioPlugin::write_audio (const void * data, int size)
 
 void SndioPlugin::drain ()
 {
+    open_settle ();
+
     pthread_mutex_lock (& m_mutex);
 
+    while (s_open_state == OPEN_LIVE && s_prebuffer.len ())
+    {
+        int written = sio_write (m_handle, s_prebuffer.begin (), s_prebuffer.len ());
+        m_frames_buffered += written / m_bytes_per_frame;
+
+        if (written > 0)
+            s_prebuffer.remove (0, written);
+        else if (! poll_locked ())
+            break;
+    }
+
     int d = aud::rescale (m_frames_buffered, m_rate, 1000);
     timespec delay = {d / 1000, d % 1000 * 1000000};
 
@@ -315,7 +449,8 @@ void SndioPlugin::drain ()
     nanosleep (& delay, nullptr);
     pthread_mutex_lock (& m_mutex);
 
-    poll_locked ();
+    if (s_open_state == OPEN_LIVE)
+        poll_locked ();
 
     pthread_mutex_unlock (& m_mutex);
 }
@@ -327,7 +462,8 @@ int SndioPlugin::get_delay ()
 
     pthread_mutex_lock (& m_mutex);
 
-    int delay = aud::rescale (m_frames_buffered, m_rate, 1000);
+    int delay = aud::rescale (m_frames_buffered +
+     s_prebuffer.len () / m_bytes_per_frame, m_rate, 1000);
 
     if (m_last_write_time.tv_sec)
     {
@@ -344,6 +480,19 @@ void SndioPlugin::flush ()
 {
     pthread_mutex_lock (& m_mutex);
 
+    s_prebuffer.clear ();
+
+    if (s_open_state != OPEN_LIVE)
+    {
+        m_frames_buffered = 0;
+        m_last_write_time = timeval ();
+        m_flush_count ++;
+
+        pthread_cond_broadcast (& m_cond);
+        pthread_mutex_unlock (& m_mutex);
+        return;
+    }
+
 #if HAVE_SNDIO_1_9
     sio_flush (m_handle);
 #else
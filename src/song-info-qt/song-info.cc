@@ -20,6 +20,7 @@
 #include <libaudcore/drct.h>
 #include <libaudcore/hook.h>
 #include <libaudcore/i18n.h>
+#include <libaudcore/mainloop.h>
 #include <libaudcore/plugin.h>
 
 #include <libaudqt/info-widget.h>
@@ -45,9 +46,15 @@ public:
 
 private:
     const HookReceiver<SongInfoWidget>
-        change_hook{"tuple change", this, &SongInfoWidget::update},
-        update_hook{"playback ready", this, &SongInfoWidget::update},
-        clear_hook{"playback stop", this, &SongInfoWidget::update};
+        change_hook{"tuple change", this, &SongInfoWidget::queue_update},
+        update_hook{"playback ready", this, &SongInfoWidget::queue_update},
+        clear_hook{"playback stop", this, &SongInfoWidget::queue_update};
+
+    QueuedFunc m_update_func;
+
+    /* tuple changes arrive in bursts while a stream is probed; rebuilding
+     * the info model once per main-loop pass is enough */
+    void queue_update() { m_update_func.queue([this]() { update(); }); }
 
     void update()
     {
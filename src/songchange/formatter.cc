@@ -24,6 +24,9 @@
 
 #include <assert.h>
 #include <string.h>
+
+#include <libaudcore/audstrings.h>
+
 #include "formatter.h"
 
 StringBuf Formatter::format (const char * format) const
@@ -79,3 +82,56 @@ StringBuf Formatter::format (const char * format) const
 
     return buffer;
 }
+
+void Template::compile (const char * format)
+{
+    m_segments.clear ();
+
+    if (! format || ! format[0])
+        return;
+
+    const char * p = format;
+    while (* p)
+    {
+        const char * start = p;
+        while (* p && * p != '%')
+            p ++;
+
+        Segment & seg = m_segments.append ();
+        if (p > start)
+            seg.literal = String (str_copy (start, p - start));
+
+        if (* p == '%')
+        {
+            p ++;
+            /* a trailing '%' expands to itself, as in format() */
+            seg.code = * p ? * p ++ : '%';
+        }
+    }
+}
+
+StringBuf Template::expand (const Formatter & values) const
+{
+    StringBuf buffer (0);
+
+    for (const Segment & seg : m_segments)
+    {
+        if (seg.literal)
+            buffer.insert (-1, seg.literal);
+
+        if (! seg.code)
+            continue;
+
+        const char * value = values.get (seg.code);
+        if (value)
+            buffer.insert (-1, value);
+        else
+        {
+            /* unknown codes pass through untouched, as in format() */
+            buffer.insert (-1, "%", 1);
+            buffer.insert (-1, (const char *) & seg.code, 1);
+        }
+    }
+
+    return buffer;
+}
@@ -1,6 +1,7 @@
 #ifndef FORMATTER_H
 #define FORMATTER_H
 
+#include <libaudcore/index.h>
 #include <libaudcore/objects.h>
 
 struct Formatter
@@ -11,10 +12,35 @@ struct Formatter
     void set (unsigned char id, const char * value)
         { values[id] = String (value); }
 
+    const char * get (unsigned char id) const
+        { return values[id]; }
+
     StringBuf format (const char * format) const;
 
 private:
     String values[256];
 };
 
+/* A command template parsed once into literal runs and format codes,
+ * so that expanding it per event is a plain concatenation instead of a
+ * rescan for '%' specifiers. */
+class Template
+{
+public:
+    void compile (const char * format);
+
+    explicit operator bool () const
+        { return m_segments.len () > 0; }
+
+    StringBuf expand (const Formatter & values) const;
+
+private:
+    struct Segment {
+        String literal;         /* verbatim text preceding the code */
+        unsigned char code = 0; /* format code, or 0 for a plain literal */
+    };
+
+    Index<Segment> m_segments;
+};
+
 #endif
@@ -46,6 +46,14 @@ static String cmd_line_stop;
 static String cmd_line_after;
 static String cmd_line_end;
 static String cmd_line_ttc;
+static String cmd_pipe;
+
+/* command templates precompiled at config time */
+static Template tmpl_line;
+static Template tmpl_stop;
+static Template tmpl_after;
+static Template tmpl_end;
+static Template tmpl_ttc;
 
 /**
  * Escapes characters that are special to the shell inside double quotes.
@@ -97,11 +105,11 @@ static StringBuf escape_shell_chars (const char * string)
  *   b - album
  *   r - track title
  */
-/* do_command(): do @cmd after replacing the format codes
-   @cmd: command to run */
-static void do_command (const char * cmd)
+/* do_command(): do @tmpl after replacing the format codes
+   @tmpl: precompiled command template to run */
+static void do_command (const Template & tmpl)
 {
-    if (cmd && strlen (cmd) > 0)
+    if (tmpl)
     {
         Formatter formatter;
         bool playing = aud_drct_get_ready ();
@@ -172,35 +180,58 @@ static void do_command (const char * cmd)
         else
             formatter.set ('T', "");
 
-        StringBuf shstring = formatter.format (cmd);
-        if (shstring)
-            execute_command (shstring);
+        StringBuf shstring = tmpl.expand (formatter);
+        if (! shstring)
+            return;
+
+        /* persistent handler: one formatted line per event over a pipe,
+         * spawning the handler on the first event (or after it died);
+         * fall back to fork/exec if the pipe cannot be served */
+        if (cmd_pipe && cmd_pipe[0])
+        {
+            if (! pipe_handler_is_open ())
+                pipe_handler_open (cmd_pipe);
+
+            if (pipe_handler_write (str_concat ({shstring, "\n"})))
+                return;
+        }
+
+        execute_command (shstring);
     }
 }
 
 static void songchange_playback_begin (void *, void *)
 {
-    do_command (cmd_line);
+    do_command (tmpl_line);
 }
 
 static void songchange_playback_stop (void *, void *)
 {
-    do_command (cmd_line_stop);
+    do_command (tmpl_stop);
 }
 
 static void songchange_playback_end (void *, void *)
 {
-    do_command (cmd_line_after);
+    do_command (tmpl_after);
 }
 
 static void songchange_playback_ttc (void *, void *)
 {
-    do_command (cmd_line_ttc);
+    do_command (tmpl_ttc);
 }
 
 static void songchange_playlist_eof (void *, void *)
 {
-    do_command (cmd_line_end);
+    do_command (tmpl_end);
+}
+
+static void compile_templates ()
+{
+    tmpl_line.compile (cmd_line);
+    tmpl_stop.compile (cmd_line_stop);
+    tmpl_after.compile (cmd_line_after);
+    tmpl_end.compile (cmd_line_end);
+    tmpl_ttc.compile (cmd_line_ttc);
 }
 
 static void read_config ()
@@ -210,6 +241,9 @@ static void read_config ()
     cmd_line_after = aud_get_str ("song_change", "cmd_line_after");
     cmd_line_end = aud_get_str ("song_change", "cmd_line_end");
     cmd_line_ttc = aud_get_str ("song_change", "cmd_line_ttc");
+    cmd_pipe = aud_get_str ("song_change", "cmd_pipe");
+
+    compile_templates ();
 }
 
 bool SongChange::init ()
@@ -238,6 +272,10 @@ void SongChange::cleanup ()
     cmd_line_after = String ();
     cmd_line_end = String ();
     cmd_line_ttc = String ();
+    cmd_pipe = String ();
+
+    compile_templates ();
+    pipe_handler_close ();
 
     signal_child ();
 }
@@ -248,6 +286,7 @@ typedef struct {
     String cmd_after;
     String cmd_end;
     String cmd_ttc;
+    String cmd_pipe;
 } SongChangeConfig;
 
 static SongChangeConfig config;
@@ -270,6 +309,12 @@ const PreferencesWidget SongChange::widgets[] = {
     WidgetLabel (N_("Command to run when song title changes (for network streams):")),
     WidgetEntry (0, WidgetString (config.cmd_ttc)),
 
+    WidgetLabel (N_("Persistent event handler (optional):")),
+    WidgetEntry (0, WidgetString (config.cmd_pipe)),
+    WidgetLabel (N_("If set, this handler is started once and each formatted "
+                    "command above is written to its standard input as one "
+                    "line per event, instead of being run through the shell.")),
+
     WidgetLabel (N_("You can use the following format codes, which will be "
                     "replaced before running the command.\nNot all are useful "
                     "though for the song-stopped or end-of-playlist command.")),
@@ -296,6 +341,7 @@ static void configure_init ()
     config.cmd_after = cmd_line_after;
     config.cmd_end = cmd_line_end;
     config.cmd_ttc = cmd_line_ttc;
+    config.cmd_pipe = cmd_pipe;
 }
 
 static void configure_ok_cb ()
@@ -305,12 +351,19 @@ static void configure_ok_cb ()
     aud_set_str ("song_change", "cmd_line_after", config.cmd_after);
     aud_set_str ("song_change", "cmd_line_end", config.cmd_end);
     aud_set_str ("song_change", "cmd_line_ttc", config.cmd_ttc);
+    aud_set_str ("song_change", "cmd_pipe", config.cmd_pipe);
 
     cmd_line = config.cmd;
     cmd_line_stop = config.cmd_stop;
     cmd_line_after = config.cmd_after;
     cmd_line_end = config.cmd_end;
     cmd_line_ttc = config.cmd_ttc;
+    cmd_pipe = config.cmd_pipe;
+
+    compile_templates ();
+
+    /* restart the handler lazily with the new command */
+    pipe_handler_close ();
 }
 
 static void configure_cleanup ()
@@ -320,6 +373,7 @@ static void configure_cleanup ()
     config.cmd_after = String ();
     config.cmd_end = String ();
     config.cmd_ttc = String ();
+    config.cmd_pipe = String ();
 }
 
 const PluginPreferences SongChange::prefs = {
@@ -40,6 +40,12 @@ static void signal_child() {
    // signal (SIGCHLD, SIG_DFL);
 }
 
+/* the persistent pipe handler relies on fork(); not available here */
+static bool pipe_handler_is_open() { return false; }
+static bool pipe_handler_open(const char *cmd) { return false; }
+static bool pipe_handler_write(const char *line) { return false; }
+static void pipe_handler_close() {}
+
 static void execute_command(const char *cmd) {
     auto *windows_cmd = reinterpret_cast<wchar_t *>(g_utf8_to_utf16(cmd, -1, nullptr, nullptr, nullptr));
     g_return_if_fail (windows_cmd);
@@ -61,7 +67,9 @@ static void execute_command(const char *cmd) {
 
 
 #else
+#include <errno.h>
 #include <signal.h>
+#include <string.h>
 #include <unistd.h>
 #include <sys/wait.h>
 
@@ -88,6 +96,86 @@ static void execute_command (const char * cmd)
         execv (argv[0], (char * *) argv);
     }
 }
+
+/* Persistent event handler: spawned once with a pipe on its standard
+ * input, it receives one formatted line per event, avoiding a
+ * fork/exec of a fresh shell for every track change. */
+
+static int pipe_handler_fd = -1;
+
+static bool pipe_handler_is_open ()
+{
+    return pipe_handler_fd >= 0;
+}
+
+static bool pipe_handler_open (const char * cmd)
+{
+    int fds[2];
+    if (pipe (fds) < 0)
+        return false;
+
+    signal (SIGCHLD, bury_child);
+    signal (SIGPIPE, SIG_IGN); /* a dead handler must not kill us */
+
+    pid_t pid = fork ();
+    if (pid == 0)
+    {
+        dup2 (fds[0], 0);
+        /* We don't want this process to hog the audio device etc */
+        for (int i = 3; i < 255; i ++)
+            close (i);
+        const char * argv[4] = {"/bin/sh", "-c", cmd, nullptr};
+        execv (argv[0], (char * *) argv);
+        _exit (127);
+    }
+
+    close (fds[0]);
+
+    if (pid < 0)
+    {
+        close (fds[1]);
+        return false;
+    }
+
+    pipe_handler_fd = fds[1];
+    return true;
+}
+
+static void pipe_handler_close ()
+{
+    if (pipe_handler_fd < 0)
+        return;
+
+    /* the handler sees end-of-file on its standard input and exits */
+    close (pipe_handler_fd);
+    pipe_handler_fd = -1;
+}
+
+static bool pipe_handler_write (const char * line)
+{
+    if (pipe_handler_fd < 0)
+        return false;
+
+    size_t left = strlen (line);
+    while (left > 0)
+    {
+        ssize_t written = write (pipe_handler_fd, line, left);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            /* handler is gone; close so the next event can respawn it */
+            pipe_handler_close ();
+            return false;
+        }
+
+        line += written;
+        left -= written;
+    }
+
+    return true;
+}
 #endif
 
 #endif //AUDACIOUS1_SONGCHANGE_CROSSPLATFORM_H
@@ -68,12 +68,14 @@ const char * const SoXResampler::defaults[] = {
     "allow_aliasing", "FALSE",
 #endif
     "use_steep_filter", "FALSE",
+    "threads", "1",
     nullptr
 };
 
 static soxr_t soxr;
 static soxr_error_t error;
 static soxr_quality_spec_t q;
+static soxr_runtime_spec_t r;
 static int stored_rate;
 static int target_rate;
 static int stored_channels;
@@ -115,7 +117,11 @@ void SoXResampler::start (int & channels, int & rate)
 
     q = soxr_quality_spec (recipe, 0);
 
-    soxr = soxr_create (rate, target_rate, channels, & error, nullptr, & q, nullptr);
+    /* 1 = single-threaded (the old behavior), 0 = one worker per core; the
+     * spec is ignored by libsoxr builds without threading support */
+    r = soxr_runtime_spec (aud::max (0, aud_get_int ("soxr", "threads")));
+
+    soxr = soxr_create (rate, target_rate, channels, & error, nullptr, & q, & r);
 
     if (error)
     {
@@ -157,7 +163,7 @@ bool SoXResampler::flush (bool force)
 
     soxr_delete (soxr);
 
-    soxr = soxr_create (stored_rate, target_rate, stored_channels, & error, nullptr, & q, nullptr);
+    soxr = soxr_create (stored_rate, target_rate, stored_channels, & error, nullptr, & q, & r);
 
     if (error)
     {
@@ -200,6 +206,9 @@ const PreferencesWidget SoXResampler::widgets[] = {
     WidgetCheck (N_("Allow aliasing"), WidgetBool ("soxr", "allow_aliasing")),
 #endif
     WidgetCheck (N_("Use steep filter"), WidgetBool ("soxr", "use_steep_filter")),
+    WidgetSpin (N_("Worker threads (0 = one per core):"),
+        WidgetInt ("soxr", "threads"),
+        {0, 16, 1}),
     WidgetSpin (N_("Rate:"),
         WidgetInt ("soxr", "rate"),
         {MIN_RATE, MAX_RATE, RATE_STEP, N_("Hz")})
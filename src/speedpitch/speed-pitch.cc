@@ -20,6 +20,12 @@
 #include <math.h>
 #include <samplerate.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#elif defined (__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #include <libaudcore/hook.h>
 #include <libaudcore/i18n.h>
 #include <libaudcore/runtime.h>
@@ -30,7 +36,11 @@
  * into pieces, spaced at a time interval A, using a cosine-shaped window
  * function.  The pieces are then reassembled by adding them together again,
  * spaced at another time interval B.  By varying the ratio A:B, we change the
- * speed of the audio. */
+ * speed of the audio.
+ *
+ * Optionally, each piece is not copied from exactly the nominal position but
+ * from the most similar-sounding position within a few milliseconds of it
+ * (WSOLA), which removes most of the phasing artifacts of a fixed grid. */
 
 #define FREQ    10
 #define OVERLAP  3
@@ -84,6 +94,83 @@ static int outstep, width;
 static Index<float> cosine;
 static Index<float> in, out;
 static int src, dst;
+static int search_range;
+
+/* dot product over a run of samples, four lanes per step where available */
+static float dot_block (const float * a, const float * b, int count)
+{
+    float sum = 0;
+    int i = 0;
+
+#ifdef __SSE2__
+    __m128 vsum = _mm_setzero_ps ();
+
+    for (; i + 4 <= count; i += 4)
+        vsum = _mm_add_ps (vsum, _mm_mul_ps (_mm_loadu_ps (a + i), _mm_loadu_ps (b + i)));
+
+    float part[4];
+    _mm_storeu_ps (part, vsum);
+    sum = (part[0] + part[1]) + (part[2] + part[3]);
+#elif defined (__ARM_NEON)
+    float32x4_t vsum = vdupq_n_f32 (0);
+
+    for (; i + 4 <= count; i += 4)
+        vsum = vmlaq_f32 (vsum, vld1q_f32 (a + i), vld1q_f32 (b + i));
+
+    sum = (vgetq_lane_f32 (vsum, 0) + vgetq_lane_f32 (vsum, 1)) +
+          (vgetq_lane_f32 (vsum, 2) + vgetq_lane_f32 (vsum, 3));
+#endif
+
+    for (; i < count; i ++)
+        sum += a[i] * b[i];
+
+    return sum;
+}
+
+/* finds the offset (in samples, a whole number of frames) within the search
+ * range whose input segment best matches what is already in the output,
+ * by normalized cross-correlation; coarse scan first, then a refining pass */
+static int best_shift (int src_at, int dst_at)
+{
+    /* near the end of input, shrink the range so candidates stay in bounds;
+     * keep it a whole number of frames so channels stay aligned */
+    int range = aud::min (search_range, in.len () - src_at);
+    range -= range % curchans;
+    int corr_len = aud::min (width / 2, aud::min (dst_at, src_at - range));
+
+    if (range <= 0 || corr_len < curchans)
+        return 0;
+
+    const float * target = & out[dst_at - corr_len];
+    float best = -1;
+    int best_s = 0;
+
+    int step = 4 * curchans;
+
+    for (int pass = 0; pass < 2; pass ++)
+    {
+        int lo = (pass == 0) ? -range : aud::max (-range, best_s - 3 * curchans);
+        int hi = (pass == 0) ? range : aud::min (range, best_s + 3 * curchans);
+
+        for (int s = lo; s <= hi; s += step)
+        {
+            const float * cand = & in[src_at + s - corr_len];
+            float corr = dot_block (target, cand, corr_len);
+            float energy = dot_block (cand, cand, corr_len);
+            float score = corr / sqrtf (energy + 1e-9f);
+
+            if (score > best)
+            {
+                best = score;
+                best_s = s;
+            }
+        }
+
+        step = curchans;
+    }
+
+    return best_s;
+}
 
 static void add_data (Index<float> & b, Index<float> & data, float ratio)
 {
@@ -144,6 +231,10 @@ void SpeedPitch::start (int & chans, int & rate)
     for (int i = 0; i < width; i ++)
         cosine[i] = (1.0 - cos (2.0 * M_PI * i / width)) / OVERLAP;
 
+    /* WSOLA looks up to 5 ms either side of the nominal copy position */
+    search_range = aud_get_bool (CFGSECT, "wsola") ?
+     ((currate / 200) & ~1) * curchans : 0;
+
     flush (true);
 }
 
@@ -171,12 +262,20 @@ Index<float> & SpeedPitch::process (Index<float> & data, bool ending)
 
     while (src <= stop)
     {
+        /* Copy from the most similar-sounding position near the nominal one;
+         * the deviation is local to this window and does not accumulate.
+         * When input and output grids coincide, the nominal position is
+         * already correct. */
+        int srcw = src;
+        if (instep != outstep)
+            srcw += best_shift (src, dst);
+
         /* Truncate the window to avoid overflows if necessary. */
-        int begin = aud::max (-(width / 2), aud::max (-src, -dst));
-        int end = aud::min (width / 2, aud::min (in.len () - src, out.len () - dst));
+        int begin = aud::max (-(width / 2), aud::max (-srcw, -dst));
+        int end = aud::min (width / 2, aud::min (in.len () - srcw, out.len () - dst));
 
         for (int i = begin; i < end; i ++)
-            out[dst + i] += in[src + i] * cosine_center[i];
+            out[dst + i] += in[srcw + i] * cosine_center[i];
 
         src += instep;
         dst += outstep;
@@ -241,6 +340,7 @@ const char * const SpeedPitch::defaults[] = {
  "decouple", "TRUE",
  "speed", "1",
  "pitch", "1",
+ "wsola", "TRUE",
  nullptr};
 
 const PreferencesWidget SpeedPitch::widgets[] = {
@@ -251,6 +351,9 @@ const PreferencesWidget SpeedPitch::widgets[] = {
         WidgetFloat (CFGSECT, "speed", nullptr, "speed-pitch set speed"),
         {MINSPEED, MAXSPEED, 0.05},
         WIDGET_CHILD),
+    WidgetCheck (N_("Align pieces by waveform similarity"),
+        WidgetBool (CFGSECT, "wsola"),
+        WIDGET_CHILD),
     WidgetLabel (N_("<b>Pitch</b>")),
     WidgetSpin (nullptr,
         WidgetFloat (semitones, semitones_changed, "speed-pitch set semitones"),
@@ -55,7 +55,7 @@ public:
     void cleanup () override;
 
 private:
-    static void update_tooltip (void * data, void * user_data);
+    static void invalidate_tooltip (void * data, void * user_data);
     static void window_closed (void * data, void * user_data);
     static void activate (QSystemTrayIcon::ActivationReason);
     static void open_files ();
@@ -130,6 +130,11 @@ const audqt::MenuItem StatusIcon::items[] =
     audqt::MenuCommand ({N_("_Quit"), "application-exit"}, aud_quit),
 };
 
+/* The tooltip is rebuilt only when the icon is actually hovered; track
+ * changes merely mark it stale instead of pushing a new string to the
+ * tray host for every song. */
+static bool tooltip_stale = true;
+
 class SystemTrayIcon : public QSystemTrayIcon
 {
 public:
@@ -181,6 +186,11 @@ bool SystemTrayIcon::event (QEvent * e)
             setToolTip (QString ()); /* prevent double tooltip */
             audqt::infopopup_show_current ();
         }
+        else if (tooltip_stale)
+        {
+            setToolTip (QString (aud_drct_get_title ()));
+            tooltip_stale = false;
+        }
         return true;
 
     case QEvent::Wheel:
@@ -207,11 +217,11 @@ bool StatusIcon::init ()
     tray->setContextMenu (menu);
     tray->show ();
 
-    update_tooltip (nullptr, nullptr);
+    invalidate_tooltip (nullptr, nullptr);
 
-    hook_associate ("title change", update_tooltip, nullptr);
-    hook_associate ("playback ready", update_tooltip, nullptr);
-    hook_associate ("playback stop", update_tooltip, nullptr);
+    hook_associate ("title change", invalidate_tooltip, nullptr);
+    hook_associate ("playback ready", invalidate_tooltip, nullptr);
+    hook_associate ("playback stop", invalidate_tooltip, nullptr);
     hook_associate ("window close", window_closed, nullptr);
 
     return true;
@@ -219,9 +229,9 @@ bool StatusIcon::init ()
 
 void StatusIcon::cleanup ()
 {
-    hook_dissociate ("title change", update_tooltip);
-    hook_dissociate ("playback ready", update_tooltip);
-    hook_dissociate ("playback stop", update_tooltip);
+    hook_dissociate ("title change", invalidate_tooltip);
+    hook_dissociate ("playback ready", invalidate_tooltip);
+    hook_dissociate ("playback stop", invalidate_tooltip);
     hook_dissociate ("window close", window_closed);
 
     /* Prevent accidentally hiding the interface by disabling
@@ -238,10 +248,9 @@ void StatusIcon::cleanup ()
     audqt::cleanup ();
 }
 
-void StatusIcon::update_tooltip (void * data, void * user_data)
+void StatusIcon::invalidate_tooltip (void * data, void * user_data)
 {
-    String title = aud_drct_get_title ();
-    tray->setToolTip (QString (title));
+    tooltip_stale = true;
 }
 
 void StatusIcon::window_closed (void * data, void * user_data)
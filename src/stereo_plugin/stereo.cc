@@ -66,18 +66,24 @@ Index<float> & ExtraStereo::process(Index<float> & data)
 {
     float value = aud_get_double ("extra_stereo", "intensity");
     float * f, * end;
-    float center;
 
-    if (stereo_channels != 2)
+    /* intensity 1 is the identity matrix (a = 1, b = 0); enabled-but-
+     * neutral costs nothing */
+    if (stereo_channels != 2 || value == 1)
         return data;
 
+    /* algebraically the same as mixing toward/away from the center, folded
+     * into a 2x2 matrix so each sample is a single multiply-add */
+    float a = (1 + value) / 2;
+    float b = (1 - value) / 2;
+
     end = data.end ();
 
     for (f = data.begin (); f < end; f += 2)
     {
-        center = (f[0] + f[1]) / 2;
-        f[0] = center + (f[0] - center) * value;
-        f[1] = center + (f[1] - center) * value;
+        float left = f[0], right = f[1];
+        f[0] = a * left + b * right;
+        f[1] = b * left + a * right;
     }
 
     return data;
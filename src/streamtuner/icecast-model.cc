@@ -8,15 +8,40 @@
 // implied.  In no event shall the authors be liable for any damages arising
 // from the use of this software.
 
+#include <memory>
+#include <utility>
+
 #include <QXmlStreamReader>
 
+#include <libaudcore/vfs.h>
+
 #include "icecast-model.h"
+#include "../fetch-common/fetch.h"
 
 static const char *ICECAST_YP = "http://dir.xiph.org/yp.xml";
 
+// stations delivered to the model per batch; the full YP document is tens
+// of megabytes, so it is parsed on a worker thread and rows are shown as
+// they arrive
+static const int PARSE_BATCH = 500;
+
+static String icecast_cache_path ()
+{
+    return String (str_concat ({aud_get_path (AudPath::UserDir), "/streamtuner-icecast.xml"}));
+}
+
 IcecastTunerModel::IcecastTunerModel (QObject * parent) :
     QAbstractListModel (parent)
 {
+    // show the directory as cached by the last fetch right away; the
+    // fresh copy replaces it once it has been downloaded
+    VFSFile cache (icecast_cache_path (), "r");
+    if (cache) {
+        auto data = cache.read_all ();
+        if (data.len ())
+            start_parse (QByteArray (data.begin (), data.len ()));
+    }
+
     fetch_stations ();
 }
 
@@ -27,72 +52,116 @@ IcecastTunerModel::~IcecastTunerModel ()
 
 void IcecastTunerModel::fetch_stations ()
 {
-    vfs_async_file_get_contents(ICECAST_YP, [&] (const char *, const Index<char> & buf) {
+    fetch_async(ICECAST_YP, [&] (const char *, const Index<char> & buf) {
         if (! buf.len ())
             return;
 
+        AUDINFO("icecast: got results from YP server\n");
+
+        // refresh the on-disk cache so the next open is instant
+        VFSFile cache (icecast_cache_path (), "w");
+        if (cache)
+            cache.fwrite (buf.begin (), 1, buf.len ());
+
+        start_parse (QByteArray (buf.begin (), buf.len ()));
+    });
+}
+
+void IcecastTunerModel::start_parse (QByteArray && data)
+{
+    if (m_results.len ()) {
         beginResetModel ();
+        m_results.clear ();
+        endResetModel ();
+    }
 
-        AUDINFO("icecast: got results from YP server\n");
+    m_worker.start (std::move (data), [this] (ParseWorker & worker,
+     const QByteArray & data) { parse_all (worker, data); });
+}
 
-        // oh, this is going to be fun... parse the XML as fast as possible
-        QXmlStreamReader reader (QByteArray (buf.begin (), buf.len ()));
-        IcecastEntry entry;
-
-        // lets prefab some atoms for fast comparisons
-        QString entry_atom = QString ("entry");
-        QString server_name_atom = QString ("server_name");
-        QString listen_url_atom = QString ("listen_url");
-        QString server_type_atom = QString ("server_type");
-        QString bitrate_atom = QString ("bitrate");
-        QString genre_atom = QString ("genre");
-        QString current_song_atom = QString ("current_song");
-        QString mp3_atom = QString ("audio/mpeg");
-        QString aac_atom = QString ("audio/aacp");
-        QString vorbis_atom = QString ("application/ogg");
-
-        while (! reader.atEnd ()) {
-            auto token_type = reader.readNext ();
-
-            switch (token_type) {
-            case QXmlStreamReader::StartElement:
-                if (! reader.name ().compare (server_name_atom))
-                    entry.title = reader.readElementText ();
-                else if (! reader.name ().compare (listen_url_atom))
-                    entry.stream_uri = reader.readElementText ();
-                else if (! reader.name ().compare (current_song_atom))
-                    entry.current_song = reader.readElementText ();
-                else if (! reader.name ().compare (genre_atom))
-                    entry.genre = reader.readElementText ();
-                else if (! reader.name ().compare (server_type_atom))
-                {
-                    auto server_type = reader.readElementText ();
-
-                    if (! server_type.compare (mp3_atom))
-                        entry.type = IcecastEntry::MP3;
-                    else if (! server_type.compare (aac_atom))
-                        entry.type = IcecastEntry::AAC;
-                    else if (! server_type.compare (vorbis_atom))
-                        entry.type = IcecastEntry::Vorbis;
-                    else
-                        entry.type = IcecastEntry::Other;
-                }
-                else if (! reader.name ().compare (bitrate_atom))
-                    entry.bitrate = reader.readElementText ().toInt ();
-
-                break;
-            case QXmlStreamReader::EndElement:
-                if (! reader.name ().compare (entry_atom))
-                    m_results.append (entry);
-
-                break;
-            default:
-                break;
+// runs on the worker thread; only the finished batches cross back over
+// to the model, through the event queue
+void IcecastTunerModel::parse_all (ParseWorker & worker, const QByteArray & data)
+{
+    // lets prefab some atoms for fast comparisons
+    static const QString entry_atom = QString ("entry");
+    static const QString server_name_atom = QString ("server_name");
+    static const QString listen_url_atom = QString ("listen_url");
+    static const QString server_type_atom = QString ("server_type");
+    static const QString bitrate_atom = QString ("bitrate");
+    static const QString genre_atom = QString ("genre");
+    static const QString current_song_atom = QString ("current_song");
+    static const QString mp3_atom = QString ("audio/mpeg");
+    static const QString aac_atom = QString ("audio/aacp");
+    static const QString vorbis_atom = QString ("application/ogg");
+
+    QXmlStreamReader reader (data);
+    IcecastEntry entry;
+
+    auto send = [& worker] (Index<IcecastEntry> & batch, IcecastTunerModel * model) {
+        // Index is move-only and std::function wants a copyable closure
+        auto shared = std::make_shared<Index<IcecastEntry>> (std::move (batch));
+        worker.deliver ([model, shared] () { model->insert_batch (* shared); });
+    };
+
+    Index<IcecastEntry> batch;
+
+    while (! reader.atEnd () && ! worker.cancelled ()) {
+        auto token_type = reader.readNext ();
+
+        switch (token_type) {
+        case QXmlStreamReader::StartElement:
+            if (! reader.name ().compare (server_name_atom))
+                entry.title = reader.readElementText ();
+            else if (! reader.name ().compare (listen_url_atom))
+                entry.stream_uri = reader.readElementText ();
+            else if (! reader.name ().compare (current_song_atom))
+                entry.current_song = reader.readElementText ();
+            else if (! reader.name ().compare (genre_atom))
+                entry.genre = reader.readElementText ();
+            else if (! reader.name ().compare (server_type_atom))
+            {
+                auto server_type = reader.readElementText ();
+
+                if (! server_type.compare (mp3_atom))
+                    entry.type = IcecastEntry::MP3;
+                else if (! server_type.compare (aac_atom))
+                    entry.type = IcecastEntry::AAC;
+                else if (! server_type.compare (vorbis_atom))
+                    entry.type = IcecastEntry::Vorbis;
+                else
+                    entry.type = IcecastEntry::Other;
             }
+            else if (! reader.name ().compare (bitrate_atom))
+                entry.bitrate = reader.readElementText ().toInt ();
+
+            break;
+        case QXmlStreamReader::EndElement:
+            if (! reader.name ().compare (entry_atom))
+                batch.append (entry);
+
+            break;
+        default:
+            break;
         }
 
-        endResetModel ();
-    });
+        if (batch.len () >= PARSE_BATCH)
+            send (batch, this);
+    }
+
+    if (batch.len () && ! worker.cancelled ())
+        send (batch, this);
+}
+
+void IcecastTunerModel::insert_batch (Index<IcecastEntry> & batch)
+{
+    if (! batch.len ())
+        return;
+
+    beginInsertRows (QModelIndex (), m_results.len (),
+     m_results.len () + batch.len () - 1);
+    m_results.move_from (batch, 0, -1, -1, true, true);
+    endInsertRows ();
 }
 
 const IcecastEntry & IcecastTunerModel::entry (int idx) const
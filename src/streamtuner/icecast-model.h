@@ -20,6 +20,8 @@
 #include <libaudcore/hook.h>
 #include <libaudcore/runtime.h>
 #include <libaudcore/index.h>
+#include <libaudcore/mainloop.h>
+#include <libaudcore/objects.h>
 #include <libaudcore/playlist.h>
 #include <libaudcore/vfs_async.h>
 
@@ -31,6 +33,8 @@
 #include <QSplitter>
 #include <QAbstractListModel>
 
+#include "parse-worker.h"
+
 struct IcecastEntry {
     QString title;
     QString genre;
@@ -71,7 +75,12 @@ public:
     const IcecastEntry & entry (int idx) const;
 
 private:
+    void start_parse (QByteArray && data);
+    void parse_all (ParseWorker & worker, const QByteArray & data);
+    void insert_batch (Index<IcecastEntry> & batch);
+
     Index<IcecastEntry> m_results;
+    ParseWorker m_worker;
 };
 
 #endif
@@ -9,6 +9,7 @@
 // from the use of this software.
 
 #include "icecast-widget.h"
+#include "probe-worker.h"
 
 IcecastListingWidget::IcecastListingWidget (QWidget * parent) :
     audqt::TreeView (parent)
@@ -31,3 +32,11 @@ void IcecastListingWidget::activate (const QModelIndex & index)
 
     Playlist::temporary_playlist ().insert_entry (-1, entry.stream_uri.toUtf8 (), Tuple (), true);
 }
+
+void IcecastListingWidget::currentChanged (const QModelIndex & current, const QModelIndex & previous)
+{
+    audqt::TreeView::currentChanged (current, previous);
+
+    if (current.row () >= 0)
+        probe_station (m_model->entry (current.row ()).stream_uri.toUtf8 ());
+}
@@ -33,6 +33,9 @@ public:
 
      void activate (const QModelIndex & index);
 
+protected:
+     void currentChanged (const QModelIndex & current, const QModelIndex & previous) override;
+
 private:
      IcecastTunerModel *m_model;
 };
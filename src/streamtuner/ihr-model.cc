@@ -18,6 +18,7 @@
 #include <libaudcore/runtime.h>
 #include <libaudcore/index.h>
 #include <libaudcore/playlist.h>
+#include <libaudcore/vfs.h>
 #include <libaudcore/vfs_async.h>
 
 #include <libaudqt/treeview.h>
@@ -28,15 +29,33 @@
 #include <QNetworkAccessManager>
 #include <QNetworkRequest>
 #include <QNetworkReply>
+#include <memory>
+#include <utility>
+
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QJsonObject>
 
 #include "ihr-model.h"
+#include "../fetch-common/fetch.h"
+
+static String ihr_cache_path ()
+{
+    return String (str_concat ({aud_get_path (AudPath::UserDir), "/streamtuner-ihr-markets.json"}));
+}
 
 IHRMarketModel::IHRMarketModel (QObject * parent) :
     QAbstractListModel (parent)
 {
+    // show the market list as cached by the last fetch right away; the
+    // fresh copy replaces it once it has been downloaded
+    VFSFile cache (ihr_cache_path (), "r");
+    if (cache) {
+        auto data = cache.read_all ();
+        if (data.len ())
+            start_parse (QByteArray (data.begin (), data.len ()));
+    }
+
     fetch_markets ();
 }
 
@@ -80,40 +99,67 @@ QVariant IHRMarketModel::data (const QModelIndex &index, int role) const
 
 static const char *URI_GET_MARKETS = "https://api.iheart.com/api/v2/content/markets?limit=10000&cache=true";
 
-void IHRMarketModel::fetch_markets ()
+void IHRMarketModel::start_parse (QByteArray && data)
 {
-    vfs_async_file_get_contents (URI_GET_MARKETS, [&] (const char *, const Index<char> & buf) {
-        if (! buf.len ())
-            return;
+    m_worker.start (std::move (data), [this] (ParseWorker & worker,
+     const QByteArray & data) { parse_markets (worker, data); });
+}
+
+// runs on the worker thread; the parsed listing crosses back over to the
+// model through the event queue
+void IHRMarketModel::parse_markets (ParseWorker & worker, const QByteArray & data)
+{
+    auto doc = QJsonDocument::fromJson(data);
+    if (! doc.isObject ())
+        return;
 
-       auto doc = QJsonDocument::fromJson(QByteArray (buf.begin (), buf.len ()));
-       if (! doc.isObject ())
-           return;
+    auto root = doc.object ();
+    auto market_count = root["total"].toInt ();
 
-       auto root = doc.object ();
-       auto market_count = root["total"].toInt ();
+    AUDINFO ("Fetched %d markets.\n", market_count);
 
-       AUDINFO ("Fetched %d markets.\n", market_count);
+    Index<IHRMarketEntry> results;
 
-       beginResetModel ();
+    auto markets = root["hits"].toArray ();
 
-       auto markets = root["hits"].toArray ();
+    for (auto market_ref : markets)
+    {
+        auto market = market_ref.toObject ();
+        IHRMarketEntry entry;
 
-       for (auto market_ref : markets)
-       {
-           auto market = market_ref.toObject ();
-           IHRMarketEntry entry;
+        entry.market_id = market["marketId"].toInt ();
+        entry.station_count = market["stationCount"].toInt ();
+        entry.city = market["city"].toString ();
+        entry.state = market["stateAbbreviation"].toString ();
+        entry.country_code = market["countryAbbreviation"].toString ();
 
-           entry.market_id = market["marketId"].toInt ();
-           entry.station_count = market["stationCount"].toInt ();
-           entry.city = market["city"].toString ();
-           entry.state = market["stateAbbreviation"].toString ();
-           entry.country_code = market["countryAbbreviation"].toString ();
+        results.append (entry);
+    }
 
-           m_results.append (entry);
-       }
+    // Index is move-only and std::function wants a copyable closure
+    auto shared = std::make_shared<Index<IHRMarketEntry>> (std::move (results));
+    worker.deliver ([this, shared] () { apply_results (* shared); });
+}
 
-       endResetModel ();
+void IHRMarketModel::apply_results (Index<IHRMarketEntry> & results)
+{
+    beginResetModel ();
+    m_results = std::move (results);
+    endResetModel ();
+}
+
+void IHRMarketModel::fetch_markets ()
+{
+    fetch_async (URI_GET_MARKETS, [&] (const char *, const Index<char> & buf) {
+        if (! buf.len ())
+            return;
+
+        // refresh the on-disk cache so the next open is instant
+        VFSFile cache (ihr_cache_path (), "w");
+        if (cache)
+            cache.fwrite (buf.begin (), 1, buf.len ());
+
+        start_parse (QByteArray (buf.begin (), buf.len ()));
     });
 }
 
@@ -192,42 +238,58 @@ void IHRTunerModel::fetch_stations (int market_id)
 {
     StringBuf uri = str_printf("https://api.iheart.com/api/v2/content/liveStations?limit=100&marketId=%d", market_id);
 
-    vfs_async_file_get_contents(uri, [&] (const char *, const Index<char> & buf) {
+    fetch_async(uri, [&, market_id] (const char *, const Index<char> & buf) {
         if (! buf.len ())
             return;
 
-       auto doc = QJsonDocument::fromJson(QByteArray (buf.begin (), buf.len ()));
-       if (! doc.isObject ())
-           return;
+        m_worker.start (QByteArray (buf.begin (), buf.len ()),
+         [this, market_id] (ParseWorker & worker, const QByteArray & data)
+            { parse_stations (worker, data, market_id); });
+    });
+}
 
-       auto root = doc.object ();
-       auto station_count = root["total"].toInt ();
+// runs on the worker thread; the parsed listing crosses back over to the
+// model through the event queue
+void IHRTunerModel::parse_stations (ParseWorker & worker, const QByteArray & data, int market_id)
+{
+    auto doc = QJsonDocument::fromJson(data);
+    if (! doc.isObject ())
+        return;
 
-       AUDINFO ("Fetched %d stations for market %d.\n", station_count, market_id);
+    auto root = doc.object ();
+    auto station_count = root["total"].toInt ();
 
-       beginResetModel ();
+    AUDINFO ("Fetched %d stations for market %d.\n", station_count, market_id);
 
-       m_results.clear ();
+    Index<IHRStationEntry> results;
 
-       auto stations = root["hits"].toArray ();
+    auto stations = root["hits"].toArray ();
 
-       for (auto station_ref : stations)
-       {
-           auto station = station_ref.toObject ();
-           IHRStationEntry entry;
+    for (auto station_ref : stations)
+    {
+        auto station = station_ref.toObject ();
+        IHRStationEntry entry;
 
-           entry.title = station["name"].toString ();
-           entry.description = station["description"].toString ();
-           entry.call_letters = station["callLetters"].toString ();
+        entry.title = station["name"].toString ();
+        entry.description = station["description"].toString ();
+        entry.call_letters = station["callLetters"].toString ();
 
-           auto streams = station["streams"].toObject ();
-           entry.stream_uri = streams["shoutcast_stream"].toString ();
+        auto streams = station["streams"].toObject ();
+        entry.stream_uri = streams["shoutcast_stream"].toString ();
 
-           m_results.append (entry);
-       }
+        results.append (entry);
+    }
 
-       endResetModel ();
-    });
+    // Index is move-only and std::function wants a copyable closure
+    auto shared = std::make_shared<Index<IHRStationEntry>> (std::move (results));
+    worker.deliver ([this, shared] () { apply_results (* shared); });
+}
+
+void IHRTunerModel::apply_results (Index<IHRStationEntry> & results)
+{
+    beginResetModel ();
+    m_results = std::move (results);
+    endResetModel ();
 }
 
 const IHRStationEntry & IHRTunerModel::station_for_idx (const QModelIndex &index) const
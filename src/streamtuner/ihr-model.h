@@ -34,6 +34,8 @@
 #include <QJsonArray>
 #include <QJsonObject>
 
+#include "parse-worker.h"
+
 struct IHRMarketEntry {
     QString city;
     QString state;
@@ -64,7 +66,12 @@ public:
     int id_for_idx (const QModelIndex &index) const;
 
 private:
+    void start_parse (QByteArray && data);
+    void parse_markets (ParseWorker & worker, const QByteArray & data);
+    void apply_results (Index<IHRMarketEntry> & results);
+
     Index<IHRMarketEntry> m_results;
+    ParseWorker m_worker;
 };
 
 class IHRTunerModel : public QAbstractListModel {
@@ -89,7 +96,11 @@ public:
     const IHRStationEntry & station_for_idx (const QModelIndex &index) const;
 
 private:
+    void parse_stations (ParseWorker & worker, const QByteArray & data, int market_id);
+    void apply_results (Index<IHRStationEntry> & results);
+
     Index<IHRStationEntry> m_results;
+    ParseWorker m_worker;
 };
 
 #endif
@@ -44,6 +44,14 @@ void IHRListingWidget::activate (const QModelIndex & index)
     Playlist::temporary_playlist ().insert_entry (-1, entry.stream_uri.toUtf8 (), Tuple (), true);
 }
 
+void IHRListingWidget::currentChanged (const QModelIndex & current, const QModelIndex & previous)
+{
+    audqt::TreeView::currentChanged (current, previous);
+
+    if (current.row () >= 0)
+        probe_station (m_model->entry (current.row ()).stream_uri.toUtf8 ());
+}
+
 IHRMarketWidget::IHRMarketWidget (QWidget * parent) :
     QTreeView (parent)
 {
@@ -0,0 +1,84 @@
+// Copyright (c) 2026 Audacious developers
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// This software is provided 'as is' and without any warranty, express or
+// implied.  In no event shall the authors be liable for any damages arising
+// from the use of this software.
+
+#include "parse-worker.h"
+
+void * ParseWorker::worker_cb (void * self)
+{
+    auto & worker = * (ParseWorker *) self;
+    worker.m_parse (worker, worker.m_data);
+    return nullptr;
+}
+
+void ParseWorker::start (QByteArray && data, ParseFunc parse)
+{
+    stop ();
+
+    m_data = std::move (data);
+    m_parse = std::move (parse);
+
+    if (pthread_create (& m_thread, nullptr, worker_cb, this)) {
+        // fall back to parsing on the spot; correct, if not smooth
+        m_parse (* this, m_data);
+        flush ();
+        return;
+    }
+
+    m_running = true;
+}
+
+void ParseWorker::stop ()
+{
+    pthread_mutex_lock (& m_mutex);
+    m_cancel = true;
+    pthread_mutex_unlock (& m_mutex);
+
+    if (m_running) {
+        pthread_join (m_thread, nullptr);
+        m_running = false;
+    }
+
+    // drop batches the main loop has not picked up yet
+    m_queued.stop ();
+    m_pending.clear ();
+    m_data.clear ();
+    m_parse = nullptr;
+    m_cancel = false;
+}
+
+bool ParseWorker::cancelled ()
+{
+    pthread_mutex_lock (& m_mutex);
+    bool cancel = m_cancel;
+    pthread_mutex_unlock (& m_mutex);
+    return cancel;
+}
+
+void ParseWorker::deliver (std::function<void ()> batch)
+{
+    pthread_mutex_lock (& m_mutex);
+
+    if (! m_cancel) {
+        m_pending.append (std::move (batch));
+        m_queued.queue ([this] () { flush (); });
+    }
+
+    pthread_mutex_unlock (& m_mutex);
+}
+
+void ParseWorker::flush ()
+{
+    pthread_mutex_lock (& m_mutex);
+    auto batches = std::move (m_pending);
+    pthread_mutex_unlock (& m_mutex);
+
+    for (auto & batch : batches)
+        batch ();
+}
@@ -0,0 +1,60 @@
+// Copyright (c) 2026 Audacious developers
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// This software is provided 'as is' and without any warranty, express or
+// implied.  In no event shall the authors be liable for any damages arising
+// from the use of this software.
+
+#ifndef STREAMTUNER_PARSE_WORKER_H
+#define STREAMTUNER_PARSE_WORKER_H
+
+#include <pthread.h>
+
+#include <functional>
+
+#include <QByteArray>
+
+#include <libaudcore/index.h>
+#include <libaudcore/mainloop.h>
+
+// Runs response parsing on a worker thread so that digesting a large
+// directory listing does not stall the main loop.  The parse function runs
+// on the worker and calls deliver() with a closure for each batch of parsed
+// records; the closures are handed back to the main loop through the event
+// queue, in order.  start() on a busy worker, and the destructor, cancel the
+// running job; a long parse should poll cancelled() between batches so the
+// cancellation is prompt.  Closures from a cancelled job are never run, so a
+// model that stops its worker before dying cannot be called back after.
+
+class ParseWorker {
+public:
+    typedef std::function<void (ParseWorker &, const QByteArray &)> ParseFunc;
+
+    ParseWorker () = default;
+    ~ParseWorker () { stop (); }
+
+    void start (QByteArray && data, ParseFunc parse);
+    void stop ();
+
+    // called by the parse function, on the worker thread
+    bool cancelled ();
+    void deliver (std::function<void ()> batch);
+
+private:
+    void flush ();
+    static void * worker_cb (void * self);
+
+    QByteArray m_data;
+    ParseFunc m_parse;
+    Index<std::function<void ()>> m_pending;
+    QueuedFunc m_queued;
+    pthread_mutex_t m_mutex = PTHREAD_MUTEX_INITIALIZER;
+    pthread_t m_thread;
+    bool m_running = false;
+    bool m_cancel = false;
+};
+
+#endif
@@ -0,0 +1,104 @@
+// Copyright (c) 2026 Audacious developers
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// This software is provided 'as is' and without any warranty, express or
+// implied.  In no event shall the authors be liable for any damages arising
+// from the use of this software.
+
+#include "probe-worker.h"
+
+#include <pthread.h>
+#include <string.h>
+
+#include <libaudcore/objects.h>
+#include <libaudcore/runtime.h>
+#include <libaudcore/vfs.h>
+
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+static pthread_t thread;
+static bool running, quitting;
+static String next_uri, last_uri;
+
+static void * worker_cb (void *)
+{
+    pthread_mutex_lock (& mutex);
+
+    while (! quitting)
+    {
+        if (! next_uri)
+        {
+            pthread_cond_wait (& cond, & mutex);
+            continue;
+        }
+
+        String uri = next_uri;
+        next_uri = String ();
+
+        pthread_mutex_unlock (& mutex);
+
+        AUDINFO ("Warming up connection to %s.\n", (const char *) uri);
+
+        // opening and closing the URL is all it takes; the transport pools
+        // the session on close and hands it back when playback opens the
+        // same host
+        VFSFile file (uri, "r");
+
+        if (! file)
+            AUDINFO ("Warmup failed: %s.\n", file.error ());
+
+        pthread_mutex_lock (& mutex);
+    }
+
+    pthread_mutex_unlock (& mutex);
+    return nullptr;
+}
+
+void probe_station (const char * uri)
+{
+    // only the HTTP transport pools its sessions
+    if (! uri || (strncmp (uri, "http://", 7) && strncmp (uri, "https://", 8)))
+        return;
+
+    // a selection usually stays put for a while; don't probe it twice
+    if (last_uri && ! strcmp (last_uri, uri))
+        return;
+
+    last_uri = String (uri);
+
+    pthread_mutex_lock (& mutex);
+
+    next_uri = last_uri;
+
+    if (! running)
+    {
+        quitting = false;
+
+        // if the thread cannot be created, simply skip the warmup
+        if (! pthread_create (& thread, nullptr, worker_cb, nullptr))
+            running = true;
+    }
+
+    pthread_cond_signal (& cond);
+    pthread_mutex_unlock (& mutex);
+}
+
+void probe_worker_stop ()
+{
+    pthread_mutex_lock (& mutex);
+    quitting = true;
+    next_uri = String ();
+    pthread_cond_signal (& cond);
+    pthread_mutex_unlock (& mutex);
+
+    if (running)
+    {
+        pthread_join (thread, nullptr);
+        running = false;
+    }
+
+    last_uri = String ();
+}
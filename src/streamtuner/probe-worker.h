@@ -0,0 +1,23 @@
+// Copyright (c) 2026 Audacious developers
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// This software is provided 'as is' and without any warranty, express or
+// implied.  In no event shall the authors be liable for any damages arising
+// from the use of this software.
+
+#ifndef STREAMTUNER_PROBE_WORKER_H
+#define STREAMTUNER_PROBE_WORKER_H
+
+// Speculative connection warmup.  Selecting a station briefly opens its URL
+// on a worker thread and closes it again; the HTTP transport keeps the
+// resolved, set-up session in its pool, so actually playing the station
+// afterward skips the name lookup and session setup.  Only the most recent
+// selection is probed; older requests still waiting are replaced.
+
+void probe_station (const char * uri);
+void probe_worker_stop ();
+
+#endif
@@ -18,22 +18,40 @@
 #include <libaudcore/runtime.h>
 #include <libaudcore/index.h>
 #include <libaudcore/playlist.h>
+#include <libaudcore/vfs.h>
 
 #include <QAbstractListModel>
 #include <QNetworkAccessManager>
 #include <QNetworkRequest>
 #include <QNetworkReply>
+#include <memory>
+#include <utility>
+
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QJsonObject>
 
 #include "shoutcast-model.h"
 
+static String shoutcast_cache_path ()
+{
+    return String (str_concat ({aud_get_path (AudPath::UserDir), "/streamtuner-shoutcast.json"}));
+}
+
 ShoutcastTunerModel::ShoutcastTunerModel (QObject * parent) :
     QAbstractListModel (parent)
 {
     m_qnam = new QNetworkAccessManager (this);
 
+    // show the Top 500 listing as cached by the last fetch right away;
+    // the fresh copy replaces it once it has been downloaded
+    VFSFile cache (shoutcast_cache_path (), "r");
+    if (cache) {
+        auto data = cache.read_all ();
+        if (data.len ())
+            start_parse (QByteArray (data.begin (), data.len ()));
+    }
+
     fetch_stations ();
 }
 
@@ -62,52 +80,73 @@ void ShoutcastTunerModel::fetch_stations (String genre)
     QNetworkRequest request = QNetworkRequest (url);
     request.setHeader (QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
 
+    bool is_top500 = (! genre || ! strcmp (genre, "Top 500 Stations"));
+
     QNetworkReply * reply = m_qnam->post (request, (const char *) post_data);
-    QObject::connect (reply, &QNetworkReply::finished, [reply, this] () {
+    QObject::connect (reply, &QNetworkReply::finished, [reply, is_top500, this] () {
         if (200 != reply->attribute (QNetworkRequest::HttpStatusCodeAttribute))
             return;
 
        auto data = reply->readAll();
-       auto doc = QJsonDocument::fromJson(data);
 
-       if (! doc.isArray ())
-           return;
+       // cache the default listing so the next open is instant
+       if (is_top500) {
+           VFSFile cache (shoutcast_cache_path (), "w");
+           if (cache)
+               cache.fwrite (data.constData (), 1, data.size ());
+       }
 
-       auto stations = doc.array ();
-       process_stations (stations);
+       start_parse (std::move (data));
     });
 }
 
-void ShoutcastTunerModel::process_station (QJsonObject object)
+void ShoutcastTunerModel::start_parse (QByteArray && data)
 {
-    ShoutcastEntry entry;
-
-    entry.listeners = object["Listeners"].toInt ();
-    entry.bitrate = object["Bitrate"].toInt ();
-    entry.station_id = object["ID"].toInt ();
-    entry.genre = object["Genre"].toString ();
-    entry.title = object["Name"].toString ();
-    entry.type = object["Format"].toString () == QString ("audio/mpeg") ? ShoutcastEntry::MP3 : ShoutcastEntry::AAC;
-
-    m_results.append (entry);
+    m_worker.start (std::move (data), [this] (ParseWorker & worker,
+     const QByteArray & data) { parse_stations (worker, data); });
 }
 
-void ShoutcastTunerModel::process_stations (QJsonArray & stations)
+// runs on the worker thread; the parsed listing crosses back over to the
+// model through the event queue
+void ShoutcastTunerModel::parse_stations (ParseWorker & worker, const QByteArray & data)
 {
-    AUDINFO ("Retrieved %lld stations.\n", (long long int) stations.size ());
+    auto doc = QJsonDocument::fromJson (data);
+    if (! doc.isArray ())
+        return;
 
-    beginResetModel ();
+    auto stations = doc.array ();
 
-    m_results.clear ();
+    AUDINFO ("Retrieved %lld stations.\n", (long long int) stations.size ());
+
+    Index<ShoutcastEntry> results;
 
     for (auto st : stations)
     {
         if (! st.isObject ())
             continue;
 
-        process_station (st.toObject ());
+        auto object = st.toObject ();
+        ShoutcastEntry entry;
+
+        entry.listeners = object["Listeners"].toInt ();
+        entry.bitrate = object["Bitrate"].toInt ();
+        entry.station_id = object["ID"].toInt ();
+        entry.genre = object["Genre"].toString ();
+        entry.title = object["Name"].toString ();
+        entry.type = object["Format"].toString () == QString ("audio/mpeg") ? ShoutcastEntry::MP3 : ShoutcastEntry::AAC;
+
+        results.append (entry);
     }
 
+    // Index is move-only and std::function wants a copyable closure
+    auto shared = std::make_shared<Index<ShoutcastEntry>> (std::move (results));
+    worker.deliver ([this, shared] () { apply_results (* shared); });
+}
+
+void ShoutcastTunerModel::apply_results (Index<ShoutcastEntry> & results)
+{
+    beginResetModel ();
+    m_results = std::move (results);
     endResetModel ();
 }
 
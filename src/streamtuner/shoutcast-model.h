@@ -34,6 +34,8 @@
 #include <QJsonArray>
 #include <QJsonObject>
 
+#include "parse-worker.h"
+
 struct ShoutcastEntry {
     QString title;
     QString genre;
@@ -71,14 +73,16 @@ public:
 
     void fetch_stations (String genre = String ());
 
-    void process_station (QJsonObject object);
-    void process_stations (QJsonArray & stations);
-
     const ShoutcastEntry & entry (int idx) const;
 
 private:
+    void start_parse (QByteArray && data);
+    void parse_stations (ParseWorker & worker, const QByteArray & data);
+    void apply_results (Index<ShoutcastEntry> & results);
+
     Index<ShoutcastEntry> m_results;
     QNetworkAccessManager *m_qnam;
+    ParseWorker m_worker;
 };
 
 class ShoutcastGenreModel : public QAbstractListModel {
@@ -53,6 +53,17 @@ void ShoutcastListingWidget::activate (const QModelIndex & index)
     Playlist::temporary_playlist ().insert_entry (-1, playlist_uri, Tuple (), true);
 }
 
+void ShoutcastListingWidget::currentChanged (const QModelIndex & current, const QModelIndex & previous)
+{
+    audqt::TreeView::currentChanged (current, previous);
+
+    if (current.row () < 0)
+        return;
+
+    auto entry = m_model->entry (current.row ());
+    probe_station (str_printf ("https://yp.shoutcast.com/sbin/tunein-station.m3u?id=%d", entry.station_id));
+}
+
 ShoutcastGenreWidget::ShoutcastGenreWidget (QWidget * parent) :
     QTreeView (parent)
 {
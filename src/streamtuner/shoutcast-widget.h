@@ -32,6 +32,9 @@ public:
 
      void activate (const QModelIndex & index);
 
+protected:
+     void currentChanged (const QModelIndex & current, const QModelIndex & previous) override;
+
 private:
      ShoutcastTunerModel *m_model;
 };
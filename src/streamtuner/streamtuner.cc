@@ -35,6 +35,8 @@
 #include "shoutcast-widget.h"
 #include "icecast-widget.h"
 #include "ihr-widget.h"
+#include "probe-worker.h"
+#include "../fetch-common/fetch.h"
 
 class StreamTunerWidget : public QTabWidget {
 public:
@@ -77,11 +79,18 @@ public:
 
     constexpr StreamTunerPlugin () : GeneralPlugin (info, false) { }
 
+    void cleanup () override;
     void * get_qt_widget () override;
 };
 
 EXPORT StreamTunerPlugin aud_plugin_instance;
 
+void StreamTunerPlugin::cleanup ()
+{
+    probe_worker_stop ();
+    fetch_cleanup ();
+}
+
 void * StreamTunerPlugin::get_qt_widget ()
 {
     return new StreamTunerWidget ();
@@ -21,6 +21,7 @@
 #include <libaudcore/plugin.h>
 
 #include <limits.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
@@ -35,6 +36,27 @@
 #define PI              3.14159265358979323846
 #endif
 
+/* one cycle of sine, indexed by the top bits of a 32-bit phase accumulator;
+ * the extra entry at the end lets the interpolation read i+1 without wrapping */
+#define TABLE_BITS      12
+#define TABLE_SIZE      (1 << TABLE_BITS)
+#define PHASE_SHIFT     (32 - TABLE_BITS)
+#define PHASE_MASK      ((1u << PHASE_SHIFT) - 1)
+
+static float sine_table[TABLE_SIZE + 1];
+static bool sine_table_ready = false;
+
+static void sine_table_init()
+{
+    if (sine_table_ready)
+        return;
+
+    for (int i = 0; i <= TABLE_SIZE; i++)
+        sine_table[i] = sin(2 * PI * i / TABLE_SIZE);
+
+    sine_table_ready = true;
+}
+
 class ToneGen : public InputPlugin
 {
 public:
@@ -98,8 +120,7 @@ static StringBuf tone_title(const char *filename)
 
 struct tone_t
 {
-    double wd;
-    unsigned period, t;
+    uint32_t phase, step;
 };
 
 bool ToneGen::play(const char *filename, VFSFile &file)
@@ -113,31 +134,39 @@ bool ToneGen::play(const char *filename, VFSFile &file)
     set_stream_bitrate(16 * OUTPUT_FREQ);
     open_audio(FMT_FLOAT, OUTPUT_FREQ, 1);
 
+    sine_table_init();
+
     Index<tone_t> tone;
     tone.resize(frequencies.len());
     for (int i = 0; i < frequencies.len(); i++)
     {
-        double f = frequencies[i];
-        tone[i].wd = 2 * PI * f / OUTPUT_FREQ;
-        tone[i].period = (INT_MAX * 2U / OUTPUT_FREQ) * (OUTPUT_FREQ / f);
-        tone[i].t = 0;
+        /* the 32-bit accumulator wraps for free, so phase never drifts */
+        tone[i].step = (uint32_t)(frequencies[i] / OUTPUT_FREQ * 4294967296.0);
+        tone[i].phase = 0;
     }
 
+    /* dithering can cause a little bit of clipping */
+    float scale = 0.999 / frequencies.len();
+
     while (!check_stop())
     {
         for (int i = 0; i < BUF_SAMPLES; i++)
         {
-            double sum_sines = 0;
+            float sum_sines = 0;
 
             for (int j = 0; j < frequencies.len(); j++)
             {
-                sum_sines += sin(tone[j].wd * tone[j].t);
-                if (tone[j].t > tone[j].period)
-                    tone[j].t -= tone[j].period;
-                tone[j].t++;
+                uint32_t phase = tone[j].phase;
+                unsigned idx = phase >> PHASE_SHIFT;
+                float frac = (phase & PHASE_MASK) * (1.0f / (PHASE_MASK + 1.0f));
+
+                sum_sines += sine_table[idx]
+                 + (sine_table[idx + 1] - sine_table[idx]) * frac;
+
+                tone[j].phase = phase + tone[j].step;
             }
-            /* dithering can cause a little bit of clipping */
-            data[i] = (sum_sines * 0.999 / (double)frequencies.len());
+
+            data[i] = sum_sines * scale;
         }
 
         write_audio(data, BUF_BYTES);
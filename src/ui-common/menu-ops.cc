@@ -17,28 +17,206 @@
  * the use of this software.
  */
 
+#include <pthread.h>
+#include <string.h>
+
+#include <libaudcore/audstrings.h>
 #include <libaudcore/drct.h>
+#include <libaudcore/mainloop.h>
+#include <libaudcore/multihash.h>
 #include <libaudcore/playlist.h>
 #include <libaudcore/runtime.h>
+#include <libaudcore/templates.h>
+#include <libaudcore/tuple.h>
 
 #define ACTIVE Playlist::active_playlist ()
 
+/* Sorting a very large playlist by a text field spends nearly all of its
+ * time in locale collation, recomputed for every comparison.  For big
+ * lists we snapshot the unique field values, build one collation key per
+ * value (strxfrm) on a few worker threads, and then run the sort with a
+ * comparator that only strcmps the cached keys.  The reordering is still
+ * the core's single batched sort_by_tuple mutation; only the expensive
+ * key computation leaves the main thread, so the interface stays live
+ * while it runs. */
+
+static constexpr int KeyedSortThreshold = 5000;
+static constexpr int KeyedSortMaxThreads = 4;
+
+struct KeyedSortJob
+{
+    Playlist list;
+    Tuple::Field field;
+    bool selected = false;
+    Index<String> values;
+    Index<Index<char>> keys;
+    int next_value = 0;   /* guarded by mutex */
+    int threads_left = 0; /* guarded by mutex */
+    pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+};
+
+static SimpleHash<String, Index<char>> keyed_sort_keys;
+static Tuple::Field keyed_sort_field;
+static QueuedFunc keyed_sort_queued;
+static bool keyed_sort_pending = false;
+
+static int keyed_compare (const Tuple & a, const Tuple & b)
+{
+    String sa = a.get_str (keyed_sort_field);
+    String sb = b.get_str (keyed_sort_field);
+
+    if (! sa || ! sb)
+        return (sa ? 1 : 0) - (sb ? 1 : 0);
+
+    auto ka = keyed_sort_keys.lookup (sa);
+    auto kb = keyed_sort_keys.lookup (sb);
+
+    /* entries added or rescanned while the keys were being built; strcoll
+     * orders consistently with strcmp over strxfrm keys, so mixing the two
+     * keeps the comparator a strict weak ordering */
+    if (! ka || ! kb)
+        return strcoll (sa, sb);
+
+    return strcmp (ka->begin (), kb->begin ());
+}
+
+/* runs on the main loop */
+static void keyed_sort_apply (KeyedSortJob * job)
+{
+    keyed_sort_field = job->field;
+
+    for (int i = 0; i < job->values.len (); i ++)
+        keyed_sort_keys.add (job->values[i], std::move (job->keys[i]));
+
+    if (job->selected)
+        job->list.sort_selected_by_tuple (keyed_compare);
+    else
+        job->list.sort_by_tuple (keyed_compare);
+
+    keyed_sort_keys.clear ();
+    keyed_sort_pending = false;
+    delete job;
+}
+
+static void * keyed_sort_worker (void * data)
+{
+    auto job = (KeyedSortJob *) data;
+
+    for (;;)
+    {
+        pthread_mutex_lock (& job->mutex);
+        int i = job->next_value ++;
+        pthread_mutex_unlock (& job->mutex);
+
+        if (i >= job->values.len ())
+            break;
+
+        const char * value = job->values[i];
+        size_t len = strxfrm (nullptr, value, 0);
+
+        Index<char> & key = job->keys[i];
+        key.insert (-1, len + 1);
+        strxfrm (key.begin (), value, len + 1);
+    }
+
+    pthread_mutex_lock (& job->mutex);
+    bool last = ! -- job->threads_left;
+    pthread_mutex_unlock (& job->mutex);
+
+    if (last)
+        keyed_sort_queued.queue ([job] () { keyed_sort_apply (job); });
+
+    return nullptr;
+}
+
+static void keyed_sort (Playlist::SortType stock, Tuple::Field field, bool selected)
+{
+    auto list = ACTIVE;
+    int entries = list.n_entries ();
+
+    /* small lists sort faster than a snapshot would take; and only one
+     * keyed sort runs at a time */
+    if (entries < KeyedSortThreshold || keyed_sort_pending)
+    {
+        if (selected)
+            list.sort_selected (stock);
+        else
+            list.sort_entries (stock);
+
+        return;
+    }
+
+    auto job = new KeyedSortJob;
+    job->list = list;
+    job->field = field;
+    job->selected = selected;
+
+    SimpleHash<String, bool> seen;
+
+    for (int i = 0; i < entries; i ++)
+    {
+        if (selected && ! list.entry_selected (i))
+            continue;
+
+        String value = list.entry_tuple (i, Playlist::NoWait).get_str (field);
+        if (value && ! seen.lookup (value))
+        {
+            seen.add (value, true);
+            job->values.append (value);
+        }
+    }
+
+    job->keys.insert (-1, job->values.len ());
+
+    int n_threads = aud::clamp (job->values.len () / 4096, 1, KeyedSortMaxThreads);
+    job->threads_left = n_threads;
+
+    keyed_sort_pending = true;
+
+    int started = 0;
+    for (int i = 0; i < n_threads; i ++)
+    {
+        pthread_t thread;
+        if (! pthread_create (& thread, nullptr, keyed_sort_worker, job))
+        {
+            pthread_detach (thread);
+            started ++;
+        }
+        else
+        {
+            pthread_mutex_lock (& job->mutex);
+            bool last = ! -- job->threads_left;
+            pthread_mutex_unlock (& job->mutex);
+
+            if (last && started)
+                keyed_sort_queued.queue ([job] () { keyed_sort_apply (job); });
+        }
+    }
+
+    /* no workers to be had; compute the keys on the spot */
+    if (! started)
+    {
+        job->threads_left = 1;
+        keyed_sort_worker (job);
+    }
+}
+
 void rm_dupes_title () { ACTIVE.remove_duplicates (Playlist::Title); }
 void rm_dupes_filename () { ACTIVE.remove_duplicates (Playlist::Filename); }
 void rm_dupes_path () { ACTIVE.remove_duplicates (Playlist::Path); }
 
 void sort_track () { ACTIVE.sort_entries (Playlist::Track); }
-void sort_title () { ACTIVE.sort_entries (Playlist::Title); }
-void sort_artist () { ACTIVE.sort_entries (Playlist::Artist); }
-void sort_album () { ACTIVE.sort_entries (Playlist::Album); }
-void sort_album_artist () { ACTIVE.sort_entries (Playlist::AlbumArtist); }
+void sort_title () { keyed_sort (Playlist::Title, Tuple::Title, false); }
+void sort_artist () { keyed_sort (Playlist::Artist, Tuple::Artist, false); }
+void sort_album () { keyed_sort (Playlist::Album, Tuple::Album, false); }
+void sort_album_artist () { keyed_sort (Playlist::AlbumArtist, Tuple::AlbumArtist, false); }
 void sort_date () { ACTIVE.sort_entries (Playlist::Date); }
-void sort_genre () { ACTIVE.sort_entries (Playlist::Genre); }
+void sort_genre () { keyed_sort (Playlist::Genre, Tuple::Genre, false); }
 void sort_length () { ACTIVE.sort_entries (Playlist::Length); }
 void sort_path () { ACTIVE.sort_entries (Playlist::Path); }
 void sort_filename () { ACTIVE.sort_entries (Playlist::Filename); }
-void sort_custom_title () { ACTIVE.sort_entries (Playlist::FormattedTitle); }
-void sort_comment () { ACTIVE.sort_entries (Playlist::Comment); }
+void sort_custom_title () { keyed_sort (Playlist::FormattedTitle, Tuple::FormattedTitle, false); }
+void sort_comment () { keyed_sort (Playlist::Comment, Tuple::Comment, false); }
 void sort_disc () { ACTIVE.sort_entries (Playlist::Disc); }
 void sort_file_created () { ACTIVE.sort_entries (Playlist::FileCreated); }
 void sort_file_modified () { ACTIVE.sort_entries (Playlist::FileModified); }
@@ -46,17 +224,17 @@ void sort_reverse () { ACTIVE.reverse_order (); }
 void sort_random () { ACTIVE.randomize_order (); }
 
 void sort_sel_track () { ACTIVE.sort_selected (Playlist::Track); }
-void sort_sel_title () { ACTIVE.sort_selected (Playlist::Title); }
-void sort_sel_artist () { ACTIVE.sort_selected (Playlist::Artist); }
-void sort_sel_album () { ACTIVE.sort_selected (Playlist::Album); }
-void sort_sel_album_artist () { ACTIVE.sort_selected (Playlist::AlbumArtist); }
+void sort_sel_title () { keyed_sort (Playlist::Title, Tuple::Title, true); }
+void sort_sel_artist () { keyed_sort (Playlist::Artist, Tuple::Artist, true); }
+void sort_sel_album () { keyed_sort (Playlist::Album, Tuple::Album, true); }
+void sort_sel_album_artist () { keyed_sort (Playlist::AlbumArtist, Tuple::AlbumArtist, true); }
 void sort_sel_date () { ACTIVE.sort_selected (Playlist::Date); }
-void sort_sel_genre () { ACTIVE.sort_selected (Playlist::Genre); }
+void sort_sel_genre () { keyed_sort (Playlist::Genre, Tuple::Genre, true); }
 void sort_sel_length () { ACTIVE.sort_selected (Playlist::Length); }
 void sort_sel_path () { ACTIVE.sort_selected (Playlist::Path); }
 void sort_sel_filename () { ACTIVE.sort_selected (Playlist::Filename); }
-void sort_sel_custom_title () { ACTIVE.sort_selected (Playlist::FormattedTitle); }
-void sort_sel_comment () { ACTIVE.sort_selected (Playlist::Comment); }
+void sort_sel_custom_title () { keyed_sort (Playlist::FormattedTitle, Tuple::FormattedTitle, true); }
+void sort_sel_comment () { keyed_sort (Playlist::Comment, Tuple::Comment, true); }
 void sort_sel_disc () { ACTIVE.sort_selected (Playlist::Disc); }
 void sort_sel_file_created () { ACTIVE.sort_selected (Playlist::FileCreated); }
 void sort_sel_file_modified () { ACTIVE.sort_selected (Playlist::FileModified); }
@@ -0,0 +1,57 @@
+/*
+ * output-stats.h
+ * Copyright 2025 Audacious team
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions, and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions, and the following disclaimer in the documentation
+ *    provided with the distribution.
+ *
+ * This software is provided "as is" and without any warranty, express or
+ * implied. In no event shall the authors be liable for any damages arising from
+ * the use of this software.
+ */
+
+#ifndef OUTPUT_STATS_H
+#define OUTPUT_STATS_H
+
+#include <stdint.h>
+#include <time.h>
+
+/* Lightweight counters kept by the output plugins on their device write
+ * paths.  They are cheap enough to stay on unconditionally and can be
+ * read at any time with:
+ *
+ *     OutputStats stats;
+ *     aud_plugin_send_message (plugin, OUTPUT_STATS_QUERY, & stats,
+ *      sizeof stats);
+ *
+ * The plugin fills in the caller's struct (the message data pointer is
+ * used as an out-parameter) and returns 0.  All counts are cumulative
+ * since the plugin was loaded; callers interested in rates should take
+ * deltas between two queries. */
+
+#define OUTPUT_STATS_QUERY "get output stats"
+
+struct OutputStats
+{
+    uint64_t blocks;      /* device writes completed */
+    uint64_t frames;      /* audio frames delivered to the device */
+    uint64_t busy_ns;     /* time spent inside device writes */
+    uint64_t underruns;   /* underruns recovered from / starved cycles */
+    int buffer_fill;      /* current software buffer fill (percent) */
+};
+
+static inline uint64_t output_stats_now ()
+{
+    timespec ts;
+    clock_gettime (CLOCK_MONOTONIC, & ts);
+    return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+#endif
@@ -0,0 +1,110 @@
+/*
+ * pcm-scan.h
+ * Copyright 2025 Thomas Lange
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions, and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions, and the following disclaimer in the documentation
+ *    provided with the distribution.
+ *
+ * This software is provided "as is" and without any warranty, express or
+ * implied. In no event shall the authors be liable for any damages arising from
+ * the use of this software.
+ */
+
+#ifndef PCM_SCAN_H
+#define PCM_SCAN_H
+
+#include <math.h>
+
+#include <libaudcore/templates.h>
+
+/* Per-channel analysis scans over an interleaved PCM block, shared by
+ * the level meter plugins.  The mono and stereo cases are unrolled into
+ * contiguous loops that compilers can auto-vectorize; other channel
+ * counts fall back to a generic interleaved scan. */
+
+static inline void pcm_scan_peak (const float * pcm, int channels, int frames,
+ float * peaks)
+{
+    if (channels == 1)
+    {
+        float peak = 0;
+        for (int i = 0; i < frames; i ++)
+            peak = aud::max (peak, aud::abs (pcm[i]));
+
+        peaks[0] = peak;
+    }
+    else if (channels == 2)
+    {
+        float left = 0, right = 0;
+        for (int i = 0; i < 2 * frames; i += 2)
+        {
+            left = aud::max (left, aud::abs (pcm[i]));
+            right = aud::max (right, aud::abs (pcm[i + 1]));
+        }
+
+        peaks[0] = left;
+        peaks[1] = right;
+    }
+    else
+    {
+        for (int channel = 0; channel < channels; channel ++)
+            peaks[channel] = 0;
+
+        for (int i = 0; i < frames * channels;)
+        {
+            for (int channel = 0; channel < channels; channel ++)
+                peaks[channel] = aud::max (peaks[channel], aud::abs (pcm[i ++]));
+        }
+    }
+}
+
+static inline void pcm_scan_rms (const float * pcm, int channels, int frames,
+ float * rms)
+{
+    if (channels == 1)
+    {
+        float sum = 0;
+        for (int i = 0; i < frames; i ++)
+            sum += pcm[i] * pcm[i];
+
+        rms[0] = sqrtf (sum / frames);
+    }
+    else if (channels == 2)
+    {
+        float left = 0, right = 0;
+        for (int i = 0; i < 2 * frames; i += 2)
+        {
+            left += pcm[i] * pcm[i];
+            right += pcm[i + 1] * pcm[i + 1];
+        }
+
+        rms[0] = sqrtf (left / frames);
+        rms[1] = sqrtf (right / frames);
+    }
+    else
+    {
+        for (int channel = 0; channel < channels; channel ++)
+            rms[channel] = 0;
+
+        for (int i = 0; i < frames * channels;)
+        {
+            for (int channel = 0; channel < channels; channel ++)
+            {
+                rms[channel] += pcm[i] * pcm[i];
+                i ++;
+            }
+        }
+
+        for (int channel = 0; channel < channels; channel ++)
+            rms[channel] = sqrtf (rms[channel] / frames);
+    }
+}
+
+#endif /* PCM_SCAN_H */
@@ -18,30 +18,125 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <math.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#elif defined (__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #include <libaudcore/i18n.h>
 #include <libaudcore/plugin.h>
+#include <libaudcore/preferences.h>
+#include <libaudcore/runtime.h>
 
 class VoiceRemoval : public EffectPlugin
 {
 public:
+    static const char * const defaults[];
+    static const PreferencesWidget widgets[];
+    static const PluginPreferences prefs;
+
     static constexpr PluginInfo info = {
         N_("Voice Removal"),
-        PACKAGE
+        PACKAGE,
+        nullptr,
+        & prefs
     };
 
     constexpr VoiceRemoval () : EffectPlugin (info, 0, true) {}
 
+    bool init () override;
+
     void start (int & channels, int & rate) override;
     Index<float> & process (Index<float> & data) override;
 };
 
 EXPORT VoiceRemoval aud_plugin_instance;
 
-static int voice_channels;
+const char * const VoiceRemoval::defaults[] = {
+ "selective", "FALSE",
+ "low_cutoff", "200",
+ "high_cutoff", "6000",
+ nullptr};
+
+static int voice_channels, voice_rate;
+
+/* band-pass filter applied to the center channel in selective mode
+ * (RBJ cookbook biquad, constant 0 dB peak gain) */
+static float bp_b0, bp_b2, bp_a1, bp_a2;
+static float bp_z1, bp_z2;
+static int bp_low = -1, bp_high = -1;
+
+static void update_filter ()
+{
+    int low = aud::clamp (aud_get_int ("voice_removal", "low_cutoff"), 50, 1000);
+    int high = aud::clamp (aud_get_int ("voice_removal", "high_cutoff"),
+     low + 100, voice_rate / 2 - 1);
+
+    if (low == bp_low && high == bp_high)
+        return;
+
+    /* center frequency and Q from the band edges */
+    float f0 = sqrtf ((float) low * high);
+    float q = f0 / (high - low);
+
+    float w0 = 2 * M_PI * f0 / voice_rate;
+    float alpha = sinf (w0) / (2 * q);
+    float a0 = 1 + alpha;
+
+    bp_b0 = alpha / a0;
+    bp_b2 = -alpha / a0;
+    bp_a1 = -2 * cosf (w0) / a0;
+    bp_a2 = (1 - alpha) / a0;
+
+    bp_low = low;
+    bp_high = high;
+}
+
+bool VoiceRemoval::init ()
+{
+    aud_config_set_defaults ("voice_removal", defaults);
+    return true;
+}
 
 void VoiceRemoval::start (int & channels, int & rate)
 {
     voice_channels = channels;
+    voice_rate = rate;
+
+    bp_z1 = bp_z2 = 0;
+    bp_low = bp_high = -1;
+}
+
+/* replaces each frame with (left - right) in both channels,
+ * two frames per step where SIMD is available */
+static void cancel_center (float * f, float * end)
+{
+#ifdef __SSE2__
+    for (; f + 4 <= end; f += 4)
+    {
+        __m128 v = _mm_loadu_ps (f);
+        __m128 swapped = _mm_shuffle_ps (v, v, _MM_SHUFFLE (2, 3, 0, 1));
+        __m128 diff = _mm_sub_ps (v, swapped);
+        _mm_storeu_ps (f, _mm_shuffle_ps (diff, diff, _MM_SHUFFLE (2, 2, 0, 0)));
+    }
+#elif defined (__ARM_NEON)
+    for (; f + 8 <= end; f += 8)
+    {
+        float32x4x2_t v = vld2q_f32 (f);
+        v.val[0] = vsubq_f32 (v.val[0], v.val[1]);
+        v.val[1] = v.val[0];
+        vst2q_f32 (f, v);
+    }
+#endif
+
+    for (; f < end; f += 2)
+    {
+        f[0] -= f[1];
+        f[1] = f[0];
+    }
 }
 
 Index<float> & VoiceRemoval::process (Index<float> & data)
@@ -51,11 +146,49 @@ Index<float> & VoiceRemoval::process (Index<float> & data)
 
     float * end = data.end ();
 
+    if (! aud_get_bool ("voice_removal", "selective"))
+    {
+        cancel_center (data.begin (), end);
+        return data;
+    }
+
+    /* Frequency-selective mode: subtract only the band-passed part of the
+     * center channel, leaving bass and treble (kick, cymbals) intact.  The
+     * filter is recursive, so this loop stays scalar. */
+    update_filter ();
+
+    float z1 = bp_z1, z2 = bp_z2;
+
     for (float * f = data.begin (); f < end; f += 2)
     {
-        f[0] -= f[1];
-        f[1] = f[0];
+        float center = (f[0] + f[1]) * 0.5f;
+
+        /* transposed direct form II */
+        float band = bp_b0 * center + z1;
+        z1 = z2 - bp_a1 * band;
+        z2 = bp_b2 * center - bp_a2 * band;
+
+        f[0] -= band;
+        f[1] -= band;
     }
 
+    bp_z1 = z1;
+    bp_z2 = z2;
+
     return data;
 }
+
+const PreferencesWidget VoiceRemoval::widgets[] = {
+    WidgetCheck (N_("Remove only mid-frequency vocals"),
+        WidgetBool ("voice_removal", "selective")),
+    WidgetSpin (N_("Low cutoff:"),
+        WidgetInt ("voice_removal", "low_cutoff"),
+        {50, 1000, 10, N_("Hz")},
+        WIDGET_CHILD),
+    WidgetSpin (N_("High cutoff:"),
+        WidgetInt ("voice_removal", "high_cutoff"),
+        {300, 16000, 100, N_("Hz")},
+        WIDGET_CHILD)
+};
+
+const PluginPreferences VoiceRemoval::prefs = {{widgets}};
@@ -26,6 +26,7 @@
  */
 
 #include <glib.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
@@ -46,24 +47,171 @@ EXPORT VorbisPlugin aud_plugin_instance;
 
 static Index<char> read_image_from_comment (const char * filename, vorbis_comment * comment);
 
-static size_t ovcb_read (void * buffer, size_t size, size_t count, void * file)
+/* Background reader for network streams: keeps up to about a second of
+ * compressed data buffered ahead of the decoder, so transient transport
+ * stalls are absorbed here instead of reaching the output buffer.  Streams
+ * cannot seek, so the buffer is strictly first-in, first-out.  (The same
+ * helper exists in the Opus plugin, which shares this structure.) */
+class StreamPrefetch
 {
-    return ((VFSFile *) file)->fread (buffer, size, count);
+public:
+    void start (VFSFile & file)
+    {
+        m_file = & file;
+        m_limit = DEFAULT_LIMIT;
+        m_stop = m_eof = m_error = false;
+        m_buffer.resize (0);
+        m_drained = 0;
+
+        m_started = ! pthread_create (& m_thread, nullptr, worker, this);
+    }
+
+    void stop ()
+    {
+        if (! m_started)
+            return;
+
+        pthread_mutex_lock (& m_mutex);
+        m_stop = true;
+        pthread_cond_broadcast (& m_cond);
+        pthread_mutex_unlock (& m_mutex);
+
+        pthread_join (m_thread, nullptr);
+        m_started = false;
+        m_buffer.clear ();
+    }
+
+    /* about a second of data at the stream's bitrate */
+    void set_bitrate (int bitrate)
+    {
+        pthread_mutex_lock (& m_mutex);
+        m_limit = aud::clamp (bitrate / 8, MIN_LIMIT, MAX_LIMIT);
+        pthread_cond_broadcast (& m_cond);
+        pthread_mutex_unlock (& m_mutex);
+    }
+
+    /* same contract as fread: bytes read, 0 at EOF, -1 on error */
+    int read (void * buf, int size)
+    {
+        pthread_mutex_lock (& m_mutex);
+
+        while (! buffered () && ! m_eof && ! m_error && ! m_stop)
+            pthread_cond_wait (& m_cond, & m_mutex);
+
+        int copy = aud::min (size, buffered ());
+        if (copy > 0)
+        {
+            memcpy (buf, & m_buffer[m_drained], copy);
+            m_drained += copy;
+
+            /* reclaim the drained prefix once in a while */
+            if (m_drained >= m_limit)
+            {
+                m_buffer.remove (0, m_drained);
+                m_drained = 0;
+            }
+
+            pthread_cond_broadcast (& m_cond);
+        }
+
+        bool error = m_error;
+        pthread_mutex_unlock (& m_mutex);
+
+        return (! copy && error) ? -1 : copy;
+    }
+
+private:
+    static constexpr int CHUNK = 16384;
+    static constexpr int MIN_LIMIT = 64 * 1024;
+    static constexpr int DEFAULT_LIMIT = 256 * 1024;
+    static constexpr int MAX_LIMIT = 1024 * 1024;
+
+    int buffered () const { return m_buffer.len () - m_drained; }
+
+    static void * worker (void * data)
+    {
+        auto * p = (StreamPrefetch *) data;
+        char chunk[CHUNK];
+
+        while (1)
+        {
+            pthread_mutex_lock (& p->m_mutex);
+
+            while (p->buffered () >= p->m_limit && ! p->m_stop)
+                pthread_cond_wait (& p->m_cond, & p->m_mutex);
+
+            bool stop = p->m_stop;
+            pthread_mutex_unlock (& p->m_mutex);
+
+            if (stop)
+                break;
+
+            /* the (possibly slow) transport read happens unlocked */
+            int64_t got = p->m_file->fread (chunk, 1, sizeof chunk);
+
+            pthread_mutex_lock (& p->m_mutex);
+
+            if (got > 0)
+                p->m_buffer.insert (chunk, -1, got);
+            else if (got == 0)
+                p->m_eof = true;
+            else
+                p->m_error = true;
+
+            pthread_cond_broadcast (& p->m_cond);
+            bool done = p->m_eof || p->m_error;
+            pthread_mutex_unlock (& p->m_mutex);
+
+            if (done)
+                break;
+        }
+
+        return nullptr;
+    }
+
+    VFSFile * m_file = nullptr;
+    Index<char> m_buffer;
+    int m_drained = 0;
+    int m_limit = DEFAULT_LIMIT;
+    bool m_stop = false, m_eof = false, m_error = false, m_started = false;
+    pthread_t m_thread;
+    pthread_mutex_t m_mutex = PTHREAD_MUTEX_INITIALIZER;
+    pthread_cond_t m_cond = PTHREAD_COND_INITIALIZER;
+};
+
+/* handle passed to the vorbisfile callbacks */
+struct VorbisReader
+{
+    VFSFile * file;
+    StreamPrefetch * prefetch; /* only set for network streams */
+};
+
+static size_t ovcb_read (void * buffer, size_t size, size_t count, void * handle)
+{
+    VorbisReader * reader = (VorbisReader *) handle;
+
+    if (reader->prefetch)
+    {
+        int64_t bytes = reader->prefetch->read (buffer, size * count);
+        return (bytes > 0 && size > 0) ? bytes / size : 0;
+    }
+
+    return reader->file->fread (buffer, size, count);
 }
 
-static int ovcb_seek (void * file, ogg_int64_t offset, int whence)
+static int ovcb_seek (void * handle, ogg_int64_t offset, int whence)
 {
-    return ((VFSFile *) file)->fseek (offset, to_vfs_seek_type (whence));
+    return ((VorbisReader *) handle)->file->fseek (offset, to_vfs_seek_type (whence));
 }
 
-static int ovcb_close (void * file)
+static int ovcb_close (void * handle)
 {
     return 0;
 }
 
-static long ovcb_tell (void * file)
+static long ovcb_tell (void * handle)
 {
-    return ((VFSFile *) file)->ftell ();
+    return ((VorbisReader *) handle)->file->ftell ();
 }
 
 ov_callbacks vorbis_callbacks = {
@@ -257,7 +405,16 @@ bool VorbisPlugin::play (const char * filename, VFSFile & file)
     bool stream = (file.fsize () < 0);
     bool error = false;
 
-    if (ov_open_callbacks (& file, & vf, nullptr, 0, stream ?
+    StreamPrefetch prefetch;
+    VorbisReader reader = {& file, nullptr};
+
+    if (stream)
+    {
+        prefetch.start (file);
+        reader.prefetch = & prefetch;
+    }
+
+    if (ov_open_callbacks (& reader, & vf, nullptr, 0, stream ?
      vorbis_callbacks_stream : vorbis_callbacks) < 0)
     {
         error = true;
@@ -272,6 +429,9 @@ bool VorbisPlugin::play (const char * filename, VFSFile & file)
 
     set_stream_bitrate (br);
 
+    if (stream)
+        prefetch.set_bitrate (br > 0 ? br : 128000);
+
     if (update_tuple (& vf, tuple))
         set_playback_tuple (tuple.ref ());
 
@@ -344,6 +504,7 @@ bool VorbisPlugin::play (const char * filename, VFSFile & file)
 play_cleanup:
 
     ov_clear(&vf);
+    prefetch.stop ();
     return ! error;
 }
 
@@ -353,13 +514,14 @@ bool VorbisPlugin::read_tag (const char * filename, VFSFile & file,
     OggVorbis_File vfile;
 
     bool stream = (file.fsize () < 0);
+    VorbisReader reader = {& file, nullptr};
 
     /*
      * The open function performs full stream detection and
      * machine initialization.  If it returns zero, the stream
      * *is* Vorbis and we're fully ready to decode.
      */
-    if (ov_open_callbacks (& file, & vfile, nullptr, 0, stream ?
+    if (ov_open_callbacks (& reader, & vfile, nullptr, 0, stream ?
      vorbis_callbacks_stream : vorbis_callbacks) < 0)
         return false;
 
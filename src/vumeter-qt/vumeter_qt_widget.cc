@@ -23,6 +23,8 @@
 #include <math.h>
 #include <libaudcore/runtime.h>
 
+#include "../ui-common/pcm-scan.h"
+
 const QColor VUMeterQtWidget::backgroundColor = QColor(16, 16, 16, 255);
 const QColor VUMeterQtWidget::text_color = QColor(255, 255, 255);
 const QColor VUMeterQtWidget::db_line_color = QColor(120, 120, 120);
@@ -72,19 +74,8 @@ void VUMeterQtWidget::render_multi_pcm (const float * pcm, int channels)
 {
     nchannels = aud::clamp(channels, 1, max_channels);
 
-    float * peaks = new float[nchannels];
-    for (int channel = 0; channel < nchannels; channel++)
-    {
-        peaks[channel] = fabsf(pcm[channel]);
-    }
-
-    for (int i = 0; i < 512 * nchannels;)
-    {
-        for (int channel = 0; channel < nchannels; channel++)
-        {
-            peaks[channel] = fmaxf(peaks[channel], fabsf(pcm[i++]));
-        }
-    }
+    float peaks[max_channels];
+    pcm_scan_peak(pcm, nchannels, 512, peaks);
 
     for (int i = 0; i < nchannels; i++)
     {
@@ -102,8 +93,6 @@ void VUMeterQtWidget::render_multi_pcm (const float * pcm, int channels)
             last_peak_times[i].start();
         }
     }
-
-    delete[] peaks;
 }
 
 void VUMeterQtWidget::redraw_timer_expired()
@@ -125,7 +114,26 @@ void VUMeterQtWidget::redraw_timer_expired()
         }
     }
 
-    update();
+    // repaint only when a displayed level or peak moves by at least
+    // one pixel; a silent or steady signal costs nothing
+    bool moved = false;
+    for (int i = 0; i < nchannels; i++)
+    {
+        int level_y = (int) get_y_from_db(channels_db_level[i]);
+        int peak_y = (int) get_y_from_db(channels_peaks[i]);
+
+        if (level_y != drawn_level_y[i] || peak_y != drawn_peak_y[i])
+        {
+            drawn_level_y[i] = level_y;
+            drawn_peak_y[i] = peak_y;
+            moved = true;
+        }
+    }
+
+    if (moved)
+    {
+        update();
+    }
 }
 
 void VUMeterQtWidget::reset()
@@ -135,6 +143,8 @@ void VUMeterQtWidget::reset()
         last_peak_times[i].start();
         channels_db_level[i] = -db_range;
         channels_peaks[i] = -db_range;
+        drawn_level_y[i] = -1;
+        drawn_peak_y[i] = -1;
     }
 }
 
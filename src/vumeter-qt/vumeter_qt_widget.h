@@ -44,6 +44,8 @@ private:
     int nchannels = 2;
     float channels_db_level[max_channels];
     float channels_peaks[max_channels];
+    int drawn_level_y[max_channels]; // level positions as last drawn, in pixels
+    int drawn_peak_y[max_channels];
     QElapsedTimer last_peak_times[max_channels]; // Time elapsed since peak was set
     QLinearGradient vumeter_pattern;
     QLinearGradient background_vumeter_pattern;
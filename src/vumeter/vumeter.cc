@@ -31,6 +31,8 @@
 #include <libaudcore/runtime.h>
 #include <libaudgui/gtk-compat.h>
 
+#include "../ui-common/pcm-scan.h"
+
 #define CFG_ID "vumeter"
 #define MAX_CHANNELS 20
 #define DB_RANGE 96
@@ -108,6 +110,14 @@ static float channels_peaks[MAX_CHANNELS];
 static gint64 last_peak_times[MAX_CHANNELS]; // Time elapsed since peak was set
 static gint64 last_render_time = 0;
 
+/* meter gradients, rebuilt only when the geometry changes */
+static cairo_pattern_t * meter_pattern = nullptr;
+static cairo_pattern_t * meter_pattern_background = nullptr;
+
+/* level and peak positions as last drawn, in pixels */
+static int drawn_level_y[MAX_CHANNELS];
+static int drawn_peak_y[MAX_CHANNELS];
+
 static void update_sizes ()
 {
     if (aud_get_bool (CFG_ID, "display_legend"))
@@ -126,6 +136,18 @@ static void update_sizes ()
         vumeter_width = (float) width / nchannels;
         vumeter_height = height;
     }
+
+    if (meter_pattern)
+    {
+        cairo_pattern_destroy (meter_pattern);
+        meter_pattern = nullptr;
+    }
+
+    if (meter_pattern_background)
+    {
+        cairo_pattern_destroy (meter_pattern_background);
+        meter_pattern_background = nullptr;
+    }
 }
 
 static float get_db_on_range (float db)
@@ -175,22 +197,18 @@ void VUMeter::render_multi_pcm (const float * pcm, int channels)
     float falloff = aud_get_double (CFG_ID, "falloff") / 1000000.0;
     gint64 peak_hold_time = aud_get_double (CFG_ID, "peak_hold_time") * 1000000;
 
+    bool moved = false;
+
     channels = aud::clamp (channels, 1, MAX_CHANNELS);
     if (nchannels != channels)
     {
         nchannels = channels;
         update_sizes ();
+        moved = true;
     }
 
-    float * peaks = new float[nchannels];
-    for (int channel = 0; channel < nchannels; channel ++)
-        peaks[channel] = aud::abs (pcm[channel]);
-
-    for (int i = 0; i < 512 * nchannels;)
-    {
-        for (int channel = 0; channel < nchannels; channel ++)
-            peaks[channel] = aud::max (peaks[channel], aud::abs (pcm[i ++]));
-    }
+    float peaks[MAX_CHANNELS];
+    pcm_scan_peak (pcm, nchannels, 512, peaks);
 
     for (int i = 0; i < nchannels; i ++)
     {
@@ -207,11 +225,21 @@ void VUMeter::render_multi_pcm (const float * pcm, int channels)
             channels_peaks[i] = channels_db_level[i];
             last_peak_times[i] = g_get_monotonic_time ();
         }
-    }
 
-    delete[] peaks;
+        /* repaint only when the displayed level or peak moves by at
+         * least one pixel; a silent or steady signal costs nothing */
+        int level_y = (int) get_y_from_db (channels_db_level[i]);
+        int peak_y = (int) get_y_from_db (channels_peaks[i]);
 
-    if (spect_widget)
+        if (level_y != drawn_level_y[i] || peak_y != drawn_peak_y[i])
+        {
+            drawn_level_y[i] = level_y;
+            drawn_peak_y[i] = peak_y;
+            moved = true;
+        }
+    }
+
+    if (moved && spect_widget)
         gtk_widget_queue_draw (spect_widget);
 }
 
@@ -224,6 +252,12 @@ static void reset_variables ()
     }
 
     memset (last_peak_times, 0, sizeof last_peak_times);
+
+    for (int i = 0; i < MAX_CHANNELS; i ++)
+    {
+        drawn_level_y[i] = -1;
+        drawn_peak_y[i] = -1;
+    }
 }
 
 bool VUMeter::init ()
@@ -329,8 +363,10 @@ static cairo_pattern_t * get_meter_pattern (float alpha)
 
 static void draw_visualizer (cairo_t * cr)
 {
-    cairo_pattern_t * meter_pattern = get_meter_pattern (1.0);
-    cairo_pattern_t * meter_pattern_background = get_meter_pattern (0.1);
+    if (! meter_pattern)
+        meter_pattern = get_meter_pattern (1.0);
+    if (! meter_pattern_background)
+        meter_pattern_background = get_meter_pattern (0.1);
 
     for (int i = 0; i < nchannels; i ++)
     {
@@ -359,9 +395,6 @@ static void draw_visualizer (cairo_t * cr)
             cairo_fill (cr);
         }
     }
-
-    cairo_pattern_destroy (meter_pattern_background);
-    cairo_pattern_destroy (meter_pattern);
 }
 
 static StringBuf format_db (const float val)
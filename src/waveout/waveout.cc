@@ -19,6 +19,7 @@
 
 #include <assert.h>
 #include <pthread.h>
+#include <string.h>
 
 #include <windows.h>
 
@@ -83,9 +84,14 @@ static HWAVEOUT device;
 static bool prebuffer_flag, paused_flag;
 static int64_t total_frames;
 
-// guarded by buffer_mutex
+// guarded by buffer_mutex.  The audio is coalesced into a fixed arena of
+// NUM_BLOCKS large blocks, carved out and prepared once per stream; only a
+// full (or final partial) block is handed to waveOutWrite, so the per-header
+// prepare/write/callback overhead is paid once per block rather than once per
+// write_audio call.
 static Index<WAVEHDR> headers;
-static Index<Index<char>> blocks;
+static Index<char> arena;
+static int block_used[NUM_BLOCKS];
 static int next_block, blocks_free;
 
 StereoVolume WaveOut::get_volume ()
@@ -112,7 +118,7 @@ static void CALLBACK callback (HWAVEOUT, UINT uMsg, DWORD_PTR, DWORD_PTR, DWORD_
 
     assert (blocks_free < NUM_BLOCKS);
     int old_block = (next_block + blocks_free) % NUM_BLOCKS;
-    blocks[old_block].resize (0);
+    block_used[old_block] = 0;
     blocks_free ++;
 
     pthread_cond_broadcast (& buffer_cond);
@@ -156,7 +162,17 @@ bool WaveOut::open_audio (int format, int rate, int chan, String & error)
     block_size = FMT_SIZEOF (format) * chan * aud::rescale (block_ms, 1000, rate);
 
     headers.insert (0, NUM_BLOCKS);
-    blocks.insert (0, NUM_BLOCKS);
+    arena.insert (0, NUM_BLOCKS * block_size);
+
+    for (int b = 0; b < NUM_BLOCKS; b ++)
+    {
+        WAVEHDR & header = headers[b];
+        header.lpData = & arena[b * block_size];
+        header.dwBufferLength = block_size;
+        waveOutPrepareHeader (device, & header, sizeof header);
+
+        block_used[b] = 0;
+    }
 
     next_block = 0;
     blocks_free = NUM_BLOCKS;
@@ -173,10 +189,14 @@ void WaveOut::close_audio ()
 {
     AUDDBG ("Closing audio.\n");
     flush ();
+
+    for (auto & header : headers)
+        waveOutUnprepareHeader (device, & header, sizeof header);
+
     waveOutClose (device);
 
     headers.clear ();
-    blocks.clear ();
+    arena.clear ();
 }
 
 void WaveOut::period_wait ()
@@ -192,13 +212,10 @@ void WaveOut::period_wait ()
 // assumes state_mutex locked
 static void write_block (int b)
 {
+    // the header was prepared for a full block; a shorter length is allowed
     WAVEHDR & header = headers[b];
-    Index<char> & block = blocks[b];
-
-    header.lpData = block.begin ();
-    header.dwBufferLength = block.len ();
+    header.dwBufferLength = block_used[b];
 
-    waveOutPrepareHeader (device, & header, sizeof header);
     waveOutWrite (device, & header, sizeof header);
 }
 
@@ -225,11 +242,12 @@ int WaveOut::write_audio (const void * data, int len)
     {
         int block_to_write = -1;
 
-        Index<char> & block = blocks[next_block];
-        int copy = aud::min (len, block_size - block.len ());
-        block.insert ((const char *) data, -1, copy);
+        int used = block_used[next_block];
+        int copy = aud::min (len, block_size - used);
+        memcpy (& arena[next_block * block_size + used], data, copy);
+        block_used[next_block] = used + copy;
 
-        if (block.len () == block_size)
+        if (block_used[next_block] == block_size)
         {
             block_to_write = next_block;
             next_block = (next_block + 1) % NUM_BLOCKS;
@@ -269,7 +287,7 @@ void WaveOut::drain ()
     int block_to_write = -1;
 
     // write last partial block, if any
-    if (blocks_free > 0 && blocks[next_block].len () > 0)
+    if (blocks_free > 0 && block_used[next_block] > 0)
     {
         block_to_write = next_block;
         next_block = (next_block + 1) % NUM_BLOCKS;
@@ -339,10 +357,9 @@ void WaveOut::flush ()
 
     pthread_mutex_lock (& buffer_mutex);
 
-    for (auto & header : headers)
-        waveOutUnprepareHeader (device, & header, sizeof header);
-    for (auto & block : blocks)
-        block.resize (0);
+    // headers stay prepared for the life of the stream
+    for (int b = 0; b < NUM_BLOCKS; b ++)
+        block_used[b] = 0;
 
     next_block = 0;
     blocks_free = NUM_BLOCKS;
@@ -1,3 +1,4 @@
+#include <pthread.h>
 #include <stdlib.h>
 
 #include <wavpack/wavpack.h>
@@ -114,6 +115,86 @@ static void wv_deattach (WavpackContext * ctx)
     WavpackCloseFile (ctx);
 }
 
+/* Two-block decode pipeline: WavPack blocks are independently decodable, so
+ * a helper thread unpacks the next block while the playback thread converts
+ * and outputs the previous one.  The helper owns the WavpackContext; seeks
+ * are forwarded to it so the context is never touched from two threads. */
+
+static pthread_mutex_t wv_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wv_cond = PTHREAD_COND_INITIALIZER;
+
+static WavpackContext * wv_ctx;
+static unsigned wv_num_samples;
+static Index<int32_t> wv_slot_data[2];
+static int wv_slot_samples[2];
+static bool wv_slot_full[2];
+static int wv_head, wv_tail;       /* decoder fills head, playback drains tail */
+static int64_t wv_seek_request;    /* sample index, -1 = none */
+static bool wv_quit, wv_eof, wv_error;
+
+static void * unpack_worker (void *)
+{
+    pthread_mutex_lock (& wv_mutex);
+
+    while (! wv_quit)
+    {
+        if (wv_seek_request >= 0)
+        {
+            int64_t sample = wv_seek_request;
+            wv_seek_request = -1;
+
+            /* drop blocks decoded before the seek */
+            wv_slot_full[0] = wv_slot_full[1] = false;
+            wv_head = wv_tail = 0;
+            wv_eof = wv_error = false;
+
+            pthread_mutex_unlock (& wv_mutex);
+            WavpackSeekSample (wv_ctx, sample);
+            pthread_mutex_lock (& wv_mutex);
+
+            pthread_cond_broadcast (& wv_cond);
+            continue;
+        }
+
+        if (wv_eof || wv_error || wv_slot_full[wv_head])
+        {
+            pthread_cond_wait (& wv_cond, & wv_mutex);
+            continue;
+        }
+
+        int slot = wv_head;
+        pthread_mutex_unlock (& wv_mutex);
+
+        unsigned samples_left = wv_num_samples - WavpackGetSampleIndex (wv_ctx);
+        int ret = 0;
+
+        if (samples_left > 0)
+            ret = WavpackUnpackSamples (wv_ctx, wv_slot_data[slot].begin (), BUFFER_SIZE);
+
+        pthread_mutex_lock (& wv_mutex);
+
+        /* a seek arrived while unpacking; this block is stale */
+        if (wv_seek_request >= 0)
+            continue;
+
+        if (ret < 0)
+            wv_error = true;
+        else if (! ret)
+            wv_eof = true;
+        else
+        {
+            wv_slot_samples[slot] = ret;
+            wv_slot_full[slot] = true;
+            wv_head = ! slot;
+        }
+
+        pthread_cond_broadcast (& wv_cond);
+    }
+
+    pthread_mutex_unlock (& wv_mutex);
+    return nullptr;
+}
+
 bool WavpackPlugin::play (const char * filename, VFSFile & file)
 {
     VFSFile wvc_input;
@@ -137,60 +218,107 @@ bool WavpackPlugin::play (const char * filename, VFSFile & file)
     else
         open_audio (SAMPLE_FMT (bits_per_sample), sample_rate, num_channels);
 
-    Index<int32_t> input;
-    input.resize (BUFFER_SIZE * num_channels);
-
     Index<char> output;
     output.resize (BUFFER_SIZE * num_channels * SAMPLE_SIZE (bits_per_sample));
 
+    /* set up the decode pipeline */
+    wv_ctx = ctx;
+    wv_num_samples = num_samples;
+    wv_slot_data[0].resize (BUFFER_SIZE * num_channels);
+    wv_slot_data[1].resize (BUFFER_SIZE * num_channels);
+    wv_slot_full[0] = wv_slot_full[1] = false;
+    wv_head = wv_tail = 0;
+    wv_seek_request = -1;
+    wv_quit = wv_eof = wv_error = false;
+
+    pthread_t worker;
+    bool threaded = ! pthread_create (& worker, nullptr, unpack_worker, nullptr);
+
+    if (! threaded)
+    {
+        AUDERR ("Error starting decode thread.\n");
+        wv_deattach (ctx);
+        return false;
+    }
+
     while (! check_stop ())
     {
         int seek_value = check_seek ();
-        if (seek_value >= 0)
-            WavpackSeekSample (ctx, (int64_t) seek_value * sample_rate / 1000);
 
-        /* Decode audio data */
-        unsigned samples_left = num_samples - WavpackGetSampleIndex (ctx);
+        pthread_mutex_lock (& wv_mutex);
 
-        if (samples_left == 0)
-            break;
+        if (seek_value >= 0)
+        {
+            wv_seek_request = (int64_t) seek_value * sample_rate / 1000;
+            pthread_cond_broadcast (& wv_cond);
+        }
 
-        int ret = WavpackUnpackSamples (ctx, input.begin (), BUFFER_SIZE);
+        while (wv_seek_request >= 0 ||
+         (! wv_slot_full[wv_tail] && ! wv_eof && ! wv_error))
+            pthread_cond_wait (& wv_cond, & wv_mutex);
 
-        if (ret < 0)
+        if (wv_error)
         {
+            pthread_mutex_unlock (& wv_mutex);
             AUDERR ("Error decoding file.\n");
             break;
         }
+
+        if (! wv_slot_full[wv_tail])
+        {
+            /* end of file */
+            pthread_mutex_unlock (& wv_mutex);
+            break;
+        }
+
+        int slot = wv_tail;
+        int ret = wv_slot_samples[slot];
+        pthread_mutex_unlock (& wv_mutex);
+
+        /* Perform audio data conversion and output; meanwhile the helper
+         * thread is already unpacking the other slot */
+        int32_t * rp = wv_slot_data[slot].begin ();
+        int8_t * wp = (int8_t *) output.begin ();
+        int16_t * wp2 = (int16_t *) output.begin ();
+        int32_t * wp4 = (int32_t *) output.begin ();
+
+        if (bits_per_sample <= 8)
+        {
+            for (int i = 0; i < ret * num_channels; i++, wp++, rp++)
+                * wp = * rp & 0xff;
+        }
+        else if (bits_per_sample <= 16)
+        {
+            for (int i = 0; i < ret * num_channels; i++, wp2++, rp++)
+                * wp2 = * rp & 0xffff;
+        }
         else
         {
-            /* Perform audio data conversion and output */
-            int32_t * rp = input.begin ();
-            int8_t * wp = (int8_t *) output.begin ();
-            int16_t * wp2 = (int16_t *) output.begin ();
-            int32_t * wp4 = (int32_t *) output.begin ();
-
-            if (bits_per_sample <= 8)
-            {
-                for (int i = 0; i < ret * num_channels; i++, wp++, rp++)
-                    * wp = * rp & 0xff;
-            }
-            else if (bits_per_sample <= 16)
-            {
-                for (int i = 0; i < ret * num_channels; i++, wp2++, rp++)
-                    * wp2 = * rp & 0xffff;
-            }
-            else
-            {
-                for (int i = 0; i < ret * num_channels; i++, wp4++, rp++)
-                    * wp4 = * rp;
-            }
-
-            write_audio (output.begin (),
-             ret * num_channels * SAMPLE_SIZE (bits_per_sample));
+            for (int i = 0; i < ret * num_channels; i++, wp4++, rp++)
+                * wp4 = * rp;
         }
+
+        write_audio (output.begin (),
+         ret * num_channels * SAMPLE_SIZE (bits_per_sample));
+
+        pthread_mutex_lock (& wv_mutex);
+        wv_slot_full[slot] = false;
+        wv_tail = ! slot;
+        pthread_cond_broadcast (& wv_cond);
+        pthread_mutex_unlock (& wv_mutex);
     }
 
+    pthread_mutex_lock (& wv_mutex);
+    wv_quit = true;
+    pthread_cond_broadcast (& wv_cond);
+    pthread_mutex_unlock (& wv_mutex);
+
+    pthread_join (worker, nullptr);
+
+    wv_slot_data[0].clear ();
+    wv_slot_data[1].clear ();
+    wv_ctx = nullptr;
+
     wv_deattach (ctx);
     return true;
 }
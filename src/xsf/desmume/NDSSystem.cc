@@ -23,6 +23,7 @@
 #include <zlib.h>
 #include "NDSSystem.h"
 #include "MMU.h"
+#include "armcpu_exec.h"
 #include "cp15.h"
 #include "bios.h"
 #include "readwrite.h"
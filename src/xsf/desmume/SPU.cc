@@ -1296,6 +1296,41 @@ static void SPU_MixAudio_Advanced(bool actuallyMix, SPU_struct *SPU, int length)
   SPU->sndbuf[1] = samp0[1];
 }
 
+//this mixes channel-major: each playing channel runs its specialized
+//fetch+interpolate+pan loop over the whole block before the next channel is
+//touched, accumulating into sndbuf.  it produces the same mix as the advanced
+//path whenever the capture units, the ch1/ch3 output routing and the bypass
+//bits are idle, at a fraction of the per-sample dispatch cost.
+static void SPU_MixAudio_Classic(bool actuallyMix, SPU_struct *SPU, int length)
+{
+  for (int i = 0; i < 16; i++)
+  {
+    channel_struct *chan = &SPU->channels[i];
+
+    if (chan->status != CHANSTAT_PLAY)
+      continue;
+
+    SPU->bufpos = 0;
+    SPU->buflength = length;
+
+    _SPU_ChanUpdate(actuallyMix && !CommonSettings.spu_muteChannels[i], SPU, chan);
+  }
+}
+
+//do we need the sample-at-a-time mixer, or can the block mixer above stand in?
+static bool SPU_NeedAdvancedMix(SPU_struct *SPU)
+{
+  if (SPU->regs.cap[0].runtime.running || SPU->regs.cap[1].runtime.running)
+    return true;
+  if (SPU->regs.ctl_ch1bypass || SPU->regs.ctl_ch3bypass)
+    return true;
+  if (SPU->regs.ctl_left != SPU_struct::REGS::LOM_LEFT_MIXER)
+    return true;
+  if (SPU->regs.ctl_right != SPU_struct::REGS::ROM_RIGHT_MIXER)
+    return true;
+  return false;
+}
+
 //ENTER
 static void SPU_MixAudio(bool actuallyMix, SPU_struct *SPU, int length)
 {
@@ -1305,7 +1340,10 @@ static void SPU_MixAudio(bool actuallyMix, SPU_struct *SPU, int length)
     memset(SPU->outbuf, 0, length*2*2);
   }
 
-  SPU_MixAudio_Advanced(actuallyMix, SPU, length);
+  if (SPU_NeedAdvancedMix(SPU))
+    SPU_MixAudio_Advanced(actuallyMix, SPU, length);
+  else
+    SPU_MixAudio_Classic(actuallyMix, SPU, length);
 
   //we used to bail out if speakers were disabled.
   //this is technically wrong. sound may still be captured, or something.
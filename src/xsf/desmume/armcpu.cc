@@ -26,12 +26,11 @@
 #include "bios.h"
 #include "NDSSystem.h"
 #include "MMU_timing.h"
+#include "armcpu_exec.h"
 #ifdef HAVE_LUA
 #include "lua-engine.h"
 #endif
 
-template<uint32_t> static uint32_t armcpu_prefetch();
-
 static inline uint32_t armcpu_prefetch(armcpu_t *armcpu)
 {
 	if (!armcpu->proc_ID)
@@ -193,43 +192,6 @@ uint32_t armcpu_Wait4IRQ(armcpu_t *cpu)
 	return 1;
 }
 
-template<uint32_t PROCNUM> static inline uint32_t armcpu_prefetch()
-{
-	armcpu_t *const armcpu = &ARMPROC;
-	uint32_t curInstruction = armcpu->next_instruction;
-
-	if (!armcpu->CPSR.bits.T)
-	{
-		curInstruction &= 0xFFFFFFFC; // please don't change this to 0x0FFFFFFC -- the NDS will happily run on 0xF******* addresses all day long
-		// please note that we must setup R[15] before reading the instruction since there is a protection
-		// which prevents PC > 0x3FFF from reading the bios region
-		armcpu->instruct_adr = curInstruction;
-		armcpu->next_instruction = curInstruction + 4;
-		armcpu->R[15] = curInstruction + 8;
-		armcpu->instruction = _MMU_read32<PROCNUM, MMU_AT_CODE>(curInstruction);
-
-		return MMU_codeFetchCycles<PROCNUM, 32>(curInstruction);
-	}
-	curInstruction &= 0xFFFFFFFE; // please don't change this to 0x0FFFFFFE -- the NDS will happily run on 0xF******* addresses all day long
-	// please note that we must setup R[15] before reading the instruction since there is a protection
-	// which prevents PC > 0x3FFF from reading the bios region
-	armcpu->instruct_adr = curInstruction;
-	armcpu->next_instruction = curInstruction + 2;
-	armcpu->R[15] = curInstruction + 4;
-	armcpu->instruction = _MMU_read16<PROCNUM, MMU_AT_CODE>(curInstruction);
-
-	if (!PROCNUM)
-	{
-		// arm9 fetches 2 instructions at a time in thumb mode
-		if (!(curInstruction == armcpu->instruct_adr + 2 && (curInstruction & 2)))
-			return MMU_codeFetchCycles<PROCNUM, 32>(curInstruction);
-		else
-			return 0;
-	}
-
-	return MMU_codeFetchCycles<PROCNUM, 16>(curInstruction);
-}
-
 // TODO - merge with armcpu_irqException?
 // http://www.ethernut.de/en/documents/arm-exceptions.html
 // http://docs.google.com/viewer?a=v&q=cache:V4ht1YkxprMJ:www.cs.nctu.edu.tw/~wjtsai/EmbeddedSystemDesign/Ch3-1.pdf+arm+exception+handling&hl=en&gl=us&pid=bl&srcid=ADGEEShx9VTHbUhWdDOrTVRzLkcCsVfJiijncNDkkgkrlJkLa7D0LCpO8fQ_hhU3DTcgZh9rcZWWQq4TYhhCovJ625h41M0ZUX3WGasyzWQFxYzDCB-VS6bsUmpoJnRxAc-bdkD0qmsu&sig=AHIEtbR9VHvDOCRmZFQDUVwy53iJDjoSPQ
@@ -313,48 +275,6 @@ uint32_t TRAPUNDEF(armcpu_t *cpu)
 	}
 }
 
-template<int PROCNUM> uint32_t armcpu_exec()
-{
-	// Usually, fetching and executing are processed parallelly.
-	// So this function stores the cycles of each process to
-	// the variables below, and returns appropriate cycle count.
-	uint32_t cFetch = 0;
-	uint32_t cExecute = 0;
-
-	// this assert is annoying. but sometimes it is handy.
-	//assert(ARMPROC.instruct_adr!=0x00000000);
-
-	//cFetch = armcpu_prefetch(&ARMPROC);
-
-	//fprintf(stderr, "%d: %08X\n",PROCNUM,ARMPROC.instruct_adr);
-
-	if (!ARMPROC.CPSR.bits.T)
-	{
-		if (
-			CONDITION(ARMPROC.instruction) == 0x0E  // fast path for unconditional instructions
-			|| (TEST_COND(CONDITION(ARMPROC.instruction), CODE(ARMPROC.instruction), ARMPROC.CPSR)) // handles any condition
-		)
-		{
-#ifdef HAVE_LUA
-			CallRegisteredLuaMemHook(ARMPROC.instruct_adr, 4, ARMPROC.instruction, LUAMEMHOOK_EXEC); // should report even if condition=false?
-#endif
-			cExecute = arm_instructions_set[PROCNUM][INSTRUCTION_INDEX(ARMPROC.instruction)](ARMPROC.instruction);
-		}
-		else
-			cExecute = 1; // If condition=false: 1S cycle
-		cFetch = armcpu_prefetch<PROCNUM>();
-		return MMU_fetchExecuteCycles<PROCNUM>(cExecute, cFetch);
-	}
-
-#ifdef HAVE_LUA
-	CallRegisteredLuaMemHook(ARMPROC.instruct_adr, 2, ARMPROC.instruction, LUAMEMHOOK_EXEC);
-#endif
-	cExecute = thumb_instructions_set[PROCNUM][ARMPROC.instruction>>6](ARMPROC.instruction);
-
-	cFetch = armcpu_prefetch<PROCNUM>();
-	return MMU_fetchExecuteCycles<PROCNUM>(cExecute, cFetch);
-}
-
 // these templates needed to be instantiated manually
 template uint32_t armcpu_exec<0>();
 template uint32_t armcpu_exec<1>();
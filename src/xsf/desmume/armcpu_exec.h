@@ -0,0 +1,113 @@
+/*
+	Copyright (C) 2006 yopyop
+	Copyright (C) 2006-2015 DeSmuME team
+
+	This file is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 2 of the License, or
+	(at your option) any later version.
+
+	This file is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with the this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ARMCPU_EXEC_H
+#define ARMCPU_EXEC_H
+
+// The fetch/dispatch hot path, in a header of its own so that the scheduler's
+// inner loop (armInnerLoop in NDSSystem.cc) can inline it.  When these lived
+// in armcpu.cc every emulated instruction paid a cross-module call on top of
+// the handler dispatch; inlined, the compiler keeps the condition test, the
+// prefetch and the cycle accounting in registers around the handler call.
+
+#include "armcpu.h"
+#include "instructions.h"
+#include "MMU.h"
+#include "MMU_timing.h"
+#ifdef HAVE_LUA
+#include "lua-engine.h"
+#endif
+
+template<uint32_t PROCNUM> inline uint32_t armcpu_prefetch()
+{
+	armcpu_t *const armcpu = &ARMPROC;
+	uint32_t curInstruction = armcpu->next_instruction;
+
+	if (!armcpu->CPSR.bits.T)
+	{
+		curInstruction &= 0xFFFFFFFC; // please don't change this to 0x0FFFFFFC -- the NDS will happily run on 0xF******* addresses all day long
+		// please note that we must setup R[15] before reading the instruction since there is a protection
+		// which prevents PC > 0x3FFF from reading the bios region
+		armcpu->instruct_adr = curInstruction;
+		armcpu->next_instruction = curInstruction + 4;
+		armcpu->R[15] = curInstruction + 8;
+		armcpu->instruction = _MMU_read32<PROCNUM, MMU_AT_CODE>(curInstruction);
+
+		return MMU_codeFetchCycles<PROCNUM, 32>(curInstruction);
+	}
+	curInstruction &= 0xFFFFFFFE; // please don't change this to 0x0FFFFFFE -- the NDS will happily run on 0xF******* addresses all day long
+	// please note that we must setup R[15] before reading the instruction since there is a protection
+	// which prevents PC > 0x3FFF from reading the bios region
+	armcpu->instruct_adr = curInstruction;
+	armcpu->next_instruction = curInstruction + 2;
+	armcpu->R[15] = curInstruction + 4;
+	armcpu->instruction = _MMU_read16<PROCNUM, MMU_AT_CODE>(curInstruction);
+
+	if (!PROCNUM)
+	{
+		// arm9 fetches 2 instructions at a time in thumb mode
+		if (!(curInstruction == armcpu->instruct_adr + 2 && (curInstruction & 2)))
+			return MMU_codeFetchCycles<PROCNUM, 32>(curInstruction);
+		else
+			return 0;
+	}
+
+	return MMU_codeFetchCycles<PROCNUM, 16>(curInstruction);
+}
+
+template<int PROCNUM> inline uint32_t armcpu_exec()
+{
+	// Usually, fetching and executing are processed parallelly.
+	// So this function stores the cycles of each process to
+	// the variables below, and returns appropriate cycle count.
+	uint32_t cFetch = 0;
+	uint32_t cExecute = 0;
+
+	// this assert is annoying. but sometimes it is handy.
+	//assert(ARMPROC.instruct_adr!=0x00000000);
+
+	//fprintf(stderr, "%d: %08X\n",PROCNUM,ARMPROC.instruct_adr);
+
+	if (!ARMPROC.CPSR.bits.T)
+	{
+		if (
+			CONDITION(ARMPROC.instruction) == 0x0E  // fast path for unconditional instructions
+			|| (TEST_COND(CONDITION(ARMPROC.instruction), CODE(ARMPROC.instruction), ARMPROC.CPSR)) // handles any condition
+		)
+		{
+#ifdef HAVE_LUA
+			CallRegisteredLuaMemHook(ARMPROC.instruct_adr, 4, ARMPROC.instruction, LUAMEMHOOK_EXEC); // should report even if condition=false?
+#endif
+			cExecute = arm_instructions_set[PROCNUM][INSTRUCTION_INDEX(ARMPROC.instruction)](ARMPROC.instruction);
+		}
+		else
+			cExecute = 1; // If condition=false: 1S cycle
+		cFetch = armcpu_prefetch<PROCNUM>();
+		return MMU_fetchExecuteCycles<PROCNUM>(cExecute, cFetch);
+	}
+
+#ifdef HAVE_LUA
+	CallRegisteredLuaMemHook(ARMPROC.instruct_adr, 2, ARMPROC.instruction, LUAMEMHOOK_EXEC);
+#endif
+	cExecute = thumb_instructions_set[PROCNUM][ARMPROC.instruction>>6](ARMPROC.instruction);
+
+	cFetch = armcpu_prefetch<PROCNUM>();
+	return MMU_fetchExecuteCycles<PROCNUM>(cExecute, cFetch);
+}
+
+#endif
@@ -233,6 +233,43 @@ static void xsf_reset(int frameSkip)
   buffer_rope.clear();
 }
 
+/* The image built from the _lib chain is identical for every subtune of a
+ * set, so it is kept resident between opens.  While a track's own program
+ * sections are mapped on top, the base bytes they replace are saved, and
+ * restored before the next subtune maps its sections -- copy-on-write done
+ * in the plugin layer, since the emulator's MMU is vendored code.  Opening
+ * another subtune of the same set thus touches only the few kilobytes the
+ * previous track patched instead of rebuilding tens of megabytes. */
+struct RomPatch {
+  uint32_t offset;
+  std::vector<uint8_t> saved;
+};
+
+bool recursiveLoad2SF(std::vector<uint8_t>& rom, XSFFile* xsf, int level);
+
+static String rom_lib_path;            // _lib of the set rom_image was built for
+static std::vector<uint8_t> rom_image; // lib chain base plus current overlay
+static uint32_t rom_base_size = 0;     // image size before any overlay
+static std::vector<RomPatch> rom_patches;
+static bool rom_recording = false;     // save base bytes as map2SF overwrites them
+
+static void romInvalidate()
+{
+  rom_lib_path = String();
+  rom_image.clear();
+  rom_base_size = 0;
+  rom_patches.clear();
+}
+
+static void romRestoreBase()
+{
+  // undo in reverse order in case patches overlap
+  for (auto it = rom_patches.rbegin(); it != rom_patches.rend(); ++it)
+    memcpy(&rom_image[it->offset], it->saved.data(), it->saved.size());
+  rom_patches.clear();
+  rom_image.resize(rom_base_size);
+}
+
 bool map2SF(std::vector<uint8_t>& rom, XSFFile* xsf)
 {
   if (!xsf->IsValidType(0x24))
@@ -245,23 +282,22 @@ bool map2SF(std::vector<uint8_t>& rom, XSFFile* xsf)
     if (rom.size() < finalSize) {
       rom.resize(finalSize + 10);
     }
+    if (rom_recording && offset < rom_base_size) {
+      // bytes past rom_base_size are shed by the resize in romRestoreBase
+      uint32_t keep = ((finalSize < rom_base_size) ? finalSize : rom_base_size) - offset;
+      RomPatch patch;
+      patch.offset = offset;
+      patch.saved.assign(&rom[offset], &rom[offset + keep]);
+      rom_patches.push_back(std::move(patch));
+    }
     memcpy(&rom[offset], &programSection[8], size);
   }
   return true;
 }
 
-bool recursiveLoad2SF(std::vector<uint8_t>& rom, XSFFile* xsf, int level)
+/* maps xsf's own sections plus its _lib2..n auxiliary libs */
+static bool load2SFOverlay(std::vector<uint8_t>& rom, XSFFile* xsf, int level)
 {
-  if (level <= 10 && xsf->GetTagExists("_lib"))
-  {
-    vfsfile_istream vs(filename_build({ dirpath, xsf->GetTagValue("_lib").c_str() }));
-    if (!vs)
-      return false;
-    XSFFile libxsf(vs, 4, 8);
-    if (!recursiveLoad2SF(rom, &libxsf, level + 1))
-      return false;
-  }
-
   if (!map2SF(rom, xsf))
     return false;
 
@@ -282,6 +318,63 @@ bool recursiveLoad2SF(std::vector<uint8_t>& rom, XSFFile* xsf, int level)
   return true;
 }
 
+bool recursiveLoad2SF(std::vector<uint8_t>& rom, XSFFile* xsf, int level)
+{
+  if (level <= 10 && xsf->GetTagExists("_lib"))
+  {
+    vfsfile_istream vs(filename_build({ dirpath, xsf->GetTagValue("_lib").c_str() }));
+    if (!vs)
+      return false;
+    XSFFile libxsf(vs, 4, 8);
+    if (!recursiveLoad2SF(rom, &libxsf, level + 1))
+      return false;
+  }
+
+  return load2SFOverlay(rom, xsf, level);
+}
+
+/* builds (or reuses) the full image for one subtune in rom_image */
+static bool load2SFCached(XSFFile* xsf)
+{
+  if (xsf->GetTagExists("_lib")) {
+    String lib_path = String(filename_build({ dirpath, xsf->GetTagValue("_lib").c_str() }));
+
+    if (rom_lib_path && !strcmp(rom_lib_path, lib_path))
+      romRestoreBase();
+    else {
+      romInvalidate();
+
+      vfsfile_istream vs(lib_path);
+      if (!vs)
+        return false;
+      XSFFile libxsf(vs, 4, 8);
+      if (!recursiveLoad2SF(rom_image, &libxsf, 1)) {
+        romInvalidate();
+        return false;
+      }
+
+      rom_base_size = rom_image.size();
+      rom_lib_path = lib_path;
+    }
+
+    rom_recording = true;
+    bool ok = load2SFOverlay(rom_image, xsf, 0);
+    rom_recording = false;
+
+    if (!ok) {
+      romInvalidate();
+      return false;
+    }
+  } else {
+    // no shared library; nothing worth keeping across opens
+    romInvalidate();
+    if (!recursiveLoad2SF(rom_image, xsf, 0))
+      return false;
+  }
+
+  return rom_image.size() > 0;
+}
+
 void setInterp() {
   std::string interp = (const char*)aud_get_str(CFG_ID, "interpolation_mode");
   int interpMode = 0;
@@ -326,9 +419,9 @@ bool XSFPlugin::play(const char *filename, VFSFile &file)
     fade = xsf.GetFadeMS(5000);
     length = xsf.GetLengthMS(115000) + fade;
 
-    std::vector<uint8_t> rom;
-    if (!recursiveLoad2SF(rom, &xsf, 0) || !rom.size())
+    if (!load2SFCached(&xsf))
       return false;
+    std::vector<uint8_t>& rom = rom_image;
 
     if (NDS_Init())
       return false;
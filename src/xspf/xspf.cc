@@ -198,25 +198,17 @@ static void xspf_find_track (xmlNode * tracklist, const char * filename,
     }
 }
 
-static int read_cb (void * file, char * buf, int len)
-{
-    return ((VFSFile *) file)->fread (buf, 1, len);
-}
-
-static int write_cb (void * file, const char * buf, int len)
-{
-    return ((VFSFile *) file)->fwrite (buf, 1, len);
-}
-
-static int close_cb (void * file)
-{
-    return 0;
-}
-
 bool XSPFLoader::load (const char * filename, VFSFile & file, String & title,
  Index<PlaylistAddItem> & items)
 {
-    xmlDoc * doc = xmlReadIO (read_cb, close_cb, & file, filename, nullptr, XML_PARSE_RECOVER);
+    /* read the whole file in one I/O rather than letting libxml pull it
+     * in small chunks through the VFS layer */
+    Index<char> text = file.read_all ();
+    if (! text.len ())
+        return false;
+
+    xmlDoc * doc = xmlReadMemory (text.begin (), text.len (), filename,
+     nullptr, XML_PARSE_RECOVER);
     if (! doc)
         return false;
 
@@ -388,12 +380,30 @@ bool XSPFLoader::save (const char * filename, VFSFile & file,
         }
     }
 
-    xmlSaveCtxt * save = xmlSaveToIO (write_cb, close_cb, & file, nullptr, XML_SAVE_FORMAT);
-    if (! save)
-        goto ERR;
+    {
+        /* serialize to memory and write the result in one I/O */
+        xmlBuffer * xbuf = xmlBufferCreate ();
+        xmlSaveCtxt * save = xmlSaveToBuffer (xbuf, nullptr, XML_SAVE_FORMAT);
+
+        if (! save)
+        {
+            xmlBufferFree (xbuf);
+            goto ERR;
+        }
+
+        if (xmlSaveDoc (save, doc) < 0 || xmlSaveClose (save) < 0)
+        {
+            xmlBufferFree (xbuf);
+            goto ERR;
+        }
 
-    if (xmlSaveDoc (save, doc) < 0 || xmlSaveClose (save) < 0)
-        goto ERR;
+        int len = xmlBufferLength (xbuf);
+        bool written = (file.fwrite (xmlBufferContent (xbuf), 1, len) == len);
+        xmlBufferFree (xbuf);
+
+        if (! written)
+            goto ERR;
+    }
 
     xmlFreeDoc (doc);
     return true;